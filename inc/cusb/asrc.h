@@ -0,0 +1,299 @@
+/**
+ * @file
+ * @brief Asynchronous sample-rate converter for audio OUT streams.
+ * @details An asynchronous OUT endpoint relies on the host following the
+ * feedback endpoint. Some hosts ignore it, and adaptive or synchronous
+ * endpoints have none, so the host sends at its own clock while the codec
+ * plays at another. Without correction the FIFO between them slowly
+ * fills or drains until a sample is dropped or repeated, which is heard
+ * as a click every few minutes.
+ *
+ * The USB side writes received packets with @ref cusb_asrc_write(). The
+ * codec side, i.e. an I2S DMA half-transfer interrupt, pulls every block
+ * it plays with @ref cusb_asrc_read(). Reading starts once the FIFO is
+ * half full. From then on the converter steps through the input slightly
+ * faster or slower than one input frame per output frame, by the amount
+ * that keeps the FIFO half full. That ratio comes from the filtered fill
+ * level through a PI loop with a bandwidth of about 0.1 Hz at 48 kHz,
+ * slow enough that packet jitter moves the pitch by well under a cent,
+ * and is limited to @ref CUSB_ASRC_PPM_MAX. In steady state no input sample is
+ * ever dropped or repeated.
+ *
+ * Output samples come from a 16 tap, 64 phase windowed-sinc filter with
+ * linear interpolation between adjacent phases, in 16-bit fixed point.
+ * The filter's inner loop is compiled for the target:
+ *      - Cortex-M4/M7 DSP extension, two multiply-accumulates per SMLAD.
+ *      Selected when the compiler defines __ARM_FEATURE_DSP.
+ *      - SSE2 on x86_64 hosts, used for benchmarking on Linux.
+ *      - Portable C for everything else.
+ * All produce the same samples bit for bit.
+ *
+ * The writer and the reader may run in different contexts (i.e. USB
+ * interrupt and DMA interrupt) without locking.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_ASRC_H_
+#define CUSB_ASRC_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Filter taps per phase. Input frames the converter looks at
+ * for each output frame.
+ */
+#define CUSB_ASRC_TAPS                      (16U)
+
+/**
+ * @brief Filter phases per input frame. Positions in between are
+ * interpolated.
+ */
+#define CUSB_ASRC_PHASES                    (64U)
+
+/**
+ * @brief Largest rate correction, in parts per million.
+ */
+#define CUSB_ASRC_PPM_MAX                   (1000U)
+
+/**
+ * @brief Smallest FIFO, in frames.
+ */
+#define CUSB_ASRC_SIZE_MIN                  (4U * CUSB_ASRC_TAPS)
+
+/**
+ * @brief Largest FIFO, in frames.
+ */
+#define CUSB_ASRC_SIZE_MAX                  (0x7FFFU)
+
+/**
+ * @brief Defined to 1 if this build contains the Cortex-M DSP backend.
+ */
+#if defined(__ARM_FEATURE_DSP) && defined(__GNUC__)
+#define CUSB_ASRC_HAS_DSP 1
+#else
+#define CUSB_ASRC_HAS_DSP 0
+#endif
+
+/**
+ * @brief Defined to 1 if this build contains the SSE2 backend. Every
+ * x86_64 CPU supports it.
+ */
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CUSB_ASRC_HAS_SSE2 1
+#else
+#define CUSB_ASRC_HAS_SSE2 0
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Converter statistics. Counters wrap around.
+ */
+struct cusb_asrc_stats
+{
+    /// @brief Times the FIFO ran dry and output went silent until it
+    /// refilled.
+    uint32_t underruns;
+
+    /// @brief Input frames dropped because the FIFO was full.
+    uint32_t overflows;
+};
+
+/**
+ * @brief Sample-rate converter. Only modify through API.
+ */
+struct cusb_asrc
+{
+    /// @private FIFO, @ref size frames twice over per channel, so the
+    /// frames under the filter are always contiguous.
+    int16_t *mem;
+
+    /// @private FIFO frames.
+    uint16_t size;
+
+    /// @private Interleaved channels.
+    uint8_t channels;
+
+    /// @private Output is running. Only written by the reader.
+    bool running;
+
+    /// @private Free-running count of frames written. Only written by
+    /// the writer.
+    volatile uint32_t head;
+
+    /// @private Free-running count of frames consumed. Only written by
+    /// the reader.
+    volatile uint32_t tail;
+
+    /// @private Position between the frame at @ref tail and the next,
+    /// Q0.32.
+    uint32_t frac;
+
+    /// @private Input frames per output frame, minus one, Q0.32.
+    int32_t step;
+
+    /// @private Filtered fill level, frames Q16.16.
+    int32_t avg;
+
+    /// @private Integral term of the rate loop.
+    int64_t integral;
+
+#if (CUSB_CFG_STATS)
+    /// @private Statistics.
+    struct cusb_asrc_stats stats;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*-------------------- ASRC MEMBER FUNCTIONS -----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Converter constructor.
+ *
+ * @param me Converter to construct.
+ * @param mem FIFO of 2 * @p size * @p channels samples. Must remain
+ * valid for the lifetime of @p me.
+ * @param size FIFO frames, @ref CUSB_ASRC_SIZE_MIN to
+ * @ref CUSB_ASRC_SIZE_MAX. A few packets plus a few codec blocks is
+ * enough, the converter keeps it half full.
+ * @param channels Interleaved channels, at least 1.
+ */
+extern void cusb_asrc_ctor(struct cusb_asrc *me, int16_t *mem, uint16_t size, uint8_t channels);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_asrc_ctor().
+ * @brief Queues a received packet. Returns the frames taken, fewer
+ * than in @p data only if the FIFO is full.
+ *
+ * @param me Converter.
+ * @param data 16-bit little-endian interleaved samples, as received.
+ * @param len Bytes in @p data, a whole number of frames.
+ */
+extern uint32_t cusb_asrc_write(struct cusb_asrc *me, const uint8_t *data, uint32_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_asrc_ctor().
+ * @brief Produces the next @p frames frames at the codec's rate.
+ * Silence until the FIFO first fills, and again after it runs dry.
+ * Blocks of the same size each time give the smoothest tracking.
+ *
+ * @param me Converter.
+ * @param out Interleaved samples.
+ * @param frames Frames to produce.
+ */
+extern void cusb_asrc_read(struct cusb_asrc *me, int16_t *out, uint32_t frames);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_asrc_ctor().
+ * @brief Empties the FIFO and forgets the rate, i.e. when the host
+ * selects the zero bandwidth alternate setting. Call with neither side
+ * running.
+ *
+ * @param me Converter.
+ */
+extern void cusb_asrc_reset(struct cusb_asrc *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_asrc_ctor().
+ * @brief Returns the current correction in parts per million. Positive
+ * when the host sends faster than the codec plays.
+ *
+ * @param me Converter.
+ */
+extern int32_t cusb_asrc_ppm(const struct cusb_asrc *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_asrc_ctor().
+ * @brief Returns the frames in the FIFO.
+ *
+ * @param me Converter.
+ */
+extern uint32_t cusb_asrc_fill(const struct cusb_asrc *me);
+
+#if (CUSB_CFG_STATS)
+/**
+ * @pre @p me previously constructed via @ref cusb_asrc_ctor().
+ * @brief Returns the statistics. Only exists when @ref CUSB_CFG_STATS
+ * is 1.
+ *
+ * @param me Converter.
+ */
+extern const struct cusb_asrc_stats *cusb_asrc_get_stats(const struct cusb_asrc *me);
+#endif
+/**@}*/
+
+/**
+ * @name Backends
+ * Raw filter entry points. Applications normally use the member
+ * functions instead. These are exposed so benchmarks can compare
+ * the implementations directly. Each returns one output sample from
+ * @ref CUSB_ASRC_TAPS input samples at @p x, blending the phase at
+ * @p coef with the next one by @p weight (Q15).
+ */
+/**@{*/
+/**
+ * @brief Returns the coefficients of @p phase, followed by those of
+ * the next phase.
+ */
+extern const int16_t *cusb_asrc_phase(uint32_t phase);
+
+/**
+ * @brief Portable backend. Always available.
+ */
+extern int16_t cusb_asrc_fir_c(const int16_t *x, const int16_t *coef, uint32_t weight);
+
+#if (CUSB_ASRC_HAS_DSP)
+/**
+ * @brief Cortex-M DSP extension backend.
+ */
+extern int16_t cusb_asrc_fir_dsp(const int16_t *x, const int16_t *coef, uint32_t weight);
+#endif
+
+#if (CUSB_ASRC_HAS_SSE2)
+/**
+ * @brief x86_64 SSE2 backend.
+ */
+extern int16_t cusb_asrc_fir_sse2(const int16_t *x, const int16_t *coef, uint32_t weight);
+#endif
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_ASRC_H_ */
@@ -0,0 +1,87 @@
+/**
+ * @file
+ * @brief Runtime assert levels. Modules check their preconditions
+ * through @ref CUSB_ASSERT_API(), @ref CUSB_ASSERT_INTERNAL() and
+ * @ref CUSB_ASSERT_PACKET() instead of ECU's ECU_RUNTIME_ASSERT()
+ * directly, so a build can keep the cheap checks and drop the ones the
+ * transfer path pays for on every packet.
+ * @details @ref CUSB_CFG_ASSERT_LEVEL picks how many of them are
+ * compiled in. Each level includes the ones below it:
+ *
+ * | Level                                | Checks                                                      |
+ * |--------------------------------------|-------------------------------------------------------------|
+ * | @ref CUSB_ASSERT_LEVEL_NONE          | None.                                                       |
+ * | @ref CUSB_ASSERT_LEVEL_API           | Arguments of functions called at setup or control rate.     |
+ * | @ref CUSB_ASSERT_LEVEL_INTERNAL      | Call order and module state outside the transfer path.      |
+ * | @ref CUSB_ASSERT_LEVEL_PACKET        | Everything run once per packet or transfer. The default.    |
+ *
+ * A failed check ends up in ECU's assert handler like before, and
+ * ECU_DISABLE_RUNTIME_ASSERTS still removes every one of them. A check
+ * that is compiled out is not evaluated, but still counts as a use of
+ * the variables in it, so a parameter only checked is not reported as
+ * unused.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_ASSERT_H_
+#define CUSB_ASSERT_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* Runtime asserts. */
+#include "ecu/asserter.h"
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @private
+ * @brief Level in effect. None when ECU's asserts are disabled.
+ */
+#if defined(ECU_DISABLE_RUNTIME_ASSERTS)
+#define CUSB_ASSERT_LEVEL_                  CUSB_ASSERT_LEVEL_NONE
+#else
+#define CUSB_ASSERT_LEVEL_                  CUSB_CFG_ASSERT_LEVEL
+#endif
+
+/**
+ * @private
+ * @brief A check compiled out. Not evaluated.
+ */
+#define CUSB_ASSERT_NOTHING_(check)         ((void)sizeof((check) ? 1 : 0))
+
+/**
+ * @name Asserts
+ * Each takes the condition in parentheses, like ECU_RUNTIME_ASSERT().
+ */
+/**@{*/
+#if (CUSB_ASSERT_LEVEL_ >= CUSB_ASSERT_LEVEL_API)
+#define CUSB_ASSERT_API(check)              ECU_RUNTIME_ASSERT(check)
+#else
+#define CUSB_ASSERT_API(check)              CUSB_ASSERT_NOTHING_(check)
+#endif
+
+#if (CUSB_ASSERT_LEVEL_ >= CUSB_ASSERT_LEVEL_INTERNAL)
+#define CUSB_ASSERT_INTERNAL(check)         ECU_RUNTIME_ASSERT(check)
+#else
+#define CUSB_ASSERT_INTERNAL(check)         CUSB_ASSERT_NOTHING_(check)
+#endif
+
+#if (CUSB_ASSERT_LEVEL_ >= CUSB_ASSERT_LEVEL_PACKET)
+#define CUSB_ASSERT_PACKET(check)           ECU_RUNTIME_ASSERT(check)
+#else
+#define CUSB_ASSERT_PACKET(check)           CUSB_ASSERT_NOTHING_(check)
+#endif
+/**@}*/
+
+#endif /* CUSB_ASSERT_H_ */
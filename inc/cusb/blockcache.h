@@ -0,0 +1,239 @@
+/**
+ * @file
+ * @brief Write-back cache that coalesces sector writes into whole erase
+ * block writes for flash backed block devices.
+ * @details The cache is itself a @ref cusb_blockdev that sits between
+ * the SCSI target and the flash driver. A raw NOR or NAND driver erases
+ * the enclosing erase block for every write it gets, so a host writing a
+ * file one sector at a time costs one erase per sector. The cache keeps
+ * a fixed number of erase blocks (lines) in RAM. Writes land in a line,
+ * which is filled from the flash first unless the write covers all of
+ * it, and a dirty line goes back to the flash as one erase block sized
+ * write when:
+ *
+ * - it is evicted to make room for another erase block. The least
+ *   recently used line is evicted.
+ * - the host sends SYNCHRONIZE CACHE (a @ref CUSB_BLOCKDEV_SYNC request).
+ * - the application calls @ref cusb_blockcache_flush(), i.e. once the
+ *   bus has been idle for a while.
+ *
+ * A write back that fails leaves the line dirty, so the next write back
+ * retries it. A failed eviction does not fail the request that caused
+ * it; another line is evicted instead. The error is reported on the next
+ * SYNCHRONIZE CACHE, like fsync() does after a failed background write.
+ *
+ * Reads of cached erase blocks are served from RAM. Other reads go
+ * straight to the flash without taking a line. Requests are processed
+ * one at a time in submission order. The RAM budget is exactly the lines
+ * passed to the constructor.
+ *
+ * Meant for fixed on-board flash. Media state is not forwarded from the
+ * lower device.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_BLOCKCACHE_H_
+#define CUSB_BLOCKCACHE_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Block device. */
+#include "cusb/blockdev.h"
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief One cached erase block. Only modify through API.
+ */
+struct cusb_blockcache_line
+{
+    /// @private Erase block number. Valid if @ref used.
+    uint32_t erase_block;
+
+    /// @private Last use, for LRU eviction.
+    uint32_t stamp;
+
+    /// @private Erase block sized buffer.
+    uint8_t *data;
+
+    /// @private Line holds a valid copy of @ref erase_block.
+    bool used;
+
+    /// @private Line differs from the flash.
+    bool dirty;
+};
+
+/**
+ * @brief Cache statistics.
+ */
+struct cusb_blockcache_stats
+{
+    uint32_t read_hits;     /**< Read segments served from RAM. */
+    uint32_t write_hits;    /**< Write segments that landed in a cached line. */
+    uint32_t fills;         /**< Lines read from the flash before a partial write. */
+    uint32_t writebacks;    /**< Erase block writes sent to the flash. */
+};
+
+/**
+ * @brief Block cache. Only modify through API.
+ */
+struct cusb_blockcache
+{
+    /// @private Block device handed to the SCSI target.
+    struct cusb_blockdev dev;
+
+    /// @private Flash.
+    struct cusb_blockdev *lower;
+
+    /// @private Cache lines.
+    struct cusb_blockcache_line *lines;
+
+    /// @private Number of elements in @ref lines.
+    size_t nlines;
+
+    /// @private Blocks per erase block.
+    uint32_t erase_blocks;
+
+    /// @private Use counter for @ref cusb_blockcache_line.stamp.
+    uint32_t clock;
+
+    /// @private Submitted requests not started yet.
+    struct cusb_blockdev_req *head;
+
+    /// @private Last element of @ref head.
+    struct cusb_blockdev_req *tail;
+
+    /// @private Request being processed. NULL if none.
+    struct cusb_blockdev_req *cur;
+
+    /// @private Blocks of @ref cur done so far.
+    uint32_t done;
+
+    /// @private Evictions that failed while processing @ref cur.
+    size_t evict_failures;
+
+    /// @private Request sent to the flash.
+    struct cusb_blockdev_req lower_req;
+
+    /// @private Line @ref lower_req fills or writes back. NULL for pass-through reads.
+    struct cusb_blockcache_line *lower_line;
+
+    /// @private @ref lower_req is in flight.
+    bool waiting;
+
+    /// @private Processing loop is running. Guards against synchronous completions.
+    bool running;
+
+    /// @private Internal request used by @ref cusb_blockcache_flush().
+    struct cusb_blockdev_req flush_req;
+
+    /// @private @ref flush_req is queued or running.
+    bool flushing;
+
+    /// @private A write back failed since the last SYNC request.
+    bool write_error;
+
+#if (CUSB_CFG_STATS)
+    /// @private Statistics.
+    struct cusb_blockcache_stats stats;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*------------------ BLOCKCACHE MEMBER FUNCTIONS -------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Block cache constructor.
+ *
+ * @param me Cache to construct.
+ * @param lower Flash. Must remain valid for the lifetime of @p me.
+ * @param lines Cache lines.
+ * @param nlines Number of elements in @p lines. At least 1.
+ * @param buffer @p nlines erase block buffers, back to back. This is the
+ * RAM budget: @p nlines * @p erase_size bytes.
+ * @param erase_size Erase block size in bytes. A power of 2 multiple of
+ * the block size that divides the device size.
+ */
+extern void cusb_blockcache_ctor(struct cusb_blockcache *me,
+                                 struct cusb_blockdev *lower,
+                                 struct cusb_blockcache_line *lines,
+                                 size_t nlines,
+                                 uint8_t *buffer,
+                                 uint32_t erase_size);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_blockcache_ctor().
+ * @brief Returns the block device to hand to the SCSI target.
+ *
+ * @param me Cache.
+ */
+extern struct cusb_blockdev *cusb_blockcache_blockdev(struct cusb_blockcache *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_blockcache_ctor().
+ * @brief Writes every dirty line back to the flash in the background,
+ * after the requests already submitted. Does not sync the flash itself.
+ * Returns true if there was something to write back. A failure is
+ * reported on the next SYNC request.
+ *
+ * @param me Cache.
+ */
+extern bool cusb_blockcache_flush(struct cusb_blockcache *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_blockcache_ctor().
+ * @brief Returns true if no line is dirty and no request is pending.
+ *
+ * @param me Cache.
+ */
+extern bool cusb_blockcache_idle(const struct cusb_blockcache *me);
+
+#if (CUSB_CFG_STATS)
+/**
+ * @pre @p me previously constructed via @ref cusb_blockcache_ctor().
+ * @brief Copies the statistics into @p stats. Only exists when
+ * @ref CUSB_CFG_STATS is 1.
+ *
+ * @param me Cache.
+ * @param stats Destination.
+ */
+extern void cusb_blockcache_get_stats(const struct cusb_blockcache *me, struct cusb_blockcache_stats *stats);
+#endif
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_BLOCKCACHE_H_ */
@@ -0,0 +1,234 @@
+/**
+ * @file
+ * @brief Asynchronous block device interface used by the mass storage
+ * classes.
+ * @details A block device is a backend (SD card, flash, RAM disk, etc)
+ * wrapped in a @ref cusb_blockdev. Requests are submitted with
+ * @ref cusb_blockdev_submit() and completed by the backend with
+ * @ref cusb_blockdev_complete() whenever it is done, from any context
+ * and in any order. A synchronous backend simply completes the request
+ * before its submit function returns. Several requests may be
+ * outstanding at once so a backend that can overlap work (i.e. queue
+ * commands to an SD card while a previous transfer finishes) is free
+ * to do so.
+ *
+ * A backend whose media is addressable memory (RAM disk, memory mapped
+ * disk image) can also hand out direct pointers to it with the optional
+ * map function. Submitters then move data straight between the media and
+ * the USB transfer buffers and pass that pointer as the request buffer,
+ * so the backend has nothing left to copy.
+ *
+ * Media state (present, size, write protect) is owned by the block
+ * device. Every change bumps a generation count the SCSI layer uses to
+ * report a unit attention to the host.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_BLOCKDEV_H_
+#define CUSB_BLOCKDEV_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Request operation.
+ */
+enum cusb_blockdev_op
+{
+    CUSB_BLOCKDEV_READ,     /**< Read blocks into buffer. */
+    CUSB_BLOCKDEV_WRITE,    /**< Write blocks from buffer. */
+    CUSB_BLOCKDEV_SYNC      /**< Commit all previously completed writes to media. */
+};
+
+/**
+ * @brief One block device request. Owned by the submitter, which fills
+ * in the public members before calling @ref cusb_blockdev_submit(). Must
+ * not be modified or reused until completed.
+ */
+struct cusb_blockdev_req
+{
+    /// @brief @ref cusb_blockdev_op.
+    uint8_t op;
+
+    /// @brief First block. Unused for @ref CUSB_BLOCKDEV_SYNC.
+    uint32_t lba;
+
+    /// @brief Number of blocks. Unused for @ref CUSB_BLOCKDEV_SYNC.
+    uint32_t count;
+
+    /// @brief Data buffer of at least count * block size bytes.
+    uint8_t *buf;
+
+    /// @brief Called by @ref cusb_blockdev_complete(). @p ok is false
+    /// if the backend failed the request.
+    void (*done)(struct cusb_blockdev_req *req, bool ok);
+
+    /// @brief Submitter's context. Not used by the block device.
+    void *owner;
+
+    /// @brief Free for the backend to use, i.e. to queue requests.
+    struct cusb_blockdev_req *next;
+};
+
+/**
+ * @brief Backend functions.
+ */
+struct cusb_blockdev_api
+{
+    /// @brief Starts @p req. The backend must eventually call
+    /// @ref cusb_blockdev_complete() exactly once for it, either before
+    /// returning or later from any context.
+    void (*submit)(void *ctx, struct cusb_blockdev_req *req);
+
+    /// @brief Optional, can be NULL. Returns the address of @p count
+    /// blocks starting at @p lba if they are contiguous in memory,
+    /// otherwise NULL. @p writing is true if the caller may write through
+    /// it. See @ref cusb_blockdev_map().
+    uint8_t *(*map)(void *ctx, uint32_t lba, uint32_t count, bool writing);
+};
+
+/**
+ * @brief Block device. Only modify through API.
+ */
+struct cusb_blockdev
+{
+    /// @private Backend functions.
+    const struct cusb_blockdev_api *api;
+
+    /// @private Passed to every backend function.
+    void *ctx;
+
+    /// @private Block size in bytes.
+    uint32_t block_size;
+
+    /// @private Number of blocks on the media.
+    uint32_t block_count;
+
+    /// @private Media is inserted.
+    bool present;
+
+    /// @private Media is write protected.
+    bool write_protected;
+
+    /// @private Incremented on every media state change.
+    uint8_t generation;
+};
+
+/*------------------------------------------------------------*/
+/*------------------ BLOCKDEV MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Block device constructor. Media starts present and writable.
+ *
+ * @param me Block device to construct.
+ * @param api Backend functions. Must remain valid for the lifetime of @p me.
+ * @param ctx Passed to every backend function. Optional, can be NULL.
+ * @param block_size Block size in bytes. Must be a power of 2 and at least 512.
+ * @param block_count Number of blocks.
+ */
+extern void cusb_blockdev_ctor(struct cusb_blockdev *me,
+                               const struct cusb_blockdev_api *api,
+                               void *ctx,
+                               uint32_t block_size,
+                               uint32_t block_count);
+/**@}*/
+
+/**
+ * @name Requests
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_blockdev_ctor().
+ * @brief Submits @p req to the backend. The request must be within the
+ * media and the media must be present.
+ *
+ * @param me Block device.
+ * @param req Request. Public members filled in by the caller.
+ */
+extern void cusb_blockdev_submit(struct cusb_blockdev *me, struct cusb_blockdev_req *req);
+
+/**
+ * @brief Completes @p req. Called by the backend, from any context.
+ *
+ * @param req Request previously passed to the backend.
+ * @param ok False if the request failed.
+ */
+extern void cusb_blockdev_complete(struct cusb_blockdev_req *req, bool ok);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_blockdev_ctor().
+ * @brief Returns a direct pointer to @p count blocks starting at @p lba,
+ * or NULL if the backend cannot map them. The pointer is only valid until
+ * the next media change.
+ *
+ * Data read through it is only current once a READ request with the
+ * pointer as its buffer completed. Data written through it may reach the
+ * media before the WRITE request with the pointer as its buffer is
+ * submitted, so a command aborted halfway can leave a partial write,
+ * just like on a real disk. The backend must therefore treat blocks mapped
+ * for writing as written, whether or not a WRITE request follows.
+ *
+ * @param me Block device.
+ * @param lba First block. Must be within the media.
+ * @param count Number of blocks. Must be within the media.
+ * @param writing True if data will be written through the pointer.
+ */
+extern uint8_t *cusb_blockdev_map(struct cusb_blockdev *me, uint32_t lba, uint32_t count, bool writing);
+/**@}*/
+
+/**
+ * @name Media State
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_blockdev_ctor().
+ * @brief Reports media insertion, removal or resize.
+ *
+ * @param me Block device.
+ * @param present Media is inserted.
+ * @param block_count Number of blocks. Ignored if @p present is false.
+ */
+extern void cusb_blockdev_media_changed(struct cusb_blockdev *me, bool present, uint32_t block_count);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_blockdev_ctor().
+ * @brief Sets the write protect state.
+ *
+ * @param me Block device.
+ * @param write_protected Media is write protected.
+ */
+extern void cusb_blockdev_set_write_protect(struct cusb_blockdev *me, bool write_protected);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_BLOCKDEV_H_ */
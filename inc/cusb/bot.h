@@ -0,0 +1,236 @@
+/**
+ * @file
+ * @brief Mass storage Bulk-Only Transport (BOT).
+ * @details Moves one command at a time: Command Block Wrapper (CBW) on
+ * Bulk-OUT, optional data phase, Command Status Wrapper (CSW) on Bulk-IN.
+ * Handles GET MAX LUN and Bulk-Only Mass Storage Reset, and the thirteen
+ * host/device data phase mismatch cases of the spec by halting the right
+ * endpoint and reporting a residue or phase error in the CSW.
+ *
+ * Like the other classes it is transport agnostic. The endpoint glue
+ * passes Bulk-OUT packets to @ref cusb_bot_bulk_out() while
+ * @ref cusb_bot_bulk_out_space() is non-zero, asks @ref cusb_bot_bulk_in()
+ * what to send next and forwards class requests to @ref cusb_bot_control().
+ * After every call and every notification it halts the endpoints
+ * @ref cusb_bot_halt() returns.
+ *
+ * Every logical unit has its own backend and the transport never waits
+ * for one: while a LUN's backend is busy the bulk endpoints simply NAK,
+ * and the CPU is free for everything else. BOT itself allows only one
+ * command in flight, so use UAS where the host should be able to overlap
+ * commands to different LUNs.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_BOT_H_
+#define CUSB_BOT_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* SCSI target. */
+#include "cusb/scsi.h"
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Size of a Command Status Wrapper.
+ */
+#define CUSB_BOT_CSW_SIZE                   (13U)
+
+/**
+ * @brief Largest control request response.
+ */
+#define CUSB_BOT_CONTROL_RESPONSE_MAX       (1U)
+
+/**
+ * @name Halt Flags
+ * @brief Returned by @ref cusb_bot_halt().
+ */
+/**@{*/
+#define CUSB_BOT_HALT_IN                    (1U << 0)
+#define CUSB_BOT_HALT_OUT                   (1U << 1)
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief BOT function. Only modify through API.
+ */
+struct cusb_bot
+{
+    /// @private Logical units. Element i is LUN i.
+    struct cusb_scsi *luns;
+
+    /// @private Number of elements in @ref luns.
+    uint8_t nluns;
+
+    /// @private Bulk endpoint max packet size.
+    uint16_t packet_size;
+
+    /// @private The one command slot.
+    struct cusb_scsi_task task;
+
+    /// @private Transport phase.
+    uint8_t phase;
+
+    /// @private Endpoints waiting to be halted by the glue.
+    uint8_t halt;
+
+    /// @private Host and device disagreed on the data phase.
+    bool phase_error;
+
+    /// @private dCBWTag.
+    uint32_t tag;
+
+    /// @private dCBWDataTransferLength.
+    uint32_t data_len;
+
+    /// @private Data phase bytes moved over the bus so far.
+    uint32_t moved;
+
+    /// @private Called when something new is ready.
+    void (*notify)(void *ctx);
+
+    /// @private Passed to @ref notify.
+    void *ctx;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------- BOT MEMBER FUNCTIONS -----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief BOT constructor.
+ *
+ * @param me BOT function to construct.
+ * @param luns Logical units. Must remain valid for the lifetime of @p me.
+ * @param nluns Number of elements in @p luns. At most @ref CUSB_SCSI_LUN_MAX.
+ * @param buf Task buffer. A multiple of the block size and at least
+ * @ref CUSB_SCSI_TASK_BUFFER_MIN bytes.
+ * @param buf_size Size of @p buf.
+ * @param packet_size Bulk endpoint max packet size.
+ * @param notify Called from the backend's completion context when
+ * something new is ready. Optional, can be NULL.
+ * @param ctx Passed to @p notify.
+ */
+extern void cusb_bot_ctor(struct cusb_bot *me,
+                          struct cusb_scsi *luns,
+                          size_t nluns,
+                          uint8_t *buf,
+                          size_t buf_size,
+                          uint16_t packet_size,
+                          void (*notify)(void *ctx),
+                          void *ctx);
+/**@}*/
+
+/**
+ * @name Transport
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_bot_ctor().
+ * @brief Returns the number of bytes the Bulk-OUT endpoint can take right
+ * now. The glue only arms the endpoint while this is non-zero.
+ *
+ * @param me BOT function.
+ */
+extern size_t cusb_bot_bulk_out_space(const struct cusb_bot *me);
+
+/**
+ * @pre @ref cusb_bot_bulk_out_space() returned at least @p len.
+ * @brief Processes one packet received on the Bulk-OUT endpoint.
+ *
+ * @param me BOT function.
+ * @param pkt Received packet.
+ * @param len Number of bytes in @p pkt.
+ */
+extern void cusb_bot_bulk_out(struct cusb_bot *me, const uint8_t *pkt, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_bot_ctor().
+ * @brief Fills the next Bulk-IN transfer chunk. Returns true if something
+ * must be sent, in which case @p len holds the number of bytes written to
+ * @p buf.
+ *
+ * @param me BOT function.
+ * @param buf Transfer buffer. At least @ref CUSB_BOT_CSW_SIZE bytes.
+ * @param size Size of @p buf. Must be a non-zero multiple of the packet size.
+ * @param len Number of bytes written to @p buf.
+ */
+extern bool cusb_bot_bulk_in(struct cusb_bot *me, uint8_t *buf, size_t size, size_t *len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_bot_ctor().
+ * @brief Returns the endpoints that must be halted now as
+ * @ref CUSB_BOT_HALT_IN and @ref CUSB_BOT_HALT_OUT flags, and forgets them.
+ *
+ * @param me BOT function.
+ */
+extern uint8_t cusb_bot_halt(struct cusb_bot *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_bot_ctor().
+ * @brief Call when the host clears a halted bulk endpoint. Returns false
+ * if the endpoint must stay halted because an invalid CBW was received
+ * and the host has not done a Reset Recovery yet.
+ *
+ * @param me BOT function.
+ */
+extern bool cusb_bot_clear_halt(struct cusb_bot *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_bot_ctor().
+ * @brief Handles GET MAX LUN and Bulk-Only Mass Storage Reset. Returns
+ * false if the request is not supported, in which case EP0 must be
+ * stalled. Otherwise @p resp holds @p resp_len bytes for the data stage.
+ *
+ * @param me BOT function.
+ * @param setup The 8 byte SETUP packet.
+ * @param resp Response buffer of at least @ref CUSB_BOT_CONTROL_RESPONSE_MAX bytes.
+ * @param resp_len Number of response bytes written to @p resp.
+ */
+extern bool cusb_bot_control(struct cusb_bot *me, const uint8_t *setup,
+                             uint8_t *resp, size_t *resp_len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_bot_ctor().
+ * @brief Aborts the current command and waits for the next CBW. Call on
+ * bus reset and set interface.
+ *
+ * @param me BOT function.
+ */
+extern void cusb_bot_reset(struct cusb_bot *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_BOT_H_ */
@@ -0,0 +1,192 @@
+/**
+ * @file
+ * @brief Completion coalescing for endpoints carrying many small
+ * packets. Collects transfer completions and hands them to the
+ * application as one callback with an array of results.
+ * @details At high packet rates the cost of calling back into the
+ * application once per packet (call, prologue, reloading its state)
+ * dominates the work done per packet. The transport posts each
+ * completion with @ref cusb_coalesce_post(), which only stores it. The
+ * callback runs once a batch is full, and @ref cusb_coalesce_flush()
+ * delivers whatever is left, so calling it at the end of every interrupt
+ * or poll pass gives one callback per pass no matter how many packets
+ * completed in it. A batch size of 1 gives the plain one callback per
+ * packet behaviour.
+ *
+ * Results live in two banks. The callback reads one while completions
+ * keep landing in the other, so a callback can restart transfers that
+ * complete before it returns, up to a batch of them. Those are delivered
+ * in a new callback once it does, never nested.
+ *
+ * Post and flush from the same context, i.e. both from the USB interrupt
+ * or both from the poll loop.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_COALESCE_H_
+#define CUSB_COALESCE_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Result of one transfer.
+ */
+struct cusb_completion
+{
+    /// @brief Buffer of the transfer.
+    uint8_t *buf;
+
+    /// @brief Bytes actually transferred.
+    uint16_t len;
+
+    /// @brief Endpoint address, direction bit included.
+    uint8_t ep;
+
+    /// @brief True if the transfer completed without error.
+    bool ok;
+};
+
+/**
+ * @brief Coalescing statistics. Counters wrap around.
+ */
+struct cusb_coalesce_stats
+{
+    /// @brief Completions posted.
+    uint32_t completions;
+
+    /// @brief Callbacks made.
+    uint32_t callbacks;
+};
+
+/**
+ * @brief Completion coalescer. Only modify through API.
+ */
+struct cusb_coalesce
+{
+    /// @private Two banks of @ref batch results.
+    struct cusb_completion *results;
+
+    /// @private Results per bank.
+    uint16_t batch;
+
+    /// @private Bank being filled. Points into @ref results.
+    struct cusb_completion *fill;
+
+    /// @private Results in the bank being filled.
+    uint16_t count;
+
+    /// @private Callback is running.
+    bool delivering;
+
+    /// @private Application callback.
+    void (*callback)(void *obj, const struct cusb_completion *results, size_t count);
+
+    /// @private Passed to @ref callback.
+    void *obj;
+
+#if (CUSB_CFG_STATS)
+    /// @private Statistics.
+    struct cusb_coalesce_stats stats;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*------------------- COALESCE MEMBER FUNCTIONS --------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me and @p results.
+ * @brief Constructor.
+ *
+ * @param me Coalescer to construct.
+ * @param results Storage for two banks. Must remain valid for the
+ * lifetime of @p me.
+ * @param nresults Number of elements in @p results. Even, at least 2.
+ * The batch size is half of it.
+ * @param callback Called with a batch of results, oldest first. The
+ * array is only valid during the call.
+ * @param obj Passed to @p callback. Optional, can be NULL.
+ */
+extern void cusb_coalesce_ctor(struct cusb_coalesce *me,
+                               struct cusb_completion *results,
+                               size_t nresults,
+                               void (*callback)(void *obj, const struct cusb_completion *results, size_t count),
+                               void *obj);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_coalesce_ctor().
+ * @brief Records one completion. Calls back if it fills the batch.
+ *
+ * @param me Coalescer.
+ * @param ep Endpoint address, direction bit included.
+ * @param buf Buffer of the transfer.
+ * @param len Bytes actually transferred.
+ * @param ok False if the transfer failed.
+ */
+extern void cusb_coalesce_post(struct cusb_coalesce *me, uint8_t ep, uint8_t *buf, uint16_t len, bool ok);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_coalesce_ctor().
+ * @brief Calls back with the completions posted since the last callback,
+ * if any. Call at the end of each interrupt or poll pass.
+ *
+ * @param me Coalescer.
+ */
+extern void cusb_coalesce_flush(struct cusb_coalesce *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_coalesce_ctor().
+ * @brief Returns the number of completions waiting for a callback.
+ *
+ * @param me Coalescer.
+ */
+extern size_t cusb_coalesce_pending(const struct cusb_coalesce *me);
+
+#if (CUSB_CFG_STATS)
+/**
+ * @pre @p me previously constructed via @ref cusb_coalesce_ctor().
+ * @brief Returns the statistics. Only exists when @ref CUSB_CFG_STATS
+ * is 1.
+ *
+ * @param me Coalescer.
+ */
+extern const struct cusb_coalesce_stats *cusb_coalesce_get_stats(const struct cusb_coalesce *me);
+#endif
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_COALESCE_H_ */
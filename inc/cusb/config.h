@@ -0,0 +1,347 @@
+/**
+ * @file
+ * @brief Compile-time configuration of the CUSB library. Pulls in the
+ * application's @ref cusb_config.h, gives every option it leaves out a
+ * default and rejects invalid combinations.
+ * @details Every module includes this header first. Disabled classes
+ * compile to empty translation units, and statistics and trace points
+ * are removed from both the code and the structs, so a disabled feature
+ * costs neither flash nor RAM. Table and queue sizes are fixed here so
+ * they can be trimmed to what a product actually uses.
+ *
+ * Boolean options are 0 or 1 and are tested with #if, never #ifdef.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_CONFIG_H_
+#define CUSB_CONFIG_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Application configuration. */
+#include "cusb_config.h"
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Speeds
+ * Values of @ref CUSB_CFG_SPEED.
+ */
+/**@{*/
+#define CUSB_SPEED_FULL                     (0U)
+#define CUSB_SPEED_HIGH                     (1U)
+/**@}*/
+
+/**
+ * @name Assert Levels
+ * Values of @ref CUSB_CFG_ASSERT_LEVEL. Each includes the ones before
+ * it, see @ref cusb/assert.h.
+ */
+/**@{*/
+#define CUSB_ASSERT_LEVEL_NONE              (0U)    /**< No runtime asserts. */
+#define CUSB_ASSERT_LEVEL_API               (1U)    /**< Arguments at setup and control rate. */
+#define CUSB_ASSERT_LEVEL_INTERNAL          (2U)    /**< Call order and module state. */
+#define CUSB_ASSERT_LEVEL_PACKET            (3U)    /**< Checks on the transfer path. */
+/**@}*/
+
+/**
+ * @name Device
+ */
+/**@{*/
+#ifndef CUSB_CFG_SPEED
+/**
+ * @brief Fastest speed the device supports. Bounds the bulk max packet
+ * size every class accepts, see @ref CUSB_CFG_BULK_SIZE_MAX.
+ */
+#define CUSB_CFG_SPEED                      CUSB_SPEED_HIGH
+#endif
+
+#ifndef CUSB_CFG_ENDPOINTS
+/**
+ * @brief Endpoint numbers used, including EP0. Sizes the per endpoint
+ * tables of the device controller drivers. 1 to 16.
+ */
+#define CUSB_CFG_ENDPOINTS                  (16U)
+#endif
+
+#ifndef CUSB_CFG_EP0_SIZE
+/**
+ * @brief Max packet size of the default control endpoint. 8, 16, 32 or
+ * 64.
+ */
+#define CUSB_CFG_EP0_SIZE                   (64U)
+#endif
+
+#ifndef CUSB_CFG_DMA
+/**
+ * @brief Support for controller drivers that move endpoint data by DMA:
+ * buffer constraint checks and the data cache maintenance of
+ * @ref cusb_device_set_cache(). Costs one test per transfer with drivers
+ * that do not use DMA.
+ */
+#define CUSB_CFG_DMA                        1
+#endif
+/**@}*/
+
+/**
+ * @name Classes
+ * A disabled class leaves no code behind. Calling its API is a link
+ * error.
+ */
+/**@{*/
+#ifndef CUSB_CFG_MSC
+/**
+ * @brief Mass storage: SCSI target, Bulk-Only transport and the block
+ * device layer.
+ */
+#define CUSB_CFG_MSC                        1
+#endif
+
+#ifndef CUSB_CFG_MSC_UAS
+/**
+ * @brief USB Attached SCSI transport. Needs @ref CUSB_CFG_MSC.
+ */
+#define CUSB_CFG_MSC_UAS                    CUSB_CFG_MSC
+#endif
+
+#ifndef CUSB_CFG_BLOCKCACHE
+/**
+ * @brief Erase block write cache for flash backed block devices. Needs
+ * @ref CUSB_CFG_MSC.
+ */
+#define CUSB_CFG_BLOCKCACHE                 CUSB_CFG_MSC
+#endif
+
+#ifndef CUSB_CFG_MTP
+/**
+ * @brief Media Transfer Protocol responder.
+ */
+#define CUSB_CFG_MTP                        1
+#endif
+
+#ifndef CUSB_CFG_USBTMC
+/**
+ * @brief USBTMC test and measurement class with the USB488 subclass.
+ */
+#define CUSB_CFG_USBTMC                     1
+#endif
+
+#ifndef CUSB_CFG_MIDI
+/**
+ * @brief USB-MIDI class, MIDI 1.0 event packets and MIDI 2.0 UMP.
+ */
+#define CUSB_CFG_MIDI                       1
+#endif
+
+#ifndef CUSB_CFG_RNDIS
+/**
+ * @brief RNDIS network function. Needs @ref CUSB_CFG_PKTPOOL.
+ */
+#define CUSB_CFG_RNDIS                      1
+#endif
+
+#ifndef CUSB_CFG_PKTPOOL
+/**
+ * @brief Reference counted transfer buffer pool of the network
+ * functions.
+ */
+#define CUSB_CFG_PKTPOOL                    CUSB_CFG_RNDIS
+#endif
+
+#ifndef CUSB_CFG_STREAM
+/**
+ * @brief Bulk streaming pipes, used by vendor classes and the pty
+ * bridge.
+ */
+#define CUSB_CFG_STREAM                     1
+#endif
+
+#ifndef CUSB_CFG_CRC32
+/**
+ * @brief CRC-32 verification service.
+ */
+#define CUSB_CFG_CRC32                      1
+#endif
+
+#ifndef CUSB_CFG_COALESCE
+/**
+ * @brief Completion coalescing for high packet rate endpoints.
+ */
+#define CUSB_CFG_COALESCE                   1
+#endif
+
+#ifndef CUSB_CFG_ASRC
+/**
+ * @brief Sample-rate converter for audio OUT streams whose host does
+ * not follow the feedback endpoint.
+ */
+#define CUSB_CFG_ASRC                       1
+#endif
+/**@}*/
+
+/**
+ * @name Queue Depths And Tables
+ */
+/**@{*/
+#ifndef CUSB_CFG_SCSI_LUN_MAX
+/**
+ * @brief Most logical units one SCSI target serves. 1 to 16.
+ */
+#define CUSB_CFG_SCSI_LUN_MAX               (16U)
+#endif
+
+#ifndef CUSB_CFG_UAS_PENDING_MAX
+/**
+ * @brief Status IUs not tied to a command slot (task management
+ * responses, TASK SET FULL) the UAS transport can queue. 4 bytes each.
+ */
+#define CUSB_CFG_UAS_PENDING_MAX            (4U)
+#endif
+
+#ifndef CUSB_CFG_MIDI_CABLES
+/**
+ * @brief Most virtual cables, or UMP groups, of one USB-MIDI function.
+ * 1 to 16, 16 bytes of parser state each.
+ */
+#define CUSB_CFG_MIDI_CABLES                (4U)
+#endif
+
+#ifndef CUSB_CFG_CRC32_SLICE8
+/**
+ * @brief Software CRC-32 uses slicing-by-8 (8 KiB of tables) rather than
+ * a byte at a time (1 KiB). Roughly four times faster. Not used by the
+ * STM32 hardware backend.
+ */
+#define CUSB_CFG_CRC32_SLICE8               1
+#endif
+
+#ifndef CUSB_CFG_LOAD_HISTORY
+/**
+ * @brief Windows the load average of @ref cusb/load.h runs over. 1 to
+ * 255, 8 bytes each.
+ */
+#define CUSB_CFG_LOAD_HISTORY               (8U)
+#endif
+/**@}*/
+
+/**
+ * @name Diagnostics
+ */
+/**@{*/
+#ifndef CUSB_CFG_STATS
+/**
+ * @brief Modules keep statistics counters. When 0 the counters, the
+ * fields holding them and the functions reading them do not exist.
+ */
+#define CUSB_CFG_STATS                      1
+#endif
+
+#ifndef CUSB_CFG_ASSERT_LEVEL
+/**
+ * @brief Runtime asserts compiled in, one of the
+ * @ref CUSB_ASSERT_LEVEL_NONE "assert levels". Production builds that
+ * want to keep argument checks without paying for them on every packet
+ * use @ref CUSB_ASSERT_LEVEL_API or @ref CUSB_ASSERT_LEVEL_INTERNAL.
+ */
+#define CUSB_CFG_ASSERT_LEVEL               CUSB_ASSERT_LEVEL_PACKET
+#endif
+
+#ifndef CUSB_CFG_TRACE
+/**
+ * @brief Modules report events through @ref CUSB_TRACE(). See
+ * @ref cusb/trace.h.
+ */
+#define CUSB_CFG_TRACE                      0
+#endif
+
+#ifndef CUSB_CFG_LOAD
+/**
+ * @brief CPU load accounting of @ref cusb/load.h, and the hooks in the
+ * device core that feed it. When 0 neither exists.
+ */
+#define CUSB_CFG_LOAD                       1
+#endif
+
+#ifndef CUSB_CFG_RTT
+/**
+ * @brief In-memory trace sink of @ref cusb/rtt.h. Needs 32-bit lock-free
+ * atomics.
+ */
+#define CUSB_CFG_RTT                        1
+#endif
+
+#ifndef CUSB_CFG_TRACE_RTT
+/**
+ * @brief The library defines @ref cusb_trace() and sends trace points
+ * to a @ref cusb_rtt. Needs @ref CUSB_CFG_TRACE and @ref CUSB_CFG_RTT.
+ */
+#define CUSB_CFG_TRACE_RTT                  0
+#endif
+/**@}*/
+
+/**
+ * @brief Largest bulk max packet size allowed at @ref CUSB_CFG_SPEED.
+ */
+#if (CUSB_CFG_SPEED == CUSB_SPEED_HIGH)
+#define CUSB_CFG_BULK_SIZE_MAX              (512U)
+#else
+#define CUSB_CFG_BULK_SIZE_MAX              (64U)
+#endif
+
+/*------------------------------------------------------------*/
+/*------------------------- VALIDATION -----------------------*/
+/*------------------------------------------------------------*/
+
+#if (CUSB_CFG_SPEED != CUSB_SPEED_FULL) && (CUSB_CFG_SPEED != CUSB_SPEED_HIGH)
+#error "CUSB_CFG_SPEED must be CUSB_SPEED_FULL or CUSB_SPEED_HIGH."
+#endif
+
+#if (CUSB_CFG_ENDPOINTS < 1) || (CUSB_CFG_ENDPOINTS > 16)
+#error "CUSB_CFG_ENDPOINTS must be 1 to 16."
+#endif
+
+#if (CUSB_CFG_EP0_SIZE != 8) && (CUSB_CFG_EP0_SIZE != 16) && (CUSB_CFG_EP0_SIZE != 32) && (CUSB_CFG_EP0_SIZE != 64)
+#error "CUSB_CFG_EP0_SIZE must be 8, 16, 32 or 64."
+#endif
+
+#if (CUSB_CFG_MSC_UAS || CUSB_CFG_BLOCKCACHE) && !(CUSB_CFG_MSC)
+#error "CUSB_CFG_MSC_UAS and CUSB_CFG_BLOCKCACHE need CUSB_CFG_MSC."
+#endif
+
+#if (CUSB_CFG_RNDIS) && !(CUSB_CFG_PKTPOOL)
+#error "CUSB_CFG_RNDIS needs CUSB_CFG_PKTPOOL."
+#endif
+
+#if (CUSB_CFG_SCSI_LUN_MAX < 1) || (CUSB_CFG_SCSI_LUN_MAX > 16)
+#error "CUSB_CFG_SCSI_LUN_MAX must be 1 to 16."
+#endif
+
+#if (CUSB_CFG_UAS_PENDING_MAX < 1) || (CUSB_CFG_UAS_PENDING_MAX > 255)
+#error "CUSB_CFG_UAS_PENDING_MAX must be 1 to 255."
+#endif
+
+#if (CUSB_CFG_MIDI_CABLES < 1) || (CUSB_CFG_MIDI_CABLES > 16)
+#error "CUSB_CFG_MIDI_CABLES must be 1 to 16."
+#endif
+
+#if (CUSB_CFG_ASSERT_LEVEL > CUSB_ASSERT_LEVEL_PACKET)
+#error "CUSB_CFG_ASSERT_LEVEL must be one of the CUSB_ASSERT_LEVEL_ values."
+#endif
+
+#if (CUSB_CFG_TRACE_RTT) && !(CUSB_CFG_TRACE && CUSB_CFG_RTT)
+#error "CUSB_CFG_TRACE_RTT needs CUSB_CFG_TRACE and CUSB_CFG_RTT."
+#endif
+
+#if (CUSB_CFG_LOAD_HISTORY < 1) || (CUSB_CFG_LOAD_HISTORY > 255)
+#error "CUSB_CFG_LOAD_HISTORY must be 1 to 255."
+#endif
+
+#endif /* CUSB_CONFIG_H_ */
@@ -0,0 +1,159 @@
+/**
+ * @file
+ * @brief Incremental CRC-32 (IEEE 802.3, reflected, poly 0x04C11DB7) used
+ * to verify DFU and storage images while they are being received.
+ * @details The checksum is updated block by block as data streams in so an
+ * image never has to be read back out of flash for a second verification
+ * pass. The same result as zlib's crc32() is produced regardless of the
+ * backend that is compiled in:
+ *      - STM32 on-chip CRC unit. Selected when CUSB_CRC32_STM32 is defined
+ *      (CMake does this automatically when cross compiling for an STM32 MCU).
+ *      The application is responsible for enabling the CRC peripheral clock
+ *      in RCC before any CRC is computed.
+ *      - PCLMULQDQ carry-less multiply folding. Used automatically on x86_64
+ *      hosts whose CPU supports it.
+ *      - Slicing-by-8 table lookup. Portable fallback for everything else.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_CRC32_H_
+#define CUSB_CRC32_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Defined to 1 if this build contains the PCLMULQDQ backend.
+ * Only x86_64 GCC-compatible builds qualify. Whether the running CPU
+ * actually supports the instruction is still checked at runtime.
+ */
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(CUSB_CRC32_STM32)
+#define CUSB_CRC32_HAS_PCLMUL 1
+#else
+#define CUSB_CRC32_HAS_PCLMUL 0
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Running CRC-32 calculation. Each image being verified
+ * gets its own instance so a DFU download and a mass storage write
+ * can be checked at the same time.
+ */
+struct cusb_crc32
+{
+    /// @private Bit-inverted running CRC. Only modify through API.
+    uint32_t state;
+};
+
+/*------------------------------------------------------------*/
+/*-------------------- CRC32 MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief CRC32 constructor. Starts a new calculation.
+ *
+ * @param me CRC32 to construct.
+ */
+extern void cusb_crc32_ctor(struct cusb_crc32 *me);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_crc32_ctor().
+ * @brief Feeds the next block of the image into the calculation.
+ * Blocks can be any size and alignment, so this can be called directly
+ * with each DFU block or storage sector as it is received.
+ *
+ * @param me CRC32 to update.
+ * @param data Next block. Can be NULL if @p len is 0.
+ * @param len Number of bytes in @p data.
+ */
+extern void cusb_crc32_update(struct cusb_crc32 *me, const void *data, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_crc32_ctor().
+ * @brief Returns the CRC of all data fed so far. This does not
+ * end the calculation - more data can still be added afterwards.
+ *
+ * @param me CRC32 to read.
+ */
+extern uint32_t cusb_crc32_value(const struct cusb_crc32 *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_crc32_ctor().
+ * @brief Returns true if the CRC of all data fed so far equals
+ * @p expected. False otherwise.
+ *
+ * @param me CRC32 to check.
+ * @param expected CRC the image is supposed to have, i.e. taken
+ * from the image's header or trailer.
+ */
+extern bool cusb_crc32_verify(const struct cusb_crc32 *me, uint32_t expected);
+/**@}*/
+
+/**
+ * @name Backends
+ * Raw backend entry points. Applications normally use the
+ * member functions instead. These are exposed so benchmarks
+ * can compare the implementations directly. @p crc is the
+ * bit-inverted running state and the new bit-inverted state
+ * is returned.
+ */
+/**@{*/
+/**
+ * @brief Portable slicing-by-8 backend. Always available. Runs a byte at
+ * a time when @ref CUSB_CFG_CRC32_SLICE8 is 0.
+ */
+extern uint32_t cusb_crc32_slice8(uint32_t crc, const void *data, size_t len);
+
+#if (CUSB_CRC32_HAS_PCLMUL)
+/**
+ * @brief Returns true if the running CPU supports the PCLMULQDQ backend.
+ */
+extern bool cusb_crc32_pclmul_supported(void);
+
+/**
+ * @pre @ref cusb_crc32_pclmul_supported() returned true.
+ * @brief x86_64 PCLMULQDQ folding backend.
+ */
+extern uint32_t cusb_crc32_pclmul(uint32_t crc, const void *data, size_t len);
+#endif
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_CRC32_H_ */
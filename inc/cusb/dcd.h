@@ -0,0 +1,277 @@
+/**
+ * @file
+ * @brief Device controller driver (DCD) interface. The only part of the
+ * stack that touches controller registers.
+ * @details A driver wraps its controller in a @ref cusb_dcd and fills in
+ * a @ref cusb_dcd_api. The device core calls the API to connect, open
+ * endpoints and start transfers. The driver reports what happened on the
+ * bus back to the core through the cusb_dcd_*() event functions below,
+ * and only from inside its @ref cusb_dcd_api.service function.
+ *
+ * Service reads the controller's status registers and reports at most
+ * budget events. It is the whole interrupt handler in interrupt mode and
+ * what @ref cusb_poll() calls in polled mode, so a driver has exactly one
+ * code path for both. In polled mode the core masks the controller
+ * interrupt with @ref cusb_dcd_api.irq_enable and events simply wait in
+ * the status registers until the next poll.
+ *
+ * Transfers are multi-packet. An endpoint armed with len bytes completes
+ * once len bytes moved or, for OUT, a short packet arrived. A zero length
+ * IN transfer sends a zero length packet. The driver never adds one by
+ * itself.
+ *
+ * A driver whose controller moves endpoint data by DMA declares what its
+ * engine needs with @ref cusb_dcd_set_dma(). The core then checks every
+ * transfer against it before @ref cusb_dcd_api.ep_xfer sees it, and does
+ * the data cache maintenance the application set up with
+ * cusb_device_set_cache(), so drivers never touch the cache. EP0 is
+ * exempt: control transfers use small core buffers and descriptors in
+ * flash, so drivers move EP0 data by CPU or through a bounce buffer of
+ * their own. For every other endpoint the buffer belongs to the engine
+ * from ep_xfer until the completion is reported:
+ *      - Neither the application nor the driver reads or writes it. An
+ *      IN buffer changed in that time may go out half old, half new.
+ *      - ep_close and a bus reset stop the engine before they return, so
+ *      nothing is written to a buffer after its endpoint closed.
+ *      - The completion is reported only once the last byte reached
+ *      memory, not when the last packet was acknowledged on the bus.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_DCD_H_
+#define CUSB_DCD_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Direction bit of an endpoint address. Set for IN.
+ */
+#define CUSB_EP_DIR_IN                      (0x80U)
+
+/**
+ * @brief Returns the endpoint number of endpoint address @p ep.
+ */
+#define CUSB_EP_NUM(ep)                     ((uint8_t)((ep) & 0x0FU))
+
+/**
+ * @brief Returns true if @p ep is an IN endpoint address.
+ */
+#define CUSB_EP_IS_IN(ep)                   (((ep) & CUSB_EP_DIR_IN) != 0U)
+
+/**
+ * @name Endpoint Types
+ * bmAttributes transfer types.
+ */
+/**@{*/
+#define CUSB_EP_CONTROL                     (0U)
+#define CUSB_EP_ISOCHRONOUS                 (1U)
+#define CUSB_EP_BULK                        (2U)
+#define CUSB_EP_INTERRUPT                   (3U)
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+struct cusb_device;
+
+/**
+ * @brief What a DMA engine requires of endpoint buffers. Power of two
+ * sizes throughout.
+ */
+struct cusb_dcd_dma
+{
+    /// @brief Buffer address alignment in bytes, i.e. 4 for word-wide
+    /// engines. 1 for none.
+    uint16_t align;
+
+    /// @brief OUT transfer lengths are a multiple of this many bytes,
+    /// as engines that write whole words or bursts may fill the rest of
+    /// the last one. 1 for none.
+    uint16_t granule;
+
+    /// @brief Longest transfer in bytes the engine moves in one go.
+    uint32_t max_len;
+};
+
+/**
+ * @brief Driver functions. All are called from the context the
+ * application runs the stack in, never concurrently.
+ */
+struct cusb_dcd_api
+{
+    /// @brief Enables (@p on true) or disables the D+ or D- pull-up.
+    void (*connect)(void *ctx, bool on);
+
+    /// @brief Called in the SETUP stage of SET_ADDRESS. The driver
+    /// applies @p addr when its controller requires, i.e. only after the
+    /// status stage completed.
+    void (*set_address)(void *ctx, uint8_t addr);
+
+    /// @brief Opens endpoint address @p ep. EP0 is opened by the driver on
+    /// bus reset and never passed here.
+    void (*ep_open)(void *ctx, uint8_t ep, uint8_t type, uint16_t mps);
+
+    /// @brief Closes endpoint address @p ep, cancelling any transfer.
+    void (*ep_close)(void *ctx, uint8_t ep);
+
+    /// @brief Arms endpoint address @p ep for a transfer of @p len bytes.
+    /// @p buf stays owned by the driver until the transfer completes. IN
+    /// transfers only read it.
+    void (*ep_xfer)(void *ctx, uint8_t ep, uint8_t *buf, uint32_t len);
+
+    /// @brief Sets or clears the halt condition of endpoint address
+    /// @p ep. Clearing also resets the data toggle. A stalled EP0 clears
+    /// itself on the next SETUP.
+    void (*ep_stall)(void *ctx, uint8_t ep, bool stall);
+
+    /// @brief Reads the status registers and reports up to @p budget
+    /// events with the cusb_dcd_*() functions. Returns how many it
+    /// reported.
+    size_t (*service)(void *ctx, size_t budget);
+
+    /// @brief Unmasks (@p on true) or masks the controller interrupt.
+    void (*irq_enable)(void *ctx, bool on);
+};
+
+/**
+ * @brief Device controller. Embedded in the driver's own struct. Only
+ * modify through API.
+ */
+struct cusb_dcd
+{
+    /// @private Driver functions.
+    const struct cusb_dcd_api *api;
+
+    /// @private Passed to every driver function.
+    void *ctx;
+
+    /// @private Device core events go to. Set by @ref cusb_device_ctor().
+    struct cusb_device *dev;
+
+#if (CUSB_CFG_DMA)
+    /// @private Buffer constraints, NULL if the driver does not use DMA.
+    const struct cusb_dcd_dma *dma;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- DCD MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Called by the driver's own constructor.
+ *
+ * @param me Controller to construct.
+ * @param api Driver functions. Must remain valid for the lifetime of @p me.
+ * @param ctx Passed to every driver function. Optional, can be NULL.
+ */
+extern void cusb_dcd_ctor(struct cusb_dcd *me, const struct cusb_dcd_api *api, void *ctx);
+/**@}*/
+
+#if (CUSB_CFG_DMA)
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_dcd_ctor().
+ * @brief Called by the driver's own constructor if it moves endpoint
+ * data by DMA. Only exists when @ref CUSB_CFG_DMA is 1.
+ *
+ * @param me Controller.
+ * @param dma Buffer constraints of the engine. Must remain valid for the
+ * lifetime of @p me.
+ */
+extern void cusb_dcd_set_dma(struct cusb_dcd *me, const struct cusb_dcd_dma *dma);
+/**@}*/
+#endif
+
+/**
+ * @name Events
+ * Called by the driver from its service function only.
+ */
+/**@{*/
+/**
+ * @brief Bus reset finished at @p speed. EP0 is open, every other
+ * endpoint closed and the address is 0.
+ *
+ * @param me Controller.
+ * @param speed @ref CUSB_SPEED_FULL or @ref CUSB_SPEED_HIGH.
+ */
+extern void cusb_dcd_bus_reset(struct cusb_dcd *me, uint8_t speed);
+
+/**
+ * @brief SETUP packet received on EP0. Any EP0 transfer in progress was
+ * cancelled by the controller.
+ *
+ * @param me Controller.
+ * @param setup The 8 byte packet. Only valid during the call.
+ */
+extern void cusb_dcd_setup(struct cusb_dcd *me, const uint8_t *setup);
+
+/**
+ * @brief Transfer on endpoint address @p ep completed.
+ *
+ * @param me Controller.
+ * @param ep Endpoint address.
+ * @param len Bytes transferred.
+ * @param ok False if the transfer failed, i.e. an isochronous CRC error.
+ */
+extern void cusb_dcd_xfer_done(struct cusb_dcd *me, uint8_t ep, uint32_t len, bool ok);
+
+/**
+ * @brief Start of frame.
+ *
+ * @param me Controller.
+ * @param frame Frame number, 11 bits.
+ */
+extern void cusb_dcd_sof(struct cusb_dcd *me, uint16_t frame);
+
+/**
+ * @brief Bus went idle for 3 ms.
+ *
+ * @param me Controller.
+ */
+extern void cusb_dcd_suspend(struct cusb_dcd *me);
+
+/**
+ * @brief Bus activity resumed after a suspend.
+ *
+ * @param me Controller.
+ */
+extern void cusb_dcd_resume(struct cusb_dcd *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_DCD_H_ */
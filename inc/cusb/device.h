@@ -0,0 +1,790 @@
+/**
+ * @file
+ * @brief Device core. Answers the standard requests on the default
+ * control pipe, passes class and vendor requests to the application and
+ * routes endpoint completions to the classes that own the endpoints.
+ * @details The core sits on top of a controller driver, see
+ * @ref cusb/dcd.h, and runs in one of two modes picked at
+ * @ref cusb_device_start():
+ *
+ * - Interrupt mode. The controller interrupt is enabled and its handler
+ *   calls @ref cusb_isr(), which services every pending event.
+ * - Polled mode. The controller interrupt stays masked. The application
+ *   calls @ref cusb_poll() from its main loop or a task, which reads the
+ *   controller's status registers directly and services at most a given
+ *   number of events. No interrupt ever fires, so the stack cannot add
+ *   jitter to a control loop, and the budget bounds the time one poll
+ *   takes. Events left over wait in the controller for the next poll.
+ *
+ * Class callbacks run in whichever context services events: the handler
+ * in interrupt mode, the caller of @ref cusb_poll() in polled mode. The
+ * rest of the API must be called from that same context.
+ *
+ * Endpoints are opened from the configure callback once the host selects
+ * a configuration. Each gets either a completion callback or, with
+ * @ref CUSB_CFG_COALESCE, a @ref cusb_coalesce that is flushed at the end
+ * of every interrupt or poll pass.
+ *
+ * A device with more than one configuration, i.e. a low and a high power
+ * variant or a choice of functions, describes each with a
+ * @ref cusb_device_config built once at startup and passed to
+ * @ref cusb_device_set_configs(). Everything SET_CONFIGURATION needs is
+ * worked out then: the descriptor served, the endpoints to open and the
+ * class each one's completions go to. Selecting a configuration only
+ * looks it up and swaps the device's active configuration pointer before
+ * the endpoints are opened from its table, so it never parses a
+ * descriptor or allocates, and completions are dispatched through the
+ * active table directly.
+ *
+ * For tickless idle, @ref cusb_device_next_deadline() tells how long the
+ * CPU may sleep before the stack needs it again: until the next software
+ * timer expires, until the next slot of a periodic endpoint in polled
+ * mode, or only when an interrupt arrives. Time is an application
+ * supplied free running microsecond count that may wrap.
+ *
+ * @code
+ * for (;;)
+ * {
+ *     (void)cusb_poll(&dev, 8);    // Polled mode only.
+ *     cusb_device_run_timers(&dev, now_us());
+ *
+ *     uint32_t wait = cusb_device_next_deadline(&dev, now_us());
+ *     if (wait == CUSB_DEADLINE_NONE)
+ *         sleep_until_interrupt();
+ *     else
+ *         sleep_until_interrupt_or(wait);
+ * }
+ * @endcode
+ *
+ * In interrupt mode mask the controller interrupt around the timer and
+ * deadline calls, since its handler may start timers too. In polled mode
+ * the controller interrupt can still wake the CPU without running a
+ * handler (WFE with SEVONPEND on Cortex-M), so a SETUP is answered
+ * promptly even when no deadline is pending.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_DEVICE_H_
+#define CUSB_DEVICE_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* CUSB. */
+#include "cusb/coalesce.h"
+#include "cusb/dcd.h"
+#include "cusb/load.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Device States
+ * Values returned by @ref cusb_device_get_state().
+ */
+/**@{*/
+#define CUSB_DEVICE_DETACHED                (0U)    /**< Not started or no bus reset seen yet. */
+#define CUSB_DEVICE_DEFAULT                 (1U)    /**< Reset, address 0. */
+#define CUSB_DEVICE_ADDRESS                 (2U)    /**< Address assigned, not configured. */
+#define CUSB_DEVICE_CONFIGURED              (3U)    /**< Configuration selected. */
+/**@}*/
+
+/**
+ * @name Bus Events
+ * Passed to @ref cusb_device_callbacks.event.
+ */
+/**@{*/
+#define CUSB_DEVICE_EVENT_RESET             (0U)
+#define CUSB_DEVICE_EVENT_SUSPEND           (1U)
+#define CUSB_DEVICE_EVENT_RESUME            (2U)
+/**@}*/
+
+/**
+ * @brief Returned by @ref cusb_device_next_deadline() when the stack only
+ * needs the CPU once an interrupt arrives.
+ */
+#define CUSB_DEADLINE_NONE                  (UINT32_MAX)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Descriptors the core serves for GET_DESCRIPTOR. All are in
+ * wire format and served in place, so they can live in flash.
+ */
+struct cusb_device_descriptors
+{
+    /// @brief Device descriptor, 18 bytes. bMaxPacketSize0 must equal
+    /// @ref CUSB_CFG_EP0_SIZE.
+    const uint8_t *device;
+
+    /// @brief Configuration descriptor followed by its interface,
+    /// endpoint and class descriptors, wTotalLength bytes. Only used by
+    /// devices with a single configuration, can be NULL if
+    /// @ref cusb_device_set_configs() is called instead.
+    const uint8_t *config;
+
+    /// @brief Device qualifier, 10 bytes. Optional, NULL for full-speed
+    /// only devices.
+    const uint8_t *qualifier;
+
+    /// @brief String descriptors by index, [0] being the language IDs.
+    /// Optional, NULL if @ref nstrings is 0.
+    const uint8_t *const *strings;
+
+    /// @brief Elements in @ref strings.
+    uint8_t nstrings;
+};
+
+/**
+ * @brief Application callbacks. Every member is optional and can be
+ * NULL.
+ */
+struct cusb_device_callbacks
+{
+    /// @brief Host selected configuration @p config, or 0 when the
+    /// device was deconfigured or reset. Every endpoint was closed
+    /// beforehand, then the configuration's bindings opened, if any.
+    /// Open its other endpoints and start the first transfers here.
+    /// Return false to reject the request.
+    bool (*configure)(void *obj, uint8_t config);
+
+    /// @brief Class or vendor request, a standard request for an
+    /// interface, or GET_DESCRIPTOR for a type the core does not serve.
+    /// @p setup is the 8 byte packet. For a request with an IN data
+    /// stage point @p data at the response and set @p len. The core
+    /// truncates it to wLength. For an OUT data stage point @p data at a
+    /// buffer of at least wLength bytes and set @p len to its size.
+    /// @ref control_out is called once it is filled. The buffer must
+    /// stay valid until then. Return false to stall the request.
+    bool (*control)(void *obj, const uint8_t *setup, uint8_t **data, uint16_t *len);
+
+    /// @brief OUT data stage of a request accepted by @ref control
+    /// arrived in its buffer. Return false to stall the status stage.
+    bool (*control_out)(void *obj, const uint8_t *setup, const uint8_t *data, uint16_t len);
+
+    /// @brief Bus reset, suspend or resume, see the bus events above.
+    void (*event)(void *obj, uint8_t event);
+
+    /// @brief Start of frame with the 11 bit frame number.
+    void (*sof)(void *obj, uint16_t frame);
+};
+
+/**
+ * @brief Data cache maintenance of the CPU, for controllers that move
+ * endpoint data by DMA. On a Cortex-M7 these wrap
+ * SCB_CleanDCache_by_Addr() and SCB_InvalidateDCache_by_Addr().
+ */
+struct cusb_device_cache
+{
+    /// @brief Writes dirty lines covering @p len bytes at @p addr back
+    /// to memory.
+    void (*clean)(void *obj, const void *addr, size_t len);
+
+    /// @brief Discards lines covering @p len bytes at @p addr without
+    /// writing them back.
+    void (*invalidate)(void *obj, void *addr, size_t len);
+
+    /// @brief Cache line size in bytes, a power of two.
+    uint16_t line;
+};
+
+/**
+ * @brief Device statistics. Counters wrap around.
+ */
+struct cusb_device_stats
+{
+    /// @brief Calls to @ref cusb_isr().
+    uint32_t interrupts;
+
+    /// @brief Calls to @ref cusb_poll().
+    uint32_t polls;
+
+    /// @brief Polls that used up their budget, i.e. may have left
+    /// events pending.
+    uint32_t polls_exhausted;
+
+    /// @brief Controller events serviced in either mode.
+    uint32_t events;
+
+    /// @brief SETUP packets received.
+    uint32_t setups;
+
+    /// @brief Control requests stalled.
+    uint32_t stalls;
+};
+
+/**
+ * @brief Endpoint of a configuration and the class that owns it. Opened
+ * by the core when the host selects the configuration, see
+ * @ref cusb_device_config_ctor().
+ */
+struct cusb_device_binding
+{
+    /// @brief Endpoint address, 1 to @ref CUSB_CFG_ENDPOINTS - 1,
+    /// direction bit included.
+    uint8_t ep;
+
+    /// @brief Transfer type, see @ref cusb/dcd.h.
+    uint8_t type;
+
+    /// @brief Max packet size.
+    uint16_t mps;
+
+    /// @brief Completion callback, as for @ref cusb_device_ep_open().
+    /// NULL if @ref coalesce is set.
+    void (*done)(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok);
+
+    /// @brief Passed to @ref done.
+    void *obj;
+
+    /// @brief Coalescer completions are posted to instead, as for
+    /// @ref cusb_device_ep_open_coalesced(). Must be NULL unless
+    /// @ref CUSB_CFG_COALESCE is 1.
+    struct cusb_coalesce *coalesce;
+};
+
+/**
+ * @brief Configuration precomputed by @ref cusb_device_config_ctor().
+ * Only modify through API.
+ */
+struct cusb_device_config
+{
+    /// @private Configuration descriptor, served in place.
+    const uint8_t *desc;
+
+    /// @private Endpoints opened when selected.
+    const struct cusb_device_binding *bindings;
+
+    /// @private wTotalLength of @ref desc.
+    uint16_t total_length;
+
+    /// @private Bus current allowed once selected, in mA.
+    uint16_t max_power_ma;
+
+    /// @private bConfigurationValue.
+    uint8_t value;
+
+    /// @private Reported by GET_STATUS.
+    bool self_powered;
+
+    /// @private Elements in @ref bindings.
+    uint8_t nbindings;
+
+    /// @private bInterval of each endpoint in @ref desc by
+    /// [direction][number], the first one if several alternate settings
+    /// use the address. 0 if not described.
+    uint8_t binterval[2][CUSB_CFG_ENDPOINTS];
+};
+
+/**
+ * @private
+ * @brief One endpoint direction. Only modify through API.
+ */
+struct cusb_device_ep
+{
+    /// @private Where completions go while open. Either @ref own or an
+    /// element of the active configuration's bindings.
+    const struct cusb_device_binding *binding;
+
+    /// @private Binding of an endpoint opened by the application.
+    struct cusb_device_binding own;
+
+    /// @private Buffer of the transfer in progress.
+    uint8_t *buf;
+
+    /// @private Endpoint is open.
+    bool open;
+
+    /// @private Transfer in progress.
+    bool busy;
+
+    /// @private Service interval in microseconds of an isochronous or
+    /// interrupt endpoint. 0 for bulk.
+    uint32_t interval_us;
+
+    /// @private Endpoint is halted.
+    bool stalled;
+};
+
+/**
+ * @brief One shot software timer run by the device. Only modify through
+ * API.
+ */
+struct cusb_timer
+{
+    /// @private Next armed timer, later expiry.
+    struct cusb_timer *next;
+
+    /// @private Expiry time in microseconds.
+    uint32_t expiry;
+
+    /// @private Called once expired.
+    void (*callback)(void *obj);
+
+    /// @private Passed to @ref callback.
+    void *obj;
+
+    /// @private Timer is in the device's list.
+    bool armed;
+};
+
+/**
+ * @brief Device. Only modify through API.
+ */
+struct cusb_device
+{
+    /// @private Controller driver.
+    struct cusb_dcd *dcd;
+
+    /// @private Descriptors served to the host.
+    const struct cusb_device_descriptors *desc;
+
+    /// @private Configurations by index, as served by GET_DESCRIPTOR.
+    const struct cusb_device_config *configs;
+
+    /// @private Configuration selected, NULL if none.
+    const struct cusb_device_config *active;
+
+    /// @private Built from @ref cusb_device_descriptors.config if the
+    /// application passes no configurations of its own.
+    struct cusb_device_config single;
+
+    /// @private Application callbacks.
+    const struct cusb_device_callbacks *callbacks;
+
+    /// @private Passed to every callback.
+    void *obj;
+
+    /// @private Endpoints by [direction][number], OUT first. Index 0 of
+    /// each is the control pipe, handled by the core.
+    struct cusb_device_ep ep[2][CUSB_CFG_ENDPOINTS];
+
+    /// @private SETUP packet of the control transfer in progress.
+    uint8_t setup[8];
+
+    /// @private Data stage buffer of the control transfer in progress.
+    uint8_t *ctl_data;
+
+    /// @private Control transfer stage.
+    uint8_t ctl_stage;
+
+    /// @private IN data stage ends on a full packet shorter than wLength
+    /// so a zero length packet follows.
+    bool ctl_zlp;
+
+    /// @private Answers of GET_STATUS and GET_CONFIGURATION.
+    uint8_t ctl_buf[2];
+
+    /// @private One of the device states above.
+    uint8_t state;
+
+    /// @private Address of the last SET_ADDRESS. @ref state follows it
+    /// once the status stage completed.
+    uint8_t address;
+
+    /// @private Elements in @ref configs.
+    uint8_t nconfigs;
+
+    /// @private Speed of the last bus reset.
+    uint8_t speed;
+
+    /// @private Bus is suspended.
+    bool suspended;
+
+    /// @private Host enabled remote wakeup.
+    bool remote_wakeup;
+
+    /// @private Started in polled mode.
+    bool polled;
+
+    /// @private Last poll used up its budget.
+    bool backlog;
+
+    /// @private Armed timers, earliest first.
+    struct cusb_timer *timers;
+
+#if (CUSB_CFG_COALESCE)
+    /// @private Endpoints whose coalescer got completions this pass. Bit
+    /// n for OUT n, bit 16 + n for IN n.
+    uint32_t coalesce_dirty;
+#endif
+
+#if (CUSB_CFG_STATS)
+    /// @private Statistics.
+    struct cusb_device_stats stats;
+#endif
+
+#if (CUSB_CFG_LOAD)
+    /// @private Load accounting, NULL if none.
+    struct cusb_load *load;
+#endif
+
+#if (CUSB_CFG_DMA)
+    /// @private Cache maintenance around DMA transfers, NULL if none.
+    const struct cusb_device_cache *cache;
+
+    /// @private Passed to the functions of @ref cache.
+    void *cache_obj;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*-------------------- DEVICE MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me. @p dcd constructed by its
+ * driver.
+ * @brief Constructor. The device stays detached until
+ * @ref cusb_device_start().
+ *
+ * @param me Device to construct.
+ * @param dcd Controller driver. Reports its events to @p me from now on.
+ * @param desc Descriptors. Must remain valid for the lifetime of @p me.
+ * @param callbacks Application callbacks. Must remain valid for the
+ * lifetime of @p me.
+ * @param obj Passed to every callback. Optional, can be NULL.
+ */
+extern void cusb_device_ctor(struct cusb_device *me,
+                             struct cusb_dcd *dcd,
+                             const struct cusb_device_descriptors *desc,
+                             const struct cusb_device_callbacks *callbacks,
+                             void *obj);
+
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Precomputes configuration @p desc for
+ * @ref cusb_device_set_configs(). Endpoints not in @p bindings can still
+ * be opened from the configure callback.
+ *
+ * @param me Configuration to construct.
+ * @param desc Configuration descriptor followed by its interface,
+ * endpoint and class descriptors. bConfigurationValue must not be 0.
+ * Must remain valid for the lifetime of @p me.
+ * @param bindings Endpoints opened before the configure callback runs,
+ * each one described in @p desc and bound once. Must remain valid for
+ * the lifetime of @p me. Optional, can be NULL if @p nbindings is 0.
+ * @param nbindings Elements in @p bindings.
+ */
+extern void cusb_device_config_ctor(struct cusb_device_config *me,
+                                    const uint8_t *desc,
+                                    const struct cusb_device_binding *bindings,
+                                    uint8_t nbindings);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Picks the mode and connects to the bus.
+ *
+ * @param me Device.
+ * @param polled True for polled mode: the controller interrupt stays
+ * masked and the application calls @ref cusb_poll(). False for interrupt
+ * mode: the interrupt is enabled and its handler calls @ref cusb_isr().
+ */
+extern void cusb_device_start(struct cusb_device *me, bool polled);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor() and not
+ * started. Every element of @p configs constructed.
+ * @brief Serves @p configs instead of
+ * @ref cusb_device_descriptors.config. The host reads them by index and
+ * selects one by its bConfigurationValue.
+ *
+ * @param me Device.
+ * @param configs Configurations, bNumConfigurations of them, each with
+ * its own bConfigurationValue. Must remain valid for the lifetime of
+ * @p me.
+ * @param nconfigs Elements in @p configs, at least 1.
+ */
+extern void cusb_device_set_configs(struct cusb_device *me, const struct cusb_device_config *configs, uint8_t nconfigs);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Disconnects from the bus and masks the controller interrupt.
+ *
+ * @param me Device.
+ */
+extern void cusb_device_stop(struct cusb_device *me);
+
+/**
+ * @pre @p me started in polled mode.
+ * @brief Services at most @p budget pending controller events, then
+ * flushes the coalescers that received completions. Returns the number
+ * of events serviced. If it equals @p budget more may be pending.
+ *
+ * @param me Device.
+ * @param budget Most events to service, at least 1. SIZE_MAX services
+ * all of them.
+ */
+extern size_t cusb_poll(struct cusb_device *me, size_t budget);
+
+/**
+ * @pre @p me started in interrupt mode.
+ * @brief Body of the controller interrupt handler. Services every
+ * pending event, then flushes the coalescers that received completions.
+ *
+ * @param me Device.
+ */
+extern void cusb_isr(struct cusb_device *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Opens endpoint address @p ep. Completions of its transfers are
+ * passed to @p done. Call from the configure callback.
+ *
+ * @param me Device.
+ * @param ep Endpoint address, 1 to @ref CUSB_CFG_ENDPOINTS - 1, direction
+ * bit included.
+ * @param type Transfer type, see @ref cusb/dcd.h.
+ * @param mps Max packet size.
+ * @param done Called with the endpoint address, the buffer, the bytes
+ * transferred and false on error. The endpoint is idle again when it
+ * runs, so it may start the next transfer.
+ * @param obj Passed to @p done. Optional, can be NULL.
+ */
+extern void cusb_device_ep_open(struct cusb_device *me,
+                                uint8_t ep,
+                                uint8_t type,
+                                uint16_t mps,
+                                void (*done)(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok),
+                                void *obj);
+
+#if (CUSB_CFG_COALESCE)
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @p coalesce constructed.
+ * @brief Opens endpoint address @p ep with its completions posted to
+ * @p coalesce. Several endpoints can share one coalescer. Transfers on
+ * it must be at most 65535 bytes. Only exists when
+ * @ref CUSB_CFG_COALESCE is 1.
+ *
+ * @param me Device.
+ * @param ep Endpoint address, direction bit included.
+ * @param type Transfer type, see @ref cusb/dcd.h.
+ * @param mps Max packet size.
+ * @param coalesce Coalescer completions are posted to.
+ */
+extern void cusb_device_ep_open_coalesced(struct cusb_device *me,
+                                          uint8_t ep,
+                                          uint8_t type,
+                                          uint16_t mps,
+                                          struct cusb_coalesce *coalesce);
+#endif
+
+/**
+ * @pre @p ep opened.
+ * @brief Closes endpoint address @p ep, cancelling its transfer without
+ * a completion.
+ *
+ * @param me Device.
+ * @param ep Endpoint address.
+ */
+extern void cusb_device_ep_close(struct cusb_device *me, uint8_t ep);
+
+/**
+ * @pre @p ep opened.
+ * @brief Starts a transfer of @p len bytes on endpoint address @p ep.
+ * Returns false without starting it if one is already in progress.
+ *
+ * @param me Device.
+ * @param ep Endpoint address.
+ * @param buf Data to send, or where received data goes. Owned by the
+ * driver until the transfer completes. With a DMA driver it meets the
+ * driver's @ref cusb_dcd_dma constraints, and with a cache also starts
+ * on a cache line if @p ep is OUT.
+ * @param len Bytes to send or most bytes to receive. With a DMA driver
+ * and @p ep OUT, a multiple of its granule and, with a cache, of the
+ * cache line.
+ */
+extern bool cusb_device_ep_xfer(struct cusb_device *me, uint8_t ep, uint8_t *buf, uint32_t len);
+
+/**
+ * @pre @p ep opened.
+ * @brief Halts (@p stall true) or resumes endpoint address @p ep.
+ *
+ * @param me Device.
+ * @param ep Endpoint address.
+ * @param stall True to halt.
+ */
+extern void cusb_device_ep_stall(struct cusb_device *me, uint8_t ep, bool stall);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Returns true if a transfer is in progress on endpoint address
+ * @p ep.
+ *
+ * @param me Device.
+ * @param ep Endpoint address.
+ */
+extern bool cusb_device_ep_busy(const struct cusb_device *me, uint8_t ep);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Returns one of the device states above.
+ *
+ * @param me Device.
+ */
+extern uint8_t cusb_device_get_state(const struct cusb_device *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Returns the selected bConfigurationValue, 0 if not configured.
+ *
+ * @param me Device.
+ */
+extern uint8_t cusb_device_get_config(const struct cusb_device *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Returns the bus current in mA the selected configuration
+ * declares, from its bMaxPower. 0 if not configured, in which case the
+ * device may draw one unit load at most.
+ *
+ * @param me Device.
+ */
+extern uint16_t cusb_device_get_max_power(const struct cusb_device *me);
+
+#if (CUSB_CFG_DMA)
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Sets up cache maintenance for a controller that moves endpoint
+ * data by DMA. Needed on CPUs with a data cache unless every endpoint
+ * buffer lives in memory the cache does not cover, i.e. DTCM or a
+ * region the MPU marks non-cacheable. Has no effect with drivers that do
+ * not use DMA. Only exists when @ref CUSB_CFG_DMA is 1.
+ *
+ * IN buffers are cleaned when the transfer starts. OUT buffers are
+ * invalidated when it starts, so no dirty line is evicted over the
+ * received data, and again for the bytes received when it completes,
+ * since the CPU may have speculatively loaded lines in between.
+ *
+ * @param me Device.
+ * @param cache Maintenance functions. Must remain valid for the lifetime
+ * of @p me. NULL for none.
+ * @param obj Passed to the functions of @p cache. Optional, can be NULL.
+ */
+extern void cusb_device_set_cache(struct cusb_device *me, const struct cusb_device_cache *cache, void *obj);
+#endif
+
+#if (CUSB_CFG_STATS)
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Returns the statistics. Only exists when @ref CUSB_CFG_STATS
+ * is 1.
+ *
+ * @param me Device.
+ */
+extern const struct cusb_device_stats *cusb_device_get_stats(const struct cusb_device *me);
+#endif
+
+#if (CUSB_CFG_LOAD)
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Charges the time spent in @ref cusb_isr(), @ref cusb_poll(),
+ * @ref cusb_device_run_timers() and every callback they make to @p load.
+ * Only exists when @ref CUSB_CFG_LOAD is 1.
+ *
+ * @param me Device.
+ * @param load Accounting, NULL to stop. Must remain valid while set.
+ */
+extern void cusb_device_set_load(struct cusb_device *me, struct cusb_load *load);
+#endif
+/**@}*/
+
+/**
+ * @name Timers And Tickless Idle
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Timer constructor.
+ *
+ * @param me Timer to construct.
+ * @param callback Called from @ref cusb_device_run_timers() once the
+ * timer expired. May start it again.
+ * @param obj Passed to @p callback. Optional, can be NULL.
+ */
+extern void cusb_timer_ctor(struct cusb_timer *me, void (*callback)(void *obj), void *obj);
+
+/**
+ * @pre @p timer constructed via @ref cusb_timer_ctor().
+ * @brief Starts @p timer to expire @p delay microseconds after @p now.
+ * Restarts it if already armed.
+ *
+ * @param me Device.
+ * @param timer Timer.
+ * @param now Current time in microseconds.
+ * @param delay Microseconds until expiry, less than 2^31.
+ */
+extern void cusb_device_timer_start(struct cusb_device *me, struct cusb_timer *timer, uint32_t now, uint32_t delay);
+
+/**
+ * @pre @p timer constructed via @ref cusb_timer_ctor().
+ * @brief Stops @p timer. Does nothing if it is not armed.
+ *
+ * @param me Device.
+ * @param timer Timer.
+ */
+extern void cusb_device_timer_stop(struct cusb_device *me, struct cusb_timer *timer);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Calls back every timer expired at @p now, earliest first.
+ *
+ * @param me Device.
+ * @param now Current time in microseconds.
+ */
+extern void cusb_device_run_timers(struct cusb_device *me, uint32_t now);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_device_ctor().
+ * @brief Returns the microseconds from @p now until the stack next needs
+ * the CPU, 0 if it needs it right away, or @ref CUSB_DEADLINE_NONE if
+ * only an interrupt can give it work. That is the earliest of:
+ *
+ * - the expiry of the first armed timer.
+ * - in polled mode, now if the last poll used up its budget.
+ * - in polled mode on an active bus, the shortest service interval of the
+ *   periodic endpoints with a transfer in flight, and the frame period if
+ *   a SOF callback is installed. Their events only reach the stack
+ *   through polls, which must keep up with the slots.
+ *
+ * @param me Device.
+ * @param now Current time in microseconds.
+ */
+extern uint32_t cusb_device_next_deadline(const struct cusb_device *me, uint32_t now);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_DEVICE_H_ */
@@ -0,0 +1,183 @@
+/**
+ * @file
+ * @brief Block device backed by a memory mapped disk image file, for
+ * running the mass storage stack on a Linux host.
+ * @details Meant for simulator builds and benchmarks, not for targets.
+ * The image is mapped shared, so the file always holds what the host
+ * wrote and a @ref CUSB_BLOCKDEV_SYNC only has to msync() the blocks
+ * written since the last one. The device implements the block device
+ * map function, so the SCSI target moves sector data straight between
+ * the mapping and the USB transfer buffers without going through its
+ * task buffer. Images of several GiB only cost the page cache the host
+ * actually touches.
+ *
+ * By default requests complete before submit returns. With a latency set
+ * requests are queued instead and @ref cusb_diskimage_poll() completes
+ * them once they are due, which models a real card or SSD and exercises
+ * the asynchronous paths of the transports. Completions then come from
+ * whatever context calls poll, usually the application's main loop, so
+ * no threads are involved.
+ *
+ * Only built when the target is Linux.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_DISKIMAGE_H_
+#define CUSB_DISKIMAGE_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Block device. */
+#include "cusb/blockdev.h"
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Most requests that can wait for their latency to pass.
+ */
+#define CUSB_DISKIMAGE_QUEUE_MAX            (32U)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Disk image block device. Only modify through API.
+ */
+struct cusb_diskimage
+{
+    /// @private Block device handed to the SCSI target.
+    struct cusb_blockdev dev;
+
+    /// @private Image file descriptor.
+    int fd;
+
+    /// @private Start of the mapping.
+    uint8_t *base;
+
+    /// @private Size of the mapping in bytes.
+    size_t size;
+
+    /// @private Request latency in nanoseconds. 0 completes synchronously.
+    uint64_t latency_ns;
+
+    /// @private Blocks written or mapped for writing since the last sync,
+    /// [dirty_first, dirty_end).
+    uint32_t dirty_first;
+
+    /// @private See @ref dirty_first.
+    uint32_t dirty_end;
+
+    /// @private Requests waiting for their latency to pass, in due order.
+    struct
+    {
+        struct cusb_blockdev_req *req;
+        uint64_t due;
+    } queue[CUSB_DISKIMAGE_QUEUE_MAX];
+
+    /// @private Oldest element of @ref queue.
+    uint8_t head;
+
+    /// @private Number of elements in @ref queue.
+    uint8_t count;
+};
+
+/*------------------------------------------------------------*/
+/*------------------ DISKIMAGE MEMBER FUNCTIONS --------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Opens and maps the image at @p path. Returns false if the file
+ * cannot be opened or mapped, is empty, is not a multiple of
+ * @p block_size or has more blocks than a block device can address.
+ *
+ * @param me Disk image to construct.
+ * @param path Image file.
+ * @param block_size Block size in bytes. A power of 2 and at least 512.
+ * @param read_only Opens the file read only and reports the media as
+ * write protected.
+ */
+extern bool cusb_diskimage_open(struct cusb_diskimage *me, const char *path,
+                                uint32_t block_size, bool read_only);
+
+/**
+ * @pre @p me previously opened via @ref cusb_diskimage_open() and no
+ * request is pending.
+ * @brief Syncs and unmaps the image.
+ *
+ * @param me Disk image.
+ */
+extern void cusb_diskimage_close(struct cusb_diskimage *me);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously opened via @ref cusb_diskimage_open().
+ * @brief Returns the block device to hand to the SCSI target.
+ *
+ * @param me Disk image.
+ */
+extern struct cusb_blockdev *cusb_diskimage_blockdev(struct cusb_diskimage *me);
+
+/**
+ * @pre @p me previously opened via @ref cusb_diskimage_open() and no
+ * request is pending.
+ * @brief Sets the time every request takes from submission to completion.
+ *
+ * @param me Disk image.
+ * @param latency_us Latency in microseconds. 0 completes requests
+ * synchronously, which is the default.
+ */
+extern void cusb_diskimage_set_latency(struct cusb_diskimage *me, uint32_t latency_us);
+
+/**
+ * @pre @p me previously opened via @ref cusb_diskimage_open().
+ * @brief Completes every request that is due. Returns the number of
+ * requests completed.
+ *
+ * @param me Disk image.
+ */
+extern size_t cusb_diskimage_poll(struct cusb_diskimage *me);
+
+/**
+ * @pre @p me previously opened via @ref cusb_diskimage_open().
+ * @brief Returns the number of requests waiting for their latency to pass.
+ *
+ * @param me Disk image.
+ */
+extern size_t cusb_diskimage_pending(const struct cusb_diskimage *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_DISKIMAGE_H_ */
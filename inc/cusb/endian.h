@@ -0,0 +1,197 @@
+/**
+ * @file
+ * @brief Loads and stores of 16 and 32-bit little and big endian values
+ * at any address. Protocol fields are read straight from packet buffers
+ * with these, without copying them into structs first.
+ * @details Each one is a fixed size memcpy() to or from a local and, where
+ * the target's byte order differs from the field's, a byte swap. GCC
+ * turns that into a single load or store, e.g. one LDRH for
+ * @ref cusb_get_le16() on Cortex-M3 and up, plus a REV16 on a big endian
+ * target. On cores without unaligned access, e.g. Cortex-M0, it becomes
+ * byte loads instead, so a misaligned field never faults.
+ *
+ * ECU's endian macros convert values already in registers. These also
+ * have to read them from unaligned bytes, so they do the conversion
+ * themselves.
+ *
+ * Defining CUSB_ENDIAN_EMULATE_BIG before this header makes it behave as
+ * on a big endian target, so host tests can exercise the swapping
+ * branches. Never define it in a real build.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_ENDIAN_H_
+#define CUSB_ENDIAN_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* STDLib. */
+#include <stdint.h>
+#include <string.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @private
+ * @brief 1 if the target is big endian.
+ */
+#if defined(CUSB_ENDIAN_EMULATE_BIG) || (defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__))
+#define CUSB_ENDIAN_BIG_                    1
+#else
+#define CUSB_ENDIAN_BIG_                    0
+#endif
+
+/**
+ * @private
+ * @brief Byte swaps. A single instruction where the target has one.
+ */
+/**@{*/
+#if defined(__GNUC__)
+#define CUSB_SWAP16_(v)                     __builtin_bswap16(v)
+#define CUSB_SWAP32_(v)                     __builtin_bswap32(v)
+#else
+#define CUSB_SWAP16_(v)                     ((uint16_t)(((v) >> 8) | ((v) << 8)))
+#define CUSB_SWAP32_(v)                     ((((v) >> 24) & 0xFFUL) | (((v) >> 8) & 0xFF00UL) | \
+                                             (((v) << 8) & 0xFF0000UL) | (((v) << 24) & 0xFF000000UL))
+#endif
+/**@}*/
+
+/**
+ * @private
+ * @brief What a target of the emulated byte order reads from and writes
+ * to memory. Plain on a real target.
+ */
+/**@{*/
+#if defined(CUSB_ENDIAN_EMULATE_BIG)
+#define CUSB_MEM16_(v)                      CUSB_SWAP16_(v)
+#define CUSB_MEM32_(v)                      CUSB_SWAP32_(v)
+#else
+#define CUSB_MEM16_(v)                      (v)
+#define CUSB_MEM32_(v)                      (v)
+#endif
+/**@}*/
+
+/**
+ * @private
+ * @brief Converts between the target's byte order and little endian
+ * (LE) or big endian (BE). Each is its own inverse.
+ */
+/**@{*/
+#if (CUSB_ENDIAN_BIG_)
+#define CUSB_LE16_(v)                       CUSB_SWAP16_(v)
+#define CUSB_LE32_(v)                       CUSB_SWAP32_(v)
+#define CUSB_BE16_(v)                       (v)
+#define CUSB_BE32_(v)                       (v)
+#else
+#define CUSB_LE16_(v)                       (v)
+#define CUSB_LE32_(v)                       (v)
+#define CUSB_BE16_(v)                       CUSB_SWAP16_(v)
+#define CUSB_BE32_(v)                       CUSB_SWAP32_(v)
+#endif
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*--------------------- ENDIAN ACCESSORS ---------------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Unaligned Access
+ * @private
+ */
+/**@{*/
+static inline uint16_t cusb_load16_(const uint8_t *p)
+{
+    uint16_t val;
+    memcpy(&val, p, sizeof(val));
+    return (uint16_t)CUSB_MEM16_(val);
+}
+
+static inline uint32_t cusb_load32_(const uint8_t *p)
+{
+    uint32_t val;
+    memcpy(&val, p, sizeof(val));
+    return (uint32_t)CUSB_MEM32_(val);
+}
+
+static inline void cusb_store16_(uint8_t *p, uint16_t val)
+{
+    val = (uint16_t)CUSB_MEM16_(val);
+    memcpy(p, &val, sizeof(val));
+}
+
+static inline void cusb_store32_(uint8_t *p, uint32_t val)
+{
+    val = (uint32_t)CUSB_MEM32_(val);
+    memcpy(p, &val, sizeof(val));
+}
+/**@}*/
+
+/**
+ * @name Loads
+ * Read the value at @p p, which needs no alignment.
+ */
+/**@{*/
+static inline uint16_t cusb_get_le16(const uint8_t *p)
+{
+    return (uint16_t)CUSB_LE16_(cusb_load16_(p));
+}
+
+static inline uint32_t cusb_get_le32(const uint8_t *p)
+{
+    return (uint32_t)CUSB_LE32_(cusb_load32_(p));
+}
+
+static inline uint16_t cusb_get_be16(const uint8_t *p)
+{
+    return (uint16_t)CUSB_BE16_(cusb_load16_(p));
+}
+
+static inline uint32_t cusb_get_be32(const uint8_t *p)
+{
+    return (uint32_t)CUSB_BE32_(cusb_load32_(p));
+}
+/**@}*/
+
+/**
+ * @name Stores
+ * Write @p val at @p p, which needs no alignment.
+ */
+/**@{*/
+static inline void cusb_set_le16(uint8_t *p, uint16_t val)
+{
+    cusb_store16_(p, (uint16_t)CUSB_LE16_(val));
+}
+
+static inline void cusb_set_le32(uint8_t *p, uint32_t val)
+{
+    cusb_store32_(p, (uint32_t)CUSB_LE32_(val));
+}
+
+static inline void cusb_set_be16(uint8_t *p, uint16_t val)
+{
+    cusb_store16_(p, (uint16_t)CUSB_BE16_(val));
+}
+
+static inline void cusb_set_be32(uint8_t *p, uint32_t val)
+{
+    cusb_store32_(p, (uint32_t)CUSB_BE32_(val));
+}
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_ENDIAN_H_ */
@@ -0,0 +1,289 @@
+/**
+ * @file
+ * @brief CPU load accounting. Measures the share of CPU time spent in the
+ * USB interrupt, in deferred processing and in class callbacks, over
+ * fixed windows, with a rolling average and a peak hold.
+ * @details Code brackets each piece of work with @ref cusb_load_enter()
+ * and @ref cusb_load_exit(). The device core does this itself once a
+ * @ref cusb_load is attached with @ref cusb_device_set_load():
+ * @ref cusb_isr() counts as @ref CUSB_LOAD_ISR, @ref cusb_poll() and
+ * @ref cusb_device_run_timers() as @ref CUSB_LOAD_DEFERRED, and every call
+ * into the application or a class (completions, requests, bus events,
+ * batches, timers) as @ref CUSB_LOAD_CALLBACK. The application brackets
+ * its own USB related work, e.g. a class task fed by completions, the
+ * same way.
+ *
+ * Time is exclusive. A callback made from the interrupt is charged to
+ * the callback, not to the interrupt, and an interrupt that preempts
+ * deferred work is taken out of that work's time. The sum of the
+ * contexts is the USB stack's whole share of the CPU.
+ *
+ * The thread side calls @ref cusb_load_update() at least once per
+ * window, typically from the main loop or an idle hook. That closes the
+ * window, turns the ticks of each context into a percentage and updates
+ * the report. The interrupt side only adds up ticks, so there is no
+ * lock: one interrupt level may preempt the thread side, but it must not
+ * be preempted by another piece of work charged to the same object.
+ *
+ * Ticks come from a free running 32-bit counter. @ref cusb_load_cycles()
+ * reads the DWT cycle counter on Cortex-M3 and up, and CLOCK_MONOTONIC
+ * in nanoseconds on Linux. Elsewhere the application passes its own.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_LOAD_H_
+#define CUSB_LOAD_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Contexts
+ * Kinds of work passed to @ref cusb_load_enter() and indexes into
+ * @ref cusb_load_report.
+ */
+/**@{*/
+#define CUSB_LOAD_ISR                       (0U)    /**< Controller interrupt handler. */
+#define CUSB_LOAD_DEFERRED                  (1U)    /**< Polling, timers and class tasks outside the interrupt. */
+#define CUSB_LOAD_CALLBACK                  (2U)    /**< Application and class callbacks. */
+#define CUSB_LOAD_TOTAL                     (3U)    /**< Report index only. Sum of the above. */
+/**@}*/
+
+/**
+ * @brief Load values are in hundredths of a percent. This is 100 %.
+ */
+#define CUSB_LOAD_FULL                      (10000U)
+
+/**
+ * @private
+ * @brief Contexts that can be entered.
+ */
+#define CUSB_LOAD_CONTEXTS                  (3U)
+
+/**
+ * @private
+ * @brief Nesting depth per level, e.g. poll, then a callback, then a
+ * timer started from it.
+ */
+#define CUSB_LOAD_DEPTH                     (4U)
+
+/**
+ * @brief 1 when @ref cusb_load_cycles() exists on this target.
+ */
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+#define CUSB_LOAD_HAS_CYCLES                1
+#elif defined(__linux__)
+#define CUSB_LOAD_HAS_CYCLES                1
+#else
+#define CUSB_LOAD_HAS_CYCLES                0
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Load per context, indexed by @ref CUSB_LOAD_ISR and friends,
+ * with the sum at @ref CUSB_LOAD_TOTAL. Hundredths of a percent.
+ */
+struct cusb_load_report
+{
+    /// @brief Last closed window.
+    uint16_t last[CUSB_LOAD_CONTEXTS + 1U];
+
+    /// @brief Mean of the last @ref CUSB_CFG_LOAD_HISTORY windows, or of
+    /// every window so far if fewer have closed.
+    uint16_t average[CUSB_LOAD_CONTEXTS + 1U];
+
+    /// @brief Highest single window since construction or the last
+    /// @ref cusb_load_clear_peak().
+    uint16_t peak[CUSB_LOAD_CONTEXTS + 1U];
+
+    /// @brief Windows closed. Wraps around.
+    uint32_t windows;
+};
+
+/**
+ * @private
+ * @brief Accounting state of one execution level, thread or interrupt.
+ * Only written from that level.
+ */
+struct cusb_load_level
+{
+    /// @private Ticks charged per context. Wrap around.
+    volatile uint32_t busy[CUSB_LOAD_CONTEXTS];
+
+    /// @private Time the running context was last charged up to.
+    uint32_t mark;
+
+    /// @private Entered contexts, innermost last.
+    uint8_t stack[CUSB_LOAD_DEPTH];
+
+    /// @private Entries in @ref stack.
+    uint8_t depth;
+};
+
+/**
+ * @brief Load accounting. Only modify through API.
+ */
+struct cusb_load
+{
+    /// @private Tick source.
+    uint32_t (*now)(void);
+
+    /// @private Window length in ticks.
+    uint32_t window;
+
+    /// @private Work outside interrupts.
+    struct cusb_load_level thread;
+
+    /// @private Work inside the interrupt.
+    struct cusb_load_level irq;
+
+    /// @private Ticks spent in the interrupt level so far, updated when
+    /// it is left. Wraps around.
+    volatile uint32_t irq_ticks;
+
+    /// @private @ref irq_ticks as of @ref thread mark.
+    uint32_t irq_seen;
+
+    /// @private Interrupt level is running.
+    volatile bool in_irq;
+
+    /// @private Start of the open window.
+    uint32_t start;
+
+    /// @private Ticks per context when the open window started.
+    uint32_t base[CUSB_LOAD_CONTEXTS];
+
+    /// @private Load of the last windows per context, ring.
+    uint16_t history[CUSB_CFG_LOAD_HISTORY][CUSB_LOAD_CONTEXTS + 1U];
+
+    /// @private Next slot of @ref history.
+    uint8_t head;
+
+    /// @private Valid slots of @ref history.
+    uint8_t count;
+
+    /// @private Results.
+    struct cusb_load_report report;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------- LOAD MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Constructor. Opens the first window.
+ *
+ * @param me Accounting to construct.
+ * @param now Tick source, a free running 32-bit counter. NULL uses
+ * @ref cusb_load_cycles(), which must exist then.
+ * @param window Window length in ticks, 1 to 2^31 - 1. E.g. 100 ms is
+ * 8000000 at 80 MHz, or 100000000 with the nanosecond Linux source.
+ */
+extern void cusb_load_ctor(struct cusb_load *me, uint32_t (*now)(void), uint32_t window);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_load_ctor().
+ * @brief Starts charging time to @p context. Entering @ref CUSB_LOAD_ISR
+ * starts the interrupt level, which ends with its matching exit.
+ *
+ * @param me Accounting.
+ * @param context @ref CUSB_LOAD_ISR, @ref CUSB_LOAD_DEFERRED or
+ * @ref CUSB_LOAD_CALLBACK.
+ */
+extern void cusb_load_enter(struct cusb_load *me, uint8_t context);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_load_ctor().
+ * @brief Stops charging the innermost entered context and resumes the
+ * one it interrupted, if any.
+ *
+ * @param me Accounting.
+ */
+extern void cusb_load_exit(struct cusb_load *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_load_ctor().
+ * @brief Closes the open window if it is over and updates the report.
+ * Thread side only. Returns true if a window closed. A window spanning
+ * more than its length, because this was called late, is still one
+ * window and its load is relative to its actual length.
+ *
+ * @param me Accounting.
+ */
+extern bool cusb_load_update(struct cusb_load *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_load_ctor().
+ * @brief Returns the report. Values change on @ref cusb_load_update().
+ *
+ * @param me Accounting.
+ */
+extern const struct cusb_load_report *cusb_load_get_report(const struct cusb_load *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_load_ctor().
+ * @brief Restarts the peak hold from the last closed window.
+ *
+ * @param me Accounting.
+ */
+extern void cusb_load_clear_peak(struct cusb_load *me);
+/**@}*/
+
+/**
+ * @name Tick Source
+ */
+/**@{*/
+#if (CUSB_LOAD_HAS_CYCLES)
+/**
+ * @brief Enables the cycle counter. Call once before constructing an
+ * accounting that uses @ref cusb_load_cycles(). Does nothing on Linux.
+ */
+extern void cusb_load_cycles_init(void);
+
+/**
+ * @brief Reads the DWT cycle counter on Cortex-M, or CLOCK_MONOTONIC in
+ * nanoseconds on Linux. Wraps around. Only exists when
+ * @ref CUSB_LOAD_HAS_CYCLES is 1.
+ */
+extern uint32_t cusb_load_cycles(void);
+#endif
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_LOAD_H_ */
@@ -0,0 +1,368 @@
+/**
+ * @file
+ * @brief USB-MIDI class, MIDI 1.0 event packets and MIDI 2.0 Universal
+ * MIDI Packets (UMP), with batching of many events per bulk transfer.
+ * @details Like the other classes it is transport agnostic. The
+ * application's endpoint glue passes received Bulk-OUT packets to
+ * @ref cusb_midi_bulk_out(), asks @ref cusb_midi_bulk_in() for the next
+ * Bulk-IN transfer when @ref cusb_midi_api.ready says one is due and
+ * reports its completion with @ref cusb_midi_in_complete().
+ *
+ * The application writes plain MIDI byte streams, one per virtual cable,
+ * with @ref cusb_midi_write(). Each cable has its own parser, so running
+ * status, real-time bytes inside other messages and SysEx split over
+ * many writes all work. Complete messages are packed as they are parsed:
+ * into 4 byte event packets in @ref CUSB_MIDI_1_0 mode, or into UMP
+ * MIDI 1.0 protocol messages in @ref CUSB_MIDI_2_0 mode, where cables
+ * are groups. Native UMP, e.g. MIDI 2.0 channel voice messages, goes in
+ * with @ref cusb_midi_write_ump().
+ *
+ * Packed events wait in a FIFO and leave together. A transfer is due
+ * once a full packet is waiting, or once the oldest waiting event is
+ * @p latency microseconds old. While a transfer is in flight new events
+ * pile up behind it and leave together in the next one. A dense stream
+ * of controller changes therefore goes out as full packets, and a lone
+ * note waits no longer than @p latency plus the transfer in flight. A
+ * latency of 0 sends whatever is waiting as soon as the endpoint is idle,
+ * which still batches whatever piles up during a transfer.
+ *
+ * In @ref CUSB_MIDI_2_0 mode a UMP never straddles a packet boundary.
+ * Where one would, the rest of the packet is filled with UMP NOOPs.
+ *
+ * Call everything from one context, or mask the USB interrupt around
+ * the writes.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_MIDI_H_
+#define CUSB_MIDI_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* Latency timer. */
+#include "cusb/device.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Modes
+ * Values of @ref cusb_midi_set_mode(). Equal to the alternate setting of
+ * the MIDI streaming interface that selects them.
+ */
+/**@{*/
+#define CUSB_MIDI_1_0                       (0U)    /**< USB-MIDI 1.0 event packets. */
+#define CUSB_MIDI_2_0                       (1U)    /**< Universal MIDI Packets. */
+/**@}*/
+
+/**
+ * @brief Most 32-bit words in one UMP.
+ */
+#define CUSB_MIDI_UMP_WORDS_MAX             (4U)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Application callbacks. @ref ready and @ref receive are
+ * mandatory.
+ */
+struct cusb_midi_api
+{
+    /// @brief A Bulk-IN transfer is due. Call @ref cusb_midi_bulk_in()
+    /// now or from the endpoint glue's next pass.
+    void (*ready)(void *ctx);
+
+    /// @brief Delivers @p len MIDI bytes received on @p cable in
+    /// @ref CUSB_MIDI_1_0 mode. Consecutive events of a cable come in one
+    /// call.
+    void (*receive)(void *ctx, uint8_t cable, const uint8_t *data, size_t len);
+
+    /// @brief Delivers one UMP of @p nwords words received in
+    /// @ref CUSB_MIDI_2_0 mode. NOOPs are skipped. Optional, NULL drops
+    /// them.
+    void (*receive_ump)(void *ctx, const uint32_t *ump, uint8_t nwords);
+};
+
+/**
+ * @brief MIDI class statistics. Counters wrap around.
+ */
+struct cusb_midi_stats
+{
+    /// @brief Event packets or UMPs queued for the host.
+    uint32_t events_in;
+
+    /// @brief Event packets or UMPs received from the host.
+    uint32_t events_out;
+
+    /// @brief Bulk-IN transfers handed out.
+    uint32_t transfers;
+
+    /// @brief Writes dropped for lack of FIFO space.
+    uint32_t dropped;
+};
+
+/**
+ * @brief Byte stream parser of one cable. Only modify through API.
+ */
+struct cusb_midi_parser
+{
+    /// @private Running status, 0 if none.
+    uint8_t status;
+
+    /// @private Data bytes the status takes.
+    uint8_t need;
+
+    /// @private Data bytes received for it.
+    uint8_t count;
+
+    /// @private Data bytes received for it.
+    uint8_t data[2];
+
+    /// @private SysEx bytes not packed yet.
+    uint8_t nsysex;
+
+    /// @private SysEx bytes not packed yet.
+    uint8_t sysex[6];
+
+    /// @private Inside a SysEx message.
+    bool in_sysex;
+
+    /// @private A UMP of the SysEx message went out already.
+    bool sysex_started;
+};
+
+/**
+ * @brief USB-MIDI function. Only modify through API.
+ */
+struct cusb_midi
+{
+    /// @private Application callbacks.
+    const struct cusb_midi_api *api;
+
+    /// @private Passed to every callback.
+    void *ctx;
+
+    /// @private Packed events waiting for the host.
+    uint8_t *fifo;
+
+    /// @private Size of @ref fifo minus 1. Size is a power of 2.
+    uint32_t mask;
+
+    /// @private Free-running count of bytes packed.
+    uint32_t head;
+
+    /// @private Free-running count of bytes handed out.
+    uint32_t tail;
+
+    /// @private Device running @ref timer. NULL if @ref latency is 0.
+    struct cusb_device *dev;
+
+    /// @private Expires when the oldest waiting event is due.
+    struct cusb_timer timer;
+
+    /// @private Longest an event waits for a fuller packet, microseconds.
+    uint32_t latency;
+
+    /// @private Bulk endpoint max packet size.
+    uint16_t packet_size;
+
+    /// @private Cables in use.
+    uint8_t ncables;
+
+    /// @private @ref CUSB_MIDI_1_0 or @ref CUSB_MIDI_2_0.
+    uint8_t mode;
+
+    /// @private Waiting events are due.
+    bool due;
+
+    /// @private A Bulk-IN transfer is in flight.
+    bool busy;
+
+    /// @private Parser per cable.
+    struct cusb_midi_parser parsers[CUSB_CFG_MIDI_CABLES];
+
+#if (CUSB_CFG_STATS)
+    /// @private Statistics.
+    struct cusb_midi_stats stats;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*--------------------- MIDI MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me and @p fifo.
+ * @brief USB-MIDI constructor. Starts in @ref CUSB_MIDI_1_0 mode.
+ *
+ * @param me USB-MIDI function to construct.
+ * @param api Application callbacks. Must remain valid for the lifetime of @p me.
+ * @param ctx Passed to every callback. Optional, can be NULL.
+ * @param fifo Holds packed events until they leave. A power of 2 of at
+ * least two packets. Must remain valid for the lifetime of @p me.
+ * @param fifo_size Bytes in @p fifo.
+ * @param ncables Virtual cables, 1 to @ref CUSB_CFG_MIDI_CABLES.
+ * @param packet_size Bulk endpoint max packet size. Must be a multiple of
+ * 16, so the longest UMP fits in one packet.
+ * @param dev Device whose timers bound the latency. Can be NULL if
+ * @p latency is 0.
+ * @param latency Longest an event waits for a fuller packet, in
+ * microseconds of the clock passed to @ref cusb_midi_write().
+ */
+extern void cusb_midi_ctor(struct cusb_midi *me,
+                           const struct cusb_midi_api *api,
+                           void *ctx,
+                           uint8_t *fifo,
+                           size_t fifo_size,
+                           uint8_t ncables,
+                           uint16_t packet_size,
+                           struct cusb_device *dev,
+                           uint32_t latency);
+/**@}*/
+
+/**
+ * @name Application Interface
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor().
+ * @brief Packs @p len bytes of the MIDI stream of @p cable. Returns false,
+ * having packed nothing, if the events do not fit in the FIFO.
+ *
+ * @param me USB-MIDI function.
+ * @param cable Virtual cable, or UMP group in @ref CUSB_MIDI_2_0 mode.
+ * @param data MIDI bytes. Need not end on a message boundary.
+ * @param len Number of bytes.
+ * @param now Current time in microseconds, starts the latency timer.
+ */
+extern bool cusb_midi_write(struct cusb_midi *me, uint8_t cable, const uint8_t *data, size_t len, uint32_t now);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor() and in
+ * @ref CUSB_MIDI_2_0 mode.
+ * @brief Queues complete UMPs. Returns false, having queued nothing, if
+ * they do not fit in the FIFO.
+ *
+ * @param me USB-MIDI function.
+ * @param ump Words of one or more whole UMPs.
+ * @param nwords Number of words.
+ * @param now Current time in microseconds, starts the latency timer.
+ */
+extern bool cusb_midi_write_ump(struct cusb_midi *me, const uint32_t *ump, size_t nwords, uint32_t now);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor().
+ * @brief Makes everything waiting due now, without waiting for the
+ * latency to run out.
+ *
+ * @param me USB-MIDI function.
+ */
+extern void cusb_midi_flush(struct cusb_midi *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor().
+ * @brief Returns the bytes of packed events waiting for the host.
+ *
+ * @param me USB-MIDI function.
+ */
+extern size_t cusb_midi_pending(const struct cusb_midi *me);
+
+#if (CUSB_CFG_STATS)
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor().
+ * @brief Returns the statistics. Only exists when @ref CUSB_CFG_STATS
+ * is 1.
+ *
+ * @param me USB-MIDI function.
+ */
+extern const struct cusb_midi_stats *cusb_midi_get_stats(const struct cusb_midi *me);
+#endif
+/**@}*/
+
+/**
+ * @name Transport
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor().
+ * @brief Selects @ref CUSB_MIDI_1_0 or @ref CUSB_MIDI_2_0. Call when the
+ * host selects the alternate setting of the streaming interface. Drops
+ * everything waiting, as @ref cusb_midi_reset().
+ *
+ * @param me USB-MIDI function.
+ * @param mode @ref CUSB_MIDI_1_0 or @ref CUSB_MIDI_2_0.
+ */
+extern void cusb_midi_set_mode(struct cusb_midi *me, uint8_t mode);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor().
+ * @brief Unpacks one packet received on the Bulk-OUT endpoint and hands
+ * its events to the application.
+ *
+ * @param me USB-MIDI function.
+ * @param pkt Received packet.
+ * @param len Number of bytes in @p pkt.
+ */
+extern void cusb_midi_bulk_out(struct cusb_midi *me, const uint8_t *pkt, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor().
+ * @brief Fills the next Bulk-IN transfer if one is due and none is in
+ * flight. Returns true if so, with @p len bytes written to @p buf.
+ *
+ * @param me USB-MIDI function.
+ * @param buf Transfer buffer.
+ * @param size Size of @p buf. Must be a non-zero multiple of the packet size.
+ * @param len Number of bytes written to @p buf.
+ */
+extern bool cusb_midi_bulk_in(struct cusb_midi *me, uint8_t *buf, size_t size, size_t *len);
+
+/**
+ * @pre A transfer handed out by @ref cusb_midi_bulk_in() completed.
+ * @brief Ends the transfer in flight. Calls @ref cusb_midi_api.ready
+ * if the next one is due already.
+ *
+ * @param me USB-MIDI function.
+ */
+extern void cusb_midi_in_complete(struct cusb_midi *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_midi_ctor().
+ * @brief Drops every waiting event and partly parsed message. Call on bus
+ * reset and when the host clears a halted bulk endpoint.
+ *
+ * @param me USB-MIDI function.
+ */
+extern void cusb_midi_reset(struct cusb_midi *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_MIDI_H_ */
@@ -0,0 +1,380 @@
+/**
+ * @file
+ * @brief Media Transfer Protocol (PTP/MTP) responder.
+ * @details Unlike mass storage, MTP exposes objects (files) instead of
+ * raw sectors so the device keeps ownership of its filesystem while it
+ * is connected. The responder is transport agnostic. The application's
+ * bulk endpoint glue passes every received OUT packet to
+ * @ref cusb_mtp_bulk_out() and asks @ref cusb_mtp_bulk_in() for the next
+ * IN packet to send.
+ *
+ * Objects are never buffered in RAM. GetObject, GetPartialObject and
+ * SendObject data phases are streamed packet by packet directly from and
+ * to the storage backend. Objects are tracked in an application-supplied
+ * table where an object handle directly encodes the table index, so every
+ * handle lookup is O(1). The encoded generation count makes stale handles
+ * of deleted objects get rejected.
+ *
+ * A single storage is exposed. Events (interrupt endpoint) are not
+ * supported.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_MTP_H_
+#define CUSB_MTP_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Size of a PTP container header in bytes. Length (4),
+ * type (2), code (2) and transaction ID (4).
+ */
+#define CUSB_MTP_CONTAINER_HEADER_SIZE      (12U)
+
+/**
+ * @brief The only storage ID this responder exposes.
+ */
+#define CUSB_MTP_STORAGE_ID                 (0x00010001UL)
+
+/**
+ * @brief Parent handle of objects in the root folder.
+ */
+#define CUSB_MTP_ROOT_HANDLE                (0xFFFFFFFFUL)
+
+/**
+ * @brief Returned by the object table when a handle is invalid.
+ */
+#define CUSB_MTP_INVALID_HANDLE             (0UL)
+
+/**
+ * @brief Maximum filename length, including NUL terminator,
+ * the responder will pass to and from the storage backend.
+ * Can be overridden by the build system.
+ */
+#ifndef CUSB_MTP_FILENAME_MAX
+#define CUSB_MTP_FILENAME_MAX               (64U)
+#endif
+
+/**
+ * @name Object Formats
+ */
+/**@{*/
+#define CUSB_MTP_FORMAT_UNDEFINED           (0x3000U)
+#define CUSB_MTP_FORMAT_ASSOCIATION         (0x3001U) /**< Folder. */
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Description of an object passed between the responder
+ * and storage backend.
+ */
+struct cusb_mtp_object_info
+{
+    /// @brief MTP object format. I.e. @ref CUSB_MTP_FORMAT_UNDEFINED.
+    uint16_t format;
+
+    /// @brief Handle of the parent folder, or @ref CUSB_MTP_ROOT_HANDLE.
+    uint32_t parent;
+
+    /// @brief Object size in bytes.
+    uint32_t size;
+
+    /// @brief NUL terminated ASCII filename.
+    const char *filename;
+};
+
+/**
+ * @brief Storage backend. Objects are identified by a backend-defined
+ * cookie, i.e. a file index or directory entry number. All functions
+ * are mandatory unless stated otherwise.
+ */
+struct cusb_mtp_store_api
+{
+    /// @brief Reads up to @p len bytes of object @p cookie starting at
+    /// @p offset directly into the packet buffer @p buf. Returns number
+    /// of bytes read. Returning less than requested aborts the transfer.
+    size_t (*read)(void *ctx, uint32_t cookie, uint32_t offset, uint8_t *buf, size_t len);
+
+    /// @brief Writes @p len bytes of object @p cookie at @p offset directly
+    /// from the received packet @p buf. Returns false on failure. Optional.
+    /// Storage is read-only if NULL.
+    bool (*write)(void *ctx, uint32_t cookie, uint32_t offset, const uint8_t *buf, size_t len);
+
+    /// @brief Creates a new object described by @p info. Stores the new object's
+    /// cookie in @p cookie. Returns false on failure. Optional. Storage is read-only
+    /// if NULL.
+    bool (*create)(void *ctx, const struct cusb_mtp_object_info *info, uint32_t *cookie);
+
+    /// @brief Deletes object @p cookie. Returns false on failure. Optional. Objects
+    /// cannot be deleted if NULL.
+    bool (*remove)(void *ctx, uint32_t cookie);
+
+    /// @brief Copies the filename of object @p cookie into @p buf of size
+    /// @p size, NUL terminated.
+    void (*filename)(void *ctx, uint32_t cookie, char *buf, size_t size);
+
+    /// @brief Returns storage capacity and free space in bytes.
+    void (*capacity)(void *ctx, uint64_t *max, uint64_t *free);
+};
+
+/**
+ * @brief One slot in the responder's object table. Application
+ * allocates an array of these and gives it to the responder.
+ * Only modify through API.
+ */
+struct cusb_mtp_object
+{
+    /// @private Backend identifier of this object.
+    uint32_t cookie;
+
+    /// @private Object size in bytes.
+    uint32_t size;
+
+    /// @private Handle of the parent folder.
+    uint32_t parent;
+
+    /// @private Object format.
+    uint16_t format;
+
+    /// @private Incremented each time the slot is reused so stale
+    /// handles do not alias a new object.
+    uint16_t generation;
+
+    /// @private Next free slot index while this slot is unused.
+    uint16_t next_free;
+
+    /// @private True if this slot holds an object.
+    bool used;
+};
+
+/**
+ * @brief Static device strings reported in GetDeviceInfo and
+ * GetStorageInfo. All are NUL terminated ASCII.
+ */
+struct cusb_mtp_strings
+{
+    const char *manufacturer;
+    const char *model;
+    const char *device_version;
+    const char *serial_number;
+    const char *storage_description;
+};
+
+/**
+ * @brief MTP responder. Only modify through API.
+ */
+struct cusb_mtp
+{
+    /// @private Storage backend.
+    const struct cusb_mtp_store_api *store;
+
+    /// @private Passed to every backend function.
+    void *store_ctx;
+
+    /// @private Device strings.
+    const struct cusb_mtp_strings *strings;
+
+    /// @private Object table.
+    struct cusb_mtp_object *objects;
+
+    /// @private Number of slots in @ref objects.
+    uint16_t object_capacity;
+
+    /// @private Head of the free slot list.
+    uint16_t free_head;
+
+    /// @private Bulk endpoint max packet size.
+    uint16_t packet_size;
+
+    /// @private Buffer small datasets are built in and parsed from.
+    uint8_t *scratch;
+
+    /// @private Size of @ref scratch.
+    size_t scratch_size;
+
+    /// @private Current session ID. 0 if no session is open.
+    uint32_t session_id;
+
+    /// @private Filename buffer for backend calls.
+    char filename[CUSB_MTP_FILENAME_MAX];
+
+    /// @private Transaction currently being processed.
+    struct
+    {
+        uint16_t code;
+        uint32_t transaction_id;
+        uint32_t params[5];
+        uint8_t nparams;
+    } cmd;
+
+    /// @private Data phase currently being processed. cookie is the
+    /// streamed object's backend cookie, or the number of handles
+    /// when listing handles.
+    struct
+    {
+        uint8_t source;
+        uint32_t cookie;
+        uint32_t offset;
+        uint32_t remaining;
+        uint16_t cursor;
+        bool header_pending;
+        bool zlp_pending;
+    } data;
+
+    /// @private Response currently being returned.
+    struct
+    {
+        uint16_t code;
+        uint32_t params[3];
+        uint8_t nparams;
+    } resp;
+
+    /// @private Object created by the last SendObjectInfo that SendObject
+    /// will write to. @ref CUSB_MTP_INVALID_HANDLE if none.
+    uint32_t send_handle;
+
+    /// @private Responder state.
+    uint8_t state;
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- MTP MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief MTP responder constructor.
+ *
+ * @param me Responder to construct.
+ * @param store Storage backend. Must remain valid for the lifetime of @p me.
+ * @param store_ctx Passed to every backend function. Optional, can be NULL.
+ * @param strings Device strings. Must remain valid for the lifetime of @p me.
+ * @param objects Object table. Its size bounds the number of objects.
+ * @param object_capacity Number of elements in @p objects.
+ * @param scratch Buffer used to build and parse small datasets (DeviceInfo,
+ * ObjectInfo, etc). 256 bytes is enough with the default filename length.
+ * @param scratch_size Number of bytes in @p scratch.
+ * @param packet_size Bulk endpoint max packet size. Must be a multiple of 4
+ * and at least 32 so every command and response fits in one packet.
+ */
+extern void cusb_mtp_ctor(struct cusb_mtp *me,
+                          const struct cusb_mtp_store_api *store,
+                          void *store_ctx,
+                          const struct cusb_mtp_strings *strings,
+                          struct cusb_mtp_object *objects,
+                          uint16_t object_capacity,
+                          uint8_t *scratch,
+                          size_t scratch_size,
+                          uint16_t packet_size);
+/**@}*/
+
+/**
+ * @name Object Table
+ * Used by the application to publish objects that already exist
+ * on its filesystem, and to keep the table in sync when it changes
+ * files itself while connected.
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_mtp_ctor().
+ * @brief Adds an object to the table. O(1). Returns its new handle,
+ * or @ref CUSB_MTP_INVALID_HANDLE if the table is full.
+ *
+ * @param me Responder.
+ * @param cookie Backend identifier of the object.
+ * @param info Object description. Filename is not used.
+ */
+extern uint32_t cusb_mtp_object_add(struct cusb_mtp *me,
+                                    uint32_t cookie,
+                                    const struct cusb_mtp_object_info *info);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_mtp_ctor().
+ * @brief Removes an object from the table. O(1). Returns false if
+ * @p handle is not valid. Does not call the backend.
+ */
+extern bool cusb_mtp_object_remove(struct cusb_mtp *me, uint32_t handle);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_mtp_ctor().
+ * @brief Returns the table slot of @p handle or NULL if @p handle
+ * is not valid. O(1).
+ */
+extern struct cusb_mtp_object *cusb_mtp_object_find(struct cusb_mtp *me, uint32_t handle);
+/**@}*/
+
+/**
+ * @name Transport
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_mtp_ctor().
+ * @brief Processes one packet received on the bulk OUT endpoint.
+ *
+ * @param me Responder.
+ * @param pkt Received packet.
+ * @param len Number of bytes in @p pkt.
+ */
+extern void cusb_mtp_bulk_out(struct cusb_mtp *me, const uint8_t *pkt, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_mtp_ctor().
+ * @brief Fills the next bulk IN transfer. Returns true if something
+ * must be sent, in which case @p len holds the number of bytes written
+ * to @p buf (0 for a zero length packet). Returns false if there is
+ * nothing to send.
+ *
+ * @param me Responder.
+ * @param buf Transfer buffer, ideally the endpoint's packet buffer.
+ * @param size Size of @p buf. Must be a non-zero multiple of the packet
+ * size. Larger buffers let several packets be queued per call.
+ * @param len Number of bytes written to @p buf.
+ */
+extern bool cusb_mtp_bulk_in(struct cusb_mtp *me, uint8_t *buf, size_t size, size_t *len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_mtp_ctor().
+ * @brief Aborts the current transaction. Call on the class-specific
+ * Cancel and Device Reset requests, and on bus reset. Device Reset
+ * also closes the session.
+ *
+ * @param me Responder.
+ * @param close_session True to also close the session.
+ */
+extern void cusb_mtp_reset(struct cusb_mtp *me, bool close_session);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_MTP_H_ */
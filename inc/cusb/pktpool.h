@@ -0,0 +1,226 @@
+/**
+ * @file
+ * @brief Pool of transfer-sized packet buffers shared by the network
+ * classes, and a queue to hold them.
+ * @details Network classes move Ethernet frames without copying them.
+ * A Bulk-OUT transfer lands straight in a pool buffer. Each frame in it
+ * goes to the application as a pointer into that buffer. Frames for the
+ * host are written by the application straight into the buffer of the
+ * next Bulk-IN transfer, after the header the class reserved for them.
+ *
+ * One transfer can carry many frames, so buffers are reference counted.
+ * Each frame handed to the application holds a reference and the buffer
+ * returns to the pool once the last one is released. Several functions,
+ * e.g. RNDIS and NCM on the same device, can share one pool.
+ *
+ * Call everything from one context, or mask the USB interrupt around the
+ * calls made outside it.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_PKTPOOL_H_
+#define CUSB_PKTPOOL_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief One buffer of a @ref cusb_pktpool. Only modify through API,
+ * except @ref len.
+ */
+struct cusb_pkt
+{
+    /// @private Next buffer in the free list or in a @ref cusb_pktq.
+    struct cusb_pkt *next;
+
+    /// @brief Start of the buffer, 4 byte aligned.
+    uint8_t *buf;
+
+    /// @brief Bytes in use. Set by whoever fills the buffer.
+    uint32_t len;
+
+    /// @private References held. 0 while in the pool.
+    uint16_t refs;
+};
+
+/**
+ * @brief Pool of equally sized buffers. Only modify through API.
+ */
+struct cusb_pktpool
+{
+    /// @private Free buffers.
+    struct cusb_pkt *free;
+
+    /// @private Bytes in each buffer.
+    uint32_t size;
+
+    /// @private Buffers in the pool.
+    uint16_t count;
+
+    /// @private Buffers in @ref free.
+    uint16_t available;
+
+    /// @private Fewest buffers ever in @ref free.
+    uint16_t low_water;
+};
+
+/**
+ * @brief FIFO of buffers. Only modify through API.
+ */
+struct cusb_pktq
+{
+    /// @private Oldest buffer, NULL if empty.
+    struct cusb_pkt *head;
+
+    /// @private Newest buffer.
+    struct cusb_pkt *tail;
+};
+
+/*------------------------------------------------------------*/
+/*------------------- PKTPOOL MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me, @p pkts and @p mem.
+ * @brief Pool constructor. Every buffer starts free.
+ *
+ * @param me Pool to construct.
+ * @param pkts @p count buffer descriptors. Must remain valid for the
+ * lifetime of @p me.
+ * @param mem @p count times @p size bytes, 4 byte aligned. Must remain
+ * valid for the lifetime of @p me.
+ * @param count Number of buffers, at least 1.
+ * @param size Bytes per buffer. A multiple of 4.
+ */
+extern void cusb_pktpool_ctor(struct cusb_pktpool *me,
+                              struct cusb_pkt *pkts,
+                              uint8_t *mem,
+                              uint16_t count,
+                              uint32_t size);
+
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Queue constructor. Starts empty.
+ *
+ * @param me Queue to construct.
+ */
+extern void cusb_pktq_ctor(struct cusb_pktq *me);
+/**@}*/
+
+/**
+ * @name Pool
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_pktpool_ctor().
+ * @brief Takes a free buffer with one reference and @ref cusb_pkt.len 0.
+ * Returns NULL if none is free.
+ *
+ * @param me Pool.
+ */
+extern struct cusb_pkt *cusb_pktpool_alloc(struct cusb_pktpool *me);
+
+/**
+ * @pre @p pkt taken from @p me and not released yet.
+ * @brief Adds a reference to @p pkt.
+ *
+ * @param me Pool.
+ * @param pkt Buffer.
+ */
+extern void cusb_pktpool_ref(struct cusb_pktpool *me, struct cusb_pkt *pkt);
+
+/**
+ * @pre @p pkt taken from @p me and not released yet.
+ * @brief Drops a reference to @p pkt. The last one returns it to the pool.
+ *
+ * @param me Pool.
+ * @param pkt Buffer.
+ */
+extern void cusb_pktpool_release(struct cusb_pktpool *me, struct cusb_pkt *pkt);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_pktpool_ctor().
+ * @brief Returns the bytes in each buffer.
+ *
+ * @param me Pool.
+ */
+extern uint32_t cusb_pktpool_size(const struct cusb_pktpool *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_pktpool_ctor().
+ * @brief Returns the number of free buffers.
+ *
+ * @param me Pool.
+ */
+extern uint16_t cusb_pktpool_available(const struct cusb_pktpool *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_pktpool_ctor().
+ * @brief Returns the fewest free buffers there ever were, to size the
+ * pool.
+ *
+ * @param me Pool.
+ */
+extern uint16_t cusb_pktpool_low_water(const struct cusb_pktpool *me);
+/**@}*/
+
+/**
+ * @name Queue
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_pktq_ctor().
+ * @brief Appends @p pkt. A buffer is in one queue at a time.
+ *
+ * @param me Queue.
+ * @param pkt Buffer.
+ */
+extern void cusb_pktq_push(struct cusb_pktq *me, struct cusb_pkt *pkt);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_pktq_ctor().
+ * @brief Removes and returns the oldest buffer. NULL if empty.
+ *
+ * @param me Queue.
+ */
+extern struct cusb_pkt *cusb_pktq_pop(struct cusb_pktq *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_pktq_ctor().
+ * @brief Returns true if @p me holds no buffer.
+ *
+ * @param me Queue.
+ */
+extern bool cusb_pktq_empty(const struct cusb_pktq *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_PKTPOOL_H_ */
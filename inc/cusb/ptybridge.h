@@ -0,0 +1,233 @@
+/**
+ * @file
+ * @brief Bridges a pair of stream pipes to a Linux pseudo-terminal, so
+ * ordinary serial tools can talk to a device running on the host.
+ * @details A CDC-ACM style serial port is one bulk IN and one bulk OUT
+ * pipe carrying raw bytes. The bridge takes the place of the endpoint
+ * glue, the bus and the host driver: what the device sends on its IN
+ * pipe comes out of the pty, and what a program writes to the pty goes
+ * into the device's OUT pipe. Point cat, minicom, pyserial or the real
+ * host application at @ref cusb_ptybridge_name() (or the optional
+ * symlink) and it behaves like a /dev/ttyACM port.
+ *
+ * Data moves straight between the pipes' circular buffers and the pty
+ * with readv() and writev(), one syscall per transfer of up to
+ * @ref CUSB_PTYBRIDGE_TRANSFER_MAX bytes rather than one per byte. The
+ * pty master is non-blocking and watched with epoll in edge-triggered
+ * mode. When the pty is full the IN pipe stops draining, and when the OUT
+ * pipe is full the pty is not read, so flow control works end to end
+ * just like NAKs on a real bus.
+ *
+ * The line is put in raw mode. Programs that open the pty set their own
+ * mode. The bridge keeps the slave side open itself, so tools can come
+ * and go without the device seeing a hangup. Data the device sends while
+ * nothing is reading waits in the pty until its buffer is full.
+ *
+ * An IN pipe only starts a transfer once its watermark is reached, so a
+ * device sending short interactive replies should flush them with
+ * @ref cusb_stream_flush().
+ *
+ * Only built when the target is Linux.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_PTYBRIDGE_H_
+#define CUSB_PTYBRIDGE_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Stream pipes. */
+#include "cusb/stream.h"
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Largest transfer moved per syscall. A multiple of every bulk
+ * packet size.
+ */
+#define CUSB_PTYBRIDGE_TRANSFER_MAX         (16384U)
+
+/**
+ * @brief Size of the buffer holding the slave device path.
+ */
+#define CUSB_PTYBRIDGE_NAME_MAX             (32U)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Bridge statistics. Counters wrap around.
+ */
+struct cusb_ptybridge_stats
+{
+    /// @brief Bytes written to the pty (device to host).
+    uint32_t to_host;
+
+    /// @brief Bytes read from the pty (host to device).
+    uint32_t from_host;
+
+    /// @brief readv() and writev() calls that moved data.
+    uint32_t syscalls;
+};
+
+/**
+ * @brief Pty bridge. Only modify through API.
+ */
+struct cusb_ptybridge
+{
+    /// @private Device to host pipe. Can be NULL.
+    struct cusb_stream *in;
+
+    /// @private Host to device pipe. Can be NULL.
+    struct cusb_stream *out;
+
+    /// @private Pty master.
+    int master;
+
+    /// @private Pty slave, held open so tools can come and go.
+    int slave;
+
+    /// @private Watches @ref master.
+    int epfd;
+
+    /// @private Edge-triggered state: master had data last time we looked.
+    bool readable;
+
+    /// @private Edge-triggered state: master had room last time we looked.
+    bool writable;
+
+    /// @private An IN transfer is acquired.
+    bool in_busy;
+
+    /// @private An OUT transfer is acquired.
+    bool out_busy;
+
+    /// @private Acquired IN transfer.
+    struct cusb_stream_iov in_iov[2];
+
+    /// @private Length of the acquired IN transfer.
+    size_t in_len;
+
+    /// @private Bytes of the acquired IN transfer already written.
+    size_t in_sent;
+
+    /// @private Armed OUT transfer.
+    struct cusb_stream_iov out_iov[2];
+
+    /// @private Length of the armed OUT transfer.
+    size_t out_len;
+
+    /// @private Slave device path.
+    char name[CUSB_PTYBRIDGE_NAME_MAX];
+
+    /// @private Symlink to remove on close. NULL if none.
+    const char *link;
+
+    /// @private Statistics.
+    struct cusb_ptybridge_stats stats;
+};
+
+/*------------------------------------------------------------*/
+/*------------------ PTYBRIDGE MEMBER FUNCTIONS --------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Creates the pty and starts bridging it. Returns false if the pty,
+ * the epoll instance or the symlink cannot be created.
+ *
+ * @param me Bridge to construct.
+ * @param in IN pipe the device writes to. Optional, can be NULL.
+ * @param out OUT pipe the device reads from. Optional, can be NULL.
+ * @param link Path of a symlink to the slave device, i.e. /tmp/ttyCUSB0,
+ * so tools can use a fixed name. An existing link is replaced. Optional,
+ * can be NULL. Must remain valid until @ref cusb_ptybridge_close().
+ */
+extern bool cusb_ptybridge_open(struct cusb_ptybridge *me,
+                                struct cusb_stream *in,
+                                struct cusb_stream *out,
+                                const char *link);
+
+/**
+ * @pre @p me previously opened via @ref cusb_ptybridge_open().
+ * @brief Closes the pty and removes the symlink. Programs still using
+ * the slave see a hangup.
+ *
+ * @param me Bridge.
+ */
+extern void cusb_ptybridge_close(struct cusb_ptybridge *me);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously opened via @ref cusb_ptybridge_open().
+ * @brief Moves whatever can be moved in both directions. If nothing
+ * could, waits up to @p timeout_ms for the pty to become ready and tries
+ * again. Returns the number of bytes moved.
+ *
+ * @param me Bridge.
+ * @param timeout_ms Longest wait in milliseconds. 0 never waits, -1
+ * waits until the pty is ready.
+ */
+extern size_t cusb_ptybridge_poll(struct cusb_ptybridge *me, int timeout_ms);
+
+/**
+ * @pre @p me previously opened via @ref cusb_ptybridge_open().
+ * @brief Returns a file descriptor that becomes readable when the pty
+ * needs service, for applications running their own epoll or select
+ * loop. Call @ref cusb_ptybridge_poll() with a timeout of 0 when it does.
+ *
+ * @param me Bridge.
+ */
+extern int cusb_ptybridge_fd(const struct cusb_ptybridge *me);
+
+/**
+ * @pre @p me previously opened via @ref cusb_ptybridge_open().
+ * @brief Returns the path of the slave device, i.e. /dev/pts/3.
+ *
+ * @param me Bridge.
+ */
+extern const char *cusb_ptybridge_name(const struct cusb_ptybridge *me);
+
+/**
+ * @pre @p me previously opened via @ref cusb_ptybridge_open().
+ * @brief Returns the bridge statistics.
+ *
+ * @param me Bridge.
+ */
+extern const struct cusb_ptybridge_stats *cusb_ptybridge_get_stats(const struct cusb_ptybridge *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_PTYBRIDGE_H_ */
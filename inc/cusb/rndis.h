@@ -0,0 +1,376 @@
+/**
+ * @file
+ * @brief RNDIS network function, for hosts without NCM drivers, e.g.
+ * older Windows versions.
+ * @details Handles the RNDIS control messages (initialize, query, set,
+ * reset, keepalive, halt) and the packet message framing on the bulk
+ * endpoints. Like the other classes it is transport agnostic:
+ *
+ * - Class requests on the communication interface go to
+ *   @ref cusb_rndis_control() and @ref cusb_rndis_control_out(), which
+ *   take the arguments of @ref cusb_device_callbacks.control and
+ *   @ref cusb_device_callbacks.control_out.
+ * - When @ref cusb_rndis_api.notify is called the glue sends
+ *   @ref CUSB_RNDIS_NOTIFICATION_SIZE bytes, 01 00 00 00 00 00 00 00, on
+ *   the interrupt endpoint.
+ * - The glue arms the Bulk-OUT endpoint with the buffer from
+ *   @ref cusb_rndis_rx_arm() and passes its completion to
+ *   @ref cusb_rndis_bulk_out().
+ * - When @ref cusb_rndis_api.ready is called, or the Bulk-IN endpoint is
+ *   idle, the glue starts the transfer @ref cusb_rndis_bulk_in() hands
+ *   out and reports its completion with @ref cusb_rndis_in_complete().
+ *
+ * Frames are never copied. Transfer buffers come from a
+ * @ref cusb_pktpool, which other network functions can share. Received
+ * frames are handed to the application in place, each holding a
+ * reference to its transfer buffer. Frames for the host are written by
+ * the application straight into the next Bulk-IN transfer with
+ * @ref cusb_rndis_tx_alloc() and @ref cusb_rndis_tx_commit().
+ *
+ * Transfers carry many packet messages. The host may send up to the
+ * pool's buffer size worth of frames per Bulk-OUT transfer. Frames for
+ * the host collect in one transfer while the previous one is in flight
+ * and leave together once it completes, up to the size the host
+ * accepts.
+ *
+ * Call everything from one context, or mask the USB interrupt around the
+ * calls made outside it.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_RNDIS_H_
+#define CUSB_RNDIS_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* Transfer buffers. */
+#include "cusb/pktpool.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Size of the packet message header before each frame.
+ */
+#define CUSB_RNDIS_HEADER_SIZE              (44U)
+
+/**
+ * @brief Largest Ethernet frame, without FCS.
+ */
+#define CUSB_RNDIS_FRAME_MAX                (1514U)
+
+/**
+ * @brief Smallest pool buffer: one largest frame with its header,
+ * alignment and the pad byte that avoids a zero length packet.
+ */
+#define CUSB_RNDIS_BUFFER_MIN               (1564U)
+
+/**
+ * @brief Largest control message, in either direction.
+ */
+#define CUSB_RNDIS_CONTROL_MAX              (256U)
+
+/**
+ * @brief Size of the RESPONSE_AVAILABLE notification.
+ */
+#define CUSB_RNDIS_NOTIFICATION_SIZE        (8U)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Application callbacks. All are mandatory.
+ */
+struct cusb_rndis_api
+{
+    /// @brief Delivers a received frame of @p len bytes at @p frame,
+    /// inside @p pkt. The frame holds a reference to @p pkt, dropped
+    /// with @ref cusb_pktpool_release() once the application is done
+    /// with it.
+    void (*receive)(void *ctx, struct cusb_pkt *pkt, uint8_t *frame, uint32_t len);
+
+    /// @brief A response is available. Send the notification on the
+    /// interrupt endpoint.
+    void (*notify)(void *ctx);
+
+    /// @brief A Bulk-IN transfer is ready. Call @ref cusb_rndis_bulk_in()
+    /// now or from the endpoint glue's next pass.
+    void (*ready)(void *ctx);
+};
+
+/**
+ * @brief RNDIS statistics. Counters wrap around. Also reported to the
+ * host through the statistics OIDs.
+ */
+struct cusb_rndis_stats
+{
+    /// @brief Frames handed to the application.
+    uint32_t rx_frames;
+
+    /// @brief Malformed packet messages dropped.
+    uint32_t rx_errors;
+
+    /// @brief Frames queued for the host.
+    uint32_t tx_frames;
+
+    /// @brief Frames not sent for lack of a buffer or before the host
+    /// enabled the data path.
+    uint32_t tx_dropped;
+
+    /// @brief Bulk-IN transfers handed out.
+    uint32_t tx_transfers;
+};
+
+/**
+ * @brief RNDIS function. Only modify through API.
+ */
+struct cusb_rndis
+{
+    /// @private Application callbacks.
+    const struct cusb_rndis_api *api;
+
+    /// @private Passed to every callback.
+    void *ctx;
+
+    /// @private Transfer buffers.
+    struct cusb_pktpool *pool;
+
+    /// @private Permanent MAC address reported to the host.
+    uint8_t mac[6];
+
+    /// @private Bulk endpoint max packet size.
+    uint16_t packet_size;
+
+    /// @private Largest Bulk-IN transfer the host accepts.
+    uint32_t tx_max;
+
+    /// @private Packet filter set by the host. 0 disables the data path.
+    uint32_t filter;
+
+    /// @private RNDIS_STATUS_MEDIA_* indication to send, 0 if none.
+    uint32_t indication;
+
+    /// @private Host initialized the function.
+    bool initialized;
+
+    /// @private Link up.
+    bool link;
+
+    /// @private Bulk-OUT buffer armed.
+    struct cusb_pkt *rx;
+
+    /// @private Bulk-IN transfer being filled.
+    struct cusb_pkt *tx_open;
+
+    /// @private Filled Bulk-IN transfers.
+    struct cusb_pktq tx_queue;
+
+    /// @private Bulk-IN transfer in flight.
+    struct cusb_pkt *tx_busy;
+
+    /// @private Bytes of @ref resp to send, 0 if none.
+    uint16_t resp_len;
+
+    /// @private Control message from the host.
+    uint8_t cmd[CUSB_RNDIS_CONTROL_MAX];
+
+    /// @private Response to it.
+    uint8_t resp[CUSB_RNDIS_CONTROL_MAX];
+
+#if (CUSB_CFG_STATS)
+    /// @private Statistics.
+    struct cusb_rndis_stats stats;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*-------------------- RNDIS MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief RNDIS constructor. The link starts up.
+ *
+ * @param me RNDIS function to construct.
+ * @param api Application callbacks. Must remain valid for the lifetime of @p me.
+ * @param ctx Passed to every callback. Optional, can be NULL.
+ * @param pool Transfer buffers of at least @ref CUSB_RNDIS_BUFFER_MIN
+ * bytes, 2 or more. Must remain valid for the lifetime of @p me.
+ * @param mac MAC address the host sees as the adapter's. Copied.
+ * @param packet_size Bulk endpoint max packet size. 512 reports a
+ * high-speed link.
+ */
+extern void cusb_rndis_ctor(struct cusb_rndis *me,
+                            const struct cusb_rndis_api *api,
+                            void *ctx,
+                            struct cusb_pktpool *pool,
+                            const uint8_t *mac,
+                            uint16_t packet_size);
+/**@}*/
+
+/**
+ * @name Application Interface
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_rndis_ctor().
+ * @brief Returns where to write a frame of up to @p len bytes for the
+ * host, inside the next Bulk-IN transfer. Returns NULL, and counts a
+ * dropped frame, if the host has not enabled the data path or no buffer
+ * is free.
+ *
+ * @param me RNDIS function.
+ * @param len Most bytes of the frame, up to @ref CUSB_RNDIS_FRAME_MAX.
+ */
+extern uint8_t *cusb_rndis_tx_alloc(struct cusb_rndis *me, uint32_t len);
+
+/**
+ * @pre Space returned by the last @ref cusb_rndis_tx_alloc().
+ * @brief Queues the frame written there.
+ *
+ * @param me RNDIS function.
+ * @param len Bytes of the frame, at most what was allocated.
+ */
+extern void cusb_rndis_tx_commit(struct cusb_rndis *me, uint32_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_rndis_ctor().
+ * @brief Reports the link state to the host, through a status
+ * indication once it initialized the function.
+ *
+ * @param me RNDIS function.
+ * @param up True if the link is up.
+ */
+extern void cusb_rndis_set_link(struct cusb_rndis *me, bool up);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_rndis_ctor().
+ * @brief Returns true once the host enabled the data path.
+ *
+ * @param me RNDIS function.
+ */
+extern bool cusb_rndis_online(const struct cusb_rndis *me);
+
+#if (CUSB_CFG_STATS)
+/**
+ * @pre @p me previously constructed via @ref cusb_rndis_ctor().
+ * @brief Returns the statistics. Only exists when @ref CUSB_CFG_STATS
+ * is 1.
+ *
+ * @param me RNDIS function.
+ */
+extern const struct cusb_rndis_stats *cusb_rndis_get_stats(const struct cusb_rndis *me);
+#endif
+/**@}*/
+
+/**
+ * @name Transport
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_rndis_ctor().
+ * @brief Handles a class request to the communication interface.
+ * Arguments and return value as @ref cusb_device_callbacks.control.
+ *
+ * @param me RNDIS function.
+ * @param setup The 8 byte SETUP packet.
+ * @param data Data stage buffer.
+ * @param len Bytes in @p data.
+ */
+extern bool cusb_rndis_control(struct cusb_rndis *me, const uint8_t *setup, uint8_t **data, uint16_t *len);
+
+/**
+ * @pre @ref cusb_rndis_control() accepted the request.
+ * @brief Handles the control message its OUT data stage carried.
+ * Arguments and return value as @ref cusb_device_callbacks.control_out.
+ *
+ * @param me RNDIS function.
+ * @param setup The 8 byte SETUP packet.
+ * @param data Data stage buffer.
+ * @param len Bytes in @p data.
+ */
+extern bool cusb_rndis_control_out(struct cusb_rndis *me, const uint8_t *setup, const uint8_t *data, uint16_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_rndis_ctor() and no
+ * Bulk-OUT buffer armed.
+ * @brief Returns the buffer to arm the Bulk-OUT endpoint with, and its
+ * size in @p size. Returns NULL if none is free. Try again once the
+ * application released a frame.
+ *
+ * @param me RNDIS function.
+ * @param size Bytes in the buffer.
+ */
+extern uint8_t *cusb_rndis_rx_arm(struct cusb_rndis *me, uint32_t *size);
+
+/**
+ * @pre A buffer from @ref cusb_rndis_rx_arm() was filled.
+ * @brief Hands the frames of a completed Bulk-OUT transfer to the
+ * application.
+ *
+ * @param me RNDIS function.
+ * @param len Bytes received.
+ */
+extern void cusb_rndis_bulk_out(struct cusb_rndis *me, uint32_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_rndis_ctor().
+ * @brief Hands out the next Bulk-IN transfer if one is waiting and none
+ * is in flight. Returns true if so. @p buf stays owned by the class and
+ * must not be modified.
+ *
+ * @param me RNDIS function.
+ * @param buf Transfer buffer.
+ * @param len Bytes to send. Never a multiple of the packet size.
+ */
+extern bool cusb_rndis_bulk_in(struct cusb_rndis *me, uint8_t **buf, uint32_t *len);
+
+/**
+ * @pre A transfer handed out by @ref cusb_rndis_bulk_in() completed.
+ * @brief Returns its buffer to the pool. Calls @ref cusb_rndis_api.ready
+ * if another one is waiting.
+ *
+ * @param me RNDIS function.
+ */
+extern void cusb_rndis_in_complete(struct cusb_rndis *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_rndis_ctor().
+ * @brief Returns every buffer held to the pool and waits for the host to
+ * initialize the function again. Call on bus reset and
+ * SET_CONFIGURATION, after the endpoints were closed.
+ *
+ * @param me RNDIS function.
+ */
+extern void cusb_rndis_reset(struct cusb_rndis *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_RNDIS_H_ */
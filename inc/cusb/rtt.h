@@ -0,0 +1,279 @@
+/**
+ * @file
+ * @brief In-memory trace sink a debugger drains while the target runs.
+ * Log text and binary trace records go into lock-free rings described by
+ * a control block in the SEGGER RTT layout, so J-Link, OpenOCD
+ * ("rtt setup") and probe-rs find it by its ID string and read it over
+ * the debug port without halting the core.
+ * @details Writing never blocks and never touches a peripheral. A record
+ * that does not fit in the free space is dropped whole and counted. Up
+ * channel 0 carries text written with @ref cusb_rtt_log(), up channel 1
+ * fixed size binary records written with @ref cusb_rtt_trace(). With
+ * @ref CUSB_CFG_TRACE_RTT the library defines @ref cusb_trace() itself
+ * and sends every trace point to the ring set with
+ * @ref cusb_rtt_set_trace().
+ *
+ * Writers may preempt each other, i.e. thread, USB interrupt and other
+ * interrupts, on one core. Each claims its bytes with a compare and swap
+ * and copies them. The offset the reader sees only moves once the
+ * outermost writer is done, so a debugger never reads a record that an
+ * interrupted writer has not finished. Needs 32-bit lock-free atomics,
+ * i.e. Cortex-M3 and up or any Linux host.
+ *
+ * Trace records are @ref CUSB_RTT_RECORD_SIZE bytes, little endian:
+ *
+ * | Offset | Size | Field                                         |
+ * |--------|------|-----------------------------------------------|
+ * | 0      | 4    | Timestamp from the tick source, 0 if none.    |
+ * | 4      | 2    | Event, see @ref cusb/trace.h.                 |
+ * | 6      | 2    | Records dropped before this one, saturating.  |
+ * | 8      | 4    | Argument.                                     |
+ *
+ * Records are in the order their writers claimed space. A writer that
+ * preempts another between its claim and its timestamp puts an earlier
+ * time after it, so sort by timestamp where order matters.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_RTT_H_
+#define CUSB_RTT_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Up Channels
+ */
+/**@{*/
+#define CUSB_RTT_LOG                        (0U)    /**< Text, "Terminal". */
+#define CUSB_RTT_TRACE                      (1U)    /**< Binary trace records, "cusb trace". */
+#define CUSB_RTT_CHANNELS                   (2U)
+/**@}*/
+
+/**
+ * @brief Bytes per trace record.
+ */
+#define CUSB_RTT_RECORD_SIZE                (12U)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief One ring, laid out like SEGGER_RTT_BUFFER_UP. The writer owns
+ * @ref wr_off, the reader @ref rd_off.
+ */
+struct cusb_rtt_buffer
+{
+    /// @brief Channel name shown by the debugger.
+    const char *name;
+
+    /// @brief Ring storage.
+    uint8_t *buf;
+
+    /// @brief Bytes in @ref buf. One is always left free.
+    uint32_t size;
+
+    /// @brief Offset the next published byte goes to.
+    volatile uint32_t wr_off;
+
+    /// @brief Offset of the next byte the reader takes.
+    volatile uint32_t rd_off;
+
+    /// @brief Mode. 0, i.e. skip records that do not fit.
+    uint32_t flags;
+};
+
+/**
+ * @brief Control block, laid out like SEGGER_RTT_CB with no down
+ * channels. Debuggers look for it by @ref id.
+ */
+struct cusb_rtt_cb
+{
+    /// @brief "SEGGER RTT", written last by @ref cusb_rtt_ctor().
+    char id[16];
+
+    /// @brief Up channels, @ref CUSB_RTT_CHANNELS.
+    int32_t max_up;
+
+    /// @brief Down channels, 0.
+    int32_t max_down;
+
+    /// @brief Up channels.
+    struct cusb_rtt_buffer up[CUSB_RTT_CHANNELS];
+};
+
+/**
+ * @brief Sink statistics. Counters wrap around.
+ */
+struct cusb_rtt_stats
+{
+    /// @brief Writes and records that went into a ring.
+    uint32_t written;
+
+    /// @brief Writes and records dropped for lack of space.
+    uint32_t dropped;
+};
+
+/**
+ * @brief Trace sink. Only modify through API.
+ */
+struct cusb_rtt
+{
+    /// @private What the debugger reads.
+    struct cusb_rtt_cb cb;
+
+    /// @private Offset after the last claimed byte, per channel.
+    uint32_t claim[CUSB_RTT_CHANNELS];
+
+    /// @private Writers inside a channel.
+    uint32_t writers[CUSB_RTT_CHANNELS];
+
+    /// @private Trace records dropped since the last one written.
+    uint32_t lost;
+
+    /// @private Timestamp source. NULL for none.
+    uint32_t (*now)(void);
+
+#if (CUSB_CFG_STATS)
+    /// @private Statistics.
+    struct cusb_rtt_stats stats;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- RTT MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me, @p log and @p trace.
+ * @brief Constructor. Publishes the control block.
+ *
+ * @param me Sink to construct. Place it in RAM the debugger scans.
+ * @param log Ring of the log channel. Must remain valid for the lifetime
+ * of @p me.
+ * @param log_size Bytes in @p log, at least 2.
+ * @param trace Ring of the trace channel. Must remain valid for the
+ * lifetime of @p me.
+ * @param trace_size Bytes in @p trace, more than
+ * @ref CUSB_RTT_RECORD_SIZE.
+ * @param now Timestamp source for trace records, e.g.
+ * @ref cusb_load_cycles(). Optional, can be NULL.
+ */
+extern void cusb_rtt_ctor(struct cusb_rtt *me,
+                          uint8_t *log,
+                          size_t log_size,
+                          uint8_t *trace,
+                          size_t trace_size,
+                          uint32_t (*now)(void));
+/**@}*/
+
+/**
+ * @name Writer Functions
+ * Callable from any context, interrupts included.
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_rtt_ctor().
+ * @brief Writes @p len bytes to @p channel in one piece, or nothing if
+ * they do not fit. Returns true if written.
+ *
+ * @param me Sink.
+ * @param channel @ref CUSB_RTT_LOG or @ref CUSB_RTT_TRACE.
+ * @param data Bytes to write.
+ * @param len Number of bytes.
+ */
+extern bool cusb_rtt_write(struct cusb_rtt *me, uint8_t channel, const void *data, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_rtt_ctor().
+ * @brief Writes NUL-terminated @p text to the log channel. No
+ * formatting, so it costs a copy and nothing more.
+ *
+ * @param me Sink.
+ * @param text Text, typically a literal ending in a newline.
+ */
+extern bool cusb_rtt_log(struct cusb_rtt *me, const char *text);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_rtt_ctor().
+ * @brief Writes one trace record to the trace channel.
+ *
+ * @param me Sink.
+ * @param event Event, see @ref cusb/trace.h.
+ * @param arg Event specific argument.
+ */
+extern bool cusb_rtt_trace(struct cusb_rtt *me, uint16_t event, uint32_t arg);
+
+#if (CUSB_CFG_TRACE_RTT)
+/**
+ * @pre @p me previously constructed via @ref cusb_rtt_ctor().
+ * @brief Sends every @ref CUSB_TRACE() point to @p me. Trace points
+ * before this are dropped. Only exists when @ref CUSB_CFG_TRACE_RTT is 1.
+ *
+ * @param me Sink, NULL to stop.
+ */
+extern void cusb_rtt_set_trace(struct cusb_rtt *me);
+#endif
+/**@}*/
+
+/**
+ * @name Reader Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_rtt_ctor().
+ * @brief Takes up to @p size published bytes out of @p channel, what a
+ * debugger does over the debug port. For host side tests and for
+ * targets that drain the ring themselves, from one context only.
+ * Returns the number of bytes taken.
+ *
+ * @param me Sink.
+ * @param channel @ref CUSB_RTT_LOG or @ref CUSB_RTT_TRACE.
+ * @param buf Destination.
+ * @param size Room in @p buf.
+ */
+extern size_t cusb_rtt_read(struct cusb_rtt *me, uint8_t channel, uint8_t *buf, size_t size);
+
+#if (CUSB_CFG_STATS)
+/**
+ * @pre @p me previously constructed via @ref cusb_rtt_ctor().
+ * @brief Returns the statistics. Only exists when @ref CUSB_CFG_STATS
+ * is 1.
+ *
+ * @param me Sink.
+ */
+extern const struct cusb_rtt_stats *cusb_rtt_get_stats(const struct cusb_rtt *me);
+#endif
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_RTT_H_ */
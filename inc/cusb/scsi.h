@@ -0,0 +1,424 @@
+/**
+ * @file
+ * @brief SCSI block command target shared by the mass storage transports.
+ * @details Decodes CDBs, builds command responses, tracks sense data and
+ * drives the @ref cusb_blockdev backend. It knows nothing about USB. One
+ * @ref cusb_scsi is one logical unit with its own backend. A transport
+ * with several logical units groups them with @ref cusb_scsi_attach(). A
+ * transport (i.e. UAS) owns a set of @ref cusb_scsi_task slots, starts a
+ * command in a free slot with @ref cusb_scsi_task_start() and then moves
+ * data with @ref cusb_scsi_task_data_in() and @ref cusb_scsi_task_data_out()
+ * according to the slot's state. Several tasks can be in progress at once
+ * and their backend requests may complete in any order.
+ *
+ * Each task moves block data through its own buffer in chunks of up to
+ * the buffer size, so a task buffer of one typical host request (i.e.
+ * 4 KiB) keeps one backend request per command.
+ *
+ * Responses to the commands hosts poll with (INQUIRY, READ CAPACITY,
+ * MODE SENSE, REQUEST SENSE while there is nothing to report) are built
+ * once and served straight from the target. The media dependent ones are
+ * rebuilt only when the backend's media generation changes.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_SCSI_H_
+#define CUSB_SCSI_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Block device. */
+#include "cusb/blockdev.h"
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Size of fixed format sense data in bytes.
+ */
+#define CUSB_SCSI_SENSE_SIZE                (18U)
+
+/**
+ * @brief Most logical units per target. REPORT LUNS data for all of them
+ * fits in @ref CUSB_SCSI_TASK_BUFFER_MIN. Set with
+ * @ref CUSB_CFG_SCSI_LUN_MAX.
+ */
+#define CUSB_SCSI_LUN_MAX                   (CUSB_CFG_SCSI_LUN_MAX)
+
+/**
+ * @brief Smallest task buffer. Every non-block response fits.
+ */
+#define CUSB_SCSI_TASK_BUFFER_MIN           (512U)
+
+/**
+ * @name Cached Response Sizes
+ */
+/**@{*/
+#define CUSB_SCSI_INQUIRY_SIZE              (36U)
+#define CUSB_SCSI_CAPACITY_10_SIZE          (8U)
+#define CUSB_SCSI_CAPACITY_16_SIZE          (32U)
+#define CUSB_SCSI_FORMAT_CAPACITIES_SIZE    (12U)
+#define CUSB_SCSI_MODE_SENSE_6_SIZE         (24U)
+#define CUSB_SCSI_MODE_SENSE_10_SIZE        (28U)
+/**@}*/
+
+/**
+ * @name SCSI Status
+ */
+/**@{*/
+#define CUSB_SCSI_STATUS_GOOD               (0x00U)
+#define CUSB_SCSI_STATUS_CHECK_CONDITION    (0x02U)
+#define CUSB_SCSI_STATUS_TASK_SET_FULL      (0x28U)
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Task state. Tells the transport what the task needs next.
+ */
+enum cusb_scsi_task_state
+{
+    CUSB_SCSI_TASK_IDLE,        /**< Slot is free. */
+    CUSB_SCSI_TASK_WAIT,        /**< Waiting for the backend. */
+    CUSB_SCSI_TASK_DATA_IN,     /**< Data is ready to be sent to the host. */
+    CUSB_SCSI_TASK_DATA_OUT,    /**< Ready to receive data from the host. */
+    CUSB_SCSI_TASK_DONE         /**< Status (and sense) ready to be returned. */
+};
+
+/**
+ * @brief Standard INQUIRY strings. Shorter strings are padded
+ * with spaces, longer ones truncated.
+ */
+struct cusb_scsi_inquiry
+{
+    const char *vendor;     /**< 8 characters. */
+    const char *product;    /**< 16 characters. */
+    const char *revision;   /**< 4 characters. */
+};
+
+/**
+ * @brief Sense key and additional sense code.
+ */
+struct cusb_scsi_sense
+{
+    uint8_t key;
+    uint8_t asc;
+    uint8_t ascq;
+};
+
+/**
+ * @brief SCSI logical unit. Only modify through API.
+ */
+struct cusb_scsi
+{
+    /// @private Backend.
+    struct cusb_blockdev *dev;
+
+    /// @private INQUIRY strings.
+    const struct cusb_scsi_inquiry *inquiry;
+
+    /// @private Sense of the last failed command. Returned by REQUEST SENSE.
+    struct cusb_scsi_sense sense;
+
+    /// @private Last media generation reported to the host.
+    uint8_t generation;
+
+    /// @private Host prevents medium removal.
+    bool prevent_removal;
+
+    /// @private Number of logical units of the target, for REPORT LUNS.
+    uint8_t nluns;
+
+    /// @private Prebuilt responses. Each fits in one packet, so a rebuild
+    /// never tears a response another task is sending.
+    struct
+    {
+        /// @private Media generation the media dependent responses were built for.
+        uint8_t generation;
+
+        /// @private Standard INQUIRY data. Built once.
+        uint8_t inquiry[CUSB_SCSI_INQUIRY_SIZE];
+
+        /// @private READ CAPACITY(10) data.
+        uint8_t capacity_10[CUSB_SCSI_CAPACITY_10_SIZE];
+
+        /// @private READ CAPACITY(16) data.
+        uint8_t capacity_16[CUSB_SCSI_CAPACITY_16_SIZE];
+
+        /// @private READ FORMAT CAPACITIES data.
+        uint8_t format_capacities[CUSB_SCSI_FORMAT_CAPACITIES_SIZE];
+
+        /// @private MODE SENSE(6) data. Caching mode page.
+        uint8_t mode_sense_6[CUSB_SCSI_MODE_SENSE_6_SIZE];
+
+        /// @private MODE SENSE(10) data. Caching mode page.
+        uint8_t mode_sense_10[CUSB_SCSI_MODE_SENSE_10_SIZE];
+    } cache;
+};
+
+/**
+ * @brief One command slot. Only modify through API. The transport
+ * reads @ref state, @ref status and @ref sense directly.
+ */
+struct cusb_scsi_task
+{
+    /// @brief @ref cusb_scsi_task_state.
+    volatile uint8_t state;
+
+    /// @brief SCSI status once @ref CUSB_SCSI_TASK_DONE.
+    uint8_t status;
+
+    /// @brief Sense once @ref CUSB_SCSI_TASK_DONE with CHECK CONDITION.
+    struct cusb_scsi_sense sense;
+
+    /// @brief Transport's tag for the command. Not used by the target.
+    uint16_t tag;
+
+    /// @brief Transport-specific flags. Not used by the target.
+    uint8_t flags;
+
+    /// @private Target running the command.
+    struct cusb_scsi *target;
+
+    /// @private Data buffer.
+    uint8_t *buf;
+
+    /// @private Data-in source. @ref buf, a cached response of the target
+    /// or the mapped media.
+    const uint8_t *src;
+
+    /// @private Data-out destination. @ref buf or the mapped media.
+    uint8_t *dst;
+
+    /// @private Size of @ref buf.
+    uint32_t buf_size;
+
+    /// @private Valid bytes in @ref buf (data in) or bytes wanted (data out).
+    uint32_t buf_len;
+
+    /// @private Bytes of @ref buf already moved over the bus.
+    uint32_t buf_pos;
+
+    /// @private Data bytes the CDB asks for.
+    uint32_t expected;
+
+    /// @private Data bytes the command will actually move.
+    uint32_t xfer_len;
+
+    /// @private Data bytes moved over the bus so far.
+    uint32_t xfer_done;
+
+    /// @private Next block to read or write.
+    uint32_t lba;
+
+    /// @private Blocks left to read or write.
+    uint32_t blocks;
+
+    /// @private Command is a data out (host to device) command.
+    bool out;
+
+    /// @private Task was aborted while waiting for the backend.
+    bool aborted;
+
+    /// @private Backend request.
+    struct cusb_blockdev_req req;
+
+    /// @private Called when a backend completion changes @ref state.
+    void (*notify)(void *ctx, struct cusb_scsi_task *task);
+
+    /// @private Passed to @ref notify.
+    void *notify_ctx;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------- SCSI MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief SCSI logical unit constructor.
+ *
+ * @param me Logical unit to construct.
+ * @param dev Backend. Must remain valid for the lifetime of @p me.
+ * @param inquiry INQUIRY strings. Must remain valid for the lifetime of @p me.
+ */
+extern void cusb_scsi_ctor(struct cusb_scsi *me,
+                           struct cusb_blockdev *dev,
+                           const struct cusb_scsi_inquiry *inquiry);
+
+/**
+ * @pre Memory already allocated for @p task.
+ * @brief Task slot constructor. Used by transports.
+ *
+ * @param task Task to construct.
+ * @param buf Data buffer. Must hold at least @ref CUSB_SCSI_TASK_BUFFER_MIN
+ * bytes and be a multiple of the block size.
+ * @param buf_size Size of @p buf.
+ * @param notify Called from the backend's completion context whenever a
+ * backend completion changes the task's state.
+ * @param notify_ctx Passed to @p notify.
+ */
+extern void cusb_scsi_task_ctor(struct cusb_scsi_task *task,
+                                uint8_t *buf,
+                                size_t buf_size,
+                                void (*notify)(void *ctx, struct cusb_scsi_task *task),
+                                void *notify_ctx);
+/**@}*/
+
+/**
+ * @name Transport Interface
+ */
+/**@{*/
+/**
+ * @brief Groups @p nluns logical units into one target. Called by the
+ * transport's constructor. Element i is LUN i.
+ *
+ * @param luns Logical units.
+ * @param nluns Number of elements in @p luns. At most @ref CUSB_SCSI_LUN_MAX.
+ */
+extern void cusb_scsi_attach(struct cusb_scsi *luns, size_t nluns);
+
+/**
+ * @pre @p task is @ref CUSB_SCSI_TASK_IDLE.
+ * @brief Starts a command. On return the task is either finished
+ * (@ref CUSB_SCSI_TASK_DONE), has a data phase ready, or is waiting for
+ * the backend.
+ *
+ * @param me Target.
+ * @param task Free task slot.
+ * @param cdb Command descriptor block.
+ * @param cdb_len Number of bytes in @p cdb. At most 16.
+ */
+extern void cusb_scsi_task_start(struct cusb_scsi *me, struct cusb_scsi_task *task,
+                                 const uint8_t *cdb, size_t cdb_len);
+
+/**
+ * @pre @p task is @ref CUSB_SCSI_TASK_DATA_IN.
+ * @brief Copies up to @p size data-in bytes into @p buf. Returns number
+ * of bytes copied. Starts the next backend read once the task buffer is
+ * drained.
+ *
+ * @param task Task.
+ * @param buf Destination, i.e. the endpoint's transfer buffer.
+ * @param size Size of @p buf.
+ */
+extern size_t cusb_scsi_task_data_in(struct cusb_scsi_task *task, uint8_t *buf, size_t size);
+
+/**
+ * @pre @p task has data-out bytes left, see @ref cusb_scsi_task_data_out_left().
+ * @brief Takes @p len data-out bytes received from the host. Starts a
+ * backend write once the task buffer is full. Bytes of a command that
+ * already failed are dropped.
+ *
+ * @param task Task.
+ * @param data Received bytes.
+ * @param len Number of bytes in @p data.
+ */
+extern void cusb_scsi_task_data_out(struct cusb_scsi_task *task, const uint8_t *data, size_t len);
+
+/**
+ * @brief Host ended the data-out phase of @p task before sending every
+ * byte. The command fails with a data phase error once no backend write
+ * is in flight, and @ref cusb_scsi_task_data_out_left() returns 0.
+ *
+ * @param task Task.
+ */
+extern void cusb_scsi_task_data_out_end(struct cusb_scsi_task *task);
+
+/**
+ * @brief Returns the number of data-out bytes the host still has to send
+ * for @p task, including bytes that will be dropped because it failed
+ * during the data phase. 0 if it failed before the data phase started.
+ *
+ * @param task Task.
+ */
+extern uint32_t cusb_scsi_task_data_out_left(const struct cusb_scsi_task *task);
+
+/**
+ * @brief Returns the number of data-out bytes @p task can take right
+ * now. 0 while a backend write is in flight.
+ *
+ * @param task Task.
+ */
+extern uint32_t cusb_scsi_task_data_out_space(const struct cusb_scsi_task *task);
+
+/**
+ * @brief Returns true once all data-in bytes of @p task were sent, or
+ * the command ended early. Returns true for commands without data-in.
+ *
+ * @param task Task.
+ */
+extern bool cusb_scsi_task_data_in_done(const struct cusb_scsi_task *task);
+
+/**
+ * @brief Returns the number of data bytes the CDB of @p task asked for.
+ *
+ * @param task Task.
+ */
+extern uint32_t cusb_scsi_task_expected(const struct cusb_scsi_task *task);
+
+/**
+ * @brief Returns the number of data bytes moved over the bus so far.
+ *
+ * @param task Task.
+ */
+extern uint32_t cusb_scsi_task_transferred(const struct cusb_scsi_task *task);
+
+/**
+ * @brief Writes fixed format sense data of @p task into @p buf of
+ * @ref CUSB_SCSI_SENSE_SIZE bytes.
+ *
+ * @param task Task.
+ * @param buf Destination.
+ */
+extern void cusb_scsi_task_sense(const struct cusb_scsi_task *task, uint8_t *buf);
+
+/**
+ * @brief Aborts @p task. If a backend request is in flight the slot stays
+ * @ref CUSB_SCSI_TASK_WAIT until it completes, then becomes idle and the
+ * transport is notified so it can reuse the slot. Otherwise the slot is
+ * idle on return, without a notification.
+ *
+ * @param task Task.
+ */
+extern void cusb_scsi_task_abort(struct cusb_scsi_task *task);
+
+/**
+ * @pre @p task is @ref CUSB_SCSI_TASK_DONE.
+ * @brief Frees @p task once its status was returned.
+ *
+ * @param task Task.
+ */
+extern void cusb_scsi_task_free(struct cusb_scsi_task *task);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_SCSI_H_ */
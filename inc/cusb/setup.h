@@ -0,0 +1,145 @@
+/**
+ * @file
+ * @brief Field views of SETUP packets and of the standard descriptors.
+ * Each reads one field in place from the packet or descriptor bytes,
+ * with any alignment, so a request handler never copies the 8 byte
+ * packet into a struct to look at it.
+ * @details Multi-byte fields are little endian on the bus and read with
+ * @ref cusb/endian.h, i.e. a single halfword load on Cortex-M3 and up.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_SETUP_H_
+#define CUSB_SETUP_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Endian accessors. */
+#include "cusb/endian.h"
+
+/* STDLib. */
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Bytes in a SETUP packet.
+ */
+#define CUSB_SETUP_SIZE                     (8U)
+
+/**
+ * @name bmRequestType
+ */
+/**@{*/
+#define CUSB_SETUP_DIR_IN                   (0x80U)     /**< Data stage, if any, is IN. */
+#define CUSB_SETUP_TYPE_MASK                (0x60U)
+#define CUSB_SETUP_TYPE_STANDARD            (0x00U)
+#define CUSB_SETUP_TYPE_CLASS               (0x20U)
+#define CUSB_SETUP_TYPE_VENDOR              (0x40U)
+#define CUSB_SETUP_RECIPIENT_MASK           (0x1FU)
+#define CUSB_SETUP_RECIPIENT_DEVICE         (0U)
+#define CUSB_SETUP_RECIPIENT_INTERFACE      (1U)
+#define CUSB_SETUP_RECIPIENT_ENDPOINT       (2U)
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*----------------------- FIELD VIEWS ------------------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name SETUP Packet
+ * @p setup is the @ref CUSB_SETUP_SIZE byte packet.
+ */
+/**@{*/
+static inline uint8_t cusb_setup_request_type(const uint8_t *setup)
+{
+    return setup[0];
+}
+
+static inline uint8_t cusb_setup_request(const uint8_t *setup)
+{
+    return setup[1];
+}
+
+static inline uint16_t cusb_setup_value(const uint8_t *setup)
+{
+    return cusb_get_le16(&setup[2]);
+}
+
+static inline uint16_t cusb_setup_index(const uint8_t *setup)
+{
+    return cusb_get_le16(&setup[4]);
+}
+
+static inline uint16_t cusb_setup_length(const uint8_t *setup)
+{
+    return cusb_get_le16(&setup[6]);
+}
+/**@}*/
+
+/**
+ * @name Device Descriptor
+ * @p desc is the 18 byte descriptor.
+ */
+/**@{*/
+static inline uint16_t cusb_desc_bcd_usb(const uint8_t *desc)
+{
+    return cusb_get_le16(&desc[2]);
+}
+
+static inline uint16_t cusb_desc_vendor(const uint8_t *desc)
+{
+    return cusb_get_le16(&desc[8]);
+}
+
+static inline uint16_t cusb_desc_product(const uint8_t *desc)
+{
+    return cusb_get_le16(&desc[10]);
+}
+
+static inline uint16_t cusb_desc_bcd_device(const uint8_t *desc)
+{
+    return cusb_get_le16(&desc[12]);
+}
+/**@}*/
+
+/**
+ * @name Configuration And Endpoint Descriptors
+ */
+/**@{*/
+/**
+ * @brief wTotalLength of configuration descriptor @p desc, i.e. the bytes
+ * of it and everything that follows it.
+ */
+static inline uint16_t cusb_desc_total_length(const uint8_t *desc)
+{
+    return cusb_get_le16(&desc[2]);
+}
+
+/**
+ * @brief Max packet size of endpoint descriptor @p desc, without the high
+ * bandwidth bits.
+ */
+static inline uint16_t cusb_desc_max_packet_size(const uint8_t *desc)
+{
+    return (uint16_t)(cusb_get_le16(&desc[4]) & 0x07FFU);
+}
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_SETUP_H_ */
@@ -0,0 +1,429 @@
+/**
+ * @file
+ * @brief Simulated device controller. A @ref cusb_dcd whose "registers"
+ * are plain memory and whose bus is driven by host functions called from
+ * a test or benchmark.
+ * @details The model follows a typical full/high-speed controller. A
+ * status word latches bus events (reset, SETUP, SOF, suspend, resume)
+ * and a second one holds one transfer complete bit per endpoint. Host
+ * tokens move at most one packet. An endpoint not armed with a transfer
+ * answers NAK, a halted one STALL, and a completed transfer stays NAKing
+ * until the device core has serviced its bit and armed it again, exactly
+ * like the hardware does while its interrupt is pending.
+ *
+ * Both modes of @ref cusb/device.h work against it. With the interrupt
+ * unmasked, every event the host causes invokes the irq function given to
+ * @ref cusb_sim_ctor() synchronously, before the host function returns,
+ * the same way a real interrupt preempts whatever was running. With it
+ * masked, events wait in the status words until the application polls.
+ * The host-side control transfer helper calls an idle function each time
+ * it is NAKed, which is where a test lets the polled device run.
+ *
+ * With @ref cusb_sim_set_dma() the controller moves endpoint data other
+ * than EP0's by DMA, asynchronously to the bus. The engine only runs when
+ * the test calls @ref cusb_sim_dma_run(), each step moving one packet:
+ *      - IN data is fetched from memory up to two packets ahead of the
+ *      bus. IN tokens are NAKed until the next packet was fetched.
+ *      - OUT packets are acknowledged into a receive FIFO shared by every
+ *      endpoint, @ref CUSB_SIM_RX_FIFO bytes, and NAKed while it is full.
+ *      The engine writes them to memory in arrival order and the
+ *      transfer completes once the last one landed, with the rest of its
+ *      last granule filled with 0xA5 as a word-wide engine would.
+ * Buffers that break the engine's constraints assert, as they would
+ * fault on hardware, and so does an IN buffer changed while it belonged
+ * to the engine.
+ *
+ * Not thread-safe. Host functions and the device run in one thread.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_SIM_H_
+#define CUSB_SIM_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* CUSB. */
+#include "cusb/dcd.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Handshakes
+ * Outcome of a host token.
+ */
+/**@{*/
+#define CUSB_SIM_ACK                        (0)
+#define CUSB_SIM_NAK                        (1)
+#define CUSB_SIM_STALL                      (2)
+#define CUSB_SIM_TIMEOUT                    (3)     /**< No answer: endpoint closed, device disconnected or NAKed too often. */
+/**@}*/
+
+/**
+ * @brief NAKs @ref cusb_sim_host_control() accepts per packet before it
+ * gives up with @ref CUSB_SIM_TIMEOUT.
+ */
+#define CUSB_SIM_RETRIES                    (1000U)
+
+/**
+ * @brief Bytes of the shared receive FIFO in DMA mode, packet headers
+ * included.
+ */
+#define CUSB_SIM_RX_FIFO                    (4096U)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Simulator statistics. Counters wrap around.
+ */
+struct cusb_sim_stats
+{
+    /// @brief Times the irq function was invoked.
+    uint32_t interrupts;
+
+    /// @brief Data packets acknowledged, both directions.
+    uint32_t packets;
+
+    /// @brief Tokens answered with NAK.
+    uint32_t naks;
+
+#if (CUSB_CFG_DMA)
+    /// @brief Packets the DMA engine moved, both directions.
+    uint32_t dma_packets;
+#endif
+};
+
+/**
+ * @private
+ * @brief One endpoint direction of the simulated controller.
+ */
+struct cusb_sim_ep
+{
+    /// @private Buffer of the armed transfer.
+    uint8_t *buf;
+
+    /// @private Length of the armed transfer.
+    uint32_t len;
+
+    /// @private Bytes moved so far. Holds the final length once complete.
+    uint32_t count;
+
+    /// @private Max packet size.
+    uint16_t mps;
+
+    /// @private Endpoint is open.
+    bool open;
+
+    /// @private Transfer armed and not yet complete.
+    bool armed;
+
+    /// @private Endpoint is halted.
+    bool stalled;
+
+    /// @private Transfer completed without babble.
+    bool ok;
+
+#if (CUSB_CFG_DMA)
+    /// @private IN: bytes fetched from memory. OUT: bytes received into
+    /// the FIFO.
+    uint32_t dma;
+
+    /// @private IN: bytes are left to fetch. OUT: the last packet is in
+    /// the FIFO, not yet in memory.
+    bool dma_busy;
+
+    /// @private Hash of an IN buffer when it was armed.
+    uint32_t hash;
+#endif
+};
+
+/**
+ * @brief Simulated controller. Only modify through API.
+ */
+struct cusb_sim
+{
+    /// @private Driver interface handed to the device core.
+    struct cusb_dcd dcd;
+
+    /// @private Endpoints by [direction][number], OUT first.
+    struct cusb_sim_ep ep[2][CUSB_CFG_ENDPOINTS];
+
+    /// @private Last SETUP packet.
+    uint8_t setup[8];
+
+    /// @private Latched bus events.
+    volatile uint32_t status;
+
+    /// @private Transfer complete bits. Bit n for OUT n, bit 16 + n for
+    /// IN n.
+    volatile uint32_t done;
+
+    /// @private Frame number.
+    uint16_t frame;
+
+    /// @private Speed reported on bus reset.
+    uint8_t speed;
+
+    /// @private Device address.
+    uint8_t address;
+
+    /// @private Address applied once the next EP0 IN status stage
+    /// completes.
+    uint8_t new_address;
+
+    /// @private @ref new_address is valid.
+    bool address_pending;
+
+    /// @private Pull-up enabled.
+    bool connected;
+
+    /// @private Interrupt unmasked.
+    bool irq_enabled;
+
+    /// @private Irq function is running.
+    bool in_irq;
+
+    /// @private Interrupt vector.
+    void (*irq)(void *obj);
+
+    /// @private Passed to @ref irq.
+    void *irq_obj;
+
+    /// @private Called by the host helper on every NAK.
+    void (*idle)(void *obj);
+
+    /// @private Passed to @ref idle.
+    void *idle_obj;
+
+    /// @private Statistics.
+    struct cusb_sim_stats stats;
+
+#if (CUSB_CFG_DMA)
+    /// @private Engine constraints.
+    struct cusb_dcd_dma dma;
+
+    /// @private Shared receive FIFO. Each packet is a header byte, the
+    /// endpoint number with bit 7 set for the last packet of a transfer,
+    /// two length bytes and the data.
+    uint8_t rx[CUSB_SIM_RX_FIFO];
+
+    /// @private Bytes in @ref rx.
+    uint16_t rx_used;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- SIM MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Constructor. Pass &me->dcd to @ref cusb_device_ctor().
+ *
+ * @param me Simulator to construct.
+ * @param speed Speed reported on bus reset.
+ * @param irq Interrupt vector, typically calling @ref cusb_isr(). Invoked
+ * whenever an event is pending while the interrupt is unmasked. Optional,
+ * can be NULL for polled mode only.
+ * @param irq_obj Passed to @p irq. Optional, can be NULL.
+ */
+extern void cusb_sim_ctor(struct cusb_sim *me, uint8_t speed, void (*irq)(void *obj), void *irq_obj);
+/**@}*/
+
+/**
+ * @name Host Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Sets the function @ref cusb_sim_host_control() calls each time
+ * it is NAKed, i.e. the polled device's main loop.
+ *
+ * @param me Simulator.
+ * @param idle Idle function. NULL for none.
+ * @param obj Passed to @p idle. Optional, can be NULL.
+ */
+extern void cusb_sim_set_idle(struct cusb_sim *me, void (*idle)(void *obj), void *obj);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Drives a bus reset. Every endpoint but EP0 closes and the
+ * address goes back to 0.
+ *
+ * @param me Simulator.
+ */
+extern void cusb_sim_host_reset(struct cusb_sim *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Sends a SETUP packet. Always acknowledged. Cancels any EP0
+ * transfer and clears an EP0 halt.
+ *
+ * @param me Simulator.
+ * @param setup The 8 byte packet.
+ */
+extern void cusb_sim_host_setup(struct cusb_sim *me, const uint8_t *setup);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Sends one OUT data packet of at most max packet size. Returns
+ * the handshake.
+ *
+ * @param me Simulator.
+ * @param ep OUT endpoint address.
+ * @param data Packet. Can be NULL if @p len is 0.
+ * @param len Packet length.
+ */
+extern int cusb_sim_host_out(struct cusb_sim *me, uint8_t ep, const uint8_t *data, uint16_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Sends one IN token. Returns the handshake. On ACK the packet is
+ * copied to @p buf and its length stored in @p len.
+ *
+ * @param me Simulator.
+ * @param ep IN endpoint address.
+ * @param buf Where the packet goes. Room for max packet size bytes.
+ * @param len Length of the packet received.
+ */
+extern int cusb_sim_host_in(struct cusb_sim *me, uint8_t ep, uint8_t *buf, uint16_t *len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Runs a whole control transfer on EP0: SETUP, data stage and
+ * status stage, retrying NAKed packets up to @ref CUSB_SIM_RETRIES
+ * times. Returns the first handshake that is not an ACK, or
+ * @ref CUSB_SIM_ACK.
+ *
+ * @param me Simulator.
+ * @param setup The 8 byte SETUP packet.
+ * @param data Data stage, wLength bytes. IN replies are stored here. Can
+ * be NULL if wLength is 0.
+ * @param len Bytes actually moved in the data stage. Optional, can be
+ * NULL.
+ */
+extern int cusb_sim_host_control(struct cusb_sim *me, const uint8_t *setup, uint8_t *data, uint16_t *len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Sends a start of frame.
+ *
+ * @param me Simulator.
+ */
+extern void cusb_sim_host_sof(struct cusb_sim *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Suspends (@p suspend true) or resumes the bus.
+ *
+ * @param me Simulator.
+ * @param suspend True to suspend.
+ */
+extern void cusb_sim_host_suspend(struct cusb_sim *me, bool suspend);
+/**@}*/
+
+#if (CUSB_CFG_DMA)
+/**
+ * @name DMA
+ * Only exist when @ref CUSB_CFG_DMA is 1.
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor(), and the
+ * device not constructed yet.
+ * @brief Moves endpoint data other than EP0's by DMA from now on.
+ *
+ * @param me Simulator.
+ * @param dma Engine constraints, copied.
+ */
+extern void cusb_sim_set_dma(struct cusb_sim *me, const struct cusb_dcd_dma *dma);
+
+/**
+ * @pre DMA enabled via @ref cusb_sim_set_dma().
+ * @brief Lets the engine move up to @p budget packets between memory
+ * and the endpoints, OUT first. Returns how many it moved, 0 once it is
+ * idle.
+ *
+ * @param me Simulator.
+ * @param budget Most packets to move.
+ */
+extern size_t cusb_sim_dma_run(struct cusb_sim *me, size_t budget);
+/**@}*/
+#endif
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Returns the address the device answers to.
+ *
+ * @param me Simulator.
+ */
+extern uint8_t cusb_sim_get_address(const struct cusb_sim *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Returns true if the pull-up is enabled.
+ *
+ * @param me Simulator.
+ */
+extern bool cusb_sim_is_connected(const struct cusb_sim *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Returns true if the endpoint address @p ep is halted.
+ *
+ * @param me Simulator.
+ * @param ep Endpoint address.
+ */
+extern bool cusb_sim_is_stalled(const struct cusb_sim *me, uint8_t ep);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Returns true if events are waiting to be serviced.
+ *
+ * @param me Simulator.
+ */
+extern bool cusb_sim_pending(const struct cusb_sim *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_sim_ctor().
+ * @brief Returns the statistics.
+ *
+ * @param me Simulator.
+ */
+extern const struct cusb_sim_stats *cusb_sim_get_stats(const struct cusb_sim *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_SIM_H_ */
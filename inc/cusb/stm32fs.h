@@ -0,0 +1,292 @@
+/**
+ * @file
+ * @brief Device controller driver for the STM32 USB full-speed device
+ * peripheral with 16-bit packet memory access (L4, G4, F0, L0 families).
+ * @details One driver instance per chip. Registers live at
+ * @ref CUSB_STM32FS_BASE and the packet memory (PMA) right after them.
+ * The application enables the peripheral clock, the 48 MHz source and
+ * the USB interrupt in the NVIC before constructing the driver.
+ *
+ * The PMA layout is fixed at compile time: the buffer table, two
+ * @ref CUSB_CFG_EP0_SIZE buffers for EP0 and two buffers of
+ * CUSB_STM32FS_PMA_EPn bytes for every other endpoint number n. A layout
+ * that does not fit is a build error. The driver picks the buffering
+ * when an endpoint opens:
+ *      - Isochronous endpoints are always double-buffered. The hardware
+ *      switches buffers every frame without a handshake, so an IN
+ *      endpoint sends an empty packet in frames with nothing armed and
+ *      an OUT endpoint drops packets that arrive while it is not armed.
+ *      - Bulk endpoints whose number is used in one direction only are
+ *      double-buffered. The hardware moves one packet while the driver
+ *      copies the next, so only the copy of the last packet of a
+ *      transfer is on the bus-visible path. An OUT endpoint NAKs after
+ *      its transfer completed until it is armed again.
+ *      - Everything else, including bulk numbers used in both
+ *      directions, uses one buffer per direction.
+ * Endpoint number n uses endpoint register n, so numbers above 7 are not
+ * available.
+ *
+ * Both modes of @ref cusb/device.h work as usual: the USB interrupt
+ * handler calls @ref cusb_isr() in interrupt mode, and nothing is wired
+ * to it in polled mode. A third, deferred mode keeps the work out of the
+ * interrupt without polling blindly. Construct the driver with a wake
+ * function, start the device in polled mode and have the interrupt
+ * handler call @ref cusb_stm32fs_isr(). It only masks the peripheral's
+ * interrupt sources and calls the wake function, i.e. to release the task
+ * that calls @ref cusb_poll(). Events stay latched in the peripheral and
+ * the poll that drains them unmasks the sources again.
+ * @code{.c}
+ * void USB_IRQHandler(void)
+ * {
+ *     cusb_stm32fs_isr(&usb);      // Deferred mode only.
+ * }
+ * @endcode
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_STM32FS_H_
+#define CUSB_STM32FS_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* CUSB. */
+#include "cusb/dcd.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#ifndef CUSB_STM32FS_BASE
+/**
+ * @brief Base address of the USB peripheral registers. Correct for the
+ * L4 family. Can be overridden by the build system for other families.
+ */
+#define CUSB_STM32FS_BASE                   (0x40006800UL)
+#endif
+
+#ifndef CUSB_STM32FS_PMA_SIZE
+/**
+ * @brief Bytes of packet memory. Can be overridden by the build system,
+ * i.e. 2048 on G4 parts.
+ */
+#define CUSB_STM32FS_PMA_SIZE               (1024U)
+#endif
+
+/**
+ * @brief Endpoint numbers the driver handles, EP0 included.
+ */
+#define CUSB_STM32FS_ENDPOINTS              ((CUSB_CFG_ENDPOINTS < 8U) ? CUSB_CFG_ENDPOINTS : 8U)
+
+/**
+ * @name PMA Layout
+ * Bytes of each of the two packet buffers of endpoint numbers 1 to 7.
+ * Even, and a multiple of 32 above 62. At least the max packet size of
+ * whatever opens on that number. Numbers not below
+ * @ref CUSB_STM32FS_ENDPOINTS take no memory. Defined by the application
+ * in cusb_config.h or by the build system. The defaults give EP1 to EP6
+ * two full-speed bulk packets each.
+ */
+/**@{*/
+#ifndef CUSB_STM32FS_PMA_EP1
+#define CUSB_STM32FS_PMA_EP1                (64U)
+#endif
+#ifndef CUSB_STM32FS_PMA_EP2
+#define CUSB_STM32FS_PMA_EP2                (64U)
+#endif
+#ifndef CUSB_STM32FS_PMA_EP3
+#define CUSB_STM32FS_PMA_EP3                (64U)
+#endif
+#ifndef CUSB_STM32FS_PMA_EP4
+#define CUSB_STM32FS_PMA_EP4                (64U)
+#endif
+#ifndef CUSB_STM32FS_PMA_EP5
+#define CUSB_STM32FS_PMA_EP5                (64U)
+#endif
+#ifndef CUSB_STM32FS_PMA_EP6
+#define CUSB_STM32FS_PMA_EP6                (64U)
+#endif
+#ifndef CUSB_STM32FS_PMA_EP7
+#define CUSB_STM32FS_PMA_EP7                (0U)
+#endif
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @private
+ * @brief One endpoint direction.
+ */
+struct cusb_stm32fs_ep
+{
+    /// @private Buffer of the armed transfer.
+    uint8_t *buf;
+
+    /// @private Length of the armed transfer.
+    uint32_t len;
+
+    /// @private Bytes acknowledged (IN) or received (OUT) so far.
+    uint32_t count;
+
+    /// @private IN: bytes copied to the PMA so far.
+    uint32_t next;
+
+    /// @private Max packet size.
+    uint16_t mps;
+
+    /// @private IN: length of the packet the hardware owns.
+    uint16_t inflight;
+
+    /// @private IN, double-buffered: length of the packet waiting in the
+    /// driver's buffer.
+    uint16_t staged;
+
+    /// @private IN: packets not yet copied to the PMA.
+    uint32_t pkts;
+
+    /// @private Transfer type. Both directions of a number share it.
+    uint8_t type;
+
+    /// @private Endpoint is open.
+    bool open;
+
+    /// @private Double-buffered.
+    bool dbl;
+
+    /// @private Transfer armed and not yet complete.
+    bool armed;
+
+    /// @private IN, double-buffered: @ref staged is valid.
+    bool has_staged;
+
+    /// @private Double-buffered: index of the buffer the driver owns, a
+    /// copy of the SW_BUF bit. Isochronous IN: buffer of the packet in
+    /// flight.
+    uint8_t sw;
+
+    /// @private OUT: a packet did not fit the transfer.
+    bool babble;
+};
+
+/**
+ * @brief Driver. Only modify through API.
+ */
+struct cusb_stm32fs
+{
+    /// @private Driver interface handed to the device core.
+    struct cusb_dcd dcd;
+
+    /// @private Endpoints by [direction][number], OUT first.
+    struct cusb_stm32fs_ep ep[2][CUSB_STM32FS_ENDPOINTS];
+
+    /// @private Called by @ref cusb_stm32fs_isr(). NULL outside deferred
+    /// mode.
+    void (*wake)(void *obj);
+
+    /// @private Passed to @ref wake.
+    void *wake_obj;
+
+    /// @private CNTR control bits, interrupt masks excluded.
+    uint16_t cntr;
+
+    /// @private CNTR interrupt masks of the events reported. Equal to
+    /// their ISTR flags.
+    uint16_t sources;
+
+    /// @private Address applied once the next EP0 IN status stage
+    /// completes.
+    uint8_t new_address;
+
+    /// @private @ref new_address is valid.
+    bool address_pending;
+
+    /// @private Interrupt unmasked by the device core.
+    bool irq_on;
+
+    /// @private @ref cusb_stm32fs_isr() masked the interrupt sources.
+    volatile bool deferred;
+};
+
+/*------------------------------------------------------------*/
+/*------------------- STM32FS MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me. Peripheral clock enabled.
+ * @brief Constructor. Resets the peripheral. Pass &me->dcd to
+ * @ref cusb_device_ctor().
+ *
+ * @param me Driver to construct.
+ * @param sof Report start of frame events, at the cost of one interrupt
+ * every millisecond.
+ * @param wake Called by @ref cusb_stm32fs_isr() for deferred mode.
+ * Optional, can be NULL for interrupt and polled mode.
+ * @param wake_obj Passed to @p wake. Optional, can be NULL.
+ */
+extern void cusb_stm32fs_ctor(struct cusb_stm32fs *me, bool sof, void (*wake)(void *obj), void *wake_obj);
+/**@}*/
+
+/**
+ * @name Member Functions
+ */
+/**@{*/
+/**
+ * @pre @p me constructed with a wake function, device started in polled
+ * mode.
+ * @brief USB interrupt handler body for deferred mode. Masks the
+ * interrupt sources and calls the wake function. The next
+ * @ref cusb_poll() that leaves no event behind unmasks them.
+ *
+ * @param me Driver.
+ */
+extern void cusb_stm32fs_isr(struct cusb_stm32fs *me);
+/**@}*/
+
+#if defined(CUSB_UNIT_TEST)
+/**
+ * @name Bus Access
+ * Unit test builds route every register and PMA access through these
+ * instead of the bus. The test defines them with a model of the
+ * peripheral.
+ */
+/**@{*/
+/**
+ * @brief Reads the 16-bit register or PMA word at @p addr.
+ */
+extern uint16_t cusb_stm32fs_read(uint32_t addr);
+
+/**
+ * @brief Writes @p val to the 16-bit register or PMA word at @p addr.
+ */
+extern void cusb_stm32fs_write(uint32_t addr, uint16_t val);
+/**@}*/
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_STM32FS_H_ */
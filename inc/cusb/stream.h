@@ -0,0 +1,349 @@
+/**
+ * @file
+ * @brief Vendor-class bulk streaming pipe for data acquisition.
+ * @details One @ref cusb_stream object backs one bulk endpoint with an
+ * application-owned circular buffer. A function with several pipes uses
+ * one object per endpoint. Like the other classes it is transport agnostic.
+ *
+ * Data is not copied by the class. For an IN pipe the application
+ * (i.e. an ADC DMA) writes samples straight into the circular buffer and
+ * commits them with @ref cusb_stream_write_commit(). The endpoint glue asks
+ * @ref cusb_stream_in_acquire() for the next transfer, which is one
+ * contiguous segment pointing into the circular buffer, and hands it to the
+ * controller as is. An OUT pipe works
+ * the other way round: the controller receives straight into the free
+ * segments returned by @ref cusb_stream_out_acquire() and the application
+ * drains the data in place.
+ *
+ * IN transfers are only started once at least the watermark number of
+ * bytes is pending, and are always a multiple of the packet size so the
+ * host sees one continuous transfer. @ref cusb_stream_flush() sends what
+ * is left, ended by a short packet or zero length packet. A transfer
+ * reaching the end of the buffer stops at the last packet boundary before
+ * it, and the rest goes out with the next transfer. After a flush the queue
+ * position may be off a packet boundary, so once per lap one packet
+ * straddles the end of the buffer. Only that packet is copied.
+ *
+ * The producer and consumer sides may run in different contexts (i.e.
+ * DMA interrupt and USB interrupt) without locking. Only one transfer per
+ * pipe is in flight at a time, so use the largest transfer the controller
+ * supports for full bus throughput.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_STREAM_H_
+#define CUSB_STREAM_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Pipe direction, from the host's point of view.
+ */
+enum cusb_stream_dir
+{
+    CUSB_STREAM_IN,     /**< Device to host. Application produces. */
+    CUSB_STREAM_OUT     /**< Host to device. Application consumes. */
+};
+
+/**
+ * @brief One contiguous segment of the circular buffer. Mirrors
+ * POSIX struct iovec.
+ */
+struct cusb_stream_iov
+{
+    /// @brief Start of segment.
+    uint8_t *base;
+
+    /// @brief Number of bytes in segment. 0 if unused.
+    size_t len;
+};
+
+/**
+ * @brief Pipe statistics. Counters wrap around.
+ */
+struct cusb_stream_stats
+{
+    /// @brief Bytes moved over the bus.
+    uint32_t bytes;
+
+    /// @brief Completed transfers, including zero length packets.
+    uint32_t transfers;
+
+    /// @brief IN only. Number of commits that overran the buffer.
+    uint32_t overflow_events;
+
+    /// @brief IN only. Bytes of unsent data lost to overruns.
+    uint32_t overflow_bytes;
+
+    /// @brief OUT only. Number of times reception was throttled
+    /// because less than one packet of space was free.
+    uint32_t throttled;
+};
+
+/**
+ * @brief Bulk streaming pipe. Only modify through API.
+ */
+struct cusb_stream
+{
+    /// @private Circular buffer.
+    uint8_t *buf;
+
+    /// @private Size of @ref buf minus 1. Size is a power of 2.
+    uint32_t mask;
+
+    /// @private Bulk endpoint max packet size.
+    uint16_t packet_size;
+
+    /// @private Pipe direction.
+    uint8_t dir;
+
+    /// @private Free-running count of bytes written into the buffer.
+    /// Only written by the producer.
+    volatile uint32_t head;
+
+    /// @private Free-running count of bytes handed to the consumer
+    /// side but not yet released. Only written by the consumer.
+    volatile uint32_t queued;
+
+    /// @private Free-running count of bytes released back to the
+    /// producer. Only written by the consumer.
+    volatile uint32_t tail;
+
+    /// @private Minimum pending bytes before an IN transfer is started.
+    uint32_t watermark;
+
+    /// @private Length of the transfer in flight.
+    uint32_t inflight;
+
+    /// @private Value of @ref head when the last flush was requested.
+    volatile uint32_t flush_to;
+
+    /// @private Incremented by the producer to request a flush.
+    volatile uint8_t flush_req;
+
+    /// @private Last flush request handled by the consumer.
+    uint8_t flush_ack;
+
+    /// @private A transfer is in flight.
+    volatile bool busy;
+
+    /// @private Host transfer has not been ended by a short packet yet.
+    bool open;
+
+    /// @private Zero length packet must end a flush.
+    bool zlp_pending;
+
+    /// @private OUT pipe is currently throttled.
+    bool throttling;
+
+    /// @private IN only. Contiguous copy of a packet straddling the end
+    /// of the buffer.
+    uint8_t straddle[CUSB_CFG_BULK_SIZE_MAX];
+
+#if (CUSB_CFG_STATS)
+    /// @private Statistics.
+    struct cusb_stream_stats stats;
+#endif
+};
+
+/*------------------------------------------------------------*/
+/*------------------- STREAM MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief Stream pipe constructor. Watermark defaults to one packet.
+ *
+ * @param me Pipe to construct.
+ * @param dir Pipe direction.
+ * @param buf Circular buffer. Owned by the application, which writes
+ * (IN) or reads (OUT) it directly.
+ * @param size Size of @p buf. Must be a power of 2 and a multiple of
+ * @p packet_size.
+ * @param packet_size Bulk endpoint max packet size. Must be a power of 2.
+ */
+extern void cusb_stream_ctor(struct cusb_stream *me,
+                             enum cusb_stream_dir dir,
+                             uint8_t *buf,
+                             size_t size,
+                             uint16_t packet_size);
+/**@}*/
+
+/**
+ * @name Application Interface
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor() as an IN pipe.
+ * @brief Describes the free space the producer may write into, starting
+ * at the write position. Returns total number of free bytes.
+ *
+ * @param me Pipe.
+ * @param iov Filled with up to two free segments. Second segment is the
+ * part that wrapped around to the start of the buffer.
+ */
+extern size_t cusb_stream_write_space(const struct cusb_stream *me, struct cusb_stream_iov iov[2]);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor() as an IN pipe.
+ * @brief Commits @p len bytes written at the write position. A circular
+ * DMA keeps writing whether or not there is space. If it overran unsent
+ * data, the overrun is recorded in the statistics and the oldest unsent
+ * data is dropped so the host resumes at the newest valid data.
+ *
+ * @param me Pipe.
+ * @param len Number of bytes written. At most the buffer size.
+ */
+extern void cusb_stream_write_commit(struct cusb_stream *me, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor() as an OUT pipe.
+ * @brief Describes received data the consumer may read in place.
+ * Returns total number of bytes available.
+ *
+ * @param me Pipe.
+ * @param iov Filled with up to two data segments.
+ */
+extern size_t cusb_stream_read_data(const struct cusb_stream *me, struct cusb_stream_iov iov[2]);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor() as an OUT pipe.
+ * @brief Releases @p len bytes of data returned by @ref cusb_stream_read_data()
+ * back to the pipe.
+ *
+ * @param me Pipe.
+ * @param len Number of bytes consumed.
+ */
+extern void cusb_stream_read_release(struct cusb_stream *me, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor() as an IN pipe.
+ * @brief Sets the number of pending bytes needed before a transfer is
+ * started. Higher watermarks give fewer, larger transfers at the cost of
+ * latency. Pair with a periodic @ref cusb_stream_flush() to bound latency.
+ *
+ * @param me Pipe.
+ * @param watermark Number of bytes. Must be at least one packet and at
+ * most the buffer size.
+ */
+extern void cusb_stream_set_watermark(struct cusb_stream *me, size_t watermark);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor() as an IN pipe.
+ * @brief Sends all pending data regardless of the watermark. The host
+ * sees the end of a transfer once it is out.
+ *
+ * @param me Pipe.
+ */
+extern void cusb_stream_flush(struct cusb_stream *me);
+
+#if (CUSB_CFG_STATS)
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor().
+ * @brief Returns the pipe statistics. Only exists when
+ * @ref CUSB_CFG_STATS is 1.
+ *
+ * @param me Pipe.
+ */
+extern const struct cusb_stream_stats *cusb_stream_get_stats(const struct cusb_stream *me);
+#endif
+/**@}*/
+
+/**
+ * @name Transport
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor() as an IN pipe.
+ * @brief Starts the next IN transfer. Returns true if something must be
+ * sent, in which case @p iov describes the data in place and @p len holds
+ * its total length (0 for a zero length packet). Returns false if nothing
+ * is ready or a transfer is already in flight. Call
+ * @ref cusb_stream_in_complete() once the transfer is done.
+ *
+ * @param me Pipe.
+ * @param iov Filled with the segment to send. The second segment is
+ * always empty.
+ * @param max Largest transfer the controller can do. Must be a non-zero
+ * multiple of the packet size.
+ * @param len Total number of bytes to send.
+ */
+extern bool cusb_stream_in_acquire(struct cusb_stream *me, struct cusb_stream_iov iov[2],
+                                   size_t max, size_t *len);
+
+/**
+ * @pre Transfer started with @ref cusb_stream_in_acquire().
+ * @brief Releases the space of the completed IN transfer.
+ *
+ * @param me Pipe.
+ */
+extern void cusb_stream_in_complete(struct cusb_stream *me);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor() as an OUT pipe.
+ * @brief Arms the next OUT transfer. Returns true if at least one packet
+ * of space is free, in which case @p iov describes the space to receive
+ * into and @p len its total length, a multiple of the packet size. Returns
+ * false if the pipe must be throttled (NAKed) or a transfer is already in
+ * flight. Call @ref cusb_stream_out_complete() once the transfer is done.
+ *
+ * @param me Pipe.
+ * @param iov Filled with up to two segments to receive into back to back.
+ * @param max Largest transfer the controller can do. Must be a non-zero
+ * multiple of the packet size.
+ * @param len Total number of bytes that may be received.
+ */
+extern bool cusb_stream_out_acquire(struct cusb_stream *me, struct cusb_stream_iov iov[2],
+                                    size_t max, size_t *len);
+
+/**
+ * @pre Transfer started with @ref cusb_stream_out_acquire().
+ * @brief Commits @p len received bytes.
+ *
+ * @param me Pipe.
+ * @param len Number of bytes actually received. A short packet ends
+ * the transfer early.
+ */
+extern void cusb_stream_out_complete(struct cusb_stream *me, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_stream_ctor().
+ * @brief Drops all buffered data and any transfer in flight. Statistics
+ * are kept. Call on bus reset or when the endpoint is reconfigured.
+ *
+ * @param me Pipe.
+ */
+extern void cusb_stream_reset(struct cusb_stream *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_STREAM_H_ */
@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Trace points. Modules report notable events through
+ * @ref CUSB_TRACE(), which compiles to nothing unless
+ * @ref CUSB_CFG_TRACE is 1.
+ * @details With tracing enabled the application defines
+ * @ref cusb_trace() and decides where events go. It is called from
+ * whatever context the module runs in, interrupts included, so it must
+ * not block. @ref cusb/rtt.h provides one that writes into a ring a
+ * debugger drains, see @ref CUSB_CFG_TRACE_RTT.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_TRACE_H_
+#define CUSB_TRACE_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Events
+ * Upper byte is the module, lower byte the event.
+ */
+/**@{*/
+#define CUSB_TRACE_SCSI_COMMAND             (0x0101U)   /**< arg: operation code. */
+#define CUSB_TRACE_SCSI_CHECK_CONDITION     (0x0102U)   /**< arg: key << 16 | ASC << 8 | ASCQ. */
+#define CUSB_TRACE_BOT_PHASE_ERROR          (0x0201U)   /**< arg: CBW tag. */
+#define CUSB_TRACE_UAS_TASK_SET_FULL        (0x0301U)   /**< arg: IU tag. */
+#define CUSB_TRACE_MTP_OPERATION            (0x0401U)   /**< arg: operation code. */
+#define CUSB_TRACE_USBTMC_MESSAGE           (0x0501U)   /**< arg: MsgID. */
+#define CUSB_TRACE_STREAM_OVERFLOW          (0x0601U)   /**< arg: bytes lost. */
+#define CUSB_TRACE_STREAM_THROTTLED         (0x0602U)   /**< arg: free bytes. */
+#define CUSB_TRACE_MIDI_OVERFLOW            (0x0701U)   /**< arg: bytes dropped. */
+#define CUSB_TRACE_RNDIS_MESSAGE            (0x0801U)   /**< arg: message type. */
+#define CUSB_TRACE_RNDIS_BAD_PACKET         (0x0802U)   /**< arg: offset in the transfer. */
+#define CUSB_TRACE_ASRC_UNDERRUN            (0x0901U)   /**< arg: frames in the FIFO. */
+#define CUSB_TRACE_ASRC_OVERFLOW            (0x0902U)   /**< arg: frames dropped. */
+/**@}*/
+
+/**
+ * @brief Reports @p event with argument @p arg. Arguments are not
+ * evaluated when tracing is disabled, so they must not have side
+ * effects.
+ */
+#if (CUSB_CFG_TRACE)
+#define CUSB_TRACE(event, arg)              cusb_trace((uint16_t)(event), (uint32_t)(arg))
+#else
+#define CUSB_TRACE(event, arg)              ((void)0)
+#endif
+
+/*------------------------------------------------------------*/
+/*------------------------ TRACE HOOK ------------------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if (CUSB_CFG_TRACE)
+/**
+ * @brief Defined by the application when @ref CUSB_CFG_TRACE is 1.
+ * Receives every trace point. Must not block.
+ *
+ * @param event One of the events above.
+ * @param arg Event specific argument.
+ */
+extern void cusb_trace(uint16_t event, uint32_t arg);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_TRACE_H_ */
@@ -0,0 +1,233 @@
+/**
+ * @file
+ * @brief USB Attached SCSI (UAS) transport.
+ * @details Uses four bulk pipes: Command (OUT), Status (IN), Data-In and
+ * Data-Out. Up to one command per @ref cusb_scsi_task slot is outstanding
+ * at once, each identified by the host's tag. Commands are started as
+ * soon as they arrive, so the backend can work on several of them while
+ * the data of another is on the bus, and they may complete in any order.
+ *
+ * Like the other classes it is transport agnostic. The endpoint glue
+ * passes Command and Data-Out packets to @ref cusb_uas_command_out() and
+ * @ref cusb_uas_data_out(), and asks @ref cusb_uas_status_in() and
+ * @ref cusb_uas_data_in() for what to send next. The notify callback
+ * passed to the constructor fires when a backend completion made
+ * something new ready, so idle IN endpoints can be re-armed.
+ *
+ * This implements the high-speed (USB 2.0) protocol: the device
+ * announces each data phase with a READ READY or WRITE READY IU and
+ * then moves that command's whole data phase before the next one starts.
+ * SuperSpeed bulk streams are not supported.
+ *
+ * Each logical unit has its own backend. Commands to different LUNs run
+ * side by side, and a LUN never gets the last free slot another LUN
+ * needs: with N LUNs, one LUN occupies at most (slots - N + 1) slots, so
+ * a slow SD card cannot lock internal flash out with TASK SET FULL.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_UAS_H_
+#define CUSB_UAS_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* SCSI target. */
+#include "cusb/scsi.h"
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Largest IU sent on the Status pipe. Sense IU with fixed
+ * format sense data.
+ */
+#define CUSB_UAS_STATUS_IU_MAX              (16U + CUSB_SCSI_SENSE_SIZE)
+
+/**
+ * @brief Number of status IUs that do not belong to a task slot
+ * (task management responses, TASK SET FULL) that can be queued.
+ * Set with @ref CUSB_CFG_UAS_PENDING_MAX.
+ */
+#define CUSB_UAS_PENDING_MAX                (CUSB_CFG_UAS_PENDING_MAX)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief UAS function. Only modify through API.
+ */
+struct cusb_uas
+{
+    /// @private Logical units. Element i is LUN i.
+    struct cusb_scsi *luns;
+
+    /// @private Number of elements in @ref luns.
+    uint8_t nluns;
+
+    /// @private Command slots. Queue depth is the number of slots.
+    struct cusb_scsi_task *tasks;
+
+    /// @private Number of elements in @ref tasks.
+    uint8_t ntasks;
+
+    /// @private Round-robin position for the Status pipe.
+    uint8_t cursor;
+
+    /// @private Bulk endpoint max packet size.
+    uint16_t packet_size;
+
+    /// @private Task whose data phase owns the Data-In pipe. NULL if none.
+    struct cusb_scsi_task *data_in_owner;
+
+    /// @private Task whose data phase owns the Data-Out pipe. NULL if none.
+    struct cusb_scsi_task *data_out_owner;
+
+    /// @private Status IUs not tied to a task slot.
+    struct
+    {
+        uint16_t tag;
+        uint8_t iu;
+        uint8_t code;
+    } pending[CUSB_UAS_PENDING_MAX];
+
+    /// @private Number of entries in @ref pending.
+    uint8_t npending;
+
+    /// @private Called when something new is ready to send.
+    void (*notify)(void *ctx);
+
+    /// @private Passed to @ref notify.
+    void *ctx;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------- UAS MEMBER FUNCTIONS -----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief UAS constructor.
+ *
+ * @param me UAS function to construct.
+ * @param luns Logical units. Must remain valid for the lifetime of @p me.
+ * @param nluns Number of elements in @p luns. At most @ref CUSB_SCSI_LUN_MAX.
+ * @param tasks Command slots. Their number is the queue depth.
+ * @param ntasks Number of elements in @p tasks. At least @p nluns, at most 255.
+ * @param buffers @p ntasks task buffers of @p buffer_size bytes each, back to back.
+ * @param buffer_size Size of one task buffer. Must be a multiple of the
+ * block size and at least @ref CUSB_SCSI_TASK_BUFFER_MIN.
+ * @param packet_size Bulk endpoint max packet size.
+ * @param notify Called from the backend's completion context when
+ * something new is ready to send. Optional, can be NULL.
+ * @param ctx Passed to @p notify.
+ */
+extern void cusb_uas_ctor(struct cusb_uas *me,
+                          struct cusb_scsi *luns,
+                          size_t nluns,
+                          struct cusb_scsi_task *tasks,
+                          size_t ntasks,
+                          uint8_t *buffers,
+                          size_t buffer_size,
+                          uint16_t packet_size,
+                          void (*notify)(void *ctx),
+                          void *ctx);
+/**@}*/
+
+/**
+ * @name Transport
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_uas_ctor().
+ * @brief Processes one IU received on the Command pipe.
+ *
+ * @param me UAS function.
+ * @param pkt Received IU.
+ * @param len Number of bytes in @p pkt.
+ */
+extern void cusb_uas_command_out(struct cusb_uas *me, const uint8_t *pkt, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_uas_ctor().
+ * @brief Fills the next Status pipe IU. Returns true if something must
+ * be sent, in which case @p len holds its length.
+ *
+ * @param me UAS function.
+ * @param buf IU buffer of at least @ref CUSB_UAS_STATUS_IU_MAX bytes.
+ * @param size Size of @p buf.
+ * @param len Number of bytes written to @p buf.
+ */
+extern bool cusb_uas_status_in(struct cusb_uas *me, uint8_t *buf, size_t size, size_t *len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_uas_ctor().
+ * @brief Fills the next Data-In chunk. Returns true if something must be
+ * sent, in which case @p len holds the number of bytes written to @p buf
+ * (0 for a zero length packet).
+ *
+ * @param me UAS function.
+ * @param buf Transfer buffer.
+ * @param size Size of @p buf. Must be a non-zero multiple of the packet size.
+ * @param len Number of bytes written to @p buf.
+ */
+extern bool cusb_uas_data_in(struct cusb_uas *me, uint8_t *buf, size_t size, size_t *len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_uas_ctor().
+ * @brief Returns the number of bytes the Data-Out pipe can take right now.
+ * The glue only arms the endpoint while this is non-zero.
+ *
+ * @param me UAS function.
+ */
+extern size_t cusb_uas_data_out_space(const struct cusb_uas *me);
+
+/**
+ * @pre @ref cusb_uas_data_out_space() returned at least @p len.
+ * @brief Processes data received on the Data-Out pipe. A packet shorter
+ * than the max packet size ends the data phase, failing the command if
+ * it expected more.
+ *
+ * @param me UAS function.
+ * @param pkt Received data.
+ * @param len Number of bytes in @p pkt.
+ */
+extern void cusb_uas_data_out(struct cusb_uas *me, const uint8_t *pkt, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_uas_ctor().
+ * @brief Aborts every command. Call on bus reset and set interface.
+ *
+ * @param me UAS function.
+ */
+extern void cusb_uas_reset(struct cusb_uas *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_UAS_H_ */
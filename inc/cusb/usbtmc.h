@@ -0,0 +1,248 @@
+/**
+ * @file
+ * @brief USB Test and Measurement Class (USBTMC) with the USB488
+ * subclass extensions.
+ * @details Handles Bulk-OUT and Bulk-IN message framing, bTag tracking,
+ * TermChar handling and the abort/clear control requests. Like the other
+ * classes it is transport agnostic. The application's endpoint glue passes
+ * received Bulk-OUT packets to @ref cusb_usbtmc_bulk_out(), asks
+ * @ref cusb_usbtmc_bulk_in() for the next Bulk-IN transfer chunk and
+ * forwards class-specific control requests to @ref cusb_usbtmc_control().
+ *
+ * Responses are never buffered by the class. The application announces a
+ * response of a given length with @ref cusb_usbtmc_respond() and the class
+ * pulls it through @ref cusb_usbtmc_api.read directly into the transfer
+ * buffer as the host asks for it. A multi-megabyte waveform therefore goes
+ * out in as few max-size Bulk-IN transfers as the host allows, with one
+ * header per transfer and no intermediate copy.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_USBTMC_H_
+#define CUSB_USBTMC_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Configuration. */
+#include "cusb/config.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Size of Bulk-OUT and Bulk-IN message headers in bytes.
+ */
+#define CUSB_USBTMC_HEADER_SIZE             (12U)
+
+/**
+ * @brief Size of the buffer @ref cusb_usbtmc_control() needs for
+ * its response. Largest response is GET_CAPABILITIES.
+ */
+#define CUSB_USBTMC_CONTROL_RESPONSE_MAX    (24U)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Application callbacks. @ref read and @ref receive are
+ * mandatory. Every other callback is optional and leaving it NULL
+ * removes the matching capability from GET_CAPABILITIES.
+ */
+struct cusb_usbtmc_api
+{
+    /// @brief Delivers device-dependent message bytes from a DEV_DEP_MSG_OUT
+    /// transfer directly out of the received packet. Called once per packet.
+    /// @p eom is true on the last chunk of a transfer that ends the message.
+    void (*receive)(void *ctx, const uint8_t *data, size_t len, bool eom);
+
+    /// @brief Copies up to @p len bytes of the current response starting at
+    /// @p offset into the transfer buffer @p buf. Returns number of bytes
+    /// copied. Returning less than requested ends the response early.
+    size_t (*read)(void *ctx, uint32_t offset, uint8_t *buf, size_t len);
+
+    /// @brief Host cleared or aborted. Discard any partially received
+    /// message and any pending response.
+    void (*clear)(void *ctx);
+
+    /// @brief INDICATOR_PULSE request. Blink an LED.
+    void (*indicator_pulse)(void *ctx);
+
+    /// @brief USB488 TRIGGER message.
+    void (*trigger)(void *ctx);
+
+    /// @brief USB488 READ_STATUS_BYTE request. Return the IEEE 488.2 status byte.
+    uint8_t (*status_byte)(void *ctx);
+
+    /// @brief USB488 REN_CONTROL, GO_TO_LOCAL and LOCAL_LOCKOUT requests.
+    /// @p request is the bRequest value, @p value is wValue.
+    void (*remote_local)(void *ctx, uint8_t request, uint16_t value);
+};
+
+/**
+ * @brief USBTMC function. Only modify through API.
+ */
+struct cusb_usbtmc
+{
+    /// @private Application callbacks.
+    const struct cusb_usbtmc_api *api;
+
+    /// @private Passed to every callback.
+    void *ctx;
+
+    /// @private Bulk endpoint max packet size.
+    uint16_t packet_size;
+
+    /// @private Bulk-OUT transfer currently being received.
+    struct
+    {
+        uint32_t remaining;     /**< Message bytes left in transfer. */
+        uint32_t padding;       /**< Alignment bytes left in transfer. */
+        uint32_t nbytes_rxd;    /**< Message bytes received so far. */
+        uint8_t btag;           /**< bTag of transfer. 0 if none received yet. */
+        uint8_t msg_id;         /**< MsgID of transfer. */
+        bool active;            /**< Transfer in progress. */
+        bool eom;               /**< Transfer ends the message. */
+    } out;
+
+    /// @private Last REQUEST_DEV_DEP_MSG_IN and the Bulk-IN transfer answering it.
+    struct
+    {
+        uint32_t max;           /**< TransferSize host asked for. */
+        uint32_t remaining;     /**< Message bytes left in transfer. */
+        uint32_t padding;       /**< Alignment bytes left in transfer. */
+        uint32_t nbytes_txd;    /**< Message bytes sent in transfer. */
+        uint8_t btag;           /**< bTag of request. */
+        uint8_t termchar;       /**< TermChar of request. */
+        bool requested;         /**< Request waiting to be answered. */
+        bool termchar_enabled;  /**< Request has TermChar enabled. */
+        bool active;            /**< Transfer in progress. */
+        bool zlp_pending;       /**< ZLP must end the transfer. */
+        bool aborted;           /**< Host aborted transfer. */
+    } in;
+
+    /// @private Response being returned to the host.
+    struct
+    {
+        uint32_t total;         /**< Response length. */
+        uint32_t offset;        /**< Bytes already sent. */
+        bool available;         /**< Response announced by application. */
+    } resp;
+};
+
+/*------------------------------------------------------------*/
+/*------------------- USBTMC MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name Constructors
+ */
+/**@{*/
+/**
+ * @pre Memory already allocated for @p me.
+ * @brief USBTMC constructor.
+ *
+ * @param me USBTMC function to construct.
+ * @param api Application callbacks. Must remain valid for the lifetime of @p me.
+ * @param ctx Passed to every callback. Optional, can be NULL.
+ * @param packet_size Bulk endpoint max packet size. Must be a multiple of 4
+ * and at least 16.
+ */
+extern void cusb_usbtmc_ctor(struct cusb_usbtmc *me,
+                             const struct cusb_usbtmc_api *api,
+                             void *ctx,
+                             uint16_t packet_size);
+/**@}*/
+
+/**
+ * @name Application Interface
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_usbtmc_ctor().
+ * @brief Makes a response of @p len bytes available. It is pulled through
+ * @ref cusb_usbtmc_api.read as the host issues REQUEST_DEV_DEP_MSG_IN.
+ * Returns false if the previous response has not been fully sent yet.
+ *
+ * @param me USBTMC function.
+ * @param len Response length in bytes.
+ */
+extern bool cusb_usbtmc_respond(struct cusb_usbtmc *me, uint32_t len);
+/**@}*/
+
+/**
+ * @name Transport
+ */
+/**@{*/
+/**
+ * @pre @p me previously constructed via @ref cusb_usbtmc_ctor().
+ * @brief Processes one packet received on the Bulk-OUT endpoint. Returns
+ * false on a protocol error (i.e. bTag does not match bTagInverse), in
+ * which case the Bulk-OUT endpoint must be halted as the spec requires.
+ *
+ * @param me USBTMC function.
+ * @param pkt Received packet.
+ * @param len Number of bytes in @p pkt.
+ */
+extern bool cusb_usbtmc_bulk_out(struct cusb_usbtmc *me, const uint8_t *pkt, size_t len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_usbtmc_ctor().
+ * @brief Fills the next Bulk-IN transfer chunk. Returns true if something
+ * must be sent, in which case @p len holds the number of bytes written to
+ * @p buf (0 for a zero length packet). Returns false if there is nothing
+ * to send.
+ *
+ * @param me USBTMC function.
+ * @param buf Transfer buffer.
+ * @param size Size of @p buf. Must be a non-zero multiple of the packet size.
+ * Use the largest buffer the controller can send in one go for best throughput.
+ * @param len Number of bytes written to @p buf.
+ */
+extern bool cusb_usbtmc_bulk_in(struct cusb_usbtmc *me, uint8_t *buf, size_t size, size_t *len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_usbtmc_ctor().
+ * @brief Handles a USBTMC or USB488 class-specific control request.
+ * Returns false if the request is not supported, in which case EP0 must
+ * be stalled. Otherwise @p resp holds @p resp_len bytes for the data stage.
+ *
+ * @param me USBTMC function.
+ * @param setup The 8 byte SETUP packet.
+ * @param resp Response buffer of at least @ref CUSB_USBTMC_CONTROL_RESPONSE_MAX bytes.
+ * @param resp_len Number of response bytes written to @p resp.
+ */
+extern bool cusb_usbtmc_control(struct cusb_usbtmc *me, const uint8_t *setup,
+                                uint8_t *resp, size_t *resp_len);
+
+/**
+ * @pre @p me previously constructed via @ref cusb_usbtmc_ctor().
+ * @brief Drops all transfer state. Call on bus reset and when the
+ * host clears a halted bulk endpoint.
+ *
+ * @param me USBTMC function.
+ */
+extern void cusb_usbtmc_reset(struct cusb_usbtmc *me);
+/**@}*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CUSB_USBTMC_H_ */
@@ -0,0 +1,40 @@
+/**
+ * @file
+ * @brief Application configuration of the CUSB library. This default
+ * copy is empty so every option takes the value listed in
+ * @ref cusb/config.h, which enables everything.
+ * @details To configure the library, copy this file into a directory of
+ * the application, define only the options that differ from the defaults
+ * and point the build at it:
+ *
+ * @code
+ * cmake -DCUSB_CONFIG_DIR=path/to/dir ...
+ * @endcode
+ *
+ * The directory is put in front of the library's public include path, so
+ * the library, the application and the tests all see the same copy. The
+ * options size structs that are shared with the application, so compiling
+ * the two against different copies breaks the ABI.
+ *
+ * Example for a full-speed device with one serial-like vendor pipe:
+ *
+ * @code
+ * #define CUSB_CFG_SPEED           CUSB_SPEED_FULL
+ * #define CUSB_CFG_ENDPOINTS       (2U)
+ * #define CUSB_CFG_MSC             0
+ * #define CUSB_CFG_MTP             0
+ * #define CUSB_CFG_USBTMC          0
+ * #define CUSB_CFG_CRC32           0
+ * #define CUSB_CFG_STATS           0
+ * @endcode
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_APP_CONFIG_H_
+#define CUSB_APP_CONFIG_H_
+
+#endif /* CUSB_APP_CONFIG_H_ */
@@ -0,0 +1,437 @@
+/**
+ * @file
+ * @brief See @ref asrc.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/asrc.h"
+
+/* Endian accessors. */
+#include "cusb/endian.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_ASRC_HAS_SSE2)
+/* SSE2 intrinsics. */
+#include <emmintrin.h>
+#endif
+
+#if (CUSB_CFG_ASRC)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/asrc.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/* Correction limit in Q0.32. */
+#define STEP_MAX        ((int32_t)((4294967296ULL * CUSB_ASRC_PPM_MAX) / 1000000ULL))
+
+/* Fill level filter time constant, 2^FILTER_SHIFT output frames. About
+0.5 Hz at 48 kHz, above the loop bandwidth and far below the packet and
+block rates whose sawtooth it removes. */
+#define FILTER_SHIFT    (14U)
+
+/* Proportional gain 2^-15 and integral gain 2^-33 per output frame, so
+about 0.1 Hz at 48 kHz and overdamped. The sawtooth of packets and blocks
+aliases into the filtered level as their phases slide past each other,
+which a lower proportional gain turns into less pitch wobble. Shifts of
+the Q16.16 error into the Q0.32 step. */
+#define KP_SHIFT        (1U)
+#define KI_SHIFT        (17U)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Blends the two phase sums and scales back to a saturated
+ * sample.
+ */
+static inline int16_t blend(int32_t a, int32_t b, uint32_t weight);
+
+/**
+ * @brief One output sample through the backend built for the target.
+ */
+static inline int16_t fir(const int16_t *x, const int16_t *coef, uint32_t weight);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+/* Kaiser (beta 7) windowed sinc, cutoff 0.45 of the sample rate. Row p
+is the filter for a position p / 64 of the way from frame 7 to frame 8
+of the window, and row 64 the same as row 0 one frame later so every
+phase has a next one to blend with. Each row sums to exactly 32768 for
+unity gain. The absolute sum of every row is below 1.77 * 32768, so a
+sum of 16 products of 16-bit samples cannot overflow 32 bits. */
+static const int16_t TABLE[CUSB_ASRC_PHASES + 1U][CUSB_ASRC_TAPS] =
+{
+    {    48,   -192,    511,  -1047,   1755,  -2496,   3063,  29489,   3063,  -2496,   1755,  -1047,    511,   -192,     48,     -5},
+    {    48,   -192,    504,  -1019,   1680,  -2316,   2599,  29474,   3537,  -2674,   1829,  -1072,    518,   -192,     48,     -4},
+    {    49,   -191,    496,   -990,   1603,  -2135,   2145,  29445,   4021,  -2852,   1900,  -1097,    523,   -192,     47,     -4},
+    {    49,   -189,    487,   -960,   1524,  -1954,   1702,  29396,   4513,  -3027,   1968,  -1119,    527,   -191,     46,     -4},
+    {    49,   -187,    478,   -928,   1443,  -1773,   1270,  29325,   5015,  -3200,   2034,  -1139,    530,   -190,     45,     -4},
+    {    49,   -185,    467,   -895,   1361,  -1592,    849,  29238,   5524,  -3371,   2097,  -1158,    532,   -188,     44,     -4},
+    {    48,   -183,    456,   -861,   1278,  -1412,    440,  29129,   6042,  -3538,   2157,  -1174,    533,   -186,     43,     -4},
+    {    48,   -180,    444,   -826,   1195,  -1234,     43,  29002,   6566,  -3702,   2214,  -1189,    533,   -184,     41,     -3},
+    {    47,   -177,    432,   -790,   1110,  -1056,   -341,  28853,   7097,  -3862,   2268,  -1201,    532,   -180,     39,     -3},
+    {    47,   -173,    419,   -753,   1025,   -880,   -713,  28686,   7635,  -4018,   2317,  -1211,    529,   -177,     38,     -3},
+    {    46,   -170,    405,   -716,    940,   -706,  -1073,  28502,   8178,  -4169,   2363,  -1219,    526,   -173,     36,     -2},
+    {    45,   -166,    391,   -677,    854,   -534,  -1419,  28298,   8726,  -4315,   2405,  -1224,    521,   -168,     33,     -2},
+    {    44,   -162,    376,   -639,    768,   -365,  -1752,  28077,   9278,  -4455,   2443,  -1226,    514,   -163,     31,     -1},
+    {    43,   -157,    361,   -599,    683,   -199,  -2071,  27835,   9835,  -4590,   2477,  -1227,    507,   -157,     28,     -1},
+    {    42,   -152,    346,   -560,    598,    -36,  -2378,  27575,  10395,  -4718,   2506,  -1224,    498,   -150,     26,      0},
+    {    41,   -148,    330,   -520,    513,    124,  -2670,  27300,  10958,  -4840,   2530,  -1219,    488,   -143,     23,      1},
+    {    40,   -143,    314,   -480,    429,    280,  -2949,  27007,  11523,  -4954,   2550,  -1211,    477,   -136,     20,      1},
+    {    39,   -137,    298,   -440,    346,    432,  -3213,  26697,  12089,  -5061,   2565,  -1201,    464,   -128,     16,      2},
+    {    38,   -132,    281,   -400,    264,    581,  -3464,  26369,  12657,  -5160,   2575,  -1188,    450,   -119,     13,      3},
+    {    36,   -127,    265,   -360,    183,    725,  -3701,  26028,  13224,  -5251,   2580,  -1172,    435,   -110,      9,      4},
+    {    35,   -121,    248,   -320,    104,    864,  -3924,  25671,  13792,  -5333,   2579,  -1153,    418,   -101,      5,      4},
+    {    34,   -115,    231,   -280,     26,    999,  -4133,  25298,  14358,  -5407,   2573,  -1131,    400,    -91,      1,      5},
+    {    32,   -110,    214,   -241,    -51,   1129,  -4328,  24912,  14923,  -5471,   2562,  -1107,    381,    -80,     -3,      6},
+    {    31,   -104,    198,   -202,   -126,   1254,  -4509,  24509,  15486,  -5525,   2545,  -1080,    360,    -69,     -7,      7},
+    {    30,    -98,    181,   -163,   -199,   1374,  -4676,  24092,  16045,  -5569,   2523,  -1049,    338,    -57,    -12,      8},
+    {    28,    -92,    164,   -125,   -270,   1488,  -4829,  23662,  16602,  -5603,   2495,  -1016,    315,    -45,    -16,     10},
+    {    27,    -87,    147,    -88,   -339,   1597,  -4968,  23223,  17154,  -5626,   2461,   -980,    290,    -33,    -21,     11},
+    {    25,    -81,    131,    -52,   -406,   1701,  -5094,  22771,  17701,  -5638,   2421,   -942,    265,    -20,    -26,     12},
+    {    24,    -75,    115,    -16,   -471,   1799,  -5206,  22305,  18243,  -5639,   2375,   -900,    238,     -6,    -31,     13},
+    {    22,    -69,     98,     19,   -534,   1891,  -5305,  21832,  18778,  -5628,   2324,   -856,    210,      8,    -36,     14},
+    {    21,    -64,     83,     54,   -594,   1978,  -5391,  21344,  19307,  -5605,   2266,   -809,    181,     22,    -41,     16},
+    {    20,    -58,     67,     87,   -651,   2059,  -5463,  20847,  19829,  -5570,   2203,   -759,    150,     37,    -47,     17},
+    {    18,    -52,     52,    119,   -706,   2134,  -5523,  20341,  20343,  -5523,   2134,   -706,    119,     52,    -52,     18},
+    {    17,    -47,     37,    150,   -759,   2203,  -5570,  19829,  20847,  -5463,   2059,   -651,     87,     67,    -58,     20},
+    {    16,    -41,     22,    181,   -809,   2266,  -5605,  19307,  21344,  -5391,   1978,   -594,     54,     83,    -64,     21},
+    {    14,    -36,      8,    210,   -856,   2324,  -5628,  18778,  21832,  -5305,   1891,   -534,     19,     98,    -69,     22},
+    {    13,    -31,     -6,    238,   -900,   2375,  -5639,  18243,  22305,  -5206,   1799,   -471,    -16,    115,    -75,     24},
+    {    12,    -26,    -20,    265,   -942,   2421,  -5638,  17701,  22771,  -5094,   1701,   -406,    -52,    131,    -81,     25},
+    {    11,    -21,    -33,    290,   -980,   2461,  -5626,  17154,  23223,  -4968,   1597,   -339,    -88,    147,    -87,     27},
+    {    10,    -16,    -45,    315,  -1016,   2495,  -5603,  16602,  23662,  -4829,   1488,   -270,   -125,    164,    -92,     28},
+    {     8,    -12,    -57,    338,  -1049,   2523,  -5569,  16045,  24092,  -4676,   1374,   -199,   -163,    181,    -98,     30},
+    {     7,     -7,    -69,    360,  -1080,   2545,  -5525,  15486,  24509,  -4509,   1254,   -126,   -202,    198,   -104,     31},
+    {     6,     -3,    -80,    381,  -1107,   2562,  -5471,  14923,  24912,  -4328,   1129,    -51,   -241,    214,   -110,     32},
+    {     5,      1,    -91,    400,  -1131,   2573,  -5407,  14358,  25298,  -4133,    999,     26,   -280,    231,   -115,     34},
+    {     4,      5,   -101,    418,  -1153,   2579,  -5333,  13792,  25671,  -3924,    864,    104,   -320,    248,   -121,     35},
+    {     4,      9,   -110,    435,  -1172,   2580,  -5251,  13224,  26028,  -3701,    725,    183,   -360,    265,   -127,     36},
+    {     3,     13,   -119,    450,  -1188,   2575,  -5160,  12657,  26369,  -3464,    581,    264,   -400,    281,   -132,     38},
+    {     2,     16,   -128,    464,  -1201,   2565,  -5061,  12089,  26697,  -3213,    432,    346,   -440,    298,   -137,     39},
+    {     1,     20,   -136,    477,  -1211,   2550,  -4954,  11523,  27007,  -2949,    280,    429,   -480,    314,   -143,     40},
+    {     1,     23,   -143,    488,  -1219,   2530,  -4840,  10958,  27300,  -2670,    124,    513,   -520,    330,   -148,     41},
+    {     0,     26,   -150,    498,  -1224,   2506,  -4718,  10395,  27575,  -2378,    -36,    598,   -560,    346,   -152,     42},
+    {    -1,     28,   -157,    507,  -1227,   2477,  -4590,   9835,  27835,  -2071,   -199,    683,   -599,    361,   -157,     43},
+    {    -1,     31,   -163,    514,  -1226,   2443,  -4455,   9278,  28077,  -1752,   -365,    768,   -639,    376,   -162,     44},
+    {    -2,     33,   -168,    521,  -1224,   2405,  -4315,   8726,  28298,  -1419,   -534,    854,   -677,    391,   -166,     45},
+    {    -2,     36,   -173,    526,  -1219,   2363,  -4169,   8178,  28502,  -1073,   -706,    940,   -716,    405,   -170,     46},
+    {    -3,     38,   -177,    529,  -1211,   2317,  -4018,   7635,  28686,   -713,   -880,   1025,   -753,    419,   -173,     47},
+    {    -3,     39,   -180,    532,  -1201,   2268,  -3862,   7097,  28853,   -341,  -1056,   1110,   -790,    432,   -177,     47},
+    {    -3,     41,   -184,    533,  -1189,   2214,  -3702,   6566,  29002,     43,  -1234,   1195,   -826,    444,   -180,     48},
+    {    -4,     43,   -186,    533,  -1174,   2157,  -3538,   6042,  29129,    440,  -1412,   1278,   -861,    456,   -183,     48},
+    {    -4,     44,   -188,    532,  -1158,   2097,  -3371,   5524,  29238,    849,  -1592,   1361,   -895,    467,   -185,     49},
+    {    -4,     45,   -190,    530,  -1139,   2034,  -3200,   5015,  29325,   1270,  -1773,   1443,   -928,    478,   -187,     49},
+    {    -4,     46,   -191,    527,  -1119,   1968,  -3027,   4513,  29396,   1702,  -1954,   1524,   -960,    487,   -189,     49},
+    {    -4,     47,   -192,    523,  -1097,   1900,  -2852,   4021,  29445,   2145,  -2135,   1603,   -990,    496,   -191,     49},
+    {    -4,     48,   -192,    518,  -1072,   1829,  -2674,   3537,  29474,   2599,  -2316,   1680,  -1019,    504,   -192,     48},
+    {    -5,     48,   -192,    511,  -1047,   1755,  -2496,   3063,  29489,   3063,  -2496,   1755,  -1047,    511,   -192,     48}
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static inline int16_t blend(int32_t a, int32_t b, uint32_t weight)
+{
+    int64_t y = (int64_t)a + ((((int64_t)b - a) * (int64_t)weight) >> 15);
+    y = (y + 0x4000) >> 15;
+
+    if (y > INT16_MAX)
+    {
+        y = INT16_MAX;
+    }
+    else if (y < INT16_MIN)
+    {
+        y = INT16_MIN;
+    }
+
+    return (int16_t)y;
+}
+
+static inline int16_t fir(const int16_t *x, const int16_t *coef, uint32_t weight)
+{
+#if (CUSB_ASRC_HAS_DSP)
+    return cusb_asrc_fir_dsp(x, coef, weight);
+#elif (CUSB_ASRC_HAS_SSE2)
+    return cusb_asrc_fir_sse2(x, coef, weight);
+#else
+    return cusb_asrc_fir_c(x, coef, weight);
+#endif
+}
+
+/*------------------------------------------------------------*/
+/*--------------------- ASRC MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_asrc_ctor(struct cusb_asrc *me, int16_t *mem, uint16_t size, uint8_t channels)
+{
+    CUSB_ASSERT_API( (me && mem) );
+    CUSB_ASSERT_API( (size >= CUSB_ASRC_SIZE_MIN && size <= CUSB_ASRC_SIZE_MAX) );
+    CUSB_ASSERT_API( (channels != 0) );
+
+    me->mem = mem;
+    me->size = size;
+    me->channels = channels;
+    cusb_asrc_reset(me);
+
+#if (CUSB_CFG_STATS)
+    me->stats.underruns = 0;
+    me->stats.overflows = 0;
+#endif
+}
+
+uint32_t cusb_asrc_write(struct cusb_asrc *me, const uint8_t *data, uint32_t len)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (data || len == 0) );
+    CUSB_ASSERT_PACKET( ((len % (2U * me->channels)) == 0) );
+
+    uint32_t head = me->head;
+    uint32_t space = me->size - (head - me->tail);
+    uint32_t frames = len / (2U * me->channels);
+    uint32_t idx = head % me->size;
+
+    if (frames > space)
+    {
+#if (CUSB_CFG_STATS)
+        me->stats.overflows += frames - space;
+#endif
+        CUSB_TRACE(CUSB_TRACE_ASRC_OVERFLOW, frames - space);
+        frames = space;
+    }
+
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        int16_t *slot = &me->mem[idx];
+
+        for (uint8_t ch = 0; ch < me->channels; ch++)
+        {
+            int16_t sample = (int16_t)cusb_get_le16(data);
+            slot[0] = sample;
+            slot[me->size] = sample;
+            slot += 2U * me->size;
+            data += 2;
+        }
+
+        idx = (idx + 1U == me->size) ? 0 : idx + 1U;
+    }
+
+    me->head = head + frames;
+    return frames;
+}
+
+void cusb_asrc_read(struct cusb_asrc *me, int16_t *out, uint32_t frames)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (out || frames == 0) );
+
+    uint32_t tail = me->tail;
+    uint32_t count = me->head - tail;
+    uint32_t idx = tail % me->size;
+    uint32_t done = 0;
+
+    if (!me->running && count >= me->size / 2U)
+    {
+        me->running = true;
+        me->avg = (int32_t)((count << 16) - (me->frac >> 16));
+    }
+
+    if (me->running)
+    {
+        for (; done < frames; done++)
+        {
+            if (count < CUSB_ASRC_TAPS)
+            {
+                me->running = false;
+#if (CUSB_CFG_STATS)
+                me->stats.underruns++;
+#endif
+                CUSB_TRACE(CUSB_TRACE_ASRC_UNDERRUN, count);
+                break;
+            }
+
+            const int16_t *coef = TABLE[me->frac >> 26];
+            uint32_t weight = (me->frac >> 11) & 0x7FFFU;
+            const int16_t *x = &me->mem[idx];
+
+            for (uint8_t ch = 0; ch < me->channels; ch++)
+            {
+                *out++ = fir(x, coef, weight);
+                x += 2U * me->size;
+            }
+
+            /* Advances 0, 1 or 2 frames, the step being within 1 +- 0.5. */
+            int64_t pos = (int64_t)me->frac + 0x100000000LL + me->step;
+            uint32_t advance = (uint32_t)(pos >> 32);
+            me->frac = (uint32_t)pos;
+            count -= advance;
+            tail += advance;
+            idx += advance;
+            idx = (idx >= me->size) ? idx - me->size : idx;
+        }
+
+        me->tail = tail;
+    }
+
+    if (done != 0)
+    {
+        /* Filtered fill level against half full drives the rate. */
+        uint32_t k = (done < (1UL << FILTER_SHIFT)) ? done : (1UL << FILTER_SHIFT);
+        int32_t fill = (int32_t)((count << 16) - (me->frac >> 16));
+        me->avg += (int32_t)((((int64_t)fill - me->avg) * (int64_t)k) >> FILTER_SHIFT);
+
+        int32_t error = me->avg - (int32_t)((uint32_t)(me->size / 2U) << 16);
+        int64_t limit = (int64_t)STEP_MAX << KI_SHIFT;
+        me->integral += (int64_t)error * (int64_t)done;
+        me->integral = (me->integral > limit) ? limit : ((me->integral < -limit) ? -limit : me->integral);
+
+        int64_t step = ((int64_t)error << KP_SHIFT) + (me->integral >> KI_SHIFT);
+        me->step = (int32_t)((step > STEP_MAX) ? STEP_MAX : ((step < -STEP_MAX) ? -STEP_MAX : step));
+    }
+
+    if (done < frames)
+    {
+        memset(out, 0, sizeof(int16_t) * me->channels * (frames - done));
+    }
+}
+
+void cusb_asrc_reset(struct cusb_asrc *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    me->running = false;
+    me->head = 0;
+    me->tail = 0;
+    me->frac = 0;
+    me->step = 0;
+    me->avg = 0;
+    me->integral = 0;
+}
+
+int32_t cusb_asrc_ppm(const struct cusb_asrc *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return (int32_t)(((int64_t)me->step * 1000000) / 4294967296LL);
+}
+
+uint32_t cusb_asrc_fill(const struct cusb_asrc *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->head - me->tail;
+}
+
+#if (CUSB_CFG_STATS)
+const struct cusb_asrc_stats *cusb_asrc_get_stats(const struct cusb_asrc *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+#endif
+
+/*------------------------------------------------------------*/
+/*------------------------- BACKENDS -------------------------*/
+/*------------------------------------------------------------*/
+
+const int16_t *cusb_asrc_phase(uint32_t phase)
+{
+    CUSB_ASSERT_API( (phase < CUSB_ASRC_PHASES) );
+    return TABLE[phase];
+}
+
+int16_t cusb_asrc_fir_c(const int16_t *x, const int16_t *coef, uint32_t weight)
+{
+    int32_t a = 0;
+    int32_t b = 0;
+
+    for (uint32_t k = 0; k < CUSB_ASRC_TAPS; k++)
+    {
+        a += (int32_t)x[k] * coef[k];
+        b += (int32_t)x[k] * coef[k + CUSB_ASRC_TAPS];
+    }
+
+    return blend(a, b, weight);
+}
+
+#if (CUSB_ASRC_HAS_DSP)
+static inline int32_t smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+    int32_t result;
+    __asm__ ("smlad %0, %1, %2, %3" : "=r" (result) : "r" (x), "r" (y), "r" (acc));
+    return result;
+}
+
+int16_t cusb_asrc_fir_dsp(const int16_t *x, const int16_t *coef, uint32_t weight)
+{
+    /* Two samples per load and two multiply-accumulates per SMLAD, for
+    both phases at once. The window starts at any frame, so samples are
+    loaded unaligned, which the M4 does in a single cycle. */
+    int32_t a = 0;
+    int32_t b = 0;
+    uint32_t xv, ca, cb;
+
+    for (uint32_t k = 0; k < CUSB_ASRC_TAPS; k += 2U)
+    {
+        memcpy(&xv, &x[k], sizeof(xv));
+        memcpy(&ca, &coef[k], sizeof(ca));
+        memcpy(&cb, &coef[k + CUSB_ASRC_TAPS], sizeof(cb));
+        a = smlad(xv, ca, a);
+        b = smlad(xv, cb, b);
+    }
+
+    return blend(a, b, weight);
+}
+#endif /* CUSB_ASRC_HAS_DSP */
+
+#if (CUSB_ASRC_HAS_SSE2)
+/* Unoptimized builds spill every vector register to the stack. This backend only
+exists on x86_64 hosts so the MCU-oriented stack budget does not apply to it. */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wstack-usage="
+int16_t cusb_asrc_fir_sse2(const int16_t *x, const int16_t *coef, uint32_t weight)
+{
+    /* PMADDWD multiplies 8 sample pairs and adds each pair to 32 bits.
+    Both phases are summed side by side and reduced together at the end. */
+    const __m128i *px = (const __m128i *)(const void *)x;
+    const __m128i *pc = (const __m128i *)(const void *)coef;
+    __m128i x0 = _mm_loadu_si128(px);
+    __m128i x1 = _mm_loadu_si128(px + 1);
+    __m128i a = _mm_add_epi32(_mm_madd_epi16(x0, _mm_loadu_si128(pc)),
+                              _mm_madd_epi16(x1, _mm_loadu_si128(pc + 1)));
+    __m128i b = _mm_add_epi32(_mm_madd_epi16(x0, _mm_loadu_si128(pc + 2)),
+                              _mm_madd_epi16(x1, _mm_loadu_si128(pc + 3)));
+    __m128i t = _mm_add_epi32(_mm_unpacklo_epi32(a, b), _mm_unpackhi_epi32(a, b));
+    t = _mm_add_epi32(t, _mm_srli_si128(t, 8));
+
+    return blend(_mm_cvtsi128_si32(t), _mm_cvtsi128_si32(_mm_srli_si128(t, 4)), weight);
+}
+#pragma GCC diagnostic pop
+#endif /* CUSB_ASRC_HAS_SSE2 */
+
+#endif /* CUSB_CFG_ASRC */
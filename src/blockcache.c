@@ -0,0 +1,506 @@
+/**
+ * @file
+ * @brief See @ref blockcache.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/blockcache.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_BLOCKCACHE)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/blockcache.c")
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Block device submit function of the cache.
+ */
+static void on_submit(void *ctx, struct cusb_blockdev_req *req);
+
+/**
+ * @brief Completion of @ref cusb_blockcache.lower_req.
+ */
+static void on_lower(struct cusb_blockdev_req *req, bool ok);
+
+/**
+ * @brief Completion of @ref cusb_blockcache.flush_req.
+ */
+static void on_flushed(struct cusb_blockdev_req *req, bool ok);
+
+static void enqueue(struct cusb_blockcache *me, struct cusb_blockdev_req *req);
+static struct cusb_blockcache_line *find(struct cusb_blockcache *me, uint32_t erase_block);
+static struct cusb_blockcache_line *find_dirty(struct cusb_blockcache *me);
+
+/**
+ * @brief Returns a free line, or the least recently used one.
+ */
+static struct cusb_blockcache_line *victim(struct cusb_blockcache *me);
+
+static void touch(struct cusb_blockcache *me, struct cusb_blockcache_line *line);
+
+/**
+ * @brief Sends @ref cusb_blockcache.lower_req to the flash.
+ */
+static void lower_submit(struct cusb_blockcache *me, struct cusb_blockcache_line *line,
+                         uint8_t op, uint32_t lba, uint32_t count, uint8_t *buf);
+
+static void writeback(struct cusb_blockcache *me, struct cusb_blockcache_line *line);
+
+/**
+ * @brief Completes the current request. A SYNC request also reports and
+ * clears earlier write back failures.
+ */
+static void finish(struct cusb_blockcache *me, bool ok);
+
+/**
+ * @brief Advances the current request by one erase block segment, or
+ * starts the flash request it needs to get there.
+ */
+static void step(struct cusb_blockcache *me);
+
+/**
+ * @brief Runs requests until the queue is empty or the flash is busy.
+ */
+static void process(struct cusb_blockcache *me);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const struct cusb_blockdev_api API = {&on_submit, NULL};
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void on_submit(void *ctx, struct cusb_blockdev_req *req)
+{
+    struct cusb_blockcache *me = (struct cusb_blockcache *)ctx;
+
+    enqueue(me, req);
+    process(me);
+}
+
+static void on_lower(struct cusb_blockdev_req *req, bool ok)
+{
+    struct cusb_blockcache *me = (struct cusb_blockcache *)req->owner;
+    struct cusb_blockcache_line *line = me->lower_line;
+
+    CUSB_ASSERT_PACKET( (me->waiting) );
+    me->waiting = false;
+
+    if (!ok)
+    {
+        if (line && req->op == CUSB_BLOCKDEV_READ)
+        {
+            /* A failed fill leaves the line free. */
+            line->used = false;
+            finish(me, false);
+        }
+        else if (line && me->cur->op != CUSB_BLOCKDEV_SYNC)
+        {
+            /* Failed eviction. The line stays dirty for the next write back and
+             * the next SYNC reports the error. Try to evict another line. */
+            me->write_error = true;
+            me->evict_failures++;
+            touch(me, line);
+
+            if (me->evict_failures >= me->nlines)
+            {
+                finish(me, false);
+            }
+        }
+        else
+        {
+            /* A failed write back during a SYNC stays dirty too. */
+            finish(me, false);
+        }
+    }
+    else if (req->op == CUSB_BLOCKDEV_READ)
+    {
+        if (line)
+        {
+            line->used = true;
+            line->dirty = false;
+        }
+        else
+        {
+            me->done += req->count;
+        }
+    }
+    else if (req->op == CUSB_BLOCKDEV_WRITE)
+    {
+        line->dirty = false;
+    }
+    else
+    {
+        finish(me, true);
+    }
+
+    process(me);
+}
+
+static void on_flushed(struct cusb_blockdev_req *req, bool ok)
+{
+    struct cusb_blockcache *me = (struct cusb_blockcache *)req->owner;
+
+    /* Nobody waits for a background flush. The next SYNC reports its failure. */
+    if (!ok)
+    {
+        me->write_error = true;
+    }
+
+    me->flushing = false;
+}
+
+static void enqueue(struct cusb_blockcache *me, struct cusb_blockdev_req *req)
+{
+    req->next = NULL;
+
+    if (me->head)
+    {
+        me->tail->next = req;
+    }
+    else
+    {
+        me->head = req;
+    }
+
+    me->tail = req;
+}
+
+static struct cusb_blockcache_line *find(struct cusb_blockcache *me, uint32_t erase_block)
+{
+    for (size_t i = 0; i < me->nlines; i++)
+    {
+        if (me->lines[i].used && me->lines[i].erase_block == erase_block)
+        {
+            return &me->lines[i];
+        }
+    }
+
+    return NULL;
+}
+
+static struct cusb_blockcache_line *find_dirty(struct cusb_blockcache *me)
+{
+    for (size_t i = 0; i < me->nlines; i++)
+    {
+        if (me->lines[i].dirty)
+        {
+            return &me->lines[i];
+        }
+    }
+
+    return NULL;
+}
+
+static struct cusb_blockcache_line *victim(struct cusb_blockcache *me)
+{
+    struct cusb_blockcache_line *oldest = &me->lines[0];
+
+    for (size_t i = 0; i < me->nlines; i++)
+    {
+        struct cusb_blockcache_line *line = &me->lines[i];
+
+        if (!line->used)
+        {
+            return line;
+        }
+
+        /* Wrap safe age comparison. */
+        if ((int32_t)(line->stamp - oldest->stamp) < 0)
+        {
+            oldest = line;
+        }
+    }
+
+    return oldest;
+}
+
+static void touch(struct cusb_blockcache *me, struct cusb_blockcache_line *line)
+{
+    me->clock++;
+    line->stamp = me->clock;
+}
+
+static void lower_submit(struct cusb_blockcache *me, struct cusb_blockcache_line *line,
+                         uint8_t op, uint32_t lba, uint32_t count, uint8_t *buf)
+{
+    me->lower_line = line;
+    me->lower_req.op = op;
+    me->lower_req.lba = lba;
+    me->lower_req.count = count;
+    me->lower_req.buf = buf;
+    me->waiting = true;
+    cusb_blockdev_submit(me->lower, &me->lower_req);
+}
+
+static void writeback(struct cusb_blockcache *me, struct cusb_blockcache_line *line)
+{
+#if (CUSB_CFG_STATS)
+    me->stats.writebacks++;
+#endif
+    lower_submit(me, line, CUSB_BLOCKDEV_WRITE, line->erase_block * me->erase_blocks,
+                 me->erase_blocks, line->data);
+}
+
+static void finish(struct cusb_blockcache *me, bool ok)
+{
+    struct cusb_blockdev_req *req = me->cur;
+
+    if (req->op == CUSB_BLOCKDEV_SYNC && req != &me->flush_req)
+    {
+        ok = ok && !me->write_error;
+        me->write_error = false;
+    }
+
+    me->cur = NULL;
+    cusb_blockdev_complete(req, ok);
+}
+
+static void step(struct cusb_blockcache *me)
+{
+    struct cusb_blockdev_req *req = me->cur;
+    uint32_t block_size = me->dev.block_size;
+
+    if (req->op == CUSB_BLOCKDEV_SYNC)
+    {
+        struct cusb_blockcache_line *dirty = find_dirty(me);
+
+        if (dirty)
+        {
+            writeback(me, dirty);
+        }
+        else if (req == &me->flush_req)
+        {
+            finish(me, true);
+        }
+        else
+        {
+            lower_submit(me, NULL, CUSB_BLOCKDEV_SYNC, 0, 0, NULL);
+        }
+        return;
+    }
+
+    if (me->done == req->count)
+    {
+        finish(me, true);
+        return;
+    }
+
+    uint32_t lba = req->lba + me->done;
+    uint32_t erase_block = lba / me->erase_blocks;
+    uint32_t offset = lba % me->erase_blocks;
+    uint32_t n = me->erase_blocks - offset;
+    uint8_t *data = &req->buf[(size_t)me->done * block_size];
+    struct cusb_blockcache_line *line = find(me, erase_block);
+
+    if (n > req->count - me->done)
+    {
+        n = req->count - me->done;
+    }
+
+    if (req->op == CUSB_BLOCKDEV_READ)
+    {
+        if (line)
+        {
+#if (CUSB_CFG_STATS)
+            me->stats.read_hits++;
+#endif
+            memcpy(data, &line->data[(size_t)offset * block_size], (size_t)n * block_size);
+            touch(me, line);
+            me->done += n;
+        }
+        else
+        {
+            lower_submit(me, NULL, CUSB_BLOCKDEV_READ, lba, n, data);
+        }
+        return;
+    }
+
+    if (line)
+    {
+#if (CUSB_CFG_STATS)
+        me->stats.write_hits++;
+#endif
+    }
+    else
+    {
+        line = victim(me);
+
+        if (line->dirty)
+        {
+            writeback(me, line);
+            return;
+        }
+
+        line->erase_block = erase_block;
+
+        if (n != me->erase_blocks)
+        {
+            /* Partial write. Read the rest of the erase block first. */
+#if (CUSB_CFG_STATS)
+            me->stats.fills++;
+#endif
+            line->used = false;
+            lower_submit(me, line, CUSB_BLOCKDEV_READ, erase_block * me->erase_blocks,
+                         me->erase_blocks, line->data);
+            return;
+        }
+
+        line->used = true;
+    }
+
+    memcpy(&line->data[(size_t)offset * block_size], data, (size_t)n * block_size);
+    line->dirty = true;
+    touch(me, line);
+    me->done += n;
+}
+
+static void process(struct cusb_blockcache *me)
+{
+    if (me->running)
+    {
+        return;
+    }
+
+    me->running = true;
+
+    while (!me->waiting)
+    {
+        if (!me->cur)
+        {
+            if (!me->head)
+            {
+                break;
+            }
+
+            me->cur = me->head;
+            me->head = me->head->next;
+            me->done = 0;
+            me->evict_failures = 0;
+        }
+
+        step(me);
+    }
+
+    me->running = false;
+}
+
+/*------------------------------------------------------------*/
+/*------------------ BLOCKCACHE MEMBER FUNCTIONS -------------*/
+/*------------------------------------------------------------*/
+
+void cusb_blockcache_ctor(struct cusb_blockcache *me,
+                          struct cusb_blockdev *lower,
+                          struct cusb_blockcache_line *lines,
+                          size_t nlines,
+                          uint8_t *buffer,
+                          uint32_t erase_size)
+{
+    CUSB_ASSERT_API( (me && lower && lines && buffer) );
+    CUSB_ASSERT_API( (nlines != 0U) );
+    CUSB_ASSERT_API( (erase_size >= lower->block_size && (erase_size & (erase_size - 1U)) == 0U) );
+
+    uint32_t erase_blocks = erase_size / lower->block_size;
+
+    CUSB_ASSERT_API( ((lower->block_count % erase_blocks) == 0U) );
+
+    memset(me, 0, sizeof(*me));
+    cusb_blockdev_ctor(&me->dev, &API, me, lower->block_size, lower->block_count);
+    me->lower = lower;
+    me->lines = lines;
+    me->nlines = nlines;
+    me->erase_blocks = erase_blocks;
+    me->lower_req.done = &on_lower;
+    me->lower_req.owner = me;
+    me->flush_req.op = CUSB_BLOCKDEV_SYNC;
+    me->flush_req.done = &on_flushed;
+    me->flush_req.owner = me;
+
+    for (size_t i = 0; i < nlines; i++)
+    {
+        lines[i].erase_block = 0;
+        lines[i].stamp = 0;
+        lines[i].data = &buffer[i * erase_size];
+        lines[i].used = false;
+        lines[i].dirty = false;
+    }
+}
+
+struct cusb_blockdev *cusb_blockcache_blockdev(struct cusb_blockcache *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->dev;
+}
+
+bool cusb_blockcache_flush(struct cusb_blockcache *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (!find_dirty(me))
+    {
+        return false;
+    }
+
+    if (!me->flushing)
+    {
+        me->flushing = true;
+        enqueue(me, &me->flush_req);
+        process(me);
+    }
+
+    return true;
+}
+
+bool cusb_blockcache_idle(const struct cusb_blockcache *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (me->cur || me->head)
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < me->nlines; i++)
+    {
+        if (me->lines[i].dirty)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#if (CUSB_CFG_STATS)
+void cusb_blockcache_get_stats(const struct cusb_blockcache *me, struct cusb_blockcache_stats *stats)
+{
+    CUSB_ASSERT_API( (me && stats) );
+    *stats = me->stats;
+}
+#endif
+
+#endif /* CUSB_CFG_BLOCKCACHE */
@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @brief See @ref blockdev.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/blockdev.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_MSC)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/blockdev.c")
+
+/*------------------------------------------------------------*/
+/*------------------- BLOCKDEV MEMBER FUNCTIONS --------------*/
+/*------------------------------------------------------------*/
+
+void cusb_blockdev_ctor(struct cusb_blockdev *me,
+                        const struct cusb_blockdev_api *api,
+                        void *ctx,
+                        uint32_t block_size,
+                        uint32_t block_count)
+{
+    CUSB_ASSERT_API( (me && api && api->submit) );
+    CUSB_ASSERT_API( (block_size >= 512U && (block_size & (block_size - 1U)) == 0U) );
+
+    me->api = api;
+    me->ctx = ctx;
+    me->block_size = block_size;
+    me->block_count = block_count;
+    me->present = true;
+    me->write_protected = false;
+    me->generation = 0;
+}
+
+void cusb_blockdev_submit(struct cusb_blockdev *me, struct cusb_blockdev_req *req)
+{
+    CUSB_ASSERT_PACKET( (me && req && req->done) );
+    CUSB_ASSERT_PACKET( (me->present) );
+    CUSB_ASSERT_PACKET( (req->op == CUSB_BLOCKDEV_READ || req->op == CUSB_BLOCKDEV_WRITE || req->op == CUSB_BLOCKDEV_SYNC) );
+
+    if (req->op != CUSB_BLOCKDEV_SYNC)
+    {
+        CUSB_ASSERT_PACKET( (req->buf && req->count != 0U) );
+        CUSB_ASSERT_PACKET( (req->lba < me->block_count && req->count <= (me->block_count - req->lba)) );
+    }
+
+    (*me->api->submit)(me->ctx, req);
+}
+
+void cusb_blockdev_complete(struct cusb_blockdev_req *req, bool ok)
+{
+    CUSB_ASSERT_PACKET( (req && req->done) );
+    (*req->done)(req, ok);
+}
+
+uint8_t *cusb_blockdev_map(struct cusb_blockdev *me, uint32_t lba, uint32_t count, bool writing)
+{
+    CUSB_ASSERT_PACKET( (me && me->present && count != 0U) );
+    CUSB_ASSERT_PACKET( (lba < me->block_count && count <= (me->block_count - lba)) );
+
+    if (me->api->map == NULL)
+    {
+        return NULL;
+    }
+
+    return (*me->api->map)(me->ctx, lba, count, writing);
+}
+
+void cusb_blockdev_media_changed(struct cusb_blockdev *me, bool present, uint32_t block_count)
+{
+    CUSB_ASSERT_API( (me) );
+
+    me->present = present;
+    if (present)
+    {
+        me->block_count = block_count;
+    }
+    me->generation++;
+}
+
+void cusb_blockdev_set_write_protect(struct cusb_blockdev *me, bool write_protected)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (me->write_protected != write_protected)
+    {
+        me->write_protected = write_protected;
+        me->generation++;
+    }
+}
+
+#endif /* CUSB_CFG_MSC */
@@ -0,0 +1,411 @@
+/**
+ * @file
+ * @brief See @ref bot.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/bot.h"
+
+/* SETUP fields and endian accessors. */
+#include "cusb/setup.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_MSC)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/bot.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define CBW_SIZE                        (31U)
+#define CBW_SIGNATURE                   (0x43425355UL)
+#define CSW_SIGNATURE                   (0x53425355UL)
+#define CBW_FLAG_DATA_IN                (0x80U)
+
+/**
+ * @name bCSWStatus
+ */
+/**@{*/
+#define CSW_PASSED                      (0x00U)
+#define CSW_FAILED                      (0x01U)
+#define CSW_PHASE_ERROR                 (0x02U)
+/**@}*/
+
+/**
+ * @name Class Requests
+ */
+/**@{*/
+#define REQ_GET_MAX_LUN                 (0xFEU)
+#define REQ_BULK_ONLY_RESET             (0xFFU)
+/**@}*/
+
+/**
+ * @name Phases
+ */
+/**@{*/
+#define PHASE_CBW                       (0U)    /**< Waiting for a CBW. */
+#define PHASE_DATA_IN                   (1U)
+#define PHASE_DATA_OUT                  (2U)
+#define PHASE_STATUS                    (3U)    /**< CSW goes out once the task is done. */
+#define PHASE_ERROR                     (4U)    /**< Invalid CBW. Waiting for Reset Recovery. */
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static void command(struct cusb_bot *me, const uint8_t *pkt, size_t len);
+
+/**
+ * @brief Ends the data phase early with a phase error, halting @p halt.
+ */
+static void phase_error(struct cusb_bot *me, uint8_t halt);
+
+/**
+ * @brief Catches a task whose data direction disagrees with the host's.
+ */
+static void settle(struct cusb_bot *me);
+
+/**
+ * @brief Writes the CSW into @p buf and frees the task.
+ */
+static void status(struct cusb_bot *me, uint8_t *buf);
+
+/**
+ * @brief Task notification from the SCSI target.
+ */
+static void on_task(void *ctx, struct cusb_scsi_task *task);
+
+static void signal_ready(struct cusb_bot *me);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void command(struct cusb_bot *me, const uint8_t *pkt, size_t len)
+{
+    uint8_t cdb[16] = {0};
+
+    if (len != CBW_SIZE || cusb_get_le32(&pkt[0]) != CBW_SIGNATURE || (pkt[13] & 0x0FU) >= me->nluns ||
+        pkt[14] == 0U || pkt[14] > 16U)
+    {
+        me->phase = PHASE_ERROR;
+        me->halt = CUSB_BOT_HALT_IN | CUSB_BOT_HALT_OUT;
+        return;
+    }
+
+    me->tag = cusb_get_le32(&pkt[4]);
+    me->data_len = cusb_get_le32(&pkt[8]);
+    me->moved = 0;
+    me->phase_error = false;
+
+    if (me->data_len == 0U)
+    {
+        me->phase = PHASE_STATUS;
+    }
+    else
+    {
+        me->phase = ((pkt[12] & CBW_FLAG_DATA_IN) != 0U) ? PHASE_DATA_IN : PHASE_DATA_OUT;
+    }
+
+    memcpy(cdb, &pkt[15], pkt[14]);
+    cusb_scsi_task_start(&me->luns[pkt[13] & 0x0FU], &me->task, cdb, sizeof(cdb));
+    settle(me);
+}
+
+static void phase_error(struct cusb_bot *me, uint8_t halt)
+{
+    CUSB_TRACE(CUSB_TRACE_BOT_PHASE_ERROR, me->tag);
+    me->phase_error = true;
+    me->halt |= halt;
+    me->phase = PHASE_STATUS;
+}
+
+static void settle(struct cusb_bot *me)
+{
+    if (me->phase == PHASE_DATA_IN && me->task.state == CUSB_SCSI_TASK_DATA_OUT)
+    {
+        /* Hi <> Do. */
+        phase_error(me, CUSB_BOT_HALT_IN);
+    }
+    else if (me->phase == PHASE_DATA_OUT && me->task.state == CUSB_SCSI_TASK_DATA_IN)
+    {
+        /* Ho <> Di. */
+        phase_error(me, CUSB_BOT_HALT_OUT);
+    }
+}
+
+static void status(struct cusb_bot *me, uint8_t *buf)
+{
+    struct cusb_scsi_task *task = &me->task;
+    uint32_t transferred = cusb_scsi_task_transferred(task);
+    uint8_t result = CSW_PASSED;
+
+    if (task->state == CUSB_SCSI_TASK_DONE)
+    {
+        result = (uint8_t)((task->status == CUSB_SCSI_STATUS_GOOD) ? CSW_PASSED : CSW_FAILED);
+        cusb_scsi_task_free(task);
+    }
+    else
+    {
+        /* Task wants more data than the host moved (Hn < Di, Hn < Do, Hi < Di, Ho < Do). */
+        CUSB_TRACE(CUSB_TRACE_BOT_PHASE_ERROR, me->tag);
+        me->phase_error = true;
+        cusb_scsi_task_abort(task);
+    }
+
+    cusb_set_le32(&buf[0], CSW_SIGNATURE);
+    cusb_set_le32(&buf[4], me->tag);
+    cusb_set_le32(&buf[8], (transferred < me->data_len) ? (me->data_len - transferred) : 0U);
+    buf[12] = me->phase_error ? (uint8_t)CSW_PHASE_ERROR : result;
+    me->phase = PHASE_CBW;
+}
+
+static void on_task(void *ctx, struct cusb_scsi_task *task)
+{
+    struct cusb_bot *me = (struct cusb_bot *)ctx;
+
+    (void)task;
+    settle(me);
+    signal_ready(me);
+}
+
+static void signal_ready(struct cusb_bot *me)
+{
+    if (me->notify)
+    {
+        (*me->notify)(me->ctx);
+    }
+}
+
+/*------------------------------------------------------------*/
+/*----------------------- BOT MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+void cusb_bot_ctor(struct cusb_bot *me,
+                   struct cusb_scsi *luns,
+                   size_t nluns,
+                   uint8_t *buf,
+                   size_t buf_size,
+                   uint16_t packet_size,
+                   void (*notify)(void *ctx),
+                   void *ctx)
+{
+    CUSB_ASSERT_API( (me && luns && buf) );
+    CUSB_ASSERT_API( (packet_size >= CUSB_BOT_CSW_SIZE && packet_size <= CUSB_CFG_BULK_SIZE_MAX) );
+
+    cusb_scsi_attach(luns, nluns);
+    cusb_scsi_task_ctor(&me->task, buf, buf_size, &on_task, me);
+    me->luns = luns;
+    me->nluns = (uint8_t)nluns;
+    me->packet_size = packet_size;
+    me->phase = PHASE_CBW;
+    me->halt = 0;
+    me->phase_error = false;
+    me->tag = 0;
+    me->data_len = 0;
+    me->moved = 0;
+    me->notify = notify;
+    me->ctx = ctx;
+}
+
+size_t cusb_bot_bulk_out_space(const struct cusb_bot *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+
+    const struct cusb_scsi_task *task = &me->task;
+
+    if (me->phase == PHASE_CBW)
+    {
+        /* Slot can still be finishing an aborted backend request. */
+        return (task->state == CUSB_SCSI_TASK_IDLE) ? me->packet_size : 0U;
+    }
+
+    if (me->phase != PHASE_DATA_OUT)
+    {
+        return 0;
+    }
+
+    uint32_t left = me->data_len - me->moved;
+
+    if (task->state == CUSB_SCSI_TASK_DATA_OUT)
+    {
+        uint32_t space = cusb_scsi_task_data_out_space(task);
+        return (space < left) ? space : left;
+    }
+
+    /* Done (failed or wanted less) drops the rest. Waiting takes nothing. */
+    return (task->state == CUSB_SCSI_TASK_DONE) ? left : 0U;
+}
+
+void cusb_bot_bulk_out(struct cusb_bot *me, const uint8_t *pkt, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me && (pkt || len == 0U)) );
+
+    if (me->phase == PHASE_CBW)
+    {
+        command(me, pkt, len);
+        signal_ready(me);
+        return;
+    }
+
+    if (me->phase != PHASE_DATA_OUT)
+    {
+        /* Leftover data after a phase error. */
+        return;
+    }
+
+    CUSB_ASSERT_PACKET( (len <= cusb_bot_bulk_out_space(me)) );
+
+    uint32_t left = cusb_scsi_task_data_out_left(&me->task);
+    size_t give = (len < left) ? len : left;
+
+    if (give != 0U)
+    {
+        cusb_scsi_task_data_out(&me->task, pkt, give);
+    }
+
+    me->moved += (uint32_t)len;
+
+    if (me->moved == me->data_len)
+    {
+        me->phase = PHASE_STATUS;
+        signal_ready(me);
+    }
+}
+
+bool cusb_bot_bulk_in(struct cusb_bot *me, uint8_t *buf, size_t size, size_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && buf && len) );
+    CUSB_ASSERT_PACKET( (size >= me->packet_size && (size % me->packet_size) == 0U) );
+
+    struct cusb_scsi_task *task = &me->task;
+
+    if (task->state == CUSB_SCSI_TASK_WAIT)
+    {
+        return false;
+    }
+
+    if (me->phase == PHASE_STATUS)
+    {
+        status(me, buf);
+        *len = CUSB_BOT_CSW_SIZE;
+        return true;
+    }
+
+    if (me->phase != PHASE_DATA_IN)
+    {
+        return false;
+    }
+
+    if (task->state != CUSB_SCSI_TASK_DATA_IN)
+    {
+        /* Device has less than the host asked for (Hi > Dn, Hi > Di). */
+        me->halt |= CUSB_BOT_HALT_IN;
+        me->phase = PHASE_STATUS;
+        return false;
+    }
+
+    uint32_t left = me->data_len - me->moved;
+    size_t n = cusb_scsi_task_data_in(task, buf, (size < left) ? size : left);
+
+    me->moved += (uint32_t)n;
+
+    if (me->moved == me->data_len)
+    {
+        me->phase = PHASE_STATUS;
+    }
+    else if (cusb_scsi_task_data_in_done(task))
+    {
+        /* Ended early. A short packet ends the data phase, otherwise halt. */
+        if ((n % me->packet_size) == 0U)
+        {
+            me->halt |= CUSB_BOT_HALT_IN;
+        }
+        me->phase = PHASE_STATUS;
+    }
+
+    *len = n;
+    return true;
+}
+
+uint8_t cusb_bot_halt(struct cusb_bot *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    uint8_t halt = me->halt;
+    me->halt = 0;
+    return halt;
+}
+
+bool cusb_bot_clear_halt(struct cusb_bot *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->phase != PHASE_ERROR;
+}
+
+bool cusb_bot_control(struct cusb_bot *me, const uint8_t *setup,
+                      uint8_t *resp, size_t *resp_len)
+{
+    CUSB_ASSERT_API( (me && setup && resp && resp_len) );
+
+    switch (cusb_setup_request(setup))
+    {
+        case REQ_GET_MAX_LUN:
+        {
+            resp[0] = (uint8_t)(me->nluns - 1U);
+            *resp_len = 1;
+            return true;
+        }
+
+        case REQ_BULK_ONLY_RESET:
+        {
+            cusb_bot_reset(me);
+            *resp_len = 0;
+            return true;
+        }
+
+        default:
+        {
+            return false;
+        }
+    }
+}
+
+void cusb_bot_reset(struct cusb_bot *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (me->task.state != CUSB_SCSI_TASK_IDLE)
+    {
+        cusb_scsi_task_abort(&me->task);
+    }
+
+    me->phase = PHASE_CBW;
+    me->halt = 0;
+    me->phase_error = false;
+}
+
+#endif /* CUSB_CFG_MSC */
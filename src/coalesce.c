@@ -0,0 +1,140 @@
+/**
+ * @file
+ * @brief See @ref coalesce.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/coalesce.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_COALESCE)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/coalesce.c")
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Hands the filled bank to the callback and switches banks,
+ * until a callback returns with nothing new posted.
+ */
+static void deliver(struct cusb_coalesce *me);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void deliver(struct cusb_coalesce *me)
+{
+    if (me->delivering)
+    {
+        /* Posted from inside the callback. Picked up once it returns. */
+        return;
+    }
+
+    me->delivering = true;
+
+    while (me->count != 0U)
+    {
+        const struct cusb_completion *bank = me->fill;
+        size_t count = me->count;
+
+        me->fill = (bank == me->results) ? &me->results[me->batch] : me->results;
+        me->count = 0;
+#if (CUSB_CFG_STATS)
+        me->stats.callbacks++;
+#endif
+        (*me->callback)(me->obj, bank, count);
+    }
+
+    me->delivering = false;
+}
+
+/*------------------------------------------------------------*/
+/*------------------- COALESCE MEMBER FUNCTIONS --------------*/
+/*------------------------------------------------------------*/
+
+void cusb_coalesce_ctor(struct cusb_coalesce *me,
+                        struct cusb_completion *results,
+                        size_t nresults,
+                        void (*callback)(void *obj, const struct cusb_completion *results, size_t count),
+                        void *obj)
+{
+    CUSB_ASSERT_API( (me && results && callback) );
+    CUSB_ASSERT_API( (nresults >= 2U && (nresults % 2U) == 0U && nresults <= 0x1FFFEUL) );
+
+    me->results = results;
+    me->batch = (uint16_t)(nresults / 2U);
+    me->fill = results;
+    me->count = 0;
+    me->delivering = false;
+    me->callback = callback;
+    me->obj = obj;
+#if (CUSB_CFG_STATS)
+    me->stats.completions = 0;
+    me->stats.callbacks = 0;
+#endif
+}
+
+void cusb_coalesce_post(struct cusb_coalesce *me, uint8_t ep, uint8_t *buf, uint16_t len, bool ok)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    /* Only reachable when a callback restarts more than a batch of transfers. */
+    CUSB_ASSERT_PACKET( (me->count < me->batch) );
+
+    struct cusb_completion *result = &me->fill[me->count];
+
+    /* Scalars rather than a struct so an interrupt handler posts straight
+    from registers without building a copy on its stack. */
+    result->buf = buf;
+    result->len = len;
+    result->ep = ep;
+    result->ok = ok;
+    me->count++;
+#if (CUSB_CFG_STATS)
+    me->stats.completions++;
+#endif
+
+    if (me->count == me->batch)
+    {
+        deliver(me);
+    }
+}
+
+void cusb_coalesce_flush(struct cusb_coalesce *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    deliver(me);
+}
+
+size_t cusb_coalesce_pending(const struct cusb_coalesce *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->count;
+}
+
+#if (CUSB_CFG_STATS)
+const struct cusb_coalesce_stats *cusb_coalesce_get_stats(const struct cusb_coalesce *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+#endif
+
+#endif /* CUSB_CFG_COALESCE */
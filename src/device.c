@@ -0,0 +1,1322 @@
+/**
+ * @file
+ * @brief See @ref device.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/device.h"
+
+/* SETUP and descriptor fields. */
+#include "cusb/setup.h"
+
+/* STDLib. */
+#include <stdint.h>
+#include <string.h>
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/device.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Standard Requests
+ */
+/**@{*/
+#define REQ_GET_STATUS                  (0U)
+#define REQ_CLEAR_FEATURE               (1U)
+#define REQ_SET_FEATURE                 (3U)
+#define REQ_SET_ADDRESS                 (5U)
+#define REQ_GET_DESCRIPTOR              (6U)
+#define REQ_GET_CONFIGURATION           (8U)
+#define REQ_SET_CONFIGURATION           (9U)
+/**@}*/
+
+/**
+ * @name Feature Selectors
+ */
+/**@{*/
+#define FEATURE_ENDPOINT_HALT           (0U)
+#define FEATURE_DEVICE_REMOTE_WAKEUP    (1U)
+/**@}*/
+
+/**
+ * @name Descriptor Types
+ */
+/**@{*/
+#define DESC_DEVICE                     (1U)
+#define DESC_CONFIGURATION              (2U)
+#define DESC_STRING                     (3U)
+#define DESC_DEVICE_QUALIFIER           (6U)
+#define DESC_ENDPOINT                   (5U)
+/**@}*/
+
+/**
+ * @name Control Transfer Stages
+ */
+/**@{*/
+#define STAGE_IDLE                      (0U)
+#define STAGE_DATA_IN                   (1U)
+#define STAGE_DATA_OUT                  (2U)
+#define STAGE_STATUS_IN                 (3U)
+#define STAGE_STATUS_OUT                (4U)
+/**@}*/
+
+/**
+ * @brief bmAttributes bit of the configuration descriptor.
+ */
+#define CONFIG_SELF_POWERED             (0x40U)
+
+/**
+ * @brief bMaxPower unit of a full or high-speed device, in mA.
+ */
+#define CONFIG_POWER_UNIT_MA            (2U)
+
+/**
+ * @name Load Accounting
+ * Bracket work charged to the attached @ref cusb_load, if any.
+ */
+/**@{*/
+#if (CUSB_CFG_LOAD)
+#define LOAD_ENTER(dev, context)        do { if ((dev)->load) { cusb_load_enter((dev)->load, (context)); } } while (0)
+#define LOAD_EXIT(dev)                  do { if ((dev)->load) { cusb_load_exit((dev)->load); } } while (0)
+#else
+#define LOAD_ENTER(dev, context)        ((void)0)
+#define LOAD_EXIT(dev)                  ((void)0)
+#endif
+/**@}*/
+
+/**
+ * @name Bus Timing
+ * Microseconds per full-speed frame and per high-speed microframe.
+ */
+/**@{*/
+#define FRAME_US                        (1000UL)
+#define MICROFRAME_US                   (125UL)
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Descriptors are served in place and IN transfers only read
+ * their buffer, so dropping const here never leads to a write.
+ */
+static inline uint8_t *in_buf(const uint8_t *p);
+
+static inline struct cusb_device_ep *endpoint(struct cusb_device *me, uint8_t ep);
+
+static void close_endpoints(struct cusb_device *me);
+
+static void open_endpoint(struct cusb_device *me, const struct cusb_device_binding *binding);
+
+/**
+ * @brief Passes bus event @p ev to the application, if it wants them.
+ */
+static void notify(struct cusb_device *me, uint8_t ev);
+
+/**
+ * @brief Configuration endpoints are described by: the active one, or
+ * the first if none is selected yet.
+ */
+static inline const struct cusb_device_config *current(const struct cusb_device *me);
+
+/**
+ * @brief Service interval of periodic endpoint address @p ep in
+ * microseconds, from its bInterval in the configuration descriptor.
+ * 0 for bulk endpoints or if the descriptor is not found.
+ */
+static uint32_t interval_us(const struct cusb_device *me, uint8_t ep, uint8_t type);
+
+/**
+ * @brief Closes every endpoint, selects @p config, opens its bindings
+ * and tells the application. NULL deconfigures. Returns false if the
+ * application rejected the configuration.
+ */
+static bool configure(struct cusb_device *me, const struct cusb_device_config *config);
+
+static void control_stall(struct cusb_device *me);
+
+/**
+ * @brief Starts the data or status stage of the request in
+ * @ref cusb_device.setup answered with @p len bytes at @p data.
+ */
+static void control_reply(struct cusb_device *me, uint8_t *data, uint16_t len);
+
+static void control_status(struct cusb_device *me, uint8_t stage);
+
+/**
+ * @brief Standard request handled by the core. Sets @p data and @p len
+ * to the reply. Returns false to stall, or leaves @p data NULL and
+ * returns true if the request should go to the application instead.
+ */
+static bool standard_request(struct cusb_device *me, uint8_t **data, uint16_t *len);
+
+static bool get_descriptor(const struct cusb_device *me, uint8_t **data, uint16_t *len);
+
+static void control_done(struct cusb_device *me, uint8_t ep, uint32_t len);
+
+static void flush_coalescers(struct cusb_device *me);
+
+#if (CUSB_CFG_COALESCE)
+/**
+ * @brief Bit of endpoint address @p ep in @ref cusb_device.coalesce_dirty.
+ */
+static inline uint32_t coalesce_bit(uint8_t ep);
+#endif
+
+#if (CUSB_CFG_DMA)
+/**
+ * @brief Checks a transfer about to be handed to a DMA driver and
+ * prepares the cache for it.
+ */
+static void dma_start(const struct cusb_device *me, uint8_t ep, uint8_t *buf, uint32_t len);
+
+/**
+ * @brief Drops lines the CPU may have loaded over an OUT buffer while
+ * the engine was writing it.
+ */
+static void dma_done(const struct cusb_device *me, uint8_t ep, uint8_t *buf, uint32_t len);
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static inline uint8_t *in_buf(const uint8_t *p)
+{
+    return (uint8_t *)(uintptr_t)p;
+}
+
+static inline struct cusb_device_ep *endpoint(struct cusb_device *me, uint8_t ep)
+{
+    CUSB_ASSERT_PACKET( (CUSB_EP_NUM(ep) < CUSB_CFG_ENDPOINTS) );
+    return &me->ep[CUSB_EP_IS_IN(ep) ? 1 : 0][CUSB_EP_NUM(ep)];
+}
+
+static void close_endpoints(struct cusb_device *me)
+{
+    for (uint8_t dir = 0; dir < 2U; dir++)
+    {
+        for (uint8_t num = 1; num < CUSB_CFG_ENDPOINTS; num++)
+        {
+            if (me->ep[dir][num].open)
+            {
+                cusb_device_ep_close(me, (uint8_t)(num | (dir ? CUSB_EP_DIR_IN : 0U)));
+            }
+        }
+    }
+}
+
+static void open_endpoint(struct cusb_device *me, const struct cusb_device_binding *binding)
+{
+    uint8_t ep = binding->ep;
+    uint8_t type = binding->type;
+    struct cusb_device_ep *e = endpoint(me, ep);
+    CUSB_ASSERT_INTERNAL( (!e->open) );
+
+    e->binding = binding;
+    e->buf = NULL;
+    e->interval_us = interval_us(me, ep, type);
+    e->open = true;
+    e->busy = false;
+    e->stalled = false;
+    (*me->dcd->api->ep_open)(me->dcd->ctx, ep, type, binding->mps);
+}
+
+static void notify(struct cusb_device *me, uint8_t ev)
+{
+    if (me->callbacks->event)
+    {
+        LOAD_ENTER(me, CUSB_LOAD_CALLBACK);
+        (*me->callbacks->event)(me->obj, ev);
+        LOAD_EXIT(me);
+    }
+}
+
+static inline const struct cusb_device_config *current(const struct cusb_device *me)
+{
+    return me->active ? me->active : me->configs;
+}
+
+static uint32_t interval_us(const struct cusb_device *me, uint8_t ep, uint8_t type)
+{
+    const struct cusb_device_config *config = current(me);
+
+    if (!config || (type != CUSB_EP_ISOCHRONOUS && type != CUSB_EP_INTERRUPT))
+    {
+        return 0;
+    }
+
+    uint8_t binterval = config->binterval[CUSB_EP_IS_IN(ep) ? 1 : 0][CUSB_EP_NUM(ep)];
+
+    if (binterval == 0U)
+    {
+        return 0;
+    }
+
+    if (me->speed == CUSB_SPEED_FULL && type == CUSB_EP_INTERRUPT)
+    {
+        return (uint32_t)binterval * FRAME_US;
+    }
+
+    binterval = (binterval > 16U) ? 16U : binterval;
+    return (uint32_t)(((me->speed == CUSB_SPEED_HIGH) ? MICROFRAME_US : FRAME_US) << (binterval - 1U));
+}
+
+static bool configure(struct cusb_device *me, const struct cusb_device_config *config)
+{
+    close_endpoints(me);
+    me->active = config;
+    me->state = config ? CUSB_DEVICE_CONFIGURED : CUSB_DEVICE_ADDRESS;
+
+    for (uint8_t i = 0; config && i < config->nbindings; i++)
+    {
+        open_endpoint(me, &config->bindings[i]);
+    }
+
+    bool ok = true;
+
+    if (me->callbacks->configure)
+    {
+        LOAD_ENTER(me, CUSB_LOAD_CALLBACK);
+        ok = (*me->callbacks->configure)(me->obj, config ? config->value : 0U);
+        LOAD_EXIT(me);
+    }
+
+    if (!ok)
+    {
+        close_endpoints(me);
+        me->active = NULL;
+        me->state = CUSB_DEVICE_ADDRESS;
+        return false;
+    }
+
+    return true;
+}
+
+static void control_stall(struct cusb_device *me)
+{
+    me->ctl_stage = STAGE_IDLE;
+    (*me->dcd->api->ep_stall)(me->dcd->ctx, CUSB_EP_DIR_IN, true);
+    (*me->dcd->api->ep_stall)(me->dcd->ctx, 0x00U, true);
+#if (CUSB_CFG_STATS)
+    me->stats.stalls++;
+#endif
+}
+
+static void control_status(struct cusb_device *me, uint8_t stage)
+{
+    me->ctl_stage = stage;
+    (*me->dcd->api->ep_xfer)(me->dcd->ctx, (stage == STAGE_STATUS_IN) ? CUSB_EP_DIR_IN : 0x00U, NULL, 0);
+}
+
+static void control_reply(struct cusb_device *me, uint8_t *data, uint16_t len)
+{
+    uint16_t wlength = cusb_setup_length(me->setup);
+
+    if (wlength == 0U)
+    {
+        control_status(me, STAGE_STATUS_IN);
+    }
+    else if ((cusb_setup_request_type(me->setup) & CUSB_SETUP_DIR_IN) != 0U)
+    {
+        if (len > wlength)
+        {
+            len = wlength;
+        }
+
+        /* A reply shorter than asked for ends with a short packet, which
+        needs an extra zero length one if it is a whole number of them. */
+        me->ctl_zlp = (len < wlength) && (len != 0U) && ((len % CUSB_CFG_EP0_SIZE) == 0U);
+        me->ctl_stage = STAGE_DATA_IN;
+        (*me->dcd->api->ep_xfer)(me->dcd->ctx, CUSB_EP_DIR_IN, data, len);
+    }
+    else if (data && len >= wlength)
+    {
+        me->ctl_data = data;
+        me->ctl_stage = STAGE_DATA_OUT;
+        (*me->dcd->api->ep_xfer)(me->dcd->ctx, 0x00U, data, wlength);
+    }
+    else
+    {
+        control_stall(me);
+    }
+}
+
+static bool get_descriptor(const struct cusb_device *me, uint8_t **data, uint16_t *len)
+{
+    const struct cusb_device_descriptors *desc = me->desc;
+    uint16_t wvalue = cusb_setup_value(me->setup);
+    uint8_t type = (uint8_t)(wvalue >> 8);
+    uint8_t index = (uint8_t)wvalue;
+
+    switch (type)
+    {
+        case DESC_DEVICE:
+        {
+            *data = in_buf(desc->device);
+            *len = desc->device[0];
+            break;
+        }
+        case DESC_CONFIGURATION:
+        {
+            if (index >= me->nconfigs)
+            {
+                return false;
+            }
+
+            *data = in_buf(me->configs[index].desc);
+            *len = me->configs[index].total_length;
+            break;
+        }
+        case DESC_STRING:
+        {
+            if (index >= desc->nstrings)
+            {
+                return false;
+            }
+
+            *data = in_buf(desc->strings[index]);
+            *len = desc->strings[index][0];
+            break;
+        }
+        case DESC_DEVICE_QUALIFIER:
+        {
+            if (!desc->qualifier)
+            {
+                return false;
+            }
+
+            *data = in_buf(desc->qualifier);
+            *len = desc->qualifier[0];
+            break;
+        }
+        default:
+        {
+            /* BOS, class descriptors and so on belong to the application. */
+            break;
+        }
+    }
+
+    return true;
+}
+
+static bool standard_request(struct cusb_device *me, uint8_t **data, uint16_t *len)
+{
+    uint8_t recipient = cusb_setup_request_type(me->setup) & CUSB_SETUP_RECIPIENT_MASK;
+    uint8_t request = cusb_setup_request(me->setup);
+    uint16_t wvalue = cusb_setup_value(me->setup);
+    uint16_t windex = cusb_setup_index(me->setup);
+
+    if (recipient == CUSB_SETUP_RECIPIENT_DEVICE)
+    {
+        switch (request)
+        {
+            case REQ_GET_STATUS:
+            {
+                me->ctl_buf[0] = (uint8_t)((current(me)->self_powered ? 1U : 0U) |
+                                           (me->remote_wakeup ? 2U : 0U));
+                me->ctl_buf[1] = 0;
+                *data = me->ctl_buf;
+                *len = 2;
+                return true;
+            }
+            case REQ_CLEAR_FEATURE:
+            case REQ_SET_FEATURE:
+            {
+                if (wvalue != FEATURE_DEVICE_REMOTE_WAKEUP)
+                {
+                    /* TEST_MODE is not supported. */
+                    return false;
+                }
+
+                me->remote_wakeup = (request == REQ_SET_FEATURE);
+                *data = me->ctl_buf;
+                *len = 0;
+                return true;
+            }
+            case REQ_SET_ADDRESS:
+            {
+                if (wvalue > 127U || me->state == CUSB_DEVICE_CONFIGURED)
+                {
+                    return false;
+                }
+
+                /* Driver applies it after the status stage. State follows once that completed. */
+                me->address = (uint8_t)wvalue;
+                (*me->dcd->api->set_address)(me->dcd->ctx, me->address);
+                *data = me->ctl_buf;
+                *len = 0;
+                return true;
+            }
+            case REQ_GET_DESCRIPTOR:
+            {
+                return get_descriptor(me, data, len);
+            }
+            case REQ_GET_CONFIGURATION:
+            {
+                me->ctl_buf[0] = me->active ? me->active->value : 0U;
+                *data = me->ctl_buf;
+                *len = 1;
+                return true;
+            }
+            case REQ_SET_CONFIGURATION:
+            {
+                const struct cusb_device_config *config = NULL;
+
+                for (uint8_t i = 0; wvalue != 0U && i < me->nconfigs && !config; i++)
+                {
+                    config = (me->configs[i].value == wvalue) ? &me->configs[i] : NULL;
+                }
+
+                if (me->state < CUSB_DEVICE_ADDRESS || (wvalue != 0U && !config))
+                {
+                    return false;
+                }
+
+                *data = me->ctl_buf;
+                *len = 0;
+                return configure(me, config);
+            }
+            default:
+            {
+                return false;
+            }
+        }
+    }
+    else if (recipient == CUSB_SETUP_RECIPIENT_ENDPOINT)
+    {
+        uint8_t ep = (uint8_t)windex;
+
+        if (CUSB_EP_NUM(ep) >= CUSB_CFG_ENDPOINTS || (ep & 0x70U) != 0U)
+        {
+            return false;
+        }
+
+        struct cusb_device_ep *e = endpoint(me, ep);
+
+        if (CUSB_EP_NUM(ep) != 0U && !e->open)
+        {
+            return false;
+        }
+
+        switch (request)
+        {
+            case REQ_GET_STATUS:
+            {
+                me->ctl_buf[0] = e->stalled ? 1U : 0U;
+                me->ctl_buf[1] = 0;
+                *data = me->ctl_buf;
+                *len = 2;
+                return true;
+            }
+            case REQ_CLEAR_FEATURE:
+            case REQ_SET_FEATURE:
+            {
+                if (wvalue != FEATURE_ENDPOINT_HALT)
+                {
+                    return false;
+                }
+
+                if (CUSB_EP_NUM(ep) != 0U)
+                {
+                    cusb_device_ep_stall(me, ep, request == REQ_SET_FEATURE);
+                }
+
+                *data = me->ctl_buf;
+                *len = 0;
+                return true;
+            }
+            default:
+            {
+                return false;
+            }
+        }
+    }
+    else if (recipient == CUSB_SETUP_RECIPIENT_INTERFACE && request == REQ_GET_STATUS)
+    {
+        if (me->state != CUSB_DEVICE_CONFIGURED)
+        {
+            return false;
+        }
+
+        me->ctl_buf[0] = 0;
+        me->ctl_buf[1] = 0;
+        *data = me->ctl_buf;
+        *len = 2;
+        return true;
+    }
+
+    /* GET_INTERFACE, SET_INTERFACE and the like go to the application. */
+    return true;
+}
+
+static void control_done(struct cusb_device *me, uint8_t ep, uint32_t len)
+{
+    switch (me->ctl_stage)
+    {
+        case STAGE_DATA_IN:
+        {
+            if (me->ctl_zlp)
+            {
+                me->ctl_zlp = false;
+                (*me->dcd->api->ep_xfer)(me->dcd->ctx, CUSB_EP_DIR_IN, NULL, 0);
+            }
+            else
+            {
+                control_status(me, STAGE_STATUS_OUT);
+            }
+            break;
+        }
+        case STAGE_DATA_OUT:
+        {
+            bool ok = true;
+
+            if (me->callbacks->control_out)
+            {
+                LOAD_ENTER(me, CUSB_LOAD_CALLBACK);
+                ok = (*me->callbacks->control_out)(me->obj, me->setup, me->ctl_data, (uint16_t)len);
+                LOAD_EXIT(me);
+            }
+
+            if (!ok)
+            {
+                control_stall(me);
+            }
+            else
+            {
+                control_status(me, STAGE_STATUS_IN);
+            }
+            break;
+        }
+        case STAGE_STATUS_IN:
+        {
+            me->ctl_stage = STAGE_IDLE;
+
+            if (cusb_setup_request(me->setup) == REQ_SET_ADDRESS && (cusb_setup_request_type(me->setup) & CUSB_SETUP_TYPE_MASK) == CUSB_SETUP_TYPE_STANDARD)
+            {
+                me->state = (me->address != 0U) ? CUSB_DEVICE_ADDRESS : CUSB_DEVICE_DEFAULT;
+            }
+            break;
+        }
+        case STAGE_STATUS_OUT:
+        {
+            me->ctl_stage = STAGE_IDLE;
+            break;
+        }
+        default:
+        {
+            /* Stale completion of a transfer the last SETUP cancelled. */
+            (void)ep;
+            break;
+        }
+    }
+}
+
+#if (CUSB_CFG_COALESCE)
+static inline uint32_t coalesce_bit(uint8_t ep)
+{
+    return (uint32_t)1U << ((CUSB_EP_IS_IN(ep) ? 16U : 0U) + CUSB_EP_NUM(ep));
+}
+#endif
+
+static void flush_coalescers(struct cusb_device *me)
+{
+#if (CUSB_CFG_COALESCE)
+    while (me->coalesce_dirty != 0U)
+    {
+        uint32_t dirty = me->coalesce_dirty;
+        me->coalesce_dirty = 0;
+
+        for (uint8_t i = 0; dirty != 0U; i++, dirty >>= 1)
+        {
+            if ((dirty & 1U) != 0U)
+            {
+                /* Shared coalescers are flushed once, later calls find them empty. */
+                LOAD_ENTER(me, CUSB_LOAD_CALLBACK);
+                cusb_coalesce_flush(me->ep[i >> 4][i & 0x0FU].binding->coalesce);
+                LOAD_EXIT(me);
+            }
+        }
+    }
+#else
+    (void)me;
+#endif
+}
+
+#if (CUSB_CFG_DMA)
+static void dma_start(const struct cusb_device *me, uint8_t ep, uint8_t *buf, uint32_t len)
+{
+    const struct cusb_dcd_dma *dma = me->dcd->dma;
+    const struct cusb_device_cache *cache = me->cache;
+
+    if (!dma)
+    {
+        return;
+    }
+
+    CUSB_ASSERT_PACKET( (((uintptr_t)buf & (dma->align - 1U)) == 0U && len <= dma->max_len) );
+    CUSB_ASSERT_PACKET( (CUSB_EP_IS_IN(ep) || (len & (dma->granule - 1U)) == 0U) );
+
+    if (!cache || len == 0U)
+    {
+        return;
+    }
+
+    if (CUSB_EP_IS_IN(ep))
+    {
+        (*cache->clean)(me->cache_obj, buf, len);
+    }
+    else
+    {
+        /* Invalidating a partial line would throw away whatever shares it. */
+        CUSB_ASSERT_PACKET( ((((uintptr_t)buf | len) & (cache->line - 1U)) == 0U) );
+        (*cache->invalidate)(me->cache_obj, buf, len);
+    }
+}
+
+static void dma_done(const struct cusb_device *me, uint8_t ep, uint8_t *buf, uint32_t len)
+{
+    const struct cusb_device_cache *cache = me->cache;
+
+    if (me->dcd->dma && cache && !CUSB_EP_IS_IN(ep) && len != 0U)
+    {
+        /* Within the transfer, whose length is a whole number of lines. */
+        (*cache->invalidate)(me->cache_obj, buf, (len + cache->line - 1U) & ~(uint32_t)(cache->line - 1U));
+    }
+}
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------- DCD MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_dcd_ctor(struct cusb_dcd *me, const struct cusb_dcd_api *api, void *ctx)
+{
+    CUSB_ASSERT_API( (me && api) );
+    CUSB_ASSERT_API( (api->connect && api->set_address && api->ep_open && api->ep_close) );
+    CUSB_ASSERT_API( (api->ep_xfer && api->ep_stall && api->service && api->irq_enable) );
+
+    me->api = api;
+    me->ctx = ctx;
+    me->dev = NULL;
+#if (CUSB_CFG_DMA)
+    me->dma = NULL;
+#endif
+}
+
+#if (CUSB_CFG_DMA)
+void cusb_dcd_set_dma(struct cusb_dcd *me, const struct cusb_dcd_dma *dma)
+{
+    CUSB_ASSERT_API( (me && dma && dma->max_len > 0U) );
+    CUSB_ASSERT_API( (dma->align > 0U && (dma->align & (dma->align - 1U)) == 0U) );
+    CUSB_ASSERT_API( (dma->granule > 0U && (dma->granule & (dma->granule - 1U)) == 0U) );
+    me->dma = dma;
+}
+#endif
+
+void cusb_dcd_bus_reset(struct cusb_dcd *me, uint8_t speed)
+{
+    CUSB_ASSERT_API( (me && me->dev) );
+    struct cusb_device *dev = me->dev;
+    bool configured = (dev->active != NULL);
+
+    /* Controller already closed every endpoint. Completions posted before
+    the reset are still delivered. */
+    flush_coalescers(dev);
+    memset(dev->ep, 0, sizeof(dev->ep));
+    dev->ep[0][0].open = true;
+    dev->ep[1][0].open = true;
+    dev->ctl_stage = STAGE_IDLE;
+    dev->state = CUSB_DEVICE_DEFAULT;
+    dev->address = 0;
+    dev->active = NULL;
+    dev->speed = speed;
+    dev->suspended = false;
+    dev->remote_wakeup = false;
+
+    if (configured && dev->callbacks->configure)
+    {
+        LOAD_ENTER(dev, CUSB_LOAD_CALLBACK);
+        (void)(*dev->callbacks->configure)(dev->obj, 0);
+        LOAD_EXIT(dev);
+    }
+
+    notify(dev, CUSB_DEVICE_EVENT_RESET);
+}
+
+void cusb_dcd_setup(struct cusb_dcd *me, const uint8_t *setup)
+{
+    CUSB_ASSERT_API( (me && me->dev && setup) );
+    struct cusb_device *dev = me->dev;
+    uint8_t *data = NULL;
+    uint16_t len = 0;
+    bool ok = true;
+
+    if (dev->ctl_stage == STAGE_STATUS_IN)
+    {
+        /* Host only moves on once the status stage went through, even if
+        the new SETUP cancelled its completion before it was serviced. */
+        control_done(dev, CUSB_EP_DIR_IN, 0);
+    }
+
+    memcpy(dev->setup, setup, sizeof(dev->setup));
+    dev->ctl_stage = STAGE_IDLE;
+    dev->ctl_zlp = false;
+#if (CUSB_CFG_STATS)
+    dev->stats.setups++;
+#endif
+
+    if ((cusb_setup_request_type(setup) & CUSB_SETUP_TYPE_MASK) == CUSB_SETUP_TYPE_STANDARD)
+    {
+        ok = standard_request(dev, &data, &len);
+    }
+
+    if (ok && !data)
+    {
+        ok = false;
+
+        if (dev->callbacks->control)
+        {
+            LOAD_ENTER(dev, CUSB_LOAD_CALLBACK);
+            ok = (*dev->callbacks->control)(dev->obj, dev->setup, &data, &len);
+            LOAD_EXIT(dev);
+        }
+    }
+
+    if (ok)
+    {
+        control_reply(dev, data, len);
+    }
+    else
+    {
+        control_stall(dev);
+    }
+}
+
+void cusb_dcd_xfer_done(struct cusb_dcd *me, uint8_t ep, uint32_t len, bool ok)
+{
+    CUSB_ASSERT_PACKET( (me && me->dev) );
+    struct cusb_device *dev = me->dev;
+
+    if (CUSB_EP_NUM(ep) == 0U)
+    {
+        control_done(dev, ep, len);
+        return;
+    }
+
+    struct cusb_device_ep *e = endpoint(dev, ep);
+
+    if (!e->busy)
+    {
+        /* Closed while the completion was pending. */
+        return;
+    }
+
+    e->busy = false;
+    const struct cusb_device_binding *binding = e->binding;
+
+#if (CUSB_CFG_DMA)
+    dma_done(dev, ep, e->buf, len);
+#endif
+
+#if (CUSB_CFG_COALESCE)
+    if (binding->coalesce)
+    {
+        CUSB_ASSERT_PACKET( (len <= UINT16_MAX) );
+        /* Posting calls back once a batch is full. */
+        LOAD_ENTER(dev, CUSB_LOAD_CALLBACK);
+        cusb_coalesce_post(binding->coalesce, ep, e->buf, (uint16_t)len, ok);
+        LOAD_EXIT(dev);
+        dev->coalesce_dirty |= coalesce_bit(ep);
+        return;
+    }
+#endif
+
+    LOAD_ENTER(dev, CUSB_LOAD_CALLBACK);
+    (*binding->done)(binding->obj, ep, e->buf, len, ok);
+    LOAD_EXIT(dev);
+}
+
+void cusb_dcd_sof(struct cusb_dcd *me, uint16_t frame)
+{
+    CUSB_ASSERT_PACKET( (me && me->dev) );
+
+    if (me->dev->callbacks->sof)
+    {
+        LOAD_ENTER(me->dev, CUSB_LOAD_CALLBACK);
+        (*me->dev->callbacks->sof)(me->dev->obj, frame);
+        LOAD_EXIT(me->dev);
+    }
+}
+
+void cusb_dcd_suspend(struct cusb_dcd *me)
+{
+    CUSB_ASSERT_API( (me && me->dev) );
+    me->dev->suspended = true;
+    notify(me->dev, CUSB_DEVICE_EVENT_SUSPEND);
+}
+
+void cusb_dcd_resume(struct cusb_dcd *me)
+{
+    CUSB_ASSERT_API( (me && me->dev) );
+
+    if (!me->dev->suspended)
+    {
+        return;
+    }
+
+    me->dev->suspended = false;
+    notify(me->dev, CUSB_DEVICE_EVENT_RESUME);
+}
+
+/*------------------------------------------------------------*/
+/*-------------------- DEVICE MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+void cusb_device_ctor(struct cusb_device *me,
+                      struct cusb_dcd *dcd,
+                      const struct cusb_device_descriptors *desc,
+                      const struct cusb_device_callbacks *callbacks,
+                      void *obj)
+{
+    CUSB_ASSERT_API( (me && dcd && desc && callbacks) );
+    CUSB_ASSERT_API( (desc->device) );
+    CUSB_ASSERT_API( (desc->device[7] == CUSB_CFG_EP0_SIZE) );
+    CUSB_ASSERT_API( (desc->strings || desc->nstrings == 0U) );
+
+    memset(me, 0, sizeof(*me));
+    me->dcd = dcd;
+    me->desc = desc;
+    me->callbacks = callbacks;
+    me->obj = obj;
+    me->state = CUSB_DEVICE_DETACHED;
+    dcd->dev = me;
+
+    if (desc->config)
+    {
+        cusb_device_config_ctor(&me->single, desc->config, NULL, 0);
+        me->configs = &me->single;
+        me->nconfigs = 1;
+    }
+}
+
+void cusb_device_config_ctor(struct cusb_device_config *me,
+                             const uint8_t *desc,
+                             const struct cusb_device_binding *bindings,
+                             uint8_t nbindings)
+{
+    CUSB_ASSERT_API( (me && desc && (bindings || nbindings == 0U)) );
+    CUSB_ASSERT_API( (desc[1] == DESC_CONFIGURATION && desc[5] != 0U) );
+
+    const uint8_t *end = desc + cusb_desc_total_length(desc);
+    uint32_t described = 0;
+
+    memset(me, 0, sizeof(*me));
+    me->desc = desc;
+    me->bindings = bindings;
+    me->total_length = cusb_desc_total_length(desc);
+    me->max_power_ma = (uint16_t)(desc[8] * CONFIG_POWER_UNIT_MA);
+    me->value = desc[5];
+    me->self_powered = ((desc[7] & CONFIG_SELF_POWERED) != 0U);
+    me->nbindings = nbindings;
+
+    /* First match. Alternate settings that reuse the address with another
+    interval must agree on the shortest one. */
+    for (const uint8_t *p = desc; p + 7 <= end && p[0] != 0U; p += p[0])
+    {
+        if (p[1] == DESC_ENDPOINT && CUSB_EP_NUM(p[2]) < CUSB_CFG_ENDPOINTS)
+        {
+            uint8_t bit = (uint8_t)((CUSB_EP_IS_IN(p[2]) ? 16U : 0U) + CUSB_EP_NUM(p[2]));
+
+            if ((described & ((uint32_t)1U << bit)) == 0U)
+            {
+                described |= (uint32_t)1U << bit;
+                me->binterval[CUSB_EP_IS_IN(p[2]) ? 1 : 0][CUSB_EP_NUM(p[2])] = (p[6] != 0U) ? p[6] : 1U;
+            }
+        }
+    }
+
+    for (uint8_t i = 0; i < nbindings; i++)
+    {
+        const struct cusb_device_binding *b = &bindings[i];
+        uint32_t bit = (uint32_t)1U << ((CUSB_EP_IS_IN(b->ep) ? 16U : 0U) + CUSB_EP_NUM(b->ep));
+
+        CUSB_ASSERT_API( (CUSB_EP_NUM(b->ep) != 0U && CUSB_EP_NUM(b->ep) < CUSB_CFG_ENDPOINTS) );
+        CUSB_ASSERT_API( (b->type != CUSB_EP_CONTROL && (described & bit) != 0U) );
+#if (CUSB_CFG_COALESCE)
+        CUSB_ASSERT_API( ((b->done != NULL) != (b->coalesce != NULL)) );
+#else
+        CUSB_ASSERT_API( (b->done && !b->coalesce) );
+#endif
+        for (uint8_t k = 0; k < i; k++)
+        {
+            CUSB_ASSERT_API( (bindings[k].ep != b->ep) );
+        }
+    }
+}
+
+void cusb_device_set_configs(struct cusb_device *me, const struct cusb_device_config *configs, uint8_t nconfigs)
+{
+    CUSB_ASSERT_API( (me && configs && nconfigs > 0U) );
+    CUSB_ASSERT_API( (me->state == CUSB_DEVICE_DETACHED && !me->active) );
+
+    for (uint8_t i = 0; i < nconfigs; i++)
+    {
+        CUSB_ASSERT_API( (configs[i].desc && configs[i].value != 0U) );
+
+        for (uint8_t k = 0; k < i; k++)
+        {
+            CUSB_ASSERT_API( (configs[k].value != configs[i].value) );
+        }
+    }
+
+    me->configs = configs;
+    me->nconfigs = nconfigs;
+}
+
+void cusb_device_start(struct cusb_device *me, bool polled)
+{
+    CUSB_ASSERT_API( (me && me->nconfigs > 0U) );
+    me->polled = polled;
+    (*me->dcd->api->irq_enable)(me->dcd->ctx, !polled);
+    (*me->dcd->api->connect)(me->dcd->ctx, true);
+}
+
+void cusb_device_stop(struct cusb_device *me)
+{
+    CUSB_ASSERT_API( (me) );
+    (*me->dcd->api->connect)(me->dcd->ctx, false);
+    (*me->dcd->api->irq_enable)(me->dcd->ctx, false);
+    me->state = CUSB_DEVICE_DETACHED;
+}
+
+size_t cusb_poll(struct cusb_device *me, size_t budget)
+{
+    CUSB_ASSERT_PACKET( (me && me->polled && budget > 0U) );
+
+    LOAD_ENTER(me, CUSB_LOAD_DEFERRED);
+    size_t n = (*me->dcd->api->service)(me->dcd->ctx, budget);
+    flush_coalescers(me);
+    me->backlog = (n == budget);
+    LOAD_EXIT(me);
+
+#if (CUSB_CFG_STATS)
+    me->stats.polls++;
+    me->stats.events += (uint32_t)n;
+    me->stats.polls_exhausted += (n == budget) ? 1U : 0U;
+#endif
+    return n;
+}
+
+void cusb_isr(struct cusb_device *me)
+{
+    CUSB_ASSERT_PACKET( (me && !me->polled) );
+
+    LOAD_ENTER(me, CUSB_LOAD_ISR);
+    size_t n = (*me->dcd->api->service)(me->dcd->ctx, SIZE_MAX);
+    flush_coalescers(me);
+    LOAD_EXIT(me);
+
+#if (CUSB_CFG_STATS)
+    me->stats.interrupts++;
+    me->stats.events += (uint32_t)n;
+#else
+    (void)n;
+#endif
+}
+
+void cusb_device_ep_open(struct cusb_device *me,
+                         uint8_t ep,
+                         uint8_t type,
+                         uint16_t mps,
+                         void (*done)(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok),
+                         void *obj)
+{
+    CUSB_ASSERT_API( (me && done) );
+    CUSB_ASSERT_API( (CUSB_EP_NUM(ep) != 0U && type != CUSB_EP_CONTROL) );
+
+    struct cusb_device_ep *e = endpoint(me, ep);
+    CUSB_ASSERT_INTERNAL( (!e->open) );
+
+    e->own.ep = ep;
+    e->own.type = type;
+    e->own.mps = mps;
+    e->own.done = done;
+    e->own.obj = obj;
+    e->own.coalesce = NULL;
+    open_endpoint(me, &e->own);
+}
+
+#if (CUSB_CFG_COALESCE)
+void cusb_device_ep_open_coalesced(struct cusb_device *me,
+                                   uint8_t ep,
+                                   uint8_t type,
+                                   uint16_t mps,
+                                   struct cusb_coalesce *coalesce)
+{
+    CUSB_ASSERT_API( (me && coalesce) );
+    CUSB_ASSERT_API( (CUSB_EP_NUM(ep) != 0U && type != CUSB_EP_CONTROL) );
+
+    struct cusb_device_ep *e = endpoint(me, ep);
+    CUSB_ASSERT_INTERNAL( (!e->open) );
+
+    e->own.ep = ep;
+    e->own.type = type;
+    e->own.mps = mps;
+    e->own.done = NULL;
+    e->own.obj = NULL;
+    e->own.coalesce = coalesce;
+    open_endpoint(me, &e->own);
+}
+#endif
+
+void cusb_device_ep_close(struct cusb_device *me, uint8_t ep)
+{
+    CUSB_ASSERT_API( (me && CUSB_EP_NUM(ep) != 0U) );
+
+    struct cusb_device_ep *e = endpoint(me, ep);
+    CUSB_ASSERT_INTERNAL( (e->open) );
+
+#if (CUSB_CFG_COALESCE)
+    if ((me->coalesce_dirty & coalesce_bit(ep)) != 0U)
+    {
+        /* Deliver what was posted this pass while the binding still
+        points at the coalescer. */
+        me->coalesce_dirty &= ~coalesce_bit(ep);
+        LOAD_ENTER(me, CUSB_LOAD_CALLBACK);
+        cusb_coalesce_flush(e->binding->coalesce);
+        LOAD_EXIT(me);
+    }
+#endif
+
+    e->open = false;
+    e->busy = false;
+    e->stalled = false;
+    (*me->dcd->api->ep_close)(me->dcd->ctx, ep);
+}
+
+bool cusb_device_ep_xfer(struct cusb_device *me, uint8_t ep, uint8_t *buf, uint32_t len)
+{
+    CUSB_ASSERT_PACKET( (me && CUSB_EP_NUM(ep) != 0U) );
+    CUSB_ASSERT_PACKET( (buf || len == 0U) );
+
+    struct cusb_device_ep *e = endpoint(me, ep);
+    CUSB_ASSERT_PACKET( (e->open) );
+
+    if (e->busy)
+    {
+        return false;
+    }
+
+#if (CUSB_CFG_DMA)
+    dma_start(me, ep, buf, len);
+#endif
+    e->buf = buf;
+    e->busy = true;
+    (*me->dcd->api->ep_xfer)(me->dcd->ctx, ep, buf, len);
+    return true;
+}
+
+void cusb_device_ep_stall(struct cusb_device *me, uint8_t ep, bool stall)
+{
+    CUSB_ASSERT_API( (me && CUSB_EP_NUM(ep) != 0U) );
+
+    struct cusb_device_ep *e = endpoint(me, ep);
+    CUSB_ASSERT_INTERNAL( (e->open) );
+
+    e->stalled = stall;
+    (*me->dcd->api->ep_stall)(me->dcd->ctx, ep, stall);
+}
+
+bool cusb_device_ep_busy(const struct cusb_device *me, uint8_t ep)
+{
+    CUSB_ASSERT_API( (me && CUSB_EP_NUM(ep) < CUSB_CFG_ENDPOINTS) );
+    return me->ep[CUSB_EP_IS_IN(ep) ? 1 : 0][CUSB_EP_NUM(ep)].busy;
+}
+
+uint8_t cusb_device_get_state(const struct cusb_device *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->state;
+}
+
+uint8_t cusb_device_get_config(const struct cusb_device *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->active ? me->active->value : 0U;
+}
+
+uint16_t cusb_device_get_max_power(const struct cusb_device *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->active ? me->active->max_power_ma : 0U;
+}
+
+#if (CUSB_CFG_STATS)
+const struct cusb_device_stats *cusb_device_get_stats(const struct cusb_device *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+#endif
+
+#if (CUSB_CFG_DMA)
+void cusb_device_set_cache(struct cusb_device *me, const struct cusb_device_cache *cache, void *obj)
+{
+    CUSB_ASSERT_API( (me) );
+    CUSB_ASSERT_API( (!cache || (cache->clean && cache->invalidate)) );
+    CUSB_ASSERT_API( (!cache || (cache->line > 0U && (cache->line & (cache->line - 1U)) == 0U)) );
+    me->cache = cache;
+    me->cache_obj = obj;
+}
+#endif
+
+#if (CUSB_CFG_LOAD)
+void cusb_device_set_load(struct cusb_device *me, struct cusb_load *load)
+{
+    CUSB_ASSERT_API( (me) );
+    me->load = load;
+}
+#endif
+
+void cusb_timer_ctor(struct cusb_timer *me, void (*callback)(void *obj), void *obj)
+{
+    CUSB_ASSERT_API( (me && callback) );
+
+    me->next = NULL;
+    me->expiry = 0;
+    me->callback = callback;
+    me->obj = obj;
+    me->armed = false;
+}
+
+void cusb_device_timer_start(struct cusb_device *me, struct cusb_timer *timer, uint32_t now, uint32_t delay)
+{
+    CUSB_ASSERT_API( (me && timer && timer->callback) );
+    CUSB_ASSERT_API( (delay < 0x80000000UL) );
+
+    cusb_device_timer_stop(me, timer);
+    timer->expiry = now + delay;
+
+    /* Sorted by expiry. Comparing signed differences keeps overdue timers
+    ahead and makes wrap-around of the clock harmless as long as every
+    delay is under half its range. */
+    struct cusb_timer **link = &me->timers;
+
+    while (*link && (int32_t)((*link)->expiry - timer->expiry) <= 0)
+    {
+        link = &(*link)->next;
+    }
+
+    timer->next = *link;
+    timer->armed = true;
+    *link = timer;
+}
+
+void cusb_device_timer_stop(struct cusb_device *me, struct cusb_timer *timer)
+{
+    CUSB_ASSERT_API( (me && timer) );
+
+    for (struct cusb_timer **link = &me->timers; timer->armed && *link; link = &(*link)->next)
+    {
+        if (*link == timer)
+        {
+            *link = timer->next;
+            timer->next = NULL;
+            timer->armed = false;
+        }
+    }
+}
+
+void cusb_device_run_timers(struct cusb_device *me, uint32_t now)
+{
+    CUSB_ASSERT_PACKET( (me) );
+
+    if (!me->timers || (int32_t)(now - me->timers->expiry) < 0)
+    {
+        return;
+    }
+
+    LOAD_ENTER(me, CUSB_LOAD_DEFERRED);
+
+    while (me->timers && (int32_t)(now - me->timers->expiry) >= 0)
+    {
+        struct cusb_timer *timer = me->timers;
+
+        me->timers = timer->next;
+        timer->next = NULL;
+        timer->armed = false;
+        LOAD_ENTER(me, CUSB_LOAD_CALLBACK);
+        (*timer->callback)(timer->obj);
+        LOAD_EXIT(me);
+    }
+
+    LOAD_EXIT(me);
+}
+
+uint32_t cusb_device_next_deadline(const struct cusb_device *me, uint32_t now)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    uint32_t wait = CUSB_DEADLINE_NONE;
+
+    if (me->timers)
+    {
+        int32_t left = (int32_t)(me->timers->expiry - now);
+        wait = (left > 0) ? (uint32_t)left : 0U;
+    }
+
+    if (!me->polled || wait == 0U)
+    {
+        return wait;
+    }
+
+    if (me->backlog)
+    {
+        return 0;
+    }
+
+    if (me->suspended || me->state < CUSB_DEVICE_DEFAULT)
+    {
+        return wait;
+    }
+
+    if (me->callbacks->sof)
+    {
+        uint32_t frame = (me->speed == CUSB_SPEED_HIGH) ? MICROFRAME_US : FRAME_US;
+        wait = (frame < wait) ? frame : wait;
+    }
+
+    for (uint8_t dir = 0; dir < 2U; dir++)
+    {
+        for (uint8_t num = 1; num < CUSB_CFG_ENDPOINTS; num++)
+        {
+            const struct cusb_device_ep *e = &me->ep[dir][num];
+
+            if (e->busy && e->interval_us != 0U && e->interval_us < wait)
+            {
+                wait = e->interval_us;
+            }
+        }
+    }
+
+    return wait;
+}
@@ -0,0 +1,264 @@
+/**
+ * @file
+ * @brief See @ref diskimage.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/* mmap(), msync() and clock_gettime() are POSIX, not C99. */
+#define _POSIX_C_SOURCE 200809L
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/diskimage.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* POSIX. */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_MSC)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/diskimage.c")
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static uint64_t now_ns(void);
+
+/**
+ * @brief Moves the data of @p req, if it is not already in place, and
+ * syncs the written range for @ref CUSB_BLOCKDEV_SYNC.
+ */
+static bool execute(struct cusb_diskimage *me, struct cusb_blockdev_req *req);
+
+/**
+ * @brief Adds @p count blocks starting at @p lba to the range the next
+ * @ref CUSB_BLOCKDEV_SYNC syncs.
+ */
+static void mark_dirty(struct cusb_diskimage *me, uint32_t lba, uint32_t count);
+
+static void on_submit(void *ctx, struct cusb_blockdev_req *req);
+static uint8_t *on_map(void *ctx, uint32_t lba, uint32_t count, bool writing);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const struct cusb_blockdev_api API = {&on_submit, &on_map};
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+static bool execute(struct cusb_diskimage *me, struct cusb_blockdev_req *req)
+{
+    uint32_t block_size = me->dev.block_size;
+    uint8_t *media = &me->base[(size_t)req->lba * block_size];
+    size_t len = (size_t)req->count * block_size;
+
+    if (req->op == CUSB_BLOCKDEV_READ)
+    {
+        if (req->buf != media)
+        {
+            memcpy(req->buf, media, len);
+        }
+        return true;
+    }
+
+    if (req->op == CUSB_BLOCKDEV_WRITE)
+    {
+        if (req->buf != media)
+        {
+            memcpy(media, req->buf, len);
+        }
+
+        mark_dirty(me, req->lba, req->count);
+        return true;
+    }
+
+    if (me->dirty_first == me->dirty_end)
+    {
+        return true;
+    }
+
+    /* msync() wants a page aligned start. */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = ((size_t)me->dirty_first * block_size) & ~(page - 1U);
+    size_t end = (size_t)me->dirty_end * block_size;
+
+    me->dirty_first = 0;
+    me->dirty_end = 0;
+    return msync(&me->base[start], end - start, MS_SYNC) == 0;
+}
+
+static void mark_dirty(struct cusb_diskimage *me, uint32_t lba, uint32_t count)
+{
+    if (me->dirty_first == me->dirty_end)
+    {
+        me->dirty_first = lba;
+        me->dirty_end = lba + count;
+    }
+    else
+    {
+        me->dirty_first = (lba < me->dirty_first) ? lba : me->dirty_first;
+        me->dirty_end = ((lba + count) > me->dirty_end) ? (lba + count) : me->dirty_end;
+    }
+}
+
+static void on_submit(void *ctx, struct cusb_blockdev_req *req)
+{
+    struct cusb_diskimage *me = (struct cusb_diskimage *)ctx;
+
+    if (me->latency_ns == 0U)
+    {
+        cusb_blockdev_complete(req, execute(me, req));
+        return;
+    }
+
+    CUSB_ASSERT_PACKET( (me->count < CUSB_DISKIMAGE_QUEUE_MAX) );
+
+    uint8_t tail = (uint8_t)((me->head + me->count) % CUSB_DISKIMAGE_QUEUE_MAX);
+    me->queue[tail].req = req;
+    me->queue[tail].due = now_ns() + me->latency_ns;
+    me->count++;
+}
+
+static uint8_t *on_map(void *ctx, uint32_t lba, uint32_t count, bool writing)
+{
+    struct cusb_diskimage *me = (struct cusb_diskimage *)ctx;
+
+    /* Host data lands in the mapping during the data phase. A WRITE that is
+     * aborted or cut short still changed the media, so sync it regardless. */
+    if (writing)
+    {
+        mark_dirty(me, lba, count);
+    }
+
+    return &me->base[(size_t)lba * me->dev.block_size];
+}
+
+/*------------------------------------------------------------*/
+/*------------------- DISKIMAGE MEMBER FUNCTIONS -------------*/
+/*------------------------------------------------------------*/
+
+bool cusb_diskimage_open(struct cusb_diskimage *me, const char *path,
+                         uint32_t block_size, bool read_only)
+{
+    CUSB_ASSERT_API( (me && path) );
+    CUSB_ASSERT_API( (block_size != 0U) );
+
+    void *base;
+    off_t size;
+    int fd = open(path, read_only ? O_RDONLY : O_RDWR);
+
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    /* Not fstat(), struct stat alone blows the stack budget. */
+    size = lseek(fd, 0, SEEK_END);
+
+    if (size <= 0 || ((uint64_t)size % block_size) != 0U || ((uint64_t)size / block_size) > UINT32_MAX)
+    {
+        close(fd);
+        return false;
+    }
+
+    base = mmap(NULL, (size_t)size, read_only ? PROT_READ : (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+
+    if (base == MAP_FAILED)
+    {
+        close(fd);
+        return false;
+    }
+
+    memset(me, 0, sizeof(*me));
+    me->fd = fd;
+    me->base = (uint8_t *)base;
+    me->size = (size_t)size;
+    cusb_blockdev_ctor(&me->dev, &API, me, block_size, (uint32_t)((uint64_t)size / block_size));
+    cusb_blockdev_set_write_protect(&me->dev, read_only);
+    return true;
+}
+
+void cusb_diskimage_close(struct cusb_diskimage *me)
+{
+    CUSB_ASSERT_API( (me && me->base) );
+    CUSB_ASSERT_INTERNAL( (me->count == 0U) );
+
+    msync(me->base, me->size, MS_SYNC);
+    munmap(me->base, me->size);
+    close(me->fd);
+    me->base = NULL;
+    me->fd = -1;
+}
+
+struct cusb_blockdev *cusb_diskimage_blockdev(struct cusb_diskimage *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->dev;
+}
+
+void cusb_diskimage_set_latency(struct cusb_diskimage *me, uint32_t latency_us)
+{
+    CUSB_ASSERT_API( (me) );
+    CUSB_ASSERT_INTERNAL( (me->count == 0U) );
+    me->latency_ns = (uint64_t)latency_us * 1000U;
+}
+
+size_t cusb_diskimage_poll(struct cusb_diskimage *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+
+    uint64_t now = now_ns();
+    size_t done = 0;
+
+    /* Constant latency, so requests fall due in submission order. Requests
+     * submitted from a completion are due later and wait for the next poll. */
+    while (me->count != 0U && me->queue[me->head].due <= now)
+    {
+        struct cusb_blockdev_req *req = me->queue[me->head].req;
+
+        me->head = (uint8_t)((me->head + 1U) % CUSB_DISKIMAGE_QUEUE_MAX);
+        me->count--;
+        cusb_blockdev_complete(req, execute(me, req));
+        done++;
+    }
+
+    return done;
+}
+
+size_t cusb_diskimage_pending(const struct cusb_diskimage *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->count;
+}
+
+#endif /* CUSB_CFG_MSC */
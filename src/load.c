@@ -0,0 +1,302 @@
+/**
+ * @file
+ * @brief See @ref load.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/* clock_gettime() for the Linux tick source. */
+#define _POSIX_C_SOURCE 200809L
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/load.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_LOAD)
+
+#if (CUSB_LOAD_HAS_CYCLES) && defined(__linux__)
+/* Linux. */
+#include <time.h>
+#endif
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/load.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#if (CUSB_LOAD_HAS_CYCLES) && !defined(__linux__)
+/**
+ * @name Cortex-M Debug Registers
+ */
+/**@{*/
+#define DWT_CTRL                (*(volatile uint32_t *)0xE0001000UL)
+#define DWT_CYCCNT              (*(volatile uint32_t *)0xE0001004UL)
+#define DWT_LAR                 (*(volatile uint32_t *)0xE0001FB0UL)   /* Cortex-M7 only, ignored elsewhere. */
+#define DWT_CTRL_CYCCNTENA      (1UL << 0)
+#define DWT_LAR_UNLOCK          (0xC5ACCE55UL)
+#define DEMCR                   (*(volatile uint32_t *)0xE000EDFCUL)
+#define DEMCR_TRCENA            (1UL << 24)
+/**@}*/
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Charges the time since the level's mark to its innermost
+ * context, if any, and moves the mark to now. Returns now.
+ */
+static uint32_t charge(struct cusb_load *me, struct cusb_load_level *level);
+
+/**
+ * @brief @p ticks out of @p elapsed in hundredths of a percent, at most
+ * @ref CUSB_LOAD_FULL.
+ */
+static uint16_t share(uint32_t ticks, uint32_t elapsed);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static uint32_t charge(struct cusb_load *me, struct cusb_load_level *level)
+{
+    uint32_t now;
+    uint32_t elapsed;
+
+    if (level == &me->irq)
+    {
+        now = (*me->now)();
+        elapsed = now - level->mark;
+
+        /* Thread side never runs while this does, so it sees the sum
+        only in between interrupts. */
+        me->irq_ticks += (level->depth != 0U) ? elapsed : 0U;
+    }
+    else
+    {
+        uint32_t irq;
+
+        /* Interrupt time inside the interval is not ours. Reread if an
+        interrupt ended between the two reads, so both belong to the
+        same point in time. */
+        do
+        {
+            irq = me->irq_ticks;
+            now = (*me->now)();
+        } while (irq != me->irq_ticks);
+
+        elapsed = (now - level->mark) - (irq - me->irq_seen);
+        me->irq_seen = irq;
+    }
+
+    if (level->depth != 0U)
+    {
+        level->busy[level->stack[level->depth - 1U]] += elapsed;
+    }
+
+    level->mark = now;
+    return now;
+}
+
+static uint16_t share(uint32_t ticks, uint32_t elapsed)
+{
+    uint64_t value = ((uint64_t)ticks * CUSB_LOAD_FULL) / elapsed;
+    return (uint16_t)((value > CUSB_LOAD_FULL) ? CUSB_LOAD_FULL : value);
+}
+
+/*------------------------------------------------------------*/
+/*--------------------- LOAD MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_load_ctor(struct cusb_load *me, uint32_t (*now)(void), uint32_t window)
+{
+#if (CUSB_LOAD_HAS_CYCLES)
+    now = now ? now : &cusb_load_cycles;
+#endif
+    CUSB_ASSERT_API( (me && now) );
+    CUSB_ASSERT_API( (window > 0U && window < 0x80000000UL) );
+
+    uint32_t start = (*now)();
+
+    me->now = now;
+    me->window = window;
+    me->irq_ticks = 0;
+    me->irq_seen = 0;
+    me->in_irq = false;
+    me->start = start;
+    me->head = 0;
+    me->count = 0;
+    me->thread.mark = start;
+    me->thread.depth = 0;
+    me->irq.mark = start;
+    me->irq.depth = 0;
+
+    for (uint8_t c = 0; c < CUSB_LOAD_CONTEXTS; c++)
+    {
+        me->thread.busy[c] = 0;
+        me->irq.busy[c] = 0;
+        me->base[c] = 0;
+    }
+
+    for (uint8_t c = 0; c <= CUSB_LOAD_CONTEXTS; c++)
+    {
+        me->report.last[c] = 0;
+        me->report.average[c] = 0;
+        me->report.peak[c] = 0;
+    }
+
+    me->report.windows = 0;
+}
+
+void cusb_load_enter(struct cusb_load *me, uint8_t context)
+{
+    CUSB_ASSERT_PACKET( (me && context < CUSB_LOAD_CONTEXTS) );
+    struct cusb_load_level *level;
+
+    if (context == CUSB_LOAD_ISR)
+    {
+        /* Interrupt level starts here. Whatever it preempted keeps its
+        own mark and is not charged for this. */
+        CUSB_ASSERT_PACKET( (!me->in_irq) );
+        me->in_irq = true;
+        level = &me->irq;
+        level->mark = (*me->now)();
+    }
+    else
+    {
+        level = me->in_irq ? &me->irq : &me->thread;
+        (void)charge(me, level);
+    }
+
+    CUSB_ASSERT_PACKET( (level->depth < CUSB_LOAD_DEPTH) );
+    level->stack[level->depth++] = context;
+}
+
+void cusb_load_exit(struct cusb_load *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    struct cusb_load_level *level = me->in_irq ? &me->irq : &me->thread;
+    CUSB_ASSERT_PACKET( (level->depth > 0U) );
+
+    (void)charge(me, level);
+    level->depth--;
+
+    if (level == &me->irq && level->depth == 0U)
+    {
+        me->in_irq = false;
+    }
+}
+
+bool cusb_load_update(struct cusb_load *me)
+{
+    CUSB_ASSERT_API( (me && !me->in_irq) );
+
+    uint32_t now = charge(me, &me->thread);
+    uint32_t elapsed = now - me->start;
+    uint32_t sum = 0;
+
+    if (elapsed < me->window)
+    {
+        return false;
+    }
+
+    uint16_t *slot = me->history[me->head];
+    struct cusb_load_report *report = &me->report;
+
+    for (uint8_t c = 0; c < CUSB_LOAD_CONTEXTS; c++)
+    {
+        uint32_t total = me->thread.busy[c] + me->irq.busy[c];
+        uint32_t ticks = total - me->base[c];
+
+        me->base[c] = total;
+        sum += ticks;
+        slot[c] = share(ticks, elapsed);
+    }
+
+    slot[CUSB_LOAD_TOTAL] = share(sum, elapsed);
+    me->head = (uint8_t)((me->head + 1U) % CUSB_CFG_LOAD_HISTORY);
+    me->count = (me->count < CUSB_CFG_LOAD_HISTORY) ? (uint8_t)(me->count + 1U) : me->count;
+    me->start = now;
+
+    for (uint8_t c = 0; c <= CUSB_LOAD_CONTEXTS; c++)
+    {
+        uint32_t total = 0;
+
+        for (uint8_t i = 0; i < me->count; i++)
+        {
+            total += me->history[i][c];
+        }
+
+        report->last[c] = slot[c];
+        report->average[c] = (uint16_t)(total / me->count);
+        report->peak[c] = (slot[c] > report->peak[c]) ? slot[c] : report->peak[c];
+    }
+
+    report->windows++;
+    return true;
+}
+
+const struct cusb_load_report *cusb_load_get_report(const struct cusb_load *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->report;
+}
+
+void cusb_load_clear_peak(struct cusb_load *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    for (uint8_t c = 0; c <= CUSB_LOAD_CONTEXTS; c++)
+    {
+        me->report.peak[c] = me->report.last[c];
+    }
+}
+
+#if (CUSB_LOAD_HAS_CYCLES)
+#if defined(__linux__)
+void cusb_load_cycles_init(void)
+{
+}
+
+uint32_t cusb_load_cycles(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+}
+#else
+void cusb_load_cycles_init(void)
+{
+    DEMCR |= DEMCR_TRCENA;
+    DWT_LAR = DWT_LAR_UNLOCK;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+}
+
+uint32_t cusb_load_cycles(void)
+{
+    return DWT_CYCCNT;
+}
+#endif
+#endif /* CUSB_LOAD_HAS_CYCLES */
+
+#endif /* CUSB_CFG_LOAD */
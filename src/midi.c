@@ -0,0 +1,819 @@
+/**
+ * @file
+ * @brief See @ref midi.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/midi.h"
+
+/* Endian accessors. */
+#include "cusb/endian.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_MIDI)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/midi.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Most bytes of packed events one stream byte produces: a 1.0
+ * event packet, or a 64-bit SysEx7 UMP in @ref CUSB_MIDI_2_0 mode.
+ */
+#define PACKED_MAX(mode)                ((mode) == CUSB_MIDI_1_0 ? 4U : 8U)
+
+/**
+ * @name Code Index Numbers
+ */
+/**@{*/
+#define CIN_SYSCOMMON_2                 (0x2U)
+#define CIN_SYSCOMMON_3                 (0x3U)
+#define CIN_SYSEX                       (0x4U)
+#define CIN_SYSEX_END_1                 (0x5U)  /**< Also 1 byte system common. */
+#define CIN_SINGLE_BYTE                 (0xFU)
+/**@}*/
+
+/**
+ * @name UMP Message Types
+ */
+/**@{*/
+#define MT_SYSTEM                       (0x1U)
+#define MT_CHANNEL_VOICE_1              (0x2U)
+#define MT_SYSEX7                       (0x3U)
+/**@}*/
+
+/**
+ * @name SysEx7 Status
+ */
+/**@{*/
+#define SYSEX7_COMPLETE                 (0x0U)
+#define SYSEX7_START                    (0x1U)
+#define SYSEX7_CONTINUE                 (0x2U)
+#define SYSEX7_END                      (0x3U)
+/**@}*/
+
+/**
+ * @brief SysEx bytes one event packet or SysEx7 UMP carries.
+ */
+#define SYSEX_CHUNK(mode)               ((mode) == CUSB_MIDI_1_0 ? 3U : 6U)
+
+/**
+ * @brief Bytes @ref cusb_midi_bulk_out() hands the application at once.
+ */
+#define RX_BATCH                        (48U)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Returns bytes of packed events waiting.
+ */
+static uint32_t used(const struct cusb_midi *me);
+
+/**
+ * @brief Returns true if a Bulk-IN transfer can start now.
+ */
+static bool can_send(const struct cusb_midi *me);
+
+/**
+ * @brief Queues @p n words of one event. Returns bytes they take. Only
+ * counts them if @p emit is false.
+ */
+static uint32_t put(struct cusb_midi *me, const uint32_t *words, uint32_t n, bool emit);
+
+/**
+ * @brief Packs a channel voice, system common or real-time message of
+ * @p nbytes bytes.
+ */
+static uint32_t message(struct cusb_midi *me, uint8_t cable, uint8_t status, uint8_t d1, uint8_t d2, uint8_t nbytes, bool emit);
+
+/**
+ * @brief Packs the SysEx bytes of @p p as one UMP with SysEx7 status
+ * @p status.
+ */
+static uint32_t sysex7(struct cusb_midi *me, uint8_t cable, const struct cusb_midi_parser *p, uint32_t status, bool emit);
+
+/**
+ * @brief Takes a SysEx data byte.
+ */
+static uint32_t sysex_byte(struct cusb_midi *me, struct cusb_midi_parser *p, uint8_t cable, uint8_t byte, bool emit);
+
+/**
+ * @brief Ends the SysEx message of @p p, normally with an EOX if @p eox,
+ * or cut short by another status byte.
+ */
+static uint32_t sysex_end(struct cusb_midi *me, struct cusb_midi_parser *p, uint8_t cable, bool eox, bool emit);
+
+/**
+ * @brief Runs @p byte through parser @p p. Returns bytes of events it
+ * completed, packed unless @p emit is false.
+ */
+static uint32_t parse(struct cusb_midi *me, struct cusb_midi_parser *p, uint8_t cable, uint8_t byte, bool emit);
+
+/**
+ * @brief Starts the latency timer if @p was_empty, and signals the
+ * application if a transfer became possible.
+ */
+static void queued(struct cusb_midi *me, bool was_empty, bool could_send, uint32_t now);
+
+/**
+ * @brief Latency timer callback.
+ */
+static void expired(void *obj);
+
+/**
+ * @brief Fills @p buf with whole UMPs, none straddling a packet.
+ */
+static size_t fill_ump(struct cusb_midi *me, uint8_t *buf, size_t size);
+
+/**
+ * @brief Returns true if @p ump is made of whole UMPs.
+ */
+static bool whole_umps(const uint32_t *ump, size_t nwords);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief MIDI bytes in a 1.0 event packet, by Code Index Number.
+ */
+static const uint8_t CIN_BYTES[16] = {0, 0, 2, 3, 3, 1, 2, 3, 3, 3, 3, 3, 2, 2, 3, 1};
+
+/**
+ * @brief Words in a UMP, by Message Type.
+ */
+static const uint8_t UMP_WORDS[16] = {1, 1, 1, 2, 2, 4, 1, 1, 2, 2, 2, 3, 3, 4, 4, 4};
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static uint32_t used(const struct cusb_midi *me)
+{
+    return me->head - me->tail;
+}
+
+static bool can_send(const struct cusb_midi *me)
+{
+    uint32_t pending = used(me);
+    return !me->busy && pending != 0 && (me->due || pending >= me->packet_size);
+}
+
+static uint32_t put(struct cusb_midi *me, const uint32_t *words, uint32_t n, bool emit)
+{
+    if (emit)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            cusb_set_le32(&me->fifo[me->head & me->mask], words[i]);
+            me->head += 4U;
+        }
+
+#if (CUSB_CFG_STATS)
+        me->stats.events_in++;
+#endif
+    }
+
+    return 4U * n;
+}
+
+static uint32_t message(struct cusb_midi *me, uint8_t cable, uint8_t status, uint8_t d1, uint8_t d2, uint8_t nbytes, bool emit)
+{
+    uint32_t word;
+
+    if (me->mode == CUSB_MIDI_1_0)
+    {
+        uint32_t cin;
+
+        if (status >= 0xF8U)
+        {
+            cin = CIN_SINGLE_BYTE;
+        }
+        else if (status < 0xF0U)
+        {
+            cin = (uint32_t)status >> 4;
+        }
+        else
+        {
+            cin = (nbytes == 1U) ? CIN_SYSEX_END_1 : (nbytes == 2U) ? CIN_SYSCOMMON_2 : CIN_SYSCOMMON_3;
+        }
+
+        word = ((uint32_t)cable << 4) | cin | ((uint32_t)status << 8) | ((uint32_t)d1 << 16) | ((uint32_t)d2 << 24);
+    }
+    else
+    {
+        uint32_t mt = (status < 0xF0U) ? MT_CHANNEL_VOICE_1 : MT_SYSTEM;
+        word = (mt << 28) | ((uint32_t)cable << 24) | ((uint32_t)status << 16) | ((uint32_t)d1 << 8) | d2;
+    }
+
+    return put(me, &word, 1U, emit);
+}
+
+static uint32_t sysex7(struct cusb_midi *me, uint8_t cable, const struct cusb_midi_parser *p, uint32_t status, bool emit)
+{
+    uint8_t b[6] = {0, 0, 0, 0, 0, 0};
+    memcpy(b, p->sysex, p->nsysex);
+
+    uint32_t words[2] =
+    {
+        ((uint32_t)MT_SYSEX7 << 28) | ((uint32_t)cable << 24) | (status << 20) | ((uint32_t)p->nsysex << 16) |
+            ((uint32_t)b[0] << 8) | b[1],
+        ((uint32_t)b[2] << 24) | ((uint32_t)b[3] << 16) | ((uint32_t)b[4] << 8) | b[5]
+    };
+
+    return put(me, words, 2U, emit);
+}
+
+static uint32_t sysex_byte(struct cusb_midi *me, struct cusb_midi_parser *p, uint8_t cable, uint8_t byte, bool emit)
+{
+    uint32_t bytes = 0;
+
+    if (me->mode == CUSB_MIDI_1_0)
+    {
+        p->sysex[p->nsysex++] = byte;
+
+        if (p->nsysex == SYSEX_CHUNK(CUSB_MIDI_1_0))
+        {
+            uint32_t word = ((uint32_t)cable << 4) | CIN_SYSEX | ((uint32_t)p->sysex[0] << 8) |
+                            ((uint32_t)p->sysex[1] << 16) | ((uint32_t)p->sysex[2] << 24);
+            bytes = put(me, &word, 1U, emit);
+            p->nsysex = 0;
+        }
+    }
+    else
+    {
+        /* Held back until the next byte shows whether the message goes
+        on, so the last UMP can say it ends the message. */
+        if (p->nsysex == SYSEX_CHUNK(CUSB_MIDI_2_0))
+        {
+            bytes = sysex7(me, cable, p, p->sysex_started ? SYSEX7_CONTINUE : SYSEX7_START, emit);
+            p->sysex_started = true;
+            p->nsysex = 0;
+        }
+
+        p->sysex[p->nsysex++] = byte;
+    }
+
+    return bytes;
+}
+
+static uint32_t sysex_end(struct cusb_midi *me, struct cusb_midi_parser *p, uint8_t cable, bool eox, bool emit)
+{
+    uint32_t bytes = 0;
+
+    if (me->mode == CUSB_MIDI_1_0)
+    {
+        if (eox)
+        {
+            p->sysex[p->nsysex++] = 0xF7U;
+        }
+
+        if (p->nsysex != 0)
+        {
+            /* CIN 5, 6 or 7: SysEx ends with the following 1, 2 or 3 bytes. */
+            uint8_t b1 = (p->nsysex > 1U) ? p->sysex[1] : 0U;
+            uint8_t b2 = (p->nsysex > 2U) ? p->sysex[2] : 0U;
+            uint32_t word = ((uint32_t)cable << 4) | (CIN_SYSEX + p->nsysex) | ((uint32_t)p->sysex[0] << 8) |
+                            ((uint32_t)b1 << 16) | ((uint32_t)b2 << 24);
+            bytes = put(me, &word, 1U, emit);
+        }
+    }
+    else
+    {
+        bytes = sysex7(me, cable, p, p->sysex_started ? SYSEX7_END : SYSEX7_COMPLETE, emit);
+    }
+
+    p->in_sysex = false;
+    p->sysex_started = false;
+    p->nsysex = 0;
+    return bytes;
+}
+
+static uint32_t parse(struct cusb_midi *me, struct cusb_midi_parser *p, uint8_t cable, uint8_t byte, bool emit)
+{
+    if (byte >= 0xF8U)
+    {
+        /* Real-time, may come between the bytes of any other message. */
+        return message(me, cable, byte, 0, 0, 1U, emit);
+    }
+
+    if (byte < 0x80U)
+    {
+        if (p->in_sysex)
+        {
+            return sysex_byte(me, p, cable, byte, emit);
+        }
+
+        if (p->status == 0)
+        {
+            /* Data without status. */
+            return 0;
+        }
+
+        p->data[p->count++] = byte;
+
+        if (p->count < p->need)
+        {
+            return 0;
+        }
+
+        uint32_t bytes = message(me, cable, p->status, p->data[0], (p->need == 2U) ? p->data[1] : 0U,
+                                 (uint8_t)(p->need + 1U), emit);
+        p->count = 0;
+
+        if (p->status >= 0xF0U)
+        {
+            /* No running status for system common. */
+            p->status = 0;
+        }
+
+        return bytes;
+    }
+
+    uint32_t bytes = 0;
+
+    if (p->in_sysex)
+    {
+        bytes = sysex_end(me, p, cable, byte == 0xF7U, emit);
+
+        if (byte == 0xF7U)
+        {
+            return bytes;
+        }
+    }
+
+    p->status = 0;
+    p->count = 0;
+
+    if (byte < 0xF0U)
+    {
+        p->status = byte;
+        p->need = ((byte & 0xE0U) == 0xC0U) ? 1U : 2U;
+    }
+    else if (byte == 0xF0U)
+    {
+        p->in_sysex = true;
+
+        if (me->mode == CUSB_MIDI_1_0)
+        {
+            /* 1.0 event packets carry the SOX, SysEx7 UMPs do not. */
+            p->sysex[p->nsysex++] = byte;
+        }
+    }
+    else if (byte == 0xF1U || byte == 0xF3U)
+    {
+        p->status = byte;
+        p->need = 1U;
+    }
+    else if (byte == 0xF2U)
+    {
+        p->status = byte;
+        p->need = 2U;
+    }
+    else if (byte == 0xF6U)
+    {
+        bytes += message(me, cable, byte, 0, 0, 1U, emit);
+    }
+
+    /* 0xF4, 0xF5 and a stray 0xF7 are ignored. */
+    return bytes;
+}
+
+static void queued(struct cusb_midi *me, bool was_empty, bool could_send, uint32_t now)
+{
+    if (was_empty && used(me) != 0)
+    {
+        if (me->latency == 0)
+        {
+            me->due = true;
+        }
+        else
+        {
+            cusb_device_timer_start(me->dev, &me->timer, now, me->latency);
+        }
+    }
+
+    if (!could_send && can_send(me))
+    {
+        me->api->ready(me->ctx);
+    }
+}
+
+static void expired(void *obj)
+{
+    struct cusb_midi *me = (struct cusb_midi *)obj;
+    bool could_send = can_send(me);
+
+    me->due = true;
+
+    if (!could_send && can_send(me))
+    {
+        me->api->ready(me->ctx);
+    }
+}
+
+static size_t fill_ump(struct cusb_midi *me, uint8_t *buf, size_t size)
+{
+    size_t n = 0;
+
+    while (me->tail != me->head)
+    {
+        uint32_t word = cusb_get_le32(&me->fifo[me->tail & me->mask]);
+        size_t bytes = 4U * UMP_WORDS[word >> 28];
+        size_t room = me->packet_size - (n % me->packet_size);
+
+        if (bytes > room)
+        {
+            if (n + room + bytes > size)
+            {
+                break;
+            }
+
+            /* Pad with NOOPs so the UMP starts the next packet. */
+            memset(&buf[n], 0, room);
+            n += room;
+        }
+        else if (n + bytes > size)
+        {
+            break;
+        }
+
+        for (size_t i = 0; i < bytes; i += 4U)
+        {
+            memcpy(&buf[n + i], &me->fifo[me->tail & me->mask], 4U);
+            me->tail += 4U;
+        }
+
+        n += bytes;
+    }
+
+    return n;
+}
+
+static bool whole_umps(const uint32_t *ump, size_t nwords)
+{
+    size_t i = 0;
+
+    while (i < nwords)
+    {
+        i += UMP_WORDS[ump[i] >> 28];
+    }
+
+    return i == nwords;
+}
+
+/*------------------------------------------------------------*/
+/*-------------------- MIDI MEMBER FUNCTIONS -----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_midi_ctor(struct cusb_midi *me,
+                    const struct cusb_midi_api *api,
+                    void *ctx,
+                    uint8_t *fifo,
+                    size_t fifo_size,
+                    uint8_t ncables,
+                    uint16_t packet_size,
+                    struct cusb_device *dev,
+                    uint32_t latency)
+{
+    CUSB_ASSERT_API( (me && api && fifo) );
+    CUSB_ASSERT_API( (api->ready && api->receive) );
+    CUSB_ASSERT_API( (ncables >= 1U && ncables <= CUSB_CFG_MIDI_CABLES) );
+    CUSB_ASSERT_API( (packet_size >= 16U && (packet_size % 16U) == 0) );
+    CUSB_ASSERT_API( (packet_size <= CUSB_CFG_BULK_SIZE_MAX) );
+    CUSB_ASSERT_API( ((fifo_size & (fifo_size - 1U)) == 0 && fifo_size >= 2U * packet_size) );
+    CUSB_ASSERT_API( (fifo_size <= 0x80000000UL) );
+    CUSB_ASSERT_API( (dev || latency == 0) );
+
+    me->api = api;
+    me->ctx = ctx;
+    me->fifo = fifo;
+    me->mask = (uint32_t)(fifo_size - 1U);
+    me->dev = dev;
+    me->latency = latency;
+    me->packet_size = packet_size;
+    me->ncables = ncables;
+    me->mode = CUSB_MIDI_1_0;
+    cusb_timer_ctor(&me->timer, &expired, me);
+    cusb_midi_reset(me);
+
+#if (CUSB_CFG_STATS)
+    me->stats.events_in = 0;
+    me->stats.events_out = 0;
+    me->stats.transfers = 0;
+    me->stats.dropped = 0;
+#endif
+}
+
+bool cusb_midi_write(struct cusb_midi *me, uint8_t cable, const uint8_t *data, size_t len, uint32_t now)
+{
+    CUSB_ASSERT_PACKET( (me && (data || len == 0)) );
+    CUSB_ASSERT_PACKET( (cable < me->ncables) );
+
+    struct cusb_midi_parser *p = &me->parsers[cable];
+    uint32_t space = me->mask + 1U - used(me);
+
+    if (len > space / PACKED_MAX(me->mode))
+    {
+        /* Might not fit. Count exactly on a copy of the parser. */
+        struct cusb_midi_parser dry = *p;
+        uint32_t need = 0;
+
+        for (size_t i = 0; i < len && need <= space; i++)
+        {
+            need += parse(me, &dry, cable, data[i], false);
+        }
+
+        if (need > space)
+        {
+#if (CUSB_CFG_STATS)
+            me->stats.dropped++;
+#endif
+            CUSB_TRACE(CUSB_TRACE_MIDI_OVERFLOW, len);
+            return false;
+        }
+    }
+
+    bool was_empty = (used(me) == 0);
+    bool could_send = can_send(me);
+
+    for (size_t i = 0; i < len; i++)
+    {
+        (void)parse(me, p, cable, data[i], true);
+    }
+
+    queued(me, was_empty, could_send, now);
+    return true;
+}
+
+bool cusb_midi_write_ump(struct cusb_midi *me, const uint32_t *ump, size_t nwords, uint32_t now)
+{
+    CUSB_ASSERT_PACKET( (me && (ump || nwords == 0)) );
+    CUSB_ASSERT_PACKET( (me->mode == CUSB_MIDI_2_0) );
+    CUSB_ASSERT_PACKET( (whole_umps(ump, nwords)) );
+
+    if (nwords > (me->mask + 1U - used(me)) / 4U)
+    {
+#if (CUSB_CFG_STATS)
+        me->stats.dropped++;
+#endif
+        CUSB_TRACE(CUSB_TRACE_MIDI_OVERFLOW, 4U * nwords);
+        return false;
+    }
+
+    bool was_empty = (used(me) == 0);
+    bool could_send = can_send(me);
+
+    for (size_t i = 0; i < nwords; )
+    {
+        uint32_t n = UMP_WORDS[ump[i] >> 28];
+        (void)put(me, &ump[i], n, true);
+        i += n;
+    }
+
+    queued(me, was_empty, could_send, now);
+    return true;
+}
+
+void cusb_midi_flush(struct cusb_midi *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+
+    if (used(me) != 0 && !me->due)
+    {
+        bool could_send = can_send(me);
+
+        me->due = true;
+
+        if (me->dev)
+        {
+            cusb_device_timer_stop(me->dev, &me->timer);
+        }
+
+        if (!could_send && can_send(me))
+        {
+            me->api->ready(me->ctx);
+        }
+    }
+}
+
+size_t cusb_midi_pending(const struct cusb_midi *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    return used(me);
+}
+
+#if (CUSB_CFG_STATS)
+const struct cusb_midi_stats *cusb_midi_get_stats(const struct cusb_midi *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+#endif
+
+void cusb_midi_set_mode(struct cusb_midi *me, uint8_t mode)
+{
+    CUSB_ASSERT_API( (me) );
+    CUSB_ASSERT_API( (mode == CUSB_MIDI_1_0 || mode == CUSB_MIDI_2_0) );
+
+    me->mode = mode;
+    cusb_midi_reset(me);
+}
+
+void cusb_midi_bulk_out(struct cusb_midi *me, const uint8_t *pkt, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (pkt || len == 0) );
+
+    if (me->mode == CUSB_MIDI_2_0)
+    {
+        uint32_t ump[CUSB_MIDI_UMP_WORDS_MAX];
+
+        for (size_t i = 0; i + 4U <= len; )
+        {
+            ump[0] = cusb_get_le32(&pkt[i]);
+            uint8_t n = UMP_WORDS[ump[0] >> 28];
+
+            if (i + 4U * n > len)
+            {
+                /* Truncated UMP. */
+                break;
+            }
+
+            for (uint8_t w = 1U; w < n; w++)
+            {
+                ump[w] = cusb_get_le32(&pkt[i + 4U * w]);
+            }
+
+            i += 4U * n;
+
+            if (ump[0] == 0)
+            {
+                /* NOOP padding. */
+                continue;
+            }
+
+#if (CUSB_CFG_STATS)
+            me->stats.events_out++;
+#endif
+            if (me->api->receive_ump)
+            {
+                me->api->receive_ump(me->ctx, ump, n);
+            }
+        }
+
+        return;
+    }
+
+    uint8_t batch[RX_BATCH];
+    size_t nbatch = 0;
+    uint8_t batch_cable = 0;
+
+    for (size_t i = 0; i + 4U <= len; i += 4U)
+    {
+        uint8_t cable = (uint8_t)(pkt[i] >> 4);
+        uint8_t n = CIN_BYTES[pkt[i] & 0x0FU];
+
+        if (n == 0 || cable >= me->ncables)
+        {
+            continue;
+        }
+
+        if (nbatch != 0 && (cable != batch_cable || nbatch + n > sizeof(batch)))
+        {
+            me->api->receive(me->ctx, batch_cable, batch, nbatch);
+            nbatch = 0;
+        }
+
+        memcpy(&batch[nbatch], &pkt[i + 1U], n);
+        nbatch += n;
+        batch_cable = cable;
+
+#if (CUSB_CFG_STATS)
+        me->stats.events_out++;
+#endif
+    }
+
+    if (nbatch != 0)
+    {
+        me->api->receive(me->ctx, batch_cable, batch, nbatch);
+    }
+}
+
+bool cusb_midi_bulk_in(struct cusb_midi *me, uint8_t *buf, size_t size, size_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && buf && len) );
+    CUSB_ASSERT_PACKET( (size != 0 && (size % me->packet_size) == 0) );
+
+    if (!can_send(me))
+    {
+        return false;
+    }
+
+    size_t n;
+
+    if (me->mode == CUSB_MIDI_2_0)
+    {
+        n = fill_ump(me, buf, size);
+    }
+    else
+    {
+        /* Event packets are 4 bytes and so is the FIFO's alignment, so
+        any amount up to the buffer size is whole events. */
+        n = used(me);
+        n = (n < size) ? n : size;
+
+        size_t offset = me->tail & me->mask;
+        size_t first = me->mask + 1U - offset;
+        first = (first < n) ? first : n;
+        memcpy(buf, &me->fifo[offset], first);
+        memcpy(&buf[first], me->fifo, n - first);
+        me->tail += (uint32_t)n;
+    }
+
+    if (used(me) == 0)
+    {
+        me->due = false;
+
+        if (me->dev)
+        {
+            cusb_device_timer_stop(me->dev, &me->timer);
+        }
+    }
+
+    me->busy = true;
+    *len = n;
+
+#if (CUSB_CFG_STATS)
+    me->stats.transfers++;
+#endif
+    return true;
+}
+
+void cusb_midi_in_complete(struct cusb_midi *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (me->busy) );
+
+    me->busy = false;
+
+    if (can_send(me))
+    {
+        me->api->ready(me->ctx);
+    }
+}
+
+void cusb_midi_reset(struct cusb_midi *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    me->head = 0;
+    me->tail = 0;
+    me->due = false;
+    me->busy = false;
+
+    if (me->dev)
+    {
+        cusb_device_timer_stop(me->dev, &me->timer);
+    }
+
+    for (uint8_t i = 0; i < CUSB_CFG_MIDI_CABLES; i++)
+    {
+        struct cusb_midi_parser *p = &me->parsers[i];
+        p->status = 0;
+        p->need = 0;
+        p->count = 0;
+        p->data[0] = 0;
+        p->data[1] = 0;
+        p->nsysex = 0;
+        p->in_sysex = false;
+        p->sysex_started = false;
+    }
+}
+
+#endif /* CUSB_CFG_MIDI */
@@ -0,0 +1,1129 @@
+/**
+ * @file
+ * @brief See @ref mtp.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/mtp.h"
+
+/* Endian accessors. */
+#include "cusb/endian.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_MTP)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/mtp.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Container Types
+ */
+/**@{*/
+#define CONTAINER_COMMAND               (1U)
+#define CONTAINER_DATA                  (2U)
+#define CONTAINER_RESPONSE              (3U)
+/**@}*/
+
+/**
+ * @name Operation Codes
+ */
+/**@{*/
+#define OP_GET_DEVICE_INFO              (0x1001U)
+#define OP_OPEN_SESSION                 (0x1002U)
+#define OP_CLOSE_SESSION                (0x1003U)
+#define OP_GET_STORAGE_IDS              (0x1004U)
+#define OP_GET_STORAGE_INFO             (0x1005U)
+#define OP_GET_NUM_OBJECTS              (0x1006U)
+#define OP_GET_OBJECT_HANDLES           (0x1007U)
+#define OP_GET_OBJECT_INFO              (0x1008U)
+#define OP_GET_OBJECT                   (0x1009U)
+#define OP_DELETE_OBJECT                (0x100BU)
+#define OP_SEND_OBJECT_INFO             (0x100CU)
+#define OP_SEND_OBJECT                  (0x100DU)
+#define OP_GET_PARTIAL_OBJECT           (0x101BU)
+/**@}*/
+
+/**
+ * @name Response Codes
+ */
+/**@{*/
+#define RESP_UNDECIDED                  (0x0000U)
+#define RESP_OK                         (0x2001U)
+#define RESP_GENERAL_ERROR              (0x2002U)
+#define RESP_SESSION_NOT_OPEN           (0x2003U)
+#define RESP_OPERATION_NOT_SUPPORTED    (0x2005U)
+#define RESP_PARAMETER_NOT_SUPPORTED    (0x2006U)
+#define RESP_INCOMPLETE_TRANSFER        (0x2007U)
+#define RESP_INVALID_STORAGE_ID         (0x2008U)
+#define RESP_INVALID_OBJECT_HANDLE      (0x2009U)
+#define RESP_STORE_FULL                 (0x200CU)
+#define RESP_STORE_READ_ONLY            (0x200EU)
+#define RESP_ACCESS_DENIED              (0x200FU)
+#define RESP_NO_VALID_OBJECT_INFO       (0x2015U)
+#define RESP_INVALID_PARENT_OBJECT      (0x201AU)
+#define RESP_INVALID_PARAMETER          (0x201DU)
+#define RESP_SESSION_ALREADY_OPEN       (0x201EU)
+#define RESP_INVALID_DATASET            (0x2023U)
+/**@}*/
+
+/**
+ * @brief Byte offset of the filename string in an ObjectInfo dataset.
+ */
+#define OBJECT_INFO_FILENAME_OFFSET     (52U)
+
+/**
+ * @brief Handle encoding. Lower 16 bits are table index + 1 so
+ * a handle is never 0. Upper 16 bits are the slot's generation.
+ */
+#define HANDLE(index, generation)       ((((uint32_t)(generation)) << 16) | ((uint32_t)(index) + 1UL))
+#define HANDLE_INDEX(handle)            ((uint16_t)(((handle) & 0xFFFFUL) - 1UL))
+#define HANDLE_GENERATION(handle)       ((uint16_t)((handle) >> 16))
+
+/**
+ * @brief Marks the end of the free slot list.
+ */
+#define FREE_LIST_END                   (0xFFFFU)
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Responder states.
+ */
+enum
+{
+    STATE_IDLE,
+    STATE_DATA_OUT,
+    STATE_DATA_IN,
+    STATE_RESPONSE
+};
+
+/**
+ * @brief Where data phase bytes come from or go to.
+ */
+enum
+{
+    DATA_SCRATCH,   /**< Dataset built in or parsed from scratch buffer. */
+    DATA_OBJECT,    /**< Streamed directly from or to the storage backend. */
+    DATA_HANDLES,   /**< Handle array generated from the object table. */
+    DATA_DISCARD    /**< Received data is dropped. */
+};
+
+/**
+ * @brief Operations reported in GetDeviceInfo.
+ */
+static const uint16_t SUPPORTED_OPERATIONS[] =
+{
+    OP_GET_DEVICE_INFO, OP_OPEN_SESSION, OP_CLOSE_SESSION, OP_GET_STORAGE_IDS,
+    OP_GET_STORAGE_INFO, OP_GET_NUM_OBJECTS, OP_GET_OBJECT_HANDLES, OP_GET_OBJECT_INFO,
+    OP_GET_OBJECT, OP_DELETE_OBJECT, OP_SEND_OBJECT_INFO, OP_SEND_OBJECT, OP_GET_PARTIAL_OBJECT
+};
+
+/**
+ * @brief Formats reported in GetDeviceInfo.
+ */
+static const uint16_t SUPPORTED_FORMATS[] =
+{
+    CUSB_MTP_FORMAT_UNDEFINED, CUSB_MTP_FORMAT_ASSOCIATION
+};
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Bounds-checked little endian dataset writer.
+ */
+struct writer
+{
+    uint8_t *buf;
+    size_t size;
+    size_t pos;
+    bool overflow;
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static void put8(struct writer *w, uint8_t val);
+static void put16(struct writer *w, uint16_t val);
+static void put32(struct writer *w, uint32_t val);
+static void put64(struct writer *w, uint64_t val);
+static void put_array16(struct writer *w, const uint16_t *vals, size_t count);
+static void put_string(struct writer *w, const char *str);
+
+/**
+ * @brief Returns true if the object in @p index matches the
+ * storage, format and parent filter of GetObjectHandles and
+ * GetNumObjects.
+ */
+static bool handle_filter_match(const struct cusb_mtp *me, uint16_t index);
+static uint32_t count_filtered_objects(const struct cusb_mtp *me);
+
+static void respond(struct cusb_mtp *me, uint16_t code, uint8_t nparams,
+                    uint32_t p0, uint32_t p1, uint32_t p2);
+static void start_data_in(struct cusb_mtp *me, uint8_t source, uint32_t cookie,
+                          uint32_t offset, uint32_t len);
+static void start_data_out(struct cusb_mtp *me, uint8_t sink, uint32_t cookie);
+static bool finish_dataset(struct cusb_mtp *me, struct writer *w);
+
+static void build_device_info(struct cusb_mtp *me);
+static void build_storage_info(struct cusb_mtp *me);
+static void build_object_info(struct cusb_mtp *me, const struct cusb_mtp_object *obj);
+
+static void dispatch_command(struct cusb_mtp *me);
+static void complete_send_object_info(struct cusb_mtp *me, size_t len);
+static void complete_data_out(struct cusb_mtp *me);
+static size_t produce(struct cusb_mtp *me, uint8_t *buf, size_t len);
+static void consume(struct cusb_mtp *me, const uint8_t *buf, size_t len);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void put8(struct writer *w, uint8_t val)
+{
+    if (w->pos < w->size)
+    {
+        w->buf[w->pos++] = val;
+    }
+    else
+    {
+        w->overflow = true;
+    }
+}
+
+static void put16(struct writer *w, uint16_t val)
+{
+    put8(w, (uint8_t)val);
+    put8(w, (uint8_t)(val >> 8));
+}
+
+static void put32(struct writer *w, uint32_t val)
+{
+    put16(w, (uint16_t)val);
+    put16(w, (uint16_t)(val >> 16));
+}
+
+static void put64(struct writer *w, uint64_t val)
+{
+    put32(w, (uint32_t)val);
+    put32(w, (uint32_t)(val >> 32));
+}
+
+static void put_array16(struct writer *w, const uint16_t *vals, size_t count)
+{
+    put32(w, (uint32_t)count);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        put16(w, vals[i]);
+    }
+}
+
+static void put_string(struct writer *w, const char *str)
+{
+    /* PTP string. Number of UTF-16 characters including NUL, then the characters.
+    An empty string is a single 0 byte. */
+    size_t len = (str) ? strlen(str) : 0;
+
+    if (len > 254U)
+    {
+        len = 254U;
+    }
+
+    if (len == 0)
+    {
+        put8(w, 0);
+    }
+    else
+    {
+        put8(w, (uint8_t)(len + 1U));
+
+        for (size_t i = 0; i < len; i++)
+        {
+            put16(w, (uint8_t)str[i]);
+        }
+
+        put16(w, 0);
+    }
+}
+
+static bool handle_filter_match(const struct cusb_mtp *me, uint16_t index)
+{
+    const struct cusb_mtp_object *obj = &me->objects[index];
+    uint32_t storage = me->cmd.params[0];
+    uint32_t format = me->cmd.params[1];
+    uint32_t parent = me->cmd.params[2];
+
+    /* Parent 0 means all objects, 0xFFFFFFFF means objects in the root. */
+    return ((obj->used) &&
+            (storage == 0xFFFFFFFFUL || storage == CUSB_MTP_STORAGE_ID) &&
+            (format == 0 || format == obj->format) &&
+            (parent == 0 || parent == obj->parent));
+}
+
+static uint32_t count_filtered_objects(const struct cusb_mtp *me)
+{
+    uint32_t count = 0;
+
+    for (uint16_t i = 0; i < me->object_capacity; i++)
+    {
+        if (handle_filter_match(me, i))
+        {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+static void respond(struct cusb_mtp *me, uint16_t code, uint8_t nparams,
+                    uint32_t p0, uint32_t p1, uint32_t p2)
+{
+    me->resp.code = code;
+    me->resp.nparams = nparams;
+    me->resp.params[0] = p0;
+    me->resp.params[1] = p1;
+    me->resp.params[2] = p2;
+    me->state = STATE_RESPONSE;
+}
+
+static void start_data_in(struct cusb_mtp *me, uint8_t source, uint32_t cookie,
+                          uint32_t offset, uint32_t len)
+{
+    me->data.source = source;
+    me->data.cookie = cookie;
+    me->data.offset = offset;
+    me->data.remaining = len;
+    me->data.cursor = 0;
+    me->data.header_pending = true;
+    me->data.zlp_pending = false;
+    me->state = STATE_DATA_IN;
+}
+
+static void start_data_out(struct cusb_mtp *me, uint8_t sink, uint32_t cookie)
+{
+    me->data.source = sink;
+    me->data.cookie = cookie;
+    me->data.offset = 0;
+    me->data.remaining = 0;
+    me->data.header_pending = true;
+    me->data.zlp_pending = false;
+    me->state = STATE_DATA_OUT;
+}
+
+static bool finish_dataset(struct cusb_mtp *me, struct writer *w)
+{
+    if (w->overflow)
+    {
+        respond(me, RESP_GENERAL_ERROR, 0, 0, 0, 0);
+        return false;
+    }
+
+    start_data_in(me, DATA_SCRATCH, 0, 0, (uint32_t)w->pos);
+    return true;
+}
+
+static void build_device_info(struct cusb_mtp *me)
+{
+    struct writer w = {me->scratch, me->scratch_size, 0, false};
+
+    put16(&w, 100);                     /* Standard version. */
+    put32(&w, 0x00000006UL);            /* Vendor extension ID. Microsoft = MTP. */
+    put16(&w, 100);                     /* Vendor extension version. */
+    put_string(&w, "microsoft.com: 1.0;");
+    put16(&w, 0);                       /* Functional mode. */
+    put_array16(&w, SUPPORTED_OPERATIONS, sizeof(SUPPORTED_OPERATIONS) / sizeof(SUPPORTED_OPERATIONS[0]));
+    put_array16(&w, NULL, 0);           /* Events. */
+    put_array16(&w, NULL, 0);           /* Device properties. */
+    put_array16(&w, NULL, 0);           /* Capture formats. */
+    put_array16(&w, SUPPORTED_FORMATS, sizeof(SUPPORTED_FORMATS) / sizeof(SUPPORTED_FORMATS[0]));
+    put_string(&w, me->strings->manufacturer);
+    put_string(&w, me->strings->model);
+    put_string(&w, me->strings->device_version);
+    put_string(&w, me->strings->serial_number);
+    (void)finish_dataset(me, &w);
+}
+
+static void build_storage_info(struct cusb_mtp *me)
+{
+    struct writer w = {me->scratch, me->scratch_size, 0, false};
+    uint64_t max = 0;
+    uint64_t free_bytes = 0;
+    bool read_only = (!me->store->write || !me->store->create);
+
+    (*me->store->capacity)(me->store_ctx, &max, &free_bytes);
+    put16(&w, 0x0003U);                 /* Storage type. Fixed RAM. */
+    put16(&w, 0x0002U);                 /* Filesystem type. Generic hierarchical. */
+    put16(&w, (read_only) ? 0x0001U : 0x0000U);  /* Access capability. */
+    put64(&w, max);
+    put64(&w, free_bytes);
+    put32(&w, 0xFFFFFFFFUL);            /* Free space in objects. Unused. */
+    put_string(&w, me->strings->storage_description);
+    put_string(&w, NULL);               /* Volume identifier. */
+    (void)finish_dataset(me, &w);
+}
+
+static void build_object_info(struct cusb_mtp *me, const struct cusb_mtp_object *obj)
+{
+    struct writer w = {me->scratch, me->scratch_size, 0, false};
+    bool folder = (obj->format == CUSB_MTP_FORMAT_ASSOCIATION);
+
+    me->filename[0] = '\0';
+    (*me->store->filename)(me->store_ctx, obj->cookie, me->filename, sizeof(me->filename));
+    me->filename[sizeof(me->filename) - 1U] = '\0';
+
+    put32(&w, CUSB_MTP_STORAGE_ID);
+    put16(&w, obj->format);
+    put16(&w, 0);                       /* Protection status. */
+    put32(&w, obj->size);
+    put16(&w, 0);                       /* Thumb format. */
+    put32(&w, 0);                       /* Thumb compressed size. */
+    put32(&w, 0);                       /* Thumb width. */
+    put32(&w, 0);                       /* Thumb height. */
+    put32(&w, 0);                       /* Image width. */
+    put32(&w, 0);                       /* Image height. */
+    put32(&w, 0);                       /* Image bit depth. */
+    put32(&w, (obj->parent == CUSB_MTP_ROOT_HANDLE) ? 0 : obj->parent);
+    put16(&w, (folder) ? 0x0001U : 0x0000U);    /* Association type. Generic folder. */
+    put32(&w, 0);                       /* Association description. */
+    put32(&w, 0);                       /* Sequence number. */
+    put_string(&w, me->filename);
+    put_string(&w, NULL);               /* Date created. */
+    put_string(&w, NULL);               /* Date modified. */
+    put_string(&w, NULL);               /* Keywords. */
+    (void)finish_dataset(me, &w);
+}
+
+static void dispatch_command(struct cusb_mtp *me)
+{
+    uint32_t p0 = me->cmd.params[0];
+    struct cusb_mtp_object *obj = NULL;
+    me->resp.code = RESP_UNDECIDED;
+
+    if (me->cmd.code == OP_GET_DEVICE_INFO)
+    {
+        build_device_info(me);
+        return;
+    }
+    else if (me->cmd.code == OP_OPEN_SESSION)
+    {
+        if (me->session_id != 0)
+        {
+            respond(me, RESP_SESSION_ALREADY_OPEN, 1, me->session_id, 0, 0);
+        }
+        else if (p0 == 0)
+        {
+            respond(me, RESP_INVALID_PARAMETER, 0, 0, 0, 0);
+        }
+        else
+        {
+            me->session_id = p0;
+            respond(me, RESP_OK, 0, 0, 0, 0);
+        }
+        return;
+    }
+    else if (me->session_id == 0)
+    {
+        respond(me, RESP_SESSION_NOT_OPEN, 0, 0, 0, 0);
+        return;
+    }
+
+    switch (me->cmd.code)
+    {
+        case OP_CLOSE_SESSION:
+        {
+            me->session_id = 0;
+            me->send_handle = CUSB_MTP_INVALID_HANDLE;
+            respond(me, RESP_OK, 0, 0, 0, 0);
+            break;
+        }
+
+        case OP_GET_STORAGE_IDS:
+        {
+            struct writer w = {me->scratch, me->scratch_size, 0, false};
+            put32(&w, 1);
+            put32(&w, CUSB_MTP_STORAGE_ID);
+            (void)finish_dataset(me, &w);
+            break;
+        }
+
+        case OP_GET_STORAGE_INFO:
+        {
+            if (p0 != CUSB_MTP_STORAGE_ID)
+            {
+                respond(me, RESP_INVALID_STORAGE_ID, 0, 0, 0, 0);
+            }
+            else
+            {
+                build_storage_info(me);
+            }
+            break;
+        }
+
+        case OP_GET_NUM_OBJECTS:
+        {
+            respond(me, RESP_OK, 1, count_filtered_objects(me), 0, 0);
+            break;
+        }
+
+        case OP_GET_OBJECT_HANDLES:
+        {
+            uint32_t count = count_filtered_objects(me);
+            start_data_in(me, DATA_HANDLES, count, 0, (uint32_t)(4U + (4U * count)));
+            break;
+        }
+
+        case OP_GET_OBJECT_INFO:
+        {
+            obj = cusb_mtp_object_find(me, p0);
+
+            if (!obj)
+            {
+                respond(me, RESP_INVALID_OBJECT_HANDLE, 0, 0, 0, 0);
+            }
+            else
+            {
+                build_object_info(me, obj);
+            }
+            break;
+        }
+
+        case OP_GET_OBJECT:
+        {
+            obj = cusb_mtp_object_find(me, p0);
+
+            if (!obj)
+            {
+                respond(me, RESP_INVALID_OBJECT_HANDLE, 0, 0, 0, 0);
+            }
+            else
+            {
+                start_data_in(me, DATA_OBJECT, obj->cookie, 0, obj->size);
+            }
+            break;
+        }
+
+        case OP_GET_PARTIAL_OBJECT:
+        {
+            obj = cusb_mtp_object_find(me, p0);
+
+            if (!obj)
+            {
+                respond(me, RESP_INVALID_OBJECT_HANDLE, 0, 0, 0, 0);
+            }
+            else if (me->cmd.params[1] > obj->size)
+            {
+                respond(me, RESP_INVALID_PARAMETER, 0, 0, 0, 0);
+            }
+            else
+            {
+                uint32_t len = obj->size - me->cmd.params[1];
+
+                if (len > me->cmd.params[2])
+                {
+                    len = me->cmd.params[2];
+                }
+
+                /* Response parameter is the number of bytes actually sent. */
+                me->resp.params[0] = len;
+                start_data_in(me, DATA_OBJECT, obj->cookie, me->cmd.params[1], len);
+            }
+            break;
+        }
+
+        case OP_DELETE_OBJECT:
+        {
+            obj = cusb_mtp_object_find(me, p0);
+
+            if (p0 == 0xFFFFFFFFUL)
+            {
+                respond(me, RESP_PARAMETER_NOT_SUPPORTED, 0, 0, 0, 0);
+            }
+            else if (!obj)
+            {
+                respond(me, RESP_INVALID_OBJECT_HANDLE, 0, 0, 0, 0);
+            }
+            else if (!me->store->remove)
+            {
+                respond(me, RESP_STORE_READ_ONLY, 0, 0, 0, 0);
+            }
+            else
+            {
+                /* Folders must be emptied first. Looking for children is the one O(n) walk. */
+                bool has_children = false;
+
+                for (uint16_t i = 0; i < me->object_capacity && !has_children; i++)
+                {
+                    has_children = (me->objects[i].used && me->objects[i].parent == p0);
+                }
+
+                if (has_children || !(*me->store->remove)(me->store_ctx, obj->cookie))
+                {
+                    respond(me, RESP_ACCESS_DENIED, 0, 0, 0, 0);
+                }
+                else
+                {
+                    (void)cusb_mtp_object_remove(me, p0);
+                    respond(me, RESP_OK, 0, 0, 0, 0);
+                }
+            }
+            break;
+        }
+
+        case OP_SEND_OBJECT_INFO:
+        {
+            if (!me->store->create || !me->store->write)
+            {
+                respond(me, RESP_STORE_READ_ONLY, 0, 0, 0, 0);
+            }
+            else
+            {
+                start_data_out(me, DATA_SCRATCH, 0);
+            }
+            break;
+        }
+
+        case OP_SEND_OBJECT:
+        {
+            obj = cusb_mtp_object_find(me, me->send_handle);
+
+            if (!obj)
+            {
+                respond(me, RESP_NO_VALID_OBJECT_INFO, 0, 0, 0, 0);
+            }
+            else
+            {
+                start_data_out(me, DATA_OBJECT, obj->cookie);
+            }
+            break;
+        }
+
+        default:
+        {
+            respond(me, RESP_OPERATION_NOT_SUPPORTED, 0, 0, 0, 0);
+            break;
+        }
+    }
+}
+
+static void complete_send_object_info(struct cusb_mtp *me, size_t len)
+{
+    struct cusb_mtp_object_info info;
+    uint32_t cookie = 0;
+    uint32_t handle;
+    uint32_t storage = me->cmd.params[0];
+    const uint8_t *p = me->scratch;
+
+    if (len < OBJECT_INFO_FILENAME_OFFSET + 1U)
+    {
+        respond(me, RESP_INVALID_DATASET, 0, 0, 0, 0);
+        return;
+    }
+
+    if (storage != 0 && storage != CUSB_MTP_STORAGE_ID)
+    {
+        respond(me, RESP_INVALID_STORAGE_ID, 0, 0, 0, 0);
+        return;
+    }
+
+    info.format = cusb_get_le16(&p[4]);
+    info.size = cusb_get_le32(&p[8]);
+    info.parent = (me->cmd.params[1] == 0) ? CUSB_MTP_ROOT_HANDLE : me->cmd.params[1];
+    info.filename = me->filename;
+
+    if (info.parent != CUSB_MTP_ROOT_HANDLE)
+    {
+        const struct cusb_mtp_object *parent = cusb_mtp_object_find(me, info.parent);
+
+        if (!parent || parent->format != CUSB_MTP_FORMAT_ASSOCIATION)
+        {
+            respond(me, RESP_INVALID_PARENT_OBJECT, 0, 0, 0, 0);
+            return;
+        }
+    }
+
+    /* Filename is UTF-16LE. Non-ASCII characters are replaced and overly long names truncated. */
+    size_t nchars = p[OBJECT_INFO_FILENAME_OFFSET];
+    size_t i = 0;
+
+    for (; i < nchars && i < sizeof(me->filename) - 1U; i++)
+    {
+        size_t offset = OBJECT_INFO_FILENAME_OFFSET + 1U + (2U * i);
+        uint16_t c = (offset + 1U < len) ? cusb_get_le16(&p[offset]) : 0;
+
+        if (c == 0)
+        {
+            break;
+        }
+
+        me->filename[i] = (c < 0x80U) ? (char)c : '_';
+    }
+
+    me->filename[i] = '\0';
+
+    if (!(*me->store->create)(me->store_ctx, &info, &cookie))
+    {
+        respond(me, RESP_STORE_FULL, 0, 0, 0, 0);
+        return;
+    }
+
+    handle = cusb_mtp_object_add(me, cookie, &info);
+
+    if (handle == CUSB_MTP_INVALID_HANDLE)
+    {
+        if (me->store->remove)
+        {
+            (void)(*me->store->remove)(me->store_ctx, cookie);
+        }
+
+        respond(me, RESP_STORE_FULL, 0, 0, 0, 0);
+        return;
+    }
+
+    me->send_handle = (info.format == CUSB_MTP_FORMAT_ASSOCIATION) ? CUSB_MTP_INVALID_HANDLE : handle;
+    respond(me, RESP_OK, 3, CUSB_MTP_STORAGE_ID, info.parent, handle);
+}
+
+static void complete_data_out(struct cusb_mtp *me)
+{
+    if (me->resp.code != RESP_UNDECIDED)
+    {
+        /* An error was already decided while data was being received. */
+        respond(me, me->resp.code, 0, 0, 0, 0);
+    }
+    else if (me->cmd.code == OP_SEND_OBJECT_INFO)
+    {
+        complete_send_object_info(me, me->data.offset);
+    }
+    else if (me->cmd.code == OP_SEND_OBJECT)
+    {
+        struct cusb_mtp_object *obj = cusb_mtp_object_find(me, me->send_handle);
+
+        if (obj)
+        {
+            obj->size = me->data.offset;
+        }
+
+        me->send_handle = CUSB_MTP_INVALID_HANDLE;
+        respond(me, RESP_OK, 0, 0, 0, 0);
+    }
+    else
+    {
+        respond(me, RESP_GENERAL_ERROR, 0, 0, 0, 0);
+    }
+}
+
+static size_t produce(struct cusb_mtp *me, uint8_t *buf, size_t len)
+{
+    size_t n = 0;
+
+    switch (me->data.source)
+    {
+        case DATA_SCRATCH:
+        {
+            memcpy(buf, &me->scratch[me->data.offset], len);
+            n = len;
+            break;
+        }
+
+        case DATA_OBJECT:
+        {
+            n = (*me->store->read)(me->store_ctx, me->data.cookie, me->data.offset, buf, len);
+            break;
+        }
+
+        case DATA_HANDLES:
+        {
+            /* Handles are generated straight into the packet so the list never has
+            to fit in RAM. Everything stays 4-byte aligned since the container header
+            is 12 bytes and the packet size is a multiple of 4. */
+            CUSB_ASSERT_PACKET( ((len % 4U) == 0) );
+
+            if (me->data.offset == 0 && len >= 4U)
+            {
+                cusb_set_le32(buf, me->data.cookie);
+                n = 4;
+            }
+
+            while (n < len && me->data.cursor < me->object_capacity)
+            {
+                uint16_t i = me->data.cursor++;
+
+                if (handle_filter_match(me, i))
+                {
+                    cusb_set_le32(&buf[n], HANDLE(i, me->objects[i].generation));
+                    n += 4U;
+                }
+            }
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    return n;
+}
+
+static void consume(struct cusb_mtp *me, const uint8_t *buf, size_t len)
+{
+    switch (me->data.source)
+    {
+        case DATA_SCRATCH:
+        {
+            if (me->data.offset + len <= me->scratch_size)
+            {
+                memcpy(&me->scratch[me->data.offset], buf, len);
+            }
+            else
+            {
+                /* Keep receiving so the host's transfer completes. Error is reported in the response. */
+                me->resp.code = RESP_INVALID_DATASET;
+                me->data.source = DATA_DISCARD;
+            }
+            break;
+        }
+
+        case DATA_OBJECT:
+        {
+            if (!(*me->store->write)(me->store_ctx, me->data.cookie, me->data.offset, buf, len))
+            {
+                me->resp.code = RESP_STORE_FULL;
+                me->data.source = DATA_DISCARD;
+            }
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    me->data.offset += (uint32_t)len;
+}
+
+/*------------------------------------------------------------*/
+/*---------------------- MTP MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_mtp_ctor(struct cusb_mtp *me,
+                   const struct cusb_mtp_store_api *store,
+                   void *store_ctx,
+                   const struct cusb_mtp_strings *strings,
+                   struct cusb_mtp_object *objects,
+                   uint16_t object_capacity,
+                   uint8_t *scratch,
+                   size_t scratch_size,
+                   uint16_t packet_size)
+{
+    CUSB_ASSERT_API( (me && store && strings && objects && scratch) );
+    CUSB_ASSERT_API( (store->read && store->filename && store->capacity) );
+    CUSB_ASSERT_API( (object_capacity > 0 && object_capacity < FREE_LIST_END) );
+    CUSB_ASSERT_API( (packet_size >= 32U && (packet_size % 4U) == 0) );
+    CUSB_ASSERT_API( (packet_size <= CUSB_CFG_BULK_SIZE_MAX) );
+
+    me->store = store;
+    me->store_ctx = store_ctx;
+    me->strings = strings;
+    me->objects = objects;
+    me->object_capacity = object_capacity;
+    me->packet_size = packet_size;
+    me->scratch = scratch;
+    me->scratch_size = scratch_size;
+    me->session_id = 0;
+    me->send_handle = CUSB_MTP_INVALID_HANDLE;
+    me->state = STATE_IDLE;
+    me->free_head = 0;
+
+    for (uint16_t i = 0; i < object_capacity; i++)
+    {
+        objects[i].used = false;
+        objects[i].generation = 0;
+        objects[i].next_free = (uint16_t)(i + 1U);
+    }
+
+    objects[object_capacity - 1U].next_free = FREE_LIST_END;
+}
+
+uint32_t cusb_mtp_object_add(struct cusb_mtp *me,
+                             uint32_t cookie,
+                             const struct cusb_mtp_object_info *info)
+{
+    CUSB_ASSERT_API( (me && info) );
+    uint16_t i = me->free_head;
+    struct cusb_mtp_object *obj;
+
+    if (i == FREE_LIST_END)
+    {
+        return CUSB_MTP_INVALID_HANDLE;
+    }
+
+    obj = &me->objects[i];
+    me->free_head = obj->next_free;
+    obj->cookie = cookie;
+    obj->size = info->size;
+    obj->parent = info->parent;
+    obj->format = info->format;
+    obj->used = true;
+
+    /* Generation survives while the slot is free so a stale handle never matches the
+    slot's next object. 0 and 0xFFFF are skipped so a handle is never 0 or 0xFFFFFFFF. */
+    obj->generation++;
+    if (obj->generation == 0xFFFFU)
+    {
+        obj->generation = 1;
+    }
+
+    return HANDLE(i, obj->generation);
+}
+
+bool cusb_mtp_object_remove(struct cusb_mtp *me, uint32_t handle)
+{
+    CUSB_ASSERT_API( (me) );
+    struct cusb_mtp_object *obj = cusb_mtp_object_find(me, handle);
+
+    if (!obj)
+    {
+        return false;
+    }
+
+    obj->used = false;
+    obj->next_free = me->free_head;
+    me->free_head = HANDLE_INDEX(handle);
+    return true;
+}
+
+struct cusb_mtp_object *cusb_mtp_object_find(struct cusb_mtp *me, uint32_t handle)
+{
+    CUSB_ASSERT_API( (me) );
+    uint16_t index = HANDLE_INDEX(handle);
+
+    if ((handle & 0xFFFFUL) == 0 || index >= me->object_capacity)
+    {
+        return NULL;
+    }
+
+    if (!me->objects[index].used || me->objects[index].generation != HANDLE_GENERATION(handle))
+    {
+        return NULL;
+    }
+
+    return &me->objects[index];
+}
+
+void cusb_mtp_bulk_out(struct cusb_mtp *me, const uint8_t *pkt, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (pkt || len == 0) );
+
+    if (me->state == STATE_IDLE)
+    {
+        /* Expecting a command. Zero length packets terminating a previous data phase land here too. */
+        if (len >= CUSB_MTP_CONTAINER_HEADER_SIZE && cusb_get_le16(&pkt[4]) == CONTAINER_COMMAND)
+        {
+            uint32_t container_len = cusb_get_le32(&pkt[0]);
+            size_t nparams = 0;
+
+            if (container_len > len)
+            {
+                container_len = (uint32_t)len;
+            }
+
+            /* A length below the header is malformed. Decode no parameters
+            rather than trusting it. */
+            if (container_len >= CUSB_MTP_CONTAINER_HEADER_SIZE)
+            {
+                nparams = (container_len - CUSB_MTP_CONTAINER_HEADER_SIZE) / 4U;
+            }
+
+            nparams = (nparams > 5U) ? 5U : nparams;
+            memset(me->cmd.params, 0, sizeof(me->cmd.params));
+            me->cmd.code = cusb_get_le16(&pkt[6]);
+            me->cmd.transaction_id = cusb_get_le32(&pkt[8]);
+            me->cmd.nparams = (uint8_t)nparams;
+
+            for (size_t i = 0; i < nparams; i++)
+            {
+                me->cmd.params[i] = cusb_get_le32(&pkt[CUSB_MTP_CONTAINER_HEADER_SIZE + (4U * i)]);
+            }
+
+            CUSB_TRACE(CUSB_TRACE_MTP_OPERATION, me->cmd.code);
+            dispatch_command(me);
+        }
+    }
+    else if (me->state == STATE_DATA_OUT)
+    {
+        const uint8_t *payload = pkt;
+        size_t n = len;
+
+        if (me->data.header_pending)
+        {
+            if (len < CUSB_MTP_CONTAINER_HEADER_SIZE || cusb_get_le16(&pkt[4]) != CONTAINER_DATA ||
+                cusb_get_le32(&pkt[0]) < CUSB_MTP_CONTAINER_HEADER_SIZE)
+            {
+                respond(me, RESP_INVALID_DATASET, 0, 0, 0, 0);
+                return;
+            }
+
+            me->data.header_pending = false;
+            me->data.remaining = cusb_get_le32(&pkt[0]) - CUSB_MTP_CONTAINER_HEADER_SIZE;
+            payload = &pkt[CUSB_MTP_CONTAINER_HEADER_SIZE];
+            n = len - CUSB_MTP_CONTAINER_HEADER_SIZE;
+        }
+
+        /* Payload goes straight from the packet buffer to the sink. */
+        n = (n > me->data.remaining) ? me->data.remaining : n;
+        consume(me, payload, n);
+        me->data.remaining -= (uint32_t)n;
+
+        if (me->data.remaining == 0)
+        {
+            complete_data_out(me);
+        }
+        else if (len < me->packet_size)
+        {
+            /* Short packet ended the transfer early. */
+            respond(me, RESP_INCOMPLETE_TRANSFER, 0, 0, 0, 0);
+        }
+    }
+}
+
+bool cusb_mtp_bulk_in(struct cusb_mtp *me, uint8_t *buf, size_t size, size_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && buf && len) );
+    CUSB_ASSERT_PACKET( (size >= me->packet_size && (size % me->packet_size) == 0) );
+    size_t n = 0;
+
+    if (me->state == STATE_DATA_IN)
+    {
+        if (me->data.zlp_pending)
+        {
+            me->data.zlp_pending = false;
+            *len = 0;
+            me->state = STATE_RESPONSE;
+            return true;
+        }
+
+        if (me->data.header_pending)
+        {
+            cusb_set_le32(&buf[0], me->data.remaining + CUSB_MTP_CONTAINER_HEADER_SIZE);
+            cusb_set_le16(&buf[4], CONTAINER_DATA);
+            cusb_set_le16(&buf[6], me->cmd.code);
+            cusb_set_le32(&buf[8], me->cmd.transaction_id);
+            me->data.header_pending = false;
+            n = CUSB_MTP_CONTAINER_HEADER_SIZE;
+        }
+
+        while (n < size && me->data.remaining > 0)
+        {
+            size_t want = size - n;
+            size_t got;
+
+            if (want > me->data.remaining)
+            {
+                want = me->data.remaining;
+            }
+
+            got = produce(me, &buf[n], want);
+            n += got;
+            me->data.offset += (uint32_t)got;
+            me->data.remaining -= (uint32_t)got;
+
+            if (got < want)
+            {
+                /* Backend failed. The resulting short packet ends the data phase early. */
+                me->data.remaining = 0;
+                me->resp.code = RESP_INCOMPLETE_TRANSFER;
+            }
+        }
+
+        if (me->data.remaining == 0)
+        {
+            if ((n % me->packet_size) == 0)
+            {
+                me->data.zlp_pending = true;
+            }
+            else
+            {
+                me->state = STATE_RESPONSE;
+            }
+
+            if (me->resp.code == RESP_UNDECIDED)
+            {
+                me->resp.code = RESP_OK;
+                me->resp.nparams = (me->cmd.code == OP_GET_PARTIAL_OBJECT) ? 1U : 0U;
+            }
+            else if (me->resp.code == RESP_INCOMPLETE_TRANSFER)
+            {
+                me->resp.nparams = 0;
+            }
+        }
+
+        *len = n;
+        return true;
+    }
+    else if (me->state == STATE_RESPONSE)
+    {
+        n = CUSB_MTP_CONTAINER_HEADER_SIZE + (4U * me->resp.nparams);
+        cusb_set_le32(&buf[0], (uint32_t)n);
+        cusb_set_le16(&buf[4], CONTAINER_RESPONSE);
+        cusb_set_le16(&buf[6], me->resp.code);
+        cusb_set_le32(&buf[8], me->cmd.transaction_id);
+
+        for (uint8_t i = 0; i < me->resp.nparams; i++)
+        {
+            cusb_set_le32(&buf[CUSB_MTP_CONTAINER_HEADER_SIZE + (4U * i)], me->resp.params[i]);
+        }
+
+        me->state = STATE_IDLE;
+        *len = n;
+        return true;
+    }
+
+    return false;
+}
+
+void cusb_mtp_reset(struct cusb_mtp *me, bool close_session)
+{
+    CUSB_ASSERT_API( (me) );
+    me->state = STATE_IDLE;
+
+    if (close_session)
+    {
+        me->session_id = 0;
+        me->send_handle = CUSB_MTP_INVALID_HANDLE;
+    }
+}
+
+#endif /* CUSB_CFG_MTP */
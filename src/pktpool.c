@@ -0,0 +1,164 @@
+/**
+ * @file
+ * @brief See @ref pktpool.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/pktpool.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_PKTPOOL)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/pktpool.c")
+
+/*------------------------------------------------------------*/
+/*------------------- PKTPOOL MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+void cusb_pktpool_ctor(struct cusb_pktpool *me,
+                       struct cusb_pkt *pkts,
+                       uint8_t *mem,
+                       uint16_t count,
+                       uint32_t size)
+{
+    CUSB_ASSERT_API( (me && pkts && mem) );
+    CUSB_ASSERT_API( (count != 0 && size != 0 && (size % 4U) == 0) );
+    CUSB_ASSERT_API( (((uintptr_t)mem % 4U) == 0) );
+
+    me->free = NULL;
+
+    for (uint16_t i = count; i != 0; i--)
+    {
+        struct cusb_pkt *pkt = &pkts[i - 1U];
+        pkt->buf = &mem[(size_t)(i - 1U) * size];
+        pkt->len = 0;
+        pkt->refs = 0;
+        pkt->next = me->free;
+        me->free = pkt;
+    }
+
+    me->size = size;
+    me->count = count;
+    me->available = count;
+    me->low_water = count;
+}
+
+void cusb_pktq_ctor(struct cusb_pktq *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    me->head = NULL;
+    me->tail = NULL;
+}
+
+struct cusb_pkt *cusb_pktpool_alloc(struct cusb_pktpool *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    struct cusb_pkt *pkt = me->free;
+
+    if (pkt)
+    {
+        me->free = pkt->next;
+        me->available--;
+        me->low_water = (me->available < me->low_water) ? me->available : me->low_water;
+        pkt->next = NULL;
+        pkt->len = 0;
+        pkt->refs = 1U;
+    }
+
+    return pkt;
+}
+
+void cusb_pktpool_ref(struct cusb_pktpool *me, struct cusb_pkt *pkt)
+{
+    CUSB_ASSERT_PACKET( (me && pkt) );
+    CUSB_ASSERT_PACKET( (pkt->refs != 0 && pkt->refs != UINT16_MAX) );
+
+    pkt->refs++;
+}
+
+void cusb_pktpool_release(struct cusb_pktpool *me, struct cusb_pkt *pkt)
+{
+    CUSB_ASSERT_PACKET( (me && pkt) );
+    CUSB_ASSERT_PACKET( (pkt->refs != 0) );
+
+    if (--pkt->refs == 0)
+    {
+        pkt->next = me->free;
+        me->free = pkt;
+        me->available++;
+    }
+}
+
+uint32_t cusb_pktpool_size(const struct cusb_pktpool *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->size;
+}
+
+uint16_t cusb_pktpool_available(const struct cusb_pktpool *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->available;
+}
+
+uint16_t cusb_pktpool_low_water(const struct cusb_pktpool *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->low_water;
+}
+
+void cusb_pktq_push(struct cusb_pktq *me, struct cusb_pkt *pkt)
+{
+    CUSB_ASSERT_PACKET( (me && pkt) );
+
+    pkt->next = NULL;
+
+    if (me->head)
+    {
+        me->tail->next = pkt;
+    }
+    else
+    {
+        me->head = pkt;
+    }
+
+    me->tail = pkt;
+}
+
+struct cusb_pkt *cusb_pktq_pop(struct cusb_pktq *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    struct cusb_pkt *pkt = me->head;
+
+    if (pkt)
+    {
+        me->head = pkt->next;
+        pkt->next = NULL;
+    }
+
+    return pkt;
+}
+
+bool cusb_pktq_empty(const struct cusb_pktq *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    return me->head == NULL;
+}
+
+#endif /* CUSB_CFG_PKTPOOL */
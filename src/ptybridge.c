@@ -0,0 +1,329 @@
+/**
+ * @file
+ * @brief See @ref ptybridge.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/* posix_openpt(), ptsname() and friends are XSI, not C99. */
+#define _XOPEN_SOURCE 700
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/ptybridge.h"
+
+/* STDLib. */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* POSIX. */
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_STREAM)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/ptybridge.c")
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Creates the pty pair in raw mode. Returns false on failure with
+ * nothing left open.
+ */
+static bool create_pty(struct cusb_ptybridge *me);
+
+/**
+ * @brief Writes the IN pipe to the pty until either runs dry.
+ */
+static size_t to_host(struct cusb_ptybridge *me);
+
+/**
+ * @brief Reads the pty into the OUT pipe until either runs dry.
+ */
+static size_t from_host(struct cusb_ptybridge *me);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static bool create_pty(struct cusb_ptybridge *me)
+{
+    struct termios tio;
+    const char *name;
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+    if (master < 0)
+    {
+        return false;
+    }
+
+    name = (grantpt(master) == 0 && unlockpt(master) == 0) ? ptsname(master) : NULL;
+
+    if (name == NULL || strlen(name) >= CUSB_PTYBRIDGE_NAME_MAX)
+    {
+        close(master);
+        return false;
+    }
+
+    strcpy(me->name, name);
+    me->slave = open(me->name, O_RDWR | O_NOCTTY);
+
+    if (me->slave < 0 || tcgetattr(me->slave, &tio) != 0)
+    {
+        if (me->slave >= 0)
+        {
+            close(me->slave);
+        }
+        close(master);
+        return false;
+    }
+
+    /* Raw, same as cfmakeraw() which is not POSIX. */
+    tio.c_iflag &= ~(tcflag_t)(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
+    tio.c_oflag &= ~(tcflag_t)OPOST;
+    tio.c_lflag &= ~(tcflag_t)(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+    tio.c_cflag &= ~(tcflag_t)(CSIZE | PARENB);
+    tio.c_cflag |= CS8;
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    tcsetattr(me->slave, TCSANOW, &tio);
+
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    me->master = master;
+    return true;
+}
+
+static size_t to_host(struct cusb_ptybridge *me)
+{
+    size_t moved = 0;
+
+    while (me->in != NULL && me->writable)
+    {
+        if (!me->in_busy)
+        {
+            if (!cusb_stream_in_acquire(me->in, me->in_iov, CUSB_PTYBRIDGE_TRANSFER_MAX, &me->in_len))
+            {
+                break;
+            }
+
+            me->in_busy = true;
+            me->in_sent = 0;
+        }
+
+        if (me->in_sent < me->in_len)
+        {
+            struct iovec iov[2];
+            int cnt = 0;
+            size_t skip = me->in_sent;
+
+            /* Resume a partly written transfer. */
+            for (int i = 0; i < 2; i++)
+            {
+                if (skip >= me->in_iov[i].len)
+                {
+                    skip -= me->in_iov[i].len;
+                    continue;
+                }
+
+                iov[cnt].iov_base = &me->in_iov[i].base[skip];
+                iov[cnt].iov_len = me->in_iov[i].len - skip;
+                skip = 0;
+                cnt++;
+            }
+
+            ssize_t n = writev(me->master, iov, cnt);
+
+            if (n <= 0)
+            {
+                me->writable = false;
+                break;
+            }
+
+            me->in_sent += (size_t)n;
+            me->stats.to_host += (uint32_t)n;
+            me->stats.syscalls++;
+            moved += (size_t)n;
+        }
+
+        /* Zero length packets have no meaning on a tty. */
+        if (me->in_sent == me->in_len)
+        {
+            cusb_stream_in_complete(me->in);
+            me->in_busy = false;
+        }
+    }
+
+    return moved;
+}
+
+static size_t from_host(struct cusb_ptybridge *me)
+{
+    size_t moved = 0;
+
+    while (me->out != NULL && me->readable)
+    {
+        if (!me->out_busy)
+        {
+            if (!cusb_stream_out_acquire(me->out, me->out_iov, CUSB_PTYBRIDGE_TRANSFER_MAX, &me->out_len))
+            {
+                /* Throttled. Leave the data in the pty. */
+                break;
+            }
+
+            me->out_busy = true;
+        }
+
+        struct iovec iov[2];
+        iov[0].iov_base = me->out_iov[0].base;
+        iov[0].iov_len = me->out_iov[0].len;
+        iov[1].iov_base = me->out_iov[1].base;
+        iov[1].iov_len = me->out_iov[1].len;
+
+        ssize_t n = readv(me->master, iov, (me->out_iov[1].len != 0U) ? 2 : 1);
+
+        if (n <= 0)
+        {
+            /* Drained, or EIO while no one holds the slave. */
+            me->readable = false;
+            break;
+        }
+
+        /* Short read is a short packet, ending the transfer. */
+        cusb_stream_out_complete(me->out, (size_t)n);
+        me->out_busy = false;
+        me->stats.from_host += (uint32_t)n;
+        me->stats.syscalls++;
+        moved += (size_t)n;
+    }
+
+    return moved;
+}
+
+/*------------------------------------------------------------*/
+/*------------------- PTYBRIDGE MEMBER FUNCTIONS -------------*/
+/*------------------------------------------------------------*/
+
+bool cusb_ptybridge_open(struct cusb_ptybridge *me,
+                         struct cusb_stream *in,
+                         struct cusb_stream *out,
+                         const char *link)
+{
+    CUSB_ASSERT_API( (me) );
+    CUSB_ASSERT_API( (in == NULL || in->dir == CUSB_STREAM_IN) );
+    CUSB_ASSERT_API( (out == NULL || out->dir == CUSB_STREAM_OUT) );
+
+    struct epoll_event ev;
+
+    memset(me, 0, sizeof(*me));
+    me->in = in;
+    me->out = out;
+    me->link = link;
+
+    if (!create_pty(me))
+    {
+        return false;
+    }
+
+    me->epfd = epoll_create1(0);
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.ptr = me;
+
+    if (me->epfd < 0 || epoll_ctl(me->epfd, EPOLL_CTL_ADD, me->master, &ev) != 0 ||
+        (link != NULL && ((unlink(link) != 0 && errno != ENOENT) || symlink(me->name, link) != 0)))
+    {
+        if (me->epfd >= 0)
+        {
+            close(me->epfd);
+        }
+        close(me->slave);
+        close(me->master);
+        return false;
+    }
+
+    /* Edge-triggered, so assume ready until a syscall says otherwise. */
+    me->readable = true;
+    me->writable = true;
+    return true;
+}
+
+void cusb_ptybridge_close(struct cusb_ptybridge *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (me->link != NULL)
+    {
+        unlink(me->link);
+    }
+
+    close(me->epfd);
+    close(me->slave);
+    close(me->master);
+    me->epfd = -1;
+    me->slave = -1;
+    me->master = -1;
+}
+
+size_t cusb_ptybridge_poll(struct cusb_ptybridge *me, int timeout_ms)
+{
+    CUSB_ASSERT_PACKET( (me) );
+
+    struct epoll_event ev;
+    size_t moved = to_host(me) + from_host(me);
+
+    /* Edges not collected yet stay queued in the epoll instance. */
+    if (moved != 0U || epoll_wait(me->epfd, &ev, 1, timeout_ms) != 1)
+    {
+        return moved;
+    }
+
+    if ((ev.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0U)
+    {
+        me->readable = true;
+    }
+
+    if ((ev.events & EPOLLOUT) != 0U)
+    {
+        me->writable = true;
+    }
+
+    return to_host(me) + from_host(me);
+}
+
+int cusb_ptybridge_fd(const struct cusb_ptybridge *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->epfd;
+}
+
+const char *cusb_ptybridge_name(const struct cusb_ptybridge *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->name;
+}
+
+const struct cusb_ptybridge_stats *cusb_ptybridge_get_stats(const struct cusb_ptybridge *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+
+#endif /* CUSB_CFG_STREAM */
@@ -0,0 +1,864 @@
+/**
+ * @file
+ * @brief See @ref rndis.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/rndis.h"
+
+/* SETUP fields and endian accessors. */
+#include "cusb/setup.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_RNDIS)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/rndis.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Class Requests
+ */
+/**@{*/
+#define REQ_SEND_ENCAPSULATED_COMMAND       (0x00U)
+#define REQ_GET_ENCAPSULATED_RESPONSE       (0x01U)
+/**@}*/
+
+/**
+ * @name Message Types
+ */
+/**@{*/
+#define MSG_PACKET                          (0x00000001UL)
+#define MSG_INITIALIZE                      (0x00000002UL)
+#define MSG_HALT                            (0x00000003UL)
+#define MSG_QUERY                           (0x00000004UL)
+#define MSG_SET                             (0x00000005UL)
+#define MSG_RESET                           (0x00000006UL)
+#define MSG_INDICATE_STATUS                 (0x00000007UL)
+#define MSG_KEEPALIVE                       (0x00000008UL)
+#define MSG_CMPLT                           (0x80000000UL)
+/**@}*/
+
+/**
+ * @name Status Values
+ */
+/**@{*/
+#define STATUS_SUCCESS                      (0x00000000UL)
+#define STATUS_NOT_SUPPORTED                (0xC00000BBUL)
+#define STATUS_INVALID_DATA                 (0xC0010015UL)
+#define STATUS_MEDIA_CONNECT                (0x4001000BUL)
+#define STATUS_MEDIA_DISCONNECT             (0x4001000CUL)
+/**@}*/
+
+/**
+ * @name Object Identifiers
+ */
+/**@{*/
+#define OID_GEN_SUPPORTED_LIST              (0x00010101UL)
+#define OID_GEN_HARDWARE_STATUS             (0x00010102UL)
+#define OID_GEN_MEDIA_SUPPORTED             (0x00010103UL)
+#define OID_GEN_MEDIA_IN_USE                (0x00010104UL)
+#define OID_GEN_MAXIMUM_FRAME_SIZE          (0x00010106UL)
+#define OID_GEN_LINK_SPEED                  (0x00010107UL)
+#define OID_GEN_TRANSMIT_BLOCK_SIZE         (0x0001010AUL)
+#define OID_GEN_RECEIVE_BLOCK_SIZE          (0x0001010BUL)
+#define OID_GEN_VENDOR_ID                   (0x0001010CUL)
+#define OID_GEN_VENDOR_DESCRIPTION          (0x0001010DUL)
+#define OID_GEN_CURRENT_PACKET_FILTER       (0x0001010EUL)
+#define OID_GEN_CURRENT_LOOKAHEAD           (0x0001010FUL)
+#define OID_GEN_MAXIMUM_TOTAL_SIZE          (0x00010111UL)
+#define OID_GEN_MAC_OPTIONS                 (0x00010113UL)
+#define OID_GEN_MEDIA_CONNECT_STATUS        (0x00010114UL)
+#define OID_GEN_PHYSICAL_MEDIUM             (0x00010202UL)
+#define OID_GEN_XMIT_OK                     (0x00020101UL)
+#define OID_GEN_RCV_OK                      (0x00020102UL)
+#define OID_GEN_XMIT_ERROR                  (0x00020103UL)
+#define OID_GEN_RCV_ERROR                   (0x00020104UL)
+#define OID_GEN_RCV_NO_BUFFER               (0x00020105UL)
+#define OID_802_3_PERMANENT_ADDRESS         (0x01010101UL)
+#define OID_802_3_CURRENT_ADDRESS           (0x01010102UL)
+#define OID_802_3_MULTICAST_LIST            (0x01010103UL)
+#define OID_802_3_MAXIMUM_LIST_SIZE         (0x01010104UL)
+/**@}*/
+
+/**
+ * @name Packet Message Fields
+ * Byte offsets from the start of the message.
+ */
+/**@{*/
+#define PKT_TYPE                            (0U)
+#define PKT_LENGTH                          (4U)
+#define PKT_DATA_OFFSET                     (8U)
+#define PKT_DATA_LENGTH                     (12U)
+/**@}*/
+
+/**
+ * @brief Offsets in messages count from the RequestId field, 8 bytes
+ * in.
+ */
+#define OFFSET_BASE                         (8U)
+
+/**
+ * @brief Messages the host packs into one transfer start at multiples
+ * of 2 to this power, so the frames the application gets are aligned.
+ */
+#define ALIGNMENT_FACTOR                    (2U)
+
+/**
+ * @brief Rounds @p n up to a multiple of 4.
+ */
+#define ALIGN4(n)                           (((n) + 3U) & ~(uint32_t)3U)
+
+/**
+ * @brief Statistics reported to the host. 0 when they are not kept.
+ */
+#if (CUSB_CFG_STATS)
+#define STAT(me, field)                     ((me)->stats.field)
+#else
+#define STAT(me, field)                     (0UL)
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Returns true if a Bulk-IN transfer can start now.
+ */
+static bool can_send(const struct cusb_rndis *me);
+
+/**
+ * @brief Returns every Bulk-IN buffer not in flight to the pool.
+ */
+static void drop_tx(struct cusb_rndis *me);
+
+/**
+ * @brief Completes a response of @p len bytes already in the buffer
+ * and tells the host it is there.
+ */
+static void respond(struct cusb_rndis *me, uint32_t type, uint32_t len);
+
+/**
+ * @brief Writes the value of @p oid to @p buf. Returns false if
+ * @p oid is not supported.
+ */
+static bool query(const struct cusb_rndis *me, uint32_t oid, uint8_t *buf, uint32_t *len);
+
+/**
+ * @brief Sets @p oid to the @p len bytes at @p buf. Returns the status.
+ */
+static uint32_t set(struct cusb_rndis *me, uint32_t oid, const uint8_t *buf, uint32_t len);
+
+/**
+ * @brief Handles the control message of @p len bytes in the command
+ * buffer. Returns false if it is malformed.
+ */
+static bool process(struct cusb_rndis *me, uint32_t len);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Answers to OID_GEN_SUPPORTED_LIST.
+ */
+static const uint32_t SUPPORTED[] =
+{
+    OID_GEN_SUPPORTED_LIST, OID_GEN_HARDWARE_STATUS, OID_GEN_MEDIA_SUPPORTED,
+    OID_GEN_MEDIA_IN_USE, OID_GEN_MAXIMUM_FRAME_SIZE, OID_GEN_LINK_SPEED,
+    OID_GEN_TRANSMIT_BLOCK_SIZE, OID_GEN_RECEIVE_BLOCK_SIZE, OID_GEN_VENDOR_ID,
+    OID_GEN_VENDOR_DESCRIPTION, OID_GEN_CURRENT_PACKET_FILTER, OID_GEN_CURRENT_LOOKAHEAD,
+    OID_GEN_MAXIMUM_TOTAL_SIZE, OID_GEN_MAC_OPTIONS, OID_GEN_MEDIA_CONNECT_STATUS,
+    OID_GEN_PHYSICAL_MEDIUM, OID_GEN_XMIT_OK, OID_GEN_RCV_OK, OID_GEN_XMIT_ERROR,
+    OID_GEN_RCV_ERROR, OID_GEN_RCV_NO_BUFFER, OID_802_3_PERMANENT_ADDRESS,
+    OID_802_3_CURRENT_ADDRESS, OID_802_3_MULTICAST_LIST, OID_802_3_MAXIMUM_LIST_SIZE
+};
+
+/**
+ * @brief Answer to OID_GEN_VENDOR_DESCRIPTION.
+ */
+static const char VENDOR_DESCRIPTION[] = "cusb RNDIS";
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static bool can_send(const struct cusb_rndis *me)
+{
+    return !me->tx_busy && (!cusb_pktq_empty(&me->tx_queue) || (me->tx_open && me->tx_open->len != 0));
+}
+
+static void drop_tx(struct cusb_rndis *me)
+{
+    struct cusb_pkt *pkt;
+
+    while ((pkt = cusb_pktq_pop(&me->tx_queue)) != NULL)
+    {
+        cusb_pktpool_release(me->pool, pkt);
+    }
+
+    if (me->tx_open)
+    {
+        cusb_pktpool_release(me->pool, me->tx_open);
+        me->tx_open = NULL;
+    }
+}
+
+static void respond(struct cusb_rndis *me, uint32_t type, uint32_t len)
+{
+    cusb_set_le32(&me->resp[0], type | MSG_CMPLT);
+    cusb_set_le32(&me->resp[4], len);
+    me->resp_len = (uint16_t)len;
+    me->api->notify(me->ctx);
+}
+
+static bool query(const struct cusb_rndis *me, uint32_t oid, uint8_t *buf, uint32_t *len)
+{
+    uint32_t value;
+
+    switch (oid)
+    {
+        case OID_GEN_SUPPORTED_LIST:
+        {
+            for (size_t i = 0; i < sizeof(SUPPORTED) / sizeof(SUPPORTED[0]); i++)
+            {
+                cusb_set_le32(&buf[4U * i], SUPPORTED[i]);
+            }
+
+            *len = (uint32_t)sizeof(SUPPORTED);
+            return true;
+        }
+
+        case OID_GEN_VENDOR_DESCRIPTION:
+        {
+            memcpy(buf, VENDOR_DESCRIPTION, sizeof(VENDOR_DESCRIPTION));
+            *len = (uint32_t)sizeof(VENDOR_DESCRIPTION);
+            return true;
+        }
+
+        case OID_802_3_PERMANENT_ADDRESS:
+        case OID_802_3_CURRENT_ADDRESS:
+        {
+            memcpy(buf, me->mac, sizeof(me->mac));
+            *len = (uint32_t)sizeof(me->mac);
+            return true;
+        }
+
+        case OID_802_3_MULTICAST_LIST:
+        {
+            /* Every multicast frame is passed on, none filtered. */
+            *len = 0;
+            return true;
+        }
+
+        case OID_GEN_HARDWARE_STATUS:
+        case OID_GEN_MEDIA_SUPPORTED:
+        case OID_GEN_MEDIA_IN_USE:
+        case OID_GEN_PHYSICAL_MEDIUM:
+        case OID_GEN_MAC_OPTIONS:
+        case OID_GEN_RCV_NO_BUFFER:
+        {
+            /* Ready, 802.3, unspecified medium, no options. */
+            value = 0;
+            break;
+        }
+
+        case OID_GEN_MAXIMUM_FRAME_SIZE:
+        {
+            value = CUSB_RNDIS_FRAME_MAX - 14U;
+            break;
+        }
+
+        case OID_GEN_LINK_SPEED:
+        {
+            /* Units of 100 bit/s. */
+            value = (me->packet_size == 512U) ? 4800000UL : 120000UL;
+            break;
+        }
+
+        case OID_GEN_TRANSMIT_BLOCK_SIZE:
+        case OID_GEN_RECEIVE_BLOCK_SIZE:
+        case OID_GEN_CURRENT_LOOKAHEAD:
+        {
+            value = CUSB_RNDIS_FRAME_MAX;
+            break;
+        }
+
+        case OID_GEN_MAXIMUM_TOTAL_SIZE:
+        {
+            value = CUSB_RNDIS_FRAME_MAX + CUSB_RNDIS_HEADER_SIZE;
+            break;
+        }
+
+        case OID_GEN_VENDOR_ID:
+        {
+            value = 0x00FFFFFFUL;
+            break;
+        }
+
+        case OID_GEN_CURRENT_PACKET_FILTER:
+        {
+            value = me->filter;
+            break;
+        }
+
+        case OID_GEN_MEDIA_CONNECT_STATUS:
+        {
+            value = me->link ? 0U : 1U;
+            break;
+        }
+
+        case OID_GEN_XMIT_OK:
+        {
+            value = STAT(me, tx_frames);
+            break;
+        }
+
+        case OID_GEN_RCV_OK:
+        {
+            value = STAT(me, rx_frames);
+            break;
+        }
+
+        case OID_GEN_XMIT_ERROR:
+        {
+            value = STAT(me, tx_dropped);
+            break;
+        }
+
+        case OID_GEN_RCV_ERROR:
+        {
+            value = STAT(me, rx_errors);
+            break;
+        }
+
+        case OID_802_3_MAXIMUM_LIST_SIZE:
+        {
+            value = 1U;
+            break;
+        }
+
+        default:
+        {
+            return false;
+        }
+    }
+
+    cusb_set_le32(buf, value);
+    *len = 4U;
+    return true;
+}
+
+static uint32_t set(struct cusb_rndis *me, uint32_t oid, const uint8_t *buf, uint32_t len)
+{
+    switch (oid)
+    {
+        case OID_GEN_CURRENT_PACKET_FILTER:
+        {
+            if (len < 4U)
+            {
+                return STATUS_INVALID_DATA;
+            }
+
+            me->filter = cusb_get_le32(buf);
+
+            if (me->filter == 0)
+            {
+                drop_tx(me);
+            }
+
+            return STATUS_SUCCESS;
+        }
+
+        case OID_GEN_CURRENT_LOOKAHEAD:
+        case OID_802_3_MULTICAST_LIST:
+        {
+            /* Accepted and ignored, everything is passed on. */
+            return STATUS_SUCCESS;
+        }
+
+        default:
+        {
+            return STATUS_NOT_SUPPORTED;
+        }
+    }
+}
+
+static bool process(struct cusb_rndis *me, uint32_t len)
+{
+    const uint8_t *cmd = me->cmd;
+
+    if (len < 12U || cusb_get_le32(&cmd[4]) > len)
+    {
+        return false;
+    }
+
+    uint32_t type = cusb_get_le32(&cmd[0]);
+    uint32_t request_id = cusb_get_le32(&cmd[8]);
+    uint8_t *resp = me->resp;
+
+    CUSB_TRACE(CUSB_TRACE_RNDIS_MESSAGE, type);
+
+    switch (type)
+    {
+        case MSG_INITIALIZE:
+        {
+            if (len < 24U)
+            {
+                return false;
+            }
+
+            uint32_t size = cusb_pktpool_size(me->pool);
+            uint32_t host_max = cusb_get_le32(&cmd[20]);
+
+            me->tx_max = (host_max < size) ? host_max : size;
+            me->tx_max = (me->tx_max < CUSB_RNDIS_BUFFER_MIN) ? CUSB_RNDIS_BUFFER_MIN : me->tx_max;
+            me->initialized = true;
+            me->filter = 0;
+            drop_tx(me);
+
+            cusb_set_le32(&resp[8], request_id);
+            cusb_set_le32(&resp[12], STATUS_SUCCESS);
+            cusb_set_le32(&resp[16], 1U);                   /* MajorVersion. */
+            cusb_set_le32(&resp[20], 0U);                   /* MinorVersion. */
+            cusb_set_le32(&resp[24], 1U);                   /* DeviceFlags, connectionless. */
+            cusb_set_le32(&resp[28], 0U);                   /* Medium, 802.3. */
+            cusb_set_le32(&resp[32], size / (CUSB_RNDIS_HEADER_SIZE + 60U));
+            cusb_set_le32(&resp[36], size);                 /* MaxTransferSize. */
+            cusb_set_le32(&resp[40], ALIGNMENT_FACTOR);
+            cusb_set_le32(&resp[44], 0U);                   /* No AF list. */
+            cusb_set_le32(&resp[48], 0U);
+            respond(me, type, 52U);
+            break;
+        }
+
+        case MSG_HALT:
+        {
+            me->initialized = false;
+            me->filter = 0;
+            drop_tx(me);
+            break;
+        }
+
+        case MSG_QUERY:
+        {
+            if (len < 28U)
+            {
+                return false;
+            }
+
+            uint32_t n = 0;
+            bool ok = query(me, cusb_get_le32(&cmd[12]), &resp[24], &n);
+
+            cusb_set_le32(&resp[8], request_id);
+            cusb_set_le32(&resp[12], ok ? STATUS_SUCCESS : STATUS_NOT_SUPPORTED);
+            cusb_set_le32(&resp[16], n);
+            cusb_set_le32(&resp[20], (n != 0) ? 24U - OFFSET_BASE : 0U);
+            respond(me, type, 24U + n);
+            break;
+        }
+
+        case MSG_SET:
+        {
+            if (len < 28U)
+            {
+                return false;
+            }
+
+            uint32_t info_len = cusb_get_le32(&cmd[16]);
+            uint32_t info_offset = cusb_get_le32(&cmd[20]);
+            uint32_t status = STATUS_INVALID_DATA;
+
+            if (info_offset <= len - OFFSET_BASE && info_len <= len - OFFSET_BASE - info_offset)
+            {
+                status = set(me, cusb_get_le32(&cmd[12]), &cmd[OFFSET_BASE + info_offset], info_len);
+            }
+
+            cusb_set_le32(&resp[8], request_id);
+            cusb_set_le32(&resp[12], status);
+            respond(me, type, 16U);
+            break;
+        }
+
+        case MSG_RESET:
+        {
+            /* AddressingReset makes the host set the filter again. */
+            drop_tx(me);
+            cusb_set_le32(&resp[8], STATUS_SUCCESS);
+            cusb_set_le32(&resp[12], 1U);
+            respond(me, type, 16U);
+            break;
+        }
+
+        case MSG_KEEPALIVE:
+        {
+            cusb_set_le32(&resp[8], request_id);
+            cusb_set_le32(&resp[12], STATUS_SUCCESS);
+            respond(me, type, 16U);
+            break;
+        }
+
+        default:
+        {
+            /* Unknown messages are ignored. */
+            break;
+        }
+    }
+
+    return true;
+}
+
+/*------------------------------------------------------------*/
+/*-------------------- RNDIS MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_rndis_ctor(struct cusb_rndis *me,
+                     const struct cusb_rndis_api *api,
+                     void *ctx,
+                     struct cusb_pktpool *pool,
+                     const uint8_t *mac,
+                     uint16_t packet_size)
+{
+    CUSB_ASSERT_API( (me && api && pool && mac) );
+    CUSB_ASSERT_API( (api->receive && api->notify && api->ready) );
+    CUSB_ASSERT_API( (cusb_pktpool_size(pool) >= CUSB_RNDIS_BUFFER_MIN) );
+    CUSB_ASSERT_API( (packet_size >= 8U && packet_size <= CUSB_CFG_BULK_SIZE_MAX) );
+
+    me->api = api;
+    me->ctx = ctx;
+    me->pool = pool;
+    memcpy(me->mac, mac, sizeof(me->mac));
+    me->packet_size = packet_size;
+    me->link = true;
+    me->rx = NULL;
+    me->tx_open = NULL;
+    me->tx_busy = NULL;
+    cusb_pktq_ctor(&me->tx_queue);
+    cusb_rndis_reset(me);
+
+#if (CUSB_CFG_STATS)
+    me->stats.rx_frames = 0;
+    me->stats.rx_errors = 0;
+    me->stats.tx_frames = 0;
+    me->stats.tx_dropped = 0;
+    me->stats.tx_transfers = 0;
+#endif
+}
+
+uint8_t *cusb_rndis_tx_alloc(struct cusb_rndis *me, uint32_t len)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (len <= CUSB_RNDIS_FRAME_MAX) );
+
+    /* Header, frame padded to keep the next header aligned, and room
+    for the byte that keeps the transfer off a packet multiple. */
+    uint32_t need = CUSB_RNDIS_HEADER_SIZE + ALIGN4(len) + 1U;
+
+    if (me->tx_open && me->tx_open->len + need > me->tx_max)
+    {
+        cusb_pktq_push(&me->tx_queue, me->tx_open);
+        me->tx_open = NULL;
+    }
+
+    if (!me->tx_open && cusb_rndis_online(me))
+    {
+        me->tx_open = cusb_pktpool_alloc(me->pool);
+    }
+
+    if (!me->tx_open || !cusb_rndis_online(me))
+    {
+#if (CUSB_CFG_STATS)
+        me->stats.tx_dropped++;
+#endif
+        return NULL;
+    }
+
+    return &me->tx_open->buf[me->tx_open->len + CUSB_RNDIS_HEADER_SIZE];
+}
+
+void cusb_rndis_tx_commit(struct cusb_rndis *me, uint32_t len)
+{
+    CUSB_ASSERT_PACKET( (me && me->tx_open) );
+    CUSB_ASSERT_PACKET( (len <= CUSB_RNDIS_FRAME_MAX) );
+
+    bool could_send = can_send(me);
+    uint8_t *msg = &me->tx_open->buf[me->tx_open->len];
+    uint32_t msg_len = CUSB_RNDIS_HEADER_SIZE + ALIGN4(len);
+
+    cusb_set_le32(&msg[PKT_TYPE], MSG_PACKET);
+    cusb_set_le32(&msg[PKT_LENGTH], msg_len);
+    cusb_set_le32(&msg[PKT_DATA_OFFSET], CUSB_RNDIS_HEADER_SIZE - OFFSET_BASE);
+    cusb_set_le32(&msg[PKT_DATA_LENGTH], len);
+    memset(&msg[16], 0, CUSB_RNDIS_HEADER_SIZE - 16U);
+    me->tx_open->len += msg_len;
+
+#if (CUSB_CFG_STATS)
+    me->stats.tx_frames++;
+#endif
+
+    if (!could_send && can_send(me))
+    {
+        me->api->ready(me->ctx);
+    }
+}
+
+void cusb_rndis_set_link(struct cusb_rndis *me, bool up)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (me->link == up)
+    {
+        return;
+    }
+
+    me->link = up;
+
+    if (me->initialized)
+    {
+        me->indication = up ? STATUS_MEDIA_CONNECT : STATUS_MEDIA_DISCONNECT;
+
+        if (me->resp_len == 0)
+        {
+            me->api->notify(me->ctx);
+        }
+    }
+}
+
+bool cusb_rndis_online(const struct cusb_rndis *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    return me->initialized && me->filter != 0;
+}
+
+#if (CUSB_CFG_STATS)
+const struct cusb_rndis_stats *cusb_rndis_get_stats(const struct cusb_rndis *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+#endif
+
+bool cusb_rndis_control(struct cusb_rndis *me, const uint8_t *setup, uint8_t **data, uint16_t *len)
+{
+    CUSB_ASSERT_API( (me && setup && data && len) );
+    uint8_t type = cusb_setup_request_type(setup);
+
+    if ((type & CUSB_SETUP_TYPE_MASK) != CUSB_SETUP_TYPE_CLASS)
+    {
+        return false;
+    }
+
+    if (cusb_setup_request(setup) == REQ_SEND_ENCAPSULATED_COMMAND && !(type & CUSB_SETUP_DIR_IN))
+    {
+        if (cusb_setup_length(setup) > sizeof(me->cmd))
+        {
+            return false;
+        }
+
+        *data = me->cmd;
+        *len = (uint16_t)sizeof(me->cmd);
+        return true;
+    }
+
+    if (cusb_setup_request(setup) == REQ_GET_ENCAPSULATED_RESPONSE && (type & CUSB_SETUP_DIR_IN))
+    {
+        if (me->resp_len == 0 && me->indication != 0)
+        {
+            cusb_set_le32(&me->resp[0], MSG_INDICATE_STATUS);
+            cusb_set_le32(&me->resp[4], 20U);
+            cusb_set_le32(&me->resp[8], me->indication);
+            cusb_set_le32(&me->resp[12], 0U);
+            cusb_set_le32(&me->resp[16], 0U);
+            me->resp_len = 20U;
+            me->indication = 0;
+        }
+
+        if (me->resp_len != 0)
+        {
+            *data = me->resp;
+            *len = me->resp_len;
+            me->resp_len = 0;
+
+            if (me->indication != 0)
+            {
+                me->api->notify(me->ctx);
+            }
+        }
+        else
+        {
+            /* Nothing to say: a single zero byte. */
+            me->resp[0] = 0;
+            *data = me->resp;
+            *len = 1U;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+bool cusb_rndis_control_out(struct cusb_rndis *me, const uint8_t *setup, const uint8_t *data, uint16_t len)
+{
+    CUSB_ASSERT_API( (me && setup) );
+    CUSB_ASSERT_API( (data == me->cmd) );
+
+    return process(me, len);
+}
+
+uint8_t *cusb_rndis_rx_arm(struct cusb_rndis *me, uint32_t *size)
+{
+    CUSB_ASSERT_PACKET( (me && size) );
+    CUSB_ASSERT_PACKET( (!me->rx) );
+
+    me->rx = cusb_pktpool_alloc(me->pool);
+
+    if (!me->rx)
+    {
+        return NULL;
+    }
+
+    *size = cusb_pktpool_size(me->pool);
+    return me->rx->buf;
+}
+
+void cusb_rndis_bulk_out(struct cusb_rndis *me, uint32_t len)
+{
+    CUSB_ASSERT_PACKET( (me && me->rx) );
+    CUSB_ASSERT_PACKET( (len <= cusb_pktpool_size(me->pool)) );
+
+    struct cusb_pkt *pkt = me->rx;
+    uint32_t offset = 0;
+
+    me->rx = NULL;
+
+    /* Anything shorter than a header at the end is the pad byte or
+    alignment. */
+    while (len - offset >= CUSB_RNDIS_HEADER_SIZE)
+    {
+        uint8_t *msg = &pkt->buf[offset];
+        uint32_t msg_len = cusb_get_le32(&msg[PKT_LENGTH]);
+        uint32_t data_offset = cusb_get_le32(&msg[PKT_DATA_OFFSET]);
+        uint32_t data_len = cusb_get_le32(&msg[PKT_DATA_LENGTH]);
+
+        if (cusb_get_le32(&msg[PKT_TYPE]) != MSG_PACKET ||
+            msg_len < CUSB_RNDIS_HEADER_SIZE || msg_len > len - offset ||
+            data_offset > msg_len - OFFSET_BASE || data_len > msg_len - OFFSET_BASE - data_offset)
+        {
+#if (CUSB_CFG_STATS)
+            me->stats.rx_errors++;
+#endif
+            CUSB_TRACE(CUSB_TRACE_RNDIS_BAD_PACKET, offset);
+            break;
+        }
+
+        if (data_len != 0)
+        {
+#if (CUSB_CFG_STATS)
+            me->stats.rx_frames++;
+#endif
+            cusb_pktpool_ref(me->pool, pkt);
+            me->api->receive(me->ctx, pkt, &msg[OFFSET_BASE + data_offset], data_len);
+        }
+
+        offset += msg_len;
+    }
+
+    cusb_pktpool_release(me->pool, pkt);
+}
+
+bool cusb_rndis_bulk_in(struct cusb_rndis *me, uint8_t **buf, uint32_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && buf && len) );
+
+    if (!can_send(me))
+    {
+        return false;
+    }
+
+    struct cusb_pkt *pkt = cusb_pktq_pop(&me->tx_queue);
+
+    if (!pkt)
+    {
+        pkt = me->tx_open;
+        me->tx_open = NULL;
+    }
+
+    if ((pkt->len % me->packet_size) == 0)
+    {
+        /* One more byte instead of a zero length packet. */
+        pkt->buf[pkt->len++] = 0;
+    }
+
+    me->tx_busy = pkt;
+    *buf = pkt->buf;
+    *len = pkt->len;
+
+#if (CUSB_CFG_STATS)
+    me->stats.tx_transfers++;
+#endif
+    return true;
+}
+
+void cusb_rndis_in_complete(struct cusb_rndis *me)
+{
+    CUSB_ASSERT_PACKET( (me && me->tx_busy) );
+
+    cusb_pktpool_release(me->pool, me->tx_busy);
+    me->tx_busy = NULL;
+
+    if (can_send(me))
+    {
+        me->api->ready(me->ctx);
+    }
+}
+
+void cusb_rndis_reset(struct cusb_rndis *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    drop_tx(me);
+
+    if (me->rx)
+    {
+        cusb_pktpool_release(me->pool, me->rx);
+        me->rx = NULL;
+    }
+
+    if (me->tx_busy)
+    {
+        cusb_pktpool_release(me->pool, me->tx_busy);
+        me->tx_busy = NULL;
+    }
+
+    me->tx_max = cusb_pktpool_size(me->pool);
+    me->filter = 0;
+    me->indication = 0;
+    me->initialized = false;
+    me->resp_len = 0;
+}
+
+#endif /* CUSB_CFG_RNDIS */
@@ -0,0 +1,326 @@
+/**
+ * @file
+ * @brief See @ref rtt.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/rtt.h"
+
+/* Endian accessors. */
+#include "cusb/endian.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_RTT)
+
+#if !defined(__GCC_ATOMIC_INT_LOCK_FREE) || (__GCC_ATOMIC_INT_LOCK_FREE < 2)
+#error "cusb/rtt.c needs lock-free 32-bit atomics. Set CUSB_CFG_RTT to 0 on this target."
+#endif
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/rtt.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Lock-free primitives. Acquire and release throughout, so the
+ * bytes a writer copied are in memory before its offset moves.
+ */
+/**@{*/
+#define LOAD(p)                 __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define CAS(p, expected, value) __atomic_compare_exchange_n((p), (expected), (value), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define ADD(p, n)               __atomic_add_fetch((p), (n), __ATOMIC_ACQ_REL)
+#define SUB(p, n)               __atomic_sub_fetch((p), (n), __ATOMIC_ACQ_REL)
+#define SWAP(p, value)          __atomic_exchange_n((p), (value), __ATOMIC_ACQ_REL)
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static void buffer_ctor(struct cusb_rtt_buffer *buffer, const char *name, uint8_t *buf, size_t size);
+
+/**
+ * @brief Reserves @p len bytes of @p channel and stores where they start
+ * in @p start. Returns false, with the channel left, if they do not
+ * fit. Either way ends with @ref release().
+ */
+static bool claim(struct cusb_rtt *me, uint8_t channel, uint32_t len, uint32_t *start);
+
+/**
+ * @brief Copies @p len bytes into the ring of @p buffer at @p start,
+ * wrapping around its end.
+ */
+static void copy(struct cusb_rtt_buffer *buffer, uint32_t start, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Leaves @p channel. The last writer out publishes every byte
+ * claimed so far.
+ */
+static void release(struct cusb_rtt *me, uint8_t channel);
+
+static void count(struct cusb_rtt *me, bool written);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+#if (CUSB_CFG_TRACE_RTT)
+/**
+ * @brief Sink of @ref cusb_trace().
+ */
+static struct cusb_rtt *trace_sink;
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void buffer_ctor(struct cusb_rtt_buffer *buffer, const char *name, uint8_t *buf, size_t size)
+{
+    buffer->name = name;
+    buffer->buf = buf;
+    buffer->size = (uint32_t)size;
+    buffer->wr_off = 0;
+    buffer->rd_off = 0;
+    buffer->flags = 0;
+}
+
+static bool claim(struct cusb_rtt *me, uint8_t channel, uint32_t len, uint32_t *start)
+{
+    struct cusb_rtt_buffer *buffer = &me->cb.up[channel];
+    (void)ADD(&me->writers[channel], 1U);
+
+    uint32_t begin = LOAD(&me->claim[channel]);
+    uint32_t end;
+
+    do
+    {
+        /* Everything from the reader up to the last claim is in use,
+        published or not. */
+        uint32_t rd = buffer->rd_off;
+        uint32_t space = (rd > begin) ? (rd - begin - 1U) : (buffer->size - (begin - rd) - 1U);
+
+        if (len > space)
+        {
+            return false;
+        }
+
+        end = begin + len;
+        end = (end >= buffer->size) ? (end - buffer->size) : end;
+    } while (!CAS(&me->claim[channel], &begin, end));
+
+    *start = begin;
+    return true;
+}
+
+static void copy(struct cusb_rtt_buffer *buffer, uint32_t start, const uint8_t *data, uint32_t len)
+{
+    uint32_t first = buffer->size - start;
+    first = (len < first) ? len : first;
+
+    memcpy(&buffer->buf[start], data, first);
+    memcpy(buffer->buf, &data[first], len - first);
+}
+
+static void release(struct cusb_rtt *me, uint8_t channel)
+{
+    if (SUB(&me->writers[channel], 1U) != 0U)
+    {
+        /* Preempted a writer that is still copying. It publishes. */
+        return;
+    }
+
+    /* A writer that preempts us from here on publishes a later claim.
+    Never move the offset back over it. */
+    volatile uint32_t *wr_off = &me->cb.up[channel].wr_off;
+    uint32_t published = LOAD(wr_off);
+    uint32_t claimed = LOAD(&me->claim[channel]);
+
+    while (published != claimed && !CAS(wr_off, &published, claimed))
+    {
+        claimed = LOAD(&me->claim[channel]);
+    }
+}
+
+static void count(struct cusb_rtt *me, bool written)
+{
+#if (CUSB_CFG_STATS)
+    (void)ADD(written ? &me->stats.written : &me->stats.dropped, 1U);
+#else
+    (void)me;
+    (void)written;
+#endif
+}
+
+/*------------------------------------------------------------*/
+/*---------------------- RTT MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_rtt_ctor(struct cusb_rtt *me,
+                   uint8_t *log,
+                   size_t log_size,
+                   uint8_t *trace,
+                   size_t trace_size,
+                   uint32_t (*now)(void))
+{
+    CUSB_ASSERT_API( (me && log && trace) );
+    CUSB_ASSERT_API( (log_size >= 2U && log_size <= UINT32_MAX) );
+    CUSB_ASSERT_API( (trace_size > CUSB_RTT_RECORD_SIZE && trace_size <= UINT32_MAX) );
+
+    /* Hide the ID from a debugger scanning memory until the block is
+    complete. */
+    memset(&me->cb, 0, sizeof(me->cb));
+    me->cb.max_up = (int32_t)CUSB_RTT_CHANNELS;
+    me->cb.max_down = 0;
+    buffer_ctor(&me->cb.up[CUSB_RTT_LOG], "Terminal", log, log_size);
+    buffer_ctor(&me->cb.up[CUSB_RTT_TRACE], "cusb trace", trace, trace_size);
+
+    for (uint8_t c = 0; c < CUSB_RTT_CHANNELS; c++)
+    {
+        me->claim[c] = 0;
+        me->writers[c] = 0;
+    }
+
+    me->lost = 0;
+    me->now = now;
+#if (CUSB_CFG_STATS)
+    me->stats.written = 0;
+    me->stats.dropped = 0;
+#endif
+
+    /* Written in two pieces, the full string never exists anywhere but
+    here, so a scan cannot find a stale copy in a stack or a literal. */
+    memcpy(&me->cb.id[7], "RTT", 4);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    memcpy(me->cb.id, "SEGGER", 6);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    me->cb.id[6] = ' ';
+}
+
+bool cusb_rtt_write(struct cusb_rtt *me, uint8_t channel, const void *data, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me && channel < CUSB_RTT_CHANNELS && (data || len == 0U)) );
+    uint32_t start;
+    /* Anything as long as the ring never fits. */
+    uint32_t n = (len < me->cb.up[channel].size) ? (uint32_t)len : UINT32_MAX;
+    bool ok = claim(me, channel, n, &start);
+
+    if (ok)
+    {
+        copy(&me->cb.up[channel], start, (const uint8_t *)data, n);
+    }
+
+    release(me, channel);
+    count(me, ok);
+    return ok;
+}
+
+bool cusb_rtt_log(struct cusb_rtt *me, const char *text)
+{
+    CUSB_ASSERT_PACKET( (text) );
+    return cusb_rtt_write(me, CUSB_RTT_LOG, text, strlen(text));
+}
+
+bool cusb_rtt_trace(struct cusb_rtt *me, uint16_t event, uint32_t arg)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    uint8_t record[CUSB_RTT_RECORD_SIZE];
+    uint32_t start;
+
+    if (!claim(me, CUSB_RTT_TRACE, CUSB_RTT_RECORD_SIZE, &start))
+    {
+        (void)ADD(&me->lost, 1U);
+        release(me, CUSB_RTT_TRACE);
+        count(me, false);
+        return false;
+    }
+
+    uint32_t time = me->now ? (*me->now)() : 0U;
+    uint32_t lost = (LOAD(&me->lost) != 0U) ? SWAP(&me->lost, 0U) : 0U;
+
+    lost = (lost > UINT16_MAX) ? UINT16_MAX : lost;
+    cusb_set_le32(&record[0], time);
+    cusb_set_le16(&record[4], event);
+    cusb_set_le16(&record[6], (uint16_t)lost);
+    cusb_set_le32(&record[8], arg);
+
+    copy(&me->cb.up[CUSB_RTT_TRACE], start, record, CUSB_RTT_RECORD_SIZE);
+    release(me, CUSB_RTT_TRACE);
+    count(me, true);
+    return true;
+}
+
+#if (CUSB_CFG_TRACE_RTT)
+void cusb_rtt_set_trace(struct cusb_rtt *me)
+{
+    __atomic_store_n(&trace_sink, me, __ATOMIC_RELEASE);
+}
+
+void cusb_trace(uint16_t event, uint32_t arg)
+{
+    struct cusb_rtt *sink = LOAD(&trace_sink);
+
+    if (sink)
+    {
+        (void)cusb_rtt_trace(sink, event, arg);
+    }
+}
+#endif
+
+size_t cusb_rtt_read(struct cusb_rtt *me, uint8_t channel, uint8_t *buf, size_t size)
+{
+    CUSB_ASSERT_API( (me && channel < CUSB_RTT_CHANNELS && (buf || size == 0U)) );
+    struct cusb_rtt_buffer *buffer = &me->cb.up[channel];
+    uint32_t wr = LOAD(&buffer->wr_off);
+    uint32_t rd = buffer->rd_off;
+    size_t taken = 0;
+
+    while (rd != wr && taken < size)
+    {
+        uint32_t run = (wr > rd) ? (wr - rd) : (buffer->size - rd);
+        run = (run < size - taken) ? run : (uint32_t)(size - taken);
+
+        memcpy(&buf[taken], &buffer->buf[rd], run);
+        taken += run;
+        rd += run;
+        rd = (rd == buffer->size) ? 0U : rd;
+    }
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    buffer->rd_off = rd;
+    return taken;
+}
+
+#if (CUSB_CFG_STATS)
+const struct cusb_rtt_stats *cusb_rtt_get_stats(const struct cusb_rtt *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+#endif
+
+#endif /* CUSB_CFG_RTT */
@@ -0,0 +1,978 @@
+/**
+ * @file
+ * @brief See @ref scsi.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/scsi.h"
+
+/* Endian accessors. */
+#include "cusb/endian.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_MSC)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/scsi.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Operation Codes
+ */
+/**@{*/
+#define OP_TEST_UNIT_READY              (0x00U)
+#define OP_REQUEST_SENSE                (0x03U)
+#define OP_INQUIRY                      (0x12U)
+#define OP_MODE_SENSE_6                 (0x1AU)
+#define OP_START_STOP_UNIT              (0x1BU)
+#define OP_PREVENT_ALLOW_REMOVAL        (0x1EU)
+#define OP_READ_FORMAT_CAPACITIES       (0x23U)
+#define OP_READ_CAPACITY_10             (0x25U)
+#define OP_READ_10                      (0x28U)
+#define OP_WRITE_10                     (0x2AU)
+#define OP_VERIFY_10                    (0x2FU)
+#define OP_SYNCHRONIZE_CACHE_10         (0x35U)
+#define OP_MODE_SENSE_10                (0x5AU)
+#define OP_READ_16                      (0x88U)
+#define OP_WRITE_16                     (0x8AU)
+#define OP_SYNCHRONIZE_CACHE_16         (0x91U)
+#define OP_SERVICE_ACTION_IN_16         (0x9EU)
+#define OP_REPORT_LUNS                  (0xA0U)
+/**@}*/
+
+/**
+ * @brief SERVICE ACTION IN(16) service action of READ CAPACITY(16).
+ */
+#define SA_READ_CAPACITY_16             (0x10U)
+
+/**
+ * @name Sense Keys
+ */
+/**@{*/
+#define SK_NO_SENSE                     (0x00U)
+#define SK_NOT_READY                    (0x02U)
+#define SK_MEDIUM_ERROR                 (0x03U)
+#define SK_ILLEGAL_REQUEST              (0x05U)
+#define SK_UNIT_ATTENTION               (0x06U)
+#define SK_DATA_PROTECT                 (0x07U)
+#define SK_ABORTED_COMMAND              (0x0BU)
+/**@}*/
+
+/**
+ * @name Additional Sense Codes
+ */
+/**@{*/
+#define ASC_WRITE_ERROR                 (0x0CU)
+#define ASC_UNRECOVERED_READ_ERROR      (0x11U)
+#define ASC_INVALID_OPCODE              (0x20U)
+#define ASC_LBA_OUT_OF_RANGE            (0x21U)
+#define ASC_INVALID_FIELD_IN_CDB        (0x24U)
+#define ASC_WRITE_PROTECTED             (0x27U)
+#define ASC_MEDIUM_CHANGED              (0x28U)
+#define ASC_MEDIUM_NOT_PRESENT          (0x3AU)
+#define ASC_DATA_PHASE_ERROR            (0x4BU)
+/**@}*/
+
+/**
+ * @brief Mode page code of the Caching mode page.
+ */
+#define MODE_PAGE_CACHING               (0x08U)
+
+/**
+ * @brief Mode page code that returns all mode pages.
+ */
+#define MODE_PAGE_ALL                   (0x3FU)
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief INQUIRY Supported VPD Pages page. Lists only itself.
+ */
+static const uint8_t VPD_SUPPORTED_PAGES[5] = {0x00U, 0x00U, 0x00U, 0x01U, 0x00U};
+
+/**
+ * @name REQUEST SENSE Responses
+ * @brief Fixed format sense data of the conditions REQUEST SENSE
+ * reports without a failed command.
+ */
+/**@{*/
+static const uint8_t SENSE_NONE[CUSB_SCSI_SENSE_SIZE] =
+{
+    0x70U, 0U, SK_NO_SENSE, 0U, 0U, 0U, 0U, CUSB_SCSI_SENSE_SIZE - 8U, 0U, 0U, 0U, 0U,
+    0U, 0U, 0U, 0U, 0U, 0U
+};
+
+static const uint8_t SENSE_MEDIUM_NOT_PRESENT[CUSB_SCSI_SENSE_SIZE] =
+{
+    0x70U, 0U, SK_NOT_READY, 0U, 0U, 0U, 0U, CUSB_SCSI_SENSE_SIZE - 8U, 0U, 0U, 0U, 0U,
+    ASC_MEDIUM_NOT_PRESENT, 0U, 0U, 0U, 0U, 0U
+};
+
+static const uint8_t SENSE_MEDIUM_CHANGED[CUSB_SCSI_SENSE_SIZE] =
+{
+    0x70U, 0U, SK_UNIT_ATTENTION, 0U, 0U, 0U, 0U, CUSB_SCSI_SENSE_SIZE - 8U, 0U, 0U, 0U, 0U,
+    ASC_MEDIUM_CHANGED, 0U, 0U, 0U, 0U, 0U
+};
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Ends @p task with GOOD status.
+ */
+static void succeed(struct cusb_scsi_task *task);
+
+/**
+ * @brief Ends @p task with CHECK CONDITION and the given sense.
+ */
+static void fail(struct cusb_scsi_task *task, uint8_t key, uint8_t asc, uint8_t ascq);
+
+/**
+ * @brief Starts the data-in phase of a response of @p len bytes
+ * at @p data, which must stay unchanged until the task is done.
+ */
+static void respond(struct cusb_scsi_task *task, const uint8_t *data, uint32_t len);
+
+/**
+ * @brief Returns true if media is present and has at least one block. A
+ * device that reports zero blocks is treated as having no media, since
+ * there is no last LBA to report.
+ */
+static bool has_media(const struct cusb_blockdev *dev);
+
+/**
+ * @brief Returns true if a unit attention must be reported for @p op,
+ * consuming it.
+ */
+static bool unit_attention(struct cusb_scsi *me, uint8_t op);
+
+/**
+ * @brief Builds fixed format sense data.
+ */
+static void build_sense(uint8_t *buf, const struct cusb_scsi_sense *sense);
+
+/**
+ * @brief Copies @p str into @p dst padded with spaces to @p len bytes.
+ */
+static void copy_padded(uint8_t *dst, const char *str, size_t len);
+
+/**
+ * @brief Rebuilds the media dependent cached responses if the media
+ * changed since they were built.
+ */
+static void refresh_cache(struct cusb_scsi *me);
+
+static void inquiry(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb);
+static void request_sense(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb);
+static void mode_sense(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb, bool ten);
+static void read_format_capacities(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb);
+static void read_capacity(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb, bool sixteen);
+static void report_luns(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb);
+
+/**
+ * @brief Validates a READ or WRITE and starts it.
+ */
+static void read_write(struct cusb_scsi *me, struct cusb_scsi_task *task, uint64_t lba, uint32_t blocks, bool write);
+
+/**
+ * @brief Submits the next backend request of a READ, WRITE or
+ * SYNCHRONIZE CACHE.
+ */
+static void submit(struct cusb_scsi_task *task, uint8_t op);
+
+/**
+ * @brief Number of blocks the next chunk of @p task covers.
+ */
+static uint32_t chunk_blocks(const struct cusb_scsi_task *task);
+
+/**
+ * @brief Where the next chunk of @p task lives. The media itself if the
+ * block device can map it, so data never passes through the task buffer.
+ * @p writing is true for WRITE data.
+ */
+static uint8_t *chunk_buffer(struct cusb_scsi_task *task, bool writing);
+
+/**
+ * @brief Backend completion handler.
+ */
+static void on_complete(struct cusb_blockdev_req *req, bool ok);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void succeed(struct cusb_scsi_task *task)
+{
+    task->status = CUSB_SCSI_STATUS_GOOD;
+    task->sense.key = SK_NO_SENSE;
+    task->sense.asc = 0;
+    task->sense.ascq = 0;
+    task->state = CUSB_SCSI_TASK_DONE;
+}
+
+static void fail(struct cusb_scsi_task *task, uint8_t key, uint8_t asc, uint8_t ascq)
+{
+    task->status = CUSB_SCSI_STATUS_CHECK_CONDITION;
+    task->sense.key = key;
+    task->sense.asc = asc;
+    task->sense.ascq = ascq;
+    task->target->sense = task->sense;
+    CUSB_TRACE(CUSB_TRACE_SCSI_CHECK_CONDITION, ((uint32_t)key << 16) | ((uint32_t)asc << 8) | ascq);
+    task->state = CUSB_SCSI_TASK_DONE;
+}
+
+static void respond(struct cusb_scsi_task *task, const uint8_t *data, uint32_t len)
+{
+    task->src = data;
+    task->xfer_len = (len < task->expected) ? len : task->expected;
+    task->buf_len = task->xfer_len;
+    task->buf_pos = 0;
+
+    if (task->xfer_len == 0U)
+    {
+        succeed(task);
+    }
+    else
+    {
+        task->state = CUSB_SCSI_TASK_DATA_IN;
+    }
+}
+
+static bool has_media(const struct cusb_blockdev *dev)
+{
+    return dev->present && dev->block_count != 0U;
+}
+
+static bool unit_attention(struct cusb_scsi *me, uint8_t op)
+{
+    if (op == OP_INQUIRY || op == OP_REQUEST_SENSE || op == OP_REPORT_LUNS)
+    {
+        return false;
+    }
+
+    if (me->generation == me->dev->generation)
+    {
+        return false;
+    }
+
+    me->generation = me->dev->generation;
+    return has_media(me->dev);
+}
+
+static void build_sense(uint8_t *buf, const struct cusb_scsi_sense *sense)
+{
+    memset(buf, 0, CUSB_SCSI_SENSE_SIZE);
+    buf[0] = 0x70U;
+    buf[2] = sense->key;
+    buf[7] = CUSB_SCSI_SENSE_SIZE - 8U;
+    buf[12] = sense->asc;
+    buf[13] = sense->ascq;
+}
+
+static void copy_padded(uint8_t *dst, const char *str, size_t len)
+{
+    size_t i = 0;
+
+    for (; i < len && str && str[i] != '\0'; i++)
+    {
+        dst[i] = (uint8_t)str[i];
+    }
+
+    for (; i < len; i++)
+    {
+        dst[i] = (uint8_t)' ';
+    }
+}
+
+static void refresh_cache(struct cusb_scsi *me)
+{
+    const struct cusb_blockdev *dev = me->dev;
+    uint8_t wp = dev->write_protected ? 0x80U : 0x00U;
+    bool media = has_media(dev);
+    uint32_t last_lba = media ? (dev->block_count - 1U) : 0U;
+
+    if (me->cache.generation == dev->generation)
+    {
+        return;
+    }
+
+    me->cache.generation = dev->generation;
+
+    cusb_set_be32(&me->cache.capacity_10[0], last_lba);
+    cusb_set_be32(&me->cache.capacity_10[4], dev->block_size);
+
+    memset(me->cache.capacity_16, 0, CUSB_SCSI_CAPACITY_16_SIZE);
+    cusb_set_be32(&me->cache.capacity_16[4], last_lba);
+    cusb_set_be32(&me->cache.capacity_16[8], dev->block_size);
+
+    memset(me->cache.format_capacities, 0, CUSB_SCSI_FORMAT_CAPACITIES_SIZE);
+    me->cache.format_capacities[3] = 8U;
+    cusb_set_be32(&me->cache.format_capacities[4], media ? dev->block_count : 0xFFFFFFFFUL);
+    cusb_set_be32(&me->cache.format_capacities[8], dev->block_size);
+
+    /* Descriptor type shares byte 8 with the 24-bit block length. Formatted or no media. */
+    me->cache.format_capacities[8] = media ? 0x02U : 0x03U;
+
+    /* Caching mode page. Write cache disabled, read cache enabled. */
+    memset(me->cache.mode_sense_6, 0, CUSB_SCSI_MODE_SENSE_6_SIZE);
+    me->cache.mode_sense_6[0] = CUSB_SCSI_MODE_SENSE_6_SIZE - 1U;
+    me->cache.mode_sense_6[2] = wp;
+    me->cache.mode_sense_6[4] = MODE_PAGE_CACHING;
+    me->cache.mode_sense_6[5] = 18U;
+
+    memset(me->cache.mode_sense_10, 0, CUSB_SCSI_MODE_SENSE_10_SIZE);
+    me->cache.mode_sense_10[1] = CUSB_SCSI_MODE_SENSE_10_SIZE - 2U;
+    me->cache.mode_sense_10[3] = wp;
+    me->cache.mode_sense_10[8] = MODE_PAGE_CACHING;
+    me->cache.mode_sense_10[9] = 18U;
+}
+
+static void inquiry(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb)
+{
+    task->expected = cusb_get_be16(&cdb[3]);
+
+    if ((cdb[1] & 0x01U) != 0U)
+    {
+        /* Only the Supported VPD Pages page. */
+        if (cdb[2] != 0x00U)
+        {
+            fail(task, SK_ILLEGAL_REQUEST, ASC_INVALID_FIELD_IN_CDB, 0);
+            return;
+        }
+
+        respond(task, VPD_SUPPORTED_PAGES, sizeof(VPD_SUPPORTED_PAGES));
+        return;
+    }
+
+    respond(task, me->cache.inquiry, CUSB_SCSI_INQUIRY_SIZE);
+}
+
+static void request_sense(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb)
+{
+    const uint8_t *data = SENSE_NONE;
+
+    task->expected = cdb[4];
+
+    if (me->sense.key != SK_NO_SENSE)
+    {
+        /* Sense of a failed command. Rare, so built on demand. */
+        build_sense(task->buf, &me->sense);
+        data = task->buf;
+    }
+
+    if (me->generation != me->dev->generation)
+    {
+        me->generation = me->dev->generation;
+        if (has_media(me->dev))
+        {
+            data = SENSE_MEDIUM_CHANGED;
+        }
+    }
+
+    if (!has_media(me->dev))
+    {
+        data = SENSE_MEDIUM_NOT_PRESENT;
+    }
+
+    me->sense.key = SK_NO_SENSE;
+    me->sense.asc = 0;
+    me->sense.ascq = 0;
+    respond(task, data, CUSB_SCSI_SENSE_SIZE);
+}
+
+static void mode_sense(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb, bool ten)
+{
+    uint8_t page = cdb[2] & 0x3FU;
+
+    task->expected = ten ? cusb_get_be16(&cdb[7]) : cdb[4];
+
+    if (page != MODE_PAGE_CACHING && page != MODE_PAGE_ALL)
+    {
+        fail(task, SK_ILLEGAL_REQUEST, ASC_INVALID_FIELD_IN_CDB, 0);
+        return;
+    }
+
+    refresh_cache(me);
+
+    if (ten)
+    {
+        respond(task, me->cache.mode_sense_10, CUSB_SCSI_MODE_SENSE_10_SIZE);
+    }
+    else
+    {
+        respond(task, me->cache.mode_sense_6, CUSB_SCSI_MODE_SENSE_6_SIZE);
+    }
+}
+
+static void read_format_capacities(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb)
+{
+    task->expected = cusb_get_be16(&cdb[7]);
+    refresh_cache(me);
+    respond(task, me->cache.format_capacities, CUSB_SCSI_FORMAT_CAPACITIES_SIZE);
+}
+
+static void read_capacity(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb, bool sixteen)
+{
+    refresh_cache(me);
+
+    if (sixteen)
+    {
+        task->expected = cusb_get_be32(&cdb[10]);
+        respond(task, me->cache.capacity_16, CUSB_SCSI_CAPACITY_16_SIZE);
+    }
+    else
+    {
+        task->expected = CUSB_SCSI_CAPACITY_10_SIZE;
+        respond(task, me->cache.capacity_10, CUSB_SCSI_CAPACITY_10_SIZE);
+    }
+}
+
+static void report_luns(struct cusb_scsi *me, struct cusb_scsi_task *task, const uint8_t *cdb)
+{
+    uint8_t *buf = task->buf;
+    uint32_t len = 8U + (8U * me->nluns);
+
+    task->expected = cusb_get_be32(&cdb[6]);
+    memset(buf, 0, len);
+    cusb_set_be32(&buf[0], len - 8U);
+
+    /* Peripheral device addressing. */
+    for (uint8_t lun = 0; lun < me->nluns; lun++)
+    {
+        buf[8U + (8U * lun) + 1U] = lun;
+    }
+
+    respond(task, buf, len);
+}
+
+static void read_write(struct cusb_scsi *me, struct cusb_scsi_task *task, uint64_t lba, uint32_t blocks, bool write)
+{
+    struct cusb_blockdev *dev = me->dev;
+
+    task->out = write;
+
+    if ((uint64_t)blocks > (UINT32_MAX / dev->block_size))
+    {
+        fail(task, SK_ILLEGAL_REQUEST, ASC_INVALID_FIELD_IN_CDB, 0);
+        return;
+    }
+
+    task->expected = blocks * dev->block_size;
+
+    if (lba > dev->block_count || (uint64_t)blocks > (dev->block_count - lba))
+    {
+        fail(task, SK_ILLEGAL_REQUEST, ASC_LBA_OUT_OF_RANGE, 0);
+        return;
+    }
+
+    if (write && dev->write_protected)
+    {
+        fail(task, SK_DATA_PROTECT, ASC_WRITE_PROTECTED, 0);
+        return;
+    }
+
+    task->xfer_len = task->expected;
+    task->lba = (uint32_t)lba;
+    task->blocks = blocks;
+
+    if (blocks == 0U)
+    {
+        succeed(task);
+    }
+    else if (write)
+    {
+        task->buf_len = chunk_blocks(task) * dev->block_size;
+        task->buf_pos = 0;
+        task->dst = chunk_buffer(task, true);
+        task->state = CUSB_SCSI_TASK_DATA_OUT;
+    }
+    else
+    {
+        submit(task, CUSB_BLOCKDEV_READ);
+    }
+}
+
+static void submit(struct cusb_scsi_task *task, uint8_t op)
+{
+    task->req.op = op;
+    task->req.lba = task->lba;
+    task->req.count = 0;
+    task->req.buf = task->buf;
+
+    if (op == CUSB_BLOCKDEV_READ)
+    {
+        task->req.count = chunk_blocks(task);
+        task->req.buf = chunk_buffer(task, false);
+    }
+    else if (op == CUSB_BLOCKDEV_WRITE)
+    {
+        task->req.count = chunk_blocks(task);
+        task->req.buf = task->dst;
+    }
+
+    task->state = CUSB_SCSI_TASK_WAIT;
+    cusb_blockdev_submit(task->target->dev, &task->req);
+}
+
+static uint32_t chunk_blocks(const struct cusb_scsi_task *task)
+{
+    uint32_t max = task->buf_size / task->target->dev->block_size;
+    return (task->blocks < max) ? task->blocks : max;
+}
+
+static uint8_t *chunk_buffer(struct cusb_scsi_task *task, bool writing)
+{
+    uint8_t *media = cusb_blockdev_map(task->target->dev, task->lba, chunk_blocks(task), writing);
+    return (media != NULL) ? media : task->buf;
+}
+
+static void on_complete(struct cusb_blockdev_req *req, bool ok)
+{
+    struct cusb_scsi_task *task = (struct cusb_scsi_task *)req->owner;
+    uint32_t block_size = task->target->dev->block_size;
+
+    CUSB_ASSERT_PACKET( (task->state == CUSB_SCSI_TASK_WAIT) );
+
+    if (task->aborted)
+    {
+        /* Transport may be waiting for the slot to free up. */
+        task->aborted = false;
+        task->state = CUSB_SCSI_TASK_IDLE;
+        (*task->notify)(task->notify_ctx, task);
+        return;
+    }
+
+    if (!ok)
+    {
+        if (req->op == CUSB_BLOCKDEV_READ)
+        {
+            fail(task, SK_MEDIUM_ERROR, ASC_UNRECOVERED_READ_ERROR, 0);
+        }
+        else
+        {
+            fail(task, SK_MEDIUM_ERROR, ASC_WRITE_ERROR, 0);
+        }
+    }
+    else if (req->op == CUSB_BLOCKDEV_READ)
+    {
+        task->lba += req->count;
+        task->blocks -= req->count;
+        task->src = req->buf;
+        task->buf_len = req->count * block_size;
+        task->buf_pos = 0;
+        task->state = CUSB_SCSI_TASK_DATA_IN;
+    }
+    else if (req->op == CUSB_BLOCKDEV_WRITE)
+    {
+        task->lba += req->count;
+        task->blocks -= req->count;
+
+        if (task->blocks == 0U)
+        {
+            succeed(task);
+        }
+        else if (cusb_scsi_task_data_out_left(task) == 0U)
+        {
+            /* Host ended the data phase while this chunk was written. */
+            fail(task, SK_ABORTED_COMMAND, ASC_DATA_PHASE_ERROR, 0);
+        }
+        else
+        {
+            task->buf_len = chunk_blocks(task) * block_size;
+            task->buf_pos = 0;
+            task->dst = chunk_buffer(task, true);
+            task->state = CUSB_SCSI_TASK_DATA_OUT;
+        }
+    }
+    else
+    {
+        succeed(task);
+    }
+
+    (*task->notify)(task->notify_ctx, task);
+}
+
+/*------------------------------------------------------------*/
+/*---------------------- SCSI MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+void cusb_scsi_ctor(struct cusb_scsi *me,
+                    struct cusb_blockdev *dev,
+                    const struct cusb_scsi_inquiry *inquiry)
+{
+    CUSB_ASSERT_API( (me && dev && inquiry) );
+
+    me->dev = dev;
+    me->inquiry = inquiry;
+    me->sense.key = SK_NO_SENSE;
+    me->sense.asc = 0;
+    me->sense.ascq = 0;
+    me->generation = dev->generation;
+    me->prevent_removal = false;
+    me->nluns = 1;
+
+    memset(me->cache.inquiry, 0, CUSB_SCSI_INQUIRY_SIZE);
+    me->cache.inquiry[1] = 0x80U;   /* Removable. */
+    me->cache.inquiry[2] = 0x06U;   /* SPC-4. */
+    me->cache.inquiry[3] = 0x02U;   /* Response data format. */
+    me->cache.inquiry[4] = CUSB_SCSI_INQUIRY_SIZE - 5U;
+    copy_padded(&me->cache.inquiry[8], inquiry->vendor, 8);
+    copy_padded(&me->cache.inquiry[16], inquiry->product, 16);
+    copy_padded(&me->cache.inquiry[32], inquiry->revision, 4);
+
+    /* Build the media dependent responses now. A generation that merely
+    differs would match again after the next media change. */
+    me->cache.generation = (uint8_t)(dev->generation + 1U);
+    refresh_cache(me);
+}
+
+void cusb_scsi_attach(struct cusb_scsi *luns, size_t nluns)
+{
+    CUSB_ASSERT_API( (luns) );
+    CUSB_ASSERT_API( (nluns != 0U && nluns <= CUSB_SCSI_LUN_MAX) );
+
+    for (size_t i = 0; i < nluns; i++)
+    {
+        luns[i].nluns = (uint8_t)nluns;
+    }
+}
+
+void cusb_scsi_task_ctor(struct cusb_scsi_task *task,
+                         uint8_t *buf,
+                         size_t buf_size,
+                         void (*notify)(void *ctx, struct cusb_scsi_task *task),
+                         void *notify_ctx)
+{
+    CUSB_ASSERT_API( (task && buf && notify) );
+    CUSB_ASSERT_API( (buf_size >= CUSB_SCSI_TASK_BUFFER_MIN && buf_size <= UINT32_MAX) );
+
+    memset(task, 0, sizeof(*task));
+    task->state = CUSB_SCSI_TASK_IDLE;
+    task->buf = buf;
+    task->buf_size = (uint32_t)buf_size;
+    task->notify = notify;
+    task->notify_ctx = notify_ctx;
+    task->req.done = &on_complete;
+    task->req.owner = task;
+}
+
+void cusb_scsi_task_start(struct cusb_scsi *me, struct cusb_scsi_task *task,
+                          const uint8_t *cdb, size_t cdb_len)
+{
+    CUSB_ASSERT_PACKET( (me && task && cdb) );
+    CUSB_ASSERT_PACKET( (cdb_len >= 6U && cdb_len <= 16U) );
+    CUSB_ASSERT_PACKET( (task->state == CUSB_SCSI_TASK_IDLE) );
+    CUSB_ASSERT_PACKET( ((task->buf_size % me->dev->block_size) == 0U) );
+
+    uint8_t op = cdb[0];
+
+    CUSB_TRACE(CUSB_TRACE_SCSI_COMMAND, op);
+    task->target = me;
+    task->src = task->buf;
+    task->dst = task->buf;
+    task->expected = 0;
+    task->xfer_len = 0;
+    task->xfer_done = 0;
+    task->buf_len = 0;
+    task->buf_pos = 0;
+    task->blocks = 0;
+    task->out = false;
+    task->aborted = false;
+
+    if (unit_attention(me, op))
+    {
+        fail(task, SK_UNIT_ATTENTION, ASC_MEDIUM_CHANGED, 0);
+        return;
+    }
+
+    switch (op)
+    {
+        case OP_INQUIRY:
+        {
+            inquiry(me, task, cdb);
+            return;
+        }
+
+        case OP_REQUEST_SENSE:
+        {
+            request_sense(me, task, cdb);
+            return;
+        }
+
+        case OP_REPORT_LUNS:
+        {
+            report_luns(me, task, cdb);
+            return;
+        }
+
+        case OP_MODE_SENSE_6:
+        case OP_MODE_SENSE_10:
+        {
+            mode_sense(me, task, cdb, (op == OP_MODE_SENSE_10));
+            return;
+        }
+
+        case OP_READ_FORMAT_CAPACITIES:
+        {
+            read_format_capacities(me, task, cdb);
+            return;
+        }
+
+        case OP_PREVENT_ALLOW_REMOVAL:
+        {
+            me->prevent_removal = ((cdb[4] & 0x01U) != 0U);
+            succeed(task);
+            return;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    /* Everything below needs media. */
+    if (!has_media(me->dev))
+    {
+        if (op == OP_TEST_UNIT_READY || op == OP_START_STOP_UNIT || op == OP_READ_CAPACITY_10 ||
+            op == OP_READ_10 || op == OP_WRITE_10 || op == OP_VERIFY_10 ||
+            op == OP_SYNCHRONIZE_CACHE_10 || op == OP_READ_16 || op == OP_WRITE_16 ||
+            op == OP_SYNCHRONIZE_CACHE_16 || op == OP_SERVICE_ACTION_IN_16)
+        {
+            fail(task, SK_NOT_READY, ASC_MEDIUM_NOT_PRESENT, 0);
+            return;
+        }
+    }
+
+    switch (op)
+    {
+        case OP_TEST_UNIT_READY:
+        case OP_START_STOP_UNIT:
+        case OP_VERIFY_10:
+        {
+            succeed(task);
+            break;
+        }
+
+        case OP_READ_CAPACITY_10:
+        {
+            read_capacity(me, task, cdb, false);
+            break;
+        }
+
+        case OP_SERVICE_ACTION_IN_16:
+        {
+            if ((cdb[1] & 0x1FU) == SA_READ_CAPACITY_16 && cdb_len >= 16U)
+            {
+                read_capacity(me, task, cdb, true);
+            }
+            else
+            {
+                fail(task, SK_ILLEGAL_REQUEST, ASC_INVALID_OPCODE, 0);
+            }
+            break;
+        }
+
+        case OP_READ_10:
+        case OP_WRITE_10:
+        {
+            read_write(me, task, cusb_get_be32(&cdb[2]), cusb_get_be16(&cdb[7]), (op == OP_WRITE_10));
+            break;
+        }
+
+        case OP_READ_16:
+        case OP_WRITE_16:
+        {
+            if (cdb_len < 16U)
+            {
+                fail(task, SK_ILLEGAL_REQUEST, ASC_INVALID_FIELD_IN_CDB, 0);
+                break;
+            }
+
+            read_write(me, task, ((uint64_t)cusb_get_be32(&cdb[2]) << 32) | cusb_get_be32(&cdb[6]),
+                       cusb_get_be32(&cdb[10]), (op == OP_WRITE_16));
+            break;
+        }
+
+        case OP_SYNCHRONIZE_CACHE_10:
+        case OP_SYNCHRONIZE_CACHE_16:
+        {
+            submit(task, CUSB_BLOCKDEV_SYNC);
+            break;
+        }
+
+        default:
+        {
+            fail(task, SK_ILLEGAL_REQUEST, ASC_INVALID_OPCODE, 0);
+            break;
+        }
+    }
+}
+
+size_t cusb_scsi_task_data_in(struct cusb_scsi_task *task, uint8_t *buf, size_t size)
+{
+    CUSB_ASSERT_PACKET( (task && buf) );
+    CUSB_ASSERT_PACKET( (task->state == CUSB_SCSI_TASK_DATA_IN) );
+
+    uint32_t n = task->buf_len - task->buf_pos;
+
+    if (n > size)
+    {
+        n = (uint32_t)size;
+    }
+
+    memcpy(buf, &task->src[task->buf_pos], n);
+    task->buf_pos += n;
+    task->xfer_done += n;
+
+    if (task->buf_pos == task->buf_len)
+    {
+        if (task->blocks != 0U)
+        {
+            submit(task, CUSB_BLOCKDEV_READ);
+        }
+        else
+        {
+            succeed(task);
+        }
+    }
+
+    return n;
+}
+
+void cusb_scsi_task_data_out(struct cusb_scsi_task *task, const uint8_t *data, size_t len)
+{
+    CUSB_ASSERT_PACKET( (task && (data || len == 0U)) );
+    CUSB_ASSERT_PACKET( (len <= cusb_scsi_task_data_out_left(task)) );
+
+    task->xfer_done += (uint32_t)len;
+
+    if (task->state == CUSB_SCSI_TASK_DONE)
+    {
+        /* Command already failed. Drop what is left of the data phase. */
+        return;
+    }
+
+    CUSB_ASSERT_PACKET( (task->state == CUSB_SCSI_TASK_DATA_OUT) );
+    CUSB_ASSERT_PACKET( (len <= (task->buf_len - task->buf_pos)) );
+
+    memcpy(&task->dst[task->buf_pos], data, len);
+    task->buf_pos += (uint32_t)len;
+
+    if (task->buf_pos == task->buf_len)
+    {
+        submit(task, CUSB_BLOCKDEV_WRITE);
+    }
+}
+
+void cusb_scsi_task_data_out_end(struct cusb_scsi_task *task)
+{
+    CUSB_ASSERT_PACKET( (task) );
+
+    /* Nothing else is coming. Whatever is still buffered is never written. */
+    task->xfer_len = task->xfer_done;
+
+    if (task->state == CUSB_SCSI_TASK_DATA_OUT)
+    {
+        fail(task, SK_ABORTED_COMMAND, ASC_DATA_PHASE_ERROR, 0);
+    }
+}
+
+uint32_t cusb_scsi_task_data_out_left(const struct cusb_scsi_task *task)
+{
+    CUSB_ASSERT_PACKET( (task) );
+    return task->out ? (task->xfer_len - task->xfer_done) : 0U;
+}
+
+uint32_t cusb_scsi_task_data_out_space(const struct cusb_scsi_task *task)
+{
+    CUSB_ASSERT_PACKET( (task) );
+
+    uint32_t left = cusb_scsi_task_data_out_left(task);
+    uint32_t space = left;
+
+    if (task->state == CUSB_SCSI_TASK_DATA_OUT)
+    {
+        space = task->buf_len - task->buf_pos;
+    }
+    else if (task->state != CUSB_SCSI_TASK_DONE)
+    {
+        space = 0;
+    }
+
+    return (space < left) ? space : left;
+}
+
+bool cusb_scsi_task_data_in_done(const struct cusb_scsi_task *task)
+{
+    CUSB_ASSERT_PACKET( (task) );
+    return task->out || task->state == CUSB_SCSI_TASK_DONE || task->xfer_done >= task->xfer_len;
+}
+
+uint32_t cusb_scsi_task_expected(const struct cusb_scsi_task *task)
+{
+    CUSB_ASSERT_PACKET( (task) );
+    return task->expected;
+}
+
+uint32_t cusb_scsi_task_transferred(const struct cusb_scsi_task *task)
+{
+    CUSB_ASSERT_PACKET( (task) );
+    return task->xfer_done;
+}
+
+void cusb_scsi_task_sense(const struct cusb_scsi_task *task, uint8_t *buf)
+{
+    CUSB_ASSERT_API( (task && buf) );
+    build_sense(buf, &task->sense);
+}
+
+void cusb_scsi_task_abort(struct cusb_scsi_task *task)
+{
+    CUSB_ASSERT_API( (task) );
+
+    if (task->state == CUSB_SCSI_TASK_WAIT)
+    {
+        task->aborted = true;
+    }
+    else
+    {
+        task->state = CUSB_SCSI_TASK_IDLE;
+    }
+}
+
+void cusb_scsi_task_free(struct cusb_scsi_task *task)
+{
+    CUSB_ASSERT_PACKET( (task) );
+    CUSB_ASSERT_PACKET( (task->state == CUSB_SCSI_TASK_DONE) );
+    task->state = CUSB_SCSI_TASK_IDLE;
+}
+
+#endif /* CUSB_CFG_MSC */
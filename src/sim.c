@@ -0,0 +1,798 @@
+/**
+ * @file
+ * @brief See @ref sim.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/sim.h"
+
+/* SETUP fields. */
+#include "cusb/setup.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/sim.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Status Bits
+ */
+/**@{*/
+#define STATUS_RESET                    ((uint32_t)1U << 0)
+#define STATUS_SETUP                    ((uint32_t)1U << 1)
+#define STATUS_SUSPEND                  ((uint32_t)1U << 2)
+#define STATUS_RESUME                   ((uint32_t)1U << 3)
+#define STATUS_SOF                      ((uint32_t)1U << 4)
+/**@}*/
+
+/**
+ * @brief Transfer complete bit of endpoint address @p ep.
+ */
+#define DONE_BIT(ep)                    ((uint32_t)1U << ((CUSB_EP_IS_IN(ep) ? 16U : 0U) + CUSB_EP_NUM(ep)))
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static inline struct cusb_sim_ep *endpoint(struct cusb_sim *me, uint8_t ep);
+
+/**
+ * @brief Asserts the interrupt line. Runs the irq function for as long
+ * as events are pending, like a level triggered interrupt would.
+ */
+static void raise(struct cusb_sim *me);
+
+static void complete(struct cusb_sim *me, uint8_t ep, struct cusb_sim_ep *e);
+
+/**
+ * @brief Sends an EP0 OUT packet until it is not NAKed, calling the
+ * idle function in between.
+ */
+static int retry_out(struct cusb_sim *me, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Sends EP0 IN tokens until one is not NAKed, calling the idle
+ * function in between.
+ */
+static int retry_in(struct cusb_sim *me, uint8_t *buf, uint16_t *len);
+
+#if (CUSB_CFG_DMA)
+/**
+ * @brief Returns true if endpoint address @p ep moves its data by DMA.
+ */
+static inline bool uses_dma(const struct cusb_sim *me, uint8_t ep);
+
+/**
+ * @brief FNV-1a over @p len bytes at @p p.
+ */
+static uint32_t hash(const uint8_t *p, uint32_t len);
+
+/**
+ * @brief Drops the packets of OUT endpoint number @p num from the
+ * receive FIFO.
+ */
+static void rx_purge(struct cusb_sim *me, uint8_t num);
+
+/**
+ * @brief Queues an OUT packet on a DMA endpoint. Returns the handshake.
+ */
+static int dma_out(struct cusb_sim *me, uint8_t ep, struct cusb_sim_ep *e, const uint8_t *data, uint16_t len);
+
+/**
+ * @brief Writes the packet at the head of the receive FIFO to memory.
+ */
+static void dma_write(struct cusb_sim *me);
+#endif
+
+static void dcd_connect(void *ctx, bool on);
+static void dcd_set_address(void *ctx, uint8_t addr);
+static void dcd_ep_open(void *ctx, uint8_t ep, uint8_t type, uint16_t mps);
+static void dcd_ep_close(void *ctx, uint8_t ep);
+static void dcd_ep_xfer(void *ctx, uint8_t ep, uint8_t *buf, uint32_t len);
+static void dcd_ep_stall(void *ctx, uint8_t ep, bool stall);
+static size_t dcd_service(void *ctx, size_t budget);
+static void dcd_irq_enable(void *ctx, bool on);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const struct cusb_dcd_api SIM_API =
+{
+    &dcd_connect,
+    &dcd_set_address,
+    &dcd_ep_open,
+    &dcd_ep_close,
+    &dcd_ep_xfer,
+    &dcd_ep_stall,
+    &dcd_service,
+    &dcd_irq_enable
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static inline struct cusb_sim_ep *endpoint(struct cusb_sim *me, uint8_t ep)
+{
+    CUSB_ASSERT_PACKET( (CUSB_EP_NUM(ep) < CUSB_CFG_ENDPOINTS) );
+    return &me->ep[CUSB_EP_IS_IN(ep) ? 1 : 0][CUSB_EP_NUM(ep)];
+}
+
+static void raise(struct cusb_sim *me)
+{
+    if (!me->irq || me->in_irq)
+    {
+        return;
+    }
+
+    me->in_irq = true;
+
+    while (me->irq_enabled && (me->status | me->done) != 0U)
+    {
+        me->stats.interrupts++;
+        (*me->irq)(me->irq_obj);
+    }
+
+    me->in_irq = false;
+}
+
+static void complete(struct cusb_sim *me, uint8_t ep, struct cusb_sim_ep *e)
+{
+    e->armed = false;
+
+    if (ep == CUSB_EP_DIR_IN && e->len == 0U && me->address_pending)
+    {
+        /* Status stage of SET_ADDRESS. */
+        me->address = me->new_address;
+        me->address_pending = false;
+    }
+
+    me->done |= DONE_BIT(ep);
+    raise(me);
+}
+
+static int retry_out(struct cusb_sim *me, const uint8_t *data, uint16_t len)
+{
+    int hs = CUSB_SIM_NAK;
+
+    for (uint32_t i = 0; i < CUSB_SIM_RETRIES && hs == CUSB_SIM_NAK; i++)
+    {
+        hs = cusb_sim_host_out(me, 0x00U, data, len);
+
+        if (hs == CUSB_SIM_NAK && me->idle)
+        {
+            (*me->idle)(me->idle_obj);
+        }
+    }
+
+    return (hs == CUSB_SIM_NAK) ? CUSB_SIM_TIMEOUT : hs;
+}
+
+static int retry_in(struct cusb_sim *me, uint8_t *buf, uint16_t *len)
+{
+    int hs = CUSB_SIM_NAK;
+
+    for (uint32_t i = 0; i < CUSB_SIM_RETRIES && hs == CUSB_SIM_NAK; i++)
+    {
+        hs = cusb_sim_host_in(me, CUSB_EP_DIR_IN, buf, len);
+
+        if (hs == CUSB_SIM_NAK && me->idle)
+        {
+            (*me->idle)(me->idle_obj);
+        }
+    }
+
+    return (hs == CUSB_SIM_NAK) ? CUSB_SIM_TIMEOUT : hs;
+}
+
+#if (CUSB_CFG_DMA)
+static inline bool uses_dma(const struct cusb_sim *me, uint8_t ep)
+{
+    return me->dcd.dma && CUSB_EP_NUM(ep) != 0U;
+}
+
+static uint32_t hash(const uint8_t *p, uint32_t len)
+{
+    uint32_t h = 2166136261UL;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        h = (h ^ p[i]) * 16777619UL;
+    }
+
+    return h;
+}
+
+static void rx_purge(struct cusb_sim *me, uint8_t num)
+{
+    uint16_t kept = 0;
+
+    for (uint16_t at = 0; at < me->rx_used;)
+    {
+        uint16_t size = (uint16_t)(3U + me->rx[at + 1U] + ((uint16_t)me->rx[at + 2U] << 8));
+
+        if ((me->rx[at] & 0x0FU) != num)
+        {
+            memmove(&me->rx[kept], &me->rx[at], size);
+            kept = (uint16_t)(kept + size);
+        }
+
+        at = (uint16_t)(at + size);
+    }
+
+    me->rx_used = kept;
+}
+
+static int dma_out(struct cusb_sim *me, uint8_t ep, struct cusb_sim_ep *e, const uint8_t *data, uint16_t len)
+{
+    if (!e->armed || me->rx_used + 3U + len > CUSB_SIM_RX_FIFO)
+    {
+        me->stats.naks++;
+        return CUSB_SIM_NAK;
+    }
+
+    CUSB_ASSERT_PACKET( (len <= e->mps) );
+    uint32_t room = e->len - e->dma;
+
+    if (len > room)
+    {
+        /* Babble. Keep what fits and fail the transfer. */
+        e->ok = false;
+        len = (uint16_t)room;
+    }
+
+    e->dma += len;
+    bool last = (len < e->mps || e->dma == e->len);
+    uint8_t *entry = &me->rx[me->rx_used];
+
+    entry[0] = (uint8_t)(CUSB_EP_NUM(ep) | (last ? 0x80U : 0U));
+    entry[1] = (uint8_t)len;
+    entry[2] = (uint8_t)(len >> 8);
+
+    if (len != 0U)
+    {
+        memcpy(&entry[3], data, len);
+    }
+
+    me->rx_used = (uint16_t)(me->rx_used + 3U + len);
+    me->stats.packets++;
+
+    if (last)
+    {
+        /* Later packets are NAKed, the completion waits for the engine. */
+        e->armed = false;
+        e->dma_busy = true;
+    }
+
+    return CUSB_SIM_ACK;
+}
+
+static void dma_write(struct cusb_sim *me)
+{
+    uint8_t num = me->rx[0] & 0x0FU;
+    bool last = ((me->rx[0] & 0x80U) != 0U);
+    uint16_t len = (uint16_t)(me->rx[1] + ((uint16_t)me->rx[2] << 8));
+    struct cusb_sim_ep *e = &me->ep[0][num];
+
+    if (len != 0U)
+    {
+        memcpy(&e->buf[e->count], &me->rx[3], len);
+    }
+
+    e->count += len;
+    me->rx_used = (uint16_t)(me->rx_used - 3U - len);
+    memmove(me->rx, &me->rx[3U + len], me->rx_used);
+    me->stats.dma_packets++;
+
+    if (last)
+    {
+        /* Whole granules are written. */
+        for (uint32_t i = e->count; (i & (me->dma.granule - 1U)) != 0U && i < e->len; i++)
+        {
+            e->buf[i] = 0xA5U;
+        }
+
+        e->dma_busy = false;
+        complete(me, num, e);
+    }
+}
+#endif
+
+static void dcd_connect(void *ctx, bool on)
+{
+    struct cusb_sim *me = (struct cusb_sim *)ctx;
+    me->connected = on;
+}
+
+static void dcd_set_address(void *ctx, uint8_t addr)
+{
+    struct cusb_sim *me = (struct cusb_sim *)ctx;
+    me->new_address = addr;
+    me->address_pending = true;
+}
+
+static void dcd_ep_open(void *ctx, uint8_t ep, uint8_t type, uint16_t mps)
+{
+    struct cusb_sim *me = (struct cusb_sim *)ctx;
+    struct cusb_sim_ep *e = endpoint(me, ep);
+    (void)type;
+
+    CUSB_ASSERT_INTERNAL( (mps > 0U) );
+    memset(e, 0, sizeof(*e));
+    e->mps = mps;
+    e->open = true;
+}
+
+static void dcd_ep_close(void *ctx, uint8_t ep)
+{
+    struct cusb_sim *me = (struct cusb_sim *)ctx;
+#if (CUSB_CFG_DMA)
+    if (!CUSB_EP_IS_IN(ep))
+    {
+        rx_purge(me, CUSB_EP_NUM(ep));
+    }
+#endif
+    memset(endpoint(me, ep), 0, sizeof(struct cusb_sim_ep));
+    me->done &= ~DONE_BIT(ep);
+}
+
+static void dcd_ep_xfer(void *ctx, uint8_t ep, uint8_t *buf, uint32_t len)
+{
+    struct cusb_sim *me = (struct cusb_sim *)ctx;
+    struct cusb_sim_ep *e = endpoint(me, ep);
+
+    CUSB_ASSERT_PACKET( (e->open && !e->armed) );
+    e->buf = buf;
+    e->len = len;
+    e->count = 0;
+    e->ok = true;
+    e->armed = true;
+
+#if (CUSB_CFG_DMA)
+    if (uses_dma(me, ep))
+    {
+        /* The engine would fault. */
+        CUSB_ASSERT_PACKET( (((uintptr_t)buf & (me->dma.align - 1U)) == 0U && len <= me->dma.max_len) );
+        CUSB_ASSERT_PACKET( (CUSB_EP_IS_IN(ep) || (len & (me->dma.granule - 1U)) == 0U) );
+        CUSB_ASSERT_PACKET( (!e->dma_busy) );
+        e->dma = 0;
+        e->dma_busy = CUSB_EP_IS_IN(ep);
+        e->hash = CUSB_EP_IS_IN(ep) ? hash(buf, len) : 0U;
+    }
+#endif
+}
+
+static void dcd_ep_stall(void *ctx, uint8_t ep, bool stall)
+{
+    struct cusb_sim *me = (struct cusb_sim *)ctx;
+    endpoint(me, ep)->stalled = stall;
+}
+
+static size_t dcd_service(void *ctx, size_t budget)
+{
+    struct cusb_sim *me = (struct cusb_sim *)ctx;
+    size_t n = 0;
+
+    /* Order a driver would check its status register in: reset voids
+    everything after it, and a SETUP cancels EP0 completions. */
+    for (; n < budget; n++)
+    {
+        uint32_t status = me->status;
+        uint32_t done = me->done;
+
+        if ((status & STATUS_RESET) != 0U)
+        {
+            me->status &= ~STATUS_RESET;
+            cusb_dcd_bus_reset(&me->dcd, me->speed);
+        }
+        else if ((status & STATUS_SETUP) != 0U)
+        {
+            me->status &= ~STATUS_SETUP;
+            cusb_dcd_setup(&me->dcd, me->setup);
+        }
+        else if (done != 0U)
+        {
+            uint8_t bit = 0;
+
+            while ((done & ((uint32_t)1U << bit)) == 0U)
+            {
+                bit++;
+            }
+
+            uint8_t ep = (uint8_t)((bit >= 16U) ? (CUSB_EP_DIR_IN | (bit - 16U)) : bit);
+            const struct cusb_sim_ep *e = endpoint(me, ep);
+
+            me->done &= ~((uint32_t)1U << bit);
+            cusb_dcd_xfer_done(&me->dcd, ep, e->count, e->ok);
+        }
+        else if ((status & STATUS_SUSPEND) != 0U)
+        {
+            me->status &= ~STATUS_SUSPEND;
+            cusb_dcd_suspend(&me->dcd);
+        }
+        else if ((status & STATUS_RESUME) != 0U)
+        {
+            me->status &= ~STATUS_RESUME;
+            cusb_dcd_resume(&me->dcd);
+        }
+        else if ((status & STATUS_SOF) != 0U)
+        {
+            me->status &= ~STATUS_SOF;
+            cusb_dcd_sof(&me->dcd, me->frame);
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return n;
+}
+
+static void dcd_irq_enable(void *ctx, bool on)
+{
+    struct cusb_sim *me = (struct cusb_sim *)ctx;
+    me->irq_enabled = on;
+
+    if (on)
+    {
+        raise(me);
+    }
+}
+
+/*------------------------------------------------------------*/
+/*---------------------- SIM MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_sim_ctor(struct cusb_sim *me, uint8_t speed, void (*irq)(void *obj), void *irq_obj)
+{
+    CUSB_ASSERT_API( (me) );
+    CUSB_ASSERT_API( (speed == CUSB_SPEED_FULL || speed == CUSB_SPEED_HIGH) );
+
+    memset(me, 0, sizeof(*me));
+    cusb_dcd_ctor(&me->dcd, &SIM_API, me);
+    me->speed = speed;
+    me->irq = irq;
+    me->irq_obj = irq_obj;
+}
+
+void cusb_sim_set_idle(struct cusb_sim *me, void (*idle)(void *obj), void *obj)
+{
+    CUSB_ASSERT_API( (me) );
+    me->idle = idle;
+    me->idle_obj = obj;
+}
+
+void cusb_sim_host_reset(struct cusb_sim *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (!me->connected)
+    {
+        return;
+    }
+
+    memset(me->ep, 0, sizeof(me->ep));
+#if (CUSB_CFG_DMA)
+    me->rx_used = 0;
+#endif
+    me->ep[0][0].mps = CUSB_CFG_EP0_SIZE;
+    me->ep[0][0].open = true;
+    me->ep[1][0].mps = CUSB_CFG_EP0_SIZE;
+    me->ep[1][0].open = true;
+    me->address = 0;
+    me->address_pending = false;
+    me->done = 0;
+    me->status = STATUS_RESET;
+    raise(me);
+}
+
+void cusb_sim_host_setup(struct cusb_sim *me, const uint8_t *setup)
+{
+    CUSB_ASSERT_API( (me && setup) );
+
+    for (uint8_t dir = 0; dir < 2U; dir++)
+    {
+        me->ep[dir][0].armed = false;
+        me->ep[dir][0].stalled = false;
+    }
+
+    memcpy(me->setup, setup, sizeof(me->setup));
+    me->done &= ~(DONE_BIT(0x00U) | DONE_BIT(CUSB_EP_DIR_IN));
+    me->status |= STATUS_SETUP;
+    raise(me);
+}
+
+int cusb_sim_host_out(struct cusb_sim *me, uint8_t ep, const uint8_t *data, uint16_t len)
+{
+    CUSB_ASSERT_PACKET( (me && !CUSB_EP_IS_IN(ep)) );
+    CUSB_ASSERT_PACKET( (data || len == 0U) );
+
+    struct cusb_sim_ep *e = endpoint(me, ep);
+
+    if (!me->connected || !e->open)
+    {
+        return CUSB_SIM_TIMEOUT;
+    }
+
+    if (e->stalled)
+    {
+        return CUSB_SIM_STALL;
+    }
+
+#if (CUSB_CFG_DMA)
+    if (uses_dma(me, ep))
+    {
+        return dma_out(me, ep, e, data, len);
+    }
+#endif
+
+    if (!e->armed)
+    {
+        me->stats.naks++;
+        return CUSB_SIM_NAK;
+    }
+
+    CUSB_ASSERT_PACKET( (len <= e->mps) );
+    uint32_t room = e->len - e->count;
+
+    if (len > room)
+    {
+        /* Babble. Keep what fits and fail the transfer. */
+        e->ok = false;
+        len = (uint16_t)room;
+    }
+
+    if (len != 0U)
+    {
+        memcpy(&e->buf[e->count], data, len);
+    }
+
+    e->count += len;
+    me->stats.packets++;
+
+    if (len < e->mps || e->count == e->len)
+    {
+        complete(me, ep, e);
+    }
+
+    return CUSB_SIM_ACK;
+}
+
+int cusb_sim_host_in(struct cusb_sim *me, uint8_t ep, uint8_t *buf, uint16_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && buf && len && CUSB_EP_IS_IN(ep)) );
+
+    struct cusb_sim_ep *e = endpoint(me, ep);
+
+    if (!me->connected || !e->open)
+    {
+        return CUSB_SIM_TIMEOUT;
+    }
+
+    if (e->stalled)
+    {
+        return CUSB_SIM_STALL;
+    }
+
+    if (!e->armed)
+    {
+        me->stats.naks++;
+        return CUSB_SIM_NAK;
+    }
+
+    uint32_t n = e->len - e->count;
+
+    if (n > e->mps)
+    {
+        n = e->mps;
+    }
+
+#if (CUSB_CFG_DMA)
+    if (uses_dma(me, ep) && (e->dma - e->count < n || (n == 0U && e->dma_busy)))
+    {
+        /* Packet not fetched yet. */
+        me->stats.naks++;
+        return CUSB_SIM_NAK;
+    }
+#endif
+
+    if (n != 0U)
+    {
+        memcpy(buf, &e->buf[e->count], n);
+    }
+
+    *len = (uint16_t)n;
+    e->count += n;
+    me->stats.packets++;
+
+    if (n < e->mps || e->count == e->len)
+    {
+#if (CUSB_CFG_DMA)
+        CUSB_ASSERT_PACKET( (!uses_dma(me, ep) || hash(e->buf, e->len) == e->hash) );
+#endif
+        complete(me, ep, e);
+    }
+
+    return CUSB_SIM_ACK;
+}
+
+int cusb_sim_host_control(struct cusb_sim *me, const uint8_t *setup, uint8_t *data, uint16_t *len)
+{
+    CUSB_ASSERT_API( (me && setup) );
+
+    uint16_t wlength = cusb_setup_length(setup);
+    uint16_t moved = 0;
+    uint16_t n = 0;
+    int hs = CUSB_SIM_ACK;
+
+    CUSB_ASSERT_API( (data || wlength == 0U) );
+
+    if (!me->connected)
+    {
+        return CUSB_SIM_TIMEOUT;
+    }
+
+    cusb_sim_host_setup(me, setup);
+
+    if ((cusb_setup_request_type(setup) & CUSB_SETUP_DIR_IN) != 0U && wlength != 0U)
+    {
+        /* Data stage ends on a short packet or once wLength arrived. */
+        do
+        {
+            hs = retry_in(me, &data[moved], &n);
+            moved = (uint16_t)(moved + n);
+        } while (hs == CUSB_SIM_ACK && n == CUSB_CFG_EP0_SIZE && moved < wlength);
+
+        if (hs == CUSB_SIM_ACK)
+        {
+            hs = retry_out(me, NULL, 0);
+        }
+    }
+    else
+    {
+        while (hs == CUSB_SIM_ACK && moved < wlength)
+        {
+            n = (uint16_t)(wlength - moved);
+            n = (n > CUSB_CFG_EP0_SIZE) ? (uint16_t)CUSB_CFG_EP0_SIZE : n;
+            hs = retry_out(me, &data[moved], n);
+            moved = (uint16_t)(moved + n);
+        }
+
+        if (hs == CUSB_SIM_ACK)
+        {
+            uint8_t zlp[CUSB_CFG_EP0_SIZE];
+            hs = retry_in(me, zlp, &n);
+        }
+    }
+
+    if (len)
+    {
+        *len = moved;
+    }
+
+    return hs;
+}
+
+void cusb_sim_host_sof(struct cusb_sim *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+
+    if (!me->connected)
+    {
+        return;
+    }
+
+    me->frame = (uint16_t)((me->frame + 1U) & 0x7FFU);
+    me->status |= STATUS_SOF;
+    raise(me);
+}
+
+void cusb_sim_host_suspend(struct cusb_sim *me, bool suspend)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (!me->connected)
+    {
+        return;
+    }
+
+    me->status = (me->status & ~(STATUS_SUSPEND | STATUS_RESUME)) | (suspend ? STATUS_SUSPEND : STATUS_RESUME);
+    raise(me);
+}
+
+uint8_t cusb_sim_get_address(const struct cusb_sim *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->address;
+}
+
+bool cusb_sim_is_connected(const struct cusb_sim *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return me->connected;
+}
+
+bool cusb_sim_is_stalled(const struct cusb_sim *me, uint8_t ep)
+{
+    CUSB_ASSERT_API( (me && CUSB_EP_NUM(ep) < CUSB_CFG_ENDPOINTS) );
+    return me->ep[CUSB_EP_IS_IN(ep) ? 1 : 0][CUSB_EP_NUM(ep)].stalled;
+}
+
+bool cusb_sim_pending(const struct cusb_sim *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return (me->status | me->done) != 0U;
+}
+
+const struct cusb_sim_stats *cusb_sim_get_stats(const struct cusb_sim *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+
+#if (CUSB_CFG_DMA)
+void cusb_sim_set_dma(struct cusb_sim *me, const struct cusb_dcd_dma *dma)
+{
+    CUSB_ASSERT_API( (me && dma && !me->dcd.dev) );
+    me->dma = *dma;
+    cusb_dcd_set_dma(&me->dcd, &me->dma);
+}
+
+size_t cusb_sim_dma_run(struct cusb_sim *me, size_t budget)
+{
+    CUSB_ASSERT_PACKET( (me && me->dcd.dma) );
+    size_t n = 0;
+    size_t before = SIZE_MAX;
+
+    /* Each pass writes one received packet, then fetches one packet for
+    every IN endpoint with room in its FIFO. */
+    while (n < budget && n != before)
+    {
+        before = n;
+
+        if (me->rx_used != 0U)
+        {
+            dma_write(me);
+            n++;
+        }
+
+        for (uint8_t num = 1; num < CUSB_CFG_ENDPOINTS && n < budget; num++)
+        {
+            struct cusb_sim_ep *e = &me->ep[1][num];
+
+            if (e->armed && e->dma_busy && e->dma - e->count < 2U * (uint32_t)e->mps)
+            {
+                uint32_t chunk = e->len - e->dma;
+                e->dma += (chunk > e->mps) ? e->mps : chunk;
+                e->dma_busy = (e->dma != e->len);
+                me->stats.dma_packets++;
+                n++;
+            }
+        }
+    }
+
+    return n;
+}
+#endif
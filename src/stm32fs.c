@@ -0,0 +1,885 @@
+/**
+ * @file
+ * @brief See @ref stm32fs.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/stm32fs.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/stm32fs.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Bus Access
+ * Registers and PMA are accessed 16 bits at a time.
+ */
+/**@{*/
+#define REG(off)                        ((uint32_t)(CUSB_STM32FS_BASE + (off)))
+#if defined(CUSB_UNIT_TEST)
+#define RD(addr)                        cusb_stm32fs_read(addr)
+#define WR(addr, val)                   cusb_stm32fs_write((addr), (uint16_t)(val))
+#else
+#define RD(addr)                        (*(volatile uint16_t *)(uintptr_t)(addr))
+#define WR(addr, val)                   (*(volatile uint16_t *)(uintptr_t)(addr) = (uint16_t)(val))
+#endif
+/**@}*/
+
+/**
+ * @name Registers
+ */
+/**@{*/
+#define EPR(n)                          REG(4U * (uint32_t)(n))
+#define CNTR                            REG(0x40U)
+#define ISTR                            REG(0x44U)
+#define FNR                             REG(0x48U)
+#define DADDR                           REG(0x4CU)
+#define BTABLE                          REG(0x50U)
+#define BCDR                            REG(0x58U)
+#define PMA(off)                        REG(0x400U + (uint32_t)(off))
+/**@}*/
+
+/**
+ * @name EPnR Bits
+ * RX fields are the TX fields shifted up by 8. CTR flags clear when
+ * written 0, DTOG and STAT toggle when written 1, the rest is read-write.
+ */
+/**@{*/
+#define EPR_CTR_TX                      ((uint16_t)0x0080U)
+#define EPR_DTOG_TX                     ((uint16_t)0x0040U)
+#define EPR_STAT_TX                     ((uint16_t)0x0030U)
+#define EPR_CTR_RX                      ((uint16_t)0x8000U)
+#define EPR_DTOG_RX                     ((uint16_t)0x4000U)
+#define EPR_STAT_RX                     ((uint16_t)0x3000U)
+#define EPR_SETUP                       ((uint16_t)0x0800U)
+#define EPR_KIND                        ((uint16_t)0x0100U)     /**< DBL_BUF for bulk. */
+#define EPR_RW                          ((uint16_t)0x070FU)     /**< EP_TYPE, EP_KIND and EA. */
+#define EPR_CTR                         ((uint16_t)(EPR_CTR_TX | EPR_CTR_RX))
+#define EPR_TYPE_BULK                   ((uint16_t)0x0000U)
+#define EPR_TYPE_CONTROL                ((uint16_t)0x0200U)
+#define EPR_TYPE_ISO                    ((uint16_t)0x0400U)
+#define EPR_TYPE_INTERRUPT              ((uint16_t)0x0600U)
+#define STAT_DISABLED                   (0U)
+#define STAT_STALL                      (1U)
+#define STAT_NAK                        (2U)
+#define STAT_VALID                      (3U)
+/**@}*/
+
+/**
+ * @brief Shifts a TX field of EPnR to direction @p in.
+ */
+#define DIR(in, bits)                   ((uint16_t)((in) ? (bits) : ((bits) << 8)))
+
+/**
+ * @brief STAT field of direction @p in holding @p s.
+ */
+#define STAT(in, s)                     DIR(in, (s) << 4)
+
+/**
+ * @brief Toggle bits that take the fields in @p mask of EPnR value @p v
+ * to @p val.
+ */
+#define TO(v, mask, val)                ((uint16_t)(((v) ^ (val)) & (mask)))
+
+/**
+ * @name CNTR and ISTR Bits
+ * Interrupt masks share their position with the ISTR flag they mask.
+ */
+/**@{*/
+#define IRQ_CTR                         ((uint16_t)0x8000U)
+#define IRQ_WKUP                        ((uint16_t)0x1000U)
+#define IRQ_SUSP                        ((uint16_t)0x0800U)
+#define IRQ_RESET                       ((uint16_t)0x0400U)
+#define IRQ_SOF                         ((uint16_t)0x0200U)
+#define ISTR_EP_ID                      ((uint16_t)0x000FU)
+#define CNTR_FSUSP                      ((uint16_t)0x0008U)
+#define CNTR_FRES                       ((uint16_t)0x0001U)
+#define DADDR_EF                        ((uint16_t)0x0080U)
+#define BCDR_DPPU                       ((uint16_t)0x8000U)
+#define FNR_FN                          ((uint16_t)0x07FFU)
+/**@}*/
+
+/**
+ * @name Buffer Table
+ * One entry per endpoint register at PMA offset 0. Slot 0 holds the TX
+ * buffer, slot 1 the RX buffer, and a double-buffered endpoint uses both
+ * for its one direction.
+ */
+/**@{*/
+#define BT_ADDR(n, slot)                ((uint32_t)(8U * (uint32_t)(n) + 4U * (uint32_t)(slot)))
+#define BT_COUNT(n, slot)               (BT_ADDR(n, slot) + 2U)
+#define COUNT_MASK                      ((uint16_t)0x03FFU)
+#define COUNT_BL_SIZE                   ((uint16_t)0x8000U)
+/**@}*/
+
+/**
+ * @name PMA Layout
+ * Offset of the buffer pair of every endpoint number, right after the
+ * buffer table.
+ */
+/**@{*/
+#define EP_BYTES(n)                     (((n) < CUSB_STM32FS_ENDPOINTS) ? CUSB_STM32FS_PMA_EP##n : 0U)
+#define PMA_EP0                         (8U * CUSB_STM32FS_ENDPOINTS)
+#define PMA_EP1                         (PMA_EP0 + 2U * CUSB_CFG_EP0_SIZE)
+#define PMA_EP2                         (PMA_EP1 + 2U * EP_BYTES(1))
+#define PMA_EP3                         (PMA_EP2 + 2U * EP_BYTES(2))
+#define PMA_EP4                         (PMA_EP3 + 2U * EP_BYTES(3))
+#define PMA_EP5                         (PMA_EP4 + 2U * EP_BYTES(4))
+#define PMA_EP6                         (PMA_EP5 + 2U * EP_BYTES(5))
+#define PMA_EP7                         (PMA_EP6 + 2U * EP_BYTES(6))
+#define PMA_END                         (PMA_EP7 + 2U * EP_BYTES(7))
+/**@}*/
+
+/**
+ * @brief True if the RX count field cannot describe a buffer of @p bytes.
+ */
+#define BAD_BUFFER(bytes)               ((((bytes) % 2U) != 0U) || ((bytes) > 62U && ((bytes) % 32U) != 0U) || (bytes) > 1024U)
+
+#if (PMA_END > CUSB_STM32FS_PMA_SIZE)
+#error "CUSB_STM32FS_PMA_EPn buffers do not fit in the packet memory."
+#endif
+
+#if BAD_BUFFER(CUSB_STM32FS_PMA_EP1) || BAD_BUFFER(CUSB_STM32FS_PMA_EP2) || BAD_BUFFER(CUSB_STM32FS_PMA_EP3) || \
+    BAD_BUFFER(CUSB_STM32FS_PMA_EP4) || BAD_BUFFER(CUSB_STM32FS_PMA_EP5) || BAD_BUFFER(CUSB_STM32FS_PMA_EP6) || \
+    BAD_BUFFER(CUSB_STM32FS_PMA_EP7)
+#error "CUSB_STM32FS_PMA_EPn must be even, and a multiple of 32 above 62."
+#endif
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static inline struct cusb_stm32fs_ep *endpoint(struct cusb_stm32fs *me, uint8_t ep);
+
+/**
+ * @brief PMA offset of buffer @p slot of endpoint number @p num.
+ */
+static inline uint16_t buffer(uint8_t num, uint8_t slot);
+
+/**
+ * @brief Writes endpoint register @p num: read-write fields @p rw, CTR
+ * flags in @p clear cleared, DTOG and STAT bits in @p toggle toggled.
+ * Everything else is left as the hardware has it.
+ */
+static inline void epr_write(uint8_t num, uint16_t rw, uint16_t clear, uint16_t toggle);
+
+/**
+ * @brief Writes CNTR, with the interrupt sources unmasked unless the
+ * stack runs polled or a deferred interrupt is pending.
+ */
+static void cntr_write(const struct cusb_stm32fs *me);
+
+static void pma_write(uint16_t addr, const uint8_t *src, uint32_t len);
+static void pma_read(uint16_t addr, uint8_t *dst, uint32_t len);
+
+/**
+ * @brief RX count field value describing a buffer of @p bytes.
+ */
+static uint16_t rx_blocks(uint16_t bytes);
+
+/**
+ * @brief Copies the next packet of IN endpoint @p e to buffer @p slot.
+ * Returns its length.
+ */
+static uint16_t in_load(uint8_t num, struct cusb_stm32fs_ep *e, uint8_t slot);
+
+/**
+ * @brief Hands the first packets of IN endpoint @p e, from byte
+ * count on, to the hardware.
+ */
+static void in_start(uint8_t num, struct cusb_stm32fs_ep *e);
+
+/**
+ * @brief Lets OUT endpoint @p e receive.
+ */
+static void out_start(uint8_t num, struct cusb_stm32fs_ep *e);
+
+/**
+ * @brief Handles CTR_TX of endpoint register @p num read as @p v. Returns
+ * the events reported, 0 or 1.
+ */
+static size_t ctr_tx(struct cusb_stm32fs *me, uint8_t num, uint16_t v);
+
+/**
+ * @brief @ref ctr_tx() of an isochronous endpoint. The hardware toggles
+ * DTOG_TX every frame whether a packet was armed or not.
+ */
+static size_t ctr_tx_iso(struct cusb_stm32fs *me, uint8_t num, uint16_t v);
+
+/**
+ * @brief Handles CTR_RX of endpoint register @p num read as @p v. Returns
+ * the events reported, 0 or 1.
+ */
+static size_t ctr_rx(struct cusb_stm32fs *me, uint8_t num, uint16_t v);
+
+static void bus_reset(struct cusb_stm32fs *me);
+
+static void dcd_connect(void *ctx, bool on);
+static void dcd_set_address(void *ctx, uint8_t addr);
+static void dcd_ep_open(void *ctx, uint8_t ep, uint8_t type, uint16_t mps);
+static void dcd_ep_close(void *ctx, uint8_t ep);
+static void dcd_ep_xfer(void *ctx, uint8_t ep, uint8_t *buf, uint32_t len);
+static void dcd_ep_stall(void *ctx, uint8_t ep, bool stall);
+static size_t dcd_service(void *ctx, size_t budget);
+static void dcd_irq_enable(void *ctx, bool on);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const struct cusb_dcd_api STM32FS_API =
+{
+    &dcd_connect,
+    &dcd_set_address,
+    &dcd_ep_open,
+    &dcd_ep_close,
+    &dcd_ep_xfer,
+    &dcd_ep_stall,
+    &dcd_service,
+    &dcd_irq_enable
+};
+
+/**
+ * @brief PMA offset of the buffer pair of every endpoint number.
+ */
+static const uint16_t PMA_BASE[8] =
+{
+    PMA_EP0, PMA_EP1, PMA_EP2, PMA_EP3, PMA_EP4, PMA_EP5, PMA_EP6, PMA_EP7
+};
+
+/**
+ * @brief Bytes of each buffer of every endpoint number.
+ */
+static const uint16_t PMA_BYTES[8] =
+{
+    CUSB_CFG_EP0_SIZE, EP_BYTES(1), EP_BYTES(2), EP_BYTES(3), EP_BYTES(4), EP_BYTES(5), EP_BYTES(6), EP_BYTES(7)
+};
+
+/**
+ * @brief EP_TYPE field of every bmAttributes transfer type.
+ */
+static const uint16_t EPR_TYPE[4] =
+{
+    EPR_TYPE_CONTROL, EPR_TYPE_ISO, EPR_TYPE_BULK, EPR_TYPE_INTERRUPT
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static inline struct cusb_stm32fs_ep *endpoint(struct cusb_stm32fs *me, uint8_t ep)
+{
+    CUSB_ASSERT_PACKET( (CUSB_EP_NUM(ep) < CUSB_STM32FS_ENDPOINTS) );
+    return &me->ep[CUSB_EP_IS_IN(ep) ? 1 : 0][CUSB_EP_NUM(ep)];
+}
+
+static inline uint16_t buffer(uint8_t num, uint8_t slot)
+{
+    return (uint16_t)(PMA_BASE[num] + (slot ? PMA_BYTES[num] : 0U));
+}
+
+static inline void epr_write(uint8_t num, uint16_t rw, uint16_t clear, uint16_t toggle)
+{
+    WR(EPR(num), (rw & EPR_RW) | (EPR_CTR & (uint16_t)~clear) | toggle);
+}
+
+static void cntr_write(const struct cusb_stm32fs *me)
+{
+    bool unmasked = (me->irq_on || me->wake) && !me->deferred;
+    WR(CNTR, me->cntr | (unmasked ? me->sources : 0U));
+}
+
+static void pma_write(uint16_t addr, const uint8_t *src, uint32_t len)
+{
+    uint32_t i = 0;
+
+    for (; i + 1U < len; i += 2U)
+    {
+        WR(PMA(addr + i), src[i] | (src[i + 1U] << 8));
+    }
+
+    if (i < len)
+    {
+        WR(PMA(addr + i), src[i]);
+    }
+}
+
+static void pma_read(uint16_t addr, uint8_t *dst, uint32_t len)
+{
+    uint32_t i = 0;
+
+    for (; i + 1U < len; i += 2U)
+    {
+        uint16_t word = RD(PMA(addr + i));
+        dst[i] = (uint8_t)word;
+        dst[i + 1U] = (uint8_t)(word >> 8);
+    }
+
+    if (i < len)
+    {
+        dst[i] = (uint8_t)RD(PMA(addr + i));
+    }
+}
+
+static uint16_t rx_blocks(uint16_t bytes)
+{
+    if (bytes > 62U)
+    {
+        return (uint16_t)(COUNT_BL_SIZE | ((bytes / 32U - 1U) << 10));
+    }
+
+    return (uint16_t)((bytes / 2U) << 10);
+}
+
+static uint16_t in_load(uint8_t num, struct cusb_stm32fs_ep *e, uint8_t slot)
+{
+    uint32_t left = e->len - e->next;
+    uint16_t n = (left < e->mps) ? (uint16_t)left : e->mps;
+
+    if (n > 0U)
+    {
+        pma_write(buffer(num, slot), &e->buf[e->next], n);
+    }
+
+    WR(PMA(BT_COUNT(num, slot)), n);
+    e->next += n;
+    e->pkts--;
+    return n;
+}
+
+static void in_start(uint8_t num, struct cusb_stm32fs_ep *e)
+{
+    uint32_t left = e->len - e->count;
+    uint16_t v = RD(EPR(num));
+
+    e->next = e->count;
+    e->pkts = (left == 0U) ? 1U : (left + e->mps - 1U) / e->mps;
+    e->has_staged = false;
+
+    if (e->type == CUSB_EP_ISOCHRONOUS)
+    {
+        /* No handshake. The hardware sends the buffer DTOG_TX points at
+        every frame, so that is where the packet goes. */
+        e->sw = (uint8_t)(((v & EPR_DTOG_TX) != 0U) ? 1U : 0U);
+        e->inflight = in_load(num, e, e->sw);
+        return;
+    }
+
+    if (!e->dbl)
+    {
+        e->inflight = in_load(num, e, 0);
+        epr_write(num, v, 0, TO(v, EPR_STAT_TX, STAT(true, STAT_VALID)));
+        return;
+    }
+
+    /* Fill the buffer the hardware looks at next and release it with
+    SW_BUF, then stage the following packet in the other one. */
+    e->inflight = in_load(num, e, e->sw);
+    epr_write(num, v, 0, EPR_DTOG_RX);
+    e->sw ^= 1U;
+
+    if (e->pkts > 0U)
+    {
+        e->staged = in_load(num, e, e->sw);
+        e->has_staged = true;
+    }
+}
+
+static void out_start(uint8_t num, struct cusb_stm32fs_ep *e)
+{
+    if (e->type == CUSB_EP_ISOCHRONOUS)
+    {
+        /* Always receiving. Packets are dropped until armed. */
+        return;
+    }
+
+    uint16_t v = RD(EPR(num));
+
+    if (!e->dbl)
+    {
+        epr_write(num, v, 0, TO(v, EPR_STAT_RX, STAT(false, STAT_VALID)));
+        return;
+    }
+
+    epr_write(num, v, 0, EPR_DTOG_TX);
+    e->sw ^= 1U;
+}
+
+static size_t ctr_tx(struct cusb_stm32fs *me, uint8_t num, uint16_t v)
+{
+    struct cusb_stm32fs_ep *e = &me->ep[1][num];
+
+    if (e->type == CUSB_EP_ISOCHRONOUS)
+    {
+        return ctr_tx_iso(me, num, v);
+    }
+
+    if (!e->armed)
+    {
+        epr_write(num, v, EPR_CTR_TX, 0);
+        return 0;
+    }
+
+    e->count += e->inflight;
+
+    if (e->dbl && e->has_staged)
+    {
+        /* Release the staged packet first so the host is not NAKed while
+        the one after it is copied. */
+        epr_write(num, v, EPR_CTR_TX, EPR_DTOG_RX);
+        e->sw ^= 1U;
+        e->inflight = e->staged;
+        e->has_staged = false;
+
+        if (e->pkts > 0U)
+        {
+            e->staged = in_load(num, e, e->sw);
+            e->has_staged = true;
+        }
+
+        return 0;
+    }
+
+    if (!e->dbl && e->pkts > 0U)
+    {
+        e->inflight = in_load(num, e, 0);
+        epr_write(num, v, EPR_CTR_TX, TO(v, EPR_STAT_TX, STAT(true, STAT_VALID)));
+        return 0;
+    }
+
+    epr_write(num, v, EPR_CTR_TX, 0);
+    e->armed = false;
+
+    if (num == 0U && e->len == 0U && me->address_pending)
+    {
+        /* Status stage of SET_ADDRESS. */
+        WR(DADDR, DADDR_EF | me->new_address);
+        me->address_pending = false;
+    }
+
+    cusb_dcd_xfer_done(&me->dcd, (uint8_t)(CUSB_EP_DIR_IN | num), e->count, true);
+    return 1;
+}
+
+static size_t ctr_tx_iso(struct cusb_stm32fs *me, uint8_t num, uint16_t v)
+{
+    struct cusb_stm32fs_ep *e = &me->ep[1][num];
+    uint8_t sent = (uint8_t)(((v & EPR_DTOG_TX) != 0U) ? 0U : 1U);
+
+    if (!e->armed || sent != e->sw)
+    {
+        /* Empty packet of an idle frame. */
+        epr_write(num, v, EPR_CTR_TX, 0);
+        return 0;
+    }
+
+    /* Idle frames send nothing rather than this packet again. */
+    WR(PMA(BT_COUNT(num, sent)), 0U);
+    e->count += e->inflight;
+
+    if (e->pkts > 0U)
+    {
+        e->sw ^= 1U;
+        e->inflight = in_load(num, e, e->sw);
+        epr_write(num, v, EPR_CTR_TX, 0);
+        return 0;
+    }
+
+    epr_write(num, v, EPR_CTR_TX, 0);
+    e->armed = false;
+    cusb_dcd_xfer_done(&me->dcd, (uint8_t)(CUSB_EP_DIR_IN | num), e->count, true);
+    return 1;
+}
+
+static size_t ctr_rx(struct cusb_stm32fs *me, uint8_t num, uint16_t v)
+{
+    struct cusb_stm32fs_ep *e = &me->ep[0][num];
+
+    if ((v & EPR_SETUP) != 0U)
+    {
+        uint8_t setup[8];
+
+        pma_read(buffer(0, 1), setup, sizeof(setup));
+        epr_write(0, v, EPR_CTR_RX, 0);
+        me->ep[0][0].armed = false;
+        me->ep[1][0].armed = false;
+        cusb_dcd_setup(&me->dcd, setup);
+        return 1;
+    }
+
+    if (!e->armed)
+    {
+        epr_write(num, v, EPR_CTR_RX, 0);
+        return 0;
+    }
+
+    /* Isochronous OUT fills the buffer DTOG_RX pointed at before the
+    hardware toggled it. */
+    uint8_t slot = e->dbl ? (uint8_t)(e->sw ^ 1U) : 1U;
+    bool iso = (e->type == CUSB_EP_ISOCHRONOUS);
+
+    if (iso)
+    {
+        slot = (uint8_t)(((v & EPR_DTOG_RX) != 0U) ? 0U : 1U);
+    }
+
+    uint16_t n = RD(PMA(BT_COUNT(num, slot))) & COUNT_MASK;
+    uint32_t room = e->len - e->count;
+    uint16_t take = (n <= room) ? n : (uint16_t)room;
+    bool last = (n < e->mps) || (e->count + take >= e->len);
+
+    e->babble = e->babble || (n > room);
+
+    if (iso)
+    {
+        epr_write(num, v, EPR_CTR_RX, 0);
+
+        if (take > 0U)
+        {
+            pma_read(buffer(num, slot), &e->buf[e->count], take);
+        }
+    }
+    else if (e->dbl)
+    {
+        /* Hand the other buffer to the hardware before copying out of
+        this one, so the next packet arrives during the copy. */
+        epr_write(num, v, EPR_CTR_RX, last ? 0U : EPR_DTOG_TX);
+        e->sw = last ? e->sw : (uint8_t)(e->sw ^ 1U);
+
+        if (take > 0U)
+        {
+            pma_read(buffer(num, slot), &e->buf[e->count], take);
+        }
+    }
+    else
+    {
+        if (take > 0U)
+        {
+            pma_read(buffer(num, slot), &e->buf[e->count], take);
+        }
+
+        epr_write(num, v, EPR_CTR_RX, last ? 0U : TO(v, EPR_STAT_RX, STAT(false, STAT_VALID)));
+    }
+
+    e->count += take;
+
+    if (!last)
+    {
+        return 0;
+    }
+
+    e->armed = false;
+    cusb_dcd_xfer_done(&me->dcd, num, e->count, !e->babble);
+    return 1;
+}
+
+static void bus_reset(struct cusb_stm32fs *me)
+{
+    WR(ISTR, ~IRQ_RESET);
+
+    for (uint8_t n = 1; n < CUSB_STM32FS_ENDPOINTS; n++)
+    {
+        if (me->ep[0][n].open || me->ep[1][n].open)
+        {
+            uint16_t v = RD(EPR(n));
+            epr_write(n, 0, EPR_CTR, TO(v, EPR_STAT_TX | EPR_DTOG_TX | EPR_STAT_RX | EPR_DTOG_RX, 0U));
+        }
+    }
+
+    memset(me->ep, 0, sizeof(me->ep));
+    me->address_pending = false;
+
+    WR(BTABLE, 0U);
+    WR(PMA(BT_ADDR(0, 0)), buffer(0, 0));
+    WR(PMA(BT_ADDR(0, 1)), buffer(0, 1));
+    WR(PMA(BT_COUNT(0, 1)), rx_blocks(CUSB_CFG_EP0_SIZE));
+
+    /* SETUP packets are accepted while NAKing. */
+    uint16_t v = RD(EPR(0));
+    epr_write(0,
+              EPR_TYPE_CONTROL,
+              EPR_CTR,
+              TO(v, EPR_STAT_TX | EPR_DTOG_TX | EPR_STAT_RX | EPR_DTOG_RX, STAT(true, STAT_NAK) | STAT(false, STAT_NAK)));
+
+    for (uint8_t d = 0; d < 2U; d++)
+    {
+        me->ep[d][0].open = true;
+        me->ep[d][0].mps = CUSB_CFG_EP0_SIZE;
+        me->ep[d][0].type = CUSB_EP_CONTROL;
+    }
+
+    WR(DADDR, DADDR_EF);
+    cusb_dcd_bus_reset(&me->dcd, CUSB_SPEED_FULL);
+}
+
+static void dcd_connect(void *ctx, bool on)
+{
+    (void)ctx;
+    WR(BCDR, on ? BCDR_DPPU : 0U);
+}
+
+static void dcd_set_address(void *ctx, uint8_t addr)
+{
+    struct cusb_stm32fs *me = (struct cusb_stm32fs *)ctx;
+    me->new_address = addr;
+    me->address_pending = true;
+}
+
+static void dcd_ep_open(void *ctx, uint8_t ep, uint8_t type, uint16_t mps)
+{
+    struct cusb_stm32fs *me = (struct cusb_stm32fs *)ctx;
+    uint8_t num = CUSB_EP_NUM(ep);
+    bool in = CUSB_EP_IS_IN(ep);
+    struct cusb_stm32fs_ep *e = endpoint(me, ep);
+    struct cusb_stm32fs_ep *other = &me->ep[in ? 0 : 1][num];
+
+    /* A larger packet needs a larger CUSB_STM32FS_PMA_EPn. Both directions
+    of a number share its type. */
+    CUSB_ASSERT_API( (mps > 0U && mps <= PMA_BYTES[num]) );
+    CUSB_ASSERT_API( (!other->open || (other->type == type && type != CUSB_EP_ISOCHRONOUS)) );
+    CUSB_ASSERT_INTERNAL( (!e->open) );
+
+    bool iso = (type == CUSB_EP_ISOCHRONOUS);
+    bool dbl = iso || (type == CUSB_EP_BULK && !other->open);
+    uint16_t mask = (uint16_t)(DIR(in, EPR_STAT_TX) | DIR(in, EPR_DTOG_TX));
+    uint16_t val = STAT(in, (dbl ? STAT_VALID : STAT_NAK));
+
+    if (dbl && !iso)
+    {
+        /* SW_BUF equal to DTOG: both buffers are the driver's. */
+        mask |= DIR(!in, EPR_DTOG_TX);
+    }
+
+    if (other->open && other->dbl)
+    {
+        /* Number now used both ways. The other direction gives up its
+        second buffer before it was ever armed. */
+        CUSB_ASSERT_INTERNAL( (!other->armed) );
+        other->dbl = false;
+        mask |= (uint16_t)(DIR(!in, EPR_STAT_TX) | DIR(!in, EPR_DTOG_TX));
+        val |= STAT(!in, STAT_NAK);
+    }
+
+    WR(PMA(BT_ADDR(num, 0)), buffer(num, 0));
+    WR(PMA(BT_ADDR(num, 1)), buffer(num, 1));
+
+    if (!in)
+    {
+        uint16_t blocks = rx_blocks(PMA_BYTES[num]);
+        WR(PMA(BT_COUNT(num, 1)), blocks);
+
+        if (dbl)
+        {
+            WR(PMA(BT_COUNT(num, 0)), blocks);
+        }
+    }
+    else if (iso)
+    {
+        /* Both buffers idle. */
+        WR(PMA(BT_COUNT(num, 0)), 0U);
+        WR(PMA(BT_COUNT(num, 1)), 0U);
+    }
+
+    uint16_t v = RD(EPR(num));
+    uint16_t kind = (type == CUSB_EP_BULK && dbl) ? EPR_KIND : 0U;
+    epr_write(num, (uint16_t)(EPR_TYPE[type & 3U] | kind | num), 0, TO(v, mask, val));
+
+    memset(e, 0, sizeof(*e));
+    e->mps = mps;
+    e->type = type;
+    e->open = true;
+    e->dbl = dbl;
+}
+
+static void dcd_ep_close(void *ctx, uint8_t ep)
+{
+    struct cusb_stm32fs *me = (struct cusb_stm32fs *)ctx;
+    uint8_t num = CUSB_EP_NUM(ep);
+    bool in = CUSB_EP_IS_IN(ep);
+    uint16_t v = RD(EPR(num));
+
+    epr_write(num, v, DIR(in, EPR_CTR_TX), TO(v, DIR(in, EPR_STAT_TX) | DIR(in, EPR_DTOG_TX), STAT_DISABLED));
+    memset(endpoint(me, ep), 0, sizeof(struct cusb_stm32fs_ep));
+}
+
+static void dcd_ep_xfer(void *ctx, uint8_t ep, uint8_t *buf, uint32_t len)
+{
+    struct cusb_stm32fs *me = (struct cusb_stm32fs *)ctx;
+    struct cusb_stm32fs_ep *e = endpoint(me, ep);
+
+    CUSB_ASSERT_PACKET( (e->open && !e->armed) );
+    e->buf = buf;
+    e->len = len;
+    e->count = 0;
+    e->babble = false;
+    e->armed = true;
+
+    if (CUSB_EP_IS_IN(ep))
+    {
+        in_start(CUSB_EP_NUM(ep), e);
+    }
+    else
+    {
+        out_start(CUSB_EP_NUM(ep), e);
+    }
+}
+
+static void dcd_ep_stall(void *ctx, uint8_t ep, bool stall)
+{
+    struct cusb_stm32fs *me = (struct cusb_stm32fs *)ctx;
+    struct cusb_stm32fs_ep *e = endpoint(me, ep);
+    uint8_t num = CUSB_EP_NUM(ep);
+    bool in = CUSB_EP_IS_IN(ep);
+    uint16_t v = RD(EPR(num));
+
+    if (stall)
+    {
+        epr_write(num, v, 0, TO(v, DIR(in, EPR_STAT_TX), STAT(in, STAT_STALL)));
+        return;
+    }
+
+    /* Back to DATA0. A double-buffered endpoint restarts its transfer
+    from the first unacknowledged byte with both buffers its own. */
+    uint16_t mask = (uint16_t)(DIR(in, EPR_STAT_TX) | DIR(in, EPR_DTOG_TX));
+    uint16_t val = STAT(in, ((e->dbl || e->armed) ? STAT_VALID : STAT_NAK));
+
+    if (e->dbl)
+    {
+        mask |= DIR(!in, EPR_DTOG_TX);
+        e->sw = 0;
+    }
+
+    epr_write(num, v, 0, TO(v, mask, val));
+
+    if (e->dbl && e->armed)
+    {
+        if (in)
+        {
+            in_start(num, e);
+        }
+        else
+        {
+            out_start(num, e);
+        }
+    }
+}
+
+static size_t dcd_service(void *ctx, size_t budget)
+{
+    struct cusb_stm32fs *me = (struct cusb_stm32fs *)ctx;
+    size_t n = 0;
+
+    /* Reset voids everything after it. Packets that did not end a
+    transfer are handled without counting against the budget. */
+    while (n < budget)
+    {
+        uint16_t istr = RD(ISTR) & (me->sources | ISTR_EP_ID);
+
+        if ((istr & IRQ_RESET) != 0U)
+        {
+            bus_reset(me);
+            n++;
+        }
+        else if ((istr & IRQ_CTR) != 0U)
+        {
+            uint8_t num = (uint8_t)(istr & ISTR_EP_ID);
+            uint16_t v = RD(EPR(num));
+            n += ((v & EPR_CTR_TX) != 0U) ? ctr_tx(me, num, v) : ctr_rx(me, num, v);
+        }
+        else if ((istr & IRQ_SUSP) != 0U)
+        {
+            WR(ISTR, ~IRQ_SUSP);
+            me->cntr |= CNTR_FSUSP;
+            cntr_write(me);
+            cusb_dcd_suspend(&me->dcd);
+            n++;
+        }
+        else if ((istr & IRQ_WKUP) != 0U)
+        {
+            WR(ISTR, ~IRQ_WKUP);
+            me->cntr &= (uint16_t)~CNTR_FSUSP;
+            cntr_write(me);
+            cusb_dcd_resume(&me->dcd);
+            n++;
+        }
+        else if ((istr & IRQ_SOF) != 0U)
+        {
+            WR(ISTR, ~IRQ_SOF);
+            cusb_dcd_sof(&me->dcd, RD(FNR) & FNR_FN);
+            n++;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if (me->deferred && n < budget)
+    {
+        /* Everything latched was handled. */
+        me->deferred = false;
+        cntr_write(me);
+    }
+
+    return n;
+}
+
+static void dcd_irq_enable(void *ctx, bool on)
+{
+    struct cusb_stm32fs *me = (struct cusb_stm32fs *)ctx;
+    me->irq_on = on;
+    cntr_write(me);
+}
+
+/*------------------------------------------------------------*/
+/*------------------- STM32FS MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+void cusb_stm32fs_ctor(struct cusb_stm32fs *me, bool sof, void (*wake)(void *obj), void *wake_obj)
+{
+    CUSB_ASSERT_API( (me) );
+
+    memset(me, 0, sizeof(*me));
+    cusb_dcd_ctor(&me->dcd, &STM32FS_API, me);
+    me->wake = wake;
+    me->wake_obj = wake_obj;
+    me->sources = (uint16_t)(IRQ_CTR | IRQ_RESET | IRQ_SUSP | IRQ_WKUP | (sof ? IRQ_SOF : 0U));
+
+    /* Leave power down with the transceiver held in reset, then release
+    it with every interrupt masked. */
+    WR(CNTR, CNTR_FRES);
+    WR(CNTR, 0U);
+    WR(ISTR, 0U);
+    WR(BCDR, 0U);
+}
+
+void cusb_stm32fs_isr(struct cusb_stm32fs *me)
+{
+    CUSB_ASSERT_PACKET( (me && me->wake) );
+
+    /* Events stay latched in ISTR and EPnR until the poll. */
+    WR(CNTR, me->cntr);
+    me->deferred = true;
+    (*me->wake)(me->wake_obj);
+}
@@ -0,0 +1,398 @@
+/**
+ * @file
+ * @brief See @ref stream.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/stream.h"
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+/* STDLib. */
+#include <string.h>
+
+#if (CUSB_CFG_STREAM)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/stream.c")
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Returns buffer size in bytes.
+ */
+static uint32_t size_of(const struct cusb_stream *me);
+
+/**
+ * @brief Describes @p len bytes of the circular buffer starting at
+ * free-running position @p start as up to two segments.
+ */
+static void segments(const struct cusb_stream *me, uint32_t start, uint32_t len, struct cusb_stream_iov iov[2]);
+
+#if (CUSB_CFG_STATS || CUSB_CFG_TRACE)
+/**
+ * @brief Returns the excess of @p used over the buffer size.
+ * 0 if the buffer is not overrun.
+ */
+static uint32_t overrun(const struct cusb_stream *me, uint32_t used);
+#endif
+
+/**
+ * @brief Hands @p len bytes starting at the queue position to the
+ * transport as one segment. 0 starts a zero length packet. A packet
+ * straddling the end of the buffer is sent from a copy.
+ */
+static void start_in(struct cusb_stream *me, struct cusb_stream_iov iov[2], uint32_t len);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static uint32_t size_of(const struct cusb_stream *me)
+{
+    return me->mask + 1U;
+}
+
+static void segments(const struct cusb_stream *me, uint32_t start, uint32_t len, struct cusb_stream_iov iov[2])
+{
+    uint32_t offset = start & me->mask;
+    uint32_t first = size_of(me) - offset;
+
+    if (first > len)
+    {
+        first = len;
+    }
+
+    iov[0].base = &me->buf[offset];
+    iov[0].len = first;
+    iov[1].base = me->buf;
+    iov[1].len = len - first;
+}
+
+#if (CUSB_CFG_STATS || CUSB_CFG_TRACE)
+static uint32_t overrun(const struct cusb_stream *me, uint32_t used)
+{
+    return (used > size_of(me)) ? (used - size_of(me)) : 0U;
+}
+#endif
+
+static void start_in(struct cusb_stream *me, struct cusb_stream_iov iov[2], uint32_t len)
+{
+    segments(me, me->queued, len, iov);
+
+    if (iov[1].len != 0U)
+    {
+        CUSB_ASSERT_INTERNAL( (len <= me->packet_size) );
+        memcpy(me->straddle, iov[0].base, iov[0].len);
+        memcpy(&me->straddle[iov[0].len], iov[1].base, iov[1].len);
+        iov[0].base = me->straddle;
+        iov[0].len = len;
+        iov[1].len = 0;
+    }
+
+    me->queued += len;
+    me->inflight = len;
+    me->open = (len != 0U) && ((len % me->packet_size) == 0U);
+    me->busy = true;
+}
+
+/*------------------------------------------------------------*/
+/*-------------------- STREAM MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+void cusb_stream_ctor(struct cusb_stream *me,
+                      enum cusb_stream_dir dir,
+                      uint8_t *buf,
+                      size_t size,
+                      uint16_t packet_size)
+{
+    CUSB_ASSERT_API( (me && buf) );
+    CUSB_ASSERT_API( (dir == CUSB_STREAM_IN || dir == CUSB_STREAM_OUT) );
+    CUSB_ASSERT_API( (packet_size != 0U && (packet_size & (packet_size - 1U)) == 0U) );
+    CUSB_ASSERT_API( (packet_size <= CUSB_CFG_BULK_SIZE_MAX) );
+    CUSB_ASSERT_API( (size >= packet_size && size <= 0x80000000UL && (size & (size - 1U)) == 0U) );
+
+    me->buf = buf;
+    me->mask = (uint32_t)(size - 1U);
+    me->packet_size = packet_size;
+    me->dir = (uint8_t)dir;
+    me->watermark = packet_size;
+#if (CUSB_CFG_STATS)
+    me->stats.bytes = 0;
+    me->stats.transfers = 0;
+    me->stats.overflow_events = 0;
+    me->stats.overflow_bytes = 0;
+    me->stats.throttled = 0;
+#endif
+    me->flush_req = 0;
+    cusb_stream_reset(me);
+}
+
+size_t cusb_stream_write_space(const struct cusb_stream *me, struct cusb_stream_iov iov[2])
+{
+    CUSB_ASSERT_PACKET( (me && iov) );
+    CUSB_ASSERT_PACKET( (me->dir == CUSB_STREAM_IN) );
+
+    uint32_t head = me->head;
+    uint32_t used = head - me->tail;
+    uint32_t space = (used < size_of(me)) ? (size_of(me) - used) : 0U;
+
+    segments(me, head, space, iov);
+    return space;
+}
+
+void cusb_stream_write_commit(struct cusb_stream *me, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (me->dir == CUSB_STREAM_IN) );
+    CUSB_ASSERT_PACKET( (len <= size_of(me)) );
+
+    uint32_t head = me->head;
+#if (CUSB_CFG_STATS || CUSB_CFG_TRACE)
+    uint32_t used = head - me->tail;
+    uint32_t lost = overrun(me, used + (uint32_t)len) - overrun(me, used);
+
+    if (lost != 0U)
+    {
+#if (CUSB_CFG_STATS)
+        me->stats.overflow_events++;
+        me->stats.overflow_bytes += lost;
+#endif
+        CUSB_TRACE(CUSB_TRACE_STREAM_OVERFLOW, lost);
+    }
+#endif
+
+    me->head = head + (uint32_t)len;
+}
+
+size_t cusb_stream_read_data(const struct cusb_stream *me, struct cusb_stream_iov iov[2])
+{
+    CUSB_ASSERT_PACKET( (me && iov) );
+    CUSB_ASSERT_PACKET( (me->dir == CUSB_STREAM_OUT) );
+
+    uint32_t tail = me->tail;
+    uint32_t available = me->head - tail;
+
+    segments(me, tail, available, iov);
+    return available;
+}
+
+void cusb_stream_read_release(struct cusb_stream *me, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (me->dir == CUSB_STREAM_OUT) );
+    CUSB_ASSERT_PACKET( (len <= (uint32_t)(me->head - me->tail)) );
+
+    me->tail += (uint32_t)len;
+}
+
+void cusb_stream_set_watermark(struct cusb_stream *me, size_t watermark)
+{
+    CUSB_ASSERT_API( (me) );
+    CUSB_ASSERT_API( (me->dir == CUSB_STREAM_IN) );
+    CUSB_ASSERT_API( (watermark >= me->packet_size && watermark <= size_of(me)) );
+
+    me->watermark = (uint32_t)watermark;
+}
+
+void cusb_stream_flush(struct cusb_stream *me)
+{
+    CUSB_ASSERT_API( (me) );
+    CUSB_ASSERT_API( (me->dir == CUSB_STREAM_IN) );
+
+    me->flush_to = me->head;
+    me->flush_req++;
+}
+
+#if (CUSB_CFG_STATS)
+const struct cusb_stream_stats *cusb_stream_get_stats(const struct cusb_stream *me)
+{
+    CUSB_ASSERT_API( (me) );
+    return &me->stats;
+}
+#endif
+
+bool cusb_stream_in_acquire(struct cusb_stream *me, struct cusb_stream_iov iov[2],
+                            size_t max, size_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && iov && len) );
+    CUSB_ASSERT_PACKET( (me->dir == CUSB_STREAM_IN) );
+    CUSB_ASSERT_PACKET( (max >= me->packet_size && (max % me->packet_size) == 0U) );
+
+    if (me->busy)
+    {
+        return false;
+    }
+
+    if (me->zlp_pending)
+    {
+        me->zlp_pending = false;
+        start_in(me, iov, 0U);
+        *len = 0;
+        return true;
+    }
+
+    uint32_t head = me->head;
+    uint8_t flush_req = me->flush_req;
+
+    /* Producer overran unsent data. Resume at the oldest data still intact. */
+    if ((uint32_t)(head - me->queued) > size_of(me))
+    {
+        me->queued = head - size_of(me);
+        me->tail = me->queued;
+    }
+
+    uint32_t pending = head - me->queued;
+    uint32_t n = (pending < max) ? pending : (uint32_t)max;
+    uint32_t first = size_of(me) - (me->queued & me->mask);
+
+    /* The controller takes one contiguous block per transfer, and a short
+    packet before the end would end the host transfer early. Stop at the last
+    packet boundary before the end of the buffer and carry the rest forward. */
+    if (n > first)
+    {
+        if (first >= me->packet_size)
+        {
+            n = first - (first % me->packet_size);
+        }
+        else if (n > me->packet_size)
+        {
+            /* Packet straddles the end. Only after a flush left the queue
+            position off a packet boundary. */
+            n = me->packet_size;
+        }
+    }
+
+    if (flush_req != me->flush_ack)
+    {
+        /* Signed distance so the comparison survives counter wrap-around. */
+        if ((int32_t)(me->queued + n - me->flush_to) >= 0)
+        {
+            me->flush_ack = flush_req;
+
+            if (n == 0U && !me->open)
+            {
+                return false;
+            }
+
+            /* Data that ends on a packet boundary needs a ZLP to end the host transfer. */
+            me->zlp_pending = (n != 0U) && ((n % me->packet_size) == 0U);
+        }
+    }
+    else
+    {
+        if (pending < me->watermark)
+        {
+            return false;
+        }
+
+        n -= n % me->packet_size;
+    }
+
+    start_in(me, iov, n);
+    *len = n;
+    return true;
+}
+
+void cusb_stream_in_complete(struct cusb_stream *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (me->dir == CUSB_STREAM_IN && me->busy) );
+
+#if (CUSB_CFG_STATS)
+    me->stats.bytes += me->inflight;
+    me->stats.transfers++;
+#endif
+    me->tail = me->queued;
+    me->busy = false;
+}
+
+bool cusb_stream_out_acquire(struct cusb_stream *me, struct cusb_stream_iov iov[2],
+                             size_t max, size_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && iov && len) );
+    CUSB_ASSERT_PACKET( (me->dir == CUSB_STREAM_OUT) );
+    CUSB_ASSERT_PACKET( (max >= me->packet_size && (max % me->packet_size) == 0U) );
+
+    if (me->busy)
+    {
+        return false;
+    }
+
+    uint32_t head = me->head;
+    uint32_t space = size_of(me) - (head - me->tail);
+    uint32_t n = (space < max) ? space : (uint32_t)max;
+
+    n -= n % me->packet_size;
+
+    if (n == 0U)
+    {
+        if (!me->throttling)
+        {
+            me->throttling = true;
+#if (CUSB_CFG_STATS)
+            me->stats.throttled++;
+#endif
+            CUSB_TRACE(CUSB_TRACE_STREAM_THROTTLED, space);
+        }
+
+        return false;
+    }
+
+    me->throttling = false;
+    segments(me, head, n, iov);
+    me->inflight = n;
+    me->busy = true;
+    *len = n;
+    return true;
+}
+
+void cusb_stream_out_complete(struct cusb_stream *me, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (me->dir == CUSB_STREAM_OUT && me->busy) );
+    CUSB_ASSERT_PACKET( (len <= me->inflight) );
+
+    me->head += (uint32_t)len;
+#if (CUSB_CFG_STATS)
+    me->stats.bytes += (uint32_t)len;
+    me->stats.transfers++;
+#endif
+    me->busy = false;
+}
+
+void cusb_stream_reset(struct cusb_stream *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    me->head = 0;
+    me->queued = 0;
+    me->tail = 0;
+    me->inflight = 0;
+    me->flush_to = 0;
+    me->flush_ack = me->flush_req;
+    me->busy = false;
+    me->open = false;
+    me->zlp_pending = false;
+    me->throttling = false;
+}
+
+#endif /* CUSB_CFG_STREAM */
@@ -0,0 +1,613 @@
+/**
+ * @file
+ * @brief See @ref uas.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/uas.h"
+
+/* Endian accessors. */
+#include "cusb/endian.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_MSC_UAS)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/uas.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name IU IDs
+ */
+/**@{*/
+#define IU_COMMAND                      (0x01U)
+#define IU_SENSE                        (0x03U)
+#define IU_RESPONSE                     (0x04U)
+#define IU_TASK_MANAGEMENT              (0x05U)
+#define IU_READ_READY                   (0x06U)
+#define IU_WRITE_READY                  (0x07U)
+/**@}*/
+
+/**
+ * @name IU Sizes
+ */
+/**@{*/
+#define COMMAND_IU_SIZE                 (32U)
+#define TASK_MANAGEMENT_IU_SIZE         (16U)
+#define SENSE_IU_HEADER_SIZE            (16U)
+#define RESPONSE_IU_SIZE                (8U)
+#define READY_IU_SIZE                   (4U)
+/**@}*/
+
+/**
+ * @name Task Management Functions
+ */
+/**@{*/
+#define TMF_ABORT_TASK                  (0x01U)
+#define TMF_ABORT_TASK_SET              (0x02U)
+#define TMF_CLEAR_TASK_SET              (0x04U)
+#define TMF_LOGICAL_UNIT_RESET          (0x08U)
+#define TMF_I_T_NEXUS_RESET             (0x10U)
+#define TMF_QUERY_TASK                  (0x80U)
+/**@}*/
+
+/**
+ * @name Response Codes
+ */
+/**@{*/
+#define RC_TMF_COMPLETE                 (0x00U)
+#define RC_INVALID_IU                   (0x02U)
+#define RC_TMF_NOT_SUPPORTED            (0x04U)
+#define RC_TMF_SUCCEEDED                (0x08U)
+#define RC_INCORRECT_LUN                (0x09U)
+#define RC_OVERLAPPED_TAG               (0x0AU)
+/**@}*/
+
+/**
+ * @name Task Flags
+ */
+/**@{*/
+#define FLAG_READY_SENT                 (1U << 0)   /**< READ READY or WRITE READY sent. */
+#define FLAG_ABORTED                    (1U << 1)   /**< Aborted while waiting for backend. */
+/**@}*/
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Returns the live task holding @p tag, or NULL.
+ */
+static struct cusb_scsi_task *find(struct cusb_uas *me, uint16_t tag);
+
+/**
+ * @brief Queues a status IU that does not belong to a task slot.
+ * Dropped if the queue is full. The host times the command out.
+ */
+static void push_pending(struct cusb_uas *me, uint16_t tag, uint8_t iu, uint8_t code);
+
+/**
+ * @brief Returns the logical unit addressed by the LUN field of an IU,
+ * or NULL if there is no such logical unit.
+ */
+static struct cusb_scsi *lookup_lun(struct cusb_uas *me, const uint8_t *pkt);
+
+/**
+ * @brief Returns true if @p lun may take another slot while every other
+ * LUN holding none still finds one free.
+ */
+static bool slot_allowed(const struct cusb_uas *me, const struct cusb_scsi *lun);
+
+static void abort_task(struct cusb_uas *me, struct cusb_scsi_task *task);
+
+/**
+ * @brief Aborts every command of @p lun, or of all LUNs if NULL.
+ */
+static void abort_all(struct cusb_uas *me, const struct cusb_scsi *lun);
+
+static void command(struct cusb_uas *me, const uint8_t *pkt, uint16_t tag);
+static void task_management(struct cusb_uas *me, const uint8_t *pkt, uint16_t tag);
+
+/**
+ * @brief Writes the status IU of @p task into @p buf if it has one.
+ * Returns its length, 0 if the task has nothing to report.
+ */
+static size_t task_status(struct cusb_uas *me, struct cusb_scsi_task *task, uint8_t *buf);
+
+/**
+ * @brief Task notification from the SCSI target.
+ */
+static void on_task(void *ctx, struct cusb_scsi_task *task);
+
+static void signal_ready(struct cusb_uas *me);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static struct cusb_scsi_task *find(struct cusb_uas *me, uint16_t tag)
+{
+    for (uint8_t i = 0; i < me->ntasks; i++)
+    {
+        struct cusb_scsi_task *task = &me->tasks[i];
+
+        if (task->state != CUSB_SCSI_TASK_IDLE && (task->flags & FLAG_ABORTED) == 0U && task->tag == tag)
+        {
+            return task;
+        }
+    }
+
+    return NULL;
+}
+
+static void push_pending(struct cusb_uas *me, uint16_t tag, uint8_t iu, uint8_t code)
+{
+    if (me->npending < CUSB_UAS_PENDING_MAX)
+    {
+        me->pending[me->npending].tag = tag;
+        me->pending[me->npending].iu = iu;
+        me->pending[me->npending].code = code;
+        me->npending++;
+    }
+}
+
+static void abort_task(struct cusb_uas *me, struct cusb_scsi_task *task)
+{
+    if (me->data_in_owner == task)
+    {
+        me->data_in_owner = NULL;
+    }
+
+    if (me->data_out_owner == task)
+    {
+        me->data_out_owner = NULL;
+    }
+
+    task->flags |= FLAG_ABORTED;
+    cusb_scsi_task_abort(task);
+}
+
+static void abort_all(struct cusb_uas *me, const struct cusb_scsi *lun)
+{
+    for (uint8_t i = 0; i < me->ntasks; i++)
+    {
+        struct cusb_scsi_task *task = &me->tasks[i];
+
+        if (task->state != CUSB_SCSI_TASK_IDLE && (lun == NULL || task->target == lun))
+        {
+            abort_task(me, task);
+        }
+    }
+}
+
+static struct cusb_scsi *lookup_lun(struct cusb_uas *me, const uint8_t *pkt)
+{
+    /* Single level LUN, peripheral device addressing. */
+    if (pkt[8] != 0U || pkt[9] >= me->nluns)
+    {
+        return NULL;
+    }
+
+    for (size_t i = 10; i < 16U; i++)
+    {
+        if (pkt[i] != 0U)
+        {
+            return NULL;
+        }
+    }
+
+    return &me->luns[pkt[9]];
+}
+
+static bool slot_allowed(const struct cusb_uas *me, const struct cusb_scsi *lun)
+{
+    uint8_t free = 0;
+    uint8_t waiting = 0;
+
+    for (uint8_t i = 0; i < me->ntasks; i++)
+    {
+        if (me->tasks[i].state == CUSB_SCSI_TASK_IDLE)
+        {
+            free++;
+        }
+    }
+
+    for (uint8_t l = 0; l < me->nluns; l++)
+    {
+        const struct cusb_scsi *other = &me->luns[l];
+        bool holds = false;
+
+        for (uint8_t i = 0; i < me->ntasks && !holds; i++)
+        {
+            holds = (me->tasks[i].state != CUSB_SCSI_TASK_IDLE && me->tasks[i].target == other);
+        }
+
+        if (other != lun && !holds)
+        {
+            waiting++;
+        }
+    }
+
+    /* One slot stays in reserve for every other LUN without a task. */
+    return free > waiting;
+}
+
+static void command(struct cusb_uas *me, const uint8_t *pkt, uint16_t tag)
+{
+    struct cusb_scsi_task *task = NULL;
+    struct cusb_scsi *lun = lookup_lun(me, pkt);
+
+    if (lun == NULL)
+    {
+        push_pending(me, tag, IU_RESPONSE, RC_INCORRECT_LUN);
+        return;
+    }
+
+    if (find(me, tag) != NULL)
+    {
+        push_pending(me, tag, IU_RESPONSE, RC_OVERLAPPED_TAG);
+        return;
+    }
+
+    for (uint8_t i = 0; i < me->ntasks; i++)
+    {
+        if (me->tasks[i].state == CUSB_SCSI_TASK_IDLE)
+        {
+            task = &me->tasks[i];
+            break;
+        }
+    }
+
+    if (task == NULL || !slot_allowed(me, lun))
+    {
+        CUSB_TRACE(CUSB_TRACE_UAS_TASK_SET_FULL, tag);
+        push_pending(me, tag, IU_SENSE, CUSB_SCSI_STATUS_TASK_SET_FULL);
+        return;
+    }
+
+    task->tag = tag;
+    task->flags = 0;
+    cusb_scsi_task_start(lun, task, &pkt[16], 16);
+}
+
+static void task_management(struct cusb_uas *me, const uint8_t *pkt, uint16_t tag)
+{
+    struct cusb_scsi_task *task = find(me, cusb_get_be16(&pkt[6]));
+    struct cusb_scsi *lun = lookup_lun(me, pkt);
+    uint8_t code = RC_TMF_COMPLETE;
+
+    if (lun == NULL && pkt[4] != TMF_I_T_NEXUS_RESET)
+    {
+        push_pending(me, tag, IU_RESPONSE, RC_INCORRECT_LUN);
+        return;
+    }
+
+    if (task != NULL && task->target != lun)
+    {
+        /* Tag belongs to another LUN. */
+        task = NULL;
+    }
+
+    switch (pkt[4])
+    {
+        case TMF_ABORT_TASK:
+        {
+            if (task != NULL)
+            {
+                abort_task(me, task);
+            }
+            break;
+        }
+
+        case TMF_ABORT_TASK_SET:
+        case TMF_CLEAR_TASK_SET:
+        case TMF_LOGICAL_UNIT_RESET:
+        {
+            abort_all(me, lun);
+            break;
+        }
+
+        case TMF_I_T_NEXUS_RESET:
+        {
+            abort_all(me, NULL);
+            break;
+        }
+
+        case TMF_QUERY_TASK:
+        {
+            code = (task != NULL) ? RC_TMF_SUCCEEDED : RC_TMF_COMPLETE;
+            break;
+        }
+
+        default:
+        {
+            code = RC_TMF_NOT_SUPPORTED;
+            break;
+        }
+    }
+
+    push_pending(me, tag, IU_RESPONSE, code);
+}
+
+static size_t task_status(struct cusb_uas *me, struct cusb_scsi_task *task, uint8_t *buf)
+{
+    if ((task->flags & FLAG_ABORTED) != 0U)
+    {
+        return 0;
+    }
+
+    cusb_set_be16(&buf[2], task->tag);
+    buf[1] = 0;
+
+    if (task->state == CUSB_SCSI_TASK_DATA_IN && (task->flags & FLAG_READY_SENT) == 0U &&
+        me->data_in_owner == NULL)
+    {
+        task->flags |= FLAG_READY_SENT;
+        me->data_in_owner = task;
+        buf[0] = IU_READ_READY;
+        return READY_IU_SIZE;
+    }
+
+    if (task->state == CUSB_SCSI_TASK_DATA_OUT && (task->flags & FLAG_READY_SENT) == 0U &&
+        me->data_out_owner == NULL)
+    {
+        task->flags |= FLAG_READY_SENT;
+        me->data_out_owner = task;
+        buf[0] = IU_WRITE_READY;
+        return READY_IU_SIZE;
+    }
+
+    if (task->state == CUSB_SCSI_TASK_DONE && me->data_in_owner != task && me->data_out_owner != task)
+    {
+        size_t len = SENSE_IU_HEADER_SIZE;
+
+        memset(&buf[4], 0, SENSE_IU_HEADER_SIZE - 4U);
+        buf[0] = IU_SENSE;
+        buf[6] = task->status;
+
+        if (task->status == CUSB_SCSI_STATUS_CHECK_CONDITION)
+        {
+            cusb_set_be16(&buf[14], CUSB_SCSI_SENSE_SIZE);
+            cusb_scsi_task_sense(task, &buf[SENSE_IU_HEADER_SIZE]);
+            len += CUSB_SCSI_SENSE_SIZE;
+        }
+
+        cusb_scsi_task_free(task);
+        return len;
+    }
+
+    return 0;
+}
+
+static void on_task(void *ctx, struct cusb_scsi_task *task)
+{
+    (void)task;
+    signal_ready((struct cusb_uas *)ctx);
+}
+
+static void signal_ready(struct cusb_uas *me)
+{
+    if (me->notify)
+    {
+        (*me->notify)(me->ctx);
+    }
+}
+
+/*------------------------------------------------------------*/
+/*----------------------- UAS MEMBER FUNCTIONS ---------------*/
+/*------------------------------------------------------------*/
+
+void cusb_uas_ctor(struct cusb_uas *me,
+                   struct cusb_scsi *luns,
+                   size_t nluns,
+                   struct cusb_scsi_task *tasks,
+                   size_t ntasks,
+                   uint8_t *buffers,
+                   size_t buffer_size,
+                   uint16_t packet_size,
+                   void (*notify)(void *ctx),
+                   void *ctx)
+{
+    CUSB_ASSERT_API( (me && luns && tasks && buffers) );
+    CUSB_ASSERT_API( (ntasks >= nluns && ntasks <= UINT8_MAX) );
+    CUSB_ASSERT_API( (packet_size != 0U && packet_size <= CUSB_CFG_BULK_SIZE_MAX) );
+
+    cusb_scsi_attach(luns, nluns);
+    me->luns = luns;
+    me->nluns = (uint8_t)nluns;
+    me->tasks = tasks;
+    me->ntasks = (uint8_t)ntasks;
+    me->cursor = 0;
+    me->packet_size = packet_size;
+    me->data_in_owner = NULL;
+    me->data_out_owner = NULL;
+    me->npending = 0;
+    me->notify = notify;
+    me->ctx = ctx;
+
+    for (size_t i = 0; i < ntasks; i++)
+    {
+        cusb_scsi_task_ctor(&tasks[i], &buffers[i * buffer_size], buffer_size, &on_task, me);
+    }
+}
+
+void cusb_uas_command_out(struct cusb_uas *me, const uint8_t *pkt, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me && (pkt || len == 0U)) );
+
+    if (len < READY_IU_SIZE)
+    {
+        return;
+    }
+
+    uint16_t tag = cusb_get_be16(&pkt[2]);
+
+    if (pkt[0] == IU_COMMAND && len >= COMMAND_IU_SIZE)
+    {
+        command(me, pkt, tag);
+    }
+    else if (pkt[0] == IU_TASK_MANAGEMENT && len >= TASK_MANAGEMENT_IU_SIZE)
+    {
+        task_management(me, pkt, tag);
+    }
+    else
+    {
+        push_pending(me, tag, IU_RESPONSE, RC_INVALID_IU);
+    }
+
+    signal_ready(me);
+}
+
+bool cusb_uas_status_in(struct cusb_uas *me, uint8_t *buf, size_t size, size_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && buf && len) );
+    CUSB_ASSERT_PACKET( (size >= CUSB_UAS_STATUS_IU_MAX) );
+
+    if (me->npending != 0U)
+    {
+        memset(buf, 0, RESPONSE_IU_SIZE);
+        buf[0] = me->pending[0].iu;
+        cusb_set_be16(&buf[2], me->pending[0].tag);
+
+        if (me->pending[0].iu == IU_SENSE)
+        {
+            memset(&buf[RESPONSE_IU_SIZE], 0, SENSE_IU_HEADER_SIZE - RESPONSE_IU_SIZE);
+            buf[6] = me->pending[0].code;
+            *len = SENSE_IU_HEADER_SIZE;
+        }
+        else
+        {
+            buf[7] = me->pending[0].code;
+            *len = RESPONSE_IU_SIZE;
+        }
+
+        me->npending--;
+        memmove(&me->pending[0], &me->pending[1], me->npending * sizeof(me->pending[0]));
+        return true;
+    }
+
+    for (uint8_t n = 0; n < me->ntasks; n++)
+    {
+        uint8_t i = (uint8_t)((me->cursor + n) % me->ntasks);
+        size_t iu_len = task_status(me, &me->tasks[i], buf);
+
+        if (iu_len != 0U)
+        {
+            me->cursor = (uint8_t)((i + 1U) % me->ntasks);
+            *len = iu_len;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool cusb_uas_data_in(struct cusb_uas *me, uint8_t *buf, size_t size, size_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && buf && len) );
+    CUSB_ASSERT_PACKET( (size >= me->packet_size && (size % me->packet_size) == 0U) );
+
+    struct cusb_scsi_task *task = me->data_in_owner;
+    size_t n = 0;
+
+    if (task == NULL)
+    {
+        return false;
+    }
+
+    if (task->state == CUSB_SCSI_TASK_DATA_IN)
+    {
+        n = cusb_scsi_task_data_in(task, buf, size);
+    }
+    else if (task->state != CUSB_SCSI_TASK_DONE)
+    {
+        /* Next chunk still being read. */
+        return false;
+    }
+
+    if (cusb_scsi_task_data_in_done(task))
+    {
+        /* Host expects the CDB's length. Anything shorter must end with a short packet. */
+        bool terminated = (cusb_scsi_task_transferred(task) == cusb_scsi_task_expected(task)) ||
+                          ((n % me->packet_size) != 0U);
+
+        if (terminated || n == 0U)
+        {
+            me->data_in_owner = NULL;
+            signal_ready(me);
+        }
+    }
+
+    *len = n;
+    return true;
+}
+
+size_t cusb_uas_data_out_space(const struct cusb_uas *me)
+{
+    CUSB_ASSERT_PACKET( (me) );
+
+    if (me->data_out_owner == NULL)
+    {
+        return 0;
+    }
+
+    return cusb_scsi_task_data_out_space(me->data_out_owner);
+}
+
+void cusb_uas_data_out(struct cusb_uas *me, const uint8_t *pkt, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me && me->data_out_owner) );
+    CUSB_ASSERT_PACKET( (len <= cusb_uas_data_out_space(me)) );
+
+    struct cusb_scsi_task *task = me->data_out_owner;
+
+    cusb_scsi_task_data_out(task, pkt, len);
+
+    if (len < me->packet_size && cusb_scsi_task_data_out_left(task) != 0U)
+    {
+        /* Short packet ends the data phase early. */
+        cusb_scsi_task_data_out_end(task);
+    }
+
+    if (cusb_scsi_task_data_out_left(task) == 0U)
+    {
+        me->data_out_owner = NULL;
+        signal_ready(me);
+    }
+}
+
+void cusb_uas_reset(struct cusb_uas *me)
+{
+    CUSB_ASSERT_API( (me) );
+
+    abort_all(me, NULL);
+    me->data_in_owner = NULL;
+    me->data_out_owner = NULL;
+    me->npending = 0;
+    me->cursor = 0;
+}
+
+#endif /* CUSB_CFG_MSC_UAS */
@@ -0,0 +1,676 @@
+/**
+ * @file
+ * @brief See @ref usbtmc.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "cusb/usbtmc.h"
+
+/* SETUP fields and endian accessors. */
+#include "cusb/setup.h"
+
+/* STDLib. */
+#include <string.h>
+
+/* Trace points. */
+#include "cusb/trace.h"
+
+/* Runtime asserts. */
+#include "cusb/assert.h"
+
+#if (CUSB_CFG_USBTMC)
+
+/*------------------------------------------------------------*/
+/*------------------ DEFINE FILE NAME FOR ASSERTER -----------*/
+/*------------------------------------------------------------*/
+
+ECU_ASSERT_DEFINE_NAME("cusb/usbtmc.c")
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @name Bulk MsgIDs
+ */
+/**@{*/
+#define MSG_DEV_DEP_MSG_OUT             (1U)
+#define MSG_REQUEST_DEV_DEP_MSG_IN      (2U)
+#define MSG_DEV_DEP_MSG_IN              (2U)
+#define MSG_VENDOR_SPECIFIC_OUT         (126U)
+#define MSG_REQUEST_VENDOR_SPECIFIC_IN  (127U)
+#define MSG_USB488_TRIGGER              (128U)
+/**@}*/
+
+/**
+ * @name bmTransferAttributes
+ */
+/**@{*/
+#define ATTR_EOM                        (1U << 0)
+#define ATTR_TERMCHAR                   (1U << 1)
+/**@}*/
+
+/**
+ * @name Class Requests
+ */
+/**@{*/
+#define REQ_INITIATE_ABORT_BULK_OUT     (1U)
+#define REQ_CHECK_ABORT_BULK_OUT_STATUS (2U)
+#define REQ_INITIATE_ABORT_BULK_IN      (3U)
+#define REQ_CHECK_ABORT_BULK_IN_STATUS  (4U)
+#define REQ_INITIATE_CLEAR              (5U)
+#define REQ_CHECK_CLEAR_STATUS          (6U)
+#define REQ_GET_CAPABILITIES            (7U)
+#define REQ_INDICATOR_PULSE             (64U)
+#define REQ_USB488_READ_STATUS_BYTE     (128U)
+#define REQ_USB488_REN_CONTROL          (160U)
+#define REQ_USB488_GO_TO_LOCAL          (161U)
+#define REQ_USB488_LOCAL_LOCKOUT        (162U)
+/**@}*/
+
+/**
+ * @name USBTMC_status Values
+ */
+/**@{*/
+#define STATUS_SUCCESS                  (0x01U)
+#define STATUS_PENDING                  (0x02U)
+#define STATUS_FAILED                   (0x80U)
+#define STATUS_TRANSFER_NOT_IN_PROGRESS (0x81U)
+/**@}*/
+
+/**
+ * @brief Returns number of alignment bytes that pad @p n
+ * message bytes plus the header to a multiple of 4.
+ */
+#define ALIGNMENT_PADDING(n)            ((uint32_t)((4U - ((n) & 3U)) & 3U))
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Parses a Bulk-OUT header. Returns false if bTagInverse
+ * does not match.
+ */
+static bool process_header(struct cusb_usbtmc *me, const uint8_t *pkt, size_t len);
+
+/**
+ * @brief Forwards message bytes of the current Bulk-OUT transfer
+ * to the application, skipping alignment bytes.
+ */
+static void process_payload(struct cusb_usbtmc *me, const uint8_t *data, size_t len);
+
+/**
+ * @brief Starts a Bulk-IN transfer answering the pending request.
+ * Returns number of bytes written to @p buf.
+ */
+static size_t start_in_transfer(struct cusb_usbtmc *me, uint8_t *buf, size_t size);
+
+/**
+ * @brief Writes the DEV_DEP_MSG_IN header for a transfer of @p nbytes.
+ */
+static void write_in_header(const struct cusb_usbtmc *me, uint8_t *buf, uint32_t nbytes, uint8_t attributes);
+
+/**
+ * @brief Continues the current Bulk-IN transfer at @p buf. Returns
+ * number of bytes written.
+ */
+static size_t continue_in_transfer(struct cusb_usbtmc *me, uint8_t *buf, size_t size);
+
+/**
+ * @brief Ends the current Bulk-IN transfer, queueing a ZLP if the
+ * last chunk of @p n bytes was a whole number of packets.
+ */
+static void end_in_transfer(struct cusb_usbtmc *me, size_t n);
+
+static void clear_all(struct cusb_usbtmc *me);
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static bool process_header(struct cusb_usbtmc *me, const uint8_t *pkt, size_t len)
+{
+    uint8_t msg_id = pkt[0];
+    uint8_t btag = pkt[1];
+
+    if (btag == 0 || (uint8_t)(btag ^ pkt[2]) != 0xFFU)
+    {
+        return false;
+    }
+
+    CUSB_TRACE(CUSB_TRACE_USBTMC_MESSAGE, msg_id);
+
+    switch (msg_id)
+    {
+        case MSG_DEV_DEP_MSG_OUT:
+        case MSG_VENDOR_SPECIFIC_OUT:
+        {
+            uint32_t size = cusb_get_le32(&pkt[4]);
+
+            me->out.msg_id = msg_id;
+            me->out.btag = btag;
+            me->out.remaining = size;
+            me->out.padding = ALIGNMENT_PADDING(size);
+            me->out.nbytes_rxd = 0;
+            me->out.eom = ((pkt[8] & ATTR_EOM) != 0);
+            me->out.active = true;
+
+            if (size == 0 && msg_id == MSG_DEV_DEP_MSG_OUT)
+            {
+                (*me->api->receive)(me->ctx, &pkt[CUSB_USBTMC_HEADER_SIZE], 0, me->out.eom);
+            }
+
+            process_payload(me, &pkt[CUSB_USBTMC_HEADER_SIZE], len - CUSB_USBTMC_HEADER_SIZE);
+            break;
+        }
+
+        case MSG_REQUEST_DEV_DEP_MSG_IN:
+        {
+            me->in.btag = btag;
+            me->in.max = cusb_get_le32(&pkt[4]);
+            me->in.termchar_enabled = ((pkt[8] & ATTR_TERMCHAR) != 0);
+            me->in.termchar = pkt[9];
+            me->in.requested = true;
+            me->in.aborted = false;
+            break;
+        }
+
+        case MSG_USB488_TRIGGER:
+        {
+            me->out.btag = btag;
+
+            if (me->api->trigger)
+            {
+                (*me->api->trigger)(me->ctx);
+            }
+            break;
+        }
+
+        default:
+        {
+            /* REQUEST_VENDOR_SPECIFIC_IN and unknown MsgIDs are not supported. */
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void process_payload(struct cusb_usbtmc *me, const uint8_t *data, size_t len)
+{
+    size_t n = (len > me->out.remaining) ? me->out.remaining : len;
+
+    if (n > 0)
+    {
+        me->out.remaining -= (uint32_t)n;
+        me->out.nbytes_rxd += (uint32_t)n;
+
+        /* Vendor specific messages are dropped. Device dependent ones go straight to the app. */
+        if (me->out.msg_id == MSG_DEV_DEP_MSG_OUT)
+        {
+            (*me->api->receive)(me->ctx, data, n, (me->out.remaining == 0 && me->out.eom));
+        }
+    }
+
+    len -= n;
+    n = (len > me->out.padding) ? me->out.padding : len;
+    me->out.padding -= (uint32_t)n;
+
+    if (me->out.remaining == 0 && me->out.padding == 0)
+    {
+        me->out.active = false;
+    }
+}
+
+static void write_in_header(const struct cusb_usbtmc *me, uint8_t *buf, uint32_t nbytes, uint8_t attributes)
+{
+    buf[0] = MSG_DEV_DEP_MSG_IN;
+    buf[1] = me->in.btag;
+    buf[2] = (uint8_t)~me->in.btag;
+    buf[3] = 0;
+    cusb_set_le32(&buf[4], nbytes);
+    buf[8] = attributes;
+    buf[9] = 0;
+    buf[10] = 0;
+    buf[11] = 0;
+}
+
+static size_t start_in_transfer(struct cusb_usbtmc *me, uint8_t *buf, size_t size)
+{
+    uint32_t nbytes = me->resp.total - me->resp.offset;
+    uint8_t attributes = 0;
+
+    if (nbytes > me->in.max)
+    {
+        nbytes = me->in.max;
+    }
+
+    me->in.requested = false;
+    me->in.active = true;
+    me->in.nbytes_txd = 0;
+
+    if (me->in.termchar_enabled)
+    {
+        /* The transfer must end right after the first TermChar. TransferSize has to be
+        known before the header goes out, so the transfer is limited to what fits in this
+        chunk and scanned in place. TermChar is for short text replies, large binary
+        blocks are read with it disabled and take the streaming path below. */
+        size_t want = size - CUSB_USBTMC_HEADER_SIZE;
+        size_t got;
+
+        if (want > nbytes)
+        {
+            want = nbytes;
+        }
+
+        got = (*me->api->read)(me->ctx, me->resp.offset, &buf[CUSB_USBTMC_HEADER_SIZE], want);
+        nbytes = (uint32_t)got;
+
+        for (uint32_t i = 0; i < nbytes; i++)
+        {
+            if (buf[CUSB_USBTMC_HEADER_SIZE + i] == me->in.termchar)
+            {
+                nbytes = i + 1U;
+                attributes |= ATTR_TERMCHAR;
+                break;
+            }
+        }
+
+        me->resp.offset += nbytes;
+        me->in.nbytes_txd = nbytes;
+
+        if (got < want && (attributes & ATTR_TERMCHAR) == 0)
+        {
+            /* Application returned less than asked. Response ends here. */
+            me->resp.total = me->resp.offset;
+        }
+
+        if (me->resp.offset == me->resp.total)
+        {
+            attributes |= ATTR_EOM;
+        }
+
+        /* Packet size is a multiple of 4 so the padding always fits in the chunk. */
+        write_in_header(me, buf, nbytes, attributes);
+        me->in.remaining = 0;
+        me->in.padding = 0;
+        memset(&buf[CUSB_USBTMC_HEADER_SIZE + nbytes], 0, ALIGNMENT_PADDING(nbytes));
+        return CUSB_USBTMC_HEADER_SIZE + nbytes + ALIGNMENT_PADDING(nbytes);
+    }
+
+    if (me->resp.offset + nbytes == me->resp.total)
+    {
+        attributes |= ATTR_EOM;
+    }
+
+    write_in_header(me, buf, nbytes, attributes);
+    me->in.remaining = nbytes;
+    me->in.padding = ALIGNMENT_PADDING(nbytes);
+    return CUSB_USBTMC_HEADER_SIZE + continue_in_transfer(me, &buf[CUSB_USBTMC_HEADER_SIZE],
+                                                          size - CUSB_USBTMC_HEADER_SIZE);
+}
+
+static size_t continue_in_transfer(struct cusb_usbtmc *me, uint8_t *buf, size_t size)
+{
+    size_t n = 0;
+
+    while (n < size && me->in.remaining > 0)
+    {
+        size_t want = size - n;
+        size_t got;
+
+        if (want > me->in.remaining)
+        {
+            want = me->in.remaining;
+        }
+
+        /* Message bytes go straight from the application into the transfer buffer. */
+        got = (*me->api->read)(me->ctx, me->resp.offset, &buf[n], want);
+        n += got;
+        me->resp.offset += (uint32_t)got;
+        me->in.remaining -= (uint32_t)got;
+        me->in.nbytes_txd += (uint32_t)got;
+
+        if (got < want)
+        {
+            /* Application ran out early. Header already promised more, so the short
+            packet that follows ends the transfer and the response is dropped. */
+            me->in.remaining = 0;
+            me->in.padding = 0;
+            me->resp.total = me->resp.offset;
+        }
+    }
+
+    while (n < size && me->in.remaining == 0 && me->in.padding > 0)
+    {
+        buf[n++] = 0;
+        me->in.padding--;
+    }
+
+    return n;
+}
+
+static void end_in_transfer(struct cusb_usbtmc *me, size_t n)
+{
+    me->in.active = false;
+    /* An empty chunk is already the short packet that ends the transfer. */
+    me->in.zlp_pending = (n != 0U && (n % me->packet_size) == 0U);
+
+    if (me->resp.offset == me->resp.total)
+    {
+        me->resp.available = false;
+    }
+}
+
+static void clear_all(struct cusb_usbtmc *me)
+{
+    memset(&me->out, 0, sizeof(me->out));
+    memset(&me->in, 0, sizeof(me->in));
+    memset(&me->resp, 0, sizeof(me->resp));
+}
+
+/*------------------------------------------------------------*/
+/*------------------- USBTMC MEMBER FUNCTIONS ----------------*/
+/*------------------------------------------------------------*/
+
+void cusb_usbtmc_ctor(struct cusb_usbtmc *me,
+                      const struct cusb_usbtmc_api *api,
+                      void *ctx,
+                      uint16_t packet_size)
+{
+    CUSB_ASSERT_API( (me && api) );
+    CUSB_ASSERT_API( (api->receive && api->read) );
+    CUSB_ASSERT_API( (packet_size >= 16U && (packet_size % 4U) == 0) );
+    CUSB_ASSERT_API( (packet_size <= CUSB_CFG_BULK_SIZE_MAX) );
+
+    me->api = api;
+    me->ctx = ctx;
+    me->packet_size = packet_size;
+    clear_all(me);
+}
+
+bool cusb_usbtmc_respond(struct cusb_usbtmc *me, uint32_t len)
+{
+    CUSB_ASSERT_API( (me) );
+
+    if (me->resp.available)
+    {
+        return false;
+    }
+
+    me->resp.total = len;
+    me->resp.offset = 0;
+    me->resp.available = true;
+    return true;
+}
+
+bool cusb_usbtmc_bulk_out(struct cusb_usbtmc *me, const uint8_t *pkt, size_t len)
+{
+    CUSB_ASSERT_PACKET( (me) );
+    CUSB_ASSERT_PACKET( (pkt || len == 0) );
+
+    if (me->out.active)
+    {
+        process_payload(me, pkt, len);
+
+        if (me->out.active && len < me->packet_size)
+        {
+            /* Short packet ended the transfer early. */
+            me->out.active = false;
+        }
+
+        return true;
+    }
+
+    if (len == 0)
+    {
+        /* ZLP terminating a previous transfer. */
+        return true;
+    }
+
+    if (len < CUSB_USBTMC_HEADER_SIZE)
+    {
+        return false;
+    }
+
+    return process_header(me, pkt, len);
+}
+
+bool cusb_usbtmc_bulk_in(struct cusb_usbtmc *me, uint8_t *buf, size_t size, size_t *len)
+{
+    CUSB_ASSERT_PACKET( (me && buf && len) );
+    CUSB_ASSERT_PACKET( (size >= me->packet_size && (size % me->packet_size) == 0) );
+
+    if (me->in.zlp_pending)
+    {
+        me->in.zlp_pending = false;
+        *len = 0;
+        return true;
+    }
+
+    if (me->in.active)
+    {
+        if (me->in.aborted)
+        {
+            /* Abort ends the transfer with a short packet. */
+            me->in.active = false;
+            *len = 0;
+            return true;
+        }
+
+        *len = continue_in_transfer(me, buf, size);
+    }
+    else if (me->in.requested && me->resp.available)
+    {
+        *len = start_in_transfer(me, buf, size);
+    }
+    else
+    {
+        return false;
+    }
+
+    if (me->in.remaining == 0 && me->in.padding == 0)
+    {
+        /* Chunks before the last one are always whole packets, so the
+        last chunk's length alone decides whether a ZLP must follow. */
+        end_in_transfer(me, *len);
+    }
+
+    return true;
+}
+
+bool cusb_usbtmc_control(struct cusb_usbtmc *me, const uint8_t *setup,
+                         uint8_t *resp, size_t *resp_len)
+{
+    CUSB_ASSERT_API( (me && setup && resp && resp_len) );
+    uint8_t request = cusb_setup_request(setup);
+    uint16_t value = cusb_setup_value(setup);
+    uint16_t length = cusb_setup_length(setup);
+    size_t n = 0;
+
+    switch (request)
+    {
+        case REQ_INITIATE_ABORT_BULK_OUT:
+        {
+            uint8_t btag = (uint8_t)value;
+
+            if (!me->out.active)
+            {
+                resp[0] = STATUS_TRANSFER_NOT_IN_PROGRESS;
+            }
+            else if (btag != me->out.btag)
+            {
+                resp[0] = STATUS_FAILED;
+            }
+            else
+            {
+                me->out.active = false;
+                resp[0] = STATUS_SUCCESS;
+
+                if (me->api->clear)
+                {
+                    (*me->api->clear)(me->ctx);
+                }
+            }
+
+            resp[1] = me->out.btag;
+            n = 2;
+            break;
+        }
+
+        case REQ_CHECK_ABORT_BULK_OUT_STATUS:
+        {
+            memset(resp, 0, 8);
+            resp[0] = STATUS_SUCCESS;
+            cusb_set_le32(&resp[4], me->out.nbytes_rxd);
+            n = 8;
+            break;
+        }
+
+        case REQ_INITIATE_ABORT_BULK_IN:
+        {
+            uint8_t btag = (uint8_t)value;
+
+            if (!me->in.active && !me->in.requested)
+            {
+                resp[0] = STATUS_TRANSFER_NOT_IN_PROGRESS;
+            }
+            else if (btag != me->in.btag)
+            {
+                resp[0] = STATUS_FAILED;
+            }
+            else
+            {
+                me->in.aborted = true;
+                me->in.requested = false;
+                me->resp.available = false;
+                resp[0] = STATUS_SUCCESS;
+            }
+
+            resp[1] = me->in.btag;
+            n = 2;
+            break;
+        }
+
+        case REQ_CHECK_ABORT_BULK_IN_STATUS:
+        {
+            memset(resp, 0, 8);
+            resp[0] = STATUS_SUCCESS;
+
+            if (me->in.active || me->in.zlp_pending)
+            {
+                /* Short packet ending the transfer not sent yet. Host must keep reading. */
+                resp[0] = STATUS_PENDING;
+                resp[1] = 0x01;
+            }
+
+            cusb_set_le32(&resp[4], me->in.nbytes_txd);
+            n = 8;
+            break;
+        }
+
+        case REQ_INITIATE_CLEAR:
+        {
+            clear_all(me);
+
+            if (me->api->clear)
+            {
+                (*me->api->clear)(me->ctx);
+            }
+
+            resp[0] = STATUS_SUCCESS;
+            n = 1;
+            break;
+        }
+
+        case REQ_CHECK_CLEAR_STATUS:
+        {
+            resp[0] = STATUS_SUCCESS;
+            resp[1] = 0;
+            n = 2;
+            break;
+        }
+
+        case REQ_GET_CAPABILITIES:
+        {
+            memset(resp, 0, CUSB_USBTMC_CONTROL_RESPONSE_MAX);
+            resp[0] = STATUS_SUCCESS;
+            resp[2] = 0x00;     /* bcdUSBTMC 1.00. */
+            resp[3] = 0x01;
+            resp[4] = (me->api->indicator_pulse) ? 0x04U : 0x00U;
+            resp[5] = 0x01;     /* TermChar supported. */
+            resp[12] = 0x00;    /* bcdUSB488 1.00. */
+            resp[13] = 0x01;
+            resp[14] = (uint8_t)(0x04U | ((me->api->remote_local) ? 0x02U : 0x00U) |
+                                 ((me->api->trigger) ? 0x01U : 0x00U));
+            resp[15] = (uint8_t)(0x08U | ((me->api->remote_local) ? 0x02U : 0x00U) |
+                                 ((me->api->trigger) ? 0x01U : 0x00U));
+            n = CUSB_USBTMC_CONTROL_RESPONSE_MAX;
+            break;
+        }
+
+        case REQ_INDICATOR_PULSE:
+        {
+            if (!me->api->indicator_pulse)
+            {
+                return false;
+            }
+
+            (*me->api->indicator_pulse)(me->ctx);
+            resp[0] = STATUS_SUCCESS;
+            n = 1;
+            break;
+        }
+
+        case REQ_USB488_READ_STATUS_BYTE:
+        {
+            /* No interrupt endpoint so the status byte is returned here. */
+            resp[0] = STATUS_SUCCESS;
+            resp[1] = (uint8_t)value;
+            resp[2] = (me->api->status_byte) ? (*me->api->status_byte)(me->ctx) : 0U;
+            n = 3;
+            break;
+        }
+
+        case REQ_USB488_REN_CONTROL:
+        case REQ_USB488_GO_TO_LOCAL:
+        case REQ_USB488_LOCAL_LOCKOUT:
+        {
+            if (!me->api->remote_local)
+            {
+                return false;
+            }
+
+            (*me->api->remote_local)(me->ctx, request, value);
+            resp[0] = STATUS_SUCCESS;
+            n = 1;
+            break;
+        }
+
+        default:
+        {
+            return false;
+        }
+    }
+
+    *resp_len = (n > length) ? length : n;
+    return true;
+}
+
+void cusb_usbtmc_reset(struct cusb_usbtmc *me)
+{
+    CUSB_ASSERT_API( (me) );
+    clear_all(me);
+}
+
+#endif /* CUSB_CFG_USBTMC */
@@ -0,0 +1,225 @@
+/**
+ * @file
+ * @brief Measurements of the asserts benchmark at one assert level. Runs
+ * the per-packet paths that carry the most checks with small packets, so
+ * the checks are a large share of the work:
+ *
+ * - A stream IN pipe producing, arming and completing 64 byte packets.
+ * - The device core receiving 64 byte bulk OUT packets from the
+ *   simulated host in interrupt mode.
+ * - CRC-32 over 4 byte words, one update each.
+ *
+ * The benchmark build links this against one copy of the library per
+ * level (CUSB_BENCHMARK_ASSERTS_NONE, _API, _INTERNAL and _PACKET), and
+ * bench_asserts.c runs all four and prints them side by side. Each line
+ * printed is a measurement name and its ns per operation, tab separated.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/crc32.h"
+#include "cusb/device.h"
+#include "cusb/sim.h"
+#include "cusb/stream.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define PACKET_SIZE         (64U)
+#define RING_SIZE           (4096U)
+#define PACKETS             (4UL * 1024UL * 1024UL)
+#define WORDS               (16UL * 1024UL * 1024UL)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static bool configure(void *obj, uint8_t config);
+
+static void done(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok);
+
+static void isr(void *obj);
+
+/**
+ * @brief Prints one measurement for bench_asserts.c to parse.
+ */
+static void report(const char *name, uint64_t ops, uint64_t ns);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0xFF, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0, 0, 0, 1
+};
+
+static const uint8_t CONFIG_DESC[9 + 9 + 7] =
+{
+    9, 2, 9 + 9 + 7, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 1, 0xFF, 0x00, 0x00, 0,
+    7, 5, 0x01, 2, PACKET_SIZE, 0x00, 0
+};
+
+static const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, NULL, NULL, 0};
+
+static const struct cusb_device_callbacks CALLBACKS = {&configure, NULL, NULL, NULL, NULL};
+
+static struct cusb_sim sim;
+
+static struct cusb_device dev;
+
+static struct cusb_stream pipe;
+
+static struct cusb_crc32 crc;
+
+static uint8_t ring[RING_SIZE];
+
+static uint8_t rx[PACKET_SIZE];
+
+static uint8_t packet[PACKET_SIZE];
+
+static uint32_t received;
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static bool configure(void *obj, uint8_t config)
+{
+    (void)obj;
+
+    if (config != 0U)
+    {
+        cusb_device_ep_open(&dev, 0x01U, CUSB_EP_BULK, PACKET_SIZE, &done, NULL);
+        (void)cusb_device_ep_xfer(&dev, 0x01U, rx, PACKET_SIZE);
+    }
+
+    return true;
+}
+
+static void done(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok)
+{
+    (void)obj;
+    (void)ok;
+    received += len;
+    (void)cusb_device_ep_xfer(&dev, ep, buf, PACKET_SIZE);
+}
+
+static void isr(void *obj)
+{
+    cusb_isr((struct cusb_device *)obj);
+}
+
+static void report(const char *name, uint64_t ops, uint64_t ns)
+{
+    printf("%s\t%.2f\n", name, (double)ns / (double)ops);
+}
+
+static void stream_packets(void)
+{
+    struct cusb_stream_iov iov[2];
+    size_t len = 0;
+
+    cusb_stream_ctor(&pipe, CUSB_STREAM_IN, ring, sizeof(ring), PACKET_SIZE);
+    cusb_stream_set_watermark(&pipe, PACKET_SIZE);
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < PACKETS; i++)
+    {
+        bench_sink((uint32_t)cusb_stream_write_space(&pipe, iov));
+        cusb_stream_write_commit(&pipe, PACKET_SIZE);
+
+        if (cusb_stream_in_acquire(&pipe, iov, PACKET_SIZE, &len))
+        {
+            cusb_stream_in_complete(&pipe);
+        }
+    }
+
+    report("stream IN, packets", PACKETS, bench_now_ns() - begin);
+    bench_sink((uint32_t)len);
+}
+
+static void device_packets(void)
+{
+    static const uint8_t SET_ADDRESS[8] = {0x00, 5, 1, 0, 0, 0, 0, 0};
+    static const uint8_t SET_CONFIGURATION[8] = {0x00, 9, 1, 0, 0, 0, 0, 0};
+
+    cusb_sim_ctor(&sim, CUSB_SPEED_HIGH, &isr, &dev);
+    cusb_device_ctor(&dev, &sim.dcd, &DESCRIPTORS, &CALLBACKS, NULL);
+    cusb_device_start(&dev, false);
+    cusb_sim_host_reset(&sim);
+    (void)cusb_sim_host_control(&sim, SET_ADDRESS, NULL, NULL);
+    (void)cusb_sim_host_control(&sim, SET_CONFIGURATION, NULL, NULL);
+    received = 0;
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < PACKETS; i++)
+    {
+        (void)cusb_sim_host_out(&sim, 0x01U, packet, PACKET_SIZE);
+    }
+
+    report("device bulk OUT, packets", PACKETS, bench_now_ns() - begin);
+    bench_sink(received);
+}
+
+static void crc_words(void)
+{
+    uint32_t word = 0x12345678UL;
+
+    cusb_crc32_ctor(&crc);
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < WORDS; i++)
+    {
+        cusb_crc32_update(&crc, &word, sizeof(word));
+    }
+
+    report("CRC-32, 4 byte updates", WORDS, bench_now_ns() - begin);
+    bench_sink(cusb_crc32_value(&crc));
+}
+
+/*------------------------------------------------------------*/
+/*--------------------------- MAIN ---------------------------*/
+/*------------------------------------------------------------*/
+
+int main(void)
+{
+    stream_packets();
+    device_packets();
+    crc_words();
+    return 0;
+}
+
+/*------------------------------------------------------------*/
+/*---------------- ASSERT HANDLER DEFINITION -----------------*/
+/*------------------------------------------------------------*/
+
+void ecu_assert_handler(const char *file, int line)
+{
+    fprintf(stderr, "Assert fired at %s:%d\n", file, line);
+    abort();
+}
@@ -0,0 +1,77 @@
+/**
+ * @file
+ * @brief Minimal timing harness shared by all benchmarks. Every
+ * benchmark is a void function registered in main.c. Results are
+ * printed as one line per measurement so runs can be diffed.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef BENCH_H_
+#define BENCH_H_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* STDLib. */
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*------------------------ BENCH FUNCTIONS -------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+extern uint64_t bench_now_ns(void);
+
+/**
+ * @brief Prints throughput of one measurement.
+ *
+ * @param name Name of what was measured.
+ * @param bytes Number of bytes processed.
+ * @param ns Time it took in nanoseconds.
+ */
+extern void bench_report_throughput(const char *name, uint64_t bytes, uint64_t ns);
+
+/**
+ * @brief Prints rate and cost per operation of one measurement.
+ *
+ * @param name Name of what was measured.
+ * @param ops Number of operations performed, e.g. packets.
+ * @param ns Time it took in nanoseconds.
+ */
+extern void bench_report_rate(const char *name, uint64_t ops, uint64_t ns);
+
+/**
+ * @brief Prevents the compiler from optimizing away a result.
+ */
+extern void bench_sink(uint32_t value);
+
+/**
+ * @name Benchmarks
+ */
+/**@{*/
+extern void bench_asrc(void);
+extern void bench_asserts(void);
+extern void bench_blockcache(void);
+extern void bench_coalesce(void);
+extern void bench_crc32(void);
+extern void bench_device(void);
+extern void bench_diskimage(void);
+extern void bench_load(void);
+extern void bench_midi(void);
+extern void bench_ptybridge(void);
+extern void bench_rndis(void);
+extern void bench_rtt(void);
+extern void bench_scsi(void);
+extern void bench_stream(void);
+extern void bench_uas(void);
+extern void bench_usbtmc(void);
+/**@}*/
+
+#endif /* BENCH_H_ */
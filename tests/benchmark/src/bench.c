@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @brief See @ref bench.h
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* clock_gettime() is POSIX, not C11. */
+#define _POSIX_C_SOURCE 200809L
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* STDLib. */
+#include <stdio.h>
+#include <time.h>
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static volatile uint32_t sink;
+
+/*------------------------------------------------------------*/
+/*------------------------ BENCH FUNCTIONS -------------------*/
+/*------------------------------------------------------------*/
+
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+void bench_report_throughput(const char *name, uint64_t bytes, uint64_t ns)
+{
+    double mib_per_s = ((double)bytes / (1024.0 * 1024.0)) / ((double)ns / 1e9);
+    printf("  %-40s %12.1f MiB/s %14.3f ms\n", name, mib_per_s, (double)ns / 1e6);
+}
+
+void bench_report_rate(const char *name, uint64_t ops, uint64_t ns)
+{
+    double ops_per_s = (double)ops / ((double)ns / 1e9);
+    printf("  %-40s %12.0f ops/s %14.2f ns/op\n", name, ops_per_s, (double)ns / (double)ops);
+}
+
+void bench_sink(uint32_t value)
+{
+    sink = value;
+}
@@ -0,0 +1,177 @@
+/**
+ * @file
+ * @brief Sample-rate converter filter backends and drift tracking.
+ *
+ * - Filter: output samples per second of each backend, and of the
+ *   whole read path for a 48 kHz stereo stream, as a multiple of real
+ *   time.
+ * - Drift: ten simulated minutes of a host whose clock is off by a
+ *   few hundred ppm, sending 1 ms packets, against a codec pulling
+ *   2.5 ms blocks. Prints the converged correction, its wobble, the
+ *   fill range and the clicks a plain FIFO would have made instead.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/asrc.h"
+
+/* STDLib. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define RATE            (48000U)
+#define CHANNELS        (2U)
+#define SIZE            (512U)
+#define BLOCK           (120U)
+#define PACKET          (RATE / 1000U)
+#define SAMPLES         (16UL * 1024UL * 1024UL)
+#define DRIFT_SECONDS   (600U)
+#define SETTLE_SECONDS  (10U)
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static struct cusb_asrc asrc;
+
+static int16_t mem[2U * SIZE * CHANNELS];
+
+static int16_t input[4096];
+
+static int16_t out[BLOCK * CHANNELS];
+
+static uint8_t pkt[(PACKET + 1U) * CHANNELS * 2U];
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void backend(const char *name, int16_t (*fir)(const int16_t *, const int16_t *, uint32_t))
+{
+    uint32_t sum = 0;
+    uint32_t frac = 0;
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < SAMPLES; i++)
+    {
+        frac += 0x9E3779B9UL;
+        sum += (uint16_t)fir(&input[i & 2047U], cusb_asrc_phase(frac >> 26), (frac >> 11) & 0x7FFFU);
+    }
+
+    bench_report_rate(name, SAMPLES, bench_now_ns() - begin);
+    bench_sink(sum);
+}
+
+static void read_path(void)
+{
+    uint64_t frames = 0;
+    uint64_t ns = 0;
+
+    cusb_asrc_ctor(&asrc, mem, SIZE, CHANNELS);
+
+    while (frames < SAMPLES / CHANNELS)
+    {
+        (void)cusb_asrc_write(&asrc, (const uint8_t *)input, (SIZE / 2U) * CHANNELS * 2U);
+
+        uint64_t begin = bench_now_ns();
+        cusb_asrc_read(&asrc, out, SIZE / 2U);
+        ns += bench_now_ns() - begin;
+        frames += SIZE / 2U;
+    }
+
+    bench_report_rate("read, stereo frames", frames, ns);
+    printf("  %.0fx real time at %u Hz\n", (double)frames * 1e9 / (double)ns / RATE, RATE);
+    bench_sink((uint32_t)out[0]);
+}
+
+static void drift(int32_t ppm)
+{
+    int32_t lo = INT32_MAX;
+    int32_t hi = INT32_MIN;
+    uint32_t fill_lo = UINT32_MAX;
+    uint32_t fill_hi = 0;
+    uint64_t sent = 0;
+    uint64_t ms = 0;
+
+    cusb_asrc_ctor(&asrc, mem, SIZE, CHANNELS);
+
+    /* Time runs in codec frames. The host's packets land every
+    1 ms of its own clock. */
+    for (uint64_t now = BLOCK; now <= (uint64_t)DRIFT_SECONDS * RATE; now += BLOCK)
+    {
+        while ((ms + 1U) * PACKET * 1000000U <= now * (uint64_t)(1000000 + ppm))
+        {
+            ms++;
+            uint32_t frames = (uint32_t)(ms * PACKET - sent);
+            (void)cusb_asrc_write(&asrc, pkt, frames * CHANNELS * 2U);
+            sent += frames;
+        }
+
+        cusb_asrc_read(&asrc, out, BLOCK);
+
+        if (now > (uint64_t)SETTLE_SECONDS * RATE)
+        {
+            int32_t p = cusb_asrc_ppm(&asrc);
+            uint32_t f = cusb_asrc_fill(&asrc);
+            lo = (p < lo) ? p : lo;
+            hi = (p > hi) ? p : hi;
+            fill_lo = (f < fill_lo) ? f : fill_lo;
+            fill_hi = (f > fill_hi) ? f : fill_hi;
+        }
+    }
+
+#if (CUSB_CFG_STATS)
+    uint32_t glitches = cusb_asrc_get_stats(&asrc)->underruns + cusb_asrc_get_stats(&asrc)->overflows;
+#else
+    uint32_t glitches = 0;
+#endif
+
+    /* A plain FIFO drops or repeats a frame for every frame of drift. */
+    printf("  host %+5ld ppm: corrected %+5ld ppm (%+ld..%+ld), fill %lu..%lu of %u, "
+           "%lu glitches, plain FIFO %lu\n",
+           (long)ppm, (long)cusb_asrc_ppm(&asrc), (long)lo, (long)hi,
+           (unsigned long)fill_lo, (unsigned long)fill_hi, SIZE, (unsigned long)glitches,
+           (unsigned long)(((uint64_t)DRIFT_SECONDS * RATE * (uint64_t)(ppm < 0 ? -ppm : ppm)) / 1000000U));
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_asrc(void)
+{
+    uint32_t seed = 1;
+
+    for (size_t i = 0; i < sizeof(input) / sizeof(input[0]); i++)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        input[i] = (int16_t)(seed >> 18);
+    }
+
+    backend("portable C, samples", &cusb_asrc_fir_c);
+#if (CUSB_ASRC_HAS_SSE2)
+    backend("sse2, samples", &cusb_asrc_fir_sse2);
+#endif
+#if (CUSB_ASRC_HAS_DSP)
+    backend("cortex-m dsp, samples", &cusb_asrc_fir_dsp);
+#endif
+    read_path();
+    drift(300);
+    drift(-750);
+}
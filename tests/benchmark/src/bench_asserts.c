@@ -0,0 +1,130 @@
+/**
+ * @file
+ * @brief Cost of each runtime assert level on the transfer path. The
+ * level is a compile time option, so one process cannot measure more than
+ * one. The benchmark build therefore compiles the library once per level
+ * and links each copy into its own executable (see asserts/main.c). This
+ * runs all four from the directory they were built in and prints their
+ * ns per operation side by side.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* popen() and pclose() are POSIX, not C11. */
+#define _POSIX_C_SOURCE 200809L
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/* Set by the benchmark build to where the per level executables are. */
+#ifndef BENCH_ASSERTS_DIR
+#define BENCH_ASSERTS_DIR   "."
+#endif
+
+#define LEVEL_COUNT         (4U)
+#define MEASUREMENT_COUNT   (3U)
+#define LINE_SIZE           (128U)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Runs the executable of level @p level and stores its results.
+ * Returns false if it could not be run or printed something unexpected.
+ */
+static bool run_level(size_t level);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const char *const LEVELS[LEVEL_COUNT] = {"NONE", "API", "INTERNAL", "PACKET"};
+
+static char names[MEASUREMENT_COUNT][LINE_SIZE];
+
+static double ns_per_op[MEASUREMENT_COUNT][LEVEL_COUNT];
+
+static char command[512];
+
+static char line[LINE_SIZE];
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static bool run_level(size_t level)
+{
+    size_t count = 0;
+
+    snprintf(command, sizeof(command), "%s/CUSB_BENCHMARK_ASSERTS_%s", BENCH_ASSERTS_DIR, LEVELS[level]);
+    FILE *out = popen(command, "r");
+
+    if (out == NULL)
+    {
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), out) != NULL)
+    {
+        char *tab = strchr(line, '\t');
+
+        if (tab == NULL || count == MEASUREMENT_COUNT)
+        {
+            count = MEASUREMENT_COUNT + 1U;
+            break;
+        }
+
+        *tab = '\0';
+        snprintf(names[count], sizeof(names[count]), "%s", line);
+        ns_per_op[count][level] = strtod(&tab[1], NULL);
+        count++;
+    }
+
+    return (pclose(out) == 0) && (count == MEASUREMENT_COUNT);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_asserts(void)
+{
+    for (size_t level = 0; level < LEVEL_COUNT; level++)
+    {
+        if (!run_level(level))
+        {
+            printf("  %s failed. Build the CUSB_BENCHMARK_ASSERTS_* targets.\n", command);
+            return;
+        }
+    }
+
+#if defined(ECU_DISABLE_RUNTIME_ASSERTS)
+    printf("  every level disabled by ECU_DISABLE_RUNTIME_ASSERTS\n");
+#endif
+    printf("  %-40s %10s %10s %10s %10s\n", "ns/op", LEVELS[0], LEVELS[1], LEVELS[2], LEVELS[3]);
+
+    for (size_t i = 0; i < MEASUREMENT_COUNT; i++)
+    {
+        printf("  %-40s %10.2f %10.2f %10.2f %10.2f\n", names[i],
+               ns_per_op[i][0], ns_per_op[i][1], ns_per_op[i][2], ns_per_op[i][3]);
+    }
+}
@@ -0,0 +1,108 @@
+/**
+ * @file
+ * @brief Compares CRC32 backends verifying a 512 KiB image streamed
+ * in 1 KiB DFU-sized blocks, against a bit-at-a-time baseline.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/crc32.h"
+
+/* STDLib. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define IMAGE_SIZE  (512U * 1024U)
+#define BLOCK_SIZE  (1024U)
+#define ITERATIONS  (64U)
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static uint8_t image[IMAGE_SIZE];
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static uint32_t bitwise(uint32_t crc, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        crc ^= p[i];
+        for (unsigned b = 0; b < 8; b++)
+        {
+            crc = (crc & 1U) ? ((crc >> 1) ^ 0xEDB88320UL) : (crc >> 1);
+        }
+    }
+
+    return crc;
+}
+
+static void run(const char *name, uint32_t (*backend)(uint32_t, const void *, size_t), unsigned iterations)
+{
+    uint64_t start = bench_now_ns();
+
+    for (unsigned i = 0; i < iterations; i++)
+    {
+        uint32_t crc = 0xFFFFFFFFUL;
+
+        for (size_t offset = 0; offset < IMAGE_SIZE; offset += BLOCK_SIZE)
+        {
+            crc = (*backend)(crc, &image[offset], BLOCK_SIZE);
+        }
+
+        bench_sink(crc);
+    }
+
+    bench_report_throughput(name, (uint64_t)IMAGE_SIZE * iterations, bench_now_ns() - start);
+}
+
+static uint32_t api(uint32_t crc, const void *data, size_t len)
+{
+    struct cusb_crc32 me = {crc};
+    cusb_crc32_update(&me, data, len);
+    return me.state;
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_crc32(void)
+{
+    for (size_t i = 0; i < IMAGE_SIZE; i++)
+    {
+        image[i] = (uint8_t)((i * 2654435761UL) >> 13);
+    }
+
+    printf("  512 KiB image in %u byte blocks:\n", BLOCK_SIZE);
+    run("bitwise baseline", &bitwise, 2U);
+    run("slicing-by-8", &cusb_crc32_slice8, ITERATIONS);
+#if (CUSB_CRC32_HAS_PCLMUL)
+    if (cusb_crc32_pclmul_supported())
+    {
+        run("pclmulqdq", &cusb_crc32_pclmul, ITERATIONS);
+    }
+#endif
+    run("cusb_crc32_update", &api, ITERATIONS);
+}
@@ -0,0 +1,352 @@
+/**
+ * @file
+ * @brief Interrupt mode against polled mode of the device core, on the
+ * simulated controller. The benchmark plays the host, sending bulk OUT
+ * packets to four endpoints round robin, and the application, whose
+ * completion callbacks re-arm each endpoint.
+ *
+ * Three things are measured per mode:
+ *
+ * - Packet rate with the host sending back to back. In interrupt mode
+ *   every packet runs the handler. In polled mode the host is NAKed until
+ *   the device polls, and each poll services up to its budget.
+ * - Delivery latency seen by a main loop that does a fixed amount of
+ *   other work per iteration and polls once in it. Packets arrive at a
+ *   random point of the iteration. In interrupt mode they are delivered
+ *   at once, in polled mode only at the next poll.
+ * - Time one handler call or one poll takes with all four endpoints
+ *   pending. This is what the stack adds to a control loop iteration. A
+ *   handler services everything pending, a poll at most its budget.
+ *
+ * Last, the host alternates between two configurations of the four
+ * endpoints, bound in precomputed tables against opened one by one from
+ * the configure callback. The time includes the simulated control
+ * transfer.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/device.h"
+#include "cusb/sim.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define ENDPOINTS           (4U)
+#define PACKET_SIZE         (512U)
+#define PACKETS             (1024UL * 1024UL)
+#define SAMPLES             (200000UL)
+#define LOOP_WORK           (400U)      /* Main loop work per iteration, in spin iterations. */
+#define PASSES              (200000UL)
+#define SWITCHES            (200000UL)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static bool configure(void *obj, uint8_t config);
+
+static void done(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok);
+
+static void isr(void *obj);
+
+static void poll_all(void *obj);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0xFF, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0, 0, 0, 1
+};
+
+static const uint8_t CONFIG_DESC[9 + 9 + 4 * 7] =
+{
+    9, 2, 9 + 9 + 4 * 7, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 4, 0xFF, 0x00, 0x00, 0,
+    7, 5, 0x01, 2, 0x00, 0x02, 0,
+    7, 5, 0x02, 2, 0x00, 0x02, 0,
+    7, 5, 0x03, 2, 0x00, 0x02, 0,
+    7, 5, 0x04, 2, 0x00, 0x02, 0
+};
+
+static const uint8_t CONFIG_2_DESC[9 + 9 + 4 * 7] =
+{
+    9, 2, 9 + 9 + 4 * 7, 0, 1, 2, 0, 0x80, 250,
+    9, 4, 0, 0, 4, 0xFF, 0x01, 0x00, 0,
+    7, 5, 0x01, 2, 0x00, 0x02, 0,
+    7, 5, 0x02, 2, 0x00, 0x02, 0,
+    7, 5, 0x03, 2, 0x00, 0x02, 0,
+    7, 5, 0x04, 2, 0x00, 0x02, 0
+};
+
+static const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, NULL, NULL, 0};
+
+static const struct cusb_device_callbacks CALLBACKS = {&configure, NULL, NULL, NULL, NULL};
+
+static const struct cusb_device_callbacks BOUND_CALLBACKS = {NULL, NULL, NULL, NULL, NULL};
+
+static const struct cusb_device_binding BINDINGS[ENDPOINTS] =
+{
+    {0x01, CUSB_EP_BULK, PACKET_SIZE, &done, NULL, NULL},
+    {0x02, CUSB_EP_BULK, PACKET_SIZE, &done, NULL, NULL},
+    {0x03, CUSB_EP_BULK, PACKET_SIZE, &done, NULL, NULL},
+    {0x04, CUSB_EP_BULK, PACKET_SIZE, &done, NULL, NULL}
+};
+
+static struct cusb_device_config configs[2];
+
+static struct cusb_sim sim;
+
+static struct cusb_device dev;
+
+static uint8_t rx[ENDPOINTS][PACKET_SIZE];
+
+static uint8_t packet[PACKET_SIZE];
+
+/**
+ * @brief Timestamp of the last delivered packet, taken in the callback
+ * while @ref timing is set.
+ */
+static uint64_t delivered_ns;
+
+static bool timing;
+
+static uint32_t received;
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static bool configure(void *obj, uint8_t config)
+{
+    (void)obj;
+
+    for (uint8_t ep = 1; config != 0U && ep <= ENDPOINTS; ep++)
+    {
+        cusb_device_ep_open(&dev, ep, CUSB_EP_BULK, PACKET_SIZE, &done, NULL);
+        (void)cusb_device_ep_xfer(&dev, ep, rx[ep - 1U], PACKET_SIZE);
+    }
+
+    return true;
+}
+
+static void done(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok)
+{
+    (void)obj;
+    (void)ok;
+    delivered_ns = timing ? bench_now_ns() : 0U;
+    received += len;
+    (void)cusb_device_ep_xfer(&dev, ep, buf, PACKET_SIZE);
+}
+
+static void isr(void *obj)
+{
+    cusb_isr((struct cusb_device *)obj);
+}
+
+static void poll_all(void *obj)
+{
+    (void)cusb_poll((struct cusb_device *)obj, SIZE_MAX);
+}
+
+/**
+ * @brief Stands in for the application's own work in a main loop
+ * iteration.
+ */
+static void work(uint32_t spins)
+{
+    for (volatile uint32_t i = 0; i < spins; i++)
+    {
+    }
+}
+
+/**
+ * @brief Brings the device up and configured in the given mode.
+ */
+static void start(bool polled)
+{
+    static const uint8_t SET_ADDRESS[8] = {0x00, 5, 1, 0, 0, 0, 0, 0};
+    static const uint8_t SET_CONFIGURATION[8] = {0x00, 9, 1, 0, 0, 0, 0, 0};
+
+    cusb_sim_ctor(&sim, CUSB_SPEED_HIGH, &isr, &dev);
+    cusb_device_ctor(&dev, &sim.dcd, &DESCRIPTORS, &CALLBACKS, NULL);
+    cusb_device_start(&dev, polled);
+
+    /* Polled device runs whenever the host is NAKed. */
+    cusb_sim_set_idle(&sim, polled ? &poll_all : NULL, &dev);
+    cusb_sim_host_reset(&sim);
+    (void)cusb_sim_host_control(&sim, SET_ADDRESS, NULL, NULL);
+    (void)cusb_sim_host_control(&sim, SET_CONFIGURATION, NULL, NULL);
+
+    if (polled)
+    {
+        /* Status stage completion. */
+        poll_all(&dev);
+    }
+
+    received = 0;
+}
+
+static void throughput(const char *name, bool polled, size_t budget)
+{
+    start(polled);
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < PACKETS; i++)
+    {
+        uint8_t ep = (uint8_t)(1U + (i % ENDPOINTS));
+
+        while (cusb_sim_host_out(&sim, ep, packet, PACKET_SIZE) == CUSB_SIM_NAK)
+        {
+            (void)cusb_poll(&dev, budget);
+        }
+    }
+
+    bench_report_rate(name, PACKETS, bench_now_ns() - begin);
+    bench_sink(received);
+}
+
+static void latency(const char *name, bool polled)
+{
+    uint64_t total = 0;
+    uint32_t seed = 12345U;
+
+    start(polled);
+    timing = true;
+
+    for (uint32_t i = 0; i < SAMPLES; i++)
+    {
+        seed = seed * 1664525U + 1013904223U;
+        uint32_t before = (seed >> 8) % LOOP_WORK;
+
+        work(before);
+        uint64_t sent = bench_now_ns();
+        (void)cusb_sim_host_out(&sim, 0x01U, packet, PACKET_SIZE);
+        work(LOOP_WORK - before);
+
+        if (polled)
+        {
+            (void)cusb_poll(&dev, SIZE_MAX);
+        }
+
+        total += delivered_ns - sent;
+    }
+
+    timing = false;
+    bench_report_rate(name, SAMPLES, total);
+}
+
+/**
+ * @brief Times single service calls with every endpoint pending. The
+ * host side of each pass is outside the measured time.
+ */
+static void pass_cost(const char *name, bool polled, size_t budget)
+{
+    uint64_t total = 0;
+    uint32_t calls = 0;
+
+    start(polled);
+
+    for (uint32_t i = 0; i < PASSES; i++)
+    {
+        /* Mask the interrupt while the host fills the endpoints so the
+        handler sees all of them at once. */
+        (*sim.dcd.api->irq_enable)(sim.dcd.ctx, false);
+
+        for (uint8_t ep = 1; ep <= ENDPOINTS; ep++)
+        {
+            (void)cusb_sim_host_out(&sim, ep, packet, PACKET_SIZE);
+        }
+
+        while (cusb_sim_pending(&sim))
+        {
+            uint64_t begin = bench_now_ns();
+
+            if (polled)
+            {
+                (void)cusb_poll(&dev, budget);
+            }
+            else
+            {
+                cusb_isr(&dev);
+            }
+
+            total += bench_now_ns() - begin;
+            calls++;
+        }
+    }
+
+    bench_report_rate(name, calls, total);
+    bench_sink(received);
+}
+
+static void switching(const char *name, bool bound)
+{
+    static const uint8_t SET_ADDRESS[8] = {0x00, 5, 1, 0, 0, 0, 0, 0};
+    uint8_t set_configuration[8] = {0x00, 9, 1, 0, 0, 0, 0, 0};
+
+    cusb_sim_ctor(&sim, CUSB_SPEED_HIGH, &isr, &dev);
+    cusb_device_ctor(&dev, &sim.dcd, &DESCRIPTORS, bound ? &BOUND_CALLBACKS : &CALLBACKS, NULL);
+
+    if (bound)
+    {
+        cusb_device_config_ctor(&configs[0], CONFIG_DESC, BINDINGS, ENDPOINTS);
+        cusb_device_config_ctor(&configs[1], CONFIG_2_DESC, BINDINGS, ENDPOINTS);
+        cusb_device_set_configs(&dev, configs, 2);
+    }
+
+    cusb_device_start(&dev, false);
+    cusb_sim_host_reset(&sim);
+    (void)cusb_sim_host_control(&sim, SET_ADDRESS, NULL, NULL);
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < SWITCHES; i++)
+    {
+        /* A single configuration can only be left by deconfiguring. */
+        set_configuration[2] = (uint8_t)(bound ? 1U + (i & 1U) : ((i & 1U) ^ 1U));
+        (void)cusb_sim_host_control(&sim, set_configuration, NULL, NULL);
+    }
+
+    bench_report_rate(name, SWITCHES, bench_now_ns() - begin);
+    bench_sink(cusb_device_get_config(&dev));
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_device(void)
+{
+    throughput("interrupt, packets", false, 1U);
+    throughput("polled, budget 1, packets", true, 1U);
+    throughput("polled, budget 4, packets", true, ENDPOINTS);
+    latency("interrupt, delivery latency", false);
+    latency("polled, delivery latency", true);
+    pass_cost("interrupt, 4 pending, handler calls", false, SIZE_MAX);
+    pass_cost("polled, 4 pending, budget 1, polls", true, 1U);
+    pass_cost("polled, 4 pending, budget 4, polls", true, ENDPOINTS);
+    switching("bound tables, SET_CONFIGURATION", true);
+    switching("configure callback, SET_CONFIGURATION", false);
+}
@@ -0,0 +1,261 @@
+/**
+ * @file
+ * @brief The whole mass storage stack (Bulk-Only transport, SCSI target,
+ * block device) against a 4 GiB sparse disk image. Sequential 64 KiB
+ * commands are run with the image mapped straight into the data phase
+ * and, for comparison, through a wrapper that hides the mapping so every
+ * sector is copied through the task buffer. The last run sets a device
+ * latency and polls for completions like a main loop would, giving the
+ * IOPS a host sees from a card-like device with one command in flight.
+ *
+ * Commands stay within a 64 MiB working set that is faulted in before
+ * anything is measured, otherwise the first run pays for the page cache.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/bot.h"
+#include "cusb/diskimage.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/* POSIX. */
+#include <unistd.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define IMAGE_SIZE          (4ULL * 1024ULL * 1024ULL * 1024ULL)
+#define BLOCK_SIZE          (512U)
+#define BLOCK_COUNT         ((uint32_t)(IMAGE_SIZE / BLOCK_SIZE))
+#define TASK_BUFFER_SIZE    (16U * 1024U)
+#define PACKET_SIZE         (512U)
+#define COMMAND_SIZE        (64U * 1024U)
+#define WORKING_SET         (64ULL * 1024ULL * 1024ULL)
+#define READ_SIZE           (4ULL * WORKING_SET)
+#define WRITE_SIZE          (2ULL * WORKING_SET)
+#define LATENCY_US          (100U)
+#define LATENCY_COMMANDS    (2000U)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static void copy_submit(void *ctx, struct cusb_blockdev_req *req);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Same image without the map function.
+ */
+static const struct cusb_blockdev_api COPY_API = {&copy_submit, NULL};
+
+static const struct cusb_scsi_inquiry INQUIRY = {"cusb", "Bench Image", "0.1"};
+
+static struct cusb_diskimage image;
+
+static struct cusb_blockdev copy_dev;
+
+static struct cusb_scsi scsi;
+
+static struct cusb_bot bot;
+
+static uint8_t task_buffer[TASK_BUFFER_SIZE];
+
+static uint8_t transfer[TASK_BUFFER_SIZE];
+
+static uint8_t cbw[31];
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void copy_submit(void *ctx, struct cusb_blockdev_req *req)
+{
+    (void)ctx;
+    cusb_blockdev_submit(cusb_diskimage_blockdev(&image), req);
+}
+
+static void set_le32(uint8_t *p, uint32_t val)
+{
+    p[0] = (uint8_t)val;
+    p[1] = (uint8_t)(val >> 8);
+    p[2] = (uint8_t)(val >> 16);
+    p[3] = (uint8_t)(val >> 24);
+}
+
+static void send_command(bool write, uint32_t lba, uint32_t bytes)
+{
+    uint32_t blocks = bytes / BLOCK_SIZE;
+
+    cbw[0] = 'U';
+    cbw[1] = 'S';
+    cbw[2] = 'B';
+    cbw[3] = 'C';
+    set_le32(&cbw[4], lba);
+    set_le32(&cbw[8], bytes);
+    cbw[12] = write ? 0x00U : 0x80U;
+    cbw[13] = 0;
+    cbw[14] = 10;
+    cbw[15] = write ? 0x2AU : 0x28U;
+    cbw[16] = 0;
+    cbw[17] = (uint8_t)(lba >> 24);
+    cbw[18] = (uint8_t)(lba >> 16);
+    cbw[19] = (uint8_t)(lba >> 8);
+    cbw[20] = (uint8_t)lba;
+    cbw[21] = 0;
+    cbw[22] = (uint8_t)(blocks >> 8);
+    cbw[23] = (uint8_t)blocks;
+    cusb_bot_bulk_out(&bot, cbw, sizeof(cbw));
+}
+
+/**
+ * @brief Moves one Bulk-IN transfer, polling the image while the endpoint
+ * would NAK. Returns its length.
+ */
+static size_t bulk_in(void)
+{
+    size_t len = 0;
+
+    while (!cusb_bot_bulk_in(&bot, transfer, sizeof(transfer), &len))
+    {
+        cusb_diskimage_poll(&image);
+    }
+
+    return len;
+}
+
+static void bulk_out(uint32_t bytes)
+{
+    while (bytes != 0U)
+    {
+        size_t space = cusb_bot_bulk_out_space(&bot);
+        size_t n = (space < sizeof(transfer)) ? space : sizeof(transfer);
+
+        if (n == 0U)
+        {
+            cusb_diskimage_poll(&image);
+            continue;
+        }
+
+        n = (n < bytes) ? n : bytes;
+        cusb_bot_bulk_out(&bot, transfer, n);
+        bytes -= (uint32_t)n;
+    }
+}
+
+static void run_command(bool write, uint32_t lba, uint32_t bytes)
+{
+    send_command(write, lba, bytes);
+
+    if (write)
+    {
+        bulk_out(bytes);
+    }
+    else
+    {
+        for (uint32_t moved = 0; moved < bytes;)
+        {
+            moved += (uint32_t)bulk_in();
+            bench_sink(transfer[0]);
+        }
+    }
+
+    /* CSW. */
+    (void)bulk_in();
+    bench_sink(transfer[12]);
+}
+
+static void sequential(const char *name, struct cusb_blockdev *dev, bool write, uint64_t total)
+{
+    cusb_scsi_ctor(&scsi, dev, &INQUIRY);
+    cusb_bot_ctor(&bot, &scsi, 1, task_buffer, sizeof(task_buffer), PACKET_SIZE, NULL, NULL);
+
+    uint64_t start = bench_now_ns();
+
+    for (uint64_t offset = 0; offset < total; offset += COMMAND_SIZE)
+    {
+        run_command(write, (uint32_t)((offset % WORKING_SET) / BLOCK_SIZE), COMMAND_SIZE);
+    }
+
+    bench_report_throughput(name, total, bench_now_ns() - start);
+}
+
+static void random_reads(void)
+{
+    uint32_t seed = 12345U;
+
+    cusb_diskimage_set_latency(&image, LATENCY_US);
+    cusb_scsi_ctor(&scsi, cusb_diskimage_blockdev(&image), &INQUIRY);
+    cusb_bot_ctor(&bot, &scsi, 1, task_buffer, sizeof(task_buffer), PACKET_SIZE, NULL, NULL);
+
+    uint64_t start = bench_now_ns();
+
+    for (unsigned i = 0; i < LATENCY_COMMANDS; i++)
+    {
+        seed = (seed * 1664525U) + 1013904223U;
+        run_command(false, (seed % (uint32_t)(WORKING_SET / 4096U)) * 8U, 4096U);
+    }
+
+    bench_report_rate("4 KiB random read, 100 us latency", LATENCY_COMMANDS, bench_now_ns() - start);
+    cusb_diskimage_set_latency(&image, 0);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_diskimage(void)
+{
+    char path[] = "/tmp/cusb_bench_XXXXXX";
+    int fd = mkstemp(path);
+
+    if (fd < 0 || ftruncate(fd, (off_t)IMAGE_SIZE) != 0)
+    {
+        printf("  cannot create image in /tmp, skipped\n");
+        return;
+    }
+
+    close(fd);
+
+    if (!cusb_diskimage_open(&image, path, BLOCK_SIZE, false))
+    {
+        printf("  cannot map image, skipped\n");
+        unlink(path);
+        return;
+    }
+
+    cusb_blockdev_ctor(&copy_dev, &COPY_API, NULL, BLOCK_SIZE, BLOCK_COUNT);
+
+    /* Faults the working set in. */
+    sequential("BOT 64 KiB write, mapped, cold", cusb_diskimage_blockdev(&image), true, WORKING_SET);
+    sequential("BOT 64 KiB write, mapped", cusb_diskimage_blockdev(&image), true, WRITE_SIZE);
+    sequential("BOT 64 KiB write, copied", &copy_dev, true, WRITE_SIZE);
+    sequential("BOT 64 KiB read, mapped", cusb_diskimage_blockdev(&image), false, READ_SIZE);
+    sequential("BOT 64 KiB read, copied", &copy_dev, false, READ_SIZE);
+    random_reads();
+
+    cusb_diskimage_close(&image);
+    unlink(path);
+}
@@ -0,0 +1,184 @@
+/**
+ * @file
+ * @brief Cost of CPU load accounting, and what it reports for the device
+ * core at full packet rate on the simulated controller. The host sends
+ * bulk OUT packets back to back in interrupt mode, so everything outside
+ * the stack is the simulated host.
+ *
+ * - Cost of one enter and exit pair with the built-in tick source, the
+ *   price paid twice per callback and once per interrupt.
+ * - Packet rate without accounting attached and with it, so the
+ *   difference is the overhead per packet.
+ * - The load report of the accounted run, per context.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/device.h"
+#include "cusb/load.h"
+#include "cusb/sim.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define PACKET_SIZE         (512U)
+#define PACKETS             (1024UL * 1024UL)
+#define PAIRS               (4UL * 1024UL * 1024UL)
+#define WINDOW_NS           (10000000UL)        /* 10 ms. */
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static bool configure(void *obj, uint8_t config);
+
+static void done(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok);
+
+static void isr(void *obj);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0xFF, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0, 0, 0, 1
+};
+
+static const uint8_t CONFIG_DESC[9 + 9 + 7] =
+{
+    9, 2, 9 + 9 + 7, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 1, 0xFF, 0x00, 0x00, 0,
+    7, 5, 0x01, 2, 0x00, 0x02, 0
+};
+
+static const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, NULL, NULL, 0};
+
+static const struct cusb_device_callbacks CALLBACKS = {&configure, NULL, NULL, NULL, NULL};
+
+static struct cusb_sim sim;
+
+static struct cusb_device dev;
+
+static struct cusb_load load;
+
+static uint8_t rx[PACKET_SIZE];
+
+static uint8_t packet[PACKET_SIZE];
+
+static uint32_t received;
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static bool configure(void *obj, uint8_t config)
+{
+    (void)obj;
+
+    if (config != 0U)
+    {
+        cusb_device_ep_open(&dev, 0x01U, CUSB_EP_BULK, PACKET_SIZE, &done, NULL);
+        (void)cusb_device_ep_xfer(&dev, 0x01U, rx, PACKET_SIZE);
+    }
+
+    return true;
+}
+
+static void done(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok)
+{
+    (void)obj;
+    (void)ok;
+    received += len;
+    (void)cusb_device_ep_xfer(&dev, ep, buf, PACKET_SIZE);
+}
+
+static void isr(void *obj)
+{
+    cusb_isr((struct cusb_device *)obj);
+}
+
+static void pairs(void)
+{
+    cusb_load_ctor(&load, NULL, WINDOW_NS);
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < PAIRS; i++)
+    {
+        cusb_load_enter(&load, CUSB_LOAD_CALLBACK);
+        cusb_load_exit(&load);
+    }
+
+    bench_report_rate("enter and exit pairs", PAIRS, bench_now_ns() - begin);
+    bench_sink(load.thread.busy[CUSB_LOAD_CALLBACK]);
+}
+
+static void packets(const char *name, bool accounted)
+{
+    static const uint8_t SET_ADDRESS[8] = {0x00, 5, 1, 0, 0, 0, 0, 0};
+    static const uint8_t SET_CONFIGURATION[8] = {0x00, 9, 1, 0, 0, 0, 0, 0};
+
+    cusb_sim_ctor(&sim, CUSB_SPEED_HIGH, &isr, &dev);
+    cusb_device_ctor(&dev, &sim.dcd, &DESCRIPTORS, &CALLBACKS, NULL);
+    cusb_load_ctor(&load, NULL, WINDOW_NS);
+    cusb_device_set_load(&dev, accounted ? &load : NULL);
+    cusb_device_start(&dev, false);
+    cusb_sim_host_reset(&sim);
+    (void)cusb_sim_host_control(&sim, SET_ADDRESS, NULL, NULL);
+    (void)cusb_sim_host_control(&sim, SET_CONFIGURATION, NULL, NULL);
+    received = 0;
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < PACKETS; i++)
+    {
+        (void)cusb_sim_host_out(&sim, 0x01U, packet, PACKET_SIZE);
+
+        if ((i & 0xFFU) == 0U)
+        {
+            (void)cusb_load_update(&load);
+        }
+    }
+
+    bench_report_rate(name, PACKETS, bench_now_ns() - begin);
+    bench_sink(received);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_load(void)
+{
+    pairs();
+    packets("interrupt, unaccounted, packets", false);
+    packets("interrupt, accounted, packets", true);
+
+    const struct cusb_load_report *report = cusb_load_get_report(&load);
+
+    printf("  load over %lu windows of 10 ms, average (peak) in %%:\n", (unsigned long)report->windows);
+    printf("    isr %5.2f (%5.2f)  callback %5.2f (%5.2f)  total %5.2f (%5.2f)\n",
+           report->average[CUSB_LOAD_ISR] / 100.0, report->peak[CUSB_LOAD_ISR] / 100.0,
+           report->average[CUSB_LOAD_CALLBACK] / 100.0, report->peak[CUSB_LOAD_CALLBACK] / 100.0,
+           report->average[CUSB_LOAD_TOTAL] / 100.0, report->peak[CUSB_LOAD_TOTAL] / 100.0);
+}
@@ -0,0 +1,242 @@
+/**
+ * @file
+ * @brief USB-MIDI packing, unpacking and batching.
+ *
+ * - Packing: 3 byte control changes written and handed out in 64 byte
+ *   transfers, MIDI 1.0 event packets and MIDI 2.0 UMP.
+ * - Unpacking: 64 byte Bulk-OUT packets of 16 events each.
+ * - Batching: one simulated second of a dense controller stream, one
+ *   event every 100 microseconds, over a full-speed bulk endpoint whose
+ *   transfers complete at the next frame. For each latency bound it
+ *   prints the transfers used, the events per transfer and the worst
+ *   time from write to transfer completion.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/device.h"
+#include "cusb/midi.h"
+#include "cusb/sim.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define PACKET_SIZE         (64U)
+#define FIFO_SIZE           (1024U)
+#define EVENTS              (8UL * 1024UL * 1024UL)
+#define PACKETS             (1024UL * 1024UL)
+#define STREAM_US           (1000000UL)
+#define STREAM_PERIOD_US    (100U)
+#define FRAME_US            (1000U)
+#define STAMPS              (FIFO_SIZE / 4U)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static void ready(void *ctx);
+
+static void receive(void *ctx, uint8_t cable, const uint8_t *data, size_t len);
+
+static void receive_ump(void *ctx, const uint32_t *ump, uint8_t nwords);
+
+static void isr(void *obj);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0x00, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0, 0, 0, 1
+};
+
+static const uint8_t CONFIG_DESC[9] = {9, 2, 9, 0, 0, 1, 0, 0x80, 50};
+
+static const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, NULL, NULL, 0};
+
+static const struct cusb_device_callbacks CALLBACKS = {NULL, NULL, NULL, NULL, NULL};
+
+static const struct cusb_midi_api API = {&ready, &receive, &receive_ump};
+
+static struct cusb_sim sim;
+
+static struct cusb_device dev;
+
+static struct cusb_midi midi;
+
+static uint8_t fifo[FIFO_SIZE];
+
+static uint8_t buf[PACKET_SIZE];
+
+static bool kicked;
+
+static uint32_t received;
+
+/* Write times of the events in the FIFO, oldest first. */
+static uint32_t stamps[STAMPS];
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void ready(void *ctx)
+{
+    (void)ctx;
+    kicked = true;
+}
+
+static void receive(void *ctx, uint8_t cable, const uint8_t *data, size_t len)
+{
+    (void)ctx;
+    (void)data;
+    received += (uint32_t)len + cable;
+}
+
+static void receive_ump(void *ctx, const uint32_t *ump, uint8_t nwords)
+{
+    (void)ctx;
+    received += ump[0] + nwords;
+}
+
+static void isr(void *obj)
+{
+    cusb_isr((struct cusb_device *)obj);
+}
+
+static void pack(uint8_t mode, const char *name)
+{
+    uint8_t cc[3] = {0xB0, 1, 0};
+    size_t len = 0;
+
+    cusb_midi_ctor(&midi, &API, NULL, fifo, sizeof(fifo), 1, PACKET_SIZE, NULL, 0);
+    cusb_midi_set_mode(&midi, mode);
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < EVENTS; i++)
+    {
+        cc[2] = (uint8_t)(i & 0x7FU);
+        (void)cusb_midi_write(&midi, 0, cc, sizeof(cc), 0);
+
+        if (cusb_midi_bulk_in(&midi, buf, sizeof(buf), &len))
+        {
+            cusb_midi_in_complete(&midi);
+        }
+    }
+
+    bench_report_rate(name, EVENTS, bench_now_ns() - begin);
+    bench_sink((uint32_t)len);
+}
+
+static void unpack(void)
+{
+    uint8_t pkt[PACKET_SIZE];
+
+    for (uint32_t i = 0; i < PACKET_SIZE; i += 4U)
+    {
+        pkt[i] = 0x0BU;
+        pkt[i + 1U] = 0xB0U;
+        pkt[i + 2U] = 1U;
+        pkt[i + 3U] = (uint8_t)i;
+    }
+
+    cusb_midi_ctor(&midi, &API, NULL, fifo, sizeof(fifo), 1, PACKET_SIZE, NULL, 0);
+    received = 0;
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < PACKETS; i++)
+    {
+        cusb_midi_bulk_out(&midi, pkt, sizeof(pkt));
+    }
+
+    bench_report_rate("unpack 1.0, events", PACKETS * (PACKET_SIZE / 4U), bench_now_ns() - begin);
+    bench_sink(received);
+}
+
+static void stream(uint32_t latency)
+{
+    uint8_t cc[3] = {0xB0, 7, 0};
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    uint32_t events = 0;
+    uint32_t transfers = 0;
+    uint32_t worst = 0;
+    uint32_t done_at = 0;
+    bool busy = false;
+    size_t len = 0;
+
+    cusb_sim_ctor(&sim, CUSB_SPEED_FULL, &isr, &dev);
+    cusb_device_ctor(&dev, &sim.dcd, &DESCRIPTORS, &CALLBACKS, NULL);
+    cusb_midi_ctor(&midi, &API, NULL, fifo, sizeof(fifo), 1, PACKET_SIZE, &dev, latency);
+    kicked = false;
+
+    for (uint32_t now = 0; now < STREAM_US; now += STREAM_PERIOD_US)
+    {
+        cc[2] = (uint8_t)(events & 0x7FU);
+
+        if (cusb_midi_write(&midi, 0, cc, sizeof(cc), now))
+        {
+            stamps[head++ % STAMPS] = now;
+            events++;
+        }
+
+        cusb_device_run_timers(&dev, now);
+
+        if (busy && now >= done_at)
+        {
+            busy = false;
+            cusb_midi_in_complete(&midi);
+        }
+
+        if (kicked && !busy && cusb_midi_bulk_in(&midi, buf, sizeof(buf), &len))
+        {
+            kicked = false;
+            busy = true;
+            transfers++;
+            done_at = (now / FRAME_US + 1U) * FRAME_US;
+
+            uint32_t waited = done_at - stamps[tail % STAMPS];
+            worst = (waited > worst) ? waited : worst;
+            tail += (uint32_t)len / 4U;
+        }
+    }
+
+    printf("  latency %4lu us: %5lu transfers, %5.1f events each, worst %lu us\n",
+           (unsigned long)latency, (unsigned long)transfers,
+           (double)(tail) / (double)((transfers != 0) ? transfers : 1U), (unsigned long)worst);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_midi(void)
+{
+    pack(CUSB_MIDI_1_0, "pack 1.0, events");
+    pack(CUSB_MIDI_2_0, "pack UMP, events");
+    unpack();
+    stream(0);
+    stream(1000);
+    stream(4000);
+}
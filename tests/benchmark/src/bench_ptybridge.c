@@ -0,0 +1,231 @@
+/**
+ * @file
+ * @brief End to end serial throughput and latency through the pty
+ * bridge. The benchmark plays both the device, producing into and
+ * draining its stream pipes, and the host program, reading and writing
+ * the slave side of the pty like a terminal program would. Everything
+ * runs on one thread with non-blocking I/O, so the numbers include every
+ * syscall on both sides.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+#define _POSIX_C_SOURCE 200809L
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/ptybridge.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/* POSIX. */
+#include <fcntl.h>
+#include <unistd.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define PACKET_SIZE         (64U)       /* Full-speed CDC-ACM. */
+#define BUFFER_SIZE         (16384U)
+#define CHUNK_SIZE          (4096U)
+#define STREAM_SIZE         (64UL * 1024UL * 1024UL)
+#define ROUND_TRIPS         (20000U)
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static struct cusb_stream in;
+
+static struct cusb_stream out;
+
+static uint8_t in_buf[BUFFER_SIZE];
+
+static uint8_t out_buf[BUFFER_SIZE];
+
+static struct cusb_ptybridge bridge;
+
+static uint8_t host_buf[BUFFER_SIZE];
+
+/**
+ * @brief Slave side, as the host program would open it.
+ */
+static int host = -1;
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Device writes up to @p len bytes into the IN pipe. Returns how
+ * many fit.
+ */
+static size_t device_send(size_t len)
+{
+    struct cusb_stream_iov iov[2];
+    size_t n;
+
+    (void)cusb_stream_write_space(&in, iov);
+    n = (len < iov[0].len) ? len : iov[0].len;
+
+    if (n != 0U)
+    {
+        iov[0].base[0] = (uint8_t)n;
+        cusb_stream_write_commit(&in, n);
+        cusb_stream_flush(&in);
+    }
+
+    return n;
+}
+
+/**
+ * @brief Device drains the OUT pipe. Returns bytes received.
+ */
+static size_t device_receive(void)
+{
+    struct cusb_stream_iov iov[2];
+    size_t n = cusb_stream_read_data(&out, iov);
+
+    if (n != 0U)
+    {
+        bench_sink(iov[0].base[0]);
+        cusb_stream_read_release(&out, n);
+    }
+
+    return n;
+}
+
+static size_t host_read(void)
+{
+    ssize_t n = read(host, host_buf, sizeof(host_buf));
+    return (n > 0) ? (size_t)n : 0U;
+}
+
+static size_t host_write(size_t len)
+{
+    ssize_t n = write(host, host_buf, len);
+    return (n > 0) ? (size_t)n : 0U;
+}
+
+static void device_to_host(void)
+{
+    uint32_t syscalls = cusb_ptybridge_get_stats(&bridge)->syscalls;
+    size_t sent = 0;
+    size_t received = 0;
+    uint64_t start = bench_now_ns();
+
+    while (received < STREAM_SIZE)
+    {
+        if (sent < STREAM_SIZE)
+        {
+            size_t left = STREAM_SIZE - sent;
+            sent += device_send((left < CHUNK_SIZE) ? left : CHUNK_SIZE);
+        }
+
+        cusb_ptybridge_poll(&bridge, 0);
+        received += host_read();
+    }
+
+    bench_report_throughput("device to host, 4 KiB writes", STREAM_SIZE, bench_now_ns() - start);
+    printf("  %-40s %12.0f bytes/syscall\n", "bridge batching",
+           (double)STREAM_SIZE / (double)(cusb_ptybridge_get_stats(&bridge)->syscalls - syscalls));
+}
+
+static void host_to_device(void)
+{
+    uint32_t syscalls = cusb_ptybridge_get_stats(&bridge)->syscalls;
+    size_t sent = 0;
+    size_t received = 0;
+    uint64_t start = bench_now_ns();
+
+    while (received < STREAM_SIZE)
+    {
+        if (sent < STREAM_SIZE)
+        {
+            size_t left = STREAM_SIZE - sent;
+            sent += host_write((left < CHUNK_SIZE) ? left : CHUNK_SIZE);
+        }
+
+        cusb_ptybridge_poll(&bridge, 0);
+        received += device_receive();
+    }
+
+    bench_report_throughput("host to device, 4 KiB writes", STREAM_SIZE, bench_now_ns() - start);
+    printf("  %-40s %12.0f bytes/syscall\n", "bridge batching",
+           (double)STREAM_SIZE / (double)(cusb_ptybridge_get_stats(&bridge)->syscalls - syscalls));
+}
+
+/**
+ * @brief Host sends one byte, device echoes it, host reads it back.
+ */
+static void round_trips(void)
+{
+    uint64_t start = bench_now_ns();
+
+    for (unsigned i = 0; i < ROUND_TRIPS; i++)
+    {
+        while (host_write(1) == 0U)
+        {
+        }
+
+        while (device_receive() == 0U)
+        {
+            cusb_ptybridge_poll(&bridge, 0);
+        }
+
+        device_send(1);
+
+        do
+        {
+            cusb_ptybridge_poll(&bridge, 0);
+        } while (host_read() == 0U);
+    }
+
+    bench_report_rate("1 byte echo round trip", ROUND_TRIPS, bench_now_ns() - start);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_ptybridge(void)
+{
+    cusb_stream_ctor(&in, CUSB_STREAM_IN, in_buf, sizeof(in_buf), PACKET_SIZE);
+    cusb_stream_ctor(&out, CUSB_STREAM_OUT, out_buf, sizeof(out_buf), PACKET_SIZE);
+
+    if (!cusb_ptybridge_open(&bridge, &in, &out, NULL))
+    {
+        printf("  cannot create pty, skipped\n");
+        return;
+    }
+
+    host = open(cusb_ptybridge_name(&bridge), O_RDWR | O_NOCTTY | O_NONBLOCK);
+
+    if (host < 0)
+    {
+        printf("  cannot open %s, skipped\n", cusb_ptybridge_name(&bridge));
+        cusb_ptybridge_close(&bridge);
+        return;
+    }
+
+    device_to_host();
+    host_to_device();
+    round_trips();
+
+    close(host);
+    cusb_ptybridge_close(&bridge);
+}
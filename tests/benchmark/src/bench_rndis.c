@@ -0,0 +1,273 @@
+/**
+ * @file
+ * @brief RNDIS packet-message framing over the shared packet pool.
+ *
+ * - Receive: 16 KiB Bulk-OUT transfers packed with minimum, medium and
+ *   maximum Ethernet frames, parsed and handed to the application in
+ *   place. The copying rows copy every frame out first, as a stack
+ *   without reference counted buffers would.
+ * - Transmit: frames written in place after their reserved header,
+ *   many per Bulk-IN transfer. The copying rows stage every frame
+ *   outside the pool first.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/pktpool.h"
+#include "cusb/rndis.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define PACKET_SIZE     (512U)
+#define BUFFERS         (4U)
+#define BUFFER_SIZE     (16384U)
+#define BYTES           (256UL * 1024UL * 1024UL)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static void receive(void *ctx, struct cusb_pkt *pkt, uint8_t *frame, uint32_t len);
+
+static void notify(void *ctx);
+
+static void ready(void *ctx);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const struct cusb_rndis_api API = {&receive, &notify, &ready};
+
+static const uint8_t MAC[6] = {0x02, 0x00, 0x00, 0x12, 0x34, 0x56};
+
+static struct cusb_pktpool pool;
+
+static struct cusb_pkt pkts[BUFFERS];
+
+static uint32_t mem[BUFFERS * BUFFER_SIZE / 4U];
+
+static struct cusb_rndis rndis;
+
+/* Where the copying rows move frames to, and from. */
+static uint8_t staging[CUSB_RNDIS_FRAME_MAX];
+
+static bool copy;
+
+static uint32_t received;
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void receive(void *ctx, struct cusb_pkt *pkt, uint8_t *frame, uint32_t len)
+{
+    (void)ctx;
+
+    if (copy)
+    {
+        memcpy(staging, frame, len);
+        frame = staging;
+    }
+
+    received += frame[len - 1U];
+    cusb_pktpool_release(&pool, pkt);
+}
+
+static void notify(void *ctx)
+{
+    (void)ctx;
+}
+
+static void ready(void *ctx)
+{
+    (void)ctx;
+}
+
+static void put32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Sends a control message with the given words after
+ * MessageLength, and drops the response.
+ */
+static void command(uint32_t type, const uint32_t *words, uint32_t nwords)
+{
+    const uint8_t send[8] = {0x21, 0x00, 0, 0, 0, 0, 64, 0};
+    const uint8_t get[8] = {0xA1, 0x01, 0, 0, 0, 0, 0, 1};
+    uint8_t *data = NULL;
+    uint16_t len = 0;
+
+    (void)cusb_rndis_control(&rndis, send, &data, &len);
+    put32(&data[0], type);
+    put32(&data[4], 8U + 4U * nwords);
+
+    for (uint32_t i = 0; i < nwords; i++)
+    {
+        put32(&data[8U + 4U * i], words[i]);
+    }
+
+    (void)cusb_rndis_control_out(&rndis, send, data, (uint16_t)(8U + 4U * nwords));
+    (void)cusb_rndis_control(&rndis, get, &data, &len);
+}
+
+/**
+ * @brief Brings the function up the way Windows does: INITIALIZE, then
+ * a packet filter.
+ */
+static void start(void)
+{
+    const uint32_t init[4] = {1, 1, 0, BUFFER_SIZE};
+    const uint32_t filter[6] = {2, 0x0001010EUL, 4, 20, 0, 0x0F};
+
+    cusb_pktpool_ctor(&pool, pkts, (uint8_t *)mem, BUFFERS, BUFFER_SIZE);
+    cusb_rndis_ctor(&rndis, &API, NULL, &pool, MAC, PACKET_SIZE);
+    command(2, init, 4);
+    command(5, filter, 6);
+}
+
+/**
+ * @brief Packs a transfer with as many packet messages of @p frame
+ * bytes as fit. Returns its length.
+ */
+static uint32_t pack(uint8_t *buf, uint32_t frame, uint32_t *frames)
+{
+    uint32_t msg = 44U + ((frame + 3U) & ~3U);
+    uint32_t len = 0;
+    *frames = 0;
+
+    while (len + msg <= BUFFER_SIZE)
+    {
+        memset(&buf[len], 0, 44);
+        put32(&buf[len], 1);
+        put32(&buf[len + 4U], msg);
+        put32(&buf[len + 8U], 36);
+        put32(&buf[len + 12U], frame);
+        memset(&buf[len + 44U], 0x5A, msg - 44U);
+        len += msg;
+        (*frames)++;
+    }
+
+    return len;
+}
+
+static void rx(uint32_t frame, bool copying)
+{
+    char name[40];
+    uint32_t frames = 0;
+    uint32_t len = 0;
+    uint32_t size = 0;
+
+    start();
+    copy = copying;
+    received = 0;
+
+    /* Every buffer holds the same transfer, as if the DCD wrote it. */
+    for (uint32_t i = 0; i < BUFFERS; i++)
+    {
+        len = pack(pkts[i].buf, frame, &frames);
+    }
+
+    uint32_t transfers = (uint32_t)(BYTES / len);
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < transfers; i++)
+    {
+        (void)cusb_rndis_rx_arm(&rndis, &size);
+        cusb_rndis_bulk_out(&rndis, len);
+    }
+
+    uint64_t ns = bench_now_ns() - begin;
+    (void)snprintf(name, sizeof(name), "rx %4lu B%s, frames", (unsigned long)frame, copying ? " copying" : "");
+    bench_report_rate(name, (uint64_t)transfers * frames, ns);
+    bench_sink(received + size);
+}
+
+static void tx(uint32_t frame, bool copying)
+{
+    char name[40];
+    uint8_t *buf = NULL;
+    uint32_t len = 0;
+    uint32_t frames = (uint32_t)(BYTES / frame);
+    uint32_t transfers = 0;
+
+    start();
+    memset(staging, 0x5A, sizeof(staging));
+
+    uint64_t begin = bench_now_ns();
+
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        uint8_t *dst = cusb_rndis_tx_alloc(&rndis, frame);
+
+        if (copying)
+        {
+            memcpy(dst, staging, frame);
+        }
+        else
+        {
+            dst[0] = (uint8_t)i;
+        }
+
+        cusb_rndis_tx_commit(&rndis, frame);
+
+        /* The endpoint takes a transfer once the pool runs low. */
+        if (cusb_pktpool_available(&pool) == 0 && cusb_rndis_bulk_in(&rndis, &buf, &len))
+        {
+            cusb_rndis_in_complete(&rndis);
+            transfers++;
+        }
+    }
+
+    uint64_t ns = bench_now_ns() - begin;
+    (void)snprintf(name, sizeof(name), "tx %4lu B%s, frames", (unsigned long)frame, copying ? " copying" : "");
+    bench_report_rate(name, frames, ns);
+    printf("  %.1f frames per transfer\n", (double)frames / (double)((transfers != 0) ? transfers : 1U));
+    bench_sink(len);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_rndis(void)
+{
+    static const uint32_t FRAMES[3] = {60, 590, 1514};
+
+    for (uint32_t i = 0; i < 3U; i++)
+    {
+        rx(FRAMES[i], false);
+        rx(FRAMES[i], true);
+    }
+
+    for (uint32_t i = 0; i < 3U; i++)
+    {
+        tx(FRAMES[i], false);
+        tx(FRAMES[i], true);
+    }
+}
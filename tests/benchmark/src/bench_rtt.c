@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Cost of writing to the in-memory trace sink, i.e. what a trace
+ * point adds to the code path it sits in. A reader drains the rings
+ * between passes, outside the measured time, the way a debugger keeps up
+ * in the background.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/load.h"
+#include "cusb/rtt.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define RING_SIZE           (4096U)
+#define PER_PASS            (256U)      /* Records per pass, fits the ring. */
+#define PASSES              (8192UL)
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static struct cusb_rtt rtt;
+
+static uint8_t log_ring[RING_SIZE];
+
+static uint8_t trace_ring[RING_SIZE];
+
+static uint8_t drained[RING_SIZE];
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void run(const char *name, bool log, uint32_t (*now)(void))
+{
+    uint64_t total = 0;
+    uint32_t written = 0;
+    uint8_t channel = log ? (uint8_t)CUSB_RTT_LOG : (uint8_t)CUSB_RTT_TRACE;
+
+    cusb_rtt_ctor(&rtt, log_ring, sizeof(log_ring), trace_ring, sizeof(trace_ring), now);
+
+    for (uint32_t pass = 0; pass < PASSES; pass++)
+    {
+        uint64_t begin = bench_now_ns();
+
+        for (uint32_t i = 0; i < (log ? PER_PASS / 2U : PER_PASS); i++)
+        {
+            written += log ? (uint32_t)cusb_rtt_log(&rtt, "ep 1 done\n")
+                           : (uint32_t)cusb_rtt_trace(&rtt, 0x0101U, i);
+        }
+
+        total += bench_now_ns() - begin;
+        (void)cusb_rtt_read(&rtt, channel, drained, sizeof(drained));
+    }
+
+    bench_report_rate(name, written, total);
+    bench_sink(written);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_rtt(void)
+{
+    run("trace records, no timestamp", false, NULL);
+    run("trace records, clock timestamp", false, &cusb_load_cycles);
+    run("log lines, 10 bytes", true, NULL);
+}
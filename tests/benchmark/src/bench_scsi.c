@@ -0,0 +1,120 @@
+/**
+ * @file
+ * @brief Cost of the commands hosts poll an idle mass storage device
+ * with: TEST UNIT READY, REQUEST SENSE, MODE SENSE, INQUIRY and READ
+ * CAPACITY. Runs each command through the SCSI target, including the
+ * data-in copy to a 512 byte endpoint buffer.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/scsi.h"
+
+/* STDLib. */
+#include <stddef.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define BLOCK_SIZE      (512U)
+#define BLOCK_COUNT     (1024UL * 1024UL)
+#define ITERATIONS      (2000000U)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static void media_submit(void *ctx, struct cusb_blockdev_req *req);
+static void on_task(void *ctx, struct cusb_scsi_task *task);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const struct cusb_blockdev_api MEDIA_API = {&media_submit, NULL};
+
+static const struct cusb_scsi_inquiry INQUIRY = {"cusb", "Bench Disk", "0.1"};
+
+static const uint8_t TEST_UNIT_READY[6] = {0x00U};
+static const uint8_t REQUEST_SENSE[6] = {0x03U, 0U, 0U, 0U, 18U, 0U};
+static const uint8_t MODE_SENSE_6[6] = {0x1AU, 0U, 0x3FU, 0U, 192U, 0U};
+static const uint8_t INQUIRY_STD[6] = {0x12U, 0U, 0U, 0U, 36U, 0U};
+static const uint8_t READ_CAPACITY_10[10] = {0x25U};
+
+static struct cusb_blockdev dev;
+
+static struct cusb_scsi scsi;
+
+static struct cusb_scsi_task task;
+
+static uint8_t task_buffer[4096];
+
+static uint8_t packet[512];
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void media_submit(void *ctx, struct cusb_blockdev_req *req)
+{
+    (void)ctx;
+    cusb_blockdev_complete(req, true);
+}
+
+static void on_task(void *ctx, struct cusb_scsi_task *t)
+{
+    (void)ctx;
+    (void)t;
+}
+
+static void run(const char *name, const uint8_t *cdb, size_t cdb_len)
+{
+    uint32_t acc = 0;
+    uint64_t start = bench_now_ns();
+
+    for (unsigned i = 0; i < ITERATIONS; i++)
+    {
+        cusb_scsi_task_start(&scsi, &task, cdb, cdb_len);
+
+        while (task.state == CUSB_SCSI_TASK_DATA_IN)
+        {
+            acc += (uint32_t)cusb_scsi_task_data_in(&task, packet, sizeof(packet));
+        }
+
+        acc += task.status;
+        cusb_scsi_task_free(&task);
+    }
+
+    bench_report_rate(name, ITERATIONS, bench_now_ns() - start);
+    bench_sink(acc + packet[0]);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_scsi(void)
+{
+    cusb_blockdev_ctor(&dev, &MEDIA_API, NULL, BLOCK_SIZE, BLOCK_COUNT);
+    cusb_scsi_ctor(&scsi, &dev, &INQUIRY);
+    cusb_scsi_task_ctor(&task, task_buffer, sizeof(task_buffer), &on_task, NULL);
+
+    run("TEST UNIT READY", TEST_UNIT_READY, sizeof(TEST_UNIT_READY));
+    run("REQUEST SENSE", REQUEST_SENSE, sizeof(REQUEST_SENSE));
+    run("MODE SENSE(6), all pages", MODE_SENSE_6, sizeof(MODE_SENSE_6));
+    run("INQUIRY", INQUIRY_STD, sizeof(INQUIRY_STD));
+    run("READ CAPACITY(10)", READ_CAPACITY_10, sizeof(READ_CAPACITY_10));
+}
@@ -0,0 +1,144 @@
+/**
+ * @file
+ * @brief Streams an 8 MiB waveform through the USBTMC Bulk-IN path
+ * over a host loopback, for full-speed and high-speed packet sizes and
+ * several transfer buffer sizes. Measures class overhead only (framing,
+ * header generation and the application copy), not bus time.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* Files under test. */
+#include "cusb/usbtmc.h"
+
+/* STDLib. */
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#define WAVEFORM_SIZE   (8U * 1024U * 1024U)
+#define BUFFER_MAX      (16U * 1024U)
+#define ITERATIONS      (8U)
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DECLARATIONS --------*/
+/*------------------------------------------------------------*/
+
+static void msg_receive(void *ctx, const uint8_t *data, size_t len, bool eom);
+static size_t msg_read(void *ctx, uint32_t offset, uint8_t *buf, size_t len);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static uint8_t waveform[WAVEFORM_SIZE];
+
+static uint8_t buffer[BUFFER_MAX];
+
+static struct cusb_usbtmc tmc;
+
+static const struct cusb_usbtmc_api API =
+{
+    &msg_receive, &msg_read, NULL, NULL, NULL, NULL, NULL
+};
+
+/*------------------------------------------------------------*/
+/*---------------------- STATIC FUNCTION DEFINITIONS ---------*/
+/*------------------------------------------------------------*/
+
+static void msg_receive(void *ctx, const uint8_t *data, size_t len, bool eom)
+{
+    (void)ctx;
+    (void)data;
+    (void)len;
+    (void)eom;
+}
+
+static size_t msg_read(void *ctx, uint32_t offset, uint8_t *buf, size_t len)
+{
+    (void)ctx;
+    memcpy(buf, &waveform[offset], len);
+    return len;
+}
+
+static void request(struct cusb_usbtmc *me, uint8_t btag, uint32_t max)
+{
+    const uint8_t hdr[CUSB_USBTMC_HEADER_SIZE] =
+    {
+        2U, btag, (uint8_t)~btag, 0U,
+        (uint8_t)max, (uint8_t)(max >> 8), (uint8_t)(max >> 16), (uint8_t)(max >> 24),
+        0U, 0U, 0U, 0U
+    };
+
+    (void)cusb_usbtmc_bulk_out(me, hdr, sizeof(hdr));
+}
+
+static void run(const char *name, uint16_t packet_size, size_t buffer_size, uint32_t transfer_size)
+{
+    uint64_t start = bench_now_ns();
+
+    for (unsigned i = 0; i < ITERATIONS; i++)
+    {
+        uint64_t received = 0;
+        uint8_t btag = 1U;
+        size_t len = 0;
+
+        cusb_usbtmc_ctor(&tmc, &API, NULL, packet_size);
+        (void)cusb_usbtmc_respond(&tmc, WAVEFORM_SIZE);
+
+        while (received < WAVEFORM_SIZE)
+        {
+            request(&tmc, btag, transfer_size);
+            btag = (uint8_t)((btag == 255U) ? 1U : (btag + 1U));
+
+            while (cusb_usbtmc_bulk_in(&tmc, buffer, buffer_size, &len))
+            {
+                received += len;
+                if ((len % packet_size) != 0U || len == 0U)
+                {
+                    break;
+                }
+            }
+        }
+
+        bench_sink(buffer[7]);
+    }
+
+    bench_report_throughput(name, (uint64_t)WAVEFORM_SIZE * ITERATIONS, bench_now_ns() - start);
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- BENCHMARK ------------------------*/
+/*------------------------------------------------------------*/
+
+void bench_usbtmc(void)
+{
+    for (size_t i = 0; i < WAVEFORM_SIZE; i++)
+    {
+        waveform[i] = (uint8_t)((i * 2654435761UL) >> 11);
+    }
+
+    printf("  8 MiB waveform, 1 MiB TransferSize:\n");
+    run("FS 64 B packets, 64 B buffer", 64U, 64U, 1024UL * 1024UL);
+    run("HS 512 B packets, 512 B buffer", 512U, 512U, 1024UL * 1024UL);
+    run("HS 512 B packets, 16 KiB buffer", 512U, BUFFER_MAX, 1024UL * 1024UL);
+
+    printf("  8 MiB waveform, 4 KiB TransferSize (one header per 4 KiB):\n");
+    run("HS 512 B packets, 512 B buffer", 512U, 512U, 4096UL);
+    run("HS 512 B packets, 16 KiB buffer", 512U, BUFFER_MAX, 4096UL);
+}
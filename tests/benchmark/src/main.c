@@ -0,0 +1,91 @@
+/**
+ * @file
+ * @brief Runs all benchmarks, or only the ones whose name is passed
+ * on the command line. I.e. ./CUSB_BENCHMARK crc32
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Benchmark harness. */
+#include "bench.h"
+
+/* STDLib. */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Every benchmark. Add new ones here.
+ */
+static const struct
+{
+    const char *name;
+    void (*run)(void);
+} BENCHMARKS[] =
+{
+    {"asrc", &bench_asrc},
+    {"asserts", &bench_asserts},
+    {"blockcache", &bench_blockcache},
+    {"coalesce", &bench_coalesce},
+    {"crc32", &bench_crc32},
+    {"device", &bench_device},
+    {"diskimage", &bench_diskimage},
+    {"load", &bench_load},
+    {"midi", &bench_midi},
+    {"ptybridge", &bench_ptybridge},
+    {"rndis", &bench_rndis},
+    {"rtt", &bench_rtt},
+    {"scsi", &bench_scsi},
+    {"stream", &bench_stream},
+    {"uas", &bench_uas},
+    {"usbtmc", &bench_usbtmc}
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- MAIN ---------------------------*/
+/*------------------------------------------------------------*/
+
+int main(int argc, char **argv)
+{
+    for (size_t i = 0; i < sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0]); i++)
+    {
+        int selected = (argc < 2);
+
+        for (int a = 1; a < argc; a++)
+        {
+            if (strcmp(argv[a], BENCHMARKS[i].name) == 0)
+            {
+                selected = 1;
+            }
+        }
+
+        if (selected)
+        {
+            printf("%s:\n", BENCHMARKS[i].name);
+            BENCHMARKS[i].run();
+        }
+    }
+
+    return 0;
+}
+
+/*------------------------------------------------------------*/
+/*---------------- ASSERT HANDLER DEFINITION -----------------*/
+/*------------------------------------------------------------*/
+
+void ecu_assert_handler(const char *file, int line)
+{
+    fprintf(stderr, "Assert fired at %s:%d\n", file, line);
+    abort();
+}
@@ -0,0 +1,51 @@
+/**
+ * @file
+ * @brief Largest configuration, for the build test. High speed, every
+ * class, the deepest queues, every runtime assert, statistics, load
+ * accounting and trace points going to the RTT sink.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_APP_CONFIG_H_
+#define CUSB_APP_CONFIG_H_
+
+/* Device. */
+#define CUSB_CFG_SPEED                      CUSB_SPEED_HIGH
+#define CUSB_CFG_ENDPOINTS                  (16U)
+#define CUSB_CFG_EP0_SIZE                   (64U)
+#define CUSB_CFG_DMA                        1
+
+/* Classes. */
+#define CUSB_CFG_MSC                        1
+#define CUSB_CFG_MSC_UAS                    1
+#define CUSB_CFG_BLOCKCACHE                 1
+#define CUSB_CFG_MTP                        1
+#define CUSB_CFG_USBTMC                     1
+#define CUSB_CFG_MIDI                       1
+#define CUSB_CFG_RNDIS                      1
+#define CUSB_CFG_PKTPOOL                    1
+#define CUSB_CFG_STREAM                     1
+#define CUSB_CFG_CRC32                      1
+#define CUSB_CFG_COALESCE                   1
+#define CUSB_CFG_ASRC                       1
+
+/* Queue depths and tables. */
+#define CUSB_CFG_SCSI_LUN_MAX               (16U)
+#define CUSB_CFG_UAS_PENDING_MAX            (255U)
+#define CUSB_CFG_MIDI_CABLES                (16U)
+#define CUSB_CFG_CRC32_SLICE8               1
+#define CUSB_CFG_LOAD_HISTORY               (255U)
+
+/* Diagnostics. */
+#define CUSB_CFG_STATS                      1
+#define CUSB_CFG_ASSERT_LEVEL               CUSB_ASSERT_LEVEL_PACKET
+#define CUSB_CFG_TRACE                      1
+#define CUSB_CFG_LOAD                       1
+#define CUSB_CFG_RTT                        1
+#define CUSB_CFG_TRACE_RTT                  1
+
+#endif /* CUSB_APP_CONFIG_H_ */
@@ -0,0 +1,53 @@
+/**
+ * @file
+ * @brief Smallest configuration, for the build test. A full-speed thumb
+ * drive on SPI flash: one LUN, Bulk-Only transport, the erase block cache
+ * and a vendor pipe. No statistics, no trace points, no load accounting,
+ * no RTT sink, byte at a time CRC-32 and every other class disabled.
+ * Runtime asserts check API arguments only.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef CUSB_APP_CONFIG_H_
+#define CUSB_APP_CONFIG_H_
+
+/* Device. */
+#define CUSB_CFG_SPEED                      CUSB_SPEED_FULL
+#define CUSB_CFG_ENDPOINTS                  (3U)
+#define CUSB_CFG_EP0_SIZE                   (8U)
+#define CUSB_CFG_DMA                        0
+
+/* Classes. */
+#define CUSB_CFG_MSC                        1
+#define CUSB_CFG_MSC_UAS                    0
+#define CUSB_CFG_BLOCKCACHE                 1
+#define CUSB_CFG_MTP                        0
+#define CUSB_CFG_USBTMC                     0
+#define CUSB_CFG_MIDI                       0
+#define CUSB_CFG_RNDIS                      0
+#define CUSB_CFG_PKTPOOL                    0
+#define CUSB_CFG_STREAM                     1
+#define CUSB_CFG_CRC32                      1
+#define CUSB_CFG_COALESCE                   1
+#define CUSB_CFG_ASRC                       0
+
+/* Queue depths and tables. */
+#define CUSB_CFG_SCSI_LUN_MAX               (1U)
+#define CUSB_CFG_UAS_PENDING_MAX            (1U)
+#define CUSB_CFG_MIDI_CABLES                (1U)
+#define CUSB_CFG_CRC32_SLICE8               0
+#define CUSB_CFG_LOAD_HISTORY               (1U)
+
+/* Diagnostics. */
+#define CUSB_CFG_STATS                      0
+#define CUSB_CFG_ASSERT_LEVEL               CUSB_ASSERT_LEVEL_API
+#define CUSB_CFG_TRACE                      0
+#define CUSB_CFG_LOAD                       0
+#define CUSB_CFG_RTT                        0
+#define CUSB_CFG_TRACE_RTT                  0
+
+#endif /* CUSB_APP_CONFIG_H_ */
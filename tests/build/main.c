@@ -8,6 +8,13 @@
  * @copyright Copyright (c) 2025
  */
 
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Trace hook declaration. */
+#include "cusb/trace.h"
+
 /*------------------------------------------------------------*/
 /*--------------------------- MAIN ---------------------------*/
 /*------------------------------------------------------------*/
@@ -30,3 +37,15 @@ void ecu_assert_handler(const char *file, int line)
 
     }
 }
+
+#if (CUSB_CFG_TRACE) && !(CUSB_CFG_TRACE_RTT)
+/*------------------------------------------------------------*/
+/*------------------- TRACE HOOK DEFINITION ------------------*/
+/*------------------------------------------------------------*/
+
+void cusb_trace(uint16_t event, uint32_t arg)
+{
+    (void)event;
+    (void)arg;
+}
+#endif
@@ -0,0 +1,308 @@
+/**
+ * @file
+ * @brief Integration test on STM32L432. Runs a vendor class bulk
+ * loopback (EP1 OUT to EP2 IN) on @ref stm32fs.h in deferred mode and
+ * captures the cycles spent in the interrupt handler and in each poll.
+ * @details Read @ref cusb_integration_cycles with the debugger while a
+ * host runs traffic through the loopback, i.e. in gdb:
+ * @code
+ * (gdb) print cusb_integration_cycles
+ * @endcode
+ * Counts come from the DWT cycle counter at 48 MHz. The interrupt
+ * figures cover @ref cusb_stm32fs_isr() only, the poll figures every
+ * @ref cusb_poll() that handled at least one event.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* CUSB. */
+#include "cusb/device.h"
+#include "cusb/load.h"
+#include "cusb/stm32fs.h"
+
+/* STDLib. */
+#include <stdbool.h>
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+#if !(CUSB_CFG_LOAD) || !(CUSB_LOAD_HAS_CYCLES)
+#error "Integration test needs cusb_load_cycles()."
+#endif
+
+/**
+ * @brief Registers used to bring up the clocks, pins and interrupt.
+ */
+#define REG(addr)                           (*(volatile uint32_t *)(addr))
+#define FLASH_ACR                           REG(0x40022000UL)
+#define RCC_CR                              REG(0x40021000UL)
+#define RCC_AHB2ENR                         REG(0x4002104CUL)
+#define RCC_APB1ENR1                        REG(0x40021058UL)
+#define RCC_CRRCR                           REG(0x40021098UL)
+#define PWR_CR2                             REG(0x40007004UL)
+#define CRS_CR                              REG(0x40006000UL)
+#define GPIOA_MODER                         REG(0x48000000UL)
+#define GPIOA_OSPEEDR                       REG(0x48000008UL)
+#define GPIOA_AFRH                          REG(0x48000024UL)
+#define NVIC_ISER2                          REG(0xE000E108UL)
+
+#define FLASH_ACR_LATENCY_2WS               (2UL)
+#define RCC_CR_MSIRANGE_48MHZ               (11UL << 4)
+#define RCC_CR_MSIRGSEL                     (1UL << 3)
+#define RCC_CR_MSIRDY                       (1UL << 1)
+#define RCC_AHB2ENR_GPIOAEN                 (1UL << 0)
+#define RCC_APB1ENR1_PWREN                  (1UL << 28)
+#define RCC_APB1ENR1_USBFSEN                (1UL << 26)
+#define RCC_APB1ENR1_CRSEN                  (1UL << 24)
+#define RCC_CRRCR_HSI48ON                   (1UL << 0)
+#define RCC_CRRCR_HSI48RDY                  (1UL << 1)
+#define PWR_CR2_USV                         (1UL << 10)
+#define CRS_CR_AUTOTRIMEN                   (1UL << 6)
+#define CRS_CR_CEN                          (1UL << 5)
+#define NVIC_ISER2_USB                      (1UL << (67U - 64U))
+
+/**
+ * @brief Events handled per poll.
+ */
+#define POLL_BUDGET                         (8U)
+
+/**
+ * @brief Loopback endpoints and their packet size.
+ */
+#define EP_OUT                              (0x01U)
+#define EP_IN                               (0x82U)
+#define EP_MPS                              (64U)
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Cycle counts of one code path.
+ */
+struct cycles
+{
+    uint32_t min;
+    uint32_t max;
+    uint32_t last;
+    uint32_t count;
+};
+
+/*------------------------------------------------------------*/
+/*----------------- STATIC FUNCTION DECLARATIONS -------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief 48 MHz system clock from MSI, 48 MHz USB clock from HSI48
+ * trimmed to the host's start of frame by the CRS, PA11/PA12 to the
+ * transceiver and the USB interrupt enabled in the NVIC.
+ */
+static void board_init(void);
+
+/**
+ * @brief Adds @p val to @p me.
+ */
+static void record(volatile struct cycles *me, uint32_t val);
+
+/**
+ * @brief Opens the loopback endpoints and arms the OUT endpoint.
+ */
+static bool configure(void *obj, uint8_t config);
+
+/**
+ * @brief Sends received data back, then arms the OUT endpoint again.
+ */
+static void done(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok);
+
+/**
+ * @brief Called by @ref cusb_stm32fs_isr().
+ */
+static void wake(void *obj);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+static const uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0xFF, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x09, 0x12, 0x01, 0x00, 0x00, 0x01, 0, 0, 0, 1
+};
+
+static const uint8_t CONFIG_DESC[32] =
+{
+    9, 2, 32, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 2, 0xFF, 0x00, 0x00, 0,
+    7, 5, EP_OUT, 2, EP_MPS, 0, 0,
+    7, 5, EP_IN, 2, EP_MPS, 0, 0
+};
+
+static const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, NULL, NULL, 0};
+
+static const struct cusb_device_callbacks CALLBACKS = {&configure, NULL, NULL, NULL, NULL};
+
+static struct cusb_stm32fs usb;
+static struct cusb_device dev;
+static uint8_t loopback[512];
+static volatile bool woken;
+
+/**
+ * @brief Read by the debugger.
+ */
+volatile struct
+{
+    struct cycles isr;
+    struct cycles poll;
+} cusb_integration_cycles;
+
+/*------------------------------------------------------------*/
+/*----------------- STATIC FUNCTION DEFINITIONS --------------*/
+/*------------------------------------------------------------*/
+
+static void board_init(void)
+{
+    FLASH_ACR = (FLASH_ACR & ~7U) | FLASH_ACR_LATENCY_2WS;
+    while ((FLASH_ACR & 7U) != FLASH_ACR_LATENCY_2WS)
+    {
+
+    }
+
+    while ((RCC_CR & RCC_CR_MSIRDY) == 0U)
+    {
+
+    }
+    RCC_CR = (RCC_CR & ~(0xFU << 4)) | RCC_CR_MSIRANGE_48MHZ | RCC_CR_MSIRGSEL;
+
+    RCC_AHB2ENR |= RCC_AHB2ENR_GPIOAEN;
+    RCC_APB1ENR1 |= RCC_APB1ENR1_PWREN | RCC_APB1ENR1_USBFSEN | RCC_APB1ENR1_CRSEN;
+    PWR_CR2 |= PWR_CR2_USV;
+
+    /* CLK48SEL resets to HSI48. */
+    RCC_CRRCR |= RCC_CRRCR_HSI48ON;
+    while ((RCC_CRRCR & RCC_CRRCR_HSI48RDY) == 0U)
+    {
+
+    }
+    CRS_CR |= CRS_CR_AUTOTRIMEN | CRS_CR_CEN;
+
+    /* PA11 and PA12, alternate function 10, very high speed. */
+    GPIOA_AFRH = (GPIOA_AFRH & ~0x000FF000U) | 0x000AA000UL;
+    GPIOA_OSPEEDR |= 0x03C00000UL;
+    GPIOA_MODER = (GPIOA_MODER & ~0x03C00000U) | 0x02800000UL;
+
+    NVIC_ISER2 = NVIC_ISER2_USB;
+}
+
+static void record(volatile struct cycles *me, uint32_t val)
+{
+    me->min = (me->count == 0U || val < me->min) ? val : me->min;
+    me->max = (val > me->max) ? val : me->max;
+    me->last = val;
+    me->count++;
+}
+
+static bool configure(void *obj, uint8_t config)
+{
+    struct cusb_device *d = (struct cusb_device *)obj;
+
+    if (config != 0U)
+    {
+        cusb_device_ep_open(d, EP_OUT, CUSB_EP_BULK, EP_MPS, &done, d);
+        cusb_device_ep_open(d, EP_IN, CUSB_EP_BULK, EP_MPS, &done, d);
+        (void)cusb_device_ep_xfer(d, EP_OUT, loopback, sizeof(loopback));
+    }
+
+    return true;
+}
+
+static void done(void *obj, uint8_t ep, uint8_t *buf, uint32_t len, bool ok)
+{
+    struct cusb_device *d = (struct cusb_device *)obj;
+
+    if (ep == EP_OUT && ok && len > 0U)
+    {
+        (void)cusb_device_ep_xfer(d, EP_IN, buf, len);
+    }
+    else
+    {
+        (void)cusb_device_ep_xfer(d, EP_OUT, loopback, sizeof(loopback));
+    }
+}
+
+static void wake(void *obj)
+{
+    (void)obj;
+    woken = true;
+}
+
+/*------------------------------------------------------------*/
+/*--------------------------- MAIN ---------------------------*/
+/*------------------------------------------------------------*/
+
+void USB_IRQHandler(void)
+{
+    uint32_t start = cusb_load_cycles();
+    cusb_stm32fs_isr(&usb);
+    record(&cusb_integration_cycles.isr, cusb_load_cycles() - start);
+}
+
+int main(void)
+{
+    board_init();
+    cusb_load_cycles_init();
+
+    cusb_stm32fs_ctor(&usb, false, &wake, NULL);
+    cusb_device_ctor(&dev, &usb.dcd, &DESCRIPTORS, &CALLBACKS, &dev);
+    cusb_device_start(&dev, true);
+
+    while (1)
+    {
+        size_t n;
+
+        /* A pending interrupt ends WFI with interrupts masked, so the
+        wake cannot slip in between the check and the sleep. */
+        __asm__ volatile ("cpsid i" ::: "memory");
+        if (!woken)
+        {
+            __asm__ volatile ("wfi" ::: "memory");
+        }
+        __asm__ volatile ("cpsie i" ::: "memory");
+        woken = false;
+
+        do
+        {
+            uint32_t start = cusb_load_cycles();
+            n = cusb_poll(&dev, POLL_BUDGET);
+
+            if (n > 0U)
+            {
+                record(&cusb_integration_cycles.poll, cusb_load_cycles() - start);
+            }
+        } while (n == POLL_BUDGET);
+    }
+}
+
+/*------------------------------------------------------------*/
+/*---------------- ASSERT HANDLER DEFINITION -----------------*/
+/*------------------------------------------------------------*/
+
+void ecu_assert_handler(const char *file, int line)
+{
+    (void)file;
+    (void)line;
+    __asm__ volatile ("bkpt #0");
+
+    while (1)
+    {
+
+    }
+}
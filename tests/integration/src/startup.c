@@ -0,0 +1,141 @@
+/**
+ * @file
+ * @brief Vector table and reset handler of the STM32L432 integration
+ * test. Only the interrupts the test uses have handlers, the other
+ * interrupts are never enabled.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* STDLib. */
+#include <stdint.h>
+
+/*------------------------------------------------------------*/
+/*--------------------------- DEFINES ------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Cortex-M4 exceptions after the initial stack pointer.
+ */
+#define CORE_VECTORS                        (15U)
+
+/**
+ * @brief USB FS global interrupt number on STM32L4.
+ */
+#define USB_IRQN                            (67U)
+
+/**
+ * @brief Coprocessor access control. Full access to CP10 and CP11 (FPU).
+ */
+#define CPACR                               (*(volatile uint32_t *)0xE000ED88UL)
+#define CPACR_FPU                           (0xFUL << 20)
+
+/*------------------------------------------------------------*/
+/*----------------- STATIC FUNCTION DECLARATIONS -------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Every exception without a handler. Stops for the debugger.
+ */
+static void default_handler(void);
+
+/**
+ * @brief Entry point. Copies .data, clears .bss and calls main().
+ */
+void Reset_Handler(void);
+
+/**
+ * @brief Defined by main.c.
+ */
+extern int main(void);
+extern void USB_IRQHandler(void);
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE SCOPE VARIABLES ----------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Symbols of the linker script.
+ */
+extern uint32_t _estack;
+extern uint32_t _sidata;
+extern uint32_t _sdata;
+extern uint32_t _edata;
+extern uint32_t _sbss;
+extern uint32_t _ebss;
+
+/**
+ * @brief Vector table. Placed at the start of flash by the linker script.
+ */
+__attribute__((section(".isr_vector"), used))
+static const struct
+{
+    uint32_t *stack;
+    void (*handler[CORE_VECTORS + USB_IRQN + 1U])(void);
+} VECTORS =
+{
+    &_estack,
+    {
+        [0] = &Reset_Handler,       /* Reset. */
+        [1] = &default_handler,     /* NMI. */
+        [2] = &default_handler,     /* HardFault. */
+        [3] = &default_handler,     /* MemManage. */
+        [4] = &default_handler,     /* BusFault. */
+        [5] = &default_handler,     /* UsageFault. */
+        [10] = &default_handler,    /* SVCall. */
+        [13] = &default_handler,    /* PendSV. */
+        [14] = &default_handler,    /* SysTick. */
+        [CORE_VECTORS + USB_IRQN] = &USB_IRQHandler
+    }
+};
+
+/*------------------------------------------------------------*/
+/*----------------- STATIC FUNCTION DEFINITIONS --------------*/
+/*------------------------------------------------------------*/
+
+static void default_handler(void)
+{
+    __asm__ volatile ("bkpt #0");
+
+    while (1)
+    {
+
+    }
+}
+
+/*------------------------------------------------------------*/
+/*----------------------- RESET HANDLER ----------------------*/
+/*------------------------------------------------------------*/
+
+void Reset_Handler(void)
+{
+    const uint32_t *src = &_sidata;
+
+    for (uint32_t *dst = &_sdata; dst < &_edata; dst++)
+    {
+        *dst = *src++;
+    }
+
+    for (uint32_t *dst = &_sbss; dst < &_ebss; dst++)
+    {
+        *dst = 0;
+    }
+
+    /* Built for the hard float ABI. */
+    CPACR |= CPACR_FPU;
+    __asm__ volatile ("dsb\n\tisb" ::: "memory");
+
+    (void)main();
+
+    while (1)
+    {
+
+    }
+}
@@ -0,0 +1,300 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref asrc.h
+ *
+ * Test Summary:
+ *
+ * cusb_asrc_write(), cusb_asrc_read()
+ *      - TEST(Asrc, SilentUntilHalfFull)
+ *      - TEST(Asrc, UnityGain)
+ *      - TEST(Asrc, ChannelsStaySeparate)
+ *      - TEST(Asrc, FullFifoDropsExcess)
+ *      - TEST(Asrc, UnderrunGoesSilentAndRestarts)
+ *      - TEST(Asrc, PartialFrameAsserts)
+ *
+ * cusb_asrc_ppm(), cusb_asrc_fill()
+ *      - TEST(Asrc, TracksFastHost)
+ *      - TEST(Asrc, TracksSlowHost)
+ *      - TEST(Asrc, ResetForgetsRate)
+ *
+ * cusb_asrc_fir_c(), cusb_asrc_fir_dsp(), cusb_asrc_fir_sse2()
+ *      - TEST(Asrc, PhaseZeroInterpolatesOwnFrame)
+ *      - TEST(Asrc, BackendsMatch)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/asrc.h"
+
+/* STDLib. */
+#include <cstring>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint16_t SIZE = 256;
+constexpr std::uint8_t CHANNELS = 2;
+
+/**
+ * @brief USB packet of @p frames stereo frames of @p left and
+ * @p right.
+ */
+std::vector<std::uint8_t> packet(std::uint32_t frames, std::int16_t left, std::int16_t right)
+{
+    std::vector<std::uint8_t> pkt;
+
+    for (std::uint32_t i = 0; i < frames; i++)
+    {
+        for (std::int16_t v : {left, right})
+        {
+            pkt.push_back(static_cast<std::uint8_t>(v));
+            pkt.push_back(static_cast<std::uint8_t>(static_cast<std::uint16_t>(v) >> 8));
+        }
+    }
+
+    return pkt;
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Asrc)
+{
+    void setup() override
+    {
+        cusb_asrc_ctor(&m_asrc, m_mem, SIZE, CHANNELS);
+    }
+
+    std::uint32_t write(std::uint32_t frames, std::int16_t left = 1000, std::int16_t right = -1000)
+    {
+        auto pkt = packet(frames, left, right);
+        return cusb_asrc_write(&m_asrc, pkt.data(), static_cast<std::uint32_t>(pkt.size()));
+    }
+
+    /**
+     * @brief Runs @p seconds of 1 ms packets from a host @p ppm off the
+     * codec's clock, read back in 48 frame blocks.
+     */
+    void run(int ppm, int seconds)
+    {
+        std::int16_t out[48 * CHANNELS];
+        std::int64_t sent = 0;
+
+        for (std::int64_t ms = 1; ms <= seconds * 1000; ms++)
+        {
+            std::int64_t due = (ms * 48 * (1000000 + ppm)) / 1000000;
+            CHECK_EQUAL(due - sent, write(static_cast<std::uint32_t>(due - sent)));
+            sent = due;
+            cusb_asrc_read(&m_asrc, out, 48);
+        }
+    }
+
+    void check_tracked(int ppm)
+    {
+        CHECK_TRUE( (cusb_asrc_ppm(&m_asrc) >= ppm - 10 && cusb_asrc_ppm(&m_asrc) <= ppm + 10) );
+        CHECK_TRUE( (cusb_asrc_fill(&m_asrc) >= SIZE / 2U - 4U && cusb_asrc_fill(&m_asrc) <= SIZE / 2U + 4U) );
+#if (CUSB_CFG_STATS)
+        CHECK_EQUAL(0U, cusb_asrc_get_stats(&m_asrc)->underruns);
+        CHECK_EQUAL(0U, cusb_asrc_get_stats(&m_asrc)->overflows);
+#endif
+    }
+
+    struct cusb_asrc m_asrc;
+    std::int16_t m_mem[2 * SIZE * CHANNELS];
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Asrc, SilentUntilHalfFull)
+{
+    std::int16_t out[16 * CHANNELS];
+
+    write(SIZE / 2U - 1U);
+    std::memset(out, 0x55, sizeof(out));
+    cusb_asrc_read(&m_asrc, out, 16);
+
+    for (std::int16_t s : out)
+    {
+        CHECK_EQUAL(0, s);
+    }
+    CHECK_EQUAL(SIZE / 2U - 1U, cusb_asrc_fill(&m_asrc));
+
+    write(1);
+    cusb_asrc_read(&m_asrc, out, 16);
+    CHECK_EQUAL(1000, out[0]);
+    CHECK_EQUAL(-1000, out[1]);
+}
+
+TEST(Asrc, UnityGain)
+{
+    std::int16_t out[48 * CHANNELS];
+
+    /* Every phase sums to one, so a constant comes out unchanged even
+    while the rate moves. */
+    write(SIZE - 16U, 32767, -32768);
+
+    for (int i = 0; i < 2; i++)
+    {
+        cusb_asrc_read(&m_asrc, out, 48);
+
+        for (std::uint32_t k = 0; k < 48; k++)
+        {
+            CHECK_EQUAL(32767, out[2 * k]);
+            CHECK_EQUAL(-32768, out[2 * k + 1]);
+        }
+    }
+
+    CHECK_TRUE( (cusb_asrc_ppm(&m_asrc) > 0) );
+}
+
+TEST(Asrc, ChannelsStaySeparate)
+{
+    std::int16_t out[CHANNELS] = {};
+    std::uint32_t reads = 0;
+
+    write(SIZE / 2U, 0, 0);
+    write(CUSB_ASRC_TAPS, 20000, 0);
+
+    /* Only the left channel ever sees the step. */
+    while (out[0] < 10000 && reads++ < SIZE)
+    {
+        cusb_asrc_read(&m_asrc, out, 1);
+        CHECK_EQUAL(0, out[1]);
+    }
+
+    CHECK_TRUE( (out[0] >= 10000) );
+}
+
+TEST(Asrc, FullFifoDropsExcess)
+{
+    CHECK_EQUAL(SIZE - 10U, write(SIZE - 10U));
+    CHECK_EQUAL(10U, write(48));
+    CHECK_EQUAL(SIZE, cusb_asrc_fill(&m_asrc));
+    CHECK_EQUAL(0U, write(1));
+
+#if (CUSB_CFG_STATS)
+    CHECK_EQUAL(39U, cusb_asrc_get_stats(&m_asrc)->overflows);
+#endif
+}
+
+TEST(Asrc, UnderrunGoesSilentAndRestarts)
+{
+    std::int16_t out[SIZE * CHANNELS];
+
+    write(SIZE / 2U);
+    cusb_asrc_read(&m_asrc, out, SIZE);
+
+    /* Played until the filter no longer had enough frames. */
+    CHECK_EQUAL(1000, out[0]);
+    CHECK_EQUAL(0, out[2 * (SIZE - 1U)]);
+    CHECK_TRUE( (cusb_asrc_fill(&m_asrc) < CUSB_ASRC_TAPS) );
+#if (CUSB_CFG_STATS)
+    CHECK_EQUAL(1U, cusb_asrc_get_stats(&m_asrc)->underruns);
+#endif
+
+    /* Waits for half full again before playing. */
+    write(SIZE / 4U);
+    cusb_asrc_read(&m_asrc, out, 1);
+    CHECK_EQUAL(0, out[0]);
+    write(SIZE / 4U);
+    cusb_asrc_read(&m_asrc, out, 1);
+    CHECK_EQUAL(1000, out[0]);
+}
+
+TEST(Asrc, PartialFrameAsserts)
+{
+    std::uint8_t pkt[6] = {};
+    CHECK_THROWS(stubs::assert_exception, cusb_asrc_write(&m_asrc, pkt, sizeof(pkt)));
+}
+
+TEST(Asrc, TracksFastHost)
+{
+    run(500, 30);
+    check_tracked(500);
+}
+
+TEST(Asrc, TracksSlowHost)
+{
+    run(-800, 30);
+    check_tracked(-800);
+}
+
+TEST(Asrc, ResetForgetsRate)
+{
+    run(300, 10);
+    CHECK_TRUE( (cusb_asrc_ppm(&m_asrc) > 200) );
+
+    cusb_asrc_reset(&m_asrc);
+    CHECK_EQUAL(0, cusb_asrc_ppm(&m_asrc));
+    CHECK_EQUAL(0U, cusb_asrc_fill(&m_asrc));
+}
+
+TEST(Asrc, PhaseZeroInterpolatesOwnFrame)
+{
+    /* A lone impulse at the interpolation point mostly comes through,
+    and its neighbours barely. */
+    std::int16_t x[CUSB_ASRC_TAPS] = {};
+    x[CUSB_ASRC_TAPS / 2U - 1U] = 32767;
+
+    CHECK_TRUE( (cusb_asrc_fir_c(x, cusb_asrc_phase(0), 0) > 29000) );
+    CHECK_TRUE( (cusb_asrc_fir_c(x, cusb_asrc_phase(CUSB_ASRC_PHASES - 1U), 32767) < 4000) );
+}
+
+TEST(Asrc, BackendsMatch)
+{
+    std::int16_t x[CUSB_ASRC_TAPS + 8];
+    std::uint32_t seed = 1;
+
+    for (std::uint32_t i = 0; i < 20000; i++)
+    {
+        for (std::int16_t &v : x)
+        {
+            seed = seed * 1664525U + 1013904223U;
+            v = static_cast<std::int16_t>(seed >> 16);
+        }
+
+        if (i % 4U == 0)
+        {
+            /* Full-scale alternating input, the worst case for overflow. */
+            for (std::uint32_t k = 0; k < CUSB_ASRC_TAPS + 8; k++)
+            {
+                x[k] = (k & 1U) ? 32767 : -32768;
+            }
+        }
+
+        const std::int16_t *coef = cusb_asrc_phase(seed % CUSB_ASRC_PHASES);
+        std::uint32_t weight = (seed >> 7) & 0x7FFFU;
+        const std::int16_t *at = &x[i % 8U];
+        std::int16_t expected = cusb_asrc_fir_c(at, coef, weight);
+        (void)expected;
+
+#if (CUSB_ASRC_HAS_DSP)
+        CHECK_EQUAL(expected, cusb_asrc_fir_dsp(at, coef, weight));
+#endif
+#if (CUSB_ASRC_HAS_SSE2)
+        CHECK_EQUAL(expected, cusb_asrc_fir_sse2(at, coef, weight));
+#endif
+    }
+}
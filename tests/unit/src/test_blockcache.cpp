@@ -0,0 +1,338 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref blockcache.h
+ *
+ * Test Summary:
+ *
+ * Writes
+ *      - TEST(BlockCache, SectorWritesCoalesceIntoOneErase)
+ *      - TEST(BlockCache, FullEraseBlockWriteSkipsFill)
+ *      - TEST(BlockCache, EvictsLeastRecentlyUsed)
+ *      - TEST(BlockCache, FailedFillFailsWrite)
+ *      - TEST(BlockCache, FailedEvictionIsReportedOnSync)
+ *      - TEST(BlockCache, WriteFailsWhenNoLineCanBeEvicted)
+ *
+ * Reads
+ *      - TEST(BlockCache, ReadsSeeCachedData)
+ *
+ * cusb_blockcache_flush(), cusb_blockcache_idle()
+ *      - TEST(BlockCache, FlushWritesBackWithoutSync)
+ *      - TEST(BlockCache, FailedFlushIsReportedOnSync)
+ *
+ * Asynchronous flash
+ *      - TEST(BlockCache, RequestsCompleteInOrder)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/blockcache.h"
+
+/* STDLib. */
+#include <cstring>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+#include "stubs/stub_blockdev.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint32_t BLOCK_SIZE = 512;
+constexpr std::uint32_t BLOCK_COUNT = 64;
+constexpr std::uint32_t ERASE_BLOCKS = 8;
+constexpr std::uint32_t ERASE_SIZE = ERASE_BLOCKS * BLOCK_SIZE;
+constexpr std::size_t LINES = 2;
+
+/**
+ * @brief Request submitted to the cache, with its own buffer.
+ */
+struct request
+{
+    request(std::uint8_t op, std::uint32_t lba, std::uint32_t count, std::uint8_t fill = 0)
+        : buf(static_cast<std::size_t>(count) * BLOCK_SIZE, fill)
+    {
+        std::memset(&req, 0, sizeof(req));
+        req.op = op;
+        req.lba = lba;
+        req.count = count;
+        req.buf = buf.data();
+        req.done = &on_done;
+        req.owner = this;
+    }
+
+    static void on_done(struct cusb_blockdev_req *r, bool ok)
+    {
+        auto *me = static_cast<request *>(r->owner);
+        me->completions++;
+        me->ok = ok;
+    }
+
+    struct cusb_blockdev_req req;
+    std::vector<std::uint8_t> buf;
+    int completions = 0;
+    bool ok = false;
+};
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(BlockCache)
+{
+    void setup() override
+    {
+        m_flash.fill_pattern();
+        m_flash.erase_blocks = ERASE_BLOCKS;
+        cusb_blockcache_ctor(&m_cache, &m_flash.dev, m_lines, LINES, m_ram, ERASE_SIZE);
+    }
+
+    void submit(request &r)
+    {
+        cusb_blockdev_submit(cusb_blockcache_blockdev(&m_cache), &r.req);
+    }
+
+    /**
+     * @brief Submits and expects synchronous success.
+     */
+    void run(request &r)
+    {
+        submit(r);
+        LONGS_EQUAL(1, r.completions);
+        CHECK_TRUE( (r.ok) );
+    }
+
+    struct cusb_blockcache_stats stats()
+    {
+        struct cusb_blockcache_stats s;
+        cusb_blockcache_get_stats(&m_cache, &s);
+        return s;
+    }
+
+    stubs::blockdev m_flash{BLOCK_SIZE, BLOCK_COUNT};
+    struct cusb_blockcache m_cache;
+    struct cusb_blockcache_line m_lines[LINES];
+    std::uint8_t m_ram[LINES * ERASE_SIZE];
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(BlockCache, SectorWritesCoalesceIntoOneErase)
+{
+    for (std::uint32_t lba = 0; lba < 2 * ERASE_BLOCKS; lba++)
+    {
+        request w{CUSB_BLOCKDEV_WRITE, lba, 1, static_cast<std::uint8_t>(lba + 1)};
+        run(w);
+    }
+
+    UNSIGNED_LONGS_EQUAL(0, m_flash.writes);
+    CHECK_FALSE( (cusb_blockcache_idle(&m_cache)) );
+
+    request sync{CUSB_BLOCKDEV_SYNC, 0, 0};
+    run(sync);
+    UNSIGNED_LONGS_EQUAL(2, m_flash.erases);
+    UNSIGNED_LONGS_EQUAL(1, m_flash.syncs);
+    UNSIGNED_LONGS_EQUAL(2, stats().fills);
+    UNSIGNED_LONGS_EQUAL(2, stats().writebacks);
+    CHECK_TRUE( (cusb_blockcache_idle(&m_cache)) );
+
+    for (std::uint32_t lba = 0; lba < 2 * ERASE_BLOCKS; lba++)
+    {
+        BYTES_EQUAL(lba + 1, m_flash.data[lba * BLOCK_SIZE + 100]);
+    }
+}
+
+TEST(BlockCache, FullEraseBlockWriteSkipsFill)
+{
+    request w{CUSB_BLOCKDEV_WRITE, ERASE_BLOCKS, ERASE_BLOCKS, 0x5A};
+    run(w);
+    request sync{CUSB_BLOCKDEV_SYNC, 0, 0};
+    run(sync);
+
+    UNSIGNED_LONGS_EQUAL(0, m_flash.reads);
+    UNSIGNED_LONGS_EQUAL(1, m_flash.erases);
+    BYTES_EQUAL(0x5A, m_flash.data[ERASE_SIZE]);
+}
+
+TEST(BlockCache, EvictsLeastRecentlyUsed)
+{
+    request w0{CUSB_BLOCKDEV_WRITE, 0, 1, 0x10};
+    request w1{CUSB_BLOCKDEV_WRITE, ERASE_BLOCKS, 1, 0x11};
+    request r0{CUSB_BLOCKDEV_READ, 1, 1};
+    request w2{CUSB_BLOCKDEV_WRITE, 2 * ERASE_BLOCKS, 1, 0x12};
+    run(w0);
+    run(w1);
+    run(r0);
+    run(w2);
+
+    /* Erase block 1 was least recently used. */
+    UNSIGNED_LONGS_EQUAL(1, m_flash.erases);
+    BYTES_EQUAL(0x11, m_flash.data[ERASE_SIZE]);
+    BYTES_EQUAL(stubs::blockdev::pattern(0, 0), m_flash.data[0]);
+}
+
+TEST(BlockCache, FailedFillFailsWrite)
+{
+    request w{CUSB_BLOCKDEV_WRITE, 3, 1, 0x77};
+    m_flash.fail = true;
+    submit(w);
+    LONGS_EQUAL(1, w.completions);
+    CHECK_FALSE( (w.ok) );
+    CHECK_TRUE( (cusb_blockcache_idle(&m_cache)) );
+
+    /* Nothing half-filled is left behind. */
+    m_flash.fail = false;
+    request r{CUSB_BLOCKDEV_READ, 0, ERASE_BLOCKS};
+    run(r);
+    BYTES_EQUAL(stubs::blockdev::pattern(3, 0), r.buf[3 * BLOCK_SIZE]);
+}
+
+TEST(BlockCache, FailedEvictionIsReportedOnSync)
+{
+    request w0{CUSB_BLOCKDEV_WRITE, 0, ERASE_BLOCKS, 0x10};
+    request w1{CUSB_BLOCKDEV_WRITE, ERASE_BLOCKS, ERASE_BLOCKS, 0x11};
+    request w2{CUSB_BLOCKDEV_WRITE, 2 * ERASE_BLOCKS, ERASE_BLOCKS, 0x12};
+    run(w0);
+    run(w1);
+
+    /* Erase block 0 fails to go back, so erase block 1 is evicted instead. */
+    m_flash.async = true;
+    submit(w2);
+    m_flash.complete(0, false);
+    LONGS_EQUAL(0, w2.completions);
+    m_flash.complete();
+    LONGS_EQUAL(1, w2.completions);
+    CHECK_TRUE( (w2.ok) );
+    BYTES_EQUAL(0x11, m_flash.data[ERASE_SIZE]);
+
+    /* Erase block 0 is retried and lands, but the SYNC still reports the loss. */
+    request sync{CUSB_BLOCKDEV_SYNC, 0, 0};
+    submit(sync);
+    while (!m_flash.queue.empty())
+    {
+        m_flash.complete();
+    }
+    LONGS_EQUAL(1, sync.completions);
+    CHECK_FALSE( (sync.ok) );
+    BYTES_EQUAL(0x10, m_flash.data[0]);
+
+    m_flash.async = false;
+    request again{CUSB_BLOCKDEV_SYNC, 0, 0};
+    run(again);
+    CHECK_TRUE( (cusb_blockcache_idle(&m_cache)) );
+}
+
+TEST(BlockCache, WriteFailsWhenNoLineCanBeEvicted)
+{
+    request w0{CUSB_BLOCKDEV_WRITE, 0, ERASE_BLOCKS, 0x10};
+    request w1{CUSB_BLOCKDEV_WRITE, ERASE_BLOCKS, ERASE_BLOCKS, 0x11};
+    request w2{CUSB_BLOCKDEV_WRITE, 2 * ERASE_BLOCKS, ERASE_BLOCKS, 0x12};
+    run(w0);
+    run(w1);
+
+    m_flash.fail = true;
+    submit(w2);
+    LONGS_EQUAL(1, w2.completions);
+    CHECK_FALSE( (w2.ok) );
+    UNSIGNED_LONGS_EQUAL(LINES, m_flash.writes);
+
+    /* Both lines are still dirty and go back once the flash recovers. */
+    m_flash.fail = false;
+    request sync{CUSB_BLOCKDEV_SYNC, 0, 0};
+    submit(sync);
+    CHECK_FALSE( (sync.ok) );
+    BYTES_EQUAL(0x10, m_flash.data[0]);
+    BYTES_EQUAL(0x11, m_flash.data[ERASE_SIZE]);
+}
+
+TEST(BlockCache, ReadsSeeCachedData)
+{
+    request w{CUSB_BLOCKDEV_WRITE, ERASE_BLOCKS + 2, 1, 0xEE};
+    run(w);
+    unsigned reads = m_flash.reads;
+
+    /* Spans an uncached and a cached erase block. */
+    request r{CUSB_BLOCKDEV_READ, ERASE_BLOCKS - 2, 6};
+    run(r);
+    UNSIGNED_LONGS_EQUAL(reads + 1, m_flash.reads);
+    UNSIGNED_LONGS_EQUAL(1, stats().read_hits);
+    BYTES_EQUAL(stubs::blockdev::pattern(ERASE_BLOCKS - 2, 9), r.buf[9]);
+    BYTES_EQUAL(stubs::blockdev::pattern(ERASE_BLOCKS + 1, 9), r.buf[3 * BLOCK_SIZE + 9]);
+    BYTES_EQUAL(0xEE, r.buf[4 * BLOCK_SIZE]);
+    BYTES_EQUAL(stubs::blockdev::pattern(ERASE_BLOCKS + 3, 0), r.buf[5 * BLOCK_SIZE]);
+}
+
+TEST(BlockCache, FlushWritesBackWithoutSync)
+{
+    CHECK_FALSE( (cusb_blockcache_flush(&m_cache)) );
+
+    request w{CUSB_BLOCKDEV_WRITE, 5, 2, 0x42};
+    run(w);
+    CHECK_TRUE( (cusb_blockcache_flush(&m_cache)) );
+
+    CHECK_TRUE( (cusb_blockcache_idle(&m_cache)) );
+    UNSIGNED_LONGS_EQUAL(1, m_flash.erases);
+    UNSIGNED_LONGS_EQUAL(0, m_flash.syncs);
+    BYTES_EQUAL(0x42, m_flash.data[6 * BLOCK_SIZE]);
+    CHECK_FALSE( (cusb_blockcache_flush(&m_cache)) );
+}
+
+TEST(BlockCache, FailedFlushIsReportedOnSync)
+{
+    request w{CUSB_BLOCKDEV_WRITE, 5, 2, 0x42};
+    run(w);
+
+    m_flash.fail = true;
+    CHECK_TRUE( (cusb_blockcache_flush(&m_cache)) );
+    CHECK_FALSE( (cusb_blockcache_idle(&m_cache)) );
+
+    m_flash.fail = false;
+    request sync{CUSB_BLOCKDEV_SYNC, 0, 0};
+    submit(sync);
+    LONGS_EQUAL(1, sync.completions);
+    CHECK_FALSE( (sync.ok) );
+    BYTES_EQUAL(0x42, m_flash.data[6 * BLOCK_SIZE]);
+    CHECK_TRUE( (cusb_blockcache_idle(&m_cache)) );
+}
+
+TEST(BlockCache, RequestsCompleteInOrder)
+{
+    m_flash.async = true;
+    request w{CUSB_BLOCKDEV_WRITE, 1, 1, 0x33};
+    request r{CUSB_BLOCKDEV_READ, 1, 1};
+    request sync{CUSB_BLOCKDEV_SYNC, 0, 0};
+    submit(w);
+    submit(r);
+    submit(sync);
+
+    /* Fill for the write. */
+    UNSIGNED_LONGS_EQUAL(1, m_flash.queue.size());
+    m_flash.complete();
+    LONGS_EQUAL(1, w.completions);
+    LONGS_EQUAL(1, r.completions);
+    BYTES_EQUAL(0x33, r.buf[0]);
+
+    /* Write back, then the flash's own sync. */
+    m_flash.complete();
+    LONGS_EQUAL(0, sync.completions);
+    m_flash.complete();
+    LONGS_EQUAL(1, sync.completions);
+    CHECK_TRUE( (m_flash.queue.empty()) );
+}
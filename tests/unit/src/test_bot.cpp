@@ -0,0 +1,314 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref bot.h
+ *
+ * Test Summary:
+ *
+ * cusb_bot_bulk_out(), cusb_bot_bulk_in()
+ *      - TEST(Bot, CommandWithoutData)
+ *      - TEST(Bot, ReadData)
+ *      - TEST(Bot, WriteData)
+ *
+ * Data phase mismatches
+ *      - TEST(Bot, HostExpectsMoreThanDeviceHas)
+ *      - TEST(Bot, DirectionMismatchIsPhaseError)
+ *      - TEST(Bot, FailedWriteDropsData)
+ *
+ * cusb_bot_control(), cusb_bot_clear_halt()
+ *      - TEST(Bot, GetMaxLun)
+ *      - TEST(Bot, InvalidCbwNeedsResetRecovery)
+ *
+ * Multiple logical units
+ *      - TEST(Bot, SlowLunDoesNotBlockTransport)
+ *      - TEST(Bot, ResetWhileBackendBusy)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/bot.h"
+
+/* STDLib. */
+#include <cstring>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+#include "stubs/stub_blockdev.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint32_t BLOCK_SIZE = 512;
+constexpr std::uint32_t BLOCK_COUNT = 64;
+constexpr std::size_t TASK_BUFFER_SIZE = 4 * BLOCK_SIZE;
+constexpr std::uint16_t PACKET_SIZE = 512;
+
+constexpr std::uint8_t CSW_PASSED = 0x00;
+constexpr std::uint8_t CSW_FAILED = 0x01;
+constexpr std::uint8_t CSW_PHASE_ERROR = 0x02;
+
+const struct cusb_scsi_inquiry INQUIRY = {"cusb", "BOT Test", "1.0"};
+
+std::uint32_t get_le32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16)) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+std::vector<std::uint8_t> cbw(std::uint32_t tag, std::uint32_t data_len, bool in,
+                              std::vector<std::uint8_t> cdb, std::uint8_t lun = 0)
+{
+    std::vector<std::uint8_t> pkt(31, 0);
+    pkt[0] = 'U';
+    pkt[1] = 'S';
+    pkt[2] = 'B';
+    pkt[3] = 'C';
+
+    for (unsigned i = 0; i < 4; i++)
+    {
+        pkt[4 + i] = static_cast<std::uint8_t>(tag >> (8 * i));
+        pkt[8 + i] = static_cast<std::uint8_t>(data_len >> (8 * i));
+    }
+
+    pkt[12] = in ? 0x80 : 0x00;
+    pkt[13] = lun;
+    pkt[14] = static_cast<std::uint8_t>(cdb.size());
+    std::copy(cdb.begin(), cdb.end(), pkt.begin() + 15);
+    return pkt;
+}
+
+std::vector<std::uint8_t> read10(std::uint32_t lba, std::uint16_t blocks)
+{
+    return {0x28, 0, 0, 0, static_cast<std::uint8_t>(lba >> 8), static_cast<std::uint8_t>(lba), 0,
+            static_cast<std::uint8_t>(blocks >> 8), static_cast<std::uint8_t>(blocks), 0};
+}
+
+std::vector<std::uint8_t> write10(std::uint32_t lba, std::uint16_t blocks)
+{
+    std::vector<std::uint8_t> cdb = read10(lba, blocks);
+    cdb[0] = 0x2A;
+    return cdb;
+}
+
+void on_notify(void *ctx)
+{
+    (*static_cast<int *>(ctx))++;
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Bot)
+{
+    void setup() override
+    {
+        m_fast.fill_pattern();
+        m_slow.fill_pattern();
+        cusb_scsi_ctor(&m_luns[0], &m_fast.dev, &INQUIRY);
+        cusb_scsi_ctor(&m_luns[1], &m_slow.dev, &INQUIRY);
+        cusb_bot_ctor(&m_bot, m_luns, 2, m_buffer, sizeof(m_buffer), PACKET_SIZE, &on_notify, &m_notifications);
+    }
+
+    void send(const std::vector<std::uint8_t> &pkt)
+    {
+        CHECK_TRUE( (cusb_bot_bulk_out_space(&m_bot) >= pkt.size()) );
+        cusb_bot_bulk_out(&m_bot, pkt.data(), pkt.size());
+    }
+
+    /**
+     * @brief Returns next Bulk-IN transfer, empty if the endpoint NAKs.
+     */
+    std::vector<std::uint8_t> receive()
+    {
+        std::uint8_t buf[PACKET_SIZE];
+        std::size_t len = 0;
+
+        if (!cusb_bot_bulk_in(&m_bot, buf, sizeof(buf), &len))
+        {
+            return {};
+        }
+
+        return std::vector<std::uint8_t>(buf, buf + len);
+    }
+
+    void check_csw(std::uint32_t tag, std::uint32_t residue, std::uint8_t status)
+    {
+        std::vector<std::uint8_t> csw = receive();
+        LONGS_EQUAL(CUSB_BOT_CSW_SIZE, csw.size());
+        UNSIGNED_LONGS_EQUAL(0x53425355UL, get_le32(&csw[0]));
+        UNSIGNED_LONGS_EQUAL(tag, get_le32(&csw[4]));
+        UNSIGNED_LONGS_EQUAL(residue, get_le32(&csw[8]));
+        BYTES_EQUAL(status, csw[12]);
+    }
+
+    stubs::blockdev m_fast{BLOCK_SIZE, BLOCK_COUNT};
+    stubs::blockdev m_slow{BLOCK_SIZE, BLOCK_COUNT, true};
+    struct cusb_scsi m_luns[2];
+    struct cusb_bot m_bot;
+    std::uint8_t m_buffer[TASK_BUFFER_SIZE];
+    int m_notifications = 0;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Bot, CommandWithoutData)
+{
+    send(cbw(0x11223344, 0, false, {0x00, 0, 0, 0, 0, 0}));
+    UNSIGNED_LONGS_EQUAL(0, cusb_bot_bulk_out_space(&m_bot));
+    check_csw(0x11223344, 0, CSW_PASSED);
+    UNSIGNED_LONGS_EQUAL(0, cusb_bot_halt(&m_bot));
+    UNSIGNED_LONGS_EQUAL(PACKET_SIZE, cusb_bot_bulk_out_space(&m_bot));
+    CHECK_TRUE( (receive().empty()) );
+}
+
+TEST(Bot, ReadData)
+{
+    send(cbw(1, 2 * BLOCK_SIZE, true, read10(3, 2)));
+
+    std::vector<std::uint8_t> first = receive();
+    std::vector<std::uint8_t> second = receive();
+    LONGS_EQUAL(PACKET_SIZE, first.size());
+    LONGS_EQUAL(PACKET_SIZE, second.size());
+    BYTES_EQUAL(stubs::blockdev::pattern(3, 7), first[7]);
+    BYTES_EQUAL(stubs::blockdev::pattern(4, 7), second[7]);
+    check_csw(1, 0, CSW_PASSED);
+    UNSIGNED_LONGS_EQUAL(0, cusb_bot_halt(&m_bot));
+}
+
+TEST(Bot, WriteData)
+{
+    send(cbw(2, BLOCK_SIZE, false, write10(5, 1)));
+    UNSIGNED_LONGS_EQUAL(BLOCK_SIZE, cusb_bot_bulk_out_space(&m_bot));
+    CHECK_TRUE( (receive().empty()) );
+
+    std::vector<std::uint8_t> data(BLOCK_SIZE, 0x5A);
+    send(data);
+    check_csw(2, 0, CSW_PASSED);
+    BYTES_EQUAL(0x5A, m_fast.data[5 * BLOCK_SIZE]);
+}
+
+TEST(Bot, HostExpectsMoreThanDeviceHas)
+{
+    /* Hi > Di on a packet boundary: the device halts Bulk-IN. */
+    send(cbw(3, 2 * BLOCK_SIZE, true, read10(0, 1)));
+    LONGS_EQUAL(BLOCK_SIZE, receive().size());
+    UNSIGNED_LONGS_EQUAL(CUSB_BOT_HALT_IN, cusb_bot_halt(&m_bot));
+    CHECK_TRUE( (cusb_bot_clear_halt(&m_bot)) );
+    check_csw(3, BLOCK_SIZE, CSW_PASSED);
+
+    /* Hi > Di with a short packet ends the data phase by itself. */
+    send(cbw(4, 64, true, {0x12, 0, 0, 0, 36, 0}));
+    LONGS_EQUAL(36, receive().size());
+    UNSIGNED_LONGS_EQUAL(0, cusb_bot_halt(&m_bot));
+    check_csw(4, 28, CSW_PASSED);
+}
+
+TEST(Bot, DirectionMismatchIsPhaseError)
+{
+    /* Ho <> Di. */
+    send(cbw(5, BLOCK_SIZE, false, read10(0, 1)));
+    UNSIGNED_LONGS_EQUAL(CUSB_BOT_HALT_OUT, cusb_bot_halt(&m_bot));
+    check_csw(5, BLOCK_SIZE, CSW_PHASE_ERROR);
+
+    /* Slot is free for the next command. */
+    send(cbw(6, 0, false, {0x00, 0, 0, 0, 0, 0}));
+    check_csw(6, 0, CSW_PASSED);
+}
+
+TEST(Bot, FailedWriteDropsData)
+{
+    /* Write past the end fails before the data phase. The host's data is
+     * still accepted and dropped. */
+    send(cbw(7, BLOCK_SIZE, false, write10(BLOCK_COUNT, 1)));
+    UNSIGNED_LONGS_EQUAL(BLOCK_SIZE, cusb_bot_bulk_out_space(&m_bot));
+    send(std::vector<std::uint8_t>(BLOCK_SIZE, 0xEE));
+    check_csw(7, BLOCK_SIZE, CSW_FAILED);
+    UNSIGNED_LONGS_EQUAL(0, m_fast.writes);
+}
+
+TEST(Bot, GetMaxLun)
+{
+    const std::uint8_t get_max_lun[8] = {0xA1, 0xFE, 0, 0, 0, 0, 1, 0};
+    const std::uint8_t unknown[8] = {0xA1, 0x42, 0, 0, 0, 0, 0, 0};
+    std::uint8_t resp[CUSB_BOT_CONTROL_RESPONSE_MAX];
+    std::size_t len = 0;
+
+    CHECK_TRUE( (cusb_bot_control(&m_bot, get_max_lun, resp, &len)) );
+    LONGS_EQUAL(1, len);
+    BYTES_EQUAL(1, resp[0]);
+    CHECK_FALSE( (cusb_bot_control(&m_bot, unknown, resp, &len)) );
+}
+
+TEST(Bot, InvalidCbwNeedsResetRecovery)
+{
+    std::vector<std::uint8_t> bad = cbw(8, 0, false, {0x00, 0, 0, 0, 0, 0});
+    bad[3] = 'X';
+    send(bad);
+
+    UNSIGNED_LONGS_EQUAL(CUSB_BOT_HALT_IN | CUSB_BOT_HALT_OUT, cusb_bot_halt(&m_bot));
+    CHECK_FALSE( (cusb_bot_clear_halt(&m_bot)) );
+    UNSIGNED_LONGS_EQUAL(0, cusb_bot_bulk_out_space(&m_bot));
+    CHECK_TRUE( (receive().empty()) );
+
+    const std::uint8_t reset[8] = {0x21, 0xFF, 0, 0, 0, 0, 0, 0};
+    std::uint8_t resp[CUSB_BOT_CONTROL_RESPONSE_MAX];
+    std::size_t len = 1;
+    CHECK_TRUE( (cusb_bot_control(&m_bot, reset, resp, &len)) );
+    LONGS_EQUAL(0, len);
+    CHECK_TRUE( (cusb_bot_clear_halt(&m_bot)) );
+    UNSIGNED_LONGS_EQUAL(PACKET_SIZE, cusb_bot_bulk_out_space(&m_bot));
+}
+
+TEST(Bot, SlowLunDoesNotBlockTransport)
+{
+    send(cbw(9, BLOCK_SIZE, true, read10(2, 1), 1));
+
+    /* Backend busy: both endpoints NAK, nothing spins. */
+    CHECK_TRUE( (receive().empty()) );
+    UNSIGNED_LONGS_EQUAL(0, cusb_bot_bulk_out_space(&m_bot));
+    int before = m_notifications;
+
+    m_slow.complete();
+    CHECK_TRUE( (m_notifications > before) );
+    std::vector<std::uint8_t> data = receive();
+    BYTES_EQUAL(stubs::blockdev::pattern(2, 0), data[0]);
+    check_csw(9, 0, CSW_PASSED);
+
+    /* Fast LUN answers at once. */
+    send(cbw(10, BLOCK_SIZE, true, read10(2, 1), 0));
+    data = receive();
+    BYTES_EQUAL(stubs::blockdev::pattern(2, 0), data[0]);
+    check_csw(10, 0, CSW_PASSED);
+}
+
+TEST(Bot, ResetWhileBackendBusy)
+{
+    send(cbw(11, BLOCK_SIZE, true, read10(0, 1), 1));
+    cusb_bot_reset(&m_bot);
+
+    /* Buffer still belongs to the backend. */
+    UNSIGNED_LONGS_EQUAL(0, cusb_bot_bulk_out_space(&m_bot));
+    int before = m_notifications;
+
+    m_slow.complete();
+    CHECK_TRUE( (m_notifications > before) );
+    UNSIGNED_LONGS_EQUAL(PACKET_SIZE, cusb_bot_bulk_out_space(&m_bot));
+    CHECK_TRUE( (receive().empty()) );
+}
@@ -0,0 +1,196 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref coalesce.h
+ *
+ * Test Summary:
+ *
+ * cusb_coalesce_post()
+ *      - TEST(Coalesce, FullBatchCallsBackOnce)
+ *      - TEST(Coalesce, BatchOfOneCallsBackPerCompletion)
+ *
+ * cusb_coalesce_flush()
+ *      - TEST(Coalesce, FlushDeliversPartialBatch)
+ *      - TEST(Coalesce, FlushWithNothingPostedDoesNotCallBack)
+ *
+ * Restarting transfers from the callback
+ *      - TEST(Coalesce, CompletionsDuringCallbackAreDeliveredAfterIt)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/coalesce.h"
+
+/* STDLib. */
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::size_t BATCH = 4;
+
+/**
+ * @brief Records every callback.
+ */
+struct recorder
+{
+    static void on_batch(void *obj, const struct cusb_completion *results, std::size_t count)
+    {
+        auto *me = static_cast<recorder *>(obj);
+        std::size_t index = me->batches.size();
+        me->batches.emplace_back();
+        me->depth++;
+        me->max_depth = (me->depth > me->max_depth) ? me->depth : me->max_depth;
+
+        if (me->restart != nullptr)
+        {
+            /* Transfers restarted here complete before the callback returns,
+            and before it has looked at its results. */
+            struct cusb_coalesce *restart = me->restart;
+            me->restart = nullptr;
+
+            for (std::size_t i = 0; i < me->restart_count; i++)
+            {
+                cusb_coalesce_post(restart, 0x81U, nullptr, static_cast<std::uint16_t>(100U + i), true);
+            }
+        }
+
+        me->batches[index].assign(results, results + count);
+        me->depth--;
+    }
+
+    std::vector<std::vector<struct cusb_completion>> batches;
+    struct cusb_coalesce *restart = nullptr;
+    std::size_t restart_count = 0;
+    int depth = 0;
+    int max_depth = 0;
+};
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Coalesce)
+{
+    void setup() override
+    {
+        cusb_coalesce_ctor(&m_coalesce, m_results, 2U * BATCH, &recorder::on_batch, &m_recorder);
+    }
+
+    void post(std::uint16_t len, bool ok = true)
+    {
+        cusb_coalesce_post(&m_coalesce, 0x81U, m_buf, len, ok);
+    }
+
+    struct cusb_coalesce m_coalesce;
+    struct cusb_completion m_results[2U * BATCH];
+    std::uint8_t m_buf[64];
+    recorder m_recorder;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Coalesce, FullBatchCallsBackOnce)
+{
+    for (std::uint16_t i = 0; i < BATCH - 1U; i++)
+    {
+        post(i);
+    }
+
+    LONGS_EQUAL(0, m_recorder.batches.size());
+    UNSIGNED_LONGS_EQUAL(BATCH - 1U, cusb_coalesce_pending(&m_coalesce));
+
+    post(BATCH - 1U, false);
+    LONGS_EQUAL(1, m_recorder.batches.size());
+    LONGS_EQUAL(BATCH, m_recorder.batches[0].size());
+
+    for (std::size_t i = 0; i < BATCH; i++)
+    {
+        UNSIGNED_LONGS_EQUAL(i, m_recorder.batches[0][i].len);
+        POINTERS_EQUAL(m_buf, m_recorder.batches[0][i].buf);
+        BYTES_EQUAL(0x81U, m_recorder.batches[0][i].ep);
+    }
+
+    CHECK_FALSE( (m_recorder.batches[0][BATCH - 1U].ok) );
+    UNSIGNED_LONGS_EQUAL(0, cusb_coalesce_pending(&m_coalesce));
+    UNSIGNED_LONGS_EQUAL(BATCH, cusb_coalesce_get_stats(&m_coalesce)->completions);
+    UNSIGNED_LONGS_EQUAL(1, cusb_coalesce_get_stats(&m_coalesce)->callbacks);
+}
+
+TEST(Coalesce, BatchOfOneCallsBackPerCompletion)
+{
+    cusb_coalesce_ctor(&m_coalesce, m_results, 2, &recorder::on_batch, &m_recorder);
+
+    post(10);
+    post(20);
+    post(30);
+
+    LONGS_EQUAL(3, m_recorder.batches.size());
+    UNSIGNED_LONGS_EQUAL(20, m_recorder.batches[1][0].len);
+    UNSIGNED_LONGS_EQUAL(0, cusb_coalesce_pending(&m_coalesce));
+}
+
+TEST(Coalesce, FlushDeliversPartialBatch)
+{
+    post(1);
+    post(2);
+    cusb_coalesce_flush(&m_coalesce);
+
+    LONGS_EQUAL(1, m_recorder.batches.size());
+    LONGS_EQUAL(2, m_recorder.batches[0].size());
+
+    /* Next batch starts empty. */
+    post(3);
+    cusb_coalesce_flush(&m_coalesce);
+    LONGS_EQUAL(2, m_recorder.batches.size());
+    LONGS_EQUAL(1, m_recorder.batches[1].size());
+    UNSIGNED_LONGS_EQUAL(3, m_recorder.batches[1][0].len);
+}
+
+TEST(Coalesce, FlushWithNothingPostedDoesNotCallBack)
+{
+    cusb_coalesce_flush(&m_coalesce);
+    LONGS_EQUAL(0, m_recorder.batches.size());
+    UNSIGNED_LONGS_EQUAL(0, cusb_coalesce_get_stats(&m_coalesce)->callbacks);
+}
+
+TEST(Coalesce, CompletionsDuringCallbackAreDeliveredAfterIt)
+{
+    m_recorder.restart = &m_coalesce;
+    m_recorder.restart_count = BATCH;
+
+    for (std::uint16_t i = 0; i < BATCH; i++)
+    {
+        post(i);
+    }
+
+    /* Restarted transfers neither overwrote the batch being delivered nor
+    nested a callback. */
+    LONGS_EQUAL(2, m_recorder.batches.size());
+    LONGS_EQUAL(1, m_recorder.max_depth);
+
+    for (std::size_t i = 0; i < BATCH; i++)
+    {
+        UNSIGNED_LONGS_EQUAL(i, m_recorder.batches[0][i].len);
+        UNSIGNED_LONGS_EQUAL(100U + i, m_recorder.batches[1][i].len);
+    }
+}
@@ -0,0 +1,176 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref crc32.h
+ * 
+ * Test Summary:
+ * 
+ * cusb_crc32_update(), cusb_crc32_value(), cusb_crc32_verify()
+ *      - TEST(Crc32, CheckValue)
+ *      - TEST(Crc32, EmptyInput)
+ *      - TEST(Crc32, IncrementalMatchesOneShot)
+ *      - TEST(Crc32, Verify)
+ *      - TEST(Crc32, NullDataAsserts)
+ * 
+ * cusb_crc32_slice8(), cusb_crc32_pclmul()
+ *      - TEST(Crc32, Slice8MatchesBitwiseAllLengthsAndAlignments)
+ *      - TEST(Crc32, PclmulMatchesSlice8)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/crc32.h"
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Bit-at-a-time reference implementation. Returns final CRC.
+ */
+static std::uint32_t reference_crc32(const std::uint8_t *data, std::size_t len)
+{
+    std::uint32_t crc = 0xFFFFFFFFU;
+
+    for (std::size_t i = 0; i < len; i++)
+    {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++)
+        {
+            crc = (crc & 1U) ? ((crc >> 1) ^ 0xEDB88320U) : (crc >> 1);
+        }
+    }
+
+    return ~crc;
+}
+
+/**
+ * @brief Deterministic pseudo-random test pattern.
+ */
+static std::vector<std::uint8_t> make_pattern(std::size_t len)
+{
+    std::vector<std::uint8_t> v(len);
+    std::uint32_t x = 0x12345678U;
+
+    for (auto &b : v)
+    {
+        x = x * 1103515245U + 12345U;
+        b = static_cast<std::uint8_t>(x >> 16);
+    }
+
+    return v;
+}
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Crc32)
+{
+    void setup() override
+    {
+        cusb_crc32_ctor(&m_crc);
+    }
+
+    struct cusb_crc32 m_crc;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+/**
+ * @brief Standard CRC-32 check value for "123456789".
+ */
+TEST(Crc32, CheckValue)
+{
+    static const char check[] = "123456789";
+    cusb_crc32_update(&m_crc, check, sizeof(check) - 1);
+    UNSIGNED_LONGS_EQUAL(0xCBF43926UL, cusb_crc32_value(&m_crc));
+}
+
+TEST(Crc32, EmptyInput)
+{
+    cusb_crc32_update(&m_crc, nullptr, 0);
+    UNSIGNED_LONGS_EQUAL(0UL, cusb_crc32_value(&m_crc));
+}
+
+/**
+ * @brief Feeding an image in odd sized blocks, as DFU and
+ * storage writes do, gives the same result as one pass.
+ */
+TEST(Crc32, IncrementalMatchesOneShot)
+{
+    const std::vector<std::uint8_t> image = make_pattern(4099);
+    static const std::size_t block_sizes[] = {1, 7, 64, 63, 512, 1000, 3};
+    std::size_t offset = 0;
+    std::size_t i = 0;
+
+    while (offset < image.size())
+    {
+        std::size_t n = std::min(block_sizes[i++ % 7], image.size() - offset);
+        cusb_crc32_update(&m_crc, &image[offset], n);
+        offset += n;
+    }
+
+    UNSIGNED_LONGS_EQUAL(reference_crc32(image.data(), image.size()), cusb_crc32_value(&m_crc));
+}
+
+TEST(Crc32, Verify)
+{
+    static const char check[] = "123456789";
+    cusb_crc32_update(&m_crc, check, sizeof(check) - 1);
+    CHECK_TRUE( (cusb_crc32_verify(&m_crc, 0xCBF43926UL)) );
+    CHECK_FALSE( (cusb_crc32_verify(&m_crc, 0xCBF43927UL)) );
+}
+
+TEST(Crc32, NullDataAsserts)
+{
+    CHECK_THROWS(stubs::assert_exception, cusb_crc32_update(&m_crc, nullptr, 1));
+}
+
+TEST(Crc32, Slice8MatchesBitwiseAllLengthsAndAlignments)
+{
+    const std::vector<std::uint8_t> buf = make_pattern(300);
+
+    for (std::size_t align = 0; align < 8; align++)
+    {
+        for (std::size_t len = 0; len < 200; len++)
+        {
+            std::uint32_t crc = ~cusb_crc32_slice8(0xFFFFFFFFU, &buf[align], len);
+            UNSIGNED_LONGS_EQUAL(reference_crc32(&buf[align], len), crc);
+        }
+    }
+}
+
+TEST(Crc32, PclmulMatchesSlice8)
+{
+#if (CUSB_CRC32_HAS_PCLMUL)
+    if (cusb_crc32_pclmul_supported())
+    {
+        const std::vector<std::uint8_t> buf = make_pattern(2048 + 16);
+
+        for (std::size_t align = 0; align < 16; align += 3)
+        {
+            for (std::size_t len = 0; len < 2048; len += 37)
+            {
+                UNSIGNED_LONGS_EQUAL(cusb_crc32_slice8(0x5A5A5A5AU, &buf[align], len),
+                                     cusb_crc32_pclmul(0x5A5A5A5AU, &buf[align], len));
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,1165 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref device.h, run
+ * against the simulated controller of @ref sim.h.
+ *
+ * Test Summary:
+ *
+ * Standard requests
+ *      - TEST(Device, EnumeratesInInterruptMode)
+ *      - TEST(Device, DescriptorIsTruncatedToWLength)
+ *      - TEST(Device, UnsupportedDescriptorStalls)
+ *      - TEST(Device, HostHaltsAndResumesEndpoint)
+ *
+ * Class and vendor requests
+ *      - TEST(Device, ShortReplyOnPacketBoundaryEndsWithZeroLengthPacket)
+ *      - TEST(Device, RejectedRequestStalls)
+ *      - TEST(Device, OutDataStageReachesApplication)
+ *
+ * Endpoints
+ *      - TEST(Device, MultiPacketTransferCompletesOnShortPacket)
+ *      - TEST(Device, BusResetDeconfigures)
+ *      - TEST(Device, CoalescedCompletionsAreDeliveredOncePerPass)
+ *      - TEST(Device, ClosingEndpointFlushesItsCoalescer)
+ *
+ * cusb_device_set_configs()
+ *      - TEST(Device, ServesEveryConfigurationByIndex)
+ *      - TEST(Device, SwitchingConfigurationRebindsEndpoints)
+ *      - TEST(Device, UnknownConfigurationStalls)
+ *      - TEST(Device, PowerFollowsSelectedConfiguration)
+ *      - TEST(Device, BindingNotInDescriptorAsserts)
+ *
+ * DMA and cusb_device_set_cache()
+ *      - TEST(Device, DmaOutCompletesOnceInMemory)
+ *      - TEST(Device, DmaInNaksUntilFetched)
+ *      - TEST(Device, MisalignedDmaBufferAsserts)
+ *      - TEST(Device, SimulatedEngineFaultsOnMisalignedBuffer)
+ *      - TEST(Device, InBufferChangedWhileOwnedAsserts)
+ *      - TEST(Device, CacheIsCleanedForInAndInvalidatedAroundOut)
+ *      - TEST(Device, PartialCacheLineOutBufferAsserts)
+ *      - TEST(Device, ClosedEndpointGetsNoDmaWrites)
+ *
+ * cusb_poll()
+ *      - TEST(Device, PolledModeNeverInterrupts)
+ *      - TEST(Device, PollServicesAtMostBudgetEvents)
+ *      - TEST(Device, EnumeratesInPolledMode)
+ *      - TEST(Device, CompletedEndpointNaksUntilPolled)
+ *      - TEST(Device, PollInInterruptModeAsserts)
+ *
+ * Timers and cusb_device_next_deadline()
+ *      - TEST(Device, IdleDeviceHasNoDeadline)
+ *      - TEST(Device, TimersFireInExpiryOrder)
+ *      - TEST(Device, OverdueTimerMeansNoSleep)
+ *      - TEST(Device, CallbackCanRestartItsTimer)
+ *      - TEST(Device, RestartedTimerQueuesBehindOverdueOnes)
+ *      - TEST(Device, StoppedTimerNeverFires)
+ *      - TEST(Device, TimersSurviveClockWrapAround)
+ *      - TEST(Device, BusyInterruptEndpointBoundsPolledDeadline)
+ *      - TEST(Device, ExhaustedPollMeansNoSleep)
+ *      - TEST(Device, SuspendedBusOnlyWaitsForTimers)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/device.h"
+#include "cusb/sim.h"
+
+/* STDLib. */
+#include <array>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint8_t EP_OUT = 0x01U;
+constexpr std::uint8_t EP_IN = 0x81U;
+constexpr std::uint8_t EP_INT = 0x82U;
+constexpr std::uint16_t MPS = 512U;
+constexpr std::uint16_t INT_MPS = 64U;
+constexpr std::uint8_t VENDOR_IN = 0xC0U;
+constexpr std::uint8_t VENDOR_OUT = 0x40U;
+
+const std::uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0xFF, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 1, 2, 0, 1
+};
+
+const std::uint8_t CONFIG_DESC[39] =
+{
+    /* Configuration, self powered. */
+    9, 2, 39, 0, 1, 1, 0, 0xC0, 50,
+    /* Vendor interface. */
+    9, 4, 0, 0, 3, 0xFF, 0x00, 0x00, 0,
+    /* Bulk OUT and IN. */
+    7, 5, EP_OUT, 2, 0x00, 0x02, 0,
+    7, 5, EP_IN, 2, 0x00, 0x02, 0,
+    /* Interrupt IN every 8 microframes (1 ms) at high speed. */
+    7, 5, EP_INT, 3, INT_MPS, 0x00, 4
+};
+
+const std::uint8_t QUALIFIER_DESC[10] = {10, 6, 0x00, 0x02, 0xFF, 0x00, 0x00, CUSB_CFG_EP0_SIZE, 1, 0};
+
+const std::uint8_t LANGID_DESC[4] = {4, 3, 0x09, 0x04};
+
+const std::uint8_t STRING_DESC[6] = {6, 3, 'A', 0, 'b', 0};
+
+const std::uint8_t *const STRINGS[2] = {LANGID_DESC, STRING_DESC};
+
+const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, QUALIFIER_DESC, STRINGS, 2};
+
+const std::uint8_t LOW_POWER_DESC[32] =
+{
+    /* Configuration 1, bus powered, 100 mA. */
+    9, 2, 32, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 2, 0xFF, 0x00, 0x00, 0,
+    7, 5, EP_OUT, 2, 0x00, 0x02, 0,
+    7, 5, EP_IN, 2, 0x00, 0x02, 0
+};
+
+const std::uint8_t HIGH_POWER_DESC[32] =
+{
+    /* Configuration 2, self powered, 500 mA. */
+    9, 2, 32, 0, 1, 2, 0, 0xC0, 250,
+    9, 4, 0, 0, 2, 0xFF, 0x01, 0x00, 0,
+    7, 5, EP_OUT, 2, 0x00, 0x02, 0,
+    7, 5, EP_INT, 3, INT_MPS, 0x00, 4
+};
+
+std::array<std::uint8_t, 8> setup_packet(std::uint8_t type, std::uint8_t request, std::uint16_t value,
+                                         std::uint16_t index, std::uint16_t length)
+{
+    return {type, request,
+            static_cast<std::uint8_t>(value), static_cast<std::uint8_t>(value >> 8),
+            static_cast<std::uint8_t>(index), static_cast<std::uint8_t>(index >> 8),
+            static_cast<std::uint8_t>(length), static_cast<std::uint8_t>(length >> 8)};
+}
+
+/**
+ * @brief Application on top of the device. Answers vendor request 1
+ * with @ref reply, accepts OUT data for vendor request 2 and records
+ * everything else.
+ */
+struct app
+{
+    static bool configure(void *obj, std::uint8_t config)
+    {
+        auto *me = static_cast<app *>(obj);
+        me->configs.push_back(config);
+
+        if (config != 0U && me->coalesce != nullptr)
+        {
+            cusb_device_ep_open_coalesced(me->dev, EP_OUT, CUSB_EP_BULK, MPS, me->coalesce);
+            cusb_device_ep_open_coalesced(me->dev, EP_IN, CUSB_EP_BULK, MPS, me->coalesce);
+        }
+        else if (config != 0U)
+        {
+            cusb_device_ep_open(me->dev, EP_OUT, CUSB_EP_BULK, MPS, &app::done, me);
+            cusb_device_ep_open(me->dev, EP_IN, CUSB_EP_BULK, MPS, &app::done, me);
+        }
+
+        if (config != 0U)
+        {
+            cusb_device_ep_open(me->dev, EP_INT, CUSB_EP_INTERRUPT, INT_MPS, &app::done, me);
+        }
+
+        return true;
+    }
+
+    static bool control(void *obj, const std::uint8_t *setup, std::uint8_t **data, std::uint16_t *len)
+    {
+        auto *me = static_cast<app *>(obj);
+
+        if (setup[0] == VENDOR_IN && setup[1] == 1U)
+        {
+            *data = me->reply.data();
+            *len = static_cast<std::uint16_t>(me->reply.size());
+            return true;
+        }
+
+        if (setup[0] == VENDOR_OUT && setup[1] == 2U)
+        {
+            *data = me->out.data();
+            *len = static_cast<std::uint16_t>(me->out.size());
+            return true;
+        }
+
+        return false;
+    }
+
+    static bool control_out(void *obj, const std::uint8_t *setup, const std::uint8_t *data, std::uint16_t len)
+    {
+        auto *me = static_cast<app *>(obj);
+        (void)setup;
+        me->received.assign(data, data + len);
+        return true;
+    }
+
+    static void event(void *obj, std::uint8_t ev)
+    {
+        static_cast<app *>(obj)->events.push_back(ev);
+    }
+
+    static void done(void *obj, std::uint8_t ep, std::uint8_t *buf, std::uint32_t len, bool ok)
+    {
+        auto *me = static_cast<app *>(obj);
+        (void)buf;
+        me->completions.push_back({ep, len, ok});
+
+        if (me->rearm)
+        {
+            (void)cusb_device_ep_xfer(me->dev, ep, me->bulk.data(), MPS);
+        }
+    }
+
+    static void on_batch(void *obj, const struct cusb_completion *results, std::size_t count)
+    {
+        static_cast<app *>(obj)->batches.push_back(count);
+        (void)results;
+    }
+
+    struct completion
+    {
+        std::uint8_t ep;
+        std::uint32_t len;
+        bool ok;
+    };
+
+    struct cusb_device *dev = nullptr;
+    struct cusb_coalesce *coalesce = nullptr;
+    bool rearm = false;
+    std::vector<std::uint8_t> reply;
+    std::array<std::uint8_t, 128> out{};
+    std::array<std::uint8_t, 2048> bulk{};
+    std::vector<std::uint8_t> received;
+    std::vector<std::uint8_t> configs;
+    std::vector<std::uint8_t> events;
+    std::vector<completion> completions;
+    std::vector<std::size_t> batches;
+};
+
+const struct cusb_device_callbacks CALLBACKS = {&app::configure, &app::control, &app::control_out, &app::event, nullptr};
+
+/**
+ * @brief Application whose endpoints are all bound by its
+ * configurations, so it only records the selected one.
+ */
+bool record_config(void *obj, std::uint8_t config)
+{
+    static_cast<app *>(obj)->configs.push_back(config);
+    return true;
+}
+
+const struct cusb_device_callbacks BOUND_CALLBACKS = {&record_config, nullptr, nullptr, nullptr, nullptr};
+
+#if (CUSB_CFG_DMA)
+/**
+ * @brief Data cache whose maintenance calls are recorded.
+ */
+struct cache_log
+{
+    struct op
+    {
+        bool clean;
+        const void *addr;
+        std::size_t len;
+    };
+
+    static void clean(void *obj, const void *addr, std::size_t len)
+    {
+        static_cast<cache_log *>(obj)->ops.push_back({true, addr, len});
+    }
+
+    static void invalidate(void *obj, void *addr, std::size_t len)
+    {
+        static_cast<cache_log *>(obj)->ops.push_back({false, addr, len});
+    }
+
+    std::vector<op> ops;
+};
+
+const struct cusb_device_cache CACHE = {&cache_log::clean, &cache_log::invalidate, 32};
+#endif
+
+void isr(void *obj)
+{
+    cusb_isr(static_cast<struct cusb_device *>(obj));
+}
+
+void poll_one(void *obj)
+{
+    (void)cusb_poll(static_cast<struct cusb_device *>(obj), 1);
+}
+
+/**
+ * @brief Timer that logs its @ref id when it fires and restarts itself
+ * @ref restarts times.
+ */
+struct tick
+{
+    static void fire(void *obj)
+    {
+        auto *me = static_cast<tick *>(obj);
+        me->log->push_back(me->id);
+
+        if (me->restarts > 0U)
+        {
+            me->restarts--;
+            cusb_device_timer_start(me->dev, &me->timer, me->now, 100U);
+        }
+    }
+
+    struct cusb_timer timer;
+    struct cusb_device *dev;
+    std::vector<int> *log;
+    int id;
+    unsigned restarts;
+    std::uint32_t now;
+};
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Device)
+{
+    void setup() override
+    {
+        cusb_sim_ctor(&m_sim, CUSB_SPEED_HIGH, &isr, &m_dev);
+        cusb_device_ctor(&m_dev, &m_sim.dcd, &DESCRIPTORS, &CALLBACKS, &m_app);
+        m_app.dev = &m_dev;
+    }
+
+    int control(std::uint8_t type, std::uint8_t request, std::uint16_t value, std::uint16_t index,
+                std::uint16_t length, std::uint8_t *data = nullptr, std::uint16_t *len = nullptr)
+    {
+        auto packet = setup_packet(type, request, value, index, length);
+        return cusb_sim_host_control(&m_sim, packet.data(), data, len);
+    }
+
+    void enumerate()
+    {
+        cusb_sim_host_reset(&m_sim);
+        LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 5, 7, 0, 0));
+        LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 1, 0, 0));
+    }
+
+    tick &make_tick(int id, unsigned restarts = 0U)
+    {
+        tick &t = m_ticks[static_cast<std::size_t>(id)];
+        t.dev = &m_dev;
+        t.log = &m_fired;
+        t.id = id;
+        t.restarts = restarts;
+        t.now = 0;
+        cusb_timer_ctor(&t.timer, &tick::fire, &t);
+        return t;
+    }
+
+    struct cusb_sim m_sim;
+    struct cusb_device m_dev;
+    app m_app;
+#if (CUSB_CFG_DMA)
+    /**
+     * @brief Rebuilds the device on a simulator with a DMA engine and
+     * configures it.
+     */
+    void use_dma(std::uint16_t align, std::uint16_t granule)
+    {
+        const struct cusb_dcd_dma dma = {align, granule, 65536};
+
+        cusb_sim_ctor(&m_sim, CUSB_SPEED_HIGH, &isr, &m_dev);
+        cusb_sim_set_dma(&m_sim, &dma);
+        cusb_device_ctor(&m_dev, &m_sim.dcd, &DESCRIPTORS, &CALLBACKS, &m_app);
+        cusb_device_start(&m_dev, false);
+        enumerate();
+    }
+
+    alignas(32) std::array<std::uint8_t, 1024> m_buf{};
+#endif
+
+    std::array<tick, 4> m_ticks{};
+    std::vector<int> m_fired;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Device, EnumeratesInInterruptMode)
+{
+    std::uint8_t buf[64];
+    std::uint16_t len = 0;
+
+    cusb_device_start(&m_dev, false);
+    CHECK_TRUE( (cusb_sim_is_connected(&m_sim)) );
+    cusb_sim_host_reset(&m_sim);
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_DEFAULT, cusb_device_get_state(&m_dev));
+    LONGS_EQUAL(1, m_app.events.size());
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_EVENT_RESET, m_app.events[0]);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0100, 0, 64, buf, &len));
+    UNSIGNED_LONGS_EQUAL(18, len);
+    MEMCMP_EQUAL(DEVICE_DESC, buf, 18);
+
+    /* Address only takes effect once the status stage completed. */
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 5, 7, 0, 0));
+    UNSIGNED_LONGS_EQUAL(7, cusb_sim_get_address(&m_sim));
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_ADDRESS, cusb_device_get_state(&m_dev));
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0200, 0, 255, buf, &len));
+    UNSIGNED_LONGS_EQUAL(sizeof(CONFIG_DESC), len);
+    MEMCMP_EQUAL(CONFIG_DESC, buf, sizeof(CONFIG_DESC));
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0301, 0x0409, 255, buf, &len));
+    UNSIGNED_LONGS_EQUAL(sizeof(STRING_DESC), len);
+    MEMCMP_EQUAL(STRING_DESC, buf, sizeof(STRING_DESC));
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 1, 0, 0));
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_CONFIGURED, cusb_device_get_state(&m_dev));
+    LONGS_EQUAL(1, m_app.configs.size());
+    UNSIGNED_LONGS_EQUAL(1, m_app.configs[0]);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 8, 0, 0, 1, buf, &len));
+    UNSIGNED_LONGS_EQUAL(1, buf[0]);
+
+    /* Self powered, no remote wakeup. */
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 0, 0, 0, 2, buf, &len));
+    UNSIGNED_LONGS_EQUAL(1, buf[0]);
+    CHECK_TRUE( (cusb_device_get_stats(&m_dev)->interrupts > 0U) );
+}
+
+TEST(Device, DescriptorIsTruncatedToWLength)
+{
+    std::uint8_t buf[64];
+    std::uint16_t len = 0;
+
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0200, 0, 9, buf, &len));
+    UNSIGNED_LONGS_EQUAL(9, len);
+    UNSIGNED_LONGS_EQUAL(sizeof(CONFIG_DESC), buf[2]);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0600, 0, 10, buf, &len));
+    MEMCMP_EQUAL(QUALIFIER_DESC, buf, sizeof(QUALIFIER_DESC));
+}
+
+TEST(Device, UnsupportedDescriptorStalls)
+{
+    std::uint8_t buf[64];
+
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+
+    LONGS_EQUAL(CUSB_SIM_STALL, control(0x80, 6, 0x0305, 0, 64, buf));
+    LONGS_EQUAL(CUSB_SIM_STALL, control(0x80, 6, 0x0201, 0, 64, buf));
+
+    /* BOS goes to the application, which rejects it. */
+    LONGS_EQUAL(CUSB_SIM_STALL, control(0x80, 6, 0x0F00, 0, 64, buf));
+    UNSIGNED_LONGS_EQUAL(3, cusb_device_get_stats(&m_dev)->stalls);
+
+    /* Next SETUP clears the stall. */
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0100, 0, 18, buf));
+}
+
+TEST(Device, HostHaltsAndResumesEndpoint)
+{
+    std::uint8_t buf[2];
+
+    cusb_device_start(&m_dev, false);
+    enumerate();
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x02, 3, 0, EP_IN, 0));
+    CHECK_TRUE( (cusb_sim_is_stalled(&m_sim, EP_IN)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x82, 0, 0, EP_IN, 2, buf));
+    UNSIGNED_LONGS_EQUAL(1, buf[0]);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x02, 1, 0, EP_IN, 0));
+    CHECK_FALSE( (cusb_sim_is_stalled(&m_sim, EP_IN)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x82, 0, 0, EP_IN, 2, buf));
+    UNSIGNED_LONGS_EQUAL(0, buf[0]);
+
+    /* Endpoint of no open pipe. */
+    LONGS_EQUAL(CUSB_SIM_STALL, control(0x02, 3, 0, 0x83, 0));
+}
+
+TEST(Device, ShortReplyOnPacketBoundaryEndsWithZeroLengthPacket)
+{
+    std::uint8_t buf[2 * CUSB_CFG_EP0_SIZE];
+    std::uint16_t len = 0;
+
+    m_app.reply.assign(CUSB_CFG_EP0_SIZE, 0x5A);
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+
+    /* Without the zero length packet the host would wait for more data
+    and time out. */
+    LONGS_EQUAL(CUSB_SIM_ACK, control(VENDOR_IN, 1, 0, 0, sizeof(buf), buf, &len));
+    UNSIGNED_LONGS_EQUAL(CUSB_CFG_EP0_SIZE, len);
+    BYTES_EQUAL(0x5A, buf[CUSB_CFG_EP0_SIZE - 1]);
+
+    /* Exactly wLength needs none. */
+    LONGS_EQUAL(CUSB_SIM_ACK, control(VENDOR_IN, 1, 0, 0, CUSB_CFG_EP0_SIZE, buf, &len));
+    UNSIGNED_LONGS_EQUAL(CUSB_CFG_EP0_SIZE, len);
+}
+
+TEST(Device, RejectedRequestStalls)
+{
+    std::uint8_t buf[8];
+
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+
+    LONGS_EQUAL(CUSB_SIM_STALL, control(VENDOR_IN, 9, 0, 0, sizeof(buf), buf));
+    LONGS_EQUAL(CUSB_SIM_STALL, control(VENDOR_OUT, 9, 0, 0, 0));
+    UNSIGNED_LONGS_EQUAL(2, cusb_device_get_stats(&m_dev)->stalls);
+}
+
+TEST(Device, OutDataStageReachesApplication)
+{
+    std::uint8_t data[100];
+
+    for (std::size_t i = 0; i < sizeof(data); i++)
+    {
+        data[i] = static_cast<std::uint8_t>(i);
+    }
+
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(VENDOR_OUT, 2, 0, 0, sizeof(data), data));
+    LONGS_EQUAL(sizeof(data), m_app.received.size());
+    MEMCMP_EQUAL(data, m_app.received.data(), sizeof(data));
+
+    /* More than the application has room for. */
+    std::uint8_t big[200] = {};
+    LONGS_EQUAL(CUSB_SIM_STALL, control(VENDOR_OUT, 2, 0, 0, sizeof(big), big));
+}
+
+TEST(Device, MultiPacketTransferCompletesOnShortPacket)
+{
+    std::uint8_t packet[MPS] = {};
+
+    cusb_device_start(&m_dev, false);
+    enumerate();
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data(), 2048)) );
+    CHECK_FALSE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data(), 2048)) );
+
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, MPS));
+    LONGS_EQUAL(0, m_app.completions.size());
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, 100));
+
+    LONGS_EQUAL(1, m_app.completions.size());
+    BYTES_EQUAL(EP_OUT, m_app.completions[0].ep);
+    UNSIGNED_LONGS_EQUAL(MPS + 100U, m_app.completions[0].len);
+    CHECK_TRUE( (m_app.completions[0].ok) );
+    CHECK_FALSE( (cusb_device_ep_busy(&m_dev, EP_OUT)) );
+
+    /* Not armed again. */
+    LONGS_EQUAL(CUSB_SIM_NAK, cusb_sim_host_out(&m_sim, EP_OUT, packet, MPS));
+}
+
+TEST(Device, BusResetDeconfigures)
+{
+    std::uint8_t packet[8] = {};
+
+    cusb_device_start(&m_dev, false);
+    enumerate();
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data(), MPS)) );
+
+    cusb_sim_host_reset(&m_sim);
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_DEFAULT, cusb_device_get_state(&m_dev));
+    UNSIGNED_LONGS_EQUAL(0, cusb_device_get_config(&m_dev));
+    LONGS_EQUAL(2, m_app.configs.size());
+    UNSIGNED_LONGS_EQUAL(0, m_app.configs[1]);
+    CHECK_FALSE( (cusb_device_ep_busy(&m_dev, EP_OUT)) );
+    LONGS_EQUAL(CUSB_SIM_TIMEOUT, cusb_sim_host_out(&m_sim, EP_OUT, packet, sizeof(packet)));
+    LONGS_EQUAL(0, m_app.completions.size());
+}
+
+TEST(Device, CoalescedCompletionsAreDeliveredOncePerPass)
+{
+    struct cusb_coalesce coalesce;
+    struct cusb_completion results[8];
+    std::uint8_t packet[MPS] = {};
+    std::uint16_t len = 0;
+
+    cusb_coalesce_ctor(&coalesce, results, 8, &app::on_batch, &m_app);
+    m_app.coalesce = &coalesce;
+    cusb_sim_set_idle(&m_sim, &poll_one, &m_dev);
+    cusb_device_start(&m_dev, true);
+    enumerate();
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data(), MPS)) );
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_IN, m_app.bulk.data(), 10)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, 20));
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_in(&m_sim, EP_IN, packet, &len));
+
+    UNSIGNED_LONGS_EQUAL(2, cusb_poll(&m_dev, SIZE_MAX));
+    LONGS_EQUAL(1, m_app.batches.size());
+    UNSIGNED_LONGS_EQUAL(2, m_app.batches[0]);
+}
+
+TEST(Device, ClosingEndpointFlushesItsCoalescer)
+{
+    struct cusb_coalesce coalesce;
+    struct cusb_completion results[8];
+
+    cusb_coalesce_ctor(&coalesce, results, 8, &app::on_batch, &m_app);
+    m_app.coalesce = &coalesce;
+    cusb_sim_set_idle(&m_sim, &poll_one, &m_dev);
+    cusb_device_start(&m_dev, true);
+    enumerate();
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+
+    /* Posted, then rebound without a coalescer before the pass ends. */
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data(), MPS)) );
+    cusb_dcd_xfer_done(&m_sim.dcd, EP_OUT, 20, true);
+    cusb_device_ep_close(&m_dev, EP_OUT);
+    LONGS_EQUAL(1, m_app.batches.size());
+    UNSIGNED_LONGS_EQUAL(1, m_app.batches[0]);
+
+    cusb_device_ep_open(&m_dev, EP_OUT, CUSB_EP_BULK, MPS, &app::done, &m_app);
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+    LONGS_EQUAL(1, m_app.batches.size());
+    LONGS_EQUAL(0, m_app.completions.size());
+}
+
+TEST(Device, ServesEveryConfigurationByIndex)
+{
+    std::uint8_t data[64] = {};
+    std::uint16_t len = sizeof(data);
+    const struct cusb_device_binding low[1] = {{EP_OUT, CUSB_EP_BULK, MPS, &app::done, &m_app, nullptr}};
+    struct cusb_device_config configs[2];
+
+    cusb_device_config_ctor(&configs[0], LOW_POWER_DESC, low, 1);
+    cusb_device_config_ctor(&configs[1], HIGH_POWER_DESC, nullptr, 0);
+    cusb_device_set_configs(&m_dev, configs, 2);
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0201, 0, sizeof(data), data, &len));
+    UNSIGNED_LONGS_EQUAL(sizeof(HIGH_POWER_DESC), len);
+    MEMCMP_EQUAL(HIGH_POWER_DESC, data, len);
+
+    len = sizeof(data);
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0200, 0, sizeof(data), data, &len));
+    MEMCMP_EQUAL(LOW_POWER_DESC, data, len);
+
+    len = sizeof(data);
+    LONGS_EQUAL(CUSB_SIM_STALL, control(0x80, 6, 0x0202, 0, sizeof(data), data, &len));
+}
+
+TEST(Device, SwitchingConfigurationRebindsEndpoints)
+{
+    app bulk_class;
+    app int_class;
+    std::uint8_t packet[MPS] = {};
+    std::uint16_t len = 0;
+    const struct cusb_device_binding low[2] =
+    {
+        {EP_OUT, CUSB_EP_BULK, MPS, &app::done, &bulk_class, nullptr},
+        {EP_IN, CUSB_EP_BULK, MPS, &app::done, &bulk_class, nullptr}
+    };
+    const struct cusb_device_binding high[2] =
+    {
+        {EP_OUT, CUSB_EP_BULK, MPS, &app::done, &int_class, nullptr},
+        {EP_INT, CUSB_EP_INTERRUPT, INT_MPS, &app::done, &int_class, nullptr}
+    };
+    struct cusb_device_config configs[2];
+
+    cusb_device_config_ctor(&configs[0], LOW_POWER_DESC, low, 2);
+    cusb_device_config_ctor(&configs[1], HIGH_POWER_DESC, high, 2);
+    cusb_device_ctor(&m_dev, &m_sim.dcd, &DESCRIPTORS, &BOUND_CALLBACKS, &m_app);
+    cusb_device_set_configs(&m_dev, configs, 2);
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 5, 7, 0, 0));
+
+    /* Endpoints are open before the application hears of the switch. */
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 1, 0, 0));
+    UNSIGNED_LONGS_EQUAL(1, cusb_device_get_config(&m_dev));
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data(), MPS)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, 3));
+    LONGS_EQUAL(1, bulk_class.completions.size());
+
+    /* Same address, other class. The old IN endpoint is gone. */
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 2, 0, 0));
+    UNSIGNED_LONGS_EQUAL(2, cusb_device_get_config(&m_dev));
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data(), MPS)) );
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_INT, m_app.bulk.data(), 4)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, 5));
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_in(&m_sim, EP_INT, packet, &len));
+    LONGS_EQUAL(CUSB_SIM_TIMEOUT, cusb_sim_host_in(&m_sim, EP_IN, packet, &len));
+
+    LONGS_EQUAL(1, bulk_class.completions.size());
+    LONGS_EQUAL(2, int_class.completions.size());
+    UNSIGNED_LONGS_EQUAL(EP_INT, int_class.completions[1].ep);
+    LONGS_EQUAL(2, m_app.configs.size());
+    UNSIGNED_LONGS_EQUAL(2, m_app.configs[1]);
+
+    /* Deconfiguring closes everything bound. */
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 0, 0, 0));
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_ADDRESS, cusb_device_get_state(&m_dev));
+    LONGS_EQUAL(CUSB_SIM_TIMEOUT, cusb_sim_host_out(&m_sim, EP_OUT, packet, 5));
+}
+
+TEST(Device, UnknownConfigurationStalls)
+{
+    struct cusb_device_config configs[2];
+
+    cusb_device_config_ctor(&configs[0], LOW_POWER_DESC, nullptr, 0);
+    cusb_device_config_ctor(&configs[1], HIGH_POWER_DESC, nullptr, 0);
+    cusb_device_set_configs(&m_dev, configs, 2);
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 5, 7, 0, 0));
+
+    LONGS_EQUAL(CUSB_SIM_STALL, control(0x00, 9, 3, 0, 0));
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_ADDRESS, cusb_device_get_state(&m_dev));
+    LONGS_EQUAL(0, m_app.configs.size());
+}
+
+TEST(Device, PowerFollowsSelectedConfiguration)
+{
+    std::uint8_t data[2] = {};
+    std::uint16_t len = sizeof(data);
+    struct cusb_device_config configs[2];
+
+    cusb_device_config_ctor(&configs[0], LOW_POWER_DESC, nullptr, 0);
+    cusb_device_config_ctor(&configs[1], HIGH_POWER_DESC, nullptr, 0);
+    cusb_device_ctor(&m_dev, &m_sim.dcd, &DESCRIPTORS, &BOUND_CALLBACKS, &m_app);
+    cusb_device_set_configs(&m_dev, configs, 2);
+    cusb_device_start(&m_dev, false);
+    cusb_sim_host_reset(&m_sim);
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 5, 7, 0, 0));
+    UNSIGNED_LONGS_EQUAL(0, cusb_device_get_max_power(&m_dev));
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 1, 0, 0));
+    UNSIGNED_LONGS_EQUAL(100, cusb_device_get_max_power(&m_dev));
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 0, 0, 0, 2, data, &len));
+    UNSIGNED_LONGS_EQUAL(0, data[0]);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 2, 0, 0));
+    UNSIGNED_LONGS_EQUAL(500, cusb_device_get_max_power(&m_dev));
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 0, 0, 0, 2, data, &len));
+    UNSIGNED_LONGS_EQUAL(1, data[0]);
+}
+
+TEST(Device, BindingNotInDescriptorAsserts)
+{
+    const struct cusb_device_binding bindings[1] = {{EP_INT, CUSB_EP_INTERRUPT, INT_MPS, &app::done, &m_app, nullptr}};
+    struct cusb_device_config config;
+
+    CHECK_THROWS(stubs::assert_exception, cusb_device_config_ctor(&config, LOW_POWER_DESC, bindings, 1));
+}
+
+#if (CUSB_CFG_DMA)
+TEST(Device, DmaOutCompletesOnceInMemory)
+{
+    std::uint8_t packet[20];
+
+    use_dma(4, 4);
+    for (std::size_t i = 0; i < sizeof(packet); i++)
+    {
+        packet[i] = static_cast<std::uint8_t>(i);
+    }
+
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_buf.data(), MPS)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, 18));
+
+    /* Acknowledged on the bus, still in the FIFO. */
+    LONGS_EQUAL(0, m_app.completions.size());
+    LONGS_EQUAL(CUSB_SIM_NAK, cusb_sim_host_out(&m_sim, EP_OUT, packet, 18));
+
+    UNSIGNED_LONGS_EQUAL(1, cusb_sim_dma_run(&m_sim, SIZE_MAX));
+    LONGS_EQUAL(1, m_app.completions.size());
+    UNSIGNED_LONGS_EQUAL(18, m_app.completions[0].len);
+    MEMCMP_EQUAL(packet, m_buf.data(), 18);
+
+    /* The engine wrote a whole last word. */
+    UNSIGNED_LONGS_EQUAL(0xA5, m_buf[18]);
+    UNSIGNED_LONGS_EQUAL(0xA5, m_buf[19]);
+    UNSIGNED_LONGS_EQUAL(0, m_buf[20]);
+    UNSIGNED_LONGS_EQUAL(0, cusb_sim_dma_run(&m_sim, SIZE_MAX));
+}
+
+TEST(Device, DmaInNaksUntilFetched)
+{
+    std::uint8_t packet[MPS];
+    std::uint16_t len = 0;
+
+    use_dma(4, 4);
+    m_buf.fill(0x3C);
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_IN, m_buf.data(), 600)) );
+    LONGS_EQUAL(CUSB_SIM_NAK, cusb_sim_host_in(&m_sim, EP_IN, packet, &len));
+
+    UNSIGNED_LONGS_EQUAL(1, cusb_sim_dma_run(&m_sim, 1));
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_in(&m_sim, EP_IN, packet, &len));
+    UNSIGNED_LONGS_EQUAL(MPS, len);
+    LONGS_EQUAL(CUSB_SIM_NAK, cusb_sim_host_in(&m_sim, EP_IN, packet, &len));
+
+    UNSIGNED_LONGS_EQUAL(1, cusb_sim_dma_run(&m_sim, SIZE_MAX));
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_in(&m_sim, EP_IN, packet, &len));
+    UNSIGNED_LONGS_EQUAL(88, len);
+    UNSIGNED_LONGS_EQUAL(0x3C, packet[87]);
+    LONGS_EQUAL(1, m_app.completions.size());
+    UNSIGNED_LONGS_EQUAL(600, m_app.completions[0].len);
+}
+
+TEST(Device, MisalignedDmaBufferAsserts)
+{
+    use_dma(32, 4);
+    CHECK_THROWS(stubs::assert_exception, cusb_device_ep_xfer(&m_dev, EP_IN, &m_buf[4], 16));
+    CHECK_THROWS(stubs::assert_exception, cusb_device_ep_xfer(&m_dev, EP_OUT, m_buf.data(), 18));
+}
+
+TEST(Device, SimulatedEngineFaultsOnMisalignedBuffer)
+{
+    use_dma(4, 4);
+
+    /* A driver handing the engine what the core would have refused. */
+    CHECK_THROWS(stubs::assert_exception, (*m_sim.dcd.api->ep_xfer)(m_sim.dcd.ctx, EP_OUT, &m_buf[2], MPS));
+}
+
+TEST(Device, InBufferChangedWhileOwnedAsserts)
+{
+    std::uint8_t packet[MPS];
+    std::uint16_t len = 0;
+
+    use_dma(4, 4);
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_IN, m_buf.data(), 16)) );
+    m_buf[3] = 1;
+    (void)cusb_sim_dma_run(&m_sim, SIZE_MAX);
+    CHECK_THROWS(stubs::assert_exception, cusb_sim_host_in(&m_sim, EP_IN, packet, &len));
+}
+
+TEST(Device, CacheIsCleanedForInAndInvalidatedAroundOut)
+{
+    cache_log log;
+    std::uint8_t packet[40] = {};
+
+    use_dma(4, 4);
+    cusb_device_set_cache(&m_dev, &CACHE, &log);
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_IN, &m_buf[512], 100)) );
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_buf.data(), MPS)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, sizeof(packet)));
+    (void)cusb_sim_dma_run(&m_sim, 1);
+
+    LONGS_EQUAL(3, log.ops.size());
+    CHECK_TRUE( (log.ops[0].clean) );
+    POINTERS_EQUAL(&m_buf[512], log.ops[0].addr);
+    UNSIGNED_LONGS_EQUAL(100, log.ops[0].len);
+    CHECK_FALSE( (log.ops[1].clean) );
+    POINTERS_EQUAL(m_buf.data(), log.ops[1].addr);
+    UNSIGNED_LONGS_EQUAL(MPS, log.ops[1].len);
+
+    /* Only the lines received into. */
+    CHECK_FALSE( (log.ops[2].clean) );
+    UNSIGNED_LONGS_EQUAL(64, log.ops[2].len);
+}
+
+TEST(Device, PartialCacheLineOutBufferAsserts)
+{
+    cache_log log;
+
+    use_dma(4, 4);
+    cusb_device_set_cache(&m_dev, &CACHE, &log);
+    CHECK_THROWS(stubs::assert_exception, cusb_device_ep_xfer(&m_dev, EP_OUT, &m_buf[4], MPS));
+    CHECK_THROWS(stubs::assert_exception, cusb_device_ep_xfer(&m_dev, EP_OUT, m_buf.data(), 100));
+}
+
+TEST(Device, ClosedEndpointGetsNoDmaWrites)
+{
+    std::uint8_t packet[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    use_dma(4, 4);
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_buf.data(), MPS)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, sizeof(packet)));
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 0, 0, 0));
+
+    UNSIGNED_LONGS_EQUAL(0, cusb_sim_dma_run(&m_sim, SIZE_MAX));
+    UNSIGNED_LONGS_EQUAL(0, m_buf[0]);
+    LONGS_EQUAL(0, m_app.completions.size());
+}
+#endif
+
+TEST(Device, PolledModeNeverInterrupts)
+{
+    cusb_device_start(&m_dev, true);
+    cusb_sim_host_reset(&m_sim);
+    cusb_sim_host_sof(&m_sim);
+
+    CHECK_TRUE( (cusb_sim_pending(&m_sim)) );
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_DETACHED, cusb_device_get_state(&m_dev));
+
+    UNSIGNED_LONGS_EQUAL(2, cusb_poll(&m_dev, SIZE_MAX));
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_DEFAULT, cusb_device_get_state(&m_dev));
+    CHECK_FALSE( (cusb_sim_pending(&m_sim)) );
+    UNSIGNED_LONGS_EQUAL(0, cusb_sim_get_stats(&m_sim)->interrupts);
+    UNSIGNED_LONGS_EQUAL(0, cusb_device_get_stats(&m_dev)->interrupts);
+}
+
+TEST(Device, PollServicesAtMostBudgetEvents)
+{
+    cusb_device_start(&m_dev, true);
+    cusb_sim_host_reset(&m_sim);
+    cusb_sim_host_sof(&m_sim);
+    cusb_sim_host_suspend(&m_sim, true);
+
+    UNSIGNED_LONGS_EQUAL(1, cusb_poll(&m_dev, 1));
+    CHECK_TRUE( (cusb_sim_pending(&m_sim)) );
+    UNSIGNED_LONGS_EQUAL(2, cusb_poll(&m_dev, 8));
+    UNSIGNED_LONGS_EQUAL(0, cusb_poll(&m_dev, 8));
+
+    UNSIGNED_LONGS_EQUAL(3, cusb_device_get_stats(&m_dev)->polls);
+    UNSIGNED_LONGS_EQUAL(1, cusb_device_get_stats(&m_dev)->polls_exhausted);
+    UNSIGNED_LONGS_EQUAL(3, cusb_device_get_stats(&m_dev)->events);
+    LONGS_EQUAL(2, m_app.events.size());
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_EVENT_SUSPEND, m_app.events[1]);
+}
+
+TEST(Device, EnumeratesInPolledMode)
+{
+    std::uint8_t buf[64];
+    std::uint16_t len = 0;
+
+    cusb_sim_set_idle(&m_sim, &poll_one, &m_dev);
+    cusb_device_start(&m_dev, true);
+    cusb_sim_host_reset(&m_sim);
+    (void)cusb_poll(&m_dev, 1);
+
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x80, 6, 0x0100, 0, 64, buf, &len));
+    MEMCMP_EQUAL(DEVICE_DESC, buf, 18);
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 5, 3, 0, 0));
+    UNSIGNED_LONGS_EQUAL(3, cusb_sim_get_address(&m_sim));
+    LONGS_EQUAL(CUSB_SIM_ACK, control(0x00, 9, 1, 0, 0));
+
+    /* Status stage completion is still waiting for a poll. */
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+    UNSIGNED_LONGS_EQUAL(CUSB_DEVICE_CONFIGURED, cusb_device_get_state(&m_dev));
+    UNSIGNED_LONGS_EQUAL(0, cusb_sim_get_stats(&m_sim)->interrupts);
+}
+
+TEST(Device, CompletedEndpointNaksUntilPolled)
+{
+    std::uint8_t packet[MPS] = {};
+
+    cusb_sim_set_idle(&m_sim, &poll_one, &m_dev);
+    cusb_device_start(&m_dev, true);
+    enumerate();
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+
+    m_app.rearm = true;
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data(), MPS)) );
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, MPS));
+    LONGS_EQUAL(CUSB_SIM_NAK, cusb_sim_host_out(&m_sim, EP_OUT, packet, MPS));
+    LONGS_EQUAL(0, m_app.completions.size());
+
+    UNSIGNED_LONGS_EQUAL(1, cusb_poll(&m_dev, SIZE_MAX));
+    LONGS_EQUAL(1, m_app.completions.size());
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, EP_OUT, packet, MPS));
+}
+
+TEST(Device, PollInInterruptModeAsserts)
+{
+    cusb_device_start(&m_dev, false);
+    CHECK_THROWS(stubs::assert_exception, cusb_poll(&m_dev, 1));
+}
+
+TEST(Device, IdleDeviceHasNoDeadline)
+{
+    cusb_device_start(&m_dev, false);
+    enumerate();
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_INT, m_app.bulk.data(), INT_MPS)) );
+
+    /* The controller interrupts when the endpoint is done. */
+    UNSIGNED_LONGS_EQUAL(CUSB_DEADLINE_NONE, cusb_device_next_deadline(&m_dev, 0));
+}
+
+TEST(Device, TimersFireInExpiryOrder)
+{
+    tick &a = make_tick(0);
+    tick &b = make_tick(1);
+    tick &c = make_tick(2);
+
+    cusb_device_start(&m_dev, false);
+    cusb_device_timer_start(&m_dev, &a.timer, 1000, 300);
+    cusb_device_timer_start(&m_dev, &b.timer, 1000, 100);
+    cusb_device_timer_start(&m_dev, &c.timer, 1000, 200);
+    UNSIGNED_LONGS_EQUAL(100, cusb_device_next_deadline(&m_dev, 1000));
+    UNSIGNED_LONGS_EQUAL(40, cusb_device_next_deadline(&m_dev, 1060));
+
+    cusb_device_run_timers(&m_dev, 1099);
+    LONGS_EQUAL(0, m_fired.size());
+    cusb_device_run_timers(&m_dev, 1250);
+    LONGS_EQUAL(2, m_fired.size());
+    LONGS_EQUAL(1, m_fired[0]);
+    LONGS_EQUAL(2, m_fired[1]);
+    UNSIGNED_LONGS_EQUAL(50, cusb_device_next_deadline(&m_dev, 1250));
+
+    cusb_device_run_timers(&m_dev, 1300);
+    LONGS_EQUAL(3, m_fired.size());
+    UNSIGNED_LONGS_EQUAL(CUSB_DEADLINE_NONE, cusb_device_next_deadline(&m_dev, 1300));
+}
+
+TEST(Device, OverdueTimerMeansNoSleep)
+{
+    tick &a = make_tick(0);
+
+    cusb_device_start(&m_dev, false);
+    cusb_device_timer_start(&m_dev, &a.timer, 0, 10);
+    UNSIGNED_LONGS_EQUAL(0, cusb_device_next_deadline(&m_dev, 10));
+    UNSIGNED_LONGS_EQUAL(0, cusb_device_next_deadline(&m_dev, 5000));
+}
+
+TEST(Device, CallbackCanRestartItsTimer)
+{
+    tick &a = make_tick(0, 2U);
+
+    cusb_device_start(&m_dev, false);
+    cusb_device_timer_start(&m_dev, &a.timer, 0, 100);
+
+    a.now = 100;
+    cusb_device_run_timers(&m_dev, 100);
+    UNSIGNED_LONGS_EQUAL(100, cusb_device_next_deadline(&m_dev, 100));
+
+    /* Late by more than a period: fires once, then is due again. */
+    a.now = 450;
+    cusb_device_run_timers(&m_dev, 450);
+    LONGS_EQUAL(2, m_fired.size());
+    UNSIGNED_LONGS_EQUAL(100, cusb_device_next_deadline(&m_dev, 450));
+
+    cusb_device_run_timers(&m_dev, 550);
+    LONGS_EQUAL(3, m_fired.size());
+    UNSIGNED_LONGS_EQUAL(CUSB_DEADLINE_NONE, cusb_device_next_deadline(&m_dev, 550));
+}
+
+TEST(Device, RestartedTimerQueuesBehindOverdueOnes)
+{
+    tick &a = make_tick(0, 1U);
+    tick &b = make_tick(1);
+
+    cusb_device_start(&m_dev, false);
+    cusb_device_timer_start(&m_dev, &a.timer, 0, 100);
+    cusb_device_timer_start(&m_dev, &b.timer, 0, 100);
+
+    /* Both overdue. A restarts from its callback while B still waits. */
+    a.now = 150;
+    cusb_device_run_timers(&m_dev, 150);
+    LONGS_EQUAL(2, m_fired.size());
+    LONGS_EQUAL(0, m_fired[0]);
+    LONGS_EQUAL(1, m_fired[1]);
+    UNSIGNED_LONGS_EQUAL(100, cusb_device_next_deadline(&m_dev, 150));
+}
+
+TEST(Device, StoppedTimerNeverFires)
+{
+    tick &a = make_tick(0);
+    tick &b = make_tick(1);
+
+    cusb_device_start(&m_dev, false);
+    cusb_device_timer_start(&m_dev, &a.timer, 0, 100);
+    cusb_device_timer_start(&m_dev, &b.timer, 0, 200);
+    cusb_device_timer_stop(&m_dev, &a.timer);
+    cusb_device_timer_stop(&m_dev, &a.timer);
+    UNSIGNED_LONGS_EQUAL(200, cusb_device_next_deadline(&m_dev, 0));
+
+    /* Restarting an armed timer moves it. */
+    cusb_device_timer_start(&m_dev, &b.timer, 0, 300);
+    cusb_device_run_timers(&m_dev, 250);
+    LONGS_EQUAL(0, m_fired.size());
+    cusb_device_run_timers(&m_dev, 300);
+    LONGS_EQUAL(1, m_fired.size());
+    LONGS_EQUAL(1, m_fired[0]);
+}
+
+TEST(Device, TimersSurviveClockWrapAround)
+{
+    tick &a = make_tick(0);
+    tick &b = make_tick(1);
+    const std::uint32_t now = UINT32_MAX - 50U;
+
+    cusb_device_start(&m_dev, false);
+    cusb_device_timer_start(&m_dev, &a.timer, now, 200);
+    cusb_device_timer_start(&m_dev, &b.timer, now, 20);
+    UNSIGNED_LONGS_EQUAL(20, cusb_device_next_deadline(&m_dev, now));
+
+    cusb_device_run_timers(&m_dev, now + 100U);
+    LONGS_EQUAL(1, m_fired.size());
+    LONGS_EQUAL(1, m_fired[0]);
+    UNSIGNED_LONGS_EQUAL(100, cusb_device_next_deadline(&m_dev, now + 100U));
+    cusb_device_run_timers(&m_dev, now + 200U);
+    LONGS_EQUAL(2, m_fired.size());
+}
+
+TEST(Device, BusyInterruptEndpointBoundsPolledDeadline)
+{
+    tick &a = make_tick(0);
+
+    cusb_sim_set_idle(&m_sim, &poll_one, &m_dev);
+    cusb_device_start(&m_dev, true);
+    enumerate();
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+    cusb_device_timer_start(&m_dev, &a.timer, 0, 5000);
+    UNSIGNED_LONGS_EQUAL(5000, cusb_device_next_deadline(&m_dev, 0));
+
+    /* bInterval 4 at high speed: 2^3 microframes. */
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_INT, m_app.bulk.data(), INT_MPS)) );
+    UNSIGNED_LONGS_EQUAL(1000, cusb_device_next_deadline(&m_dev, 0));
+
+    /* Bulk endpoints are not periodic. */
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_OUT, m_app.bulk.data() + INT_MPS, MPS)) );
+    UNSIGNED_LONGS_EQUAL(1000, cusb_device_next_deadline(&m_dev, 0));
+}
+
+TEST(Device, ExhaustedPollMeansNoSleep)
+{
+    cusb_device_start(&m_dev, true);
+    cusb_sim_host_reset(&m_sim);
+    cusb_sim_host_sof(&m_sim);
+
+    UNSIGNED_LONGS_EQUAL(1, cusb_poll(&m_dev, 1));
+    UNSIGNED_LONGS_EQUAL(0, cusb_device_next_deadline(&m_dev, 0));
+    UNSIGNED_LONGS_EQUAL(1, cusb_poll(&m_dev, 2));
+    UNSIGNED_LONGS_EQUAL(CUSB_DEADLINE_NONE, cusb_device_next_deadline(&m_dev, 0));
+}
+
+TEST(Device, SuspendedBusOnlyWaitsForTimers)
+{
+    tick &a = make_tick(0);
+
+    cusb_sim_set_idle(&m_sim, &poll_one, &m_dev);
+    cusb_device_start(&m_dev, true);
+    enumerate();
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+    CHECK_TRUE( (cusb_device_ep_xfer(&m_dev, EP_INT, m_app.bulk.data(), INT_MPS)) );
+    cusb_device_timer_start(&m_dev, &a.timer, 0, 5000);
+
+    cusb_sim_host_suspend(&m_sim, true);
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+    UNSIGNED_LONGS_EQUAL(5000, cusb_device_next_deadline(&m_dev, 0));
+
+    cusb_device_timer_stop(&m_dev, &a.timer);
+    UNSIGNED_LONGS_EQUAL(CUSB_DEADLINE_NONE, cusb_device_next_deadline(&m_dev, 0));
+}
@@ -0,0 +1,322 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref diskimage.h
+ *
+ * Test Summary:
+ *
+ * cusb_diskimage_open()
+ *      - TEST(DiskImage, OpenRejectsBadImages)
+ *      - TEST(DiskImage, ReadOnlyIsWriteProtected)
+ *
+ * Requests
+ *      - TEST(DiskImage, RequestsMoveData)
+ *      - TEST(DiskImage, SyncSucceeds)
+ *
+ * cusb_blockdev_map()
+ *      - TEST(DiskImage, ScsiReadBypassesTaskBuffer)
+ *      - TEST(DiskImage, ScsiWriteBypassesTaskBuffer)
+ *      - TEST(DiskImage, ScsiWriteCutShortIsStillSynced)
+ *
+ * cusb_diskimage_set_latency(), cusb_diskimage_poll()
+ *      - TEST(DiskImage, LatencyDefersCompletion)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/diskimage.h"
+#include "cusb/scsi.h"
+
+/* STDLib. */
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+/* POSIX. */
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint32_t BLOCK_SIZE = 512;
+constexpr std::uint32_t BLOCK_COUNT = 64;
+constexpr std::size_t TASK_BUFFER_SIZE = 2 * BLOCK_SIZE;
+constexpr std::uint8_t SENTINEL = 0xCC;
+
+const struct cusb_scsi_inquiry INQUIRY = {"cusb", "Disk Image", "1.0"};
+
+std::uint8_t pattern(std::uint32_t lba, std::uint32_t i)
+{
+    return static_cast<std::uint8_t>((lba * 7U) + i);
+}
+
+/**
+ * @brief Temporary image file, removed on destruction.
+ */
+struct image
+{
+    explicit image(std::size_t size)
+    {
+        std::strcpy(path, "/tmp/cusb_diskimage_XXXXXX");
+        int fd = mkstemp(path);
+        std::vector<std::uint8_t> data(size);
+
+        for (std::size_t i = 0; i < size; i++)
+        {
+            data[i] = pattern(static_cast<std::uint32_t>(i / BLOCK_SIZE), static_cast<std::uint32_t>(i % BLOCK_SIZE));
+        }
+
+        CHECK_TRUE( (write(fd, data.data(), size) == static_cast<ssize_t>(size)) );
+        close(fd);
+    }
+
+    ~image()
+    {
+        unlink(path);
+    }
+
+    std::uint8_t byte(std::size_t offset) const
+    {
+        std::uint8_t b = 0;
+        FILE *f = std::fopen(path, "rb");
+        std::fseek(f, static_cast<long>(offset), SEEK_SET);
+        CHECK_TRUE( (std::fread(&b, 1, 1, f) == 1) );
+        std::fclose(f);
+        return b;
+    }
+
+    char path[32];
+};
+
+/**
+ * @brief Request with its own buffer.
+ */
+struct request
+{
+    request(std::uint8_t op, std::uint32_t lba, std::uint32_t count, std::uint8_t fill = 0)
+        : buf(static_cast<std::size_t>(count) * BLOCK_SIZE, fill)
+    {
+        std::memset(&req, 0, sizeof(req));
+        req.op = op;
+        req.lba = lba;
+        req.count = count;
+        req.buf = buf.data();
+        req.done = &on_done;
+        req.owner = this;
+    }
+
+    static void on_done(struct cusb_blockdev_req *r, bool ok)
+    {
+        auto *me = static_cast<request *>(r->owner);
+        me->completions++;
+        me->ok = ok;
+    }
+
+    struct cusb_blockdev_req req;
+    std::vector<std::uint8_t> buf;
+    int completions = 0;
+    bool ok = false;
+};
+
+void on_notify(void *ctx, struct cusb_scsi_task *)
+{
+    (*static_cast<int *>(ctx))++;
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(DiskImage)
+{
+    void setup() override
+    {
+        CHECK_TRUE( (cusb_diskimage_open(&m_image, m_file.path, BLOCK_SIZE, false)) );
+        cusb_scsi_ctor(&m_scsi, cusb_diskimage_blockdev(&m_image), &INQUIRY);
+        cusb_scsi_task_ctor(&m_task, m_buf, sizeof(m_buf), &on_notify, &m_notifications);
+        std::memset(m_buf, SENTINEL, sizeof(m_buf));
+    }
+
+    void teardown() override
+    {
+        cusb_diskimage_close(&m_image);
+    }
+
+    void submit(request &r)
+    {
+        cusb_blockdev_submit(cusb_diskimage_blockdev(&m_image), &r.req);
+    }
+
+    void start(std::uint8_t op, std::uint32_t lba, std::uint16_t blocks)
+    {
+        std::uint8_t cdb[16] = {op, 0, 0, 0, 0, static_cast<std::uint8_t>(lba), 0,
+                                static_cast<std::uint8_t>(blocks >> 8), static_cast<std::uint8_t>(blocks), 0};
+        cusb_scsi_task_start(&m_scsi, &m_task, cdb, sizeof(cdb));
+    }
+
+    image m_file{BLOCK_COUNT * BLOCK_SIZE};
+    struct cusb_diskimage m_image;
+    struct cusb_scsi m_scsi;
+    struct cusb_scsi_task m_task;
+    std::uint8_t m_buf[TASK_BUFFER_SIZE];
+    int m_notifications = 0;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(DiskImage, OpenRejectsBadImages)
+{
+    struct cusb_diskimage other;
+    image odd{BLOCK_SIZE + 1};
+    image empty{0};
+
+    CHECK_FALSE( (cusb_diskimage_open(&other, "/nonexistent/cusb.img", BLOCK_SIZE, false)) );
+    CHECK_FALSE( (cusb_diskimage_open(&other, odd.path, BLOCK_SIZE, false)) );
+    CHECK_FALSE( (cusb_diskimage_open(&other, empty.path, BLOCK_SIZE, false)) );
+    UNSIGNED_LONGS_EQUAL(BLOCK_COUNT, cusb_diskimage_blockdev(&m_image)->block_count);
+}
+
+TEST(DiskImage, ReadOnlyIsWriteProtected)
+{
+    struct cusb_diskimage ro;
+    CHECK_TRUE( (cusb_diskimage_open(&ro, m_file.path, BLOCK_SIZE, true)) );
+    CHECK_TRUE( (cusb_diskimage_blockdev(&ro)->write_protected) );
+    CHECK_FALSE( (cusb_diskimage_blockdev(&m_image)->write_protected) );
+    cusb_diskimage_close(&ro);
+}
+
+TEST(DiskImage, RequestsMoveData)
+{
+    request r{CUSB_BLOCKDEV_READ, 3, 2};
+    submit(r);
+    LONGS_EQUAL(1, r.completions);
+    CHECK_TRUE( (r.ok) );
+    BYTES_EQUAL(pattern(3, 5), r.buf[5]);
+    BYTES_EQUAL(pattern(4, 5), r.buf[BLOCK_SIZE + 5]);
+
+    request w{CUSB_BLOCKDEV_WRITE, 10, 1, 0xA5};
+    submit(w);
+    CHECK_TRUE( (w.ok) );
+    BYTES_EQUAL(0xA5, m_file.byte(10 * BLOCK_SIZE + 17));
+}
+
+TEST(DiskImage, SyncSucceeds)
+{
+    request w{CUSB_BLOCKDEV_WRITE, 60, 4, 0x11};
+    request sync{CUSB_BLOCKDEV_SYNC, 0, 0};
+    submit(w);
+    submit(sync);
+    LONGS_EQUAL(1, sync.completions);
+    CHECK_TRUE( (sync.ok) );
+
+    /* Nothing written since. */
+    request again{CUSB_BLOCKDEV_SYNC, 0, 0};
+    submit(again);
+    CHECK_TRUE( (again.ok) );
+}
+
+TEST(DiskImage, ScsiReadBypassesTaskBuffer)
+{
+    std::uint8_t pkt[BLOCK_SIZE];
+
+    start(0x28, 7, 3);
+    for (std::uint32_t i = 0; i < 3; i++)
+    {
+        CHECK_EQUAL(CUSB_SCSI_TASK_DATA_IN, m_task.state);
+        LONGS_EQUAL(BLOCK_SIZE, cusb_scsi_task_data_in(&m_task, pkt, sizeof(pkt)));
+        BYTES_EQUAL(pattern(7 + i, 100), pkt[100]);
+    }
+
+    CHECK_EQUAL(CUSB_SCSI_TASK_DONE, m_task.state);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, m_task.status);
+    BYTES_EQUAL(SENTINEL, m_buf[0]);
+    BYTES_EQUAL(SENTINEL, m_buf[sizeof(m_buf) - 1]);
+}
+
+TEST(DiskImage, ScsiWriteBypassesTaskBuffer)
+{
+    std::uint8_t pkt[BLOCK_SIZE];
+    std::memset(pkt, 0x3C, sizeof(pkt));
+
+    start(0x2A, 20, 3);
+    for (std::uint32_t i = 0; i < 3; i++)
+    {
+        CHECK_EQUAL(CUSB_SCSI_TASK_DATA_OUT, m_task.state);
+        cusb_scsi_task_data_out(&m_task, pkt, sizeof(pkt));
+    }
+
+    CHECK_EQUAL(CUSB_SCSI_TASK_DONE, m_task.state);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, m_task.status);
+    BYTES_EQUAL(SENTINEL, m_buf[0]);
+    BYTES_EQUAL(0x3C, m_file.byte(22 * BLOCK_SIZE + BLOCK_SIZE - 1));
+    BYTES_EQUAL(pattern(23, 0), m_file.byte(23 * BLOCK_SIZE));
+}
+
+TEST(DiskImage, ScsiWriteCutShortIsStillSynced)
+{
+    std::uint8_t block[BLOCK_SIZE];
+    std::uint8_t pkt[BLOCK_SIZE / 2];
+    std::memset(pkt, 0x5A, sizeof(pkt));
+
+    /* Reading through the mapping leaves nothing to sync. */
+    start(0x28, 40, 1);
+    cusb_scsi_task_data_in(&m_task, block, sizeof(block));
+    cusb_scsi_task_free(&m_task);
+    UNSIGNED_LONGS_EQUAL(m_image.dirty_first, m_image.dirty_end);
+
+    start(0x2A, 30, 3);
+    cusb_scsi_task_data_out(&m_task, pkt, sizeof(pkt));
+    cusb_scsi_task_data_out_end(&m_task);
+    CHECK_EQUAL(CUSB_SCSI_TASK_DONE, m_task.state);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, m_task.status);
+
+    /* Half a block already reached the media without a WRITE request. */
+    BYTES_EQUAL(0x5A, m_file.byte(30 * BLOCK_SIZE));
+    CHECK_TRUE( (m_image.dirty_first <= 30 && m_image.dirty_end > 30) );
+
+    request sync{CUSB_BLOCKDEV_SYNC, 0, 0};
+    submit(sync);
+    CHECK_TRUE( (sync.ok) );
+    UNSIGNED_LONGS_EQUAL(m_image.dirty_first, m_image.dirty_end);
+}
+
+TEST(DiskImage, LatencyDefersCompletion)
+{
+    cusb_diskimage_set_latency(&m_image, 2000);
+
+    start(0x28, 1, 1);
+    CHECK_EQUAL(CUSB_SCSI_TASK_WAIT, m_task.state);
+    UNSIGNED_LONGS_EQUAL(0, cusb_diskimage_poll(&m_image));
+    UNSIGNED_LONGS_EQUAL(1, cusb_diskimage_pending(&m_image));
+    LONGS_EQUAL(0, m_notifications);
+
+    usleep(3000);
+    UNSIGNED_LONGS_EQUAL(1, cusb_diskimage_poll(&m_image));
+    UNSIGNED_LONGS_EQUAL(0, cusb_diskimage_pending(&m_image));
+    LONGS_EQUAL(1, m_notifications);
+    CHECK_EQUAL(CUSB_SCSI_TASK_DATA_IN, m_task.state);
+
+    std::uint8_t pkt[BLOCK_SIZE];
+    cusb_scsi_task_data_in(&m_task, pkt, sizeof(pkt));
+    BYTES_EQUAL(pattern(1, 9), pkt[9]);
+}
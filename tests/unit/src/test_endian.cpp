@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref endian.h and
+ * @ref setup.h on the host's own byte order. See test_endian_big.cpp for
+ * the big endian branches.
+ *
+ * Test Summary:
+ *
+ * cusb_get_le16(), cusb_get_le32(), cusb_get_be16(), cusb_get_be32()
+ *      - TEST(Endian, LoadsAtEveryAlignment)
+ *
+ * cusb_set_le16(), cusb_set_le32(), cusb_set_be16(), cusb_set_be32()
+ *      - TEST(Endian, StoresAtEveryAlignmentTouchOnlyTheirBytes)
+ *
+ * SETUP and descriptor field views
+ *      - TEST(Endian, SetupFieldsAreReadInPlace)
+ *      - TEST(Endian, DescriptorFieldsAreReadInPlace)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/endian.h"
+#include "cusb/setup.h"
+
+/* STDLib. */
+#include <array>
+#include <cstring>
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::size_t BUF_SIZE = 16U;
+
+/**
+ * @brief Byte by byte reference, independent of the host.
+ */
+std::uint32_t reference(const std::uint8_t *p, std::size_t n, bool big)
+{
+    std::uint32_t val = 0;
+
+    for (std::size_t i = 0; i < n; i++)
+    {
+        val |= static_cast<std::uint32_t>(p[big ? (n - 1U - i) : i]) << (8U * i);
+    }
+
+    return val;
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Endian)
+{
+    void setup() override
+    {
+        for (std::size_t i = 0; i < m_buf.size(); i++)
+        {
+            m_buf[i] = static_cast<std::uint8_t>(0xA1U + (i * 0x13U));
+        }
+    }
+
+    /* Aligned to 4, so offsets 1 to 3 are misaligned for every size. */
+    alignas(4) std::array<std::uint8_t, BUF_SIZE> m_buf{};
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Endian, LoadsAtEveryAlignment)
+{
+    for (std::size_t offset = 0; offset < 8U; offset++)
+    {
+        const std::uint8_t *p = &m_buf[offset];
+
+        UNSIGNED_LONGS_EQUAL(reference(p, 2, false), cusb_get_le16(p));
+        UNSIGNED_LONGS_EQUAL(reference(p, 4, false), cusb_get_le32(p));
+        UNSIGNED_LONGS_EQUAL(reference(p, 2, true), cusb_get_be16(p));
+        UNSIGNED_LONGS_EQUAL(reference(p, 4, true), cusb_get_be32(p));
+    }
+}
+
+TEST(Endian, StoresAtEveryAlignmentTouchOnlyTheirBytes)
+{
+    for (std::size_t offset = 1; offset < 8U; offset++)
+    {
+        std::array<std::uint8_t, BUF_SIZE> before = m_buf;
+        std::uint8_t *p = &m_buf[offset];
+
+        cusb_set_le16(p, 0x1234U);
+        BYTES_EQUAL(0x34, p[0]);
+        BYTES_EQUAL(0x12, p[1]);
+        cusb_set_be16(p, 0x1234U);
+        BYTES_EQUAL(0x12, p[0]);
+        BYTES_EQUAL(0x34, p[1]);
+        cusb_set_le32(p, 0x12345678UL);
+        MEMCMP_EQUAL("\x78\x56\x34\x12", p, 4);
+        cusb_set_be32(p, 0x12345678UL);
+        MEMCMP_EQUAL("\x12\x34\x56\x78", p, 4);
+
+        MEMCMP_EQUAL(before.data(), m_buf.data(), offset);
+        MEMCMP_EQUAL(&before[offset + 4U], &m_buf[offset + 4U], BUF_SIZE - offset - 4U);
+    }
+}
+
+TEST(Endian, SetupFieldsAreReadInPlace)
+{
+    /* GET_DESCRIPTOR, string 2 in language 0x0409, 255 bytes. */
+    const std::uint8_t packet[CUSB_SETUP_SIZE] = {0x80, 6, 0x02, 0x03, 0x09, 0x04, 0xFF, 0x00};
+    std::memcpy(&m_buf[1], packet, sizeof(packet));
+    const std::uint8_t *setup = &m_buf[1];
+
+    BYTES_EQUAL(CUSB_SETUP_DIR_IN | CUSB_SETUP_TYPE_STANDARD | CUSB_SETUP_RECIPIENT_DEVICE, cusb_setup_request_type(setup));
+    BYTES_EQUAL(6, cusb_setup_request(setup));
+    UNSIGNED_LONGS_EQUAL(0x0302U, cusb_setup_value(setup));
+    UNSIGNED_LONGS_EQUAL(0x0409U, cusb_setup_index(setup));
+    UNSIGNED_LONGS_EQUAL(255U, cusb_setup_length(setup));
+}
+
+TEST(Endian, DescriptorFieldsAreReadInPlace)
+{
+    const std::uint8_t device[18] =
+    {
+        18, 1, 0x10, 0x02, 0, 0, 0, 64, 0x34, 0x12, 0x78, 0x56, 0x01, 0x02, 1, 2, 3, 1
+    };
+    const std::uint8_t config[9] = {9, 2, 0x20, 0x01, 1, 1, 0, 0x80, 50};
+    const std::uint8_t endpoint[7] = {7, 5, 0x81, 1, 0x00, 0x14, 1};
+    std::array<std::uint8_t, 1U + sizeof(device)> odd{};
+    std::memcpy(&odd[1], device, sizeof(device));
+
+    UNSIGNED_LONGS_EQUAL(0x0210U, cusb_desc_bcd_usb(&odd[1]));
+    UNSIGNED_LONGS_EQUAL(0x1234U, cusb_desc_vendor(&odd[1]));
+    UNSIGNED_LONGS_EQUAL(0x5678U, cusb_desc_product(&odd[1]));
+    UNSIGNED_LONGS_EQUAL(0x0201U, cusb_desc_bcd_device(&odd[1]));
+    UNSIGNED_LONGS_EQUAL(0x0120U, cusb_desc_total_length(config));
+
+    /* 1024 bytes, three per microframe. */
+    UNSIGNED_LONGS_EQUAL(1024U, cusb_desc_max_packet_size(endpoint));
+}
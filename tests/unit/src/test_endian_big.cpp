@@ -0,0 +1,112 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref endian.h and
+ * @ref setup.h built as for a big endian target. The header swaps what
+ * it loads and stores, so memory looks to it the way it would to a big
+ * endian core, and every value has to come out the same as in
+ * test_endian.cpp.
+ *
+ * Test Summary:
+ *
+ * Emulation
+ *      - TEST(EndianBig, TargetIsBigEndian)
+ *
+ * Loads and stores
+ *      - TEST(EndianBig, LoadsAtEveryAlignment)
+ *      - TEST(EndianBig, StoresAtEveryAlignment)
+ *
+ * SETUP field views
+ *      - TEST(EndianBig, SetupFieldsAreReadInPlace)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test, as on a big endian target. Must come first. */
+#define CUSB_ENDIAN_EMULATE_BIG
+#include "cusb/endian.h"
+#include "cusb/setup.h"
+
+/* STDLib. */
+#include <array>
+#include <cstring>
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(EndianBig)
+{
+    void setup() override
+    {
+        const std::uint8_t pattern[8] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88};
+
+        for (std::size_t i = 0; i < m_buf.size(); i++)
+        {
+            m_buf[i] = pattern[i % sizeof(pattern)];
+        }
+    }
+
+    alignas(4) std::array<std::uint8_t, 16> m_buf{};
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(EndianBig, TargetIsBigEndian)
+{
+    LONGS_EQUAL(1, CUSB_ENDIAN_BIG_);
+}
+
+TEST(EndianBig, LoadsAtEveryAlignment)
+{
+    UNSIGNED_LONGS_EQUAL(0x2211U, cusb_get_le16(&m_buf[0]));
+    UNSIGNED_LONGS_EQUAL(0x3322U, cusb_get_le16(&m_buf[1]));
+    UNSIGNED_LONGS_EQUAL(0x55443322UL, cusb_get_le32(&m_buf[1]));
+    UNSIGNED_LONGS_EQUAL(0x66554433UL, cusb_get_le32(&m_buf[2]));
+    UNSIGNED_LONGS_EQUAL(0x77665544UL, cusb_get_le32(&m_buf[3]));
+    UNSIGNED_LONGS_EQUAL(0x2233U, cusb_get_be16(&m_buf[1]));
+    UNSIGNED_LONGS_EQUAL(0x44556677UL, cusb_get_be32(&m_buf[3]));
+    UNSIGNED_LONGS_EQUAL(0x11223344UL, cusb_get_be32(&m_buf[0]));
+}
+
+TEST(EndianBig, StoresAtEveryAlignment)
+{
+    for (std::size_t offset = 1; offset < 4U; offset++)
+    {
+        std::uint8_t *p = &m_buf[offset];
+
+        cusb_set_le16(p, 0x1234U);
+        MEMCMP_EQUAL("\x34\x12", p, 2);
+        cusb_set_be16(p, 0x1234U);
+        MEMCMP_EQUAL("\x12\x34", p, 2);
+        cusb_set_le32(p, 0x12345678UL);
+        MEMCMP_EQUAL("\x78\x56\x34\x12", p, 4);
+        cusb_set_be32(p, 0x12345678UL);
+        MEMCMP_EQUAL("\x12\x34\x56\x78", p, 4);
+        UNSIGNED_LONGS_EQUAL(0x12345678UL, cusb_get_be32(p));
+    }
+}
+
+TEST(EndianBig, SetupFieldsAreReadInPlace)
+{
+    const std::uint8_t packet[CUSB_SETUP_SIZE] = {0x21, 0x09, 0x00, 0x02, 0x01, 0x00, 0x40, 0x00};
+    std::memcpy(&m_buf[3], packet, sizeof(packet));
+    const std::uint8_t *setup = &m_buf[3];
+
+    BYTES_EQUAL(CUSB_SETUP_TYPE_CLASS | CUSB_SETUP_RECIPIENT_INTERFACE, cusb_setup_request_type(setup));
+    BYTES_EQUAL(0x09, cusb_setup_request(setup));
+    UNSIGNED_LONGS_EQUAL(0x0200U, cusb_setup_value(setup));
+    UNSIGNED_LONGS_EQUAL(0x0001U, cusb_setup_index(setup));
+    UNSIGNED_LONGS_EQUAL(64U, cusb_setup_length(setup));
+}
@@ -0,0 +1,346 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref load.h, and for the
+ * load hooks of @ref device.h.
+ *
+ * Test Summary:
+ *
+ * cusb_load_enter() and cusb_load_exit()
+ *      - TEST(Load, NestedContextsAreChargedExclusively)
+ *      - TEST(Load, InterruptIsTakenOutOfPreemptedWork)
+ *      - TEST(Load, ExitWithoutEnterAsserts)
+ *
+ * cusb_load_update()
+ *      - TEST(Load, WindowClosesOnlyOnceOver)
+ *      - TEST(Load, LateUpdateSpreadsLoadOverActualLength)
+ *      - TEST(Load, AverageRunsOverHistory)
+ *      - TEST(Load, PeakHoldsUntilCleared)
+ *      - TEST(Load, WorkSpanningWindowsIsSplit)
+ *
+ * Device hooks
+ *      - TEST(Load, DeviceChargesInterruptAndCallbacks)
+ *      - TEST(Load, DeviceChargesPollsAndTimersAsDeferred)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/device.h"
+#include "cusb/load.h"
+#include "cusb/sim.h"
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint32_t WINDOW = 1000U;
+
+/**
+ * @brief Fake tick source. Reads return @ref now_ticks, then advance it
+ * by @ref step_ticks.
+ */
+std::uint32_t now_ticks;
+std::uint32_t step_ticks;
+
+std::uint32_t fake_now()
+{
+    std::uint32_t now = now_ticks;
+    now_ticks += step_ticks;
+    return now;
+}
+
+const std::uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0xFF, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0, 0, 0, 1
+};
+
+const std::uint8_t CONFIG_DESC[9 + 9 + 7] =
+{
+    9, 2, 9 + 9 + 7, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 1, 0xFF, 0x00, 0x00, 0,
+    7, 5, 0x01, 2, 0x00, 0x02, 0
+};
+
+const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, nullptr, nullptr, 0};
+
+struct cusb_device *device;
+std::uint8_t rx[512];
+
+void done(void *obj, std::uint8_t ep, std::uint8_t *buf, std::uint32_t len, bool ok)
+{
+    (void)obj;
+    (void)len;
+    (void)ok;
+    (void)cusb_device_ep_xfer(device, ep, buf, sizeof(rx));
+}
+
+bool configure(void *obj, std::uint8_t config)
+{
+    (void)obj;
+
+    if (config != 0U)
+    {
+        cusb_device_ep_open(device, 0x01U, CUSB_EP_BULK, sizeof(rx), &done, nullptr);
+        (void)cusb_device_ep_xfer(device, 0x01U, rx, sizeof(rx));
+    }
+
+    return true;
+}
+
+void tick(void *obj)
+{
+    (void)obj;
+}
+
+const struct cusb_device_callbacks CALLBACKS = {&configure, nullptr, nullptr, nullptr, nullptr};
+
+void isr(void *obj)
+{
+    cusb_isr(static_cast<struct cusb_device *>(obj));
+}
+
+void poll(void *obj)
+{
+    (void)cusb_poll(static_cast<struct cusb_device *>(obj), SIZE_MAX);
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Load)
+{
+    void setup() override
+    {
+        now_ticks = 0;
+        step_ticks = 0;
+        cusb_load_ctor(&m_load, &fake_now, WINDOW);
+    }
+
+    /**
+     * @brief Runs @p context from @p begin to @p end on the fake clock.
+     */
+    void run(std::uint8_t context, std::uint32_t begin, std::uint32_t end)
+    {
+        now_ticks = begin;
+        cusb_load_enter(&m_load, context);
+        now_ticks = end;
+        cusb_load_exit(&m_load);
+    }
+
+    bool update_at(std::uint32_t now)
+    {
+        now_ticks = now;
+        return cusb_load_update(&m_load);
+    }
+
+    const struct cusb_load_report *report() const
+    {
+        return cusb_load_get_report(&m_load);
+    }
+
+    /**
+     * @brief Starts a device on the simulator with a fake clock that
+     * advances on every read, and enumerates it.
+     */
+    void start_device(bool polled)
+    {
+        static const std::uint8_t SET_ADDRESS[8] = {0x00, 5, 1, 0, 0, 0, 0, 0};
+        static const std::uint8_t SET_CONFIGURATION[8] = {0x00, 9, 1, 0, 0, 0, 0, 0};
+
+        device = &m_dev;
+        cusb_sim_ctor(&m_sim, CUSB_SPEED_HIGH, &isr, &m_dev);
+        cusb_device_ctor(&m_dev, &m_sim.dcd, &DESCRIPTORS, &CALLBACKS, nullptr);
+        cusb_device_set_load(&m_dev, &m_load);
+        cusb_sim_set_idle(&m_sim, polled ? &poll : nullptr, &m_dev);
+        cusb_device_start(&m_dev, polled);
+        step_ticks = 1;
+        cusb_sim_host_reset(&m_sim);
+        LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_control(&m_sim, SET_ADDRESS, nullptr, nullptr));
+        LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_control(&m_sim, SET_CONFIGURATION, nullptr, nullptr));
+    }
+
+    struct cusb_load m_load;
+    struct cusb_sim m_sim;
+    struct cusb_device m_dev;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Load, NestedContextsAreChargedExclusively)
+{
+    now_ticks = 0;
+    cusb_load_enter(&m_load, CUSB_LOAD_DEFERRED);
+    now_ticks = 100;
+    cusb_load_enter(&m_load, CUSB_LOAD_CALLBACK);
+    now_ticks = 300;
+    cusb_load_exit(&m_load);
+    now_ticks = 400;
+    cusb_load_exit(&m_load);
+
+    CHECK_TRUE( (update_at(1000)) );
+    UNSIGNED_LONGS_EQUAL(2000, report()->last[CUSB_LOAD_DEFERRED]);
+    UNSIGNED_LONGS_EQUAL(2000, report()->last[CUSB_LOAD_CALLBACK]);
+    UNSIGNED_LONGS_EQUAL(0, report()->last[CUSB_LOAD_ISR]);
+    UNSIGNED_LONGS_EQUAL(4000, report()->last[CUSB_LOAD_TOTAL]);
+}
+
+TEST(Load, InterruptIsTakenOutOfPreemptedWork)
+{
+    now_ticks = 0;
+    cusb_load_enter(&m_load, CUSB_LOAD_DEFERRED);
+
+    /* Interrupt with a callback preempts it. */
+    now_ticks = 100;
+    cusb_load_enter(&m_load, CUSB_LOAD_ISR);
+    now_ticks = 150;
+    cusb_load_enter(&m_load, CUSB_LOAD_CALLBACK);
+    now_ticks = 200;
+    cusb_load_exit(&m_load);
+    now_ticks = 250;
+    cusb_load_exit(&m_load);
+
+    now_ticks = 500;
+    cusb_load_exit(&m_load);
+
+    CHECK_TRUE( (update_at(1000)) );
+    UNSIGNED_LONGS_EQUAL(1000, report()->last[CUSB_LOAD_ISR]);
+    UNSIGNED_LONGS_EQUAL(3500, report()->last[CUSB_LOAD_DEFERRED]);
+    UNSIGNED_LONGS_EQUAL(500, report()->last[CUSB_LOAD_CALLBACK]);
+    UNSIGNED_LONGS_EQUAL(5000, report()->last[CUSB_LOAD_TOTAL]);
+}
+
+TEST(Load, ExitWithoutEnterAsserts)
+{
+    CHECK_THROWS(stubs::assert_exception, cusb_load_exit(&m_load));
+}
+
+TEST(Load, WindowClosesOnlyOnceOver)
+{
+    run(CUSB_LOAD_ISR, 0, 100);
+
+    CHECK_FALSE( (update_at(999)) );
+    UNSIGNED_LONGS_EQUAL(0, report()->windows);
+    CHECK_TRUE( (update_at(1000)) );
+    UNSIGNED_LONGS_EQUAL(1, report()->windows);
+    UNSIGNED_LONGS_EQUAL(1000, report()->last[CUSB_LOAD_ISR]);
+
+    /* Next window starts where this one closed. */
+    CHECK_FALSE( (update_at(1999)) );
+    CHECK_TRUE( (update_at(2000)) );
+    UNSIGNED_LONGS_EQUAL(0, report()->last[CUSB_LOAD_ISR]);
+}
+
+TEST(Load, LateUpdateSpreadsLoadOverActualLength)
+{
+    run(CUSB_LOAD_ISR, 0, 400);
+
+    CHECK_TRUE( (update_at(4000)) );
+    UNSIGNED_LONGS_EQUAL(1000, report()->last[CUSB_LOAD_ISR]);
+    UNSIGNED_LONGS_EQUAL(1, report()->windows);
+}
+
+TEST(Load, AverageRunsOverHistory)
+{
+    std::uint32_t t = 0;
+
+    /* A full history at 10 %, then one window at 50 %. */
+    for (unsigned i = 0; i < CUSB_CFG_LOAD_HISTORY; i++, t += WINDOW)
+    {
+        run(CUSB_LOAD_ISR, t, t + 100U);
+        CHECK_TRUE( (update_at(t + WINDOW)) );
+    }
+
+    UNSIGNED_LONGS_EQUAL(1000, report()->average[CUSB_LOAD_ISR]);
+    run(CUSB_LOAD_ISR, t, t + 500U);
+    CHECK_TRUE( (update_at(t + WINDOW)) );
+
+    UNSIGNED_LONGS_EQUAL(5000, report()->last[CUSB_LOAD_ISR]);
+    UNSIGNED_LONGS_EQUAL((1000U * (CUSB_CFG_LOAD_HISTORY - 1U) + 5000U) / CUSB_CFG_LOAD_HISTORY,
+                         report()->average[CUSB_LOAD_ISR]);
+}
+
+TEST(Load, PeakHoldsUntilCleared)
+{
+    run(CUSB_LOAD_CALLBACK, 0, 700);
+    CHECK_TRUE( (update_at(1000)) );
+    run(CUSB_LOAD_CALLBACK, 1000, 1200);
+    CHECK_TRUE( (update_at(2000)) );
+
+    UNSIGNED_LONGS_EQUAL(2000, report()->last[CUSB_LOAD_CALLBACK]);
+    UNSIGNED_LONGS_EQUAL(7000, report()->peak[CUSB_LOAD_CALLBACK]);
+    UNSIGNED_LONGS_EQUAL(7000, report()->peak[CUSB_LOAD_TOTAL]);
+
+    cusb_load_clear_peak(&m_load);
+    UNSIGNED_LONGS_EQUAL(2000, report()->peak[CUSB_LOAD_CALLBACK]);
+}
+
+TEST(Load, WorkSpanningWindowsIsSplit)
+{
+    now_ticks = 500;
+    cusb_load_enter(&m_load, CUSB_LOAD_DEFERRED);
+
+    CHECK_TRUE( (update_at(1000)) );
+    UNSIGNED_LONGS_EQUAL(5000, report()->last[CUSB_LOAD_DEFERRED]);
+
+    now_ticks = 1250;
+    cusb_load_exit(&m_load);
+    CHECK_TRUE( (update_at(2000)) );
+    UNSIGNED_LONGS_EQUAL(2500, report()->last[CUSB_LOAD_DEFERRED]);
+}
+
+TEST(Load, DeviceChargesInterruptAndCallbacks)
+{
+    std::uint8_t packet[512] = {};
+
+    start_device(false);
+
+    for (int i = 0; i < 16; i++)
+    {
+        LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, 0x01U, packet, sizeof(packet)));
+    }
+
+    CHECK_TRUE( (update_at(now_ticks + WINDOW)) );
+    CHECK_TRUE( (report()->last[CUSB_LOAD_ISR] > 0U) );
+    CHECK_TRUE( (report()->last[CUSB_LOAD_CALLBACK] > 0U) );
+    UNSIGNED_LONGS_EQUAL(0, report()->last[CUSB_LOAD_DEFERRED]);
+}
+
+TEST(Load, DeviceChargesPollsAndTimersAsDeferred)
+{
+    struct cusb_timer timer;
+    std::uint8_t packet[512] = {};
+
+    start_device(true);
+    cusb_timer_ctor(&timer, &tick, nullptr);
+    cusb_device_timer_start(&m_dev, &timer, 0, 10);
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+    LONGS_EQUAL(CUSB_SIM_ACK, cusb_sim_host_out(&m_sim, 0x01U, packet, sizeof(packet)));
+    (void)cusb_poll(&m_dev, SIZE_MAX);
+    cusb_device_run_timers(&m_dev, 10);
+
+    CHECK_TRUE( (update_at(now_ticks + WINDOW)) );
+    UNSIGNED_LONGS_EQUAL(0, report()->last[CUSB_LOAD_ISR]);
+    CHECK_TRUE( (report()->last[CUSB_LOAD_DEFERRED] > 0U) );
+    CHECK_TRUE( (report()->last[CUSB_LOAD_CALLBACK] > 0U) );
+    CHECK_FALSE( (timer.armed) );
+}
@@ -0,0 +1,446 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref midi.h
+ *
+ * Test Summary:
+ *
+ * cusb_midi_write(), MIDI 1.0 event packets
+ *      - TEST(Midi, ChannelVoiceAndRunningStatus)
+ *      - TEST(Midi, RealTimeInsideMessage)
+ *      - TEST(Midi, SystemCommon)
+ *      - TEST(Midi, SysExCodeIndexNumbers)
+ *      - TEST(Midi, MessageSplitAcrossWrites)
+ *      - TEST(Midi, CablesParseIndependently)
+ *      - TEST(Midi, OverflowDropsWholeWrite)
+ *
+ * cusb_midi_write(), cusb_midi_write_ump(), MIDI 2.0 UMP
+ *      - TEST(Midi, UmpChannelVoiceAndSystem)
+ *      - TEST(Midi, UmpSysEx7)
+ *      - TEST(Midi, UmpNeverStraddlesPacket)
+ *      - TEST(Midi, WriteUmpNeeds20Mode)
+ *
+ * cusb_midi_bulk_in(), cusb_midi_in_complete(), cusb_midi_flush()
+ *      - TEST(Midi, BatchesUntilFullPacket)
+ *      - TEST(Midi, LatencyTimerMakesPartialPacketDue)
+ *      - TEST(Midi, EventsPileUpBehindTransferInFlight)
+ *      - TEST(Midi, ZeroLatencySendsWhenIdle)
+ *      - TEST(Midi, FlushSendsNow)
+ *
+ * cusb_midi_bulk_out()
+ *      - TEST(Midi, BulkOutBatchesBytesPerCable)
+ *      - TEST(Midi, BulkOutUmpSkipsNoops)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/midi.h"
+#include "cusb/sim.h"
+
+/* STDLib. */
+#include <cstring>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint16_t PACKET_SIZE = 64;
+constexpr std::uint32_t LATENCY = 1000;
+
+/**
+ * @brief Application model. Records what the class hands it.
+ */
+struct app
+{
+    int ready = 0;
+    std::vector<std::uint8_t> cables;
+    std::vector<std::vector<std::uint8_t>> received;
+    std::vector<std::vector<std::uint32_t>> umps;
+
+    static app &self(void *ctx)
+    {
+        return *static_cast<app *>(ctx);
+    }
+
+    static void on_ready(void *ctx)
+    {
+        self(ctx).ready++;
+    }
+
+    static void receive(void *ctx, std::uint8_t cable, const std::uint8_t *data, std::size_t len)
+    {
+        self(ctx).cables.push_back(cable);
+        self(ctx).received.emplace_back(data, data + len);
+    }
+
+    static void receive_ump(void *ctx, const std::uint32_t *ump, std::uint8_t nwords)
+    {
+        self(ctx).umps.emplace_back(ump, ump + nwords);
+    }
+};
+
+const struct cusb_midi_api API = {&app::on_ready, &app::receive, &app::receive_ump};
+
+const std::uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0x00, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0, 0, 0, 1
+};
+
+const std::uint8_t CONFIG_DESC[9] = {9, 2, 9, 0, 0, 1, 0, 0x80, 50};
+
+const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, nullptr, nullptr, 0};
+
+const struct cusb_device_callbacks CALLBACKS = {nullptr, nullptr, nullptr, nullptr, nullptr};
+
+std::uint32_t le32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24));
+}
+
+void isr(void *obj)
+{
+    cusb_isr(static_cast<struct cusb_device *>(obj));
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Midi)
+{
+    void setup() override
+    {
+        cusb_sim_ctor(&m_sim, CUSB_SPEED_FULL, &isr, &m_dev);
+        cusb_device_ctor(&m_dev, &m_sim.dcd, &DESCRIPTORS, &CALLBACKS, nullptr);
+        cusb_midi_ctor(&m_midi, &API, &m_app, m_fifo, sizeof(m_fifo), 4, PACKET_SIZE, &m_dev, LATENCY);
+    }
+
+    bool write(std::uint8_t cable, const std::vector<std::uint8_t> &bytes, std::uint32_t now = 0)
+    {
+        return cusb_midi_write(&m_midi, cable, bytes.data(), bytes.size(), now);
+    }
+
+    /**
+     * @brief Takes the next Bulk-IN transfer as 32-bit words, completing
+     * it. Empty if none is due.
+     */
+    std::vector<std::uint32_t> transfer(std::size_t size = PACKET_SIZE)
+    {
+        std::vector<std::uint8_t> buf(size);
+        std::vector<std::uint32_t> words;
+        std::size_t len = 0;
+
+        if (cusb_midi_bulk_in(&m_midi, buf.data(), buf.size(), &len))
+        {
+            CHECK_EQUAL(0U, len % 4U);
+            for (std::size_t i = 0; i < len; i += 4)
+            {
+                words.push_back(le32(&buf[i]));
+            }
+            cusb_midi_in_complete(&m_midi);
+        }
+
+        return words;
+    }
+
+    /**
+     * @brief Everything queued, due or not.
+     */
+    std::vector<std::uint32_t> drain()
+    {
+        cusb_midi_flush(&m_midi);
+        return transfer(sizeof(m_fifo));
+    }
+
+    app m_app;
+    struct cusb_sim m_sim;
+    struct cusb_device m_dev;
+    struct cusb_midi m_midi;
+    std::uint8_t m_fifo[256];
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Midi, ChannelVoiceAndRunningStatus)
+{
+    /* Note on, two more under running status, program change. */
+    CHECK_TRUE( (write(1, {0x91, 60, 100, 62, 90, 64, 80, 0xC1, 5})) );
+
+    const std::vector<std::uint32_t> expected = {0x643C9119UL, 0x5A3E9119UL, 0x50409119UL, 0x0005C11CUL};
+    auto words = drain();
+    CHECK_EQUAL(expected.size(), words.size());
+    for (std::size_t i = 0; i < expected.size(); i++)
+    {
+        CHECK_EQUAL(expected[i], words[i]);
+    }
+}
+
+TEST(Midi, RealTimeInsideMessage)
+{
+    CHECK_TRUE( (write(0, {0xB0, 7, 0xF8, 127})) );
+
+    auto words = drain();
+    CHECK_EQUAL(2U, words.size());
+    CHECK_EQUAL(0x0000F80FUL, words[0]);
+    CHECK_EQUAL(0x7F07B00BUL, words[1]);
+}
+
+TEST(Midi, SystemCommon)
+{
+    /* Song position, tune request, MTC quarter frame. A data byte after
+    system common has no running status and is ignored. */
+    CHECK_TRUE( (write(0, {0xF2, 0x10, 0x20, 0xF6, 0xF1, 0x35, 0x11})) );
+
+    auto words = drain();
+    CHECK_EQUAL(3U, words.size());
+    CHECK_EQUAL(0x2010F203UL, words[0]);
+    CHECK_EQUAL(0x0000F605UL, words[1]);
+    CHECK_EQUAL(0x0035F102UL, words[2]);
+}
+
+TEST(Midi, SysExCodeIndexNumbers)
+{
+    /* 7 bytes: CIN 4 then CIN 5. 5 bytes: CIN 4 then CIN 6. 3 bytes: CIN 7. */
+    CHECK_TRUE( (write(0, {0xF0, 1, 2, 3, 4, 5, 0xF7})) );
+    CHECK_TRUE( (write(0, {0xF0, 1, 2, 3, 0xF7})) );
+    CHECK_TRUE( (write(0, {0xF0, 1, 0xF7})) );
+
+    auto words = drain();
+    CHECK_EQUAL(6U, words.size());
+    CHECK_EQUAL(0x0201F004UL, words[0]);
+    CHECK_EQUAL(0x05040304UL, words[1]);
+    CHECK_EQUAL(0x0000F705UL, words[2]);
+    CHECK_EQUAL(0x0201F004UL, words[3]);
+    CHECK_EQUAL(0x00F70306UL, words[4]);
+    CHECK_EQUAL(0xF701F007UL, words[5]);
+}
+
+TEST(Midi, MessageSplitAcrossWrites)
+{
+    CHECK_TRUE( (write(0, {0x90})) );
+    CHECK_TRUE( (write(0, {60})) );
+    CHECK_EQUAL(0U, cusb_midi_pending(&m_midi));
+    CHECK_TRUE( (write(0, {100})) );
+    CHECK_EQUAL(4U, cusb_midi_pending(&m_midi));
+}
+
+TEST(Midi, CablesParseIndependently)
+{
+    CHECK_TRUE( (write(2, {0x90, 60})) );
+    CHECK_TRUE( (write(3, {0x80, 61, 0})) );
+    CHECK_TRUE( (write(2, {100})) );
+
+    auto words = drain();
+    CHECK_EQUAL(2U, words.size());
+    CHECK_EQUAL(0x003D8038UL, words[0]);
+    CHECK_EQUAL(0x643C9029UL, words[1]);
+}
+
+TEST(Midi, OverflowDropsWholeWrite)
+{
+    /* 64 events fill the FIFO, the next write fits nowhere. Running
+    status data pairs count exactly, not by the 4 bytes per byte bound. */
+    std::vector<std::uint8_t> many = {0xB0};
+    for (int i = 0; i < 63; i++)
+    {
+        many.push_back(static_cast<std::uint8_t>(i));
+        many.push_back(0);
+    }
+    CHECK_TRUE( (write(0, many)) );
+    CHECK_TRUE( (write(0, {1, 2})) );
+    CHECK_EQUAL(sizeof(m_fifo), cusb_midi_pending(&m_midi));
+
+    CHECK_FALSE( (write(0, {0xF8})) );
+    CHECK_EQUAL(sizeof(m_fifo), cusb_midi_pending(&m_midi));
+#if (CUSB_CFG_STATS)
+    CHECK_EQUAL(1U, cusb_midi_get_stats(&m_midi)->dropped);
+    CHECK_EQUAL(64U, cusb_midi_get_stats(&m_midi)->events_in);
+#endif
+}
+
+TEST(Midi, UmpChannelVoiceAndSystem)
+{
+    cusb_midi_set_mode(&m_midi, CUSB_MIDI_2_0);
+    CHECK_TRUE( (write(3, {0x92, 60, 100, 0xF8, 0xD2, 9})) );
+
+    auto words = drain();
+    CHECK_EQUAL(3U, words.size());
+    CHECK_EQUAL(0x23923C64UL, words[0]);
+    CHECK_EQUAL(0x13F80000UL, words[1]);
+    CHECK_EQUAL(0x23D20900UL, words[2]);
+}
+
+TEST(Midi, UmpSysEx7)
+{
+    cusb_midi_set_mode(&m_midi, CUSB_MIDI_2_0);
+
+    /* 8 data bytes: start with 6, end with 2. Then an empty message. */
+    CHECK_TRUE( (write(0, {0xF0, 1, 2, 3, 4, 5, 6, 7})) );
+    CHECK_TRUE( (write(0, {8, 0xF7, 0xF0, 0xF7})) );
+
+    auto words = drain();
+    CHECK_EQUAL(6U, words.size());
+    CHECK_EQUAL(0x30160102UL, words[0]);
+    CHECK_EQUAL(0x03040506UL, words[1]);
+    CHECK_EQUAL(0x30320708UL, words[2]);
+    CHECK_EQUAL(0x00000000UL, words[3]);
+    CHECK_EQUAL(0x30000000UL, words[4]);
+    CHECK_EQUAL(0x00000000UL, words[5]);
+}
+
+TEST(Midi, UmpNeverStraddlesPacket)
+{
+    cusb_midi_set_mode(&m_midi, CUSB_MIDI_2_0);
+
+    /* 13 one word UMPs and a 2 word one, then a 4 word one that would
+    cross the 64 byte boundary. */
+    std::vector<std::uint32_t> ump(13, 0x20903C40UL);
+    ump.insert(ump.end(), {0x40903C00UL, 0x80000000UL, 0x50000000UL, 0, 0, 0});
+    CHECK_TRUE( (cusb_midi_write_ump(&m_midi, ump.data(), ump.size(), 0)) );
+
+    auto words = drain();
+    CHECK_EQUAL(20U, words.size());
+    CHECK_EQUAL(0x20903C40UL, words[12]);
+    CHECK_EQUAL(0x40903C00UL, words[13]);
+    CHECK_EQUAL(0x80000000UL, words[14]);
+    CHECK_EQUAL(0U, words[15]);
+    CHECK_EQUAL(0x50000000UL, words[16]);
+}
+
+TEST(Midi, WriteUmpNeeds20Mode)
+{
+    const std::uint32_t ump = 0x20903C40UL;
+    CHECK_THROWS(stubs::assert_exception, cusb_midi_write_ump(&m_midi, &ump, 1, 0));
+}
+
+TEST(Midi, BatchesUntilFullPacket)
+{
+    for (int i = 0; i < 15; i++)
+    {
+        CHECK_TRUE( (write(0, {0xB0, 1, static_cast<std::uint8_t>(i)})) );
+    }
+    CHECK_EQUAL(0, m_app.ready);
+    CHECK_TRUE( (transfer().empty()) );
+
+    CHECK_TRUE( (write(0, {0xB0, 1, 15})) );
+    CHECK_EQUAL(1, m_app.ready);
+    CHECK_EQUAL(16U, transfer().size());
+    CHECK_EQUAL(0U, cusb_midi_pending(&m_midi));
+}
+
+TEST(Midi, LatencyTimerMakesPartialPacketDue)
+{
+    CHECK_TRUE( (write(0, {0x90, 60, 100}, 5000)) );
+    CHECK_TRUE( (write(0, {0x80, 60, 0}, 5500)) );
+
+    cusb_device_run_timers(&m_dev, 5000 + LATENCY - 1);
+    CHECK_EQUAL(0, m_app.ready);
+    CHECK_TRUE( (transfer().empty()) );
+
+    /* The oldest event set the deadline. */
+    cusb_device_run_timers(&m_dev, 5000 + LATENCY);
+    CHECK_EQUAL(1, m_app.ready);
+    CHECK_EQUAL(2U, transfer().size());
+}
+
+TEST(Midi, EventsPileUpBehindTransferInFlight)
+{
+    std::uint8_t buf[PACKET_SIZE];
+    std::size_t len = 0;
+
+    CHECK_TRUE( (write(0, {0x90, 60, 100})) );
+    cusb_midi_flush(&m_midi);
+    CHECK_TRUE( (cusb_midi_bulk_in(&m_midi, buf, sizeof(buf), &len)) );
+    CHECK_EQUAL(4U, len);
+
+    /* In flight: nothing else goes, however due. */
+    CHECK_TRUE( (write(0, {0x91, 61, 100, 0x92, 62, 100}, 100)) );
+    cusb_midi_flush(&m_midi);
+    CHECK_FALSE( (cusb_midi_bulk_in(&m_midi, buf, sizeof(buf), &len)) );
+
+    int before = m_app.ready;
+    cusb_midi_in_complete(&m_midi);
+    CHECK_EQUAL(before + 1, m_app.ready);
+    CHECK_TRUE( (cusb_midi_bulk_in(&m_midi, buf, sizeof(buf), &len)) );
+    CHECK_EQUAL(8U, len);
+}
+
+TEST(Midi, ZeroLatencySendsWhenIdle)
+{
+    cusb_midi_ctor(&m_midi, &API, &m_app, m_fifo, sizeof(m_fifo), 1, PACKET_SIZE, nullptr, 0);
+
+    CHECK_TRUE( (write(0, {0xF8})) );
+    CHECK_EQUAL(1, m_app.ready);
+    CHECK_EQUAL(1U, transfer().size());
+}
+
+TEST(Midi, FlushSendsNow)
+{
+    CHECK_TRUE( (write(0, {0xFA})) );
+    CHECK_EQUAL(0, m_app.ready);
+    cusb_midi_flush(&m_midi);
+    CHECK_EQUAL(1, m_app.ready);
+    CHECK_EQUAL(1U, transfer().size());
+
+    /* Timer was stopped with the FIFO empty. */
+    cusb_device_run_timers(&m_dev, LATENCY);
+    CHECK_EQUAL(1, m_app.ready);
+}
+
+TEST(Midi, BulkOutBatchesBytesPerCable)
+{
+    const std::uint8_t pkt[] =
+    {
+        0x09, 0x90, 60, 100,
+        0x0F, 0xF8, 0, 0,
+        0x19, 0x91, 61, 100,
+        0x00, 0, 0, 0,
+        0x18, 0x81, 61, 0,
+        0x55, 0xF6, 0, 0,
+    };
+    cusb_midi_bulk_out(&m_midi, pkt, sizeof(pkt));
+
+    CHECK_EQUAL(2U, m_app.received.size());
+    CHECK_EQUAL(0, m_app.cables[0]);
+    CHECK_TRUE( (m_app.received[0] == std::vector<std::uint8_t>({0x90, 60, 100, 0xF8})) );
+    CHECK_EQUAL(1, m_app.cables[1]);
+    CHECK_TRUE( (m_app.received[1] == std::vector<std::uint8_t>({0x91, 61, 100, 0x81, 61, 0})) );
+}
+
+TEST(Midi, BulkOutUmpSkipsNoops)
+{
+    cusb_midi_set_mode(&m_midi, CUSB_MIDI_2_0);
+
+    const std::uint8_t pkt[] =
+    {
+        0x64, 0x3C, 0x90, 0x20,
+        0, 0, 0, 0,
+        0x00, 0x3C, 0x90, 0x40, 0x00, 0x00, 0x00, 0x80,
+        0x00, 0x00, 0x00, 0x30,
+    };
+    cusb_midi_bulk_out(&m_midi, pkt, sizeof(pkt));
+
+    CHECK_EQUAL(2U, m_app.umps.size());
+    CHECK_TRUE( (m_app.umps[0] == std::vector<std::uint32_t>({0x20903C64UL})) );
+    CHECK_TRUE( (m_app.umps[1] == std::vector<std::uint32_t>({0x40903C00UL, 0x80000000UL})) );
+}
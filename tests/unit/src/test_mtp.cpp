@@ -0,0 +1,489 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref mtp.h
+ *
+ * Test Summary:
+ *
+ * cusb_mtp_object_add(), cusb_mtp_object_remove(), cusb_mtp_object_find()
+ *      - TEST(Mtp, ObjectTableFull)
+ *      - TEST(Mtp, StaleHandleRejected)
+ *
+ * cusb_mtp_bulk_out(), cusb_mtp_bulk_in()
+ *      - TEST(Mtp, OperationsRequireSession)
+ *      - TEST(Mtp, GetDeviceInfo)
+ *      - TEST(Mtp, GetObjectHandlesSpansPackets)
+ *      - TEST(Mtp, GetObjectStreamsPacketChunks)
+ *      - TEST(Mtp, GetObjectSendsZlpOnPacketMultiple)
+ *      - TEST(Mtp, GetPartialObject)
+ *      - TEST(Mtp, SendObjectInfoThenSendObject)
+ *      - TEST(Mtp, DeleteFolderWithChildrenDenied)
+ *      - TEST(Mtp, ShortPacketIsIncompleteTransfer)
+ *      - TEST(Mtp, ContainerLengthBelowHeaderDecodesNoParams)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/mtp.h"
+
+/* STDLib. */
+#include <cstring>
+#include <string>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::size_t PACKET_SIZE = 64;
+
+/**
+ * @brief In-memory storage backend that records every access.
+ */
+struct fake_store
+{
+    struct file
+    {
+        std::string name;
+        std::vector<std::uint8_t> data;
+        bool exists;
+    };
+
+    std::vector<file> files;
+    std::vector<std::size_t> read_sizes;
+    std::vector<std::size_t> write_sizes;
+
+    static fake_store &self(void *ctx)
+    {
+        return *static_cast<fake_store *>(ctx);
+    }
+
+    static std::size_t read(void *ctx, std::uint32_t cookie, std::uint32_t offset, std::uint8_t *buf, std::size_t len)
+    {
+        auto &f = self(ctx).files.at(cookie);
+        self(ctx).read_sizes.push_back(len);
+        std::size_t n = std::min(len, f.data.size() - offset);
+        std::memcpy(buf, f.data.data() + offset, n);
+        return n;
+    }
+
+    static bool write(void *ctx, std::uint32_t cookie, std::uint32_t offset, const std::uint8_t *buf, std::size_t len)
+    {
+        auto &f = self(ctx).files.at(cookie);
+        self(ctx).write_sizes.push_back(len);
+        if (f.data.size() < offset + len)
+        {
+            f.data.resize(offset + len);
+        }
+        std::memcpy(f.data.data() + offset, buf, len);
+        return true;
+    }
+
+    static bool create(void *ctx, const struct cusb_mtp_object_info *info, std::uint32_t *cookie)
+    {
+        self(ctx).files.push_back({info->filename, {}, true});
+        *cookie = static_cast<std::uint32_t>(self(ctx).files.size() - 1);
+        return true;
+    }
+
+    static bool remove(void *ctx, std::uint32_t cookie)
+    {
+        self(ctx).files.at(cookie).exists = false;
+        return true;
+    }
+
+    static void filename(void *ctx, std::uint32_t cookie, char *buf, std::size_t size)
+    {
+        std::strncpy(buf, self(ctx).files.at(cookie).name.c_str(), size);
+    }
+
+    static void capacity(void *, std::uint64_t *max, std::uint64_t *free_bytes)
+    {
+        *max = 1000000;
+        *free_bytes = 500000;
+    }
+};
+
+const struct cusb_mtp_store_api STORE_API =
+{
+    &fake_store::read, &fake_store::write, &fake_store::create,
+    &fake_store::remove, &fake_store::filename, &fake_store::capacity
+};
+
+const struct cusb_mtp_strings STRINGS =
+{
+    "cusb", "test device", "1.0", "0001", "Internal"
+};
+
+std::uint32_t le32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24));
+}
+
+std::uint16_t le16(const std::uint8_t *p)
+{
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+
+void put_le32(std::vector<std::uint8_t> &v, std::uint32_t val)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        v.push_back(static_cast<std::uint8_t>(val >> (8 * i)));
+    }
+}
+
+void put_le16(std::vector<std::uint8_t> &v, std::uint16_t val)
+{
+    v.push_back(static_cast<std::uint8_t>(val));
+    v.push_back(static_cast<std::uint8_t>(val >> 8));
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Mtp)
+{
+    void setup() override
+    {
+        cusb_mtp_ctor(&m_mtp, &STORE_API, &m_store, &STRINGS, m_objects, 32,
+                      m_scratch, sizeof(m_scratch), PACKET_SIZE);
+    }
+
+    /**
+     * @brief Host sends a command container.
+     */
+    void command(std::uint16_t code, std::vector<std::uint32_t> params = {})
+    {
+        std::vector<std::uint8_t> pkt;
+        put_le32(pkt, static_cast<std::uint32_t>(12 + 4 * params.size()));
+        put_le16(pkt, 1);
+        put_le16(pkt, code);
+        put_le32(pkt, ++m_tid);
+        for (auto p : params)
+        {
+            put_le32(pkt, p);
+        }
+        cusb_mtp_bulk_out(&m_mtp, pkt.data(), pkt.size());
+    }
+
+    /**
+     * @brief Host sends a data phase split into packets.
+     */
+    void send_data(std::uint16_t code, const std::vector<std::uint8_t> &payload)
+    {
+        std::vector<std::uint8_t> all;
+        put_le32(all, static_cast<std::uint32_t>(12 + payload.size()));
+        put_le16(all, 2);
+        put_le16(all, code);
+        put_le32(all, m_tid);
+        all.insert(all.end(), payload.begin(), payload.end());
+
+        for (std::size_t off = 0; off < all.size(); off += PACKET_SIZE)
+        {
+            cusb_mtp_bulk_out(&m_mtp, &all[off], std::min(PACKET_SIZE, all.size() - off));
+        }
+    }
+
+    /**
+     * @brief Host reads IN packets until a response arrives. Returns
+     * response code. Data phase payload (without header) is stored in m_data.
+     */
+    std::uint16_t read_response()
+    {
+        std::uint8_t pkt[PACKET_SIZE];
+        std::size_t len = 0;
+        m_data.clear();
+        m_packets = 0;
+        m_zlp = false;
+        m_in_data = false;
+
+        while (cusb_mtp_bulk_in(&m_mtp, pkt, sizeof(pkt), &len))
+        {
+            m_packets++;
+            if (len == 0)
+            {
+                m_zlp = true;
+                m_in_data = false;
+                continue;
+            }
+
+            if (m_in_data)
+            {
+                m_data.insert(m_data.end(), pkt, pkt + len);
+                m_in_data = (len == PACKET_SIZE);
+                continue;
+            }
+
+            std::uint16_t type = le16(&pkt[4]);
+            if (type == 2)
+            {
+                m_data.insert(m_data.end(), pkt + 12, pkt + len);
+                m_in_data = (len == PACKET_SIZE);
+            }
+            else if (type == 3)
+            {
+                m_resp_params.clear();
+                for (std::size_t i = 12; i < len; i += 4)
+                {
+                    m_resp_params.push_back(le32(&pkt[i]));
+                }
+                return le16(&pkt[6]);
+            }
+        }
+
+        FAIL("No response");
+        return 0;
+    }
+
+    std::uint32_t add_file(const char *name, std::size_t size, std::uint32_t parent = CUSB_MTP_ROOT_HANDLE,
+                           std::uint16_t format = CUSB_MTP_FORMAT_UNDEFINED)
+    {
+        std::vector<std::uint8_t> data(size);
+        for (std::size_t i = 0; i < size; i++)
+        {
+            data[i] = static_cast<std::uint8_t>(i * 7);
+        }
+        m_store.files.push_back({name, data, true});
+        struct cusb_mtp_object_info info = {format, parent, static_cast<std::uint32_t>(size), name};
+        return cusb_mtp_object_add(&m_mtp, static_cast<std::uint32_t>(m_store.files.size() - 1), &info);
+    }
+
+    void open_session()
+    {
+        command(0x1002, {1});
+        LONGS_EQUAL(0x2001, read_response());
+    }
+
+    struct cusb_mtp m_mtp;
+    struct cusb_mtp_object m_objects[32];
+    std::uint8_t m_scratch[512];
+    fake_store m_store;
+    std::uint32_t m_tid = 0;
+    std::vector<std::uint8_t> m_data;
+    std::vector<std::uint32_t> m_resp_params;
+    std::size_t m_packets = 0;
+    bool m_zlp = false;
+    bool m_in_data = false;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Mtp, ObjectTableFull)
+{
+    for (int i = 0; i < 32; i++)
+    {
+        CHECK_TRUE( (add_file("f", 1) != CUSB_MTP_INVALID_HANDLE) );
+    }
+
+    UNSIGNED_LONGS_EQUAL(CUSB_MTP_INVALID_HANDLE, add_file("f", 1));
+}
+
+TEST(Mtp, StaleHandleRejected)
+{
+    std::uint32_t h1 = add_file("a", 1);
+    CHECK_TRUE( (cusb_mtp_object_remove(&m_mtp, h1)) );
+    std::uint32_t h2 = add_file("b", 1);
+
+    /* Same slot is reused with a different generation. */
+    UNSIGNED_LONGS_EQUAL(h1 & 0xFFFFU, h2 & 0xFFFFU);
+    CHECK_TRUE( (h1 != h2) );
+    POINTERS_EQUAL(nullptr, cusb_mtp_object_find(&m_mtp, h1));
+    CHECK_TRUE( (cusb_mtp_object_find(&m_mtp, h2) != nullptr) );
+    POINTERS_EQUAL(nullptr, cusb_mtp_object_find(&m_mtp, 0));
+    POINTERS_EQUAL(nullptr, cusb_mtp_object_find(&m_mtp, 0xFFFFFFFFUL));
+}
+
+TEST(Mtp, OperationsRequireSession)
+{
+    command(0x1004);
+    LONGS_EQUAL(0x2003, read_response());
+    open_session();
+    command(0x1002, {2});
+    LONGS_EQUAL(0x201E, read_response());
+}
+
+TEST(Mtp, GetDeviceInfo)
+{
+    command(0x1001);
+    LONGS_EQUAL(0x2001, read_response());
+    LONGS_EQUAL(100, le16(&m_data[0]));
+    UNSIGNED_LONGS_EQUAL(6, le32(&m_data[2]));
+    CHECK_TRUE( (m_packets > 2) );
+}
+
+TEST(Mtp, GetObjectHandlesSpansPackets)
+{
+    std::vector<std::uint32_t> handles;
+    for (int i = 0; i < 30; i++)
+    {
+        handles.push_back(add_file("f", 4));
+    }
+
+    open_session();
+    command(0x1007, {0xFFFFFFFFUL, 0, 0});
+    LONGS_EQUAL(0x2001, read_response());
+    UNSIGNED_LONGS_EQUAL(4 + 4 * 30, m_data.size());
+    UNSIGNED_LONGS_EQUAL(30, le32(&m_data[0]));
+
+    for (std::size_t i = 0; i < 30; i++)
+    {
+        UNSIGNED_LONGS_EQUAL(handles[i], le32(&m_data[4 + 4 * i]));
+    }
+}
+
+TEST(Mtp, GetObjectStreamsPacketChunks)
+{
+    std::uint32_t h = add_file("big.bin", 1000);
+    open_session();
+    m_store.read_sizes.clear();
+    command(0x1009, {h});
+    LONGS_EQUAL(0x2001, read_response());
+    CHECK_TRUE( (m_data == m_store.files[0].data) );
+
+    /* First read fills the rest of the packet after the header. Later ones are whole packets. */
+    UNSIGNED_LONGS_EQUAL(PACKET_SIZE - 12, m_store.read_sizes[0]);
+    for (std::size_t i = 1; i + 1 < m_store.read_sizes.size(); i++)
+    {
+        UNSIGNED_LONGS_EQUAL(PACKET_SIZE, m_store.read_sizes[i]);
+    }
+}
+
+TEST(Mtp, GetObjectSendsZlpOnPacketMultiple)
+{
+    std::uint32_t h = add_file("a", PACKET_SIZE * 2 - 12);
+    open_session();
+    command(0x1009, {h});
+    LONGS_EQUAL(0x2001, read_response());
+    CHECK_TRUE( (m_zlp) );
+    UNSIGNED_LONGS_EQUAL(PACKET_SIZE * 2 - 12, m_data.size());
+}
+
+TEST(Mtp, GetPartialObject)
+{
+    std::uint32_t h = add_file("a", 300);
+    open_session();
+    command(0x101B, {h, 250, 100});
+    LONGS_EQUAL(0x2001, read_response());
+    UNSIGNED_LONGS_EQUAL(50, m_data.size());
+    UNSIGNED_LONGS_EQUAL(50, m_resp_params.at(0));
+    BYTES_EQUAL(250 * 7, m_data[0]);
+}
+
+TEST(Mtp, SendObjectInfoThenSendObject)
+{
+    open_session();
+
+    std::vector<std::uint8_t> info(52, 0);
+    info[4] = 0x00;
+    info[5] = 0x30;
+    info[8] = 200;
+    const char name[] = "new.txt";
+    info.push_back(sizeof(name));
+    for (char c : name)
+    {
+        put_le16(info, static_cast<std::uint16_t>(c));
+    }
+    info.push_back(0);
+    info.push_back(0);
+    info.push_back(0);
+
+    command(0x100C, {CUSB_MTP_STORAGE_ID, 0xFFFFFFFFUL});
+    send_data(0x100C, info);
+    LONGS_EQUAL(0x2001, read_response());
+    std::uint32_t h = m_resp_params.at(2);
+    STRCMP_EQUAL("new.txt", m_store.files.at(0).name.c_str());
+
+    std::vector<std::uint8_t> payload(200);
+    for (std::size_t i = 0; i < payload.size(); i++)
+    {
+        payload[i] = static_cast<std::uint8_t>(i);
+    }
+
+    command(0x100D);
+    send_data(0x100D, payload);
+    LONGS_EQUAL(0x2001, read_response());
+    CHECK_TRUE( (m_store.files.at(0).data == payload) );
+    UNSIGNED_LONGS_EQUAL(200, cusb_mtp_object_find(&m_mtp, h)->size);
+
+    /* Written straight from each packet. Never more than one packet at a time. */
+    for (std::size_t n : m_store.write_sizes)
+    {
+        CHECK_TRUE( (n <= PACKET_SIZE) );
+    }
+}
+
+TEST(Mtp, DeleteFolderWithChildrenDenied)
+{
+    std::uint32_t folder = add_file("dir", 0, CUSB_MTP_ROOT_HANDLE, CUSB_MTP_FORMAT_ASSOCIATION);
+    std::uint32_t child = add_file("f", 1, folder);
+    open_session();
+    command(0x100B, {folder});
+    LONGS_EQUAL(0x200F, read_response());
+    command(0x100B, {child});
+    LONGS_EQUAL(0x2001, read_response());
+    command(0x100B, {folder});
+    LONGS_EQUAL(0x2001, read_response());
+    POINTERS_EQUAL(nullptr, cusb_mtp_object_find(&m_mtp, folder));
+}
+
+TEST(Mtp, ShortPacketIsIncompleteTransfer)
+{
+    std::uint32_t h = add_file("a", 0);
+    (void)h;
+    open_session();
+
+    std::vector<std::uint8_t> info(60, 0);
+    command(0x100C, {CUSB_MTP_STORAGE_ID, 0});
+    send_data(0x100C, info);
+    LONGS_EQUAL(0x2001, read_response());
+
+    /* Header claims 1000 bytes but host stops after one short packet. */
+    std::vector<std::uint8_t> pkt;
+    put_le32(pkt, 1012);
+    put_le16(pkt, 2);
+    put_le16(pkt, 0x100D);
+    put_le32(pkt, m_tid);
+    pkt.resize(20);
+    command(0x100D);
+    cusb_mtp_bulk_out(&m_mtp, pkt.data(), pkt.size());
+    LONGS_EQUAL(0x2007, read_response());
+}
+
+TEST(Mtp, ContainerLengthBelowHeaderDecodesNoParams)
+{
+    /* OpenSession with a session ID in the packet but length fields
+    that do not cover it. Without the ID the request is invalid. */
+    for (std::uint32_t length : {0U, 11U})
+    {
+        std::vector<std::uint8_t> pkt;
+        put_le32(pkt, length);
+        put_le16(pkt, 1);
+        put_le16(pkt, 0x1002);
+        put_le32(pkt, ++m_tid);
+        put_le32(pkt, 7);
+
+        cusb_mtp_bulk_out(&m_mtp, pkt.data(), pkt.size());
+        LONGS_EQUAL(0, m_mtp.cmd.nparams);
+        UNSIGNED_LONGS_EQUAL(0, m_mtp.cmd.params[0]);
+        LONGS_EQUAL(0x201D, read_response());
+    }
+}
@@ -0,0 +1,158 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref pktpool.h
+ *
+ * Test Summary:
+ *
+ * cusb_pktpool_alloc(), cusb_pktpool_release()
+ *      - TEST(Pktpool, AllocUntilEmpty)
+ *      - TEST(Pktpool, BuffersDoNotOverlap)
+ *      - TEST(Pktpool, LastReferenceFrees)
+ *      - TEST(Pktpool, LowWaterMark)
+ *      - TEST(Pktpool, ReleaseOfFreeBufferAsserts)
+ *
+ * cusb_pktq_push(), cusb_pktq_pop()
+ *      - TEST(Pktpool, QueueIsFifo)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/pktpool.h"
+
+/* STDLib. */
+#include <cstring>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint16_t COUNT = 4;
+constexpr std::uint32_t SIZE = 128;
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Pktpool)
+{
+    void setup() override
+    {
+        cusb_pktpool_ctor(&m_pool, m_pkts, reinterpret_cast<std::uint8_t *>(m_mem), COUNT, SIZE);
+    }
+
+    struct cusb_pktpool m_pool;
+    struct cusb_pkt m_pkts[COUNT];
+    std::uint32_t m_mem[COUNT * SIZE / 4];
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Pktpool, AllocUntilEmpty)
+{
+    CHECK_EQUAL(COUNT, cusb_pktpool_available(&m_pool));
+    CHECK_EQUAL(SIZE, cusb_pktpool_size(&m_pool));
+
+    for (std::uint16_t i = 0; i < COUNT; i++)
+    {
+        CHECK_TRUE( (cusb_pktpool_alloc(&m_pool) != nullptr) );
+    }
+
+    CHECK_EQUAL(0, cusb_pktpool_available(&m_pool));
+    POINTERS_EQUAL(nullptr, cusb_pktpool_alloc(&m_pool));
+}
+
+TEST(Pktpool, BuffersDoNotOverlap)
+{
+    struct cusb_pkt *pkts[COUNT];
+
+    for (std::uint16_t i = 0; i < COUNT; i++)
+    {
+        pkts[i] = cusb_pktpool_alloc(&m_pool);
+        CHECK_EQUAL(0U, pkts[i]->len);
+        CHECK_EQUAL(0U, reinterpret_cast<std::uintptr_t>(pkts[i]->buf) % 4U);
+        std::memset(pkts[i]->buf, i + 1, SIZE);
+    }
+
+    for (std::uint16_t i = 0; i < COUNT; i++)
+    {
+        CHECK_EQUAL(i + 1, pkts[i]->buf[0]);
+        CHECK_EQUAL(i + 1, pkts[i]->buf[SIZE - 1]);
+    }
+}
+
+TEST(Pktpool, LastReferenceFrees)
+{
+    struct cusb_pkt *pkt = cusb_pktpool_alloc(&m_pool);
+    cusb_pktpool_ref(&m_pool, pkt);
+    cusb_pktpool_ref(&m_pool, pkt);
+
+    cusb_pktpool_release(&m_pool, pkt);
+    cusb_pktpool_release(&m_pool, pkt);
+    CHECK_EQUAL(COUNT - 1, cusb_pktpool_available(&m_pool));
+
+    cusb_pktpool_release(&m_pool, pkt);
+    CHECK_EQUAL(COUNT, cusb_pktpool_available(&m_pool));
+
+    /* Back at the front of the free list. */
+    POINTERS_EQUAL(pkt, cusb_pktpool_alloc(&m_pool));
+}
+
+TEST(Pktpool, LowWaterMark)
+{
+    struct cusb_pkt *a = cusb_pktpool_alloc(&m_pool);
+    struct cusb_pkt *b = cusb_pktpool_alloc(&m_pool);
+    cusb_pktpool_release(&m_pool, a);
+    cusb_pktpool_release(&m_pool, b);
+
+    CHECK_EQUAL(COUNT, cusb_pktpool_available(&m_pool));
+    CHECK_EQUAL(COUNT - 2, cusb_pktpool_low_water(&m_pool));
+}
+
+TEST(Pktpool, ReleaseOfFreeBufferAsserts)
+{
+    struct cusb_pkt *pkt = cusb_pktpool_alloc(&m_pool);
+    cusb_pktpool_release(&m_pool, pkt);
+
+    CHECK_THROWS(stubs::assert_exception, cusb_pktpool_release(&m_pool, pkt));
+}
+
+TEST(Pktpool, QueueIsFifo)
+{
+    struct cusb_pktq q;
+    cusb_pktq_ctor(&q);
+    CHECK_TRUE( (cusb_pktq_empty(&q)) );
+
+    struct cusb_pkt *a = cusb_pktpool_alloc(&m_pool);
+    struct cusb_pkt *b = cusb_pktpool_alloc(&m_pool);
+    cusb_pktq_push(&q, a);
+    cusb_pktq_push(&q, b);
+    CHECK_FALSE( (cusb_pktq_empty(&q)) );
+
+    POINTERS_EQUAL(a, cusb_pktq_pop(&q));
+    POINTERS_EQUAL(b, cusb_pktq_pop(&q));
+    POINTERS_EQUAL(nullptr, cusb_pktq_pop(&q));
+    CHECK_TRUE( (cusb_pktq_empty(&q)) );
+
+    /* Still usable after draining. */
+    cusb_pktq_push(&q, b);
+    POINTERS_EQUAL(b, cusb_pktq_pop(&q));
+}
@@ -0,0 +1,217 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref ptybridge.h
+ *
+ * Test Summary:
+ *
+ * cusb_ptybridge_open(), cusb_ptybridge_close()
+ *      - TEST(PtyBridge, LinkPointsAtSlave)
+ *
+ * cusb_ptybridge_poll()
+ *      - TEST(PtyBridge, DeviceToHostInBatches)
+ *      - TEST(PtyBridge, HostToDeviceInBatches)
+ *      - TEST(PtyBridge, FullOutPipeLeavesDataInPty)
+ *      - TEST(PtyBridge, PollTimesOutWhenIdle)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/ptybridge.h"
+
+/* STDLib. */
+#include <cstring>
+#include <vector>
+
+/* POSIX. */
+#include <fcntl.h>
+#include <unistd.h>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint16_t PACKET_SIZE = 64;
+constexpr std::size_t BUFFER_SIZE = 4096;
+constexpr const char *LINK = "/tmp/cusb_ptybridge_test";
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(PtyBridge)
+{
+    void setup() override
+    {
+        cusb_stream_ctor(&m_in, CUSB_STREAM_IN, m_in_buf, sizeof(m_in_buf), PACKET_SIZE);
+        cusb_stream_ctor(&m_out, CUSB_STREAM_OUT, m_out_buf, sizeof(m_out_buf), PACKET_SIZE);
+        CHECK_TRUE( (cusb_ptybridge_open(&m_bridge, &m_in, &m_out, LINK)) );
+
+        /* Plays the host program. */
+        m_host = open(LINK, O_RDWR | O_NOCTTY | O_NONBLOCK);
+        CHECK_TRUE( (m_host >= 0) );
+    }
+
+    void teardown() override
+    {
+        close(m_host);
+        cusb_ptybridge_close(&m_bridge);
+    }
+
+    /**
+     * @brief Device sends @p len bytes of a pattern and flushes.
+     */
+    void device_send(std::size_t len)
+    {
+        struct cusb_stream_iov iov[2];
+        CHECK_TRUE( (cusb_stream_write_space(&m_in, iov) >= len) );
+
+        for (std::size_t i = 0; i < len; i++)
+        {
+            iov[0].base[i] = static_cast<std::uint8_t>(i * 3U);
+        }
+
+        cusb_stream_write_commit(&m_in, len);
+        cusb_stream_flush(&m_in);
+    }
+
+    /**
+     * @brief Drains what the device received.
+     */
+    std::vector<std::uint8_t> device_receive()
+    {
+        struct cusb_stream_iov iov[2];
+        std::vector<std::uint8_t> data;
+        std::size_t n = cusb_stream_read_data(&m_out, iov);
+
+        data.insert(data.end(), iov[0].base, iov[0].base + iov[0].len);
+        data.insert(data.end(), iov[1].base, iov[1].base + iov[1].len);
+        cusb_stream_read_release(&m_out, n);
+        return data;
+    }
+
+    std::vector<std::uint8_t> host_read()
+    {
+        std::vector<std::uint8_t> data;
+        std::uint8_t buf[1024];
+        ssize_t n;
+
+        while ((n = read(m_host, buf, sizeof(buf))) > 0)
+        {
+            data.insert(data.end(), buf, buf + n);
+        }
+
+        return data;
+    }
+
+    void host_write(std::size_t len)
+    {
+        std::vector<std::uint8_t> data(len);
+
+        for (std::size_t i = 0; i < len; i++)
+        {
+            data[i] = static_cast<std::uint8_t>(i * 5U);
+        }
+
+        CHECK_TRUE( (write(m_host, data.data(), len) == static_cast<ssize_t>(len)) );
+    }
+
+    struct cusb_stream m_in;
+    struct cusb_stream m_out;
+    std::uint8_t m_in_buf[BUFFER_SIZE];
+    std::uint8_t m_out_buf[BUFFER_SIZE];
+    struct cusb_ptybridge m_bridge;
+    int m_host = -1;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(PtyBridge, LinkPointsAtSlave)
+{
+    char target[CUSB_PTYBRIDGE_NAME_MAX] = {0};
+    CHECK_TRUE( (readlink(LINK, target, sizeof(target) - 1) > 0) );
+    STRCMP_EQUAL(cusb_ptybridge_name(&m_bridge), target);
+
+    struct cusb_ptybridge other;
+    CHECK_TRUE( (cusb_ptybridge_open(&other, nullptr, nullptr, "/tmp/cusb_ptybridge_other")) );
+    cusb_ptybridge_close(&other);
+    CHECK_TRUE( (access("/tmp/cusb_ptybridge_other", F_OK) != 0) );
+}
+
+TEST(PtyBridge, DeviceToHostInBatches)
+{
+    device_send(3000);
+    UNSIGNED_LONGS_EQUAL(3000, cusb_ptybridge_poll(&m_bridge, 0));
+
+    std::vector<std::uint8_t> data = host_read();
+    LONGS_EQUAL(3000, data.size());
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        BYTES_EQUAL(static_cast<std::uint8_t>(i * 3U), data[i]);
+    }
+
+    UNSIGNED_LONGS_EQUAL(3000, cusb_ptybridge_get_stats(&m_bridge)->to_host);
+    CHECK_TRUE( (cusb_ptybridge_get_stats(&m_bridge)->syscalls <= 2) );
+}
+
+TEST(PtyBridge, HostToDeviceInBatches)
+{
+    host_write(2500);
+    UNSIGNED_LONGS_EQUAL(2500, cusb_ptybridge_poll(&m_bridge, 100));
+
+    std::vector<std::uint8_t> data = device_receive();
+    LONGS_EQUAL(2500, data.size());
+    for (std::size_t i = 0; i < data.size(); i++)
+    {
+        BYTES_EQUAL(static_cast<std::uint8_t>(i * 5U), data[i]);
+    }
+
+    UNSIGNED_LONGS_EQUAL(2500, cusb_ptybridge_get_stats(&m_bridge)->from_host);
+    CHECK_TRUE( (cusb_ptybridge_get_stats(&m_bridge)->syscalls <= 2) );
+}
+
+TEST(PtyBridge, FullOutPipeLeavesDataInPty)
+{
+    host_write(BUFFER_SIZE + 1000);
+
+    while (cusb_ptybridge_poll(&m_bridge, 100) != 0)
+    {
+    }
+
+    /* Pipe full: the rest waits in the pty. */
+    std::vector<std::uint8_t> data = device_receive();
+    std::size_t first = data.size();
+    CHECK_TRUE( (first <= BUFFER_SIZE) );
+
+    while (cusb_ptybridge_poll(&m_bridge, 100) != 0)
+    {
+    }
+
+    std::vector<std::uint8_t> rest = device_receive();
+    LONGS_EQUAL(BUFFER_SIZE + 1000, first + rest.size());
+    BYTES_EQUAL(static_cast<std::uint8_t>(first * 5U), rest[0]);
+}
+
+TEST(PtyBridge, PollTimesOutWhenIdle)
+{
+    UNSIGNED_LONGS_EQUAL(0, cusb_ptybridge_poll(&m_bridge, 0));
+    UNSIGNED_LONGS_EQUAL(0, cusb_ptybridge_poll(&m_bridge, 1));
+}
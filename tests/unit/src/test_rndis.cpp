@@ -0,0 +1,562 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref rndis.h
+ *
+ * Test Summary:
+ *
+ * cusb_rndis_control(), cusb_rndis_control_out()
+ *      - TEST(Rndis, InitializeCompletes)
+ *      - TEST(Rndis, QueryAddressAndSupportedList)
+ *      - TEST(Rndis, QueryUnknownOidNotSupported)
+ *      - TEST(Rndis, PacketFilterEnablesDataPath)
+ *      - TEST(Rndis, KeepaliveAndReset)
+ *      - TEST(Rndis, HaltStopsDataPath)
+ *      - TEST(Rndis, NothingPendingAnswersZeroByte)
+ *      - TEST(Rndis, LinkChangeIndicated)
+ *
+ * cusb_rndis_rx_arm(), cusb_rndis_bulk_out()
+ *      - TEST(Rndis, RxFrameDeliveredInPlace)
+ *      - TEST(Rndis, RxManyPacketsPerTransfer)
+ *      - TEST(Rndis, RxMalformedMessageStopsTransfer)
+ *
+ * cusb_rndis_tx_alloc(), cusb_rndis_tx_commit(), cusb_rndis_bulk_in()
+ *      - TEST(Rndis, TxFramesBatchWhileBusy)
+ *      - TEST(Rndis, TxAvoidsPacketMultiple)
+ *      - TEST(Rndis, TxSplitsAtHostTransferSize)
+ *      - TEST(Rndis, TxDroppedBeforeFilterSet)
+ *
+ * cusb_rndis_reset()
+ *      - TEST(Rndis, ResetReturnsEveryBuffer)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/rndis.h"
+
+/* STDLib. */
+#include <cstring>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint16_t PACKET_SIZE = 64;
+constexpr std::uint16_t BUFFERS = 4;
+constexpr std::uint32_t BUFFER_SIZE = 4096;
+constexpr std::uint32_t OID_GEN_SUPPORTED_LIST = 0x00010101UL;
+constexpr std::uint32_t OID_GEN_CURRENT_PACKET_FILTER = 0x0001010EUL;
+constexpr std::uint32_t OID_GEN_MEDIA_CONNECT_STATUS = 0x00010114UL;
+constexpr std::uint32_t OID_802_3_PERMANENT_ADDRESS = 0x01010101UL;
+
+const std::uint8_t MAC[6] = {0x02, 0x00, 0x00, 0x12, 0x34, 0x56};
+
+/**
+ * @brief Network stack model. Keeps the frames it receives, and
+ * releases them when asked.
+ */
+struct app
+{
+    int notifications = 0;
+    int ready = 0;
+    struct cusb_pktpool *pool = nullptr;
+    bool keep = false;
+    std::vector<struct cusb_pkt *> held;
+    std::vector<std::vector<std::uint8_t>> frames;
+    std::vector<const std::uint8_t *> where;
+
+    static app &self(void *ctx)
+    {
+        return *static_cast<app *>(ctx);
+    }
+
+    static void receive(void *ctx, struct cusb_pkt *pkt, std::uint8_t *frame, std::uint32_t len)
+    {
+        self(ctx).frames.emplace_back(frame, frame + len);
+        self(ctx).where.push_back(frame);
+
+        if (self(ctx).keep)
+        {
+            self(ctx).held.push_back(pkt);
+        }
+        else
+        {
+            cusb_pktpool_release(self(ctx).pool, pkt);
+        }
+    }
+
+    static void notify(void *ctx)
+    {
+        self(ctx).notifications++;
+    }
+
+    static void on_ready(void *ctx)
+    {
+        self(ctx).ready++;
+    }
+};
+
+const struct cusb_rndis_api API = {&app::receive, &app::notify, &app::on_ready};
+
+void put32(std::vector<std::uint8_t> &v, std::uint32_t value)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        v.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+}
+
+std::uint32_t le32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24));
+}
+
+/**
+ * @brief Control message of @p type with @p words after MessageLength.
+ */
+std::vector<std::uint8_t> message(std::uint32_t type, const std::vector<std::uint32_t> &words)
+{
+    std::vector<std::uint8_t> msg;
+    put32(msg, type);
+    put32(msg, static_cast<std::uint32_t>(8 + 4 * words.size()));
+    for (std::uint32_t w : words)
+    {
+        put32(msg, w);
+    }
+    return msg;
+}
+
+/**
+ * @brief Packet message carrying @p frame, padded to @p pad bytes.
+ */
+std::vector<std::uint8_t> packet(const std::vector<std::uint8_t> &frame, std::size_t pad = 0)
+{
+    std::vector<std::uint8_t> msg;
+    std::size_t len = 44 + frame.size() + pad;
+    put32(msg, 1);
+    put32(msg, static_cast<std::uint32_t>(len));
+    put32(msg, 36);
+    put32(msg, static_cast<std::uint32_t>(frame.size()));
+    msg.resize(44, 0);
+    msg.insert(msg.end(), frame.begin(), frame.end());
+    msg.resize(len, 0);
+    return msg;
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Rndis)
+{
+    void setup() override
+    {
+        cusb_pktpool_ctor(&m_pool, m_pkts, reinterpret_cast<std::uint8_t *>(m_mem), BUFFERS, BUFFER_SIZE);
+        m_app.pool = &m_pool;
+        cusb_rndis_ctor(&m_rndis, &API, &m_app, &m_pool, MAC, PACKET_SIZE);
+    }
+
+    /**
+     * @brief Sends a control message the way the device core does.
+     */
+    bool send(const std::vector<std::uint8_t> &msg)
+    {
+        const std::uint8_t setup[8] = {0x21, 0x00, 0, 0, 0, 0,
+                                       static_cast<std::uint8_t>(msg.size()),
+                                       static_cast<std::uint8_t>(msg.size() >> 8)};
+        std::uint8_t *data = nullptr;
+        std::uint16_t len = 0;
+
+        if (!cusb_rndis_control(&m_rndis, setup, &data, &len))
+        {
+            return false;
+        }
+
+        CHECK_TRUE( (len >= msg.size()) );
+        std::memcpy(data, msg.data(), msg.size());
+        return cusb_rndis_control_out(&m_rndis, setup, data, static_cast<std::uint16_t>(msg.size()));
+    }
+
+    /**
+     * @brief Fetches the response.
+     */
+    std::vector<std::uint8_t> get()
+    {
+        const std::uint8_t setup[8] = {0xA1, 0x01, 0, 0, 0, 0, 0x00, 0x04};
+        std::uint8_t *data = nullptr;
+        std::uint16_t len = 0;
+
+        CHECK_TRUE( (cusb_rndis_control(&m_rndis, setup, &data, &len)) );
+        return std::vector<std::uint8_t>(data, data + len);
+    }
+
+    std::vector<std::uint8_t> query(std::uint32_t oid)
+    {
+        CHECK_TRUE( (send(message(4, {7, oid, 0, 0, 0}))) );
+        return get();
+    }
+
+    std::uint32_t set_filter(std::uint32_t filter)
+    {
+        CHECK_TRUE( (send(message(5, {8, OID_GEN_CURRENT_PACKET_FILTER, 4, 20, 0, filter}))) );
+        return le32(&get()[12]);
+    }
+
+    void initialize(std::uint32_t host_max = 0x4000)
+    {
+        CHECK_TRUE( (send(message(2, {1, 1, 0, host_max}))) );
+        CHECK_EQUAL(52U, get().size());
+    }
+
+    void go_online()
+    {
+        initialize();
+        CHECK_EQUAL(0U, set_filter(0x0F));
+    }
+
+    /**
+     * @brief Delivers @p transfer as one Bulk-OUT transfer.
+     */
+    void receive(const std::vector<std::uint8_t> &transfer)
+    {
+        std::uint32_t size = 0;
+        std::uint8_t *buf = cusb_rndis_rx_arm(&m_rndis, &size);
+        CHECK_TRUE( (buf != nullptr) );
+        CHECK_TRUE( (transfer.size() <= size) );
+        std::memcpy(buf, transfer.data(), transfer.size());
+        cusb_rndis_bulk_out(&m_rndis, static_cast<std::uint32_t>(transfer.size()));
+    }
+
+    void send_frame(std::uint32_t len, std::uint8_t fill)
+    {
+        std::uint8_t *frame = cusb_rndis_tx_alloc(&m_rndis, len);
+        CHECK_TRUE( (frame != nullptr) );
+        std::memset(frame, fill, len);
+        cusb_rndis_tx_commit(&m_rndis, len);
+    }
+
+    /**
+     * @brief Walks the packet messages of a Bulk-IN transfer, returning
+     * the frame lengths.
+     */
+    std::vector<std::uint32_t> frames_in(const std::uint8_t *buf, std::uint32_t len)
+    {
+        std::vector<std::uint32_t> lens;
+        std::uint32_t offset = 0;
+
+        while (len - offset >= 44)
+        {
+            CHECK_EQUAL(1U, le32(&buf[offset]));
+            CHECK_EQUAL(0U, le32(&buf[offset + 4]) % 4U);
+            CHECK_EQUAL(36U, le32(&buf[offset + 8]));
+            lens.push_back(le32(&buf[offset + 12]));
+            offset += le32(&buf[offset + 4]);
+        }
+
+        return lens;
+    }
+
+    app m_app;
+    struct cusb_pktpool m_pool;
+    struct cusb_pkt m_pkts[BUFFERS];
+    std::uint32_t m_mem[BUFFERS * BUFFER_SIZE / 4];
+    struct cusb_rndis m_rndis;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Rndis, InitializeCompletes)
+{
+    CHECK_TRUE( (send(message(2, {0x1234, 1, 0, 0x4000}))) );
+    CHECK_EQUAL(1, m_app.notifications);
+
+    auto r = get();
+    CHECK_EQUAL(52U, r.size());
+    CHECK_EQUAL(0x80000002UL, le32(&r[0]));
+    CHECK_EQUAL(52U, le32(&r[4]));
+    CHECK_EQUAL(0x1234U, le32(&r[8]));
+    CHECK_EQUAL(0U, le32(&r[12]));
+    CHECK_EQUAL(1U, le32(&r[16]));
+    CHECK_EQUAL(1U, le32(&r[24]));
+    CHECK_TRUE( (le32(&r[32]) > 1U) );
+    CHECK_EQUAL(BUFFER_SIZE, le32(&r[36]));
+    CHECK_EQUAL(2U, le32(&r[40]));
+}
+
+TEST(Rndis, QueryAddressAndSupportedList)
+{
+    initialize();
+
+    auto r = query(OID_802_3_PERMANENT_ADDRESS);
+    CHECK_EQUAL(0x80000004UL, le32(&r[0]));
+    CHECK_EQUAL(7U, le32(&r[8]));
+    CHECK_EQUAL(0U, le32(&r[12]));
+    CHECK_EQUAL(6U, le32(&r[16]));
+    CHECK_EQUAL(16U, le32(&r[20]));
+    MEMCMP_EQUAL(MAC, &r[24], 6);
+
+    r = query(OID_GEN_SUPPORTED_LIST);
+    std::uint32_t n = le32(&r[16]) / 4U;
+    CHECK_TRUE( (n > 10U) );
+    CHECK_EQUAL(24U + 4U * n, r.size());
+    CHECK_EQUAL(OID_GEN_SUPPORTED_LIST, le32(&r[24]));
+}
+
+TEST(Rndis, QueryUnknownOidNotSupported)
+{
+    initialize();
+
+    auto r = query(0x00FFFFFFUL);
+    CHECK_EQUAL(24U, r.size());
+    CHECK_EQUAL(0xC00000BBUL, le32(&r[12]));
+    CHECK_EQUAL(0U, le32(&r[16]));
+}
+
+TEST(Rndis, PacketFilterEnablesDataPath)
+{
+    initialize();
+    CHECK_FALSE( (cusb_rndis_online(&m_rndis)) );
+
+    CHECK_EQUAL(0U, set_filter(0x0F));
+    CHECK_TRUE( (cusb_rndis_online(&m_rndis)) );
+
+    auto r = query(OID_GEN_CURRENT_PACKET_FILTER);
+    CHECK_EQUAL(0x0FU, le32(&r[24]));
+}
+
+TEST(Rndis, KeepaliveAndReset)
+{
+    go_online();
+
+    CHECK_TRUE( (send(message(8, {99}))) );
+    auto r = get();
+    CHECK_EQUAL(0x80000008UL, le32(&r[0]));
+    CHECK_EQUAL(99U, le32(&r[8]));
+
+    send_frame(100, 0xAA);
+    CHECK_TRUE( (send(message(6, {0}))) );
+    r = get();
+    CHECK_EQUAL(0x80000006UL, le32(&r[0]));
+    CHECK_EQUAL(1U, le32(&r[12]));
+
+    /* The queued frame went back to the pool. */
+    CHECK_EQUAL(BUFFERS, cusb_pktpool_available(&m_pool));
+}
+
+TEST(Rndis, HaltStopsDataPath)
+{
+    go_online();
+    int notifications = m_app.notifications;
+
+    CHECK_TRUE( (send(message(3, {0}))) );
+    CHECK_EQUAL(notifications, m_app.notifications);
+    CHECK_FALSE( (cusb_rndis_online(&m_rndis)) );
+}
+
+TEST(Rndis, NothingPendingAnswersZeroByte)
+{
+    auto r = get();
+    CHECK_EQUAL(1U, r.size());
+    CHECK_EQUAL(0, r[0]);
+}
+
+TEST(Rndis, LinkChangeIndicated)
+{
+    initialize();
+    CHECK_EQUAL(0U, le32(&query(OID_GEN_MEDIA_CONNECT_STATUS)[24]));
+
+    cusb_rndis_set_link(&m_rndis, false);
+    CHECK_EQUAL(3, m_app.notifications);
+
+    auto r = get();
+    CHECK_EQUAL(20U, r.size());
+    CHECK_EQUAL(7U, le32(&r[0]));
+    CHECK_EQUAL(0x4001000CUL, le32(&r[8]));
+    CHECK_EQUAL(1U, le32(&query(OID_GEN_MEDIA_CONNECT_STATUS)[24]));
+}
+
+TEST(Rndis, RxFrameDeliveredInPlace)
+{
+    go_online();
+    m_app.keep = true;
+
+    std::vector<std::uint8_t> frame(60, 0x5A);
+    receive(packet(frame));
+
+    CHECK_EQUAL(1U, m_app.frames.size());
+    CHECK_TRUE( (m_app.frames[0] == frame) );
+    POINTERS_EQUAL(m_app.held[0]->buf + 44, m_app.where[0]);
+
+    /* The frame's reference keeps the buffer out of the pool. */
+    CHECK_EQUAL(BUFFERS - 1, cusb_pktpool_available(&m_pool));
+    cusb_pktpool_release(&m_pool, m_app.held[0]);
+    CHECK_EQUAL(BUFFERS, cusb_pktpool_available(&m_pool));
+}
+
+TEST(Rndis, RxManyPacketsPerTransfer)
+{
+    go_online();
+    m_app.keep = true;
+
+    std::vector<std::uint8_t> transfer;
+    for (std::uint8_t i = 1; i <= 3; i++)
+    {
+        auto msg = packet(std::vector<std::uint8_t>(60U + i, i), 4U - ((60U + i) % 4U));
+        transfer.insert(transfer.end(), msg.begin(), msg.end());
+    }
+    transfer.push_back(0);
+    receive(transfer);
+
+    CHECK_EQUAL(3U, m_app.frames.size());
+    for (std::uint8_t i = 1; i <= 3; i++)
+    {
+        CHECK_EQUAL(60U + i, m_app.frames[i - 1U].size());
+        CHECK_EQUAL(i, m_app.frames[i - 1U][0]);
+        POINTERS_EQUAL(m_app.held[0], m_app.held[i - 1U]);
+    }
+
+    /* One buffer, released by the last frame. */
+    for (int i = 0; i < 2; i++)
+    {
+        cusb_pktpool_release(&m_pool, m_app.held[static_cast<std::size_t>(i)]);
+        CHECK_EQUAL(BUFFERS - 1, cusb_pktpool_available(&m_pool));
+    }
+    cusb_pktpool_release(&m_pool, m_app.held[2]);
+    CHECK_EQUAL(BUFFERS, cusb_pktpool_available(&m_pool));
+}
+
+TEST(Rndis, RxMalformedMessageStopsTransfer)
+{
+    go_online();
+
+    auto good = packet(std::vector<std::uint8_t>(64, 1));
+    auto bad = packet(std::vector<std::uint8_t>(64, 2));
+    bad[12] = 0xFF;     /* DataLength past the message. */
+    good.insert(good.end(), bad.begin(), bad.end());
+    receive(good);
+
+    CHECK_EQUAL(1U, m_app.frames.size());
+    CHECK_EQUAL(BUFFERS, cusb_pktpool_available(&m_pool));
+#if (CUSB_CFG_STATS)
+    CHECK_EQUAL(1U, cusb_rndis_get_stats(&m_rndis)->rx_errors);
+#endif
+}
+
+TEST(Rndis, TxFramesBatchWhileBusy)
+{
+    std::uint8_t *buf = nullptr;
+    std::uint32_t len = 0;
+    go_online();
+
+    send_frame(60, 1);
+    CHECK_EQUAL(1, m_app.ready);
+    CHECK_TRUE( (cusb_rndis_bulk_in(&m_rndis, &buf, &len)) );
+    CHECK_EQUAL(104U, len);
+
+    /* In flight: the next frames share one transfer, in place. */
+    send_frame(1514, 2);
+    send_frame(61, 3);
+    send_frame(100, 4);
+    CHECK_EQUAL(1, m_app.ready);
+    CHECK_FALSE( (cusb_rndis_bulk_in(&m_rndis, &buf, &len)) );
+
+    cusb_rndis_in_complete(&m_rndis);
+    CHECK_EQUAL(2, m_app.ready);
+    CHECK_TRUE( (cusb_rndis_bulk_in(&m_rndis, &buf, &len)) );
+    auto lens = frames_in(buf, len);
+    CHECK_EQUAL(3U, lens.size());
+    CHECK_EQUAL(1514U, lens[0]);
+    CHECK_EQUAL(61U, lens[1]);
+    CHECK_EQUAL(100U, lens[2]);
+    CHECK_EQUAL(2, buf[44]);
+    CHECK_EQUAL(3, buf[44 + 1516 + 44]);
+
+    cusb_rndis_in_complete(&m_rndis);
+    CHECK_EQUAL(BUFFERS, cusb_pktpool_available(&m_pool));
+}
+
+TEST(Rndis, TxAvoidsPacketMultiple)
+{
+    std::uint8_t *buf = nullptr;
+    std::uint32_t len = 0;
+    go_online();
+
+    /* 44 + 84 = 128, two full packets. */
+    send_frame(84, 1);
+    CHECK_TRUE( (cusb_rndis_bulk_in(&m_rndis, &buf, &len)) );
+    CHECK_EQUAL(129U, len);
+    CHECK_EQUAL(0, buf[128]);
+}
+
+TEST(Rndis, TxSplitsAtHostTransferSize)
+{
+    std::uint8_t *buf = nullptr;
+    std::uint32_t len = 0;
+    initialize(2048);
+    CHECK_EQUAL(0U, set_filter(0x0F));
+
+    send_frame(60, 0);
+    CHECK_TRUE( (cusb_rndis_bulk_in(&m_rndis, &buf, &len)) );
+
+    /* Two largest frames do not fit in 2048 bytes. */
+    send_frame(1514, 1);
+    send_frame(1514, 2);
+    cusb_rndis_in_complete(&m_rndis);
+
+    CHECK_TRUE( (cusb_rndis_bulk_in(&m_rndis, &buf, &len)) );
+    CHECK_EQUAL(1U, frames_in(buf, len).size());
+    CHECK_EQUAL(1, buf[44]);
+    cusb_rndis_in_complete(&m_rndis);
+
+    CHECK_TRUE( (cusb_rndis_bulk_in(&m_rndis, &buf, &len)) );
+    CHECK_EQUAL(1U, frames_in(buf, len).size());
+    CHECK_EQUAL(2, buf[44]);
+}
+
+TEST(Rndis, TxDroppedBeforeFilterSet)
+{
+    initialize();
+
+    POINTERS_EQUAL(nullptr, cusb_rndis_tx_alloc(&m_rndis, 60));
+    CHECK_EQUAL(BUFFERS, cusb_pktpool_available(&m_pool));
+#if (CUSB_CFG_STATS)
+    CHECK_EQUAL(1U, cusb_rndis_get_stats(&m_rndis)->tx_dropped);
+#endif
+}
+
+TEST(Rndis, ResetReturnsEveryBuffer)
+{
+    std::uint8_t *buf = nullptr;
+    std::uint32_t len = 0;
+    std::uint32_t size = 0;
+    go_online();
+
+    send_frame(60, 1);
+    CHECK_TRUE( (cusb_rndis_bulk_in(&m_rndis, &buf, &len)) );
+    send_frame(60, 2);
+    CHECK_TRUE( (cusb_rndis_rx_arm(&m_rndis, &size) != nullptr) );
+    CHECK_EQUAL(BUFFERS - 3, cusb_pktpool_available(&m_pool));
+
+    cusb_rndis_reset(&m_rndis);
+    CHECK_EQUAL(BUFFERS, cusb_pktpool_available(&m_pool));
+    CHECK_FALSE( (cusb_rndis_online(&m_rndis)) );
+}
@@ -0,0 +1,209 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref rtt.h
+ *
+ * Test Summary:
+ *
+ * Control block
+ *      - TEST(Rtt, ControlBlockIsPublishedUnderItsId)
+ *
+ * cusb_rtt_write() and cusb_rtt_log()
+ *      - TEST(Rtt, LogTextIsReadBack)
+ *      - TEST(Rtt, WriteWrapsAroundRingEnd)
+ *      - TEST(Rtt, WriteThatDoesNotFitIsDroppedWhole)
+ *
+ * cusb_rtt_trace()
+ *      - TEST(Rtt, TraceRecordIsLittleEndianWithTimestamp)
+ *      - TEST(Rtt, NextRecordCountsDroppedOnes)
+ *      - TEST(Rtt, PreemptingWriterIsPublishedWithPreemptedOne)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/rtt.h"
+
+/* STDLib. */
+#include <array>
+#include <cstring>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::size_t LOG_SIZE = 16U;
+constexpr std::size_t TRACE_SIZE = 4U * CUSB_RTT_RECORD_SIZE + 1U;
+
+/**
+ * @brief Tick source. Optionally writes a trace record of its own the
+ * first time it is read, like an interrupt arriving while a record is
+ * being written.
+ */
+std::uint32_t ticks;
+struct cusb_rtt *preempt;
+std::uint32_t published_in_preemption;
+
+std::uint32_t now()
+{
+    if (preempt != nullptr)
+    {
+        struct cusb_rtt *rtt = preempt;
+        preempt = nullptr;
+        (void)cusb_rtt_trace(rtt, 0x0202U, 0xBBU);
+        published_in_preemption = rtt->cb.up[CUSB_RTT_TRACE].wr_off;
+    }
+
+    return ticks++;
+}
+
+std::uint32_t le32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8) |
+           (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+}
+
+std::uint16_t le16(const std::uint8_t *p)
+{
+    return static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Rtt)
+{
+    void setup() override
+    {
+        ticks = 0x11223344U;
+        preempt = nullptr;
+        cusb_rtt_ctor(&m_rtt, m_log.data(), m_log.size(), m_trace.data(), m_trace.size(), &now);
+    }
+
+    struct cusb_rtt m_rtt;
+    std::array<std::uint8_t, LOG_SIZE> m_log{};
+    std::array<std::uint8_t, TRACE_SIZE> m_trace{};
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Rtt, ControlBlockIsPublishedUnderItsId)
+{
+    const char id[16] = "SEGGER RTT";
+
+    MEMCMP_EQUAL(id, m_rtt.cb.id, sizeof(id));
+    LONGS_EQUAL(CUSB_RTT_CHANNELS, m_rtt.cb.max_up);
+    LONGS_EQUAL(0, m_rtt.cb.max_down);
+    STRCMP_EQUAL("Terminal", m_rtt.cb.up[CUSB_RTT_LOG].name);
+    POINTERS_EQUAL(m_trace.data(), m_rtt.cb.up[CUSB_RTT_TRACE].buf);
+    UNSIGNED_LONGS_EQUAL(TRACE_SIZE, m_rtt.cb.up[CUSB_RTT_TRACE].size);
+    UNSIGNED_LONGS_EQUAL(0, m_rtt.cb.up[CUSB_RTT_TRACE].flags);
+}
+
+TEST(Rtt, LogTextIsReadBack)
+{
+    char out[LOG_SIZE] = {};
+
+    CHECK_TRUE( (cusb_rtt_log(&m_rtt, "reset\n")) );
+    CHECK_TRUE( (cusb_rtt_log(&m_rtt, "cfg 1\n")) );
+
+    UNSIGNED_LONGS_EQUAL(12, cusb_rtt_read(&m_rtt, CUSB_RTT_LOG, reinterpret_cast<std::uint8_t *>(out), sizeof(out)));
+    STRCMP_EQUAL("reset\ncfg 1\n", out);
+    UNSIGNED_LONGS_EQUAL(0, cusb_rtt_read(&m_rtt, CUSB_RTT_LOG, reinterpret_cast<std::uint8_t *>(out), sizeof(out)));
+}
+
+TEST(Rtt, WriteWrapsAroundRingEnd)
+{
+    std::uint8_t out[LOG_SIZE] = {};
+
+    CHECK_TRUE( (cusb_rtt_write(&m_rtt, CUSB_RTT_LOG, "0123456789", 10)) );
+    UNSIGNED_LONGS_EQUAL(10, cusb_rtt_read(&m_rtt, CUSB_RTT_LOG, out, sizeof(out)));
+
+    CHECK_TRUE( (cusb_rtt_write(&m_rtt, CUSB_RTT_LOG, "abcdefghij", 10)) );
+    UNSIGNED_LONGS_EQUAL(4, m_rtt.cb.up[CUSB_RTT_LOG].wr_off);
+    UNSIGNED_LONGS_EQUAL(10, cusb_rtt_read(&m_rtt, CUSB_RTT_LOG, out, sizeof(out)));
+    MEMCMP_EQUAL("abcdefghij", out, 10);
+}
+
+TEST(Rtt, WriteThatDoesNotFitIsDroppedWhole)
+{
+    std::uint8_t out[LOG_SIZE] = {};
+
+    /* One byte of the ring always stays free. */
+    CHECK_TRUE( (cusb_rtt_write(&m_rtt, CUSB_RTT_LOG, "0123456789", 10)) );
+    CHECK_FALSE( (cusb_rtt_write(&m_rtt, CUSB_RTT_LOG, "abcdef", 6)) );
+    CHECK_TRUE( (cusb_rtt_write(&m_rtt, CUSB_RTT_LOG, "abcde", 5)) );
+    CHECK_FALSE( (cusb_rtt_write(&m_rtt, CUSB_RTT_LOG, "0123456789abcdefgh", 18)) );
+
+    UNSIGNED_LONGS_EQUAL(15, cusb_rtt_read(&m_rtt, CUSB_RTT_LOG, out, sizeof(out)));
+    MEMCMP_EQUAL("0123456789abcde", out, 15);
+    UNSIGNED_LONGS_EQUAL(2, cusb_rtt_get_stats(&m_rtt)->written);
+    UNSIGNED_LONGS_EQUAL(2, cusb_rtt_get_stats(&m_rtt)->dropped);
+}
+
+TEST(Rtt, TraceRecordIsLittleEndianWithTimestamp)
+{
+    std::uint8_t out[CUSB_RTT_RECORD_SIZE * 2U] = {};
+
+    CHECK_TRUE( (cusb_rtt_trace(&m_rtt, 0x0101U, 0xA1B2C3D4U)) );
+    CHECK_TRUE( (cusb_rtt_trace(&m_rtt, 0x0601U, 7U)) );
+
+    UNSIGNED_LONGS_EQUAL(sizeof(out), cusb_rtt_read(&m_rtt, CUSB_RTT_TRACE, out, sizeof(out)));
+    UNSIGNED_LONGS_EQUAL(0x11223344U, le32(&out[0]));
+    UNSIGNED_LONGS_EQUAL(0x0101U, le16(&out[4]));
+    UNSIGNED_LONGS_EQUAL(0, le16(&out[6]));
+    UNSIGNED_LONGS_EQUAL(0xA1B2C3D4U, le32(&out[8]));
+    UNSIGNED_LONGS_EQUAL(0x11223345U, le32(&out[12]));
+    UNSIGNED_LONGS_EQUAL(0x0601U, le16(&out[16]));
+}
+
+TEST(Rtt, NextRecordCountsDroppedOnes)
+{
+    std::uint8_t out[TRACE_SIZE] = {};
+
+    for (std::uint32_t i = 0; i < 6U; i++)
+    {
+        (void)cusb_rtt_trace(&m_rtt, 0x0101U, i);
+    }
+
+    UNSIGNED_LONGS_EQUAL(4U * CUSB_RTT_RECORD_SIZE, cusb_rtt_read(&m_rtt, CUSB_RTT_TRACE, out, sizeof(out)));
+    CHECK_TRUE( (cusb_rtt_trace(&m_rtt, 0x0102U, 0U)) );
+    UNSIGNED_LONGS_EQUAL(CUSB_RTT_RECORD_SIZE, cusb_rtt_read(&m_rtt, CUSB_RTT_TRACE, out, sizeof(out)));
+    UNSIGNED_LONGS_EQUAL(0x0102U, le16(&out[4]));
+    UNSIGNED_LONGS_EQUAL(2, le16(&out[6]));
+}
+
+TEST(Rtt, PreemptingWriterIsPublishedWithPreemptedOne)
+{
+    std::uint8_t out[CUSB_RTT_RECORD_SIZE * 2U] = {};
+
+    preempt = &m_rtt;
+    CHECK_TRUE( (cusb_rtt_trace(&m_rtt, 0x0101U, 0xAAU)) );
+
+    /* Nothing was visible while the first record was half written. */
+    UNSIGNED_LONGS_EQUAL(0, published_in_preemption);
+
+    /* Ring order is claim order. The timestamps tell the preemption. */
+    UNSIGNED_LONGS_EQUAL(sizeof(out), cusb_rtt_read(&m_rtt, CUSB_RTT_TRACE, out, sizeof(out)));
+    UNSIGNED_LONGS_EQUAL(0xAAU, le32(&out[8]));
+    UNSIGNED_LONGS_EQUAL(0xBBU, le32(&out[20]));
+    CHECK_TRUE( (le32(&out[12]) < le32(&out[0])) );
+}
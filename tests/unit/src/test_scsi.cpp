@@ -0,0 +1,397 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref scsi.h
+ *
+ * Test Summary:
+ *
+ * cusb_scsi_task_start()
+ *      - TEST(Scsi, InquiryPaddedAndTruncated)
+ *      - TEST(Scsi, TestUnitReadyWithoutMedia)
+ *      - TEST(Scsi, MediaChangeReportsUnitAttentionOnce)
+ *      - TEST(Scsi, RequestSenseReturnsLastErrorAndClears)
+ *      - TEST(Scsi, ReadCapacity)
+ *      - TEST(Scsi, ZeroBlockMediaIsNotPresent)
+ *      - TEST(Scsi, ModeSenseWriteProtect)
+ *      - TEST(Scsi, OutOfRange)
+ *      - TEST(Scsi, WriteProtected)
+ *      - TEST(Scsi, UnknownOpcode)
+ *
+ * Response cache
+ *      - TEST(Scsi, CachedResponsesSkipTaskBuffer)
+ *      - TEST(Scsi, CachedResponsesFollowMediaChange)
+ *      - TEST(Scsi, CachedResponsesFollowFirstMediaChange)
+ *
+ * cusb_scsi_task_data_in(), cusb_scsi_task_data_out()
+ *      - TEST(Scsi, ReadSpansChunks)
+ *      - TEST(Scsi, WriteSpansChunks)
+ *      - TEST(Scsi, ReadErrorIsMediumError)
+ *      - TEST(Scsi, FailedWriteDropsRemainingData)
+ *
+ * Asynchronous backend
+ *      - TEST(Scsi, SynchronizeCacheCompletesLater)
+ *      - TEST(Scsi, AbortWhileWaiting)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/scsi.h"
+
+/* STDLib. */
+#include <cstring>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+#include "stubs/stub_blockdev.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint32_t BLOCK_SIZE = 512;
+constexpr std::uint32_t BLOCK_COUNT = 64;
+constexpr std::size_t TASK_BUFFER_SIZE = 2 * BLOCK_SIZE;
+
+const struct cusb_scsi_inquiry INQUIRY = {"cusb", "Unit Test Disk Long Name", "1.0"};
+
+void on_notify(void *ctx, struct cusb_scsi_task *)
+{
+    (*static_cast<int *>(ctx))++;
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Scsi)
+{
+    void setup() override
+    {
+        m_disk.fill_pattern();
+        cusb_scsi_ctor(&m_scsi, &m_disk.dev, &INQUIRY);
+        cusb_scsi_task_ctor(&m_task, m_buf, sizeof(m_buf), &on_notify, &m_notifications);
+    }
+
+    /**
+     * @brief Runs a command, collecting all data-in. Returns final status.
+     */
+    std::uint8_t run(std::vector<std::uint8_t> cdb)
+    {
+        cdb.resize(16);
+        m_data.clear();
+        cusb_scsi_task_start(&m_scsi, &m_task, cdb.data(), cdb.size());
+
+        while (m_task.state == CUSB_SCSI_TASK_DATA_IN)
+        {
+            std::uint8_t chunk[64];
+            std::size_t n = cusb_scsi_task_data_in(&m_task, chunk, sizeof(chunk));
+            m_data.insert(m_data.end(), chunk, chunk + n);
+        }
+
+        return finish();
+    }
+
+    std::uint8_t finish()
+    {
+        CHECK_EQUAL(CUSB_SCSI_TASK_DONE, m_task.state);
+        std::uint8_t status = m_task.status;
+        cusb_scsi_task_free(&m_task);
+        return status;
+    }
+
+    void check_sense(std::uint8_t key, std::uint8_t asc)
+    {
+        BYTES_EQUAL(key, m_task.sense.key);
+        BYTES_EQUAL(asc, m_task.sense.asc);
+    }
+
+    static std::vector<std::uint8_t> rw10(std::uint8_t op, std::uint32_t lba, std::uint16_t blocks)
+    {
+        return {op, 0, static_cast<std::uint8_t>(lba >> 24), static_cast<std::uint8_t>(lba >> 16),
+                static_cast<std::uint8_t>(lba >> 8), static_cast<std::uint8_t>(lba), 0,
+                static_cast<std::uint8_t>(blocks >> 8), static_cast<std::uint8_t>(blocks), 0};
+    }
+
+    stubs::blockdev m_disk{BLOCK_SIZE, BLOCK_COUNT};
+    struct cusb_scsi m_scsi;
+    struct cusb_scsi_task m_task;
+    std::uint8_t m_buf[TASK_BUFFER_SIZE];
+    std::vector<std::uint8_t> m_data;
+    int m_notifications = 0;
+};
+
+TEST_GROUP(ScsiAsync)
+{
+    void setup() override
+    {
+        cusb_scsi_ctor(&m_scsi, &m_disk.dev, &INQUIRY);
+        cusb_scsi_task_ctor(&m_task, m_buf, sizeof(m_buf), &on_notify, &m_notifications);
+    }
+
+    stubs::blockdev m_disk{BLOCK_SIZE, BLOCK_COUNT, true};
+    struct cusb_scsi m_scsi;
+    struct cusb_scsi_task m_task;
+    std::uint8_t m_buf[TASK_BUFFER_SIZE];
+    int m_notifications = 0;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Scsi, InquiryPaddedAndTruncated)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x12, 0, 0, 0, 36, 0}));
+    LONGS_EQUAL(36, m_data.size());
+    BYTES_EQUAL(0x80, m_data[1]);
+    MEMCMP_EQUAL("cusb    ", &m_data[8], 8);
+    MEMCMP_EQUAL("Unit Test Disk L", &m_data[16], 16);
+    MEMCMP_EQUAL("1.0 ", &m_data[32], 4);
+
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x12, 0, 0, 0, 5, 0}));
+    LONGS_EQUAL(5, m_data.size());
+}
+
+TEST(Scsi, TestUnitReadyWithoutMedia)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x00}));
+    cusb_blockdev_media_changed(&m_disk.dev, false, 0);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0x00}));
+    check_sense(0x02, 0x3A);
+}
+
+TEST(Scsi, MediaChangeReportsUnitAttentionOnce)
+{
+    cusb_blockdev_media_changed(&m_disk.dev, true, 32);
+
+    /* INQUIRY does not consume the unit attention. */
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x12, 0, 0, 0, 36, 0}));
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0x00}));
+    check_sense(0x06, 0x28);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x00}));
+}
+
+TEST(Scsi, RequestSenseReturnsLastErrorAndClears)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0xFF}));
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x03, 0, 0, 0, 18, 0}));
+    LONGS_EQUAL(18, m_data.size());
+    BYTES_EQUAL(0x70, m_data[0]);
+    BYTES_EQUAL(0x05, m_data[2]);
+    BYTES_EQUAL(0x20, m_data[12]);
+
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x03, 0, 0, 0, 18, 0}));
+    BYTES_EQUAL(0x00, m_data[2]);
+}
+
+TEST(Scsi, ReadCapacity)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x25}));
+    LONGS_EQUAL(8, m_data.size());
+    BYTES_EQUAL(BLOCK_COUNT - 1, m_data[3]);
+    BYTES_EQUAL(0x02, m_data[6]);
+
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x9E, 0x10, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 32, 0, 0}));
+    LONGS_EQUAL(32, m_data.size());
+    BYTES_EQUAL(BLOCK_COUNT - 1, m_data[7]);
+    BYTES_EQUAL(0x02, m_data[10]);
+}
+
+TEST(Scsi, ZeroBlockMediaIsNotPresent)
+{
+    cusb_blockdev_media_changed(&m_disk.dev, true, 0);
+
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0x25}));
+    LONGS_EQUAL(0, m_data.size());
+    check_sense(0x02, 0x3A);
+
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0x9E, 0x10, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 32, 0, 0}));
+    check_sense(0x02, 0x3A);
+
+    /* Format capacities report no media instead of a 4G block medium. */
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x23, 0, 0, 0, 0, 0, 0, 0, 12, 0}));
+    LONGS_EQUAL(12, m_data.size());
+    BYTES_EQUAL(0xFF, m_data[4]);
+    BYTES_EQUAL(0x03, m_data[8]);
+}
+
+TEST(Scsi, ModeSenseWriteProtect)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x1A, 0, 0x3F, 0, 255, 0}));
+    LONGS_EQUAL(24, m_data.size());
+    BYTES_EQUAL(23, m_data[0]);
+    BYTES_EQUAL(0x00, m_data[2]);
+    BYTES_EQUAL(0x08, m_data[4]);
+
+    cusb_blockdev_set_write_protect(&m_disk.dev, true);
+    (void)run({0x00});
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x5A, 0, 0x08, 0, 0, 0, 0, 0, 255, 0}));
+    LONGS_EQUAL(28, m_data.size());
+    BYTES_EQUAL(0x80, m_data[3]);
+
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0x1A, 0, 0x1C, 0, 255, 0}));
+    check_sense(0x05, 0x24);
+}
+
+TEST(Scsi, OutOfRange)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run(rw10(0x28, BLOCK_COUNT - 1, 2)));
+    check_sense(0x05, 0x21);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run(rw10(0x28, BLOCK_COUNT - 1, 1)));
+}
+
+TEST(Scsi, WriteProtected)
+{
+    cusb_blockdev_set_write_protect(&m_disk.dev, true);
+    (void)run({0x00});
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run(rw10(0x2A, 0, 1)));
+    check_sense(0x07, 0x27);
+    UNSIGNED_LONGS_EQUAL(0, cusb_scsi_task_data_out_left(&m_task));
+}
+
+TEST(Scsi, UnknownOpcode)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0xC0}));
+    check_sense(0x05, 0x20);
+}
+
+TEST(Scsi, CachedResponsesSkipTaskBuffer)
+{
+    std::memset(m_buf, 0xA5, sizeof(m_buf));
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x12, 0, 0, 0, 36, 0}));
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x25}));
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x1A, 0, 0x3F, 0, 255, 0}));
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x03, 0, 0, 0, 18, 0}));
+    BYTES_EQUAL(0x70, m_data[0]);
+
+    for (std::uint8_t byte : m_buf)
+    {
+        BYTES_EQUAL(0xA5, byte);
+    }
+}
+
+TEST(Scsi, CachedResponsesFollowMediaChange)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x25}));
+    BYTES_EQUAL(BLOCK_COUNT - 1, m_data[3]);
+
+    cusb_blockdev_media_changed(&m_disk.dev, true, 16);
+    cusb_blockdev_set_write_protect(&m_disk.dev, true);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0x25}));
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x25}));
+    BYTES_EQUAL(15, m_data[3]);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x1A, 0, 0x08, 0, 255, 0}));
+    BYTES_EQUAL(0x80, m_data[2]);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x23, 0, 0, 0, 0, 0, 0, 0, 12, 0}));
+    BYTES_EQUAL(16, m_data[7]);
+}
+
+TEST(Scsi, CachedResponsesFollowFirstMediaChange)
+{
+    /* No command ran before the change to build the cache. */
+    cusb_blockdev_media_changed(&m_disk.dev, true, 24);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run({0x25}));
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run({0x25}));
+    BYTES_EQUAL(23, m_data[3]);
+    UNSIGNED_LONGS_EQUAL(BLOCK_SIZE, (m_data[6] << 8) | m_data[7]);
+}
+
+TEST(Scsi, ReadSpansChunks)
+{
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, run(rw10(0x28, 3, 5)));
+    LONGS_EQUAL(5 * BLOCK_SIZE, m_data.size());
+    UNSIGNED_LONGS_EQUAL(3, m_disk.reads);
+
+    for (std::uint32_t i = 0; i < m_data.size(); i++)
+    {
+        BYTES_EQUAL(stubs::blockdev::pattern(3 + i / BLOCK_SIZE, i % BLOCK_SIZE), m_data[i]);
+    }
+}
+
+TEST(Scsi, WriteSpansChunks)
+{
+    std::vector<std::uint8_t> cdb = rw10(0x2A, 10, 3);
+    cdb.resize(16);
+    cusb_scsi_task_start(&m_scsi, &m_task, cdb.data(), cdb.size());
+    UNSIGNED_LONGS_EQUAL(3 * BLOCK_SIZE, cusb_scsi_task_data_out_left(&m_task));
+
+    std::uint8_t pkt[64];
+    for (unsigned i = 0; cusb_scsi_task_data_out_left(&m_task) != 0; i++)
+    {
+        CHECK_EQUAL(CUSB_SCSI_TASK_DATA_OUT, m_task.state);
+        std::memset(pkt, static_cast<int>(i), sizeof(pkt));
+        cusb_scsi_task_data_out(&m_task, pkt, sizeof(pkt));
+    }
+
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, finish());
+    UNSIGNED_LONGS_EQUAL(2, m_disk.writes);
+    BYTES_EQUAL(0, m_disk.data[10 * BLOCK_SIZE]);
+    BYTES_EQUAL(23, m_disk.data[13 * BLOCK_SIZE - 1]);
+}
+
+TEST(Scsi, ReadErrorIsMediumError)
+{
+    m_disk.fail = true;
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, run(rw10(0x28, 0, 1)));
+    check_sense(0x03, 0x11);
+}
+
+TEST(Scsi, FailedWriteDropsRemainingData)
+{
+    std::vector<std::uint8_t> cdb = rw10(0x2A, 0, 4);
+    std::uint8_t pkt[512] = {};
+    cdb.resize(16);
+    m_disk.fail = true;
+    cusb_scsi_task_start(&m_scsi, &m_task, cdb.data(), cdb.size());
+
+    cusb_scsi_task_data_out(&m_task, pkt, sizeof(pkt));
+    cusb_scsi_task_data_out(&m_task, pkt, sizeof(pkt));
+    CHECK_EQUAL(CUSB_SCSI_TASK_DONE, m_task.state);
+    UNSIGNED_LONGS_EQUAL(2 * BLOCK_SIZE, cusb_scsi_task_data_out_left(&m_task));
+    UNSIGNED_LONGS_EQUAL(2 * BLOCK_SIZE, cusb_scsi_task_data_out_space(&m_task));
+
+    cusb_scsi_task_data_out(&m_task, pkt, sizeof(pkt));
+    cusb_scsi_task_data_out(&m_task, pkt, sizeof(pkt));
+    UNSIGNED_LONGS_EQUAL(1, m_disk.writes);
+    check_sense(0x03, 0x0C);
+}
+
+TEST(ScsiAsync, SynchronizeCacheCompletesLater)
+{
+    std::uint8_t cdb[10] = {0x35};
+    cusb_scsi_task_start(&m_scsi, &m_task, cdb, sizeof(cdb));
+    CHECK_EQUAL(CUSB_SCSI_TASK_WAIT, m_task.state);
+    LONGS_EQUAL(0, m_notifications);
+
+    m_disk.complete();
+    CHECK_EQUAL(CUSB_SCSI_TASK_DONE, m_task.state);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, m_task.status);
+    LONGS_EQUAL(1, m_notifications);
+    UNSIGNED_LONGS_EQUAL(1, m_disk.syncs);
+}
+
+TEST(ScsiAsync, AbortWhileWaiting)
+{
+    std::uint8_t cdb[10] = {0x28, 0, 0, 0, 0, 0, 0, 0, 1, 0};
+    cusb_scsi_task_start(&m_scsi, &m_task, cdb, sizeof(cdb));
+    cusb_scsi_task_abort(&m_task);
+    CHECK_EQUAL(CUSB_SCSI_TASK_WAIT, m_task.state);
+
+    m_disk.complete();
+    CHECK_EQUAL(CUSB_SCSI_TASK_IDLE, m_task.state);
+    LONGS_EQUAL(1, m_notifications);
+}
@@ -0,0 +1,720 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref stm32fs.h, run
+ * under the device core against the register model of
+ * stubs/stub_stm32fs.hpp.
+ *
+ * Test Summary:
+ *
+ * Enumeration
+ *      - TEST(Stm32fs, EnumeratesWithAddressAppliedAfterStatusStage)
+ *      - TEST(Stm32fs, InterruptModeServicesEventsInIsr)
+ *
+ * Buffering
+ *      - TEST(Stm32fs, BulkNumberUsedOneWayIsDoubleBuffered)
+ *      - TEST(Stm32fs, DoubleBufferedInStagesNextPacket)
+ *      - TEST(Stm32fs, DoubleBufferedOutNaksAfterCompletionUntilArmed)
+ *      - TEST(Stm32fs, SingleBufferedOutNaksUntilPacketCopied)
+ *      - TEST(Stm32fs, IsochronousInAlternatesBuffers)
+ *      - TEST(Stm32fs, IsochronousInSendsEmptyPacketsWhenIdle)
+ *      - TEST(Stm32fs, IsochronousOutDropsPacketsWhileNotArmed)
+ *      - TEST(Stm32fs, PacketLargerThanLayoutAsserts)
+ *
+ * Endpoint state
+ *      - TEST(Stm32fs, ClearedHaltRestartsTransferOnDataZero)
+ *      - TEST(Stm32fs, ClosedEndpointDoesNotAnswer)
+ *
+ * Interrupts
+ *      - TEST(Stm32fs, DeferredIsrMasksUntilPollDrainsEvents)
+ *      - TEST(Stm32fs, SofOnlyReportedWhenEnabled)
+ *      - TEST(Stm32fs, SuspendAndWakeupReachApplication)
+ *
+ * Register cost
+ *      - TEST(Stm32fs, PacketCostsTwoRegisterReadsAndOneWrite)
+ *      - TEST(Stm32fs, PacketsInOnePollShareFinalIstrRead)
+ *      - TEST(Stm32fs, PmaAccessesFollowPacketLength)
+ *      - TEST(Stm32fs, DeferredIsrIsOneRegisterWrite)
+ *      - TEST(Stm32fs, IdlePollIsOneRegisterRead)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/device.h"
+#include "cusb/stm32fs.h"
+
+/* STDLib. */
+#include <array>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+#include "stubs/stub_stm32fs.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+using hw = stubs::stm32fs;
+
+constexpr std::uint8_t BULK_OUT = 0x01U;        /* Double-buffered. */
+constexpr std::uint8_t BULK_IN = 0x82U;         /* Double-buffered. */
+constexpr std::uint8_t PAIR_OUT = 0x03U;        /* Single-buffered, shares EP3 with PAIR_IN. */
+constexpr std::uint8_t PAIR_IN = 0x83U;
+constexpr std::uint8_t ISO_IN = 0x84U;
+constexpr std::uint8_t ISO_OUT = 0x05U;
+constexpr std::uint16_t MPS = 64U;
+
+const std::uint8_t DEVICE_DESC[18] =
+{
+    18, 1, 0x00, 0x02, 0xFF, 0x00, 0x00, CUSB_CFG_EP0_SIZE,
+    0x34, 0x12, 0x78, 0x56, 0x00, 0x01, 0, 0, 0, 1
+};
+
+const std::uint8_t CONFIG_DESC[60] =
+{
+    9, 2, 60, 0, 1, 1, 0, 0x80, 50,
+    9, 4, 0, 0, 6, 0xFF, 0x00, 0x00, 0,
+    7, 5, BULK_OUT, 2, MPS, 0, 0,
+    7, 5, BULK_IN, 2, MPS, 0, 0,
+    7, 5, PAIR_OUT, 2, MPS, 0, 0,
+    7, 5, PAIR_IN, 2, MPS, 0, 0,
+    7, 5, ISO_IN, 1, MPS, 0, 1,
+    7, 5, ISO_OUT, 1, MPS, 0, 1
+};
+
+const struct cusb_device_descriptors DESCRIPTORS = {DEVICE_DESC, CONFIG_DESC, nullptr, nullptr, 0};
+
+std::array<std::uint8_t, 8> setup_packet(std::uint8_t type, std::uint8_t request, std::uint16_t value,
+                                         std::uint16_t index, std::uint16_t length)
+{
+    return {type, request,
+            static_cast<std::uint8_t>(value), static_cast<std::uint8_t>(value >> 8),
+            static_cast<std::uint8_t>(index), static_cast<std::uint8_t>(index >> 8),
+            static_cast<std::uint8_t>(length), static_cast<std::uint8_t>(length >> 8)};
+}
+
+/**
+ * @brief Opens every endpoint of @ref CONFIG_DESC and records
+ * completions and events.
+ */
+struct app
+{
+    static bool configure(void *obj, std::uint8_t config)
+    {
+        auto *me = static_cast<app *>(obj);
+
+        if (config != 0U)
+        {
+            cusb_device_ep_open(me->dev, BULK_OUT, CUSB_EP_BULK, MPS, &app::done, me);
+            cusb_device_ep_open(me->dev, BULK_IN, CUSB_EP_BULK, MPS, &app::done, me);
+            cusb_device_ep_open(me->dev, PAIR_OUT, CUSB_EP_BULK, MPS, &app::done, me);
+            cusb_device_ep_open(me->dev, PAIR_IN, CUSB_EP_BULK, MPS, &app::done, me);
+            cusb_device_ep_open(me->dev, ISO_IN, CUSB_EP_ISOCHRONOUS, MPS, &app::done, me);
+            cusb_device_ep_open(me->dev, ISO_OUT, CUSB_EP_ISOCHRONOUS, MPS, &app::done, me);
+        }
+
+        return true;
+    }
+
+    static void event(void *obj, std::uint8_t ev)
+    {
+        static_cast<app *>(obj)->events.push_back(ev);
+    }
+
+    static void sof(void *obj, std::uint16_t frame)
+    {
+        static_cast<app *>(obj)->frames.push_back(frame);
+    }
+
+    static void done(void *obj, std::uint8_t ep, std::uint8_t *buf, std::uint32_t len, bool ok)
+    {
+        auto *me = static_cast<app *>(obj);
+        (void)buf;
+        me->completions.push_back({ep, len, ok});
+    }
+
+    static void wake(void *obj)
+    {
+        static_cast<app *>(obj)->wakes++;
+    }
+
+    struct completion
+    {
+        std::uint8_t ep;
+        std::uint32_t len;
+        bool ok;
+    };
+
+    struct cusb_device *dev = nullptr;
+    std::vector<std::uint8_t> events;
+    std::vector<std::uint16_t> frames;
+    std::vector<completion> completions;
+    unsigned wakes = 0;
+};
+
+const struct cusb_device_callbacks CALLBACKS = {&app::configure, nullptr, nullptr, &app::event, &app::sof};
+
+std::vector<std::uint8_t> pattern(std::size_t len, std::uint8_t seed)
+{
+    std::vector<std::uint8_t> data(len);
+
+    for (std::size_t i = 0; i < len; i++)
+    {
+        data[i] = static_cast<std::uint8_t>(seed + i);
+    }
+
+    return data;
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*---------------------------- TESTS -------------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Stm32fs)
+{
+    void setup() override
+    {
+        m_app.dev = &m_dev;
+    }
+
+    /**
+     * @brief Constructs the stack and runs the bus reset.
+     */
+    void start(bool sof = false, bool deferred = false)
+    {
+        cusb_stm32fs_ctor(&m_drv, sof, deferred ? &app::wake : nullptr, &m_app);
+        cusb_device_ctor(&m_dev, &m_drv.dcd, &DESCRIPTORS, &CALLBACKS, &m_app);
+        cusb_device_start(&m_dev, true);
+        m_hw.reset();
+        poll();
+    }
+
+    void poll()
+    {
+        while (cusb_poll(&m_dev, 4) == 4)
+        {
+        }
+    }
+
+    /**
+     * @brief Runs @p token, polling the device once if it is NAKed.
+     */
+    template <typename F>
+    int retry(F token)
+    {
+        int result = token();
+
+        if (result == hw::NAK)
+        {
+            poll();
+            result = token();
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Control transfer with no or IN data stage. Returns the
+     * handshake of the first stage that failed.
+     */
+    int control(const std::array<std::uint8_t, 8> &setup, std::vector<std::uint8_t> *data = nullptr)
+    {
+        std::vector<std::uint8_t> got;
+        std::uint16_t length = static_cast<std::uint16_t>(setup[6] | (setup[7] << 8));
+
+        if (m_hw.setup(setup.data()) != hw::ACK)
+        {
+            return hw::TIMEOUT;
+        }
+
+        poll();
+
+        while (length > 0U)
+        {
+            std::size_t before = got.size();
+            int result = retry([&] { return m_hw.in(0, got); });
+
+            if (result != hw::ACK)
+            {
+                return result;
+            }
+
+            if (got.size() - before < CUSB_CFG_EP0_SIZE || got.size() >= length)
+            {
+                break;
+            }
+        }
+
+        int result = (length > 0U) ? retry([&] { return m_hw.out(0, nullptr, 0); })
+                                   : retry([&] { return m_hw.in(0, got); });
+        poll();
+
+        if (data)
+        {
+            *data = got;
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief Driver accesses since @p mark, registers and PMA apart.
+     */
+    struct cost
+    {
+        unsigned reads;
+        unsigned writes;
+        unsigned pma_reads;
+        unsigned pma_writes;
+    };
+
+    cost since(std::size_t mark) const
+    {
+        const std::uint32_t pma = hw::addr(0, true);
+        return {m_hw.bus.reads(mark, 0, pma), m_hw.bus.writes(mark, 0, pma),
+                m_hw.bus.reads(mark, pma), m_hw.bus.writes(mark, pma)};
+    }
+
+    void enumerate()
+    {
+        start();
+        LONGS_EQUAL(hw::ACK, control(setup_packet(0x00, 5, 9, 0, 0)));
+        LONGS_EQUAL(hw::ACK, control(setup_packet(0x00, 9, 1, 0, 0)));
+    }
+
+    hw m_hw;
+    struct cusb_stm32fs m_drv;
+    struct cusb_device m_dev;
+    app m_app;
+    std::array<std::uint8_t, 512> m_buf{};
+};
+
+/*------------------------------------------------------------*/
+/*------------------------ TESTS - ENUMERATION ---------------*/
+/*------------------------------------------------------------*/
+
+TEST(Stm32fs, EnumeratesWithAddressAppliedAfterStatusStage)
+{
+    std::vector<std::uint8_t> desc;
+    start();
+    CHECK_EQUAL(0x80U, m_hw.reg(0x4C));
+
+    LONGS_EQUAL(hw::ACK, m_hw.setup(setup_packet(0x00, 5, 9, 0, 0).data()));
+    poll();
+    CHECK_EQUAL(0x80U, m_hw.reg(0x4C));
+
+    std::vector<std::uint8_t> status;
+    LONGS_EQUAL(hw::ACK, m_hw.in(0, status));
+    poll();
+    CHECK_EQUAL(0x89U, m_hw.reg(0x4C));
+
+    LONGS_EQUAL(hw::ACK, control(setup_packet(0x80, 6, 0x0200, 0, 255), &desc));
+    LONGS_EQUAL(sizeof(CONFIG_DESC), desc.size());
+    MEMCMP_EQUAL(CONFIG_DESC, desc.data(), desc.size());
+    LONGS_EQUAL(CUSB_DEVICE_ADDRESS, cusb_device_get_state(&m_dev));
+}
+
+TEST(Stm32fs, InterruptModeServicesEventsInIsr)
+{
+    cusb_stm32fs_ctor(&m_drv, false, nullptr, nullptr);
+    cusb_device_ctor(&m_dev, &m_drv.dcd, &DESCRIPTORS, &CALLBACKS, &m_app);
+    cusb_device_start(&m_dev, false);
+    CHECK_TRUE(m_hw.reg(0x58) & 0x8000U);
+
+    m_hw.reset();
+    CHECK_TRUE(m_hw.irq());
+    cusb_isr(&m_dev);
+    CHECK_FALSE(m_hw.irq());
+    LONGS_EQUAL(CUSB_DEVICE_DEFAULT, cusb_device_get_state(&m_dev));
+}
+
+/*------------------------------------------------------------*/
+/*------------------------ TESTS - BUFFERING -----------------*/
+/*------------------------------------------------------------*/
+
+TEST(Stm32fs, BulkNumberUsedOneWayIsDoubleBuffered)
+{
+    enumerate();
+
+    CHECK_EQUAL(0x0101U, m_hw.reg(0x04) & 0x070FU);
+    CHECK_EQUAL(0x0102U, m_hw.reg(0x08) & 0x070FU);
+    CHECK_EQUAL(0x0003U, m_hw.reg(0x0C) & 0x070FU);
+    CHECK_EQUAL(0x0404U, m_hw.reg(0x10) & 0x070FU);
+}
+
+TEST(Stm32fs, DoubleBufferedInStagesNextPacket)
+{
+    std::vector<std::uint8_t> sent = pattern(3U * MPS, 1);
+    std::vector<std::uint8_t> got;
+    enumerate();
+
+    std::copy(sent.begin(), sent.end(), m_buf.begin());
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_IN, m_buf.data(), 3U * MPS));
+
+    /* Each released packet goes out, the next waits for the driver to
+    hand it over, which is all the service does for it. */
+    LONGS_EQUAL(hw::ACK, m_hw.in(2, got));
+    LONGS_EQUAL(hw::NAK, m_hw.in(2, got));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(hw::ACK, m_hw.in(2, got));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(hw::ACK, m_hw.in(2, got));
+    CHECK_TRUE(m_app.completions.empty());
+
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+    CHECK_TRUE(sent == got);
+    LONGS_EQUAL(1, m_app.completions.size());
+    CHECK_EQUAL(BULK_IN, m_app.completions[0].ep);
+    LONGS_EQUAL(3U * MPS, m_app.completions[0].len);
+    LONGS_EQUAL(hw::NAK, m_hw.in(2, got));
+}
+
+TEST(Stm32fs, DoubleBufferedOutNaksAfterCompletionUntilArmed)
+{
+    std::vector<std::uint8_t> sent = pattern(MPS + 10U, 7);
+    enumerate();
+
+    LONGS_EQUAL(hw::NAK, m_hw.out(1, sent.data(), MPS));
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_OUT, m_buf.data(), 256));
+
+    LONGS_EQUAL(hw::ACK, m_hw.out(1, sent.data(), MPS));
+    LONGS_EQUAL(hw::NAK, m_hw.out(1, &sent[MPS], 10));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(hw::ACK, m_hw.out(1, &sent[MPS], 10));
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+
+    LONGS_EQUAL(1, m_app.completions.size());
+    LONGS_EQUAL(MPS + 10U, m_app.completions[0].len);
+    CHECK_TRUE(m_app.completions[0].ok);
+    MEMCMP_EQUAL(sent.data(), m_buf.data(), sent.size());
+
+    /* Not armed: the next transfer's data waits on the host. */
+    LONGS_EQUAL(hw::NAK, m_hw.out(1, sent.data(), 4));
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_OUT, m_buf.data(), 256));
+    LONGS_EQUAL(hw::ACK, m_hw.out(1, sent.data(), 4));
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(4, m_app.completions[1].len);
+}
+
+TEST(Stm32fs, SingleBufferedOutNaksUntilPacketCopied)
+{
+    std::vector<std::uint8_t> sent = pattern(2U * MPS, 3);
+    enumerate();
+
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, PAIR_OUT, m_buf.data(), 2U * MPS));
+    LONGS_EQUAL(hw::ACK, m_hw.out(3, sent.data(), MPS));
+    LONGS_EQUAL(hw::NAK, m_hw.out(3, &sent[MPS], MPS));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(hw::ACK, m_hw.out(3, &sent[MPS], MPS));
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+
+    LONGS_EQUAL(2U * MPS, m_app.completions[0].len);
+    MEMCMP_EQUAL(sent.data(), m_buf.data(), sent.size());
+}
+
+TEST(Stm32fs, IsochronousInAlternatesBuffers)
+{
+    enumerate();
+
+    for (std::uint8_t frame = 0; frame < 4U; frame++)
+    {
+        std::vector<std::uint8_t> sent = pattern(48U + frame, frame);
+        std::vector<std::uint8_t> got;
+
+        std::copy(sent.begin(), sent.end(), m_buf.begin());
+        CHECK_TRUE(cusb_device_ep_xfer(&m_dev, ISO_IN, m_buf.data(), static_cast<std::uint32_t>(sent.size())));
+        CHECK_EQUAL((frame & 1U) ? 0x0040U : 0U, m_hw.reg(0x10) & 0x0040U);
+        LONGS_EQUAL(hw::ACK, m_hw.in(4, got));
+        LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+        CHECK_TRUE(sent == got);
+    }
+
+    LONGS_EQUAL(4, m_app.completions.size());
+}
+
+TEST(Stm32fs, IsochronousInSendsEmptyPacketsWhenIdle)
+{
+    std::vector<std::uint8_t> sent = pattern(MPS + 20U, 5);
+    std::vector<std::uint8_t> got;
+    enumerate();
+
+    /* Idle frame still completes on the bus before anything is armed. */
+    LONGS_EQUAL(hw::ACK, m_hw.in(4, got));
+    CHECK_TRUE(got.empty());
+
+    std::copy(sent.begin(), sent.end(), m_buf.begin());
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, ISO_IN, m_buf.data(), static_cast<std::uint32_t>(sent.size())));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(hw::ACK, m_hw.in(4, got));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(hw::ACK, m_hw.in(4, got));
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+    CHECK_TRUE(sent == got);
+    LONGS_EQUAL(sent.size(), m_app.completions[0].len);
+
+    /* Neither buffer is sent again. */
+    for (int frame = 0; frame < 3; frame++)
+    {
+        got.clear();
+        LONGS_EQUAL(hw::ACK, m_hw.in(4, got));
+        CHECK_TRUE(got.empty());
+        LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    }
+
+    /* Armed again after an odd number of idle frames. */
+    got.clear();
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, ISO_IN, m_buf.data(), 10));
+    LONGS_EQUAL(hw::ACK, m_hw.in(4, got));
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+    CHECK_TRUE(std::equal(got.begin(), got.end(), sent.begin()) && got.size() == 10U);
+    LONGS_EQUAL(2, m_app.completions.size());
+}
+
+TEST(Stm32fs, IsochronousOutDropsPacketsWhileNotArmed)
+{
+    std::vector<std::uint8_t> sent = pattern(MPS, 7);
+    enumerate();
+
+    /* Not armed: accepted on the bus and dropped, in either buffer. */
+    LONGS_EQUAL(hw::ACK, m_hw.out(5, sent.data(), 8));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(hw::ACK, m_hw.out(5, sent.data(), 8));
+    LONGS_EQUAL(hw::ACK, m_hw.out(5, sent.data(), 8));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    CHECK_TRUE(m_app.completions.empty());
+
+    for (std::uint8_t frame = 0; frame < 3U; frame++)
+    {
+        std::uint16_t len = static_cast<std::uint16_t>(20U + frame);
+        CHECK_TRUE(cusb_device_ep_xfer(&m_dev, ISO_OUT, m_buf.data(), MPS));
+        LONGS_EQUAL(hw::ACK, m_hw.out(5, &sent[frame], len));
+        LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+        LONGS_EQUAL(len, m_app.completions[frame].len);
+        MEMCMP_EQUAL(&sent[frame], m_buf.data(), len);
+    }
+}
+
+TEST(Stm32fs, PacketLargerThanLayoutAsserts)
+{
+    enumerate();
+    cusb_device_ep_close(&m_dev, BULK_OUT);
+    CHECK_THROWS(stubs::assert_exception,
+                 cusb_device_ep_open(&m_dev, BULK_OUT, CUSB_EP_BULK, CUSB_STM32FS_PMA_EP1 + 2U, &app::done, &m_app));
+}
+
+/*------------------------------------------------------------*/
+/*---------------------- TESTS - ENDPOINT STATE --------------*/
+/*------------------------------------------------------------*/
+
+TEST(Stm32fs, ClearedHaltRestartsTransferOnDataZero)
+{
+    std::vector<std::uint8_t> sent = pattern(2U * MPS, 9);
+    std::vector<std::uint8_t> got;
+    enumerate();
+
+    std::copy(sent.begin(), sent.end(), m_buf.begin());
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_IN, m_buf.data(), 2U * MPS));
+    cusb_device_ep_stall(&m_dev, BULK_IN, true);
+    LONGS_EQUAL(hw::STALL, m_hw.in(2, got));
+
+    LONGS_EQUAL(hw::ACK, control(setup_packet(0x02, 1, 0, BULK_IN, 0)));
+    CHECK_EQUAL(0U, m_hw.reg(0x08) & 0x0040U);
+    LONGS_EQUAL(hw::ACK, m_hw.in(2, got));
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(hw::ACK, m_hw.in(2, got));
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+    CHECK_TRUE(sent == got);
+}
+
+TEST(Stm32fs, ClosedEndpointDoesNotAnswer)
+{
+    std::vector<std::uint8_t> got;
+    enumerate();
+
+    cusb_device_ep_close(&m_dev, PAIR_IN);
+    LONGS_EQUAL(hw::TIMEOUT, m_hw.in(3, got));
+    LONGS_EQUAL(hw::NAK, m_hw.out(3, m_buf.data(), 1));
+}
+
+/*------------------------------------------------------------*/
+/*------------------------ TESTS - INTERRUPTS ----------------*/
+/*------------------------------------------------------------*/
+
+TEST(Stm32fs, DeferredIsrMasksUntilPollDrainsEvents)
+{
+    start(false, true);
+
+    m_hw.suspend(true);
+    CHECK_TRUE(m_hw.irq());
+    cusb_stm32fs_isr(&m_drv);
+    CHECK_FALSE(m_hw.irq());
+    LONGS_EQUAL(1, m_app.wakes);
+
+    /* A budget the events use up leaves the sources masked. */
+    m_hw.suspend(false);
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 1));
+    CHECK_FALSE(m_hw.irq());
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+    CHECK_EQUAL(0x9C00U, m_hw.reg(0x40) & 0xFF00U);
+    CHECK_FALSE(m_hw.irq());
+}
+
+TEST(Stm32fs, SofOnlyReportedWhenEnabled)
+{
+    start(false);
+    m_hw.sof();
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    CHECK_TRUE(m_app.frames.empty());
+
+    start(true);
+    m_hw.sof();
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(1, m_app.frames.size());
+    LONGS_EQUAL(2, m_app.frames[0]);
+}
+
+TEST(Stm32fs, SuspendAndWakeupReachApplication)
+{
+    enumerate();
+    m_app.events.clear();
+
+    m_hw.suspend(true);
+    poll();
+    CHECK_EQUAL(0x0008U, m_hw.reg(0x40) & 0x0008U);
+    m_hw.suspend(false);
+    poll();
+    CHECK_EQUAL(0U, m_hw.reg(0x40) & 0x0008U);
+
+    LONGS_EQUAL(2, m_app.events.size());
+    LONGS_EQUAL(CUSB_DEVICE_EVENT_SUSPEND, m_app.events[0]);
+    LONGS_EQUAL(CUSB_DEVICE_EVENT_RESUME, m_app.events[1]);
+}
+
+
+/*------------------------------------------------------------*/
+/*---------------------- TESTS - REGISTER COST ---------------*/
+/*------------------------------------------------------------*/
+
+TEST(Stm32fs, PacketCostsTwoRegisterReadsAndOneWrite)
+{
+    /* ISTR and EPnR are read, EPnR written once, and one more ISTR read
+    finds nothing left. Covers every packet path: double-buffered IN
+    with a packet to stage, double-buffered OUT, single-buffered OUT and
+    the packet that completes a transfer. */
+    std::vector<std::uint8_t> data = pattern(3U * MPS, 5);
+    std::vector<std::uint8_t> got;
+    enumerate();
+
+    std::copy(data.begin(), data.end(), m_buf.begin());
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_IN, m_buf.data(), 3U * MPS));
+
+    for (unsigned i = 0; i < 3U; i++)
+    {
+        LONGS_EQUAL(hw::ACK, m_hw.in(2, got));
+        std::size_t mark = m_hw.bus.mark();
+        LONGS_EQUAL((i == 2U) ? 1 : 0, cusb_poll(&m_dev, 4));
+        cost c = since(mark);
+        LONGS_EQUAL(3, c.reads);
+        LONGS_EQUAL(1, c.writes);
+    }
+
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_OUT, m_buf.data(), 256));
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, PAIR_OUT, &m_buf[256], 256));
+
+    for (std::uint8_t num : {BULK_OUT, BULK_OUT, PAIR_OUT, PAIR_OUT})
+    {
+        LONGS_EQUAL(hw::ACK, m_hw.out(num, data.data(), MPS));
+        std::size_t mark = m_hw.bus.mark();
+        LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+        cost c = since(mark);
+        LONGS_EQUAL(3, c.reads);
+        LONGS_EQUAL(1, c.writes);
+    }
+}
+
+TEST(Stm32fs, PacketsInOnePollShareFinalIstrRead)
+{
+    std::vector<std::uint8_t> data = pattern(MPS, 5);
+    std::vector<std::uint8_t> got;
+    enumerate();
+
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_OUT, m_buf.data(), 256));
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, PAIR_OUT, &m_buf[256], 256));
+    LONGS_EQUAL(hw::ACK, m_hw.out(1, data.data(), MPS));
+    LONGS_EQUAL(hw::ACK, m_hw.out(3, data.data(), MPS));
+
+    std::size_t mark = m_hw.bus.mark();
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    cost c = since(mark);
+    LONGS_EQUAL(2 * 2 + 1, c.reads);
+    LONGS_EQUAL(2, c.writes);
+}
+
+TEST(Stm32fs, PmaAccessesFollowPacketLength)
+{
+    /* One 16-bit access per two bytes plus the count field. A double-
+    buffered IN packet copies the next one, the last copies nothing. */
+    std::vector<std::uint8_t> data = pattern(2U * MPS + 10U, 5);
+    std::vector<std::uint8_t> got;
+    enumerate();
+
+    std::copy(data.begin(), data.end(), m_buf.begin());
+    std::size_t mark = m_hw.bus.mark();
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_IN, m_buf.data(), 2U * MPS + 10U));
+    LONGS_EQUAL(2 * (MPS / 2 + 1), since(mark).pma_writes);
+
+    LONGS_EQUAL(hw::ACK, m_hw.in(2, got));
+    mark = m_hw.bus.mark();
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(10 / 2 + 1, since(mark).pma_writes);
+
+    LONGS_EQUAL(hw::ACK, m_hw.in(2, got));
+    mark = m_hw.bus.mark();
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    LONGS_EQUAL(0, since(mark).pma_writes);
+
+    CHECK_TRUE(cusb_device_ep_xfer(&m_dev, BULK_OUT, m_buf.data(), 256));
+    LONGS_EQUAL(hw::ACK, m_hw.out(1, data.data(), 10));
+    mark = m_hw.bus.mark();
+    LONGS_EQUAL(1, cusb_poll(&m_dev, 4));
+    cost c = since(mark);
+    LONGS_EQUAL(10 / 2 + 1, c.pma_reads);
+    LONGS_EQUAL(0, c.pma_writes);
+}
+
+TEST(Stm32fs, DeferredIsrIsOneRegisterWrite)
+{
+    start(false, true);
+    m_hw.suspend(true);
+
+    std::size_t mark = m_hw.bus.mark();
+    cusb_stm32fs_isr(&m_drv);
+    cost c = since(mark);
+    LONGS_EQUAL(0, c.reads);
+    LONGS_EQUAL(1, c.writes);
+}
+
+TEST(Stm32fs, IdlePollIsOneRegisterRead)
+{
+    enumerate();
+
+    std::size_t mark = m_hw.bus.mark();
+    LONGS_EQUAL(0, cusb_poll(&m_dev, 4));
+    cost c = since(mark);
+    LONGS_EQUAL(1, c.reads);
+    LONGS_EQUAL(0, c.writes);
+}
@@ -0,0 +1,382 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref stream.h
+ *
+ * Test Summary:
+ *
+ * cusb_stream_ctor()
+ *      - TEST(Stream, CtorRejectsNonPowerOfTwoSize)
+ *
+ * cusb_stream_in_acquire(), cusb_stream_in_complete()
+ *      - TEST(Stream, InWaitsForWatermark)
+ *      - TEST(Stream, InSendsPacketMultiplesInPlace)
+ *      - TEST(Stream, InWrapAroundStopsAtBufferEnd)
+ *      - TEST(Stream, InUnalignedWrapCarriesRemainderForward)
+ *      - TEST(Stream, InOneTransferInFlight)
+ *      - TEST(Stream, InSpaceReleasedOnCompletion)
+ *
+ * cusb_stream_flush()
+ *      - TEST(Stream, FlushEndsWithShortPacket)
+ *      - TEST(Stream, FlushEndsWithZlpOnPacketMultiple)
+ *      - TEST(Stream, FlushLargerThanMaxTransfer)
+ *      - TEST(Stream, FlushWithNothingOpenSendsNothing)
+ *
+ * cusb_stream_write_commit()
+ *      - TEST(Stream, OverflowAccountedAndOldestDataDropped)
+ *
+ * cusb_stream_out_acquire(), cusb_stream_out_complete()
+ *      - TEST(Stream, OutReceivesInPlaceAndThrottles)
+ *      - TEST(Stream, OutShortTransfer)
+ *
+ * cusb_stream_reset()
+ *      - TEST(Stream, ResetDropsData)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/stream.h"
+
+/* STDLib. */
+#include <cstring>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint16_t PACKET_SIZE = 64;
+constexpr std::size_t BUFFER_SIZE = 1024;
+constexpr std::size_t MAX_TRANSFER = 512;
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Stream)
+{
+    void setup() override
+    {
+        cusb_stream_ctor(&m_in, CUSB_STREAM_IN, m_buf, sizeof(m_buf), PACKET_SIZE);
+        cusb_stream_ctor(&m_out, CUSB_STREAM_OUT, m_out_buf, sizeof(m_out_buf), PACKET_SIZE);
+    }
+
+    /**
+     * @brief Writes @p len bytes of an incrementing pattern the way
+     * a DMA would, then commits them.
+     */
+    void produce(std::size_t len)
+    {
+        for (std::size_t i = 0; i < len; i++)
+        {
+            m_buf[(m_written + i) % BUFFER_SIZE] = static_cast<std::uint8_t>(m_written + i);
+        }
+        m_written += len;
+        cusb_stream_write_commit(&m_in, len);
+    }
+
+    /**
+     * @brief Checks that @p iov holds the pattern starting at byte @p first.
+     */
+    void check_pattern(const cusb_stream_iov *iov, std::size_t first)
+    {
+        for (int s = 0; s < 2; s++)
+        {
+            for (std::size_t i = 0; i < iov[s].len; i++)
+            {
+                BYTES_EQUAL(static_cast<std::uint8_t>(first++), iov[s].base[i]);
+            }
+        }
+    }
+
+    bool acquire(std::size_t max = MAX_TRANSFER)
+    {
+        return cusb_stream_in_acquire(&m_in, m_iov, max, &m_len);
+    }
+
+    struct cusb_stream m_in;
+    struct cusb_stream m_out;
+    std::uint8_t m_buf[BUFFER_SIZE];
+    std::uint8_t m_out_buf[BUFFER_SIZE];
+    std::size_t m_written = 0;
+    struct cusb_stream_iov m_iov[2];
+    std::size_t m_len = 0;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Stream, CtorRejectsNonPowerOfTwoSize)
+{
+    CHECK_THROWS(stubs::assert_exception, (cusb_stream_ctor(&m_in, CUSB_STREAM_IN, m_buf, 1000, PACKET_SIZE)));
+    CHECK_THROWS(stubs::assert_exception, (cusb_stream_ctor(&m_in, CUSB_STREAM_IN, m_buf, 32, PACKET_SIZE)));
+}
+
+TEST(Stream, InWaitsForWatermark)
+{
+    cusb_stream_set_watermark(&m_in, 256);
+    produce(200);
+    CHECK_FALSE( (acquire()) );
+    produce(100);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(256, m_len);
+}
+
+TEST(Stream, InSendsPacketMultiplesInPlace)
+{
+    produce(700);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(MAX_TRANSFER, m_len);
+    POINTERS_EQUAL(m_buf, m_iov[0].base);
+    UNSIGNED_LONGS_EQUAL(0, m_iov[1].len);
+    cusb_stream_in_complete(&m_in);
+
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(128, m_len);
+    POINTERS_EQUAL(&m_buf[512], m_iov[0].base);
+    check_pattern(m_iov, 512);
+}
+
+TEST(Stream, InWrapAroundStopsAtBufferEnd)
+{
+    produce(768);
+    CHECK_TRUE( (acquire()) );
+    cusb_stream_in_complete(&m_in);
+    CHECK_TRUE( (acquire()) );
+    cusb_stream_in_complete(&m_in);
+
+    produce(512);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(256, m_len);
+    POINTERS_EQUAL(&m_buf[768], m_iov[0].base);
+    UNSIGNED_LONGS_EQUAL(256, m_iov[0].len);
+    UNSIGNED_LONGS_EQUAL(0, m_iov[1].len);
+    check_pattern(m_iov, 768);
+    cusb_stream_in_complete(&m_in);
+
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(256, m_len);
+    POINTERS_EQUAL(m_buf, m_iov[0].base);
+    check_pattern(m_iov, 1024);
+}
+
+TEST(Stream, InUnalignedWrapCarriesRemainderForward)
+{
+    /* Flush leaves the queue position at 100, off a packet boundary. */
+    produce(100);
+    cusb_stream_flush(&m_in);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(100, m_len);
+    cusb_stream_in_complete(&m_in);
+
+    produce(1000);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(512, m_len);
+    cusb_stream_in_complete(&m_in);
+
+    /* 412 bytes left before the end. Whole packets only, rest carried forward. */
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(384, m_len);
+    POINTERS_EQUAL(&m_buf[612], m_iov[0].base);
+    UNSIGNED_LONGS_EQUAL(384, m_iov[0].len);
+    UNSIGNED_LONGS_EQUAL(0, m_iov[1].len);
+    check_pattern(m_iov, 612);
+    cusb_stream_in_complete(&m_in);
+
+    /* 28 bytes before the end and 36 after it make up one full packet. */
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(64, m_len);
+    UNSIGNED_LONGS_EQUAL(64, m_iov[0].len);
+    UNSIGNED_LONGS_EQUAL(0, m_iov[1].len);
+    check_pattern(m_iov, 996);
+    cusb_stream_in_complete(&m_in);
+
+    CHECK_FALSE( (acquire()) );
+    cusb_stream_flush(&m_in);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(40, m_len);
+    POINTERS_EQUAL(&m_buf[36], m_iov[0].base);
+    check_pattern(m_iov, 1060);
+}
+
+TEST(Stream, InOneTransferInFlight)
+{
+    produce(1024);
+    CHECK_TRUE( (acquire()) );
+    CHECK_FALSE( (acquire()) );
+    cusb_stream_in_complete(&m_in);
+    CHECK_TRUE( (acquire()) );
+}
+
+TEST(Stream, InSpaceReleasedOnCompletion)
+{
+    cusb_stream_iov space[2];
+    produce(1024);
+    UNSIGNED_LONGS_EQUAL(0, cusb_stream_write_space(&m_in, space));
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(0, cusb_stream_write_space(&m_in, space));
+    cusb_stream_in_complete(&m_in);
+    UNSIGNED_LONGS_EQUAL(512, cusb_stream_write_space(&m_in, space));
+    POINTERS_EQUAL(m_buf, space[0].base);
+    UNSIGNED_LONGS_EQUAL(512, space[0].len);
+    UNSIGNED_LONGS_EQUAL(0, space[1].len);
+
+    const cusb_stream_stats *stats = cusb_stream_get_stats(&m_in);
+    UNSIGNED_LONGS_EQUAL(512, stats->bytes);
+    UNSIGNED_LONGS_EQUAL(1, stats->transfers);
+}
+
+TEST(Stream, FlushEndsWithShortPacket)
+{
+    produce(100);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(64, m_len);
+    cusb_stream_in_complete(&m_in);
+    CHECK_FALSE( (acquire()) );
+
+    cusb_stream_flush(&m_in);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(36, m_len);
+    cusb_stream_in_complete(&m_in);
+    CHECK_FALSE( (acquire()) );
+}
+
+TEST(Stream, FlushEndsWithZlpOnPacketMultiple)
+{
+    produce(128);
+    cusb_stream_flush(&m_in);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(128, m_len);
+    cusb_stream_in_complete(&m_in);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(0, m_len);
+    cusb_stream_in_complete(&m_in);
+    CHECK_FALSE( (acquire()) );
+
+    /* Transfer already sent in full with no short packet yet. */
+    produce(64);
+    CHECK_TRUE( (acquire()) );
+    cusb_stream_in_complete(&m_in);
+    cusb_stream_flush(&m_in);
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(0, m_len);
+}
+
+TEST(Stream, FlushLargerThanMaxTransfer)
+{
+    produce(600);
+    cusb_stream_flush(&m_in);
+    CHECK_TRUE( (acquire(256)) );
+    UNSIGNED_LONGS_EQUAL(256, m_len);
+    cusb_stream_in_complete(&m_in);
+    CHECK_TRUE( (acquire(256)) );
+    UNSIGNED_LONGS_EQUAL(256, m_len);
+    cusb_stream_in_complete(&m_in);
+    CHECK_TRUE( (acquire(256)) );
+    UNSIGNED_LONGS_EQUAL(88, m_len);
+    cusb_stream_in_complete(&m_in);
+    CHECK_FALSE( (acquire(256)) );
+}
+
+TEST(Stream, FlushWithNothingOpenSendsNothing)
+{
+    cusb_stream_flush(&m_in);
+    CHECK_FALSE( (acquire()) );
+    produce(32);
+    CHECK_FALSE( (acquire()) );
+}
+
+TEST(Stream, OverflowAccountedAndOldestDataDropped)
+{
+    produce(512);
+    CHECK_TRUE( (acquire()) );
+
+    /* DMA keeps running while the first 512 bytes are in flight. */
+    produce(512);
+    produce(256);
+    const cusb_stream_stats *stats = cusb_stream_get_stats(&m_in);
+    UNSIGNED_LONGS_EQUAL(1, stats->overflow_events);
+    UNSIGNED_LONGS_EQUAL(256, stats->overflow_bytes);
+    cusb_stream_in_complete(&m_in);
+
+    /* Fills the buffer exactly, then overruns the oldest unsent bytes. */
+    produce(256);
+    UNSIGNED_LONGS_EQUAL(1, stats->overflow_events);
+    produce(64);
+    UNSIGNED_LONGS_EQUAL(2, stats->overflow_events);
+    UNSIGNED_LONGS_EQUAL(320, stats->overflow_bytes);
+
+    /* Host resumes at the oldest of the newest 1024 bytes, up to the buffer end. */
+    CHECK_TRUE( (acquire()) );
+    UNSIGNED_LONGS_EQUAL(448, m_len);
+    check_pattern(m_iov, 1600 - 1024);
+    cusb_stream_in_complete(&m_in);
+
+    cusb_stream_iov space[2];
+    UNSIGNED_LONGS_EQUAL(448, cusb_stream_write_space(&m_in, space));
+}
+
+TEST(Stream, OutReceivesInPlaceAndThrottles)
+{
+    cusb_stream_iov data[2];
+
+    CHECK_TRUE( (cusb_stream_out_acquire(&m_out, m_iov, MAX_TRANSFER, &m_len)) );
+    UNSIGNED_LONGS_EQUAL(MAX_TRANSFER, m_len);
+    POINTERS_EQUAL(m_out_buf, m_iov[0].base);
+    std::memset(m_iov[0].base, 0xAB, m_len);
+    cusb_stream_out_complete(&m_out, m_len);
+
+    CHECK_TRUE( (cusb_stream_out_acquire(&m_out, m_iov, MAX_TRANSFER, &m_len)) );
+    cusb_stream_out_complete(&m_out, m_len);
+    CHECK_FALSE( (cusb_stream_out_acquire(&m_out, m_iov, MAX_TRANSFER, &m_len)) );
+    CHECK_FALSE( (cusb_stream_out_acquire(&m_out, m_iov, MAX_TRANSFER, &m_len)) );
+    UNSIGNED_LONGS_EQUAL(1, cusb_stream_get_stats(&m_out)->throttled);
+
+    UNSIGNED_LONGS_EQUAL(1024, cusb_stream_read_data(&m_out, data));
+    BYTES_EQUAL(0xAB, data[0].base[0]);
+    cusb_stream_read_release(&m_out, 100);
+
+    /* Less than two packets free, so only one packet can be received. */
+    CHECK_TRUE( (cusb_stream_out_acquire(&m_out, m_iov, MAX_TRANSFER, &m_len)) );
+    UNSIGNED_LONGS_EQUAL(64, m_len);
+}
+
+TEST(Stream, OutShortTransfer)
+{
+    cusb_stream_iov data[2];
+
+    CHECK_TRUE( (cusb_stream_out_acquire(&m_out, m_iov, MAX_TRANSFER, &m_len)) );
+    cusb_stream_out_complete(&m_out, 10);
+    UNSIGNED_LONGS_EQUAL(10, cusb_stream_read_data(&m_out, data));
+
+    /* Next transfer starts right after the short one. */
+    CHECK_TRUE( (cusb_stream_out_acquire(&m_out, m_iov, MAX_TRANSFER, &m_len)) );
+    POINTERS_EQUAL(&m_out_buf[10], m_iov[0].base);
+    CHECK_THROWS(stubs::assert_exception, (cusb_stream_out_complete(&m_out, MAX_TRANSFER + 1)));
+}
+
+TEST(Stream, ResetDropsData)
+{
+    cusb_stream_iov space[2];
+    produce(600);
+    CHECK_TRUE( (acquire()) );
+    cusb_stream_reset(&m_in);
+    UNSIGNED_LONGS_EQUAL(BUFFER_SIZE, cusb_stream_write_space(&m_in, space));
+    CHECK_FALSE( (acquire()) );
+}
@@ -0,0 +1,163 @@
+/**
+ * @file
+ * @brief Unit tests for the register file of stubs/stub_regs.hpp that
+ * driver tests rely on.
+ *
+ * Test Summary:
+ *
+ * Bits
+ *      - TEST(StubRegs, UndefinedAddressIsPlainMemory)
+ *      - TEST(StubRegs, WriteAppliesEachBitBehaviour)
+ *      - TEST(StubRegs, ResetRestoresDefinedRegistersOnly)
+ *
+ * Hooks
+ *      - TEST(StubRegs, ReadHookSeesStoredValue)
+ *      - TEST(StubRegs, WriteHookRunsAfterBitsUpdated)
+ *      - TEST(StubRegs, FifoPopsOnRead)
+ *
+ * Trace
+ *      - TEST(StubRegs, ModelAccessesAreNotTraced)
+ *      - TEST(StubRegs, CountsAccessesSinceMarkInRange)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Stubs. */
+#include "stubs/stub_regs.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(StubRegs)
+{
+    static constexpr std::uint32_t REG = 0x1000U;
+    static constexpr std::uint32_t FIFO = 0x1004U;
+    static constexpr std::uint32_t RAM = 0x2000U;
+
+    stubs::regs m_regs;
+};
+
+/*------------------------------------------------------------*/
+/*------------------------- TESTS - BITS ---------------------*/
+/*------------------------------------------------------------*/
+
+TEST(StubRegs, UndefinedAddressIsPlainMemory)
+{
+    LONGS_EQUAL(0, m_regs.read(RAM));
+    m_regs.write(RAM, 0xDEADBEEFU);
+    LONGS_EQUAL(0xDEADBEEFU, m_regs.read(RAM));
+}
+
+TEST(StubRegs, WriteAppliesEachBitBehaviour)
+{
+    /* Nibbles from the top: read-only, rw, w1c, w0c, toggle. */
+    m_regs.define(REG, {.rw = 0x0F000U, .w1c = 0x00F00U, .w0c = 0x000F0U, .toggle = 0x0000FU}, 0xF0FF0U);
+
+    m_regs.write(REG, 0x0A5A5U);
+    LONGS_EQUAL(0xFAAA5U, m_regs.peek(REG));
+
+    m_regs.write(REG, 0x00000U);
+    LONGS_EQUAL(0xF0A05U, m_regs.peek(REG));
+}
+
+TEST(StubRegs, ResetRestoresDefinedRegistersOnly)
+{
+    m_regs.define(REG, {.rw = 0xFFU}, 0x12U);
+    m_regs.fifo(FIFO);
+    m_regs.write(REG, 0x34U);
+    m_regs.write(RAM, 0x56U);
+    m_regs.push(FIFO, 1U);
+
+    m_regs.reset();
+    LONGS_EQUAL(0x12U, m_regs.peek(REG));
+    LONGS_EQUAL(0x56U, m_regs.peek(RAM));
+    LONGS_EQUAL(0, m_regs.pending(FIFO));
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- TESTS - HOOKS --------------------*/
+/*------------------------------------------------------------*/
+
+TEST(StubRegs, ReadHookSeesStoredValue)
+{
+    m_regs.define(REG, {.rw = 0xFFU}, 0x01U);
+    m_regs.on_read(REG, [](std::uint32_t stored) { return stored | 0x100U; });
+
+    LONGS_EQUAL(0x101U, m_regs.read(REG));
+    LONGS_EQUAL(0x01U, m_regs.peek(REG));
+    LONGS_EQUAL(0x101U, m_regs.trace.back().val);
+}
+
+TEST(StubRegs, WriteHookRunsAfterBitsUpdated)
+{
+    std::uint32_t seen_val = 0;
+    std::uint32_t seen_reg = 0;
+    m_regs.define(REG, {.w1c = 0xFFU}, 0xFFU);
+    m_regs.on_write(REG, [&](std::uint32_t val)
+    {
+        seen_val = val;
+        seen_reg = m_regs.peek(REG);
+    });
+
+    m_regs.write(REG, 0x0FU);
+    LONGS_EQUAL(0x0FU, seen_val);
+    LONGS_EQUAL(0xF0U, seen_reg);
+}
+
+TEST(StubRegs, FifoPopsOnRead)
+{
+    m_regs.fifo(FIFO);
+    m_regs.push(FIFO, 0x11U);
+    m_regs.push(FIFO, 0x22U);
+
+    m_regs.write(FIFO, 0x33U);
+    LONGS_EQUAL(2, m_regs.pending(FIFO));
+    LONGS_EQUAL(0x11U, m_regs.read(FIFO));
+    LONGS_EQUAL(0x22U, m_regs.read(FIFO));
+    LONGS_EQUAL(0, m_regs.read(FIFO));
+    LONGS_EQUAL(0, m_regs.pending(FIFO));
+}
+
+/*------------------------------------------------------------*/
+/*------------------------- TESTS - TRACE --------------------*/
+/*------------------------------------------------------------*/
+
+TEST(StubRegs, ModelAccessesAreNotTraced)
+{
+    m_regs.define(REG, {.w0c = 0xFFU});
+    m_regs.poke(REG, 0x0FU);
+    m_regs.set(REG, 0xF0U);
+    m_regs.clear(REG, 0x01U);
+
+    LONGS_EQUAL(0xFEU, m_regs.peek(REG));
+    CHECK_TRUE(m_regs.trace.empty());
+}
+
+TEST(StubRegs, CountsAccessesSinceMarkInRange)
+{
+    m_regs.write(REG, 1U);
+    std::size_t mark = m_regs.mark();
+
+    (void)m_regs.read(REG);
+    (void)m_regs.read(RAM);
+    m_regs.write(RAM, 2U);
+    m_regs.write(RAM + 4U, 3U);
+
+    LONGS_EQUAL(2, m_regs.reads(mark));
+    LONGS_EQUAL(2, m_regs.writes(mark));
+    LONGS_EQUAL(1, m_regs.reads(mark, REG, RAM));
+    LONGS_EQUAL(0, m_regs.writes(mark, REG, RAM));
+    LONGS_EQUAL(1, m_regs.writes(mark, RAM, RAM + 4U));
+    LONGS_EQUAL(3, m_regs.writes(0));
+}
@@ -0,0 +1,577 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref uas.h
+ *
+ * Test Summary:
+ *
+ * cusb_uas_command_out(), cusb_uas_status_in()
+ *      - TEST(Uas, CommandWithoutData)
+ *      - TEST(Uas, CompletesOutOfOrder)
+ *      - TEST(Uas, TaskSetFull)
+ *      - TEST(Uas, OverlappedTag)
+ *      - TEST(Uas, IncorrectLun)
+ *      - TEST(Uas, InvalidIu)
+ *
+ * cusb_uas_data_in()
+ *      - TEST(Uas, ReadReadyThenData)
+ *      - TEST(Uas, DataInOwnedByOneTask)
+ *      - TEST(Uas, ShortReadEndsWithZeroLengthPacket)
+ *
+ * cusb_uas_data_out(), cusb_uas_data_out_space()
+ *      - TEST(Uas, WriteReadyThenData)
+ *      - TEST(Uas, ShortPacketEndsDataOut)
+ *
+ * Task management
+ *      - TEST(Uas, AbortTaskSuppressesStatus)
+ *      - TEST(Uas, QueryTask)
+ *
+ * cusb_uas_reset()
+ *      - TEST(Uas, ResetAbortsEverything)
+ *
+ * Multiple logical units
+ *      - TEST(UasMultiLun, SlowLunDoesNotStarveOthers)
+ *      - TEST(UasMultiLun, EveryIdleLunKeepsASlot)
+ *      - TEST(UasMultiLun, ReportLuns)
+ *      - TEST(UasMultiLun, LogicalUnitResetIsPerLun)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/uas.h"
+
+/* STDLib. */
+#include <cstring>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+#include "stubs/stub_blockdev.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint32_t BLOCK_SIZE = 512;
+constexpr std::uint32_t BLOCK_COUNT = 64;
+constexpr std::size_t QUEUE_DEPTH = 3;
+constexpr std::size_t TASK_BUFFER_SIZE = 4 * BLOCK_SIZE;
+constexpr std::uint16_t PACKET_SIZE = 512;
+
+constexpr std::uint8_t IU_SENSE = 0x03;
+constexpr std::uint8_t IU_RESPONSE = 0x04;
+constexpr std::uint8_t IU_READ_READY = 0x06;
+constexpr std::uint8_t IU_WRITE_READY = 0x07;
+
+const struct cusb_scsi_inquiry INQUIRY = {"cusb", "UAS Test", "1.0"};
+
+std::vector<std::uint8_t> command_iu(std::uint16_t tag, std::vector<std::uint8_t> cdb, std::uint8_t lun = 0)
+{
+    std::vector<std::uint8_t> iu(32, 0);
+    iu[0] = 0x01;
+    iu[2] = static_cast<std::uint8_t>(tag >> 8);
+    iu[3] = static_cast<std::uint8_t>(tag);
+    iu[9] = lun;
+    std::copy(cdb.begin(), cdb.end(), iu.begin() + 16);
+    return iu;
+}
+
+std::vector<std::uint8_t> tm_iu(std::uint16_t tag, std::uint8_t function, std::uint16_t task_tag)
+{
+    std::vector<std::uint8_t> iu(16, 0);
+    iu[0] = 0x05;
+    iu[2] = static_cast<std::uint8_t>(tag >> 8);
+    iu[3] = static_cast<std::uint8_t>(tag);
+    iu[4] = function;
+    iu[6] = static_cast<std::uint8_t>(task_tag >> 8);
+    iu[7] = static_cast<std::uint8_t>(task_tag);
+    return iu;
+}
+
+std::vector<std::uint8_t> read10(std::uint32_t lba, std::uint16_t blocks)
+{
+    return {0x28, 0, 0, 0, static_cast<std::uint8_t>(lba >> 8), static_cast<std::uint8_t>(lba), 0,
+            static_cast<std::uint8_t>(blocks >> 8), static_cast<std::uint8_t>(blocks), 0};
+}
+
+std::vector<std::uint8_t> write10(std::uint32_t lba, std::uint16_t blocks)
+{
+    std::vector<std::uint8_t> cdb = read10(lba, blocks);
+    cdb[0] = 0x2A;
+    return cdb;
+}
+
+void on_notify(void *ctx)
+{
+    (*static_cast<int *>(ctx))++;
+}
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Uas)
+{
+    void setup() override
+    {
+        m_disk.fill_pattern();
+        cusb_scsi_ctor(&m_scsi, &m_disk.dev, &INQUIRY);
+        cusb_uas_ctor(&m_uas, &m_scsi, 1, m_tasks, QUEUE_DEPTH, &m_buffers[0][0], TASK_BUFFER_SIZE,
+                      PACKET_SIZE, &on_notify, &m_notifications);
+    }
+
+    void send(const std::vector<std::uint8_t> &iu)
+    {
+        cusb_uas_command_out(&m_uas, iu.data(), iu.size());
+    }
+
+    /**
+     * @brief Returns next status IU, empty if nothing to send.
+     */
+    std::vector<std::uint8_t> status()
+    {
+        std::uint8_t buf[CUSB_UAS_STATUS_IU_MAX];
+        std::size_t len = 0;
+
+        if (!cusb_uas_status_in(&m_uas, buf, sizeof(buf), &len))
+        {
+            return {};
+        }
+
+        return std::vector<std::uint8_t>(buf, buf + len);
+    }
+
+    void check_status(std::uint8_t iu, std::uint16_t tag)
+    {
+        std::vector<std::uint8_t> s = status();
+        CHECK_TRUE( (s.size() >= 4) );
+        BYTES_EQUAL(iu, s[0]);
+        UNSIGNED_LONGS_EQUAL(tag, (s[2] << 8) | s[3]);
+        m_last = s;
+    }
+
+    /**
+     * @brief Drains Data-In pipe. Returns bytes received.
+     */
+    std::vector<std::uint8_t> data_in()
+    {
+        std::vector<std::uint8_t> out;
+        std::uint8_t buf[PACKET_SIZE];
+        std::size_t len = 0;
+
+        while (cusb_uas_data_in(&m_uas, buf, sizeof(buf), &len))
+        {
+            out.insert(out.end(), buf, buf + len);
+            m_packets++;
+            if (len < sizeof(buf))
+            {
+                break;
+            }
+        }
+
+        return out;
+    }
+
+    stubs::blockdev m_disk{BLOCK_SIZE, BLOCK_COUNT, true};
+    struct cusb_scsi m_scsi;
+    struct cusb_uas m_uas;
+    struct cusb_scsi_task m_tasks[QUEUE_DEPTH];
+    std::uint8_t m_buffers[QUEUE_DEPTH][TASK_BUFFER_SIZE];
+    std::vector<std::uint8_t> m_last;
+    int m_notifications = 0;
+    int m_packets = 0;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Uas, CommandWithoutData)
+{
+    send(command_iu(7, {0x00}));
+    LONGS_EQUAL(1, m_notifications);
+    check_status(IU_SENSE, 7);
+    LONGS_EQUAL(16, m_last.size());
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, m_last[6]);
+    CHECK_TRUE( (status().empty()) );
+}
+
+TEST(Uas, CompletesOutOfOrder)
+{
+    send(command_iu(1, read10(0, 1)));
+    send(command_iu(2, read10(8, 1)));
+    send(command_iu(3, {0x35}));
+    UNSIGNED_LONGS_EQUAL(3, m_disk.queue.size());
+    CHECK_TRUE( (status().empty()) );
+
+    /* Backend finishes the cache flush first, then the second read. */
+    m_disk.complete(2);
+    check_status(IU_SENSE, 3);
+    m_disk.complete(1);
+    check_status(IU_READ_READY, 2);
+    std::vector<std::uint8_t> data = data_in();
+    BYTES_EQUAL(stubs::blockdev::pattern(8, 0), data[0]);
+    check_status(IU_SENSE, 2);
+
+    m_disk.complete(0);
+    check_status(IU_READ_READY, 1);
+    data = data_in();
+    BYTES_EQUAL(stubs::blockdev::pattern(0, 1), data[1]);
+    check_status(IU_SENSE, 1);
+}
+
+TEST(Uas, TaskSetFull)
+{
+    for (std::uint16_t tag = 1; tag <= QUEUE_DEPTH + 1; tag++)
+    {
+        send(command_iu(tag, read10(tag, 1)));
+    }
+
+    check_status(IU_SENSE, QUEUE_DEPTH + 1);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_TASK_SET_FULL, m_last[6]);
+    UNSIGNED_LONGS_EQUAL(QUEUE_DEPTH, m_disk.queue.size());
+}
+
+TEST(Uas, OverlappedTag)
+{
+    send(command_iu(5, read10(0, 1)));
+    send(command_iu(5, read10(1, 1)));
+    check_status(IU_RESPONSE, 5);
+    BYTES_EQUAL(0x0A, m_last[7]);
+}
+
+TEST(Uas, IncorrectLun)
+{
+    send(command_iu(5, {0x00}, 1));
+    check_status(IU_RESPONSE, 5);
+    BYTES_EQUAL(0x09, m_last[7]);
+    UNSIGNED_LONGS_EQUAL(0, m_disk.queue.size());
+}
+
+TEST(Uas, InvalidIu)
+{
+    std::vector<std::uint8_t> iu = command_iu(9, {0x00});
+    iu[0] = 0x42;
+    send(iu);
+    check_status(IU_RESPONSE, 9);
+    BYTES_EQUAL(0x02, m_last[7]);
+}
+
+TEST(Uas, ReadReadyThenData)
+{
+    send(command_iu(1, read10(4, 6)));
+    m_disk.complete();
+
+    /* Nothing on Data-In before READ READY. */
+    std::uint8_t pkt[PACKET_SIZE];
+    std::size_t len = 0;
+    CHECK_FALSE( (cusb_uas_data_in(&m_uas, pkt, sizeof(pkt), &len)) );
+    check_status(IU_READ_READY, 1);
+
+    /* Second chunk is still being read. */
+    std::vector<std::uint8_t> data = data_in();
+    LONGS_EQUAL(TASK_BUFFER_SIZE, data.size());
+    CHECK_TRUE( (status().empty()) );
+
+    m_disk.complete();
+    std::vector<std::uint8_t> rest = data_in();
+    data.insert(data.end(), rest.begin(), rest.end());
+    LONGS_EQUAL(6 * BLOCK_SIZE, data.size());
+    BYTES_EQUAL(stubs::blockdev::pattern(9, 511), data.back());
+    check_status(IU_SENSE, 1);
+}
+
+TEST(Uas, DataInOwnedByOneTask)
+{
+    send(command_iu(1, read10(0, 1)));
+    send(command_iu(2, read10(1, 1)));
+    m_disk.complete(0);
+    m_disk.complete(0);
+
+    check_status(IU_READ_READY, 1);
+    CHECK_TRUE( (status().empty()) );
+    (void)data_in();
+
+    /* Status pipe is served round-robin. */
+    check_status(IU_READ_READY, 2);
+    check_status(IU_SENSE, 1);
+}
+
+TEST(Uas, ShortReadEndsWithZeroLengthPacket)
+{
+    send(command_iu(1, read10(0, 6)));
+    m_disk.complete();
+    check_status(IU_READ_READY, 1);
+    (void)data_in();
+
+    m_disk.complete(0, false);
+    m_packets = 0;
+    LONGS_EQUAL(0, data_in().size());
+    LONGS_EQUAL(1, m_packets);
+
+    check_status(IU_SENSE, 1);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, m_last[6]);
+    LONGS_EQUAL(16 + CUSB_SCSI_SENSE_SIZE, m_last.size());
+    BYTES_EQUAL(0x03, m_last[16 + 2]);
+}
+
+TEST(Uas, WriteReadyThenData)
+{
+    std::uint8_t pkt[PACKET_SIZE];
+    send(command_iu(1, write10(2, 5)));
+    UNSIGNED_LONGS_EQUAL(0, cusb_uas_data_out_space(&m_uas));
+    check_status(IU_WRITE_READY, 1);
+
+    std::size_t sent = 0;
+    while (sent < 5 * BLOCK_SIZE)
+    {
+        std::size_t space = cusb_uas_data_out_space(&m_uas);
+        if (space == 0)
+        {
+            /* First chunk being written. */
+            UNSIGNED_LONGS_EQUAL(TASK_BUFFER_SIZE, sent);
+            m_disk.complete();
+            continue;
+        }
+
+        std::memset(pkt, static_cast<int>(sent / BLOCK_SIZE), sizeof(pkt));
+        cusb_uas_data_out(&m_uas, pkt, sizeof(pkt));
+        sent += sizeof(pkt);
+    }
+
+    UNSIGNED_LONGS_EQUAL(0, cusb_uas_data_out_space(&m_uas));
+    CHECK_TRUE( (status().empty()) );
+    m_disk.complete();
+    check_status(IU_SENSE, 1);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, m_last[6]);
+    BYTES_EQUAL(4, m_disk.data[6 * BLOCK_SIZE]);
+}
+
+TEST(Uas, ShortPacketEndsDataOut)
+{
+    std::uint8_t pkt[PACKET_SIZE];
+    std::memset(pkt, 0xAA, sizeof(pkt));
+    send(command_iu(1, write10(2, 2)));
+    check_status(IU_WRITE_READY, 1);
+
+    cusb_uas_data_out(&m_uas, pkt, PACKET_SIZE - 1U);
+    UNSIGNED_LONGS_EQUAL(0, cusb_uas_data_out_space(&m_uas));
+    check_status(IU_SENSE, 1);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_CHECK_CONDITION, m_last[6]);
+    BYTES_EQUAL(0x0B, m_last[16 + 2]);
+    BYTES_EQUAL(0x4B, m_last[16 + 12]);
+    CHECK_TRUE( (m_disk.data[2 * BLOCK_SIZE] != 0xAA) );
+
+    /* Data-Out pipe is free for the next write. */
+    send(command_iu(2, write10(4, 1)));
+    check_status(IU_WRITE_READY, 2);
+    cusb_uas_data_out(&m_uas, pkt, sizeof(pkt));
+    m_disk.complete();
+    check_status(IU_SENSE, 2);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, m_last[6]);
+    BYTES_EQUAL(0xAA, m_disk.data[4 * BLOCK_SIZE]);
+}
+
+TEST(Uas, AbortTaskSuppressesStatus)
+{
+    send(command_iu(1, read10(0, 1)));
+    send(command_iu(2, read10(1, 1)));
+    send(tm_iu(10, 0x01, 1));
+    check_status(IU_RESPONSE, 10);
+    BYTES_EQUAL(0x00, m_last[7]);
+
+    m_disk.complete(0);
+    m_disk.complete(0);
+    check_status(IU_READ_READY, 2);
+    (void)data_in();
+    check_status(IU_SENSE, 2);
+    CHECK_TRUE( (status().empty()) );
+
+    /* Tag is free again. */
+    send(command_iu(1, {0x00}));
+    check_status(IU_SENSE, 1);
+}
+
+TEST(Uas, QueryTask)
+{
+    send(command_iu(1, read10(0, 1)));
+    send(tm_iu(10, 0x80, 1));
+    send(tm_iu(11, 0x80, 2));
+    check_status(IU_RESPONSE, 10);
+    BYTES_EQUAL(0x08, m_last[7]);
+    check_status(IU_RESPONSE, 11);
+    BYTES_EQUAL(0x00, m_last[7]);
+}
+
+TEST(Uas, ResetAbortsEverything)
+{
+    send(command_iu(1, read10(0, 1)));
+    send(command_iu(2, write10(0, 1)));
+    check_status(IU_WRITE_READY, 2);
+    cusb_uas_reset(&m_uas);
+
+    UNSIGNED_LONGS_EQUAL(0, cusb_uas_data_out_space(&m_uas));
+    m_disk.complete();
+    CHECK_TRUE( (status().empty()) );
+
+    for (auto &task : m_tasks)
+    {
+        CHECK_EQUAL(CUSB_SCSI_TASK_IDLE, task.state);
+    }
+}
+
+/*------------------------------------------------------------*/
+/*-------------------- MULTI-LUN TEST GROUP ------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(UasMultiLun)
+{
+    void setup() override
+    {
+        cusb_scsi_ctor(&m_luns[0], &m_fast.dev, &INQUIRY);
+        cusb_scsi_ctor(&m_luns[1], &m_slow.dev, &INQUIRY);
+        cusb_uas_ctor(&m_uas, m_luns, 2, m_tasks, QUEUE_DEPTH, &m_buffers[0][0], TASK_BUFFER_SIZE,
+                      PACKET_SIZE, nullptr, nullptr);
+    }
+
+    void send(const std::vector<std::uint8_t> &iu)
+    {
+        cusb_uas_command_out(&m_uas, iu.data(), iu.size());
+    }
+
+    std::vector<std::uint8_t> status()
+    {
+        std::uint8_t buf[CUSB_UAS_STATUS_IU_MAX];
+        std::size_t len = 0;
+
+        if (!cusb_uas_status_in(&m_uas, buf, sizeof(buf), &len))
+        {
+            return {};
+        }
+
+        return std::vector<std::uint8_t>(buf, buf + len);
+    }
+
+    std::vector<std::uint8_t> data_in()
+    {
+        std::uint8_t buf[PACKET_SIZE];
+        std::size_t len = 0;
+        CHECK_TRUE( (cusb_uas_data_in(&m_uas, buf, sizeof(buf), &len)) );
+        return std::vector<std::uint8_t>(buf, buf + len);
+    }
+
+    stubs::blockdev m_fast{BLOCK_SIZE, BLOCK_COUNT};
+    stubs::blockdev m_slow{BLOCK_SIZE, BLOCK_COUNT, true};
+    struct cusb_scsi m_luns[2];
+    struct cusb_uas m_uas;
+    struct cusb_scsi_task m_tasks[QUEUE_DEPTH];
+    std::uint8_t m_buffers[QUEUE_DEPTH][TASK_BUFFER_SIZE];
+};
+
+TEST(UasMultiLun, SlowLunDoesNotStarveOthers)
+{
+    /* LUN 1 may hold every slot but one. */
+    send(command_iu(1, read10(0, 1), 1));
+    send(command_iu(2, read10(1, 1), 1));
+    send(command_iu(3, read10(2, 1), 1));
+    UNSIGNED_LONGS_EQUAL(2, m_slow.queue.size());
+    std::vector<std::uint8_t> s = status();
+    BYTES_EQUAL(IU_SENSE, s[0]);
+    BYTES_EQUAL(3, s[3]);
+    BYTES_EQUAL(CUSB_SCSI_STATUS_TASK_SET_FULL, s[6]);
+
+    /* LUN 0 keeps going while LUN 1 is busy. */
+    for (std::uint16_t tag = 10; tag < 13; tag++)
+    {
+        send(command_iu(tag, {0x00}, 0));
+        s = status();
+        BYTES_EQUAL(IU_SENSE, s[0]);
+        UNSIGNED_LONGS_EQUAL(tag, (s[2] << 8) | s[3]);
+        BYTES_EQUAL(CUSB_SCSI_STATUS_GOOD, s[6]);
+    }
+
+    CHECK_TRUE( (status().empty()) );
+    UNSIGNED_LONGS_EQUAL(2, m_slow.queue.size());
+}
+
+TEST(UasMultiLun, EveryIdleLunKeepsASlot)
+{
+    constexpr std::size_t DEPTH = 4;
+    stubs::blockdev slow2{BLOCK_SIZE, BLOCK_COUNT, true};
+    struct cusb_scsi luns[3];
+    struct cusb_scsi_task tasks[DEPTH];
+    std::vector<std::uint8_t> buffers(DEPTH * TASK_BUFFER_SIZE);
+
+    cusb_scsi_ctor(&luns[0], &m_slow.dev, &INQUIRY);
+    cusb_scsi_ctor(&luns[1], &slow2.dev, &INQUIRY);
+    cusb_scsi_ctor(&luns[2], &m_fast.dev, &INQUIRY);
+    cusb_uas_ctor(&m_uas, luns, 3, tasks, DEPTH, buffers.data(), TASK_BUFFER_SIZE, PACKET_SIZE, nullptr, nullptr);
+
+    /* Two slow LUNs share the slots, but not the last one. */
+    send(command_iu(1, read10(0, 1), 0));
+    send(command_iu(2, read10(1, 1), 0));
+    send(command_iu(3, read10(2, 1), 0));
+    send(command_iu(4, read10(0, 1), 1));
+    send(command_iu(5, read10(1, 1), 1));
+    UNSIGNED_LONGS_EQUAL(2, m_slow.queue.size());
+    UNSIGNED_LONGS_EQUAL(1, slow2.queue.size());
+
+    /* LUN 2 still gets its command in. */
+    send(command_iu(6, {0x00}, 2));
+
+    for (unsigned tag : {3U, 5U, 6U})
+    {
+        std::vector<std::uint8_t> s = status();
+        BYTES_EQUAL(IU_SENSE, s[0]);
+        UNSIGNED_LONGS_EQUAL(tag, (s[2] << 8) | s[3]);
+        BYTES_EQUAL((tag == 6) ? CUSB_SCSI_STATUS_GOOD : CUSB_SCSI_STATUS_TASK_SET_FULL, s[6]);
+    }
+
+    CHECK_TRUE( (status().empty()) );
+}
+
+TEST(UasMultiLun, ReportLuns)
+{
+    send(command_iu(4, {0xA0, 0, 0, 0, 0, 0, 0, 0, 0, 64, 0, 0}, 1));
+    std::vector<std::uint8_t> s = status();
+    BYTES_EQUAL(IU_READ_READY, s[0]);
+
+    std::vector<std::uint8_t> data = data_in();
+    LONGS_EQUAL(24, data.size());
+    BYTES_EQUAL(16, data[3]);
+    BYTES_EQUAL(0, data[9]);
+    BYTES_EQUAL(1, data[17]);
+}
+
+TEST(UasMultiLun, LogicalUnitResetIsPerLun)
+{
+    send(command_iu(1, read10(0, 1), 1));
+    send(command_iu(2, write10(0, 1), 0));
+    BYTES_EQUAL(IU_WRITE_READY, status()[0]);
+
+    /* LOGICAL UNIT RESET on LUN 1. */
+    std::vector<std::uint8_t> tm = tm_iu(20, 0x08, 0);
+    tm[9] = 1;
+    send(tm);
+    std::vector<std::uint8_t> s = status();
+    BYTES_EQUAL(IU_RESPONSE, s[0]);
+    BYTES_EQUAL(0x00, s[7]);
+
+    /* LUN 0 write still wants its data. */
+    UNSIGNED_LONGS_EQUAL(BLOCK_SIZE, cusb_uas_data_out_space(&m_uas));
+    m_slow.complete();
+    CHECK_TRUE( (status().empty()) );
+}
@@ -0,0 +1,443 @@
+/**
+ * @file
+ * @brief Unit tests for public API functions in @ref usbtmc.h
+ *
+ * Test Summary:
+ *
+ * cusb_usbtmc_bulk_out()
+ *      - TEST(Usbtmc, BtagInverseMismatchIsProtocolError)
+ *      - TEST(Usbtmc, DevDepMsgOutSpansPacketsAndSkipsPadding)
+ *      - TEST(Usbtmc, TriggerMessage)
+ *
+ * cusb_usbtmc_respond(), cusb_usbtmc_bulk_in()
+ *      - TEST(Usbtmc, RequestWaitsForResponse)
+ *      - TEST(Usbtmc, ResponseStreamsInOneTransfer)
+ *      - TEST(Usbtmc, ResponseSplitAcrossRequests)
+ *      - TEST(Usbtmc, AlignmentPadding)
+ *      - TEST(Usbtmc, ZlpOnPacketMultiple)
+ *      - TEST(Usbtmc, ReadEndingAfterWholePacketSendsOneZlp)
+ *      - TEST(Usbtmc, TermCharEndsTransfer)
+ *
+ * cusb_usbtmc_control()
+ *      - TEST(Usbtmc, AbortBulkIn)
+ *      - TEST(Usbtmc, AbortBulkOut)
+ *      - TEST(Usbtmc, InitiateClear)
+ *      - TEST(Usbtmc, GetCapabilities)
+ *      - TEST(Usbtmc, ReadStatusByte)
+ *      - TEST(Usbtmc, UnsupportedRequestStalls)
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Files under test. */
+#include "cusb/usbtmc.h"
+
+/* STDLib. */
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/* Stubs. */
+#include "stubs/stub_asserter.hpp"
+
+/* CppUTest. */
+#include "CppUTest/TestHarness.h"
+
+/*------------------------------------------------------------*/
+/*---------------------- FILE-SCOPE HELPERS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint16_t PACKET_SIZE = 64;
+
+/**
+ * @brief Instrument model. Records received messages and serves
+ * the response from a vector.
+ */
+struct instrument
+{
+    std::string received;
+    int messages = 0;
+    int clears = 0;
+    int triggers = 0;
+    std::vector<std::uint8_t> response;
+    std::vector<std::size_t> read_sizes;
+
+    static instrument &self(void *ctx)
+    {
+        return *static_cast<instrument *>(ctx);
+    }
+
+    static void receive(void *ctx, const std::uint8_t *data, std::size_t len, bool eom)
+    {
+        self(ctx).received.append(reinterpret_cast<const char *>(data), len);
+        self(ctx).messages += (eom) ? 1 : 0;
+    }
+
+    static std::size_t read(void *ctx, std::uint32_t offset, std::uint8_t *buf, std::size_t len)
+    {
+        auto &r = self(ctx).response;
+        self(ctx).read_sizes.push_back(len);
+        std::size_t n = std::min(len, r.size() - offset);
+        std::memcpy(buf, r.data() + offset, n);
+        return n;
+    }
+
+    static void clear(void *ctx)
+    {
+        self(ctx).clears++;
+    }
+
+    static void trigger(void *ctx)
+    {
+        self(ctx).triggers++;
+    }
+
+    static std::uint8_t status_byte(void *)
+    {
+        return 0x42;
+    }
+};
+
+const struct cusb_usbtmc_api API =
+{
+    &instrument::receive, &instrument::read, &instrument::clear,
+    nullptr, &instrument::trigger, &instrument::status_byte, nullptr
+};
+
+std::uint32_t le32(const std::uint8_t *p)
+{
+    return static_cast<std::uint32_t>(p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<std::uint32_t>(p[3]) << 24));
+}
+
+/**
+ * @brief One Bulk-IN transfer as seen by the host.
+ */
+struct in_transfer
+{
+    std::uint8_t btag;
+    std::uint32_t size;
+    std::uint8_t attributes;
+    std::vector<std::uint8_t> data;
+    std::size_t raw_len;
+    bool zlp;
+};
+} /* namespace */
+
+/*------------------------------------------------------------*/
+/*------------------------ TEST GROUPS -----------------------*/
+/*------------------------------------------------------------*/
+
+TEST_GROUP(Usbtmc)
+{
+    void setup() override
+    {
+        cusb_usbtmc_ctor(&m_tmc, &API, &m_inst, PACKET_SIZE);
+    }
+
+    std::vector<std::uint8_t> header(std::uint8_t msg_id, std::uint8_t btag, std::uint32_t size,
+                                     std::uint8_t attr, std::uint8_t termchar = 0)
+    {
+        return {msg_id, btag, static_cast<std::uint8_t>(~btag), 0,
+                static_cast<std::uint8_t>(size), static_cast<std::uint8_t>(size >> 8),
+                static_cast<std::uint8_t>(size >> 16), static_cast<std::uint8_t>(size >> 24),
+                attr, termchar, 0, 0};
+    }
+
+    void send_message(std::uint8_t btag, const std::string &msg, bool eom = true)
+    {
+        std::vector<std::uint8_t> all = header(1, btag, static_cast<std::uint32_t>(msg.size()), eom ? 1 : 0);
+        all.insert(all.end(), msg.begin(), msg.end());
+        while (all.size() % 4)
+        {
+            all.push_back(0);
+        }
+        for (std::size_t off = 0; off < all.size(); off += PACKET_SIZE)
+        {
+            CHECK_TRUE( (cusb_usbtmc_bulk_out(&m_tmc, &all[off], std::min<std::size_t>(PACKET_SIZE, all.size() - off))) );
+        }
+    }
+
+    void request_in(std::uint8_t btag, std::uint32_t max, bool termchar_enabled = false, std::uint8_t termchar = 0)
+    {
+        auto h = header(2, btag, max, termchar_enabled ? 2 : 0, termchar);
+        CHECK_TRUE( (cusb_usbtmc_bulk_out(&m_tmc, h.data(), h.size())) );
+    }
+
+    /**
+     * @brief Reads one Bulk-IN transfer the way a host does: until a short packet.
+     */
+    in_transfer read_transfer(std::size_t buf_size = PACKET_SIZE)
+    {
+        std::vector<std::uint8_t> raw;
+        std::vector<std::uint8_t> buf(buf_size);
+        std::size_t len = 0;
+        in_transfer t{};
+
+        while (cusb_usbtmc_bulk_in(&m_tmc, buf.data(), buf.size(), &len))
+        {
+            raw.insert(raw.end(), buf.begin(), buf.begin() + static_cast<long>(len));
+            if (len == 0)
+            {
+                t.zlp = true;
+                break;
+            }
+            if (len % PACKET_SIZE)
+            {
+                break;
+            }
+        }
+
+        CHECK_TRUE( (raw.size() >= 12) );
+        t.btag = raw[1];
+        t.size = le32(&raw[4]);
+        t.attributes = raw[8];
+        t.raw_len = raw.size();
+        t.data.assign(raw.begin() + 12, raw.begin() + 12 + t.size);
+        CHECK_EQUAL(0U, raw.size() % 4);
+        return t;
+    }
+
+    bool control(std::uint8_t request, std::uint16_t value, std::uint16_t length)
+    {
+        std::uint8_t setup[8] = {0xA1, request, static_cast<std::uint8_t>(value), static_cast<std::uint8_t>(value >> 8),
+                                 0, 0, static_cast<std::uint8_t>(length), static_cast<std::uint8_t>(length >> 8)};
+        return cusb_usbtmc_control(&m_tmc, setup, m_resp, &m_resp_len);
+    }
+
+    void set_response(std::size_t n)
+    {
+        m_inst.response.resize(n);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            m_inst.response[i] = static_cast<std::uint8_t>(i * 3);
+        }
+        CHECK_TRUE( (cusb_usbtmc_respond(&m_tmc, static_cast<std::uint32_t>(n))) );
+    }
+
+    struct cusb_usbtmc m_tmc;
+    instrument m_inst;
+    std::uint8_t m_resp[CUSB_USBTMC_CONTROL_RESPONSE_MAX];
+    std::size_t m_resp_len = 0;
+};
+
+/*------------------------------------------------------------*/
+/*--------------------------- TESTS --------------------------*/
+/*------------------------------------------------------------*/
+
+TEST(Usbtmc, BtagInverseMismatchIsProtocolError)
+{
+    auto h = header(1, 5, 0, 1);
+    h[2] = 0;
+    CHECK_FALSE( (cusb_usbtmc_bulk_out(&m_tmc, h.data(), h.size())) );
+}
+
+TEST(Usbtmc, DevDepMsgOutSpansPacketsAndSkipsPadding)
+{
+    std::string msg(150, 'x');
+    msg += "*IDN?";
+    send_message(1, msg);
+    STRCMP_EQUAL(msg.c_str(), m_inst.received.c_str());
+    LONGS_EQUAL(1, m_inst.messages);
+
+    /* Next header is parsed as a new message, not as leftover data. */
+    send_message(2, "A", false);
+    LONGS_EQUAL(msg.size() + 1, m_inst.received.size());
+    LONGS_EQUAL(1, m_inst.messages);
+}
+
+TEST(Usbtmc, TriggerMessage)
+{
+    auto h = header(128, 3, 0, 0);
+    CHECK_TRUE( (cusb_usbtmc_bulk_out(&m_tmc, h.data(), h.size())) );
+    LONGS_EQUAL(1, m_inst.triggers);
+}
+
+TEST(Usbtmc, RequestWaitsForResponse)
+{
+    std::uint8_t buf[PACKET_SIZE];
+    std::size_t len;
+    request_in(7, 1000);
+    CHECK_FALSE( (cusb_usbtmc_bulk_in(&m_tmc, buf, sizeof(buf), &len)) );
+    set_response(10);
+    auto t = read_transfer();
+    LONGS_EQUAL(7, t.btag);
+    LONGS_EQUAL(10, t.size);
+}
+
+TEST(Usbtmc, ResponseStreamsInOneTransfer)
+{
+    set_response(100000);
+    request_in(1, 1U << 20);
+    auto t = read_transfer(512);
+    LONGS_EQUAL(100000, t.size);
+    BYTES_EQUAL(0x01, t.attributes);
+    CHECK_TRUE( (t.data == m_inst.response) );
+
+    /* Application data is read straight into the transfer buffer in buffer-sized pieces. */
+    UNSIGNED_LONGS_EQUAL(512 - 12, m_inst.read_sizes[0]);
+    UNSIGNED_LONGS_EQUAL(512, m_inst.read_sizes[1]);
+}
+
+TEST(Usbtmc, ResponseSplitAcrossRequests)
+{
+    set_response(300);
+    std::vector<std::uint8_t> all;
+
+    for (int i = 0; i < 3; i++)
+    {
+        request_in(static_cast<std::uint8_t>(i + 1), 100);
+        auto t = read_transfer();
+        LONGS_EQUAL(100, t.size);
+        BYTES_EQUAL((i == 2) ? 0x01 : 0x00, t.attributes);
+        all.insert(all.end(), t.data.begin(), t.data.end());
+    }
+
+    CHECK_TRUE( (all == m_inst.response) );
+    CHECK_TRUE( (cusb_usbtmc_respond(&m_tmc, 1)) );
+}
+
+TEST(Usbtmc, AlignmentPadding)
+{
+    set_response(5);
+    request_in(1, 100);
+    auto t = read_transfer();
+    UNSIGNED_LONGS_EQUAL(20, t.raw_len);
+}
+
+TEST(Usbtmc, ZlpOnPacketMultiple)
+{
+    set_response(2 * PACKET_SIZE - 12);
+    request_in(1, 1000);
+    auto t = read_transfer();
+    CHECK_TRUE( (t.zlp) );
+}
+
+TEST(Usbtmc, ReadEndingAfterWholePacketSendsOneZlp)
+{
+    std::uint8_t buf[PACKET_SIZE];
+    std::size_t len;
+    set_response(1000);
+    m_inst.response.resize(PACKET_SIZE - 12);
+    request_in(1, 1000);
+
+    CHECK_TRUE( (cusb_usbtmc_bulk_in(&m_tmc, buf, sizeof(buf), &len)) );
+    LONGS_EQUAL(PACKET_SIZE, len);
+    CHECK_TRUE( (cusb_usbtmc_bulk_in(&m_tmc, buf, sizeof(buf), &len)) );
+    LONGS_EQUAL(0, len);
+    CHECK_FALSE( (cusb_usbtmc_bulk_in(&m_tmc, buf, sizeof(buf), &len)) );
+}
+
+TEST(Usbtmc, TermCharEndsTransfer)
+{
+    const std::string reply = "abc\ndef\n";
+    m_inst.response.assign(reply.begin(), reply.end());
+    CHECK_TRUE( (cusb_usbtmc_respond(&m_tmc, static_cast<std::uint32_t>(reply.size()))) );
+
+    request_in(1, 100, true, '\n');
+    auto t1 = read_transfer();
+    LONGS_EQUAL(4, t1.size);
+    BYTES_EQUAL(0x02, t1.attributes);
+
+    request_in(2, 100, true, '\n');
+    auto t2 = read_transfer();
+    LONGS_EQUAL(4, t2.size);
+    BYTES_EQUAL(0x03, t2.attributes);
+    CHECK_TRUE( (std::string(t2.data.begin(), t2.data.end()) == "def\n") );
+}
+
+TEST(Usbtmc, AbortBulkIn)
+{
+    std::uint8_t buf[PACKET_SIZE];
+    std::size_t len;
+    set_response(1000);
+    request_in(9, 1000);
+    CHECK_TRUE( (cusb_usbtmc_bulk_in(&m_tmc, buf, sizeof(buf), &len)) );
+
+    CHECK_TRUE( (control(3, 8, 2)) );
+    BYTES_EQUAL(0x80, m_resp[0]);
+    CHECK_TRUE( (control(3, 9, 2)) );
+    BYTES_EQUAL(0x01, m_resp[0]);
+    BYTES_EQUAL(9, m_resp[1]);
+
+    /* Pending until the short packet ending the transfer was read. */
+    CHECK_TRUE( (control(4, 0, 8)) );
+    BYTES_EQUAL(0x02, m_resp[0]);
+    BYTES_EQUAL(0x01, m_resp[1]);
+
+    /* Transfer is ended with a short packet and nothing else is sent. */
+    CHECK_TRUE( (cusb_usbtmc_bulk_in(&m_tmc, buf, sizeof(buf), &len)) );
+    LONGS_EQUAL(0, len);
+    CHECK_FALSE( (cusb_usbtmc_bulk_in(&m_tmc, buf, sizeof(buf), &len)) );
+
+    CHECK_TRUE( (control(4, 0, 8)) );
+    BYTES_EQUAL(0x01, m_resp[0]);
+    BYTES_EQUAL(0x00, m_resp[1]);
+    UNSIGNED_LONGS_EQUAL(PACKET_SIZE - 12, le32(&m_resp[4]));
+    CHECK_TRUE( (cusb_usbtmc_respond(&m_tmc, 1)) );
+}
+
+TEST(Usbtmc, AbortBulkOut)
+{
+    CHECK_TRUE( (control(1, 4, 2)) );
+    BYTES_EQUAL(0x81, m_resp[0]);
+
+    auto h = header(1, 4, 500, 1);
+    h.resize(PACKET_SIZE, 'a');
+    CHECK_TRUE( (cusb_usbtmc_bulk_out(&m_tmc, h.data(), h.size())) );
+    CHECK_TRUE( (control(1, 4, 2)) );
+    BYTES_EQUAL(0x01, m_resp[0]);
+    LONGS_EQUAL(1, m_inst.clears);
+
+    CHECK_TRUE( (control(2, 0, 8)) );
+    UNSIGNED_LONGS_EQUAL(PACKET_SIZE - 12, le32(&m_resp[4]));
+
+    /* Next packet is treated as a new header. */
+    send_message(5, "X");
+    LONGS_EQUAL(1, m_inst.messages);
+}
+
+TEST(Usbtmc, InitiateClear)
+{
+    set_response(10);
+    CHECK_TRUE( (control(5, 0, 1)) );
+    BYTES_EQUAL(0x01, m_resp[0]);
+    LONGS_EQUAL(1, m_inst.clears);
+    CHECK_TRUE( (control(6, 0, 2)) );
+    BYTES_EQUAL(0x01, m_resp[0]);
+    CHECK_TRUE( (cusb_usbtmc_respond(&m_tmc, 1)) );
+}
+
+TEST(Usbtmc, GetCapabilities)
+{
+    CHECK_TRUE( (control(7, 0, 0x18)) );
+    LONGS_EQUAL(0x18, m_resp_len);
+    BYTES_EQUAL(0x01, m_resp[0]);
+    BYTES_EQUAL(0x01, m_resp[3]);
+    BYTES_EQUAL(0x00, m_resp[4]);   /* No indicator pulse callback. */
+    BYTES_EQUAL(0x01, m_resp[5]);
+    BYTES_EQUAL(0x05, m_resp[14]);  /* 488.2 + TRIGGER. */
+}
+
+TEST(Usbtmc, ReadStatusByte)
+{
+    CHECK_TRUE( (control(128, 0x7F, 3)) );
+    LONGS_EQUAL(3, m_resp_len);
+    BYTES_EQUAL(0x7F, m_resp[1]);
+    BYTES_EQUAL(0x42, m_resp[2]);
+}
+
+TEST(Usbtmc, UnsupportedRequestStalls)
+{
+    CHECK_FALSE( (control(64, 0, 1)) );
+    CHECK_FALSE( (control(200, 0, 1)) );
+}
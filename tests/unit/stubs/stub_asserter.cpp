@@ -0,0 +1,36 @@
+/**
+ * @file
+ * @brief See @ref stub_asserter.hpp
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "stubs/stub_asserter.hpp"
+
+/* STDLib. */
+#include <string>
+
+/*------------------------------------------------------------*/
+/*------------------------ STUB DEFINITIONS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace stubs
+{
+assert_exception::assert_exception(const char *file, int line)
+    : std::runtime_error(std::string(file) + ":" + std::to_string(line))
+{
+}
+} /* namespace stubs */
+
+extern "C" void ecu_assert_handler(const char *file, int line)
+{
+    throw stubs::assert_exception(file, line);
+}
@@ -0,0 +1,39 @@
+/**
+ * @file
+ * @brief Unit test definition of ECU's assert handler. Any ECU
+ * runtime assert that fires in the code under test throws
+ * @ref stubs::assert_exception so tests can verify that invalid
+ * calls are caught with CHECK_THROWS().
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef STUB_ASSERTER_HPP_
+#define STUB_ASSERTER_HPP_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* STDLib. */
+#include <stdexcept>
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+namespace stubs
+{
+/**
+ * @brief Thrown by ecu_assert_handler().
+ */
+struct assert_exception : public std::runtime_error
+{
+    assert_exception(const char *file, int line);
+};
+} /* namespace stubs */
+
+#endif /* STUB_ASSERTER_HPP_ */
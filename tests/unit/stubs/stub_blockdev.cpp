@@ -0,0 +1,101 @@
+/**
+ * @file
+ * @brief See @ref stub_blockdev.hpp
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "stubs/stub_blockdev.hpp"
+
+/* STDLib. */
+#include <cstring>
+
+/*------------------------------------------------------------*/
+/*------------------------ STUB DEFINITIONS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+void submit(void *ctx, struct cusb_blockdev_req *req)
+{
+    auto *me = static_cast<stubs::blockdev *>(ctx);
+    me->queue.push_back(req);
+
+    if (!me->async)
+    {
+        me->complete(me->queue.size() - 1, !me->fail);
+    }
+}
+
+const struct cusb_blockdev_api API = {&submit, nullptr};
+} /* namespace */
+
+namespace stubs
+{
+blockdev::blockdev(std::uint32_t block_size, std::uint32_t block_count, bool async_)
+    : data(static_cast<std::size_t>(block_size) * block_count), async(async_)
+{
+    cusb_blockdev_ctor(&dev, &API, this, block_size, block_count);
+}
+
+void blockdev::complete(std::size_t index, bool ok)
+{
+    struct cusb_blockdev_req *req = queue.at(index);
+    std::size_t offset = static_cast<std::size_t>(req->lba) * dev.block_size;
+    std::size_t len = static_cast<std::size_t>(req->count) * dev.block_size;
+
+    queue.erase(queue.begin() + static_cast<long>(index));
+
+    if (req->op == CUSB_BLOCKDEV_READ)
+    {
+        reads++;
+        if (ok)
+        {
+            std::memcpy(req->buf, &data[offset], len);
+        }
+    }
+    else if (req->op == CUSB_BLOCKDEV_WRITE)
+    {
+        writes++;
+        if (ok)
+        {
+            std::memcpy(&data[offset], req->buf, len);
+
+            if (erase_blocks != 0)
+            {
+                erases += (req->lba + req->count - 1) / erase_blocks - req->lba / erase_blocks + 1;
+            }
+        }
+    }
+    else
+    {
+        syncs++;
+    }
+
+    cusb_blockdev_complete(req, ok);
+}
+
+void blockdev::fill_pattern()
+{
+    for (std::uint32_t lba = 0; lba < dev.block_count; lba++)
+    {
+        for (std::uint32_t i = 0; i < dev.block_size; i++)
+        {
+            data[static_cast<std::size_t>(lba) * dev.block_size + i] = pattern(lba, i);
+        }
+    }
+}
+
+std::uint8_t blockdev::pattern(std::uint32_t lba, std::uint32_t i)
+{
+    return static_cast<std::uint8_t>((lba * 7U) ^ i);
+}
+} /* namespace stubs */
@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief In-memory block device backend for unit tests. Requests are
+ * either completed immediately or queued until the test completes them,
+ * in any order, to emulate slow media. Can count erases like a raw flash
+ * driver that erases every erase block a write touches.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef STUB_BLOCKDEV_HPP_
+#define STUB_BLOCKDEV_HPP_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Block device. */
+#include "cusb/blockdev.h"
+
+/* STDLib. */
+#include <cstdint>
+#include <vector>
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+namespace stubs
+{
+/**
+ * @brief RAM disk. Construct, then use @ref dev.
+ */
+struct blockdev
+{
+    blockdev(std::uint32_t block_size, std::uint32_t block_count, bool async = false);
+
+    /**
+     * @brief Completes queued request @p index. Data is moved at
+     * completion time.
+     */
+    void complete(std::size_t index = 0, bool ok = true);
+
+    /**
+     * @brief Fills every block with a pattern derived from its LBA.
+     */
+    void fill_pattern();
+
+    /**
+     * @brief Returns pattern byte @p i of block @p lba.
+     */
+    static std::uint8_t pattern(std::uint32_t lba, std::uint32_t i);
+
+    struct cusb_blockdev dev;
+    std::vector<std::uint8_t> data;
+    std::vector<struct cusb_blockdev_req *> queue;
+    bool async;
+    bool fail = false;
+    unsigned reads = 0;
+    unsigned writes = 0;
+    unsigned syncs = 0;
+
+    /// @brief Blocks per erase block. 0 to not count erases.
+    std::uint32_t erase_blocks = 0;
+    unsigned erases = 0;
+};
+} /* namespace stubs */
+
+#endif /* STUB_BLOCKDEV_HPP_ */
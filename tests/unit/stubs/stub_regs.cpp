@@ -0,0 +1,177 @@
+/**
+ * @file
+ * @brief See @ref stub_regs.hpp
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "stubs/stub_regs.hpp"
+
+/* STDLib. */
+#include <utility>
+
+/*------------------------------------------------------------*/
+/*------------------------ STUB DEFINITIONS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace stubs
+{
+void regs::define(std::uint32_t addr, bits behaviour, std::uint32_t reset)
+{
+    cell &c = cells[addr];
+    c.defined = true;
+    c.behaviour = behaviour;
+    c.reset = reset;
+    c.val = reset;
+}
+
+void regs::on_read(std::uint32_t addr, std::function<std::uint32_t(std::uint32_t stored)> hook)
+{
+    cells[addr].read_hook = std::move(hook);
+}
+
+void regs::on_write(std::uint32_t addr, std::function<void(std::uint32_t val)> hook)
+{
+    cells[addr].write_hook = std::move(hook);
+}
+
+void regs::fifo(std::uint32_t addr)
+{
+    cell &c = cells[addr];
+    c.defined = true;
+    c.is_fifo = true;
+    c.behaviour = bits{};
+}
+
+void regs::push(std::uint32_t addr, std::uint32_t val)
+{
+    cells[addr].entries.push_back(val);
+}
+
+std::size_t regs::pending(std::uint32_t addr) const
+{
+    auto it = cells.find(addr);
+    return (it == cells.end()) ? 0U : it->second.entries.size();
+}
+
+void regs::reset()
+{
+    for (auto &[addr, c] : cells)
+    {
+        (void)addr;
+
+        if (c.defined)
+        {
+            c.val = c.reset;
+            c.entries.clear();
+        }
+    }
+}
+
+std::uint32_t regs::read(std::uint32_t addr)
+{
+    cell &c = cells[addr];
+    std::uint32_t val = c.val;
+
+    if (c.is_fifo)
+    {
+        val = 0;
+
+        if (!c.entries.empty())
+        {
+            val = c.entries.front();
+            c.entries.pop_front();
+        }
+    }
+    else if (c.read_hook)
+    {
+        val = c.read_hook(c.val);
+    }
+
+    trace.push_back({false, addr, val});
+    return val;
+}
+
+void regs::write(std::uint32_t addr, std::uint32_t val)
+{
+    cell &c = cells[addr];
+    trace.push_back({true, addr, val});
+
+    if (!c.defined)
+    {
+        c.val = val;
+    }
+    else if (!c.is_fifo)
+    {
+        const bits &b = c.behaviour;
+        std::uint32_t kept = c.val & ~(b.rw | b.w1c | b.w0c | b.toggle);
+        c.val = kept
+              | (val & b.rw)
+              | (c.val & b.w1c & ~val)
+              | (c.val & b.w0c & val)
+              | ((c.val ^ val) & b.toggle);
+    }
+
+    if (c.write_hook)
+    {
+        c.write_hook(val);
+    }
+}
+
+std::uint32_t regs::peek(std::uint32_t addr) const
+{
+    auto it = cells.find(addr);
+    return (it == cells.end()) ? 0U : it->second.val;
+}
+
+void regs::poke(std::uint32_t addr, std::uint32_t val)
+{
+    cells[addr].val = val;
+}
+
+void regs::set(std::uint32_t addr, std::uint32_t mask)
+{
+    cells[addr].val |= mask;
+}
+
+void regs::clear(std::uint32_t addr, std::uint32_t mask)
+{
+    cells[addr].val &= ~mask;
+}
+
+std::size_t regs::mark() const
+{
+    return trace.size();
+}
+
+unsigned regs::reads(std::size_t from, std::uint32_t lo, std::uint32_t hi) const
+{
+    return count(from, false, lo, hi);
+}
+
+unsigned regs::writes(std::size_t from, std::uint32_t lo, std::uint32_t hi) const
+{
+    return count(from, true, lo, hi);
+}
+
+unsigned regs::count(std::size_t from, bool write, std::uint32_t lo, std::uint32_t hi) const
+{
+    unsigned n = 0;
+
+    for (std::size_t i = from; i < trace.size(); i++)
+    {
+        const access &a = trace[i];
+        n += (a.write == write && a.addr >= lo && a.addr < hi) ? 1U : 0U;
+    }
+
+    return n;
+}
+} /* namespace stubs */
@@ -0,0 +1,165 @@
+/**
+ * @file
+ * @brief Peripheral register file for unit tests of device controller
+ * drivers. A peripheral model owns one and forwards the driver's bus
+ * accesses to @ref stubs::regs::read() and @ref stubs::regs::write().
+ * @details Every address is 32 bits of memory. Addresses never passed
+ * to @ref stubs::regs::define() behave as plain RAM, i.e. packet memory.
+ * Defined registers apply the usual side effects on driver writes:
+ * read/write, write 1 to clear, write 0 to clear, write 1 to toggle and
+ * read-only bits. A read hook can compute the value the driver sees and
+ * a FIFO register pops its oldest entry on every read. Write hooks run
+ * after the bits were updated.
+ *
+ * Every driver access is appended to @ref stubs::regs::trace. Tests take
+ * a @ref stubs::regs::mark() before the code under test and count what
+ * happened since, which on the MCU is roughly what that code costs.
+ * Accesses made by the model itself, through @ref stubs::regs::peek()
+ * and @ref stubs::regs::poke(), are not traced and have no side effects.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef STUB_REGS_HPP_
+#define STUB_REGS_HPP_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* STDLib. */
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+namespace stubs
+{
+/**
+ * @brief Register file.
+ */
+struct regs
+{
+    /**
+     * @brief How the bits of a register react to a driver write. A bit in
+     * none of the masks is read-only.
+     */
+    struct bits
+    {
+        std::uint32_t rw = 0;       /**< Takes the written value. */
+        std::uint32_t w1c = 0;      /**< Cleared by writing 1, kept by writing 0. */
+        std::uint32_t w0c = 0;      /**< Cleared by writing 0, kept by writing 1. */
+        std::uint32_t toggle = 0;   /**< Flipped by writing 1, kept by writing 0. */
+    };
+
+    /**
+     * @brief One driver access.
+     */
+    struct access
+    {
+        bool write;
+        std::uint32_t addr;
+        std::uint32_t val;          /**< Value written, or value returned by the read. */
+    };
+
+    /**
+     * @brief Makes @p addr a register with @p behaviour that holds
+     * @p reset until @ref reset() is called or the driver writes it.
+     */
+    void define(std::uint32_t addr, bits behaviour, std::uint32_t reset = 0);
+
+    /**
+     * @brief Driver reads of @p addr return @p hook called with the
+     * stored value.
+     */
+    void on_read(std::uint32_t addr, std::function<std::uint32_t(std::uint32_t stored)> hook);
+
+    /**
+     * @brief @p hook runs with the written value after every driver write
+     * to @p addr.
+     */
+    void on_write(std::uint32_t addr, std::function<void(std::uint32_t val)> hook);
+
+    /**
+     * @brief Makes @p addr a receive FIFO. Driver reads pop the oldest
+     * entry, or return 0 when it is empty. Driver writes are ignored.
+     */
+    void fifo(std::uint32_t addr);
+
+    /**
+     * @brief Appends @p val to FIFO @p addr.
+     */
+    void push(std::uint32_t addr, std::uint32_t val);
+
+    /**
+     * @brief Entries left in FIFO @p addr.
+     */
+    std::size_t pending(std::uint32_t addr) const;
+
+    /**
+     * @brief Puts every defined register back to its reset value and
+     * empties the FIFOs. Memory and the trace are kept.
+     */
+    void reset();
+
+    /// @name Driver side. Traced, with side effects.
+    /// @{
+    std::uint32_t read(std::uint32_t addr);
+    void write(std::uint32_t addr, std::uint32_t val);
+    /// @}
+
+    /// @name Model side. Not traced, no side effects.
+    /// @{
+    std::uint32_t peek(std::uint32_t addr) const;
+    void poke(std::uint32_t addr, std::uint32_t val);
+    void set(std::uint32_t addr, std::uint32_t mask);
+    void clear(std::uint32_t addr, std::uint32_t mask);
+    /// @}
+
+    /**
+     * @brief Position in @ref trace to count from.
+     */
+    std::size_t mark() const;
+
+    /**
+     * @brief Driver reads since @p from to addresses in [@p lo, @p hi).
+     */
+    unsigned reads(std::size_t from, std::uint32_t lo = 0, std::uint32_t hi = UINT32_MAX) const;
+
+    /**
+     * @brief Driver writes since @p from to addresses in [@p lo, @p hi).
+     */
+    unsigned writes(std::size_t from, std::uint32_t lo = 0, std::uint32_t hi = UINT32_MAX) const;
+
+    /// @brief Every driver access, oldest first. Tests may clear it.
+    std::vector<access> trace;
+
+private:
+    struct cell
+    {
+        std::uint32_t val = 0;
+        std::uint32_t reset = 0;
+        bool defined = false;
+        bits behaviour;
+        std::function<std::uint32_t(std::uint32_t)> read_hook;
+        std::function<void(std::uint32_t)> write_hook;
+        bool is_fifo = false;
+        std::deque<std::uint32_t> entries;
+    };
+
+    unsigned count(std::size_t from, bool write, std::uint32_t lo, std::uint32_t hi) const;
+
+    std::map<std::uint32_t, cell> cells;
+};
+} /* namespace stubs */
+
+#endif /* STUB_REGS_HPP_ */
@@ -0,0 +1,318 @@
+/**
+ * @file
+ * @brief See @ref stub_stm32fs.hpp
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Translation unit. */
+#include "stubs/stub_stm32fs.hpp"
+
+/*------------------------------------------------------------*/
+/*------------------------ STUB DEFINITIONS ------------------*/
+/*------------------------------------------------------------*/
+
+namespace
+{
+constexpr std::uint16_t CTR_RX = 0x8000U;
+constexpr std::uint16_t DTOG_RX = 0x4000U;
+constexpr std::uint16_t SETUP = 0x0800U;
+constexpr std::uint16_t KIND = 0x0100U;
+constexpr std::uint16_t CTR_TX = 0x0080U;
+constexpr std::uint16_t DTOG_TX = 0x0040U;
+constexpr std::uint16_t RW = 0x070FU;
+constexpr std::uint16_t TOGGLE = 0x7070U;
+constexpr std::uint16_t TYPE_BULK = 0x0000U;
+constexpr std::uint16_t TYPE_ISO = 0x0400U;
+constexpr std::uint16_t TYPE_MASK = 0x0600U;
+constexpr unsigned DISABLED = 0U;
+constexpr unsigned STALLED = 1U;
+constexpr unsigned NAKING = 2U;
+constexpr unsigned VALID = 3U;
+constexpr std::uint16_t ISTR_CTR = 0x8000U;
+constexpr std::uint16_t ISTR_WKUP = 0x1000U;
+constexpr std::uint16_t ISTR_SUSP = 0x0800U;
+constexpr std::uint16_t ISTR_RESET = 0x0400U;
+constexpr std::uint16_t ISTR_SOF = 0x0200U;
+constexpr std::uint16_t ISTR_DIR = 0x0010U;
+constexpr std::uint16_t ISTR_FLAGS = 0x7F80U;
+constexpr std::uint16_t DADDR_EF = 0x0080U;
+constexpr std::uint32_t CNTR = 0x40U;
+constexpr std::uint32_t ISTR = 0x44U;
+constexpr std::uint32_t FNR = 0x48U;
+constexpr std::uint32_t DADDR = 0x4CU;
+constexpr std::uint32_t BTABLE = 0x50U;
+constexpr std::uint32_t BCDR = 0x58U;
+constexpr std::uint32_t PMA = 0x400U;
+
+stubs::stm32fs *active = nullptr;
+
+unsigned stat_rx(std::uint16_t epr)
+{
+    return (epr >> 12) & 3U;
+}
+
+unsigned stat_tx(std::uint16_t epr)
+{
+    return (epr >> 4) & 3U;
+}
+
+std::uint16_t with_stat_rx(std::uint16_t epr, unsigned stat)
+{
+    return static_cast<std::uint16_t>((epr & ~0x3000U) | (stat << 12));
+}
+
+std::uint16_t with_stat_tx(std::uint16_t epr, unsigned stat)
+{
+    return static_cast<std::uint16_t>((epr & ~0x0030U) | (stat << 4));
+}
+} /* namespace */
+
+extern "C" std::uint16_t cusb_stm32fs_read(std::uint32_t addr)
+{
+    return static_cast<std::uint16_t>(active->bus.read(addr));
+}
+
+extern "C" void cusb_stm32fs_write(std::uint32_t addr, std::uint16_t val)
+{
+    active->bus.write(addr, val);
+}
+
+namespace stubs
+{
+stm32fs::stm32fs()
+{
+    active = this;
+
+    for (std::uint8_t n = 0; n < 8U; n++)
+    {
+        bus.define(addr(4U * n), {.rw = RW, .w0c = CTR_RX | CTR_TX, .toggle = TOGGLE});
+    }
+
+    bus.define(addr(CNTR), {.rw = 0xFFFFU}, 0x0003U);
+    bus.define(addr(ISTR), {.w0c = ISTR_FLAGS});
+    bus.on_read(addr(ISTR), [this](std::uint32_t) { return istr(); });
+    bus.define(addr(FNR), {});
+    bus.define(addr(DADDR), {.rw = 0x00FFU});
+    bus.define(addr(BTABLE), {.rw = 0xFFF8U});
+    bus.define(addr(BCDR), {.rw = 0xFFFFU});
+}
+
+stm32fs::~stm32fs()
+{
+    active = nullptr;
+}
+
+void stm32fs::reset()
+{
+    for (std::uint8_t n = 0; n < 8U; n++)
+    {
+        set_epr(n, 0);
+    }
+
+    bus.poke(addr(DADDR), 0);
+    bus.set(addr(ISTR), ISTR_RESET);
+}
+
+int stm32fs::setup(const std::uint8_t *packet)
+{
+    std::uint16_t e = epr(0);
+    std::uint16_t btable = reg(BTABLE);
+
+    if ((reg(DADDR) & DADDR_EF) == 0U || stat_rx(e) == DISABLED)
+    {
+        return TIMEOUT;
+    }
+
+    std::uint32_t buf = pma(btable + 4U);
+
+    for (std::uint32_t i = 0; i < 8U; i += 2U)
+    {
+        set_pma(buf + i, static_cast<std::uint16_t>(packet[i] | (packet[i + 1U] << 8)));
+    }
+
+    set_pma(btable + 6U, static_cast<std::uint16_t>((pma(btable + 6U) & ~0x03FFU) | 8U));
+    e = with_stat_tx(with_stat_rx(e, NAKING), NAKING);
+    set_epr(0, static_cast<std::uint16_t>(e | CTR_RX | SETUP));
+    return ACK;
+}
+
+int stm32fs::out(std::uint8_t num, const std::uint8_t *data, std::uint16_t len)
+{
+    std::uint16_t e = epr(num);
+    bool iso = (e & TYPE_MASK) == TYPE_ISO;
+    std::uint32_t slot = 1;
+
+    if ((e & 0x000FU) != num || stat_rx(e) == DISABLED)
+    {
+        return TIMEOUT;
+    }
+
+    if (stat_rx(e) == STALLED)
+    {
+        return STALL;
+    }
+
+    if (iso)
+    {
+        /* No handshake. DTOG picks the buffer and toggles every frame. */
+        slot = (e & DTOG_RX) ? 1U : 0U;
+    }
+    else if (dbl(num))
+    {
+        slot = (e & DTOG_RX) ? 1U : 0U;
+
+        if (((e & DTOG_RX) != 0U) == ((e & DTOG_TX) != 0U))
+        {
+            return NAK;
+        }
+    }
+    else if (stat_rx(e) != VALID)
+    {
+        return NAK;
+    }
+
+    std::uint32_t entry = reg(BTABLE) + 8U * num + 4U * slot;
+    std::uint32_t buf = pma(entry);
+
+    for (std::uint32_t i = 0; i < len; i += 2U)
+    {
+        std::uint16_t hi = (i + 1U < len) ? data[i + 1U] : 0U;
+        set_pma(buf + i, static_cast<std::uint16_t>(data[i] | (hi << 8)));
+    }
+
+    set_pma(entry + 2U, static_cast<std::uint16_t>((pma(entry + 2U) & ~0x03FFU) | len));
+    e ^= DTOG_RX;
+    e = dbl(num) ? e : with_stat_rx(e, NAKING);
+    set_epr(num, static_cast<std::uint16_t>((e | CTR_RX) & ~SETUP));
+    return ACK;
+}
+
+int stm32fs::in(std::uint8_t num, std::vector<std::uint8_t> &data)
+{
+    std::uint16_t e = epr(num);
+    bool iso = (e & TYPE_MASK) == TYPE_ISO;
+    std::uint32_t slot = 0;
+
+    if ((e & 0x000FU) != num || stat_tx(e) == DISABLED)
+    {
+        return TIMEOUT;
+    }
+
+    if (stat_tx(e) == STALLED)
+    {
+        return STALL;
+    }
+
+    if (iso)
+    {
+        /* No handshake. DTOG picks the buffer and toggles every frame. */
+        slot = (e & DTOG_TX) ? 1U : 0U;
+    }
+    else if (dbl(num))
+    {
+        slot = (e & DTOG_TX) ? 1U : 0U;
+
+        if (((e & DTOG_TX) != 0U) == ((e & DTOG_RX) != 0U))
+        {
+            return NAK;
+        }
+    }
+    else if (stat_tx(e) != VALID)
+    {
+        return NAK;
+    }
+
+    std::uint32_t entry = reg(BTABLE) + 8U * num + 4U * slot;
+    std::uint32_t buf = pma(entry);
+    std::uint16_t len = pma(entry + 2U) & 0x03FFU;
+
+    for (std::uint32_t i = 0; i < len; i++)
+    {
+        std::uint16_t word = pma(buf + (i & ~1U));
+        data.push_back(static_cast<std::uint8_t>((i & 1U) ? (word >> 8) : word));
+    }
+
+    e ^= DTOG_TX;
+    e = dbl(num) ? e : with_stat_tx(e, NAKING);
+    set_epr(num, static_cast<std::uint16_t>(e | CTR_TX));
+    return ACK;
+}
+
+void stm32fs::sof()
+{
+    bus.poke(addr(FNR), (reg(FNR) + 1U) & 0x07FFU);
+    bus.set(addr(ISTR), ISTR_SOF);
+}
+
+void stm32fs::suspend(bool idle)
+{
+    bus.set(addr(ISTR), idle ? ISTR_SUSP : ISTR_WKUP);
+}
+
+bool stm32fs::irq() const
+{
+    return (istr() & reg(CNTR) & 0xFF00U) != 0U;
+}
+
+std::uint16_t stm32fs::reg(std::uint32_t off) const
+{
+    return (off == ISTR) ? istr() : static_cast<std::uint16_t>(bus.peek(addr(off)));
+}
+
+std::uint32_t stm32fs::addr(std::uint32_t off, bool pma)
+{
+    return static_cast<std::uint32_t>(CUSB_STM32FS_BASE + (pma ? PMA : 0U) + off);
+}
+
+std::uint16_t stm32fs::istr() const
+{
+    std::uint16_t val = static_cast<std::uint16_t>(bus.peek(addr(ISTR)));
+
+    for (std::uint8_t n = 0; n < 8U; n++)
+    {
+        std::uint16_t e = epr(n);
+
+        if ((e & (CTR_RX | CTR_TX)) != 0U)
+        {
+            val |= static_cast<std::uint16_t>(ISTR_CTR | n | ((e & CTR_RX) ? ISTR_DIR : 0U));
+            break;
+        }
+    }
+
+    return val;
+}
+
+std::uint16_t stm32fs::epr(std::uint8_t num) const
+{
+    return static_cast<std::uint16_t>(bus.peek(addr(4U * num)));
+}
+
+void stm32fs::set_epr(std::uint8_t num, std::uint16_t val)
+{
+    bus.poke(addr(4U * num), val);
+}
+
+std::uint16_t stm32fs::pma(std::uint32_t off) const
+{
+    return static_cast<std::uint16_t>(bus.peek(addr(off, true)));
+}
+
+void stm32fs::set_pma(std::uint32_t off, std::uint16_t val)
+{
+    bus.poke(addr(off, true), val);
+}
+
+bool stm32fs::dbl(std::uint8_t num) const
+{
+    std::uint16_t type = epr(num) & TYPE_MASK;
+    return type == TYPE_ISO || (type == TYPE_BULK && (epr(num) & KIND) != 0U);
+}
+} /* namespace stubs */
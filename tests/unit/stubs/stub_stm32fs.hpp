@@ -0,0 +1,126 @@
+/**
+ * @file
+ * @brief Model of the STM32 USB full-speed device peripheral for unit
+ * tests of @ref stm32fs.h, built on @ref stub_regs.hpp. Defines the bus
+ * access functions the driver uses in unit test builds and gives tests a
+ * host side that sends tokens the way the hardware would see them.
+ * @details Registers behave as documented: EPnR CTR flags clear when
+ * written 0, DTOG and STAT bits toggle when written 1, ISTR flags clear
+ * when written 0 and ISTR.CTR and EP_ID follow the lowest endpoint
+ * register with a CTR flag set. The PMA is plain memory. Single-buffered endpoints NAK unless
+ * their STAT is VALID and go to NAK after every packet. Double-buffered
+ * bulk ones NAK while DTOG equals SW_BUF. Isochronous ones never NAK:
+ * every token uses the buffer DTOG points at and toggles it, an IN
+ * sending whatever count that buffer holds. A SETUP is accepted while
+ * NAKing or stalled and sets both STAT fields of EP0 to NAK.
+ *
+ * One instance at a time, since the driver's bus has no context.
+ *
+ * @author Ian Ress
+ * @version 0.1
+ * @date 2026-10-17
+ * @copyright Copyright (c) 2026
+ */
+
+#ifndef STUB_STM32FS_HPP_
+#define STUB_STM32FS_HPP_
+
+/*------------------------------------------------------------*/
+/*------------------------- INCLUDES -------------------------*/
+/*------------------------------------------------------------*/
+
+/* Driver. */
+#include "cusb/stm32fs.h"
+
+/* Register file. */
+#include "stubs/stub_regs.hpp"
+
+/* STDLib. */
+#include <cstdint>
+#include <vector>
+
+/*------------------------------------------------------------*/
+/*---------------------------- STRUCTS -----------------------*/
+/*------------------------------------------------------------*/
+
+namespace stubs
+{
+/**
+ * @brief The peripheral. Construct before the driver.
+ */
+struct stm32fs
+{
+    /// @name Handshakes
+    /// @{
+    static constexpr int ACK = 0;
+    static constexpr int NAK = 1;
+    static constexpr int STALL = 2;
+    static constexpr int TIMEOUT = 3;     /**< No answer: endpoint disabled. */
+    /// @}
+
+    stm32fs();
+    ~stm32fs();
+    stm32fs(const stm32fs &) = delete;
+    stm32fs &operator=(const stm32fs &) = delete;
+
+    /**
+     * @brief Bus reset.
+     */
+    void reset();
+
+    /**
+     * @brief SETUP token with @p packet to EP0.
+     */
+    int setup(const std::uint8_t *packet);
+
+    /**
+     * @brief OUT token with @p data to endpoint number @p num.
+     */
+    int out(std::uint8_t num, const std::uint8_t *data, std::uint16_t len);
+
+    /**
+     * @brief IN token to endpoint number @p num. The packet is appended
+     * to @p data.
+     */
+    int in(std::uint8_t num, std::vector<std::uint8_t> &data);
+
+    /**
+     * @brief Start of frame.
+     */
+    void sof();
+
+    /**
+     * @brief Bus goes idle (true) or active again (false).
+     */
+    void suspend(bool idle);
+
+    /**
+     * @brief True while the interrupt line is asserted.
+     */
+    bool irq() const;
+
+    /**
+     * @brief Register at offset @p off from the base.
+     */
+    std::uint16_t reg(std::uint32_t off) const;
+
+    /**
+     * @brief Address of the register at offset @p off from the base, or
+     * of the PMA word at @p off when @p pma is true.
+     */
+    static std::uint32_t addr(std::uint32_t off, bool pma = false);
+
+    /// @brief Registers and PMA. Every driver access is traced here.
+    regs bus;
+
+private:
+    std::uint16_t istr() const;
+    std::uint16_t epr(std::uint8_t num) const;
+    void set_epr(std::uint8_t num, std::uint16_t val);
+    std::uint16_t pma(std::uint32_t off) const;
+    void set_pma(std::uint32_t off, std::uint16_t val);
+    bool dbl(std::uint8_t num) const;
+};
+} /* namespace stubs */
+
+#endif /* STUB_STM32FS_HPP_ */